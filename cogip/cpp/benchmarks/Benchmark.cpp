@@ -0,0 +1,144 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+#include "benchmarks/Benchmark.hpp"
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> allocation_counter{0};
+std::atomic<std::uint64_t> allocated_bytes_counter{0};
+
+void* counted_allocation(std::size_t size)
+{
+    allocation_counter.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes_counter.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+} // namespace
+
+// Replace global allocation functions to count allocations of the whole program,
+// including the libraries under test.
+void* operator new(std::size_t size) { return counted_allocation(size); }
+void* operator new[](std::size_t size) { return counted_allocation(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return counted_allocation(size);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace cogip {
+
+namespace benchmarks {
+
+std::uint64_t allocation_count()
+{
+    return allocation_counter.load(std::memory_order_relaxed);
+}
+
+std::uint64_t allocated_bytes()
+{
+    return allocated_bytes_counter.load(std::memory_order_relaxed);
+}
+
+/// Value at a given percentile of sorted samples, using the nearest rank.
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    std::size_t rank = static_cast<std::size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+void Runner::print_header() const
+{
+    std::printf("%-40s %8s %10s %10s %10s %10s %10s %9s %11s\n",
+                "benchmark", "calls", "min(ns)", "p50(ns)", "p90(ns)", "p99(ns)", "max(ns)",
+                "allocs", "bytes");
+}
+
+void Runner::run(const std::string& name, const Body& body, std::size_t batch)
+{
+    if (!selected(name)) {
+        return;
+    }
+    batch = std::max<std::size_t>(batch, 1);
+
+    for (std::size_t i = 0; i < options_.warmup; i++) {
+        body(batch);
+    }
+
+    std::vector<double> samples;
+    samples.reserve(options_.samples);
+    std::uint64_t allocations = allocation_count();
+    std::uint64_t bytes = allocated_bytes();
+    for (std::size_t i = 0; i < options_.samples; i++) {
+        auto start = std::chrono::steady_clock::now();
+        body(batch);
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / batch);
+    }
+    // Samples are reserved, so allocations only come from the benchmarked code.
+    allocations = allocation_count() - allocations;
+    bytes = allocated_bytes() - bytes;
+    std::sort(samples.begin(), samples.end());
+
+    double calls = static_cast<double>(options_.samples * batch);
+    record(name, samples, options_.samples * batch, allocations / calls, bytes / calls);
+}
+
+void Runner::report(const std::string& name, std::vector<double>& samples)
+{
+    if (!selected(name) || samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    record(name, samples, samples.size(), 0, 0);
+}
+
+void Runner::record(const std::string& name, const std::vector<double>& sorted, std::size_t calls,
+                    double allocations, double bytes)
+{
+    Result result{
+        name,
+        calls,
+        sorted.front(),
+        percentile(sorted, 50),
+        percentile(sorted, 90),
+        percentile(sorted, 99),
+        sorted.back(),
+        allocations,
+        bytes
+    };
+    results_.push_back(result);
+
+    std::printf("%-40s %8zu %10.0f %10.0f %10.0f %10.0f %10.0f %9.2f %11.1f\n",
+                result.name.c_str(), result.calls, result.min, result.p50, result.p90, result.p99,
+                result.max, result.allocations, result.allocated_bytes);
+    std::fflush(stdout);
+}
+
+} // namespace benchmarks
+
+} // namespace cogip
@@ -0,0 +1,104 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @defgroup    benchmarks Benchmarks
+/// @brief       Standalone micro-benchmarks of the C++ libraries
+///
+/// Each benchmark times a function over many samples and reports latency
+/// percentiles and heap allocations per call.
+/// Benchmarks do not need Python nor another process owning the shared memory.
+///
+/// @{
+/// @file
+/// @brief       Minimal micro-benchmark runner.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cogip {
+
+namespace benchmarks {
+
+/// @brief Options shared by all benchmarks.
+struct Options {
+    std::string filter;          ///< Only run benchmarks whose name contains this string.
+    std::size_t samples = 200;   ///< Number of timed samples per benchmark.
+    std::size_t warmup = 10;     ///< Number of untimed samples run before measuring.
+    std::uint32_t seed = 42;     ///< Seed of the synthetic scenes.
+};
+
+/// @brief Results of one benchmark, latencies are per call in nanoseconds.
+struct Result {
+    std::string name;            ///< Benchmark name.
+    std::size_t calls;           ///< Number of timed calls.
+    double min;                  ///< Minimum latency.
+    double p50;                  ///< Median latency.
+    double p90;                  ///< 90th percentile latency.
+    double p99;                  ///< 99th percentile latency.
+    double max;                  ///< Maximum latency.
+    double allocations;          ///< Heap allocations per call.
+    double allocated_bytes;      ///< Heap allocated bytes per call.
+};
+
+/// @brief Function called for each sample, runs the benchmarked code `batch` times.
+using Body = std::function<void(std::size_t batch)>;
+
+/// @brief Registry and runner of benchmarks.
+class Runner
+{
+public:
+    /// @brief Constructor.
+    /// @param options Options applied to all benchmarks.
+    explicit Runner(const Options& options): options_(options) {}
+
+    /// @brief Runs a benchmark if its name matches the filter, and prints its results.
+    /// Very fast functions should use a batch so the clock overhead stays negligible.
+    /// @param name Benchmark name.
+    /// @param body Code to benchmark.
+    /// @param batch Number of calls per timed sample.
+    void run(const std::string& name, const Body& body, std::size_t batch = 1);
+
+    /// @brief Prints the results of latencies measured outside of run(), such as in other processes.
+    /// Allocations are not counted.
+    /// @param name Benchmark name.
+    /// @param samples Latencies in nanoseconds, sorted in place.
+    void report(const std::string& name, std::vector<double>& samples);
+
+    /// @brief Checks whether a benchmark name matches the filter.
+    bool selected(const std::string& name) const { return name.find(options_.filter) != std::string::npos; }
+
+    /// @brief Prints the header of the result table.
+    void print_header() const;
+
+    /// @brief Results of the benchmarks run so far.
+    const std::vector<Result>& results() const { return results_; }
+
+private:
+    Options options_;              ///< Options applied to all benchmarks.
+    std::vector<Result> results_;  ///< Results of the benchmarks run so far.
+
+    /// @brief Records and prints the results of sorted samples.
+    void record(const std::string& name, const std::vector<double>& sorted, std::size_t calls,
+                double allocations, double bytes);
+};
+
+/// @brief Number of heap allocations since program start, in all threads.
+std::uint64_t allocation_count();
+
+/// @brief Number of heap allocated bytes since program start, in all threads.
+std::uint64_t allocated_bytes();
+
+} // namespace benchmarks
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,465 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @file
+/// @brief       Benchmarks of the inter-process communication through the shared memory.
+///
+/// Usage: cogip_ipc_benchmarks [--filter <substring>] [--samples <n>] [--warmup <n>]
+///                             [--writers <n>] [--readers <n>] [--max-consumers <n>] [--duration <s>]
+///
+/// Writer and reader processes are forked onto a private shared memory segment and measure,
+/// with CLOCK_MONOTONIC which is shared by all processes:
+/// - WritePriorityLock acquire/release latency, alone and with concurrent writers and readers,
+/// - postUpdate() to waitUpdate() wake-up latency, for 1 to `--max-consumers` registered consumers,
+/// - end-to-end latency and throughput of pose and lidar scan (`lidar_data_t`, 24 KB) payloads,
+///   written under the lock then posted, for 1 to `--max-consumers` readers.
+/// Children only use the segment mapping inherited from the parent and exit without running destructors,
+/// so the segment is removed once, by the parent.
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Project includes
+#include "benchmarks/Benchmark.hpp"
+#include "shared_memory/SharedMemory.hpp"
+
+using namespace cogip;
+
+namespace {
+
+/// Options of the IPC benchmarks, in addition to the common ones.
+struct IpcOptions {
+    std::size_t writers = 1;        ///< Writer processes of the contended lock and throughput benchmarks.
+    std::size_t readers = 4;        ///< Reader processes of the contended lock benchmarks.
+    std::size_t max_consumers = 8;  ///< Largest number of registered consumers.
+    double duration = 1.0;          ///< Duration of each throughput benchmark in seconds.
+};
+
+/// Latencies recorded by each process in throughput benchmarks, at most.
+constexpr std::size_t throughput_samples = 20000;
+
+/// Monotonic time in nanoseconds, comparable between processes.
+std::uint64_t now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/// Synchronization of the forked processes, first part of the memory shared with them.
+struct alignas(64) Control {
+    std::atomic<std::uint32_t> ready;           ///< Processes ready to start.
+    std::atomic<std::uint32_t> go;              ///< Set by the parent to start the processes.
+    std::atomic<std::uint32_t> stop;            ///< Set by the parent to stop the processes.
+    alignas(64) std::atomic<std::uint32_t> acks; ///< Consumers which received the last update.
+    alignas(64) std::atomic<std::uint64_t> post_time;  ///< Time of the last posted update.
+    alignas(64) std::atomic<std::uint64_t> write_time; ///< Time of the last payload write, under the lock.
+};
+
+/// Results of one process, in the memory shared with the processes after the control block.
+/// Recorded latencies in nanoseconds follow, see samples().
+struct Slot {
+    std::uint64_t operations; ///< Operations completed by the process.
+    std::uint64_t count;      ///< Number of recorded samples.
+
+    double* samples() { return reinterpret_cast<double*>(this + 1); }
+};
+
+/// Anonymous memory shared with the forked processes, holding the control block and their results.
+class SharedResults
+{
+public:
+    SharedResults(std::size_t processes, std::size_t capacity):
+        capacity_(capacity),
+        slot_size_((sizeof(Slot) + capacity * sizeof(double) + 63) & ~std::size_t(63)),
+        size_(sizeof(Control) + processes * slot_size_)
+    {
+        memory_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (memory_ == MAP_FAILED) {
+            throw std::runtime_error("mmap of benchmark results failed");
+        }
+    }
+
+    ~SharedResults() { munmap(memory_, size_); }
+
+    SharedResults(const SharedResults&) = delete;
+    SharedResults& operator=(const SharedResults&) = delete;
+
+    /// Clears the control block and the results before a benchmark.
+    void clear() { std::memset(memory_, 0, size_); }
+
+    Control& control() { return *static_cast<Control*>(memory_); }
+
+    Slot& slot(std::size_t process)
+    {
+        return *reinterpret_cast<Slot*>(static_cast<char*>(memory_) + sizeof(Control) + process * slot_size_);
+    }
+
+    /// Records a sample of a process, dropped once its slot is full.
+    void record(std::size_t process, double sample)
+    {
+        Slot& s = slot(process);
+        if (s.count < capacity_) {
+            s.samples()[s.count++] = sample;
+        }
+    }
+
+    /// Samples of processes [begin, end), merged.
+    std::vector<double> merged(std::size_t begin, std::size_t end)
+    {
+        std::vector<double> samples;
+        for (std::size_t p = begin; p < end; p++) {
+            samples.insert(samples.end(), slot(p).samples(), slot(p).samples() + slot(p).count);
+        }
+        return samples;
+    }
+
+    /// Operations of processes [begin, end), summed.
+    std::uint64_t operations(std::size_t begin, std::size_t end)
+    {
+        std::uint64_t total = 0;
+        for (std::size_t p = begin; p < end; p++) {
+            total += slot(p).operations;
+        }
+        return total;
+    }
+
+private:
+    std::size_t capacity_;
+    std::size_t slot_size_;
+    std::size_t size_;
+    void* memory_;
+};
+
+/// Forks a process running a function, which exits without running destructors.
+pid_t spawn(const std::function<void()>& body)
+{
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("fork failed");
+    }
+    if (pid == 0) {
+        int status = EXIT_SUCCESS;
+        try {
+            body();
+        }
+        catch (const std::exception& error) {
+            std::cerr << "benchmark process: " << error.what() << std::endl;
+            status = EXIT_FAILURE;
+        }
+        _exit(status);
+    }
+    return pid;
+}
+
+/// Waits for forked processes, returns false if one failed.
+bool join(const std::vector<pid_t>& pids)
+{
+    bool ok = true;
+    for (pid_t pid : pids) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    }
+    return ok;
+}
+
+/// Waits in a child until the parent starts the benchmark.
+void wait_start(Control& control)
+{
+    control.ready.fetch_add(1);
+    while (!control.go.load(std::memory_order_acquire)) {
+        sched_yield();
+    }
+}
+
+/// Starts the benchmark once all processes are ready.
+void start(Control& control, std::size_t processes)
+{
+    while (control.ready.load() < processes) {
+        sched_yield();
+    }
+    control.go.store(1, std::memory_order_release);
+}
+
+/// Acquire/release latency of a lock, per pair of calls, in `writers` writer and `readers` reader processes.
+/// Writers are slots [0, writers), readers follow.
+bool lock_latency(
+    benchmarks::Runner& runner, const benchmarks::Options& options, SharedResults& results,
+    shared_memory::WritePriorityLock& lock, std::size_t writers, std::size_t readers)
+{
+    const std::string suffix = "/" + std::to_string(writers) + "w" + std::to_string(readers) + "r";
+    const std::string read_name = "WritePriorityLock::read" + suffix;
+    const std::string write_name = "WritePriorityLock::write" + suffix;
+    if (!(runner.selected(read_name) && readers) && !(runner.selected(write_name) && writers)) {
+        return true;
+    }
+    constexpr std::size_t batch = 100;
+    results.clear();
+    Control& control = results.control();
+
+    auto body = [&](std::size_t process, bool writer) {
+        wait_start(control);
+        for (std::size_t i = 0; i < options.warmup + options.samples; i++) {
+            std::uint64_t begin = now_ns();
+            for (std::size_t j = 0; j < batch; j++) {
+                if (writer) {
+                    lock.startWriting();
+                    lock.finishWriting();
+                }
+                else {
+                    lock.startReading();
+                    lock.finishReading();
+                }
+            }
+            if (i >= options.warmup) {
+                results.record(process, static_cast<double>(now_ns() - begin) / batch);
+            }
+        }
+    };
+    std::vector<pid_t> pids;
+    for (std::size_t p = 0; p < writers + readers; p++) {
+        pids.push_back(spawn([&, p]() { body(p, p < writers); }));
+    }
+    start(control, pids.size());
+    bool ok = join(pids);
+
+    std::vector<double> samples = results.merged(0, writers);
+    runner.report(write_name, samples);
+    samples = results.merged(writers, writers + readers);
+    runner.report(read_name, samples);
+    return ok;
+}
+
+/// Wake-up latency from postUpdate() in the parent to waitUpdate() returning in `consumers` processes.
+/// The next update is posted once all consumers received the previous one.
+bool wakeup_latency(
+    benchmarks::Runner& runner, const benchmarks::Options& options, SharedResults& results,
+    shared_memory::WritePriorityLock& lock, std::size_t consumers)
+{
+    const std::string name = "WritePriorityLock::wakeup/" + std::to_string(consumers) + "c";
+    if (!runner.selected(name)) {
+        return true;
+    }
+    results.clear();
+    Control& control = results.control();
+    const std::size_t updates = options.warmup + options.samples;
+
+    std::vector<pid_t> pids;
+    for (std::size_t p = 0; p < consumers; p++) {
+        pids.push_back(spawn([&, p]() {
+            lock.registerConsumer();
+            wait_start(control);
+            for (std::size_t i = 0; i < updates; i++) {
+                if (!lock.waitUpdate(1.0)) {
+                    throw std::runtime_error("update not received");
+                }
+                std::uint64_t latency = now_ns() - control.post_time.load();
+                if (i >= options.warmup) {
+                    results.record(p, static_cast<double>(latency));
+                }
+                control.acks.fetch_add(1);
+            }
+        }));
+    }
+    start(control, consumers);
+    for (std::size_t i = 0; i < updates; i++) {
+        control.acks.store(0);
+        control.post_time.store(now_ns());
+        lock.postUpdate();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (control.acks.load() < consumers && std::chrono::steady_clock::now() < deadline) {
+            sched_yield();
+        }
+    }
+    bool ok = join(pids);
+
+    std::vector<double> samples = results.merged(0, consumers);
+    runner.report(name, samples);
+    return ok;
+}
+
+/// Payload written by the throughput benchmarks.
+struct Payload {
+    const char* name;                        ///< Payload name.
+    shared_memory::WritePriorityLock& lock;  ///< Lock protecting the payload region.
+    void* region;                            ///< Payload region in the shared memory segment.
+    std::size_t size;                        ///< Payload size in bytes.
+};
+
+/// End-to-end latency and throughput of a payload written by `writers` processes and read by `readers` consumers.
+/// Each write copies the payload under the write lock, then posts an update;
+/// each consumer copies the payload under the read lock when woken up.
+/// Latency is measured from the end of the last write to the end of the read.
+/// Writers are slots [0, writers), readers follow.
+bool payload_throughput(
+    benchmarks::Runner& runner, const IpcOptions& ipc_options, SharedResults& results,
+    const Payload& payload, std::size_t writers, std::size_t readers)
+{
+    const std::string name = std::string("IPC::") + payload.name + "/" +
+                             std::to_string(writers) + "w" + std::to_string(readers) + "c";
+    if (!runner.selected(name)) {
+        return true;
+    }
+    results.clear();
+    Control& control = results.control();
+
+    std::vector<pid_t> pids;
+    for (std::size_t p = 0; p < writers; p++) {
+        pids.push_back(spawn([&, p]() {
+            std::vector<char> source(payload.size, static_cast<char>(p));
+            wait_start(control);
+            while (!control.stop.load(std::memory_order_relaxed)) {
+                payload.lock.startWriting();
+                std::memcpy(payload.region, source.data(), payload.size);
+                control.write_time.store(now_ns(), std::memory_order_relaxed);
+                payload.lock.finishWriting();
+                payload.lock.postUpdate();
+                results.slot(p).operations++;
+            }
+        }));
+    }
+    for (std::size_t p = writers; p < writers + readers; p++) {
+        pids.push_back(spawn([&, p]() {
+            std::vector<char> destination(payload.size);
+            payload.lock.registerConsumer();
+            wait_start(control);
+            while (!control.stop.load(std::memory_order_relaxed)) {
+                if (!payload.lock.waitUpdate(0.1)) {
+                    continue;
+                }
+                payload.lock.startReading();
+                std::memcpy(destination.data(), payload.region, payload.size);
+                std::uint64_t written = control.write_time.load(std::memory_order_relaxed);
+                payload.lock.finishReading();
+                results.record(p, static_cast<double>(now_ns() - written));
+                results.slot(p).operations++;
+            }
+        }));
+    }
+    start(control, pids.size());
+    std::this_thread::sleep_for(std::chrono::duration<double>(ipc_options.duration));
+    control.stop.store(1);
+    bool ok = join(pids);
+
+    std::vector<double> samples = results.merged(writers, writers + readers);
+    runner.report(name, samples);
+    double writes = results.operations(0, writers) / ipc_options.duration;
+    double reads = results.operations(writers, writers + readers) / ipc_options.duration;
+    std::printf("%-40s %8s %12.0f writes/s %12.0f reads/s %10.1f MB/s\n",
+                "", "", writes, reads, writes * payload.size / 1e6);
+    return ok;
+}
+
+void usage(const char* program)
+{
+    std::cerr << "Usage: " << program
+              << " [--filter <substring>] [--samples <n>] [--warmup <n>]"
+              << " [--writers <n>] [--readers <n>] [--max-consumers <n>] [--duration <s>]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmarks::Options options;
+    IpcOptions ipc_options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (arg == "--filter") {
+            options.filter = argv[++i];
+        }
+        else if (arg == "--samples") {
+            options.samples = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--warmup") {
+            options.warmup = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--writers") {
+            ipc_options.writers = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--readers") {
+            ipc_options.readers = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--max-consumers") {
+            ipc_options.max_consumers = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--duration") {
+            ipc_options.duration = std::strtod(argv[++i], nullptr);
+        }
+        else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (options.samples == 0 || ipc_options.writers == 0 || ipc_options.max_consumers == 0 ||
+        !(ipc_options.duration > 0)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Private shared memory segment, owned by the benchmark.
+    std::string name = "cogip_ipc_benchmarks_" + std::to_string(getpid());
+    shared_memory::SharedMemory shared_memory(name, true);
+    shared_memory::shared_data_t* data = shared_memory.getData();
+
+    const std::size_t processes = ipc_options.writers + std::max(ipc_options.readers, ipc_options.max_consumers);
+    SharedResults results(processes, std::max(options.warmup + options.samples, throughput_samples));
+
+    benchmarks::Runner runner(options);
+    runner.print_header();
+    bool ok = true;
+
+    // Lock latency, uncontended then with concurrent writers and readers.
+    shared_memory::WritePriorityLock& pose_lock = shared_memory.getLock(shared_memory::LockName::PoseOrder);
+    ok &= lock_latency(runner, options, results, pose_lock, 1, 0);
+    ok &= lock_latency(runner, options, results, pose_lock, 0, 1);
+    ok &= lock_latency(runner, options, results, pose_lock, ipc_options.writers, ipc_options.readers);
+
+    // Wake-up latency by number of registered consumers.
+    for (std::size_t consumers = 1; consumers <= ipc_options.max_consumers; consumers++) {
+        ok &= wakeup_latency(runner, options, results, pose_lock, consumers);
+    }
+
+    // End-to-end latency and throughput of a pose and of a full lidar scan.
+    const Payload payloads[] = {
+        {"pose", pose_lock, &data->pose_order, sizeof(data->pose_order)},
+        {"lidar", shared_memory.getLock(shared_memory::LockName::LidarData),
+         &shared_memory.getLidarData(), sizeof(shared_memory::lidar_data_t)},
+    };
+    for (const Payload& payload : payloads) {
+        for (std::size_t consumers = 1; consumers <= ipc_options.max_consumers; consumers++) {
+            ok &= payload_throughput(runner, ipc_options, results, payload, ipc_options.writers, consumers);
+        }
+    }
+
+    if (!ok) {
+        std::cerr << "Some benchmark processes failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,446 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @file
+/// @brief       Benchmarks of avoidance, obstacles and lidar conversion on synthetic scenes.
+///
+/// Usage: cogip_cpp_benchmarks [--filter <substring>] [--samples <n>] [--warmup <n>] [--seed <n>] [--snapshot <path>]
+///
+/// The benchmark owns a private shared memory segment, so it runs without any other process.
+/// A shared memory snapshot saved by SharedMemory::dump() during a match adds benchmarks on that real state.
+
+// Standard includes
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Project includes
+#include "avoidance/Avoidance.hpp"
+#include "avoidance/ObstacleSet.hpp"
+#include "benchmarks/Benchmark.hpp"
+#include "obstacles/ObstacleCircle.hpp"
+#include "obstacles/ObstacleRectangle.hpp"
+#include "shared_memory/SharedMemory.hpp"
+#include "utils/LidarDataConverter.hpp"
+
+using namespace cogip;
+
+namespace {
+
+// Table of 2000 mm along X and 3000 mm along Y, centered on the origin.
+constexpr double table_x_min = -1000;
+constexpr double table_x_max = 1000;
+constexpr double table_y_min = -1500;
+constexpr double table_y_max = 1500;
+
+constexpr double robot_size = 300;
+constexpr double bounding_box_margin = 0.2;
+constexpr uint8_t bounding_box_points_number = 6;
+
+/// Margin inside the table limits where Avoidance accepts poses, computed as Avoidance does, plus 1 mm
+/// since the limits themselves are excluded.
+constexpr double table_limits_margin = robot_size / (2 - bounding_box_margin) + 1;
+
+/// Distance kept between obstacle centers and the poses given to Avoidance,
+/// so the poses stay out of the obstacles grown by the robot footprint.
+constexpr double obstacle_clearance = 400;
+
+/// Synthetic scene of random circle and rectangle obstacles.
+/// Obstacles keep clear of the start and finish points used by the avoidance benchmarks.
+struct Scene {
+    std::deque<obstacles::ObstacleCircle> circles;
+    std::deque<obstacles::ObstacleRectangle> rectangles;
+    models::Coords start{-700, -1200};
+    models::Coords finish{700, 1200};
+
+    Scene(std::size_t count, std::uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> x(table_x_min + 100, table_x_max - 100);
+        std::uniform_real_distribution<double> y(table_y_min + 100, table_y_max - 100);
+        std::uniform_real_distribution<double> angle(0, 360);
+        std::uniform_real_distribution<double> radius(50, 120);
+        std::uniform_real_distribution<double> length(80, 250);
+
+        while (circles.size() + rectangles.size() < count) {
+            double cx = x(rng);
+            double cy = y(rng);
+            if (std::hypot(cx - start.x(), cy - start.y()) < obstacle_clearance ||
+                std::hypot(cx - finish.x(), cy - finish.y()) < obstacle_clearance) {
+                continue;
+            }
+            if ((circles.size() + rectangles.size()) % 2 == 0) {
+                circles.emplace_back(cx, cy, 0, radius(rng), bounding_box_margin, bounding_box_points_number);
+            }
+            else {
+                rectangles.emplace_back(cx, cy, angle(rng), length(rng), length(rng), bounding_box_margin);
+            }
+        }
+    }
+
+    /// Checks whether a point is far enough from all obstacles to be a start or finish pose.
+    bool is_clear(double x, double y) const
+    {
+        for (const auto& obstacle : circles) {
+            if (std::hypot(x - obstacle.center().x(), y - obstacle.center().y()) < obstacle_clearance) {
+                return false;
+            }
+        }
+        for (const auto& obstacle : rectangles) {
+            if (std::hypot(x - obstacle.center().x(), y - obstacle.center().y()) < obstacle_clearance) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/// Random segments inside the table.
+std::vector<std::pair<models::Coords, models::Coords>> random_segments(std::size_t count, std::uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> x(table_x_min, table_x_max);
+    std::uniform_real_distribution<double> y(table_y_min, table_y_max);
+    std::vector<std::pair<models::Coords, models::Coords>> segments;
+    for (std::size_t i = 0; i < count; i++) {
+        segments.emplace_back(models::Coords(x(rng), y(rng)), models::Coords(x(rng), y(rng)));
+    }
+    return segments;
+}
+
+/// Random poses accepted by Avoidance: inside the table limits minus the margin and clear of the scene obstacles.
+std::vector<models::Vec2> random_poses(std::size_t count, std::uint32_t seed, const Scene& scene)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> x(table_x_min + table_limits_margin, table_x_max - table_limits_margin);
+    std::uniform_real_distribution<double> y(table_y_min + table_limits_margin, table_y_max - table_limits_margin);
+    std::vector<models::Vec2> poses;
+    while (poses.size() < count) {
+        double px = x(rng);
+        double py = y(rng);
+        if (scene.is_clear(px, py)) {
+            poses.emplace_back(px, py);
+        }
+    }
+    return poses;
+}
+
+void usage(const char* program)
+{
+    std::cerr << "Usage: " << program
+              << " [--filter <substring>] [--samples <n>] [--warmup <n>] [--seed <n>] [--snapshot <path>]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmarks::Options options;
+    std::string snapshot;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (arg == "--filter") {
+            options.filter = argv[++i];
+        }
+        else if (arg == "--samples") {
+            options.samples = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--warmup") {
+            options.warmup = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--seed") {
+            options.seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--snapshot") {
+            snapshot = argv[++i];
+        }
+        else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (options.samples == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Private shared memory segment, owned by the benchmark.
+    std::string name = "cogip_benchmarks_" + std::to_string(getpid());
+    shared_memory::SharedMemory shared_memory(name, true);
+    double* table_limits = shared_memory.getTableLimits();
+    table_limits[0] = table_x_min;
+    table_limits[1] = table_x_max;
+    table_limits[2] = table_y_min;
+    table_limits[3] = table_y_max;
+    shared_memory::shared_properties_t& properties = shared_memory.getProperties();
+    properties.robot_width = robot_size;
+    properties.robot_length = robot_size;
+    properties.obstacle_bb_margin = bounding_box_margin;
+    properties.obstacle_bb_vertices = bounding_box_points_number;
+
+    benchmarks::Runner runner(options);
+    runner.print_header();
+
+    // Avoidance graph build and search.
+    for (std::size_t count : {8, 16, 32, 64}) {
+        Scene scene(count, options.seed);
+        avoidance::Avoidance avoidance(name);
+        for (auto& obstacle : scene.circles) {
+            avoidance.add_dynamic_obstacle(obstacle);
+        }
+        for (auto& obstacle : scene.rectangles) {
+            avoidance.add_dynamic_obstacle(obstacle);
+        }
+        runner.run("Avoidance::avoidance/" + std::to_string(count), [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                avoidance.avoidance(scene.start, scene.finish);
+            }
+        });
+    }
+
+    // Time-budgeted avoidance on the densest scene, unbounded and within 1 ms.
+    {
+        Scene scene(64, options.seed);
+        avoidance::Avoidance avoidance(name);
+        for (auto& obstacle : scene.circles) {
+            avoidance.add_dynamic_obstacle(obstacle);
+        }
+        for (auto& obstacle : scene.rectangles) {
+            avoidance.add_dynamic_obstacle(obstacle);
+        }
+        for (double budget : {0.0, 0.001}) {
+            runner.run(std::string("Avoidance::avoidance/64+budget") + (budget > 0 ? "1ms" : "0"), [&](std::size_t batch) {
+                bool optimal;
+                for (std::size_t i = 0; i < batch; i++) {
+                    avoidance.avoidance(scene.start, scene.finish, budget, optimal);
+                }
+            });
+        }
+    }
+
+    // Re-validation of the cached path on the densest scene, compared to Avoidance::avoidance/64.
+    {
+        Scene scene(64, options.seed);
+        avoidance::Avoidance avoidance(name);
+        for (auto& obstacle : scene.circles) {
+            avoidance.add_dynamic_obstacle(obstacle);
+        }
+        for (auto& obstacle : scene.rectangles) {
+            avoidance.add_dynamic_obstacle(obstacle);
+        }
+        std::vector<double> path;
+        runner.run("Avoidance::validate_cached_path/64", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                if (!avoidance.validate_cached_path(scene.start, path)) {
+                    avoidance.compute_path(scene.start, scene.finish, path);
+                }
+            }
+        });
+    }
+
+    // Avoidance with fixed obstacles, fully rebuilt and with their static roadmap.
+    {
+        Scene fixed_scene(32, options.seed);
+        Scene dynamic_scene(8, options.seed + 1);
+        std::vector<std::reference_wrapper<obstacles::Obstacle>> fixed_obstacles(
+            fixed_scene.rectangles.begin(), fixed_scene.rectangles.end()
+        );
+        for (bool roadmap : {false, true}) {
+            avoidance::Avoidance avoidance(name);
+            if (roadmap) {
+                avoidance.set_static_obstacles(fixed_obstacles);
+            }
+            for (auto& obstacle : dynamic_scene.circles) {
+                avoidance.add_dynamic_obstacle(obstacle);
+            }
+            for (auto& obstacle : fixed_scene.rectangles) {
+                avoidance.add_dynamic_obstacle(obstacle);
+            }
+            runner.run(std::string("Avoidance::avoidance/fixed16") + (roadmap ? "+roadmap" : ""), [&](std::size_t batch) {
+                for (std::size_t i = 0; i < batch; i++) {
+                    avoidance.avoidance(fixed_scene.start, fixed_scene.finish);
+                }
+            });
+        }
+    }
+
+    // Path cost matrix between GOAP candidate poses, pair by pair and with a single graph build.
+    {
+        Scene scene(32, options.seed);
+        avoidance::Avoidance avoidance(name);
+        for (auto& obstacle : scene.circles) {
+            avoidance.add_dynamic_obstacle(obstacle);
+        }
+        for (auto& obstacle : scene.rectangles) {
+            avoidance.add_dynamic_obstacle(obstacle);
+        }
+        // Poses Avoidance accepts, so path searches are timed rather than their early rejection.
+        std::vector<models::Vec2> poses = random_poses(16, options.seed, scene);
+        std::vector<double> path;
+        runner.run("Avoidance::compute_path/16x16", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                for (const auto& start : poses) {
+                    for (const auto& goal : poses) {
+                        avoidance.compute_path(models::Coords(start.x, start.y), models::Coords(goal.x, goal.y), path);
+                    }
+                }
+            }
+        });
+        std::vector<double> costs;
+        runner.run("Avoidance::compute_path_costs/16x16", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                avoidance.compute_path_costs(poses, poses, costs);
+            }
+        });
+    }
+
+    // Polygon segment crossing test.
+    {
+        Scene scene(64, options.seed);
+        auto segments = random_segments(1024, options.seed);
+        std::size_t next = 0;
+        volatile bool sink = false;
+        runner.run("ObstaclePolygon::is_segment_crossing", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                const auto& segment = segments[next];
+                auto& obstacle = scene.rectangles[next % scene.rectangles.size()];
+                sink = obstacle.is_segment_crossing(segment.first, segment.second);
+                next = (next + 1) % segments.size();
+            }
+        }, 1000);
+        (void)sink;
+    }
+
+    // Segment test against all obstacles, through virtual calls and through the obstacle set.
+    {
+        Scene scene(64, options.seed);
+        std::vector<std::reference_wrapper<obstacles::Obstacle>> obstacles;
+        obstacles.insert(obstacles.end(), scene.circles.begin(), scene.circles.end());
+        obstacles.insert(obstacles.end(), scene.rectangles.begin(), scene.rectangles.end());
+        avoidance::ObstacleSet obstacle_set;
+        obstacle_set.build(obstacles);
+        auto segments = random_segments(1024, options.seed);
+        std::vector<uint32_t> crossed;
+        std::size_t next = 0;
+        volatile std::size_t sink = 0;
+        runner.run("Obstacle::is_segment_crossing/64", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                const auto& segment = segments[next];
+                std::size_t count = 0;
+                for (auto& obstacle : obstacles) {
+                    count += obstacle.get().is_segment_crossing(segment.first, segment.second);
+                }
+                sink = count;
+                next = (next + 1) % segments.size();
+            }
+        }, 100);
+        runner.run("ObstacleSet::segment_crossings/64", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                const auto& segment = segments[next];
+                obstacle_set.segment_crossings(
+                    segment.first.x(), segment.first.y(), segment.second.x(), segment.second.y(), crossed
+                );
+                sink = crossed.size();
+                next = (next + 1) % segments.size();
+            }
+        }, 100);
+
+        // Same segments swept by the robot footprint.
+        avoidance::ObstacleSet footprint_set;
+        footprint_set.set_footprint(robot_size, robot_size);
+        footprint_set.build(obstacles);
+        runner.run("ObstacleSet::footprint_crossings/64", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                const auto& segment = segments[next];
+                footprint_set.segment_crossings(
+                    segment.first.x(), segment.first.y(), segment.second.x(), segment.second.y(), crossed
+                );
+                sink = crossed.size();
+                next = (next + 1) % segments.size();
+            }
+        }, 100);
+
+        // Bounding box points of all obstacles, as tested when validating graph vertices.
+        std::size_t count = obstacle_set.bounding_box_offset(obstacle_set.size());
+        std::vector<uint8_t> inside(count);
+        runner.run("ObstacleSet::points_inside/64", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                obstacle_set.points_inside(obstacle_set.bounding_box_x(), obstacle_set.bounding_box_y(), count, inside.data());
+            }
+        }, 10);
+        (void)sink;
+    }
+
+    // Lidar conversion of a full scan.
+    {
+        // Last entry is kept for the end of data marker.
+        // The scan is published like a driver does, so it is also in the compact scan history.
+        auto& lidar_data = shared_memory::tripleBufferBeginWrite(shared_memory.getLidarDataBuffer());
+        std::size_t points = shared_memory::MAX_LIDAR_DATA_COUNT - 1;
+        std::mt19937 rng(options.seed);
+        std::uniform_real_distribution<double> distance(100, 3000);
+        for (std::size_t i = 0; i < points; i++) {
+            lidar_data[i][0] = 360.0 * i / points;
+            lidar_data[i][1] = distance(rng);
+            lidar_data[i][2] = 200;
+        }
+        lidar_data[points][0] = -1;
+        shared_memory.getLidarScanHeader(lidar_data).point_count = points;
+        shared_memory.publishLidarScan();
+        shared_memory.getPoseCurrentBuffer()->push(0, 0, 30);
+
+        utils::LidarDataConverter converter(name);
+        shared_memory::WritePriorityLock& data_lock = shared_memory.getLock(shared_memory::LockName::LidarData);
+        runner.run("LidarDataConverter::convert", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                data_lock.postUpdate();
+                converter.convert();
+            }
+        });
+
+        converter.setCompactInput(true);
+        runner.run("LidarDataConverter::convert/compact", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                data_lock.postUpdate();
+                converter.convert();
+            }
+        });
+    }
+
+    // Avoidance on a captured match state, from the current pose to the pose order, with the planner obstacles.
+    // Loading replaces the synthetic state, so it comes last.
+    if (!snapshot.empty()) {
+        try {
+            shared_memory.load(snapshot);
+        }
+        catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        avoidance::Avoidance avoidance(name);
+        avoidance.load_obstacles_from_shared_memory();
+        models::pose_t start = shared_memory.readPoseCurrent();
+        models::pose_t finish = shared_memory.readPoseOrder();
+        runner.run("Avoidance::avoidance/snapshot", [&](std::size_t batch) {
+            for (std::size_t i = 0; i < batch; i++) {
+                avoidance.avoidance(models::Coords(start.x, start.y), models::Coords(finish.x, finish.y));
+            }
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
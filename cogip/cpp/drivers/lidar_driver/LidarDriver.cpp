@@ -0,0 +1,214 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "lidar_driver/LidarDriver.hpp"
+#include "logger/Trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace cogip {
+
+namespace lidar_driver {
+
+std::mutex LidarDriver::shared_publish_mutex_;
+
+LidarDriver::LidarDriver(double (*external_lidar_data)[3]):
+    external_data_(external_lidar_data != nullptr),
+    lidar_data_(external_lidar_data),
+    data_write_lock_(nullptr),
+    shared_memory_(nullptr),
+    shared_lidar_data_(nullptr),
+    source_index_(0),
+    local_health_{},
+    health_(&local_health_),
+    last_packet_timestamp_(0),
+    last_scan_start_(0),
+    min_intensity_(0),
+    min_distance_(0),
+    max_distance_(std::numeric_limits<std::uint16_t>::max()),
+    min_invalid_angle_(0),
+    max_invalid_angle_(0),
+    scan_bin_mode_(ScanBinMode::None),
+    scan_bin_size_(1.0),
+    scan_bin_count_(360),
+    scan_count_(0),
+    scan_dropped_(0),
+    scan_decoded_(0),
+    scan_header_{}
+{
+    if (!external_data_) {
+        // Allocate memory if external pointer is not provided
+        lidar_data_ = new double[MAX_DATA_COUNT][3]();
+    }
+}
+
+LidarDriver::~LidarDriver()
+{
+    if (!external_data_) {
+        // Deallocate memory only if it was internally allocated
+        delete[] lidar_data_;
+    }
+}
+
+void LidarDriver::setSourceIndex(std::uint32_t source_index)
+{
+    if (source_index >= shared_memory::LIDAR_SOURCES_MAX) {
+        throw std::invalid_argument(
+            "Lidar source index must be below " + std::to_string(shared_memory::LIDAR_SOURCES_MAX) + "."
+        );
+    }
+    source_index_ = source_index;
+    if (shared_memory_ != nullptr) {
+        health_ = &shared_memory_->getLidarDriverHealth(source_index_);
+    }
+}
+
+void LidarDriver::setScanBinning(ScanBinMode mode, double bin_size)
+{
+    if (!(bin_size > 0) || std::ceil(360.0 / bin_size) > MAX_SCAN_BIN_COUNT) {
+        throw std::invalid_argument(
+            "Scan bin size must give between 1 and " + std::to_string(MAX_SCAN_BIN_COUNT) + " bins."
+        );
+    }
+    std::lock_guard<std::mutex> lock(binning_mutex_);
+    scan_bin_mode_ = mode;
+    scan_bin_size_ = bin_size;
+    scan_bin_count_ = static_cast<std::size_t>(std::ceil(360.0 / bin_size));
+}
+
+std::size_t LidarDriver::binScan(std::size_t count)
+{
+    auto bin_of = [this](const std::array<double, 3>& point) {
+        std::size_t bin = static_cast<std::size_t>(point[0] / scan_bin_size_);
+        return std::min(bin, scan_bin_count_ - 1);
+    };
+
+    // Counting sort of the filtered points by bin.
+    std::fill(scan_bin_offsets_.begin(), scan_bin_offsets_.begin() + scan_bin_count_ + 1, 0);
+    for (std::size_t i = 0; i < count; i++) {
+        scan_bin_offsets_[bin_of(scan_points_[i]) + 1]++;
+    }
+    for (std::size_t bin = 0; bin < scan_bin_count_; bin++) {
+        scan_bin_offsets_[bin + 1] += scan_bin_offsets_[bin];
+    }
+    for (std::size_t i = 0; i < count; i++) {
+        // Filling moves the offset of each bin to the start of the next one, they are restored below.
+        scan_bin_points_[scan_bin_offsets_[bin_of(scan_points_[i])]++] = {
+            scan_points_[i], scan_header_.start_timestamp + scan_header_.point_offsets[i]
+        };
+    }
+    for (std::size_t bin = scan_bin_count_; bin > 0; bin--) {
+        scan_bin_offsets_[bin] = scan_bin_offsets_[bin - 1];
+    }
+    scan_bin_offsets_[0] = 0;
+
+    std::size_t kept = 0;
+    for (std::size_t bin = 0; bin < scan_bin_count_; bin++) {
+        auto first = scan_bin_points_.begin() + scan_bin_offsets_[bin];
+        auto last = scan_bin_points_.begin() + scan_bin_offsets_[bin + 1];
+        if (first == last) {
+            continue;
+        }
+        auto selected = first;
+        switch (scan_bin_mode_) {
+        case ScanBinMode::Nearest:
+            selected = std::min_element(first, last, [](const auto& a, const auto& b) { return a.point[1] < b.point[1]; });
+            break;
+        case ScanBinMode::Median:
+            selected = first + (last - first - 1) / 2;
+            std::nth_element(first, selected, last, [](const auto& a, const auto& b) { return a.point[1] < b.point[1]; });
+            break;
+        case ScanBinMode::MaxIntensity:
+            selected = std::max_element(first, last, [](const auto& a, const auto& b) { return a.point[2] < b.point[2]; });
+            break;
+        case ScanBinMode::None:
+            break;
+        }
+        scan_points_[kept] = selected->point;
+        scan_header_.point_offsets[kept] = static_cast<std::uint32_t>(selected->stamp - scan_header_.start_timestamp);
+        kept++;
+    }
+
+    return kept;
+}
+
+void LidarDriver::publishScan(std::uint64_t end_timestamp)
+{
+    COGIP_TRACE_SPAN("LidarDriver::publishScan");
+    std::lock_guard<std::mutex> lock(binning_mutex_);
+
+    if (scan_dropped_ > 0) {
+        std::cerr << "[LidarDriver] Warning: scan exceeds " << MAX_SCAN_POINT_COUNT << " points, "
+                  << scan_dropped_ << " points dropped." << std::endl;
+    }
+
+    // Bin the scan before taking the shared data, only the final copy is done while holding it.
+    std::size_t count = scan_count_;
+    if (scan_bin_mode_ != ScanBinMode::None) {
+        count = binScan(count);
+    }
+    scan_header_.end_timestamp = end_timestamp;
+    scan_header_.point_count = static_cast<std::uint32_t>(count);
+
+    double (*lidar_data)[3] = lidar_data_;
+    std::unique_lock<std::mutex> publish_lock(shared_publish_mutex_, std::defer_lock);
+    if (shared_lidar_data_ != nullptr) {
+        publish_lock.lock();
+        shared_memory::lidar_data_t& slot = shared_memory::tripleBufferBeginWrite(*shared_lidar_data_);
+        shared_memory::lidar_scan_header_t& header = shared_memory_->getLidarScanHeader(slot);
+        header.start_timestamp = scan_header_.start_timestamp;
+        header.end_timestamp = scan_header_.end_timestamp;
+        header.point_count = scan_header_.point_count;
+        header.source = source_index_;
+        std::memcpy(header.point_offsets, scan_header_.point_offsets, count * sizeof(std::uint32_t));
+        lidar_data = slot;
+    }
+    else if (data_write_lock_ != nullptr) {
+        data_write_lock_->startWriting();
+    }
+
+    std::memcpy(lidar_data, scan_points_.data(), count * sizeof(scan_points_[0]));
+
+    // Mark as end of data
+    lidar_data[count][0] = -1.0;
+    lidar_data[count][1] = -1.0;
+    lidar_data[count][2] = -1.0;
+
+    if (shared_lidar_data_ != nullptr) {
+        shared_memory_->publishLidarScan();
+        publish_lock.unlock();
+    }
+    else if (data_write_lock_ != nullptr) {
+        data_write_lock_->finishWriting();
+    }
+    if (data_write_lock_ != nullptr) {
+        data_write_lock_->postUpdate();
+    }
+
+    if (scan_decoded_ > 0) {
+        increment(health_->revolutions_assembled);
+        health_->points_per_revolution.store(scan_decoded_, std::memory_order_relaxed);
+        std::uint64_t start = scan_header_.start_timestamp;
+        health_->spin_period.store(
+            last_scan_start_ != 0 && start > last_scan_start_ ? start - last_scan_start_ : 0,
+            std::memory_order_relaxed
+        );
+        health_->last_timestamp.store(end_timestamp, std::memory_order_relaxed);
+        last_scan_start_ = start;
+    }
+
+    scan_count_ = 0;
+    scan_dropped_ = 0;
+    scan_decoded_ = 0;
+}
+
+} // namespace lidar_driver
+
+} // namespace cogip
@@ -0,0 +1,56 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "lidar_driver/LidarDriver.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace cogip {
+
+namespace lidar_driver {
+
+NB_MODULE(lidar_driver, m) {
+    auto shared_memory_module = nb::module_::import_("cogip.cpp.libraries.shared_memory");
+
+    m.attr("MAX_DATA_COUNT") = MAX_DATA_COUNT;
+
+    nb::enum_<ScanBinMode>(m, "ScanBinMode")
+        .value("NONE", ScanBinMode::None)
+        .value("NEAREST", ScanBinMode::Nearest)
+        .value("MEDIAN", ScanBinMode::Median)
+        .value("MAX_INTENSITY", ScanBinMode::MaxIntensity);
+
+    nb::class_<LidarDriver>(m, "LidarDriver", "Publish stage shared by the lidar drivers")
+        .def(
+            "get_lidar_data",
+            [](const LidarDriver& self) -> nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>> {
+                return nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>>((void*)self.getLidarData());
+            },
+            nb::rv_policy::reference_internal
+        )
+        .def("set_source_index", &LidarDriver::setSourceIndex,
+             "Set the index of the lidar among the lidars of the robot, published with each scan", "source_index"_a)
+        .def("get_source_index", &LidarDriver::getSourceIndex, "Get the index of the lidar among the lidars of the robot")
+        .def("set_data_write_lock", &LidarDriver::setDataWriteLock, "Set the data write lock", "lock"_a)
+        .def("set_shared_memory", &LidarDriver::setSharedMemory,
+             "Publish scans in the lidar_data triple buffer of the shared memory", "shared_memory"_a)
+        .def("set_min_intensity", &LidarDriver::setMinIntensity, "Set the minimum intensity value to validate data", "min_intensity"_a)
+        .def("set_min_distance", &LidarDriver::setMinDistance, "Set the minimum distance to validate data", "min_distance"_a)
+        .def("set_max_distance", &LidarDriver::setMaxDistance, "Set the maximum distance to validate data", "max_distance"_a)
+        .def("set_invalid_angle_range", &LidarDriver::setInvalidAngleRange,
+             "Set the invalid angle range, points strictly between the two angles are dropped", "min_angle"_a, "max_angle"_a)
+        .def("set_scan_binning", &LidarDriver::setScanBinning,
+             "Publish one filtered sample per angular bin of bin_size degrees", "mode"_a, "bin_size"_a = 1.0)
+        .def("get_health", [](const LidarDriver& self) { return shared_memory::readLidarDriverHealth(self.getHealth()); },
+             "Get a snapshot of the health counters of the driver")
+    ;
+}
+
+} // namespace lidar_driver
+
+} // namespace cogip
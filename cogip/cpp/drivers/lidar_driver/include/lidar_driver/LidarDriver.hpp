@@ -0,0 +1,235 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include "shared_memory/SharedMemory.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace cogip {
+
+namespace lidar_driver {
+
+/// Number of rows of the lidar data array, the last point of a scan is followed by a row of -1.
+constexpr std::size_t MAX_DATA_COUNT = 1024;
+static_assert(MAX_DATA_COUNT <= shared_memory::MAX_LIDAR_DATA_COUNT, "scans must fit in the shared lidar data");
+
+/// Maximum number of points of a scan, the last row is kept for the end of data marker.
+constexpr std::size_t MAX_SCAN_POINT_COUNT = MAX_DATA_COUNT - 1;
+
+/// Maximum number of angular bins of a binned scan.
+constexpr std::size_t MAX_SCAN_BIN_COUNT = MAX_SCAN_POINT_COUNT;
+
+/// Selection of the sample kept in each angular bin of a binned scan.
+enum class ScanBinMode {
+    None,          ///< No binning, all filtered points are published.
+    Nearest,       ///< Keep the nearest sample of each bin.
+    Median,        ///< Keep the sample of median distance of each bin.
+    MaxIntensity,  ///< Keep the most intense sample of each bin.
+};
+
+/// @class LidarDriver
+/// Publish stage shared by the lidar drivers.
+///
+/// Each driver decodes the frames of its sensor model and feeds the points of each revolution
+/// with beginScan(), addPoint() and publishScan(). The points are filtered as they are added,
+/// in buffers allocated with the driver, then optionally binned, and published at once:
+/// in the lidar_data triple buffer and the scan history of the shared memory if set,
+/// otherwise in the lidar data array, under the data write lock.
+/// Points are published as [angle (deg, counter clockwise), distance (mm), intensity] rows,
+/// followed by a row of -1.
+///
+/// Robots with several lidars run one driver per lidar in the same process, each with its own source index.
+/// Their scans are published in turn in the same shared memory, and merged by the lidar data converter.
+///
+/// Each driver also updates the health counters of its source, in the shared memory if set,
+/// otherwise in a block of its own. The decoders count bytes and packets, the publish stage counts revolutions.
+class LidarDriver {
+public:
+    /// Constructor.
+    /// @param external_lidar_data Lidar data array of MAX_DATA_COUNT rows, allocated internally if null.
+    explicit LidarDriver(double (*external_lidar_data)[3] = nullptr);
+
+    /// Destructor.
+    virtual ~LidarDriver();
+
+    LidarDriver(const LidarDriver&) = delete;             ///< Deleted copy constructor.
+    LidarDriver& operator=(const LidarDriver&) = delete;  ///< Deleted copy assignment.
+
+    /// Set the minimum intensity value to validate data.
+    void setMinIntensity(std::uint8_t min_intensity) { min_intensity_ = min_intensity; }
+
+    /// Set the minimum distance to validate data (mm).
+    void setMinDistance(std::uint16_t min_distance) { min_distance_ = min_distance; }
+
+    /// Set the maximum distance to validate data (mm).
+    void setMaxDistance(std::uint16_t max_distance) { max_distance_ = max_distance; }
+
+    /// Set the invalid angle range, points strictly between the two angles are dropped (deg).
+    void setInvalidAngleRange(std::uint16_t min_angle, std::uint16_t max_angle) {
+        min_invalid_angle_ = min_angle;
+        max_invalid_angle_ = max_angle;
+    }
+
+    /// Publish one filtered sample per angular bin instead of all filtered points.
+    /// Empty bins are skipped, so a scan has at most one point per bin, in increasing angle order.
+    /// @param mode Selection of the sample kept in each bin, ScanBinMode::None disables binning.
+    /// @param bin_size Bin width in degrees, 360 must give at most MAX_SCAN_BIN_COUNT bins.
+    void setScanBinning(ScanBinMode mode, double bin_size = 1.0);
+
+    /// Set the index of the lidar among the lidars of the robot, published with each scan.
+    /// @throws std::invalid_argument if the index is not below shared_memory::LIDAR_SOURCES_MAX.
+    void setSourceIndex(std::uint32_t source_index);
+
+    /// Get the index of the lidar among the lidars of the robot.
+    std::uint32_t getSourceIndex() const { return source_index_; }
+
+    /// Set the data write lock.
+    void setDataWriteLock(shared_memory::WritePriorityLock& lock) { data_write_lock_ = &lock; }
+
+    /// Publish scans in the lidar_data triple buffer of the shared memory instead of the lidar data array.
+    /// The data write lock is then only used to post updates.
+    /// Each scan also fills the timing header of its slot and is appended to the scan history.
+    void setSharedMemory(shared_memory::SharedMemory& shared_memory) {
+        shared_memory_ = &shared_memory;
+        shared_lidar_data_ = &shared_memory.getLidarDataBuffer();
+        health_ = &shared_memory.getLidarDriverHealth(source_index_);
+    }
+
+    /// Get the lidar data array.
+    double (*getLidarData() const)[3] { return lidar_data_; }
+
+    /// Get the health counters of the driver, those of its source in the shared memory if set.
+    const shared_memory::lidar_driver_health_t& getHealth() const { return *health_; }
+
+    /// Count bytes read from the serial port.
+    void countBytesRead(std::size_t count) {
+        increment(health_->bytes_read, count);
+    }
+
+    /// Count a decoded packet, and the time since the previous valid one if it is valid.
+    /// @param valid Whether the checksum of the packet is valid.
+    /// @param timestamp CLOCK_MONOTONIC time of reception of the packet (ns).
+    void countPacket(bool valid, std::uint64_t timestamp) {
+        if (!valid) {
+            increment(health_->packets_bad);
+            return;
+        }
+        increment(health_->packets_ok);
+        if (last_packet_timestamp_ != 0 && timestamp > last_packet_timestamp_) {
+            std::uint64_t gap = timestamp - last_packet_timestamp_;
+            if (gap > health_->max_packet_gap.load(std::memory_order_relaxed)) {
+                health_->max_packet_gap.store(gap, std::memory_order_relaxed);
+            }
+        }
+        last_packet_timestamp_ = timestamp;
+    }
+
+    /// Count a read which timed out before a complete packet was received.
+    void countReadTimeout() {
+        increment(health_->read_timeouts);
+    }
+
+    /// Count a revolution dropped before being published.
+    void countDroppedRevolution() {
+        increment(health_->revolutions_dropped);
+    }
+
+protected:
+    /// Get the shared memory, null if not set.
+    shared_memory::SharedMemory* getSharedMemory() const { return shared_memory_; }
+
+    /// Start building a new scan, dropping the points added since the last publication.
+    /// @param start_timestamp CLOCK_MONOTONIC time of the first point of the revolution (ns), 0 if unknown.
+    void beginScan(std::uint64_t start_timestamp) {
+        scan_count_ = 0;
+        scan_dropped_ = 0;
+        scan_decoded_ = 0;
+        scan_header_.start_timestamp = start_timestamp;
+    }
+
+    /// Add a decoded point to the scan being built if it passes the filters.
+    /// @param angle Angle, counter clockwise (deg).
+    /// @param distance Distance (mm).
+    /// @param intensity Intensity, from 0 to 255.
+    /// @param timestamp CLOCK_MONOTONIC time of the point (ns), not before the start of the scan.
+    void addPoint(double angle, double distance, double intensity, std::uint64_t timestamp) {
+        scan_decoded_++;
+        if (intensity < min_intensity_ || distance < min_distance_ || distance > max_distance_
+            || (angle > min_invalid_angle_ && angle < max_invalid_angle_)) {
+            return;
+        }
+        if (scan_count_ == MAX_SCAN_POINT_COUNT) {
+            scan_dropped_++;
+            return;
+        }
+        scan_points_[scan_count_] = { angle, distance, intensity };
+        scan_header_.point_offsets[scan_count_] = static_cast<std::uint32_t>(timestamp - scan_header_.start_timestamp);
+        scan_count_++;
+    }
+
+    /// Bin the scan if enabled, then publish it and post an update on the data write lock.
+    /// @param end_timestamp CLOCK_MONOTONIC time of the last point of the revolution (ns), 0 if unknown.
+    void publishScan(std::uint64_t end_timestamp);
+
+private:
+    /// Increment a health counter, which has a single writer so it needs no atomic read-modify-write.
+    static void increment(std::atomic<std::uint64_t>& counter, std::uint64_t count = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    /// Keep one point per angular bin of the scan, in place in scan_points_ and scan_header_.
+    /// @return The number of points kept.
+    std::size_t binScan(std::size_t count);
+
+    bool external_data_;       ///< Flag to indicate if memory is externally managed
+    double (*lidar_data_)[3];  ///< Pointer to lidar data memory
+    shared_memory::WritePriorityLock* data_write_lock_;  ///< Lock posted on new scans, if set
+    shared_memory::SharedMemory* shared_memory_;  ///< Shared memory, if set
+    shared_memory::lidar_data_buffer_t* shared_lidar_data_;  ///< Shared lidar data triple buffer, if set
+    std::uint32_t source_index_;  ///< Index of the lidar among the lidars of the robot
+    shared_memory::lidar_driver_health_t local_health_;  ///< Health counters used without shared memory
+    shared_memory::lidar_driver_health_t* health_;       ///< Health counters updated by the driver
+    std::uint64_t last_packet_timestamp_;  ///< Time of the last valid packet (ns), 0 if none
+    std::uint64_t last_scan_start_;        ///< Start time of the last published revolution (ns), 0 if unknown
+
+    /// Serializes the publications of the drivers of the process, the lidar data triple buffer has a single writer.
+    static std::mutex shared_publish_mutex_;
+
+    double min_intensity_;      ///< Minimum intensity of valid points
+    double min_distance_;       ///< Minimum distance of valid points (mm)
+    double max_distance_;       ///< Maximum distance of valid points (mm)
+    double min_invalid_angle_;  ///< Start of the invalid angle range (deg)
+    double max_invalid_angle_;  ///< End of the invalid angle range (deg)
+
+    std::mutex binning_mutex_;    ///< Protects the binning settings while a scan is published
+    ScanBinMode scan_bin_mode_;   ///< Selection of the sample kept in each angular bin
+    double scan_bin_size_;        ///< Angular bin width in degrees
+    std::size_t scan_bin_count_;  ///< Number of angular bins
+
+    /// Filtered point and its timestamp.
+    struct ScanSample {
+        std::array<double, 3> point;  ///< Angle, distance, intensity.
+        std::uint64_t stamp;          ///< Time of the point (ns, CLOCK_MONOTONIC).
+    };
+
+    std::size_t scan_count_;    ///< Number of points of the scan being built
+    std::size_t scan_dropped_;  ///< Number of valid points of the scan dropped because the scan is full
+    std::size_t scan_decoded_;  ///< Number of points of the scan decoded, before filtering
+    /// Filtered points of the scan being built, published at once.
+    std::array<std::array<double, 3>, MAX_SCAN_POINT_COUNT> scan_points_;
+    /// Timing of the scan being built, point offsets match scan_points_.
+    shared_memory::lidar_scan_header_t scan_header_;
+    /// Filtered points sorted by bin, the points of bin i start at scan_bin_offsets_[i].
+    std::array<ScanSample, MAX_SCAN_POINT_COUNT> scan_bin_points_;
+    std::array<std::size_t, MAX_SCAN_BIN_COUNT + 1> scan_bin_offsets_;
+};
+
+} // namespace lidar_driver
+
+} // namespace cogip
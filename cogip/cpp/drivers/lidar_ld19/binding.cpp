@@ -15,6 +15,8 @@ namespace ldlidar {
 NB_MODULE(lidar_ld19, m) {
     auto models_module = nb::module_::import_("cogip.cpp.libraries.models");
     auto shared_memory_module = nb::module_::import_("cogip.cpp.libraries.shared_memory");
+    auto lidar_driver_module = nb::module_::import_("cogip.cpp.drivers.lidar_driver");
+    auto utils_module = nb::module_::import_("cogip.cpp.libraries.utils");
 
     nb::enum_<LibSerial::BaudRate>(m, "BaudRate")
         .value("BAUD_230400", LibSerial::BaudRate::BAUD_230400);
@@ -26,11 +28,16 @@ NB_MODULE(lidar_ld19, m) {
         .value("DATA_WAIT", LidarStatus::DATA_WAIT)
         .value("STOP", LidarStatus::STOP);
 
-    nb::class_<LDLidarDriver>(m, "LDLidarDriver")
+    nb::class_<LDLidarDriver, cogip::lidar_driver::LidarDriver>(m, "LDLidarDriver")
         .def(nb::init<>(), "Constructor that internally manages memory")
-        .def(nb::init<nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>>>(),
-             "Constructor accepting nanobind::ndarray",
-             "external_lidar_data"_a
+        .def(
+            "__init__",
+            [](LDLidarDriver* self, nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>> external_lidar_data) {
+                new (self) LDLidarDriver(reinterpret_cast<double(*)[3]>(external_lidar_data.data()));
+            },
+            "Constructor accepting nanobind::ndarray",
+            "external_lidar_data"_a,
+            nb::keep_alive<1, 2>()
         )
         .def("connect", &LDLidarDriver::connect)
         .def("disconnect", &LDLidarDriver::disconnect)
@@ -38,6 +45,11 @@ NB_MODULE(lidar_ld19, m) {
         .def("start", &LDLidarDriver::start)
         .def("stop", &LDLidarDriver::stop)
         .def("ok", &LDLidarDriver::ok)
+        .def("set_rx_thread_config", &LDLidarDriver::setRxThreadConfig,
+             "Set the scheduling of the thread reading the serial port, decoding the frames and publishing the scans",
+             "config"_a)
+        .def("get_clock_drift", &LDLidarDriver::getClockDrift,
+             "Get the estimated drift of CLOCK_MONOTONIC relative to the lidar clock (ppm)")
         .def(
             "get_lidar_scan_freq",
             [](LDLidarDriver& self) {
@@ -46,19 +58,6 @@ NB_MODULE(lidar_ld19, m) {
                 return std::make_pair(success, result);
             }
         )
-        .def(
-            "get_lidar_data",
-            [](const LDLidarDriver &self) -> nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>> {
-                const auto &points = self.getLidarData();
-                return nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>>((void *)points);
-            },
-            nb::rv_policy::reference_internal
-        )
-        .def("set_data_write_lock", &LDLidarDriver::setDataWriteLock, "Set the data write lock", "lock"_a)
-        .def("set_min_intensity", &LDLidarDriver::setMinIntensity, "Set the minimum intensity value to validate data", "min_intensity"_a)
-        .def("set_min_distance", &LDLidarDriver::setMinDistance, "Set the minimum distance to validate data", "min_distance"_a)
-        .def("set_max_distance", &LDLidarDriver::setMaxDistance, "Set the maximum distance to validate data", "max_distance"_a)
-        .def("set_invalid_angle_range", &LDLidarDriver::setInvalidAngleRange, "Set the invalid angle range", "min_angle"_a, "max_angle"_a)
     ;
 }
 
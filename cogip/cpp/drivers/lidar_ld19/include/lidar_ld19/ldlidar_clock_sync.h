@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ldlidar {
+
+/// Estimator mapping the millisecond timestamps of the LD19 packets onto CLOCK_MONOTONIC.
+///
+/// Each packet gives a pair of sensor time and reception time. The reception time is the sensor time
+/// plus a clock offset, a drift proportional to the sensor time, and a latency which is never negative
+/// but varies with USB and serial buffering. The estimator tracks the lower envelope of the offsets:
+/// a packet received earlier than predicted moves the line down to it at once, and the minimum of each
+/// window of samples gives a point of the envelope, the drift being the slope across the last minima.
+/// The mapped times therefore carry the minimal latency only, not the jitter.
+///
+/// Sensor timestamps are unwrapped on 64 bits, a jump of the offset beyond the resync threshold,
+/// when the sensor restarts or the stream stalls, restarts the estimation.
+class ClockSync {
+public:
+    /// Constructor.
+    /// @param wrap_period Period of the sensor timestamps (ms), 30000 for the LD19.
+    explicit ClockSync(std::uint32_t wrap_period = 30000);
+
+    /// Restart the estimation on the next sample.
+    void reset();
+
+    /// Add a sample and map its sensor timestamp.
+    /// @param sensor_stamp Sensor timestamp (ms), below the wrap period.
+    /// @param receive_time CLOCK_MONOTONIC time of reception (ns).
+    /// @return CLOCK_MONOTONIC time of the sensor timestamp (ns).
+    std::uint64_t update(std::uint16_t sensor_stamp, std::uint64_t receive_time);
+
+    /// Check whether the drift has been measured over at least one window.
+    bool isSynchronized() const { return drift_measured_; }
+
+    /// Estimated drift of the host clock relative to the sensor clock (ppm).
+    double drift() const { return drift_ * 1e6; }
+
+    /// Estimated offset from the sensor time to CLOCK_MONOTONIC at the last sample (ns).
+    std::int64_t offset() const { return offsetAt(sensor_time_); }
+
+    /// Number of resynchronizations after a jump of the offset.
+    std::uint64_t resyncCount() const { return resync_count_; }
+
+    static constexpr std::int64_t window_duration = 2000000000;  ///< Sensor time spanned by a window (ns).
+    static constexpr std::size_t window_count = 8;               ///< Number of window minima the drift is measured across.
+    static constexpr std::int64_t resync_threshold = 100000000;  ///< Offset jump restarting the estimation (ns).
+    static constexpr double max_drift = 1e-3;                    ///< Bound of the drift estimate.
+
+private:
+    /// Offset predicted by the line at a sensor time.
+    std::int64_t offsetAt(std::int64_t sensor_time) const {
+        return anchor_offset_ + static_cast<std::int64_t>(drift_ * (sensor_time - anchor_sensor_time_));
+    }
+
+    /// Restart the estimation from a sample.
+    void restart(std::int64_t offset);
+
+    std::uint32_t wrap_period_;        ///< Period of the sensor timestamps (ms)
+    bool started_;                     ///< Whether a sample has been received since the last reset
+    std::uint16_t last_stamp_;         ///< Last raw sensor timestamp (ms)
+    std::int64_t sensor_time_;         ///< Unwrapped sensor time of the last sample (ns)
+    std::int64_t anchor_sensor_time_;  ///< Sensor time of the point the line goes through (ns)
+    std::int64_t anchor_offset_;       ///< Offset of the point the line goes through (ns)
+    double drift_;                     ///< Slope of the line
+    bool drift_measured_;              ///< Whether the drift has been measured
+    std::int64_t window_start_;        ///< Sensor time of the start of the current window (ns)
+    std::int64_t window_min_time_;     ///< Sensor time of the minimal offset of the current window (ns)
+    std::int64_t window_min_offset_;   ///< Minimal offset of the current window (ns)
+    /// Minima of the last complete windows, as sensor time and offset (ns), oldest at minima_head_.
+    std::array<std::array<std::int64_t, 2>, window_count> minima_;
+    std::size_t minima_count_;         ///< Number of valid minima
+    std::size_t minima_head_;          ///< Index of the oldest minimum once the ring is full
+    std::uint64_t resync_count_;       ///< Number of resynchronizations
+};
+
+} // namespace ldlidar
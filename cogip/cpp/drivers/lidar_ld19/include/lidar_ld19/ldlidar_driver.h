@@ -1,38 +1,38 @@
 #pragma once
 
+#include "lidar_driver/LidarDriver.hpp"
+#include "lidar_ld19/ldlidar_clock_sync.h"
 #include "lidar_ld19/ldlidar_datatype.h"
 #include "lidar_ld19/ldlidar_protocol.h"
-#include "shared_memory/WritePriorityLock.hpp"
+#include "serial_reader/SerialReader.hpp"
 
 #include <libserial/SerialPort.h>
 
-#include <nanobind/nanobind.h>
-#include <nanobind/ndarray.h>
-
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <functional>
 #include <mutex>
-#include <thread>
-
-namespace nb = nanobind;
 
 namespace ldlidar {
 
-constexpr size_t MAX_ACK_BUF_LEN = 512;
-constexpr std::size_t MAX_DATA_COUNT = 1024;
+using cogip::lidar_driver::MAX_DATA_COUNT;
+
+/// Capacity of the ring of received points, two revolutions.
+constexpr std::size_t SCAN_RING_SIZE = 2 * MAX_DATA_COUNT;
+
+/// Duration of the transfer of a point cloud data packet at 230400 bauds, 10 bits per byte (ns).
+constexpr uint64_t PCD_TRANSFER_TIME = PCD_PKG_SIZE * 10 * 1000000000ULL / 230400;
 
 uint64_t getSystemTimeStamp();
 
-class LDLidarDriver {
+/// Decoder of the LD19 frames, feeding the revolutions to the publish stage of LidarDriver.
+class LDLidarDriver : public cogip::lidar_driver::LidarDriver {
 public:
     /// Constructor with optional external memory pointer
     explicit LDLidarDriver(double (*external_lidar_data)[3] = nullptr);
 
-    /// Constructor accepting a nanobind::ndarray
-    explicit LDLidarDriver(nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>> external_lidar_data);
-
-    ~LDLidarDriver();
+    ~LDLidarDriver() override;
 
     /// Gets the running status of the LiDAR driver.
     /// @return `true` if the driver is running, `false` otherwise.
@@ -73,24 +73,15 @@ public:
     /// @return `true` if the driver stops successfully, `false` otherwise.
     bool stop();
 
-    /// Function executed in a thread to read and process data from serial port.
-    void rxThreadProc();
+    /// Set the scheduling of the serial reader thread, which decodes the frames and publishes the scans.
+    /// It is applied at each start and at once if the thread runs.
+    /// @throws std::invalid_argument if the configuration is invalid.
+    /// @throws std::runtime_error if the system refuses the configuration of the running thread.
+    void setRxThreadConfig(const cogip::utils::thread_config_t& config) { serial_reader_.setThreadConfig(config); }
 
-    /// Function executed after reading data on serial port.
+    /// Function executed by the serial reader thread with the bytes of each read.
     void commReadCallback(const char *byte, size_t len);
 
-    /// Set the minimum intensity value to validate data.
-    void setMinIntensity(uint8_t min_intensity) { min_intensity_ = min_intensity; }
-
-    /// Set the minimum distance to validate data.
-    void setMinDistance(uint16_t min_distance) { min_distance_ = min_distance; }
-
-    /// Set the maximum distance to validate data.
-    void setMaxDistance(uint16_t max_distance) { max_distance_ = max_distance; }
-
-    /// Get pointer to internal lidar points
-    const double (&getLidarData() const)[3] { return *lidar_data_; }
-
     /// Get Lidar spin speed (Hz)
     double getSpeed() const { return (speed_ / 360.0); };
 
@@ -100,24 +91,19 @@ public:
 
     bool getLidarPowerOnCommStatus();
 
+    /// Get the estimated drift of CLOCK_MONOTONIC relative to the lidar clock (ppm).
+    double getClockDrift() const { return clock_drift_.load(std::memory_order_relaxed); }
+
     void clearStatus() {
         is_frame_ready_ = false;
         is_poweron_comm_normal_ = false;
         lidar_status_ = LidarStatus::NORMAL;
         lidar_error_code_ = LIDAR_NO_ERROR;
-        last_pkg_timestamp_ = 0;
-        tmp_lidar_scan_data_vec_.clear();
-    }
-
-    /// Set the data write lock.
-    void setDataWriteLock(cogip::shared_memory::WritePriorityLock &lock) {
-        data_write_lock_ = &lock;
-    }
-
-    /// Set invalid angle range
-    void setInvalidAngleRange(uint16_t min_angle, uint16_t max_angle) {
-        min_angle_ = min_angle;
-        max_angle_ = max_angle;
+        clock_sync_.reset();
+        scan_ring_head_ = 0;
+        scan_start_ = 0;
+        scan_cursor_ = 0;
+        scan_last_angle_ = 0;
     }
 
 protected:
@@ -128,33 +114,34 @@ private:
     static bool is_ok_;
     LibSerial::SerialPort *comm_serial_;
     std::chrono::_V2::steady_clock::time_point last_pubdata_times_;
-    std::atomic<bool> rx_thread_exit_flag_;
-    std::thread *rx_thread_;
+    cogip::serial_reader::SerialReader serial_reader_;  ///< Reader thread of the serial port
     int lidar_measure_freq_;
     LidarStatus lidar_status_;
     uint8_t lidar_error_code_;
     bool is_frame_ready_;
-    bool external_data_;      ///< Flag to indicate if memory is externally managed
-    double (*lidar_data_)[3];  ///< Pointer to lidar data memory
-    cogip::shared_memory::WritePriorityLock *data_write_lock_;
-    uint8_t min_intensity_;
     uint16_t timestamp_;
-    uint16_t min_distance_;
-    uint16_t max_distance_;
-    uint16_t min_angle_;
-    uint16_t max_angle_;
     double speed_;
     bool is_poweron_comm_normal_;
-    uint64_t last_pkg_timestamp_;
+    ClockSync clock_sync_;               ///< Mapping of the packet timestamps onto CLOCK_MONOTONIC
+    std::atomic<double> clock_drift_;    ///< Last drift estimated by clock_sync_ (ppm)
     LdLidarProtocol *protocol_handle_;
-    Points2D tmp_lidar_scan_data_vec_;
+
+    /// Points received but not yet published, in stamp order.
+    /// Indexes are counters of pushed points, taken modulo SCAN_RING_SIZE to access the ring.
+    std::array<PointData, SCAN_RING_SIZE> scan_ring_;
+    uint64_t scan_ring_head_;    ///< Index of the next point to push.
+    uint64_t scan_start_;        ///< Index of the first point of the current revolution.
+    uint64_t scan_cursor_;       ///< Index of the next point to examine by assemblePacket().
+    float scan_last_angle_;      ///< Angle of the last examined point, 0 at the start of a revolution.
     std::mutex mutex_lock1_;
-    std::mutex mutex_lock2_;
 
     void commonInit();
 
     bool parse(const uint8_t *data, long len);
 
+    /// Push a received point in the scan ring, dropping the oldest point if the ring is full.
+    void pushScanPoint(const PointData &point);
+
     // Combine standard data into data frames and calibrate.
     bool assemblePacket();
 
@@ -167,7 +154,8 @@ private:
     // Set frame ready flag.
     void setFrameReady();
 
-    void setLaserScanData(Points2D &src);
+    /// Publish the points of the scan ring between two indexes.
+    void setLaserScanData(uint64_t start, uint64_t end);
 };
 
 } // namespace ldlidar
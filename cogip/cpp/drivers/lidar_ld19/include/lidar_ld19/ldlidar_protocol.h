@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 namespace ldlidar {
 
@@ -10,11 +13,6 @@ namespace ldlidar {
 #define HEALTH_PKG_INFO 0xE0
 #define MANUFACT_PKG_INF 0x0F
 
-#define GET_PKG_PCD 1
-#define GET_PKG_HEALTH 2
-#define GET_PKG_MANUFACT 3
-#define GET_PKG_ERROR 0
-
 typedef struct __attribute__((packed)) {
     uint8_t header;
     uint8_t information;
@@ -32,7 +30,8 @@ typedef struct __attribute__((packed)) {
     uint8_t intensity;
 } LidarPointStructType;
 
-typedef struct __attribute__((packed)) {
+// Packets are read in place from the serial buffer.
+typedef struct __attribute__((packed, may_alias)) {
     uint8_t header;
     uint8_t ver_len;
     uint16_t speed;
@@ -50,6 +49,18 @@ typedef struct __attribute__((packed)) {
     uint8_t crc8;
 } LiDARHealthInfoType;
 
+/// Size of a point cloud data packet.
+constexpr std::size_t PCD_PKG_SIZE = sizeof(LiDARMeasureDataType);
+
+uint8_t calCRC8(const uint8_t *data, uint16_t data_len);
+
+/// Parser of the LD19 serial stream.
+///
+/// Each chunk read from the serial port is scanned for packet headers with memchr(),
+/// point cloud packets are validated and handed over in place, without copy.
+/// Only a packet split between two chunks is copied, to be completed by the next chunk.
+/// Health and manufacture information packets are skipped.
+/// All the parser state is held by the instance, so several lidars can be parsed in one process.
 class LdLidarProtocol {
 public:
     /// Constructor.
@@ -58,24 +69,89 @@ public:
     /// Destructor
     ~LdLidarProtocol();
 
-    /// Analyzes a single byte of data to identify and process LiDAR data packets.
-    /// @param byte Input byte from the serial data stream.
-    /// @return One of the following status codes:
-    /// - `GET_PKG_PCD`: Point cloud data packet received successfully.
-    /// - `GET_PKG_HEALTH`: Health information packet received successfully.
-    /// - `GET_PKG_MANUFACT`: Manufacturing information packet received successfully.
-    uint8_t analyzeDataPacket(uint8_t byte);
+    /// Parses a chunk of the serial data stream.
+    /// @param data Bytes read from the serial port.
+    /// @param len Number of bytes.
+    /// @param on_packet Function called with each valid point cloud data packet,
+    ///                  the packet is only valid during the call.
+    /// @return The number of point cloud data packets rejected because of their CRC.
+    template <typename OnPacket>
+    std::size_t parse(const uint8_t *data, std::size_t len, OnPacket &&on_packet);
 
-    /// Retrieves the latest point cloud data packet.
-    /// @return A reference to the point cloud data structure.
-    LiDARMeasureDataType &getPCDPacketData(void);
+    /// Checks that a complete packet starting with a header is a valid point cloud data packet.
+    static bool isValidPCDPacket(const uint8_t *packet) {
+        return packet[1] == DATA_PKG_INFO && calCRC8(packet, PCD_PKG_SIZE - 1) == packet[PCD_PKG_SIZE - 1];
+    }
+
+    /// Checks whether a complete packet starting with a header is a point cloud data packet with a wrong CRC.
+    static bool isCorruptedPCDPacket(const uint8_t *packet) {
+        return packet[1] == DATA_PKG_INFO && calCRC8(packet, PCD_PKG_SIZE - 1) != packet[PCD_PKG_SIZE - 1];
+    }
 
 private:
-    LiDARMeasureDataType pcdpkg_data_;
-    LiDARHealthInfoType healthpkg_data_;
-    LiDARManufactureInfoType manufacinfpkg_data_;
+    uint8_t pending_[PCD_PKG_SIZE];  ///< Beginning of a packet split between two chunks
+    std::size_t pending_size_;       ///< Number of bytes in pending_
 };
 
-uint8_t calCRC8(const uint8_t *data, uint16_t data_len);
+template <typename OnPacket>
+std::size_t LdLidarProtocol::parse(const uint8_t *data, std::size_t len, OnPacket &&on_packet) {
+    std::size_t rejected = 0;
+
+    // Complete the packet started at the end of the previous chunk,
+    // pending_ never holds a complete packet.
+    while (pending_size_ > 0 && pending_size_ < PCD_PKG_SIZE) {
+        std::size_t needed = PCD_PKG_SIZE - pending_size_;
+        std::size_t copied = std::min(len, needed);
+        std::memcpy(pending_ + pending_size_, data, copied);
+        if (copied < needed) {
+            pending_size_ += copied;
+            return rejected;
+        }
+        if (isValidPCDPacket(pending_)) {
+            on_packet(*reinterpret_cast<const LiDARMeasureDataType *>(pending_));
+            data += needed;
+            len -= needed;
+            pending_size_ = 0;
+            break;
+        }
+        if (pending_[1] == DATA_PKG_INFO) {
+            rejected++;
+        }
+        // Not a packet: resynchronize on the next header of the pending bytes, if any,
+        // otherwise scan the chunk from its beginning.
+        const void *next = std::memchr(pending_ + 1, PKG_HEADER, pending_size_ - 1);
+        if (next == nullptr) {
+            pending_size_ = 0;
+            break;
+        }
+        std::size_t offset = static_cast<const uint8_t *>(next) - pending_;
+        std::memmove(pending_, next, pending_size_ - offset);
+        pending_size_ -= offset;
+    }
+
+    const uint8_t *end = data + len;
+    while (data < end) {
+        const uint8_t *header = static_cast<const uint8_t *>(std::memchr(data, PKG_HEADER, end - data));
+        if (header == nullptr) {
+            return rejected;
+        }
+        if (static_cast<std::size_t>(end - header) < PCD_PKG_SIZE) {
+            pending_size_ = end - header;
+            std::memcpy(pending_, header, pending_size_);
+            return rejected;
+        }
+        if (isValidPCDPacket(header)) {
+            on_packet(*reinterpret_cast<const LiDARMeasureDataType *>(header));
+            data = header + PCD_PKG_SIZE;
+        }
+        else {
+            if (header[1] == DATA_PKG_INFO) {
+                rejected++;
+            }
+            data = header + 1;
+        }
+    }
+    return rejected;
+}
 
 } // namespace ldlidar
@@ -0,0 +1,97 @@
+#include "lidar_ld19/ldlidar_clock_sync.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ldlidar {
+
+ClockSync::ClockSync(std::uint32_t wrap_period):
+    wrap_period_(wrap_period),
+    resync_count_(0)
+{
+    reset();
+}
+
+void ClockSync::reset() {
+    started_ = false;
+    last_stamp_ = 0;
+    sensor_time_ = 0;
+    drift_ = 0;
+    drift_measured_ = false;
+    restart(0);
+}
+
+void ClockSync::restart(std::int64_t offset) {
+    anchor_sensor_time_ = sensor_time_;
+    anchor_offset_ = offset;
+    window_start_ = sensor_time_;
+    window_min_time_ = sensor_time_;
+    window_min_offset_ = offset;
+    minima_count_ = 0;
+    minima_head_ = 0;
+}
+
+std::uint64_t ClockSync::update(std::uint16_t sensor_stamp, std::uint64_t receive_time) {
+    if (!started_) {
+        started_ = true;
+        last_stamp_ = sensor_stamp;
+        sensor_time_ = 0;
+        restart(static_cast<std::int64_t>(receive_time));
+        return receive_time;
+    }
+
+    std::uint32_t elapsed = (sensor_stamp + wrap_period_ - last_stamp_ % wrap_period_) % wrap_period_;
+    last_stamp_ = sensor_stamp;
+    sensor_time_ += static_cast<std::int64_t>(elapsed) * 1000000;
+
+    std::int64_t offset = static_cast<std::int64_t>(receive_time) - sensor_time_;
+    std::int64_t residual = offset - offsetAt(sensor_time_);
+
+    if (std::llabs(residual) > resync_threshold) {
+        // The sensor restarted or the stream stalled longer than a wrap period, the drift is kept.
+        resync_count_++;
+        restart(offset);
+        return receive_time;
+    }
+
+    if (residual < 0) {
+        // Received earlier than predicted: the line was above the envelope.
+        anchor_sensor_time_ = sensor_time_;
+        anchor_offset_ = offset;
+    }
+
+    if (offset - window_min_offset_ < static_cast<std::int64_t>(drift_ * (sensor_time_ - window_min_time_))) {
+        window_min_time_ = sensor_time_;
+        window_min_offset_ = offset;
+    }
+
+    if (sensor_time_ - window_start_ >= window_duration) {
+        if (minima_count_ > 0) {
+            const std::array<std::int64_t, 2>& oldest = minima_[minima_head_];
+            double measured = static_cast<double>(window_min_offset_ - oldest[1]) / (window_min_time_ - oldest[0]);
+            drift_ = std::clamp(measured, -max_drift, max_drift);
+            drift_measured_ = true;
+        }
+        // The line can only move down between windows, raise it to the window minimum
+        // in case the drift was underestimated.
+        if (window_min_offset_ > offsetAt(window_min_time_)) {
+            anchor_sensor_time_ = window_min_time_;
+            anchor_offset_ = window_min_offset_;
+        }
+        if (minima_count_ < window_count) {
+            minima_[minima_count_++] = { window_min_time_, window_min_offset_ };
+        }
+        else {
+            minima_[minima_head_] = { window_min_time_, window_min_offset_ };
+            minima_head_ = (minima_head_ + 1) % window_count;
+        }
+        window_start_ = sensor_time_;
+        window_min_time_ = sensor_time_;
+        window_min_offset_ = offset;
+    }
+
+    // Sensor timestamps are truncated to the millisecond, map the middle of the millisecond.
+    return static_cast<std::uint64_t>(sensor_time_ + offsetAt(sensor_time_) + 500000);
+}
+
+} // namespace ldlidar
@@ -1,21 +1,25 @@
 #include "lidar_ld19/ldlidar_driver.h"
 #include "lidar_ld19/ldlidar_protocol.h"
+#include "logger/Trace.hpp"
 
 #include <libserial/SerialPortConstants.h>
 
 #include <unistd.h>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <map>
 #include <numeric>
+#include <stdexcept>
+#include <string>
 
 namespace ldlidar {
 
-constexpr size_t FILTERED_DATA_COUNT = 360;
-
 uint64_t getSystemTimeStamp() {
-    std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> tp =
-        std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now());
+    // steady_clock is CLOCK_MONOTONIC, the clock of the pose buffer timestamps.
+    std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds> tp =
+        std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now());
     auto tmp = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch());
     return ((uint64_t)tmp.count());
 }
@@ -23,25 +27,8 @@ uint64_t getSystemTimeStamp() {
 bool LDLidarDriver::is_ok_ = false;
 
 LDLidarDriver::LDLidarDriver(double (*external_lidar_data)[3]):
-    lidar_data_(external_lidar_data),
-    external_data_(external_lidar_data != nullptr)
-{
-    if (!external_data_) {
-        // Allocate memory if external pointer is not provided
-        lidar_data_ = new double[MAX_DATA_COUNT][3]();
-    }
-
-    commonInit();
-}
-
-LDLidarDriver::LDLidarDriver(nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>> external_lidar_raw_points):
-    lidar_data_(reinterpret_cast<double(*)[3]>(external_lidar_raw_points.data())),
-    external_data_(true)
+    LidarDriver(external_lidar_data)
 {
-    if (!lidar_data_) {
-        throw std::runtime_error("Failed to initialize from external NumPy array.");
-    }
-
     commonInit();
 }
 
@@ -52,16 +39,10 @@ void LDLidarDriver::commonInit() {
     lidar_status_ = LidarStatus::NORMAL;
     lidar_error_code_ = LIDAR_NO_ERROR;
     is_frame_ready_ = false;
-    data_write_lock_ = nullptr;
-    min_intensity_ = 0;
-    min_distance_ = 0;
-    max_distance_ = std::numeric_limits<uint16_t>::max();
-    min_angle_ = 0;
-    max_angle_ = 360;
     timestamp_ = 0;
     speed_ = 0;
     is_poweron_comm_normal_ = false;
-    last_pkg_timestamp_ = 0;
+    clock_drift_ = 0;
 
     last_pubdata_times_ = std::chrono::steady_clock::now();
     comm_serial_ = new LibSerial::SerialPort();
@@ -69,6 +50,9 @@ void LDLidarDriver::commonInit() {
 };
 
 LDLidarDriver::~LDLidarDriver() {
+    // The reader thread uses the serial port and the protocol handle, stop it first.
+    serial_reader_.stop();
+
     if (protocol_handle_ != nullptr) {
         delete protocol_handle_;
     }
@@ -76,11 +60,6 @@ LDLidarDriver::~LDLidarDriver() {
     if (comm_serial_ != nullptr) {
         delete comm_serial_;
     }
-
-    if (!external_data_) {
-        // Deallocate memory only if it was internally allocated
-        delete[] lidar_data_;
-    }
 }
 
 bool LDLidarDriver::connect(const std::string &serial_port_name) {
@@ -103,8 +82,9 @@ bool LDLidarDriver::connect(const std::string &serial_port_name) {
     comm_serial_->SetBaudRate(LibSerial::BaudRate::BAUD_230400);
 
     is_connect_flag_ = true;
-    rx_thread_exit_flag_ = false;
-    rx_thread_ = new std::thread(&LDLidarDriver::rxThreadProc, this);
+    serial_reader_.start(comm_serial_->GetFileDescriptor(), [this](const uint8_t *data, std::size_t len) {
+        commReadCallback(reinterpret_cast<const char *>(data), len);
+    });
 
     setLidarDriverStatus(true);
 
@@ -116,30 +96,16 @@ bool LDLidarDriver::disconnect() {
         return true;
     }
 
-    rx_thread_exit_flag_ = true;
-
     setLidarDriverStatus(false);
 
     is_connect_flag_ = false;
-    if ((rx_thread_ != nullptr) && rx_thread_->joinable()) {
-        rx_thread_->join();
-        delete rx_thread_;
-        rx_thread_ = nullptr;
-    }
+    serial_reader_.stop();
 
     comm_serial_->Close();
 
     return true;
 }
 
-void LDLidarDriver::rxThreadProc() {
-    std::string rx_buf;
-    while (!rx_thread_exit_flag_.load()) {
-        comm_serial_->Read(rx_buf, MAX_ACK_BUF_LEN);
-        commReadCallback(rx_buf.c_str(), MAX_ACK_BUF_LEN);
-   }
-}
-
 bool LDLidarDriver::waitLidarComm(int64_t timeout) {
     auto last_time = std::chrono::steady_clock::now();
 
@@ -212,107 +178,102 @@ bool LDLidarDriver::stop() {
 
 
 bool LDLidarDriver::parse(const uint8_t *data, long len) {
-    for (int i = 0; i < len; i++) {
-        uint8_t ret = protocol_handle_->analyzeDataPacket(data[i]);
-        if (ret == GET_PKG_PCD) {
-            LiDARMeasureDataType datapkg = protocol_handle_->getPCDPacketData();
-            is_poweron_comm_normal_ = true;
-            speed_ = datapkg.speed;
-            timestamp_ = datapkg.timestamp;
-            // parse a package is success
-            double diff = (datapkg.end_angle / 100 - datapkg.start_angle / 100 + 360) % 360;
-            if (diff <= ((double)datapkg.speed * POINT_PER_PACK / lidar_measure_freq_ * 1.5)) {
-                if (0 == last_pkg_timestamp_) {
-                    last_pkg_timestamp_ = getSystemTimeStamp();
-                }
-                else {
-                    uint64_t current_pack_stamp = getSystemTimeStamp();
-                    int pkg_point_number = POINT_PER_PACK;
-                    double pack_stamp_point_step =
-                        static_cast<double>(current_pack_stamp - last_pkg_timestamp_) / static_cast<double>(pkg_point_number - 1);
-                    uint32_t diff = ((uint32_t)datapkg.end_angle + 36000 - (uint32_t)datapkg.start_angle) % 36000;
-                    float step = diff / (POINT_PER_PACK - 1) / 100.0;
-                    float start = (double)datapkg.start_angle / 100.0;
-                    PointData data;
-                    for (int i = 0; i < POINT_PER_PACK; i++) {
-                        data.distance = datapkg.point[i].distance;
-                        data.angle = start + i * step;
-                        if (data.angle >= 360.0) {
-                            data.angle -= 360.0;
-                        }
-                        data.intensity = datapkg.point[i].intensity;
-                        data.stamp = static_cast<uint64_t>(last_pkg_timestamp_ + (pack_stamp_point_step * i));
-                        tmp_lidar_scan_data_vec_.push_back(PointData(data.angle, data.distance, data.intensity, data.stamp));
-                    }
-                    last_pkg_timestamp_ = current_pack_stamp; // update last pkg timestamp
-                }
+    // Packets of a chunk are received at once, the clock sync keeps the earliest receptions only.
+    const uint64_t received_time = getSystemTimeStamp() - PCD_TRANSFER_TIME;
+    std::size_t rejected = protocol_handle_->parse(data, len, [this, received_time](const LiDARMeasureDataType &datapkg) {
+        countPacket(true, received_time);
+        is_poweron_comm_normal_ = true;
+        speed_ = datapkg.speed;
+        timestamp_ = datapkg.timestamp;
+        // The sensor stamps the packet after its last point.
+        uint64_t pack_stamp = clock_sync_.update(datapkg.timestamp, received_time);
+        clock_drift_.store(clock_sync_.drift(), std::memory_order_relaxed);
+        // parse a package is success
+        double diff = (datapkg.end_angle / 100 - datapkg.start_angle / 100 + 360) % 360;
+        if (diff > ((double)datapkg.speed * POINT_PER_PACK / lidar_measure_freq_ * 1.5)) {
+            return;
+        }
+        // Points are measured at a fixed rate.
+        uint64_t point_period = 1000000000ULL / lidar_measure_freq_;
+        uint32_t angle_diff = ((uint32_t)datapkg.end_angle + 36000 - (uint32_t)datapkg.start_angle) % 36000;
+        float step = angle_diff / (POINT_PER_PACK - 1) / 100.0;
+        float start = (double)datapkg.start_angle / 100.0;
+        for (int i = 0; i < POINT_PER_PACK; i++) {
+            float angle = start + i * step;
+            if (angle >= 360.0) {
+                angle -= 360.0;
             }
+            pushScanPoint(PointData(
+                angle,
+                datapkg.point[i].distance,
+                datapkg.point[i].intensity,
+                pack_stamp - (POINT_PER_PACK - 1 - i) * point_period
+            ));
         }
+    });
+    for (std::size_t i = 0; i < rejected; i++) {
+        countPacket(false, 0);
     }
 
     return true;
 }
 
-bool LDLidarDriver::assemblePacket() {
-    float last_angle = 0;
-    Points2D data;
-    int count = 0;
+void LDLidarDriver::pushScanPoint(const PointData &point) {
+    if (scan_ring_head_ - scan_start_ == SCAN_RING_SIZE) {
+        scan_start_++;
+        scan_cursor_ = std::max(scan_cursor_, scan_start_);
+        scan_last_angle_ = 0;
+    }
+    scan_ring_[scan_ring_head_ % SCAN_RING_SIZE] = point;
+    scan_ring_head_++;
+}
 
+bool LDLidarDriver::assemblePacket() {
     if (speed_ <= 0) {
-        tmp_lidar_scan_data_vec_.erase(tmp_lidar_scan_data_vec_.begin(), tmp_lidar_scan_data_vec_.end());
+        scan_start_ = scan_cursor_ = scan_ring_head_;
+        scan_last_angle_ = 0;
         return false;
     }
 
-    for (auto n : tmp_lidar_scan_data_vec_) {
-        // Wait for enough data, need enough data to show a circle enough data has been obtained.
-        if ((n.angle < 20.0) && (last_angle > 340.0)) {
-            if ((count * getSpeed()) > (lidar_measure_freq_ * 1.4)) {
-                if (count >= (int)tmp_lidar_scan_data_vec_.size()) {
-                    tmp_lidar_scan_data_vec_.clear();
-                }
-                else {
-                    tmp_lidar_scan_data_vec_.erase(
-                        tmp_lidar_scan_data_vec_.begin(),
-                        tmp_lidar_scan_data_vec_.begin() + count
-                    );
-                }
-                return false;
-            }
-            data.insert(data.begin(), tmp_lidar_scan_data_vec_.begin(), tmp_lidar_scan_data_vec_.begin() + count);
+    // Only points received since the last call are examined.
+    for (; scan_cursor_ < scan_ring_head_; scan_cursor_++) {
+        const PointData &point = scan_ring_[scan_cursor_ % SCAN_RING_SIZE];
+        uint64_t count = scan_cursor_ - scan_start_;
 
-            std::sort(data.begin(), data.end(), [](PointData a, PointData b) { return a.stamp < b.stamp; });
-            if (data.size() > 0) {
-                setLaserScanData(data);
+        // Wait for enough data, need enough data to show a circle enough data has been obtained.
+        if ((point.angle < 20.0) && (scan_last_angle_ > 340.0)) {
+            // This point starts the next revolution.
+            bool complete = (count * getSpeed()) <= (lidar_measure_freq_ * 1.4);
+            if (complete) {
+                // Points are pushed in stamp order, the revolution is published straight from the ring.
+                setLaserScanData(scan_start_, scan_cursor_);
                 setFrameReady();
-
-                if (count >= (int)tmp_lidar_scan_data_vec_.size()) {
-                    tmp_lidar_scan_data_vec_.clear();
-                }
-                else {
-                    tmp_lidar_scan_data_vec_.erase(tmp_lidar_scan_data_vec_.begin(), tmp_lidar_scan_data_vec_.begin() + count);
-                }
+            }
+            scan_start_ = scan_cursor_;
+            scan_last_angle_ = 0;
+            if (complete) {
+                // The starting point is examined again on the next call.
                 return true;
             }
+            countDroppedRevolution();
+            count = 0;
         }
-        count++;
 
-        if ((count * getSpeed()) > (lidar_measure_freq_ * 2)) {
-            if (count >= (int)tmp_lidar_scan_data_vec_.size()) {
-                tmp_lidar_scan_data_vec_.clear();
-            }
-            else {
-                tmp_lidar_scan_data_vec_.erase(tmp_lidar_scan_data_vec_.begin(), tmp_lidar_scan_data_vec_.begin() + count);
-            }
-            return false;
+        if (((count + 1) * getSpeed()) > (lidar_measure_freq_ * 2)) {
+            countDroppedRevolution();
+            scan_start_ = scan_cursor_ + 1;
+            scan_last_angle_ = 0;
+            continue;
         }
 
-        last_angle = n.angle;
+        scan_last_angle_ = point.angle;
     }
 
     return false;
 }
 
 void LDLidarDriver::commReadCallback(const char *byte, size_t len) {
+    countBytesRead(len);
     if (parse((uint8_t *)byte, len)) {
         assemblePacket();
     }
@@ -343,49 +304,16 @@ void LDLidarDriver::setFrameReady() {
     is_frame_ready_ = true;
 }
 
-void LDLidarDriver::setLaserScanData(Points2D &src) {
-    std::lock_guard<std::mutex> lg(mutex_lock2_);
-    std::array<std::vector<uint16_t>, FILTERED_DATA_COUNT> tmp_distances;
-    std::array<std::vector<uint8_t>, FILTERED_DATA_COUNT> tmp_intensities;
-    std::size_t count = 0;
-
-    if (data_write_lock_ != nullptr) {
-        data_write_lock_->startWriting();
-    }
-
-    for (const auto &point: src) {
-        if (point.intensity < min_intensity_) {
-            continue;
-        }
-        if (point.distance < min_distance_) {
-            continue;
-        }
-        if (point.distance > max_distance_) {
-            continue;
-        }
-
-        double angle = 360 - point.angle; // Lidar angle is inverted
-
-        // Skip excluded angles
-        if (angle > min_angle_ && angle < max_angle_) {
-            continue;
-        }
-
-        lidar_data_[count][0] = angle;
-        lidar_data_[count][1] = point.distance;
-        lidar_data_[count][2] = point.intensity;
-        count++;
-    }
-
-    // Mark as end of data
-    lidar_data_[count][0] = -1.0;
-    lidar_data_[count][1] = -1.0;
-    lidar_data_[count][2] = -1.0;
+void LDLidarDriver::setLaserScanData(uint64_t start, uint64_t end) {
+    COGIP_TRACE_SPAN("LDLidarDriver::setLaserScanData");
 
-    if (data_write_lock_ != nullptr) {
-        data_write_lock_->finishWriting();
-        data_write_lock_->postUpdate();
+    beginScan(scan_ring_[start % SCAN_RING_SIZE].stamp);
+    for (uint64_t index = start; index < end; index++) {
+        const PointData &point = scan_ring_[index % SCAN_RING_SIZE];
+        // Lidar angle is inverted
+        addPoint(360 - point.angle, point.distance, point.intensity, point.stamp);
     }
+    publishScan(scan_ring_[(end - 1) % SCAN_RING_SIZE].stamp);
 }
 
 } // namespace ldlidar
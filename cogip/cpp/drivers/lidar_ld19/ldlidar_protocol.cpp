@@ -1,7 +1,5 @@
 #include "lidar_ld19/ldlidar_protocol.h"
 
-#include <cstring>
-
 namespace ldlidar {
 
 // LD protocol
@@ -40,130 +38,12 @@ uint8_t calCRC8(const uint8_t *data, uint16_t data_len) {
 }
 // << LD protocol
 
-LdLidarProtocol::LdLidarProtocol() {
+LdLidarProtocol::LdLidarProtocol():
+    pending_size_(0)
+{
 }
 
 LdLidarProtocol::~LdLidarProtocol() {
 }
 
-uint8_t LdLidarProtocol::analyzeDataPacket(uint8_t byte) {
-    static enum {
-        HEADER,
-        VER_LEN,
-        DATA,
-        DATA_HEALTH,
-        DATA_MANUFACTURE,
-    } state = HEADER;
-    static uint16_t count = 0;
-    static uint8_t tmp[128] = { 0 };
-    static uint16_t pkg_count = sizeof(LiDARMeasureDataType);
-    static uint16_t pkghealth_count = sizeof(LiDARHealthInfoType);
-    static uint16_t pkgmanufac_count = sizeof(LiDARManufactureInfoType);
-    static bool check_healthinf_flag = false;
-
-    switch (state) {
-    case HEADER: {
-        if (byte == PKG_HEADER) {
-            tmp[count++] = byte;
-            state = VER_LEN;
-        }
-        else {
-            if (check_healthinf_flag) {
-                check_healthinf_flag = false;
-            }
-        }
-        break;
-    }
-    case VER_LEN: {
-        if (byte == DATA_PKG_INFO) {
-            tmp[count++] = byte;
-            state = DATA;
-            if (check_healthinf_flag) {
-                check_healthinf_flag = false;
-                return GET_PKG_HEALTH;
-            }
-        }
-        else if (byte == HEALTH_PKG_INFO) {
-            tmp[count++] = byte;
-            state = DATA_HEALTH;
-            if (check_healthinf_flag) {
-                check_healthinf_flag = false;
-                return GET_PKG_HEALTH;
-            }
-        }
-        else if (byte == MANUFACT_PKG_INF) {
-            tmp[count++] = byte;
-            state = DATA_MANUFACTURE;
-        }
-        else {
-            state = HEADER;
-            count = 0;
-            if (check_healthinf_flag) {
-                check_healthinf_flag = false;
-            }
-            return GET_PKG_ERROR;
-        }
-        break;
-    }
-    case DATA: {
-        tmp[count++] = byte;
-        if (count >= pkg_count) {
-            memcpy((uint8_t*)&pcdpkg_data_, tmp, pkg_count);
-            uint8_t crc = calCRC8((uint8_t*)&pcdpkg_data_, pkg_count - 1);
-            state = HEADER;
-            count = 0;
-            if (crc == pcdpkg_data_.crc8) {
-                return GET_PKG_PCD;
-            }
-            else {
-                return GET_PKG_ERROR;
-            }
-        }
-        break;
-    }
-    case DATA_HEALTH: {
-        tmp[count++] = byte;
-        if (count >= pkghealth_count) {
-            memcpy((uint8_t*)&healthpkg_data_, tmp, pkghealth_count);
-            uint8_t crc = calCRC8((uint8_t*)&healthpkg_data_, pkghealth_count - 1);
-            state = HEADER;
-            count = 0;
-            if (crc == healthpkg_data_.crc8) {
-                check_healthinf_flag = true;
-            }
-            else {
-                check_healthinf_flag = false;
-            }
-            return GET_PKG_ERROR;
-        }
-        break;
-    }
-    case DATA_MANUFACTURE: {
-        tmp[count++] = byte;
-        if (count >= pkgmanufac_count) {
-            memcpy((uint8_t*)&manufacinfpkg_data_, tmp, pkgmanufac_count);
-            uint8_t crc = calCRC8((uint8_t*)&manufacinfpkg_data_, pkgmanufac_count - 1);
-            state = HEADER;
-            count = 0;
-            if (crc == manufacinfpkg_data_.crc8) {
-                return GET_PKG_MANUFACT;
-            }
-            else {
-                return GET_PKG_ERROR;
-            }
-        }
-        break;
-    }
-    default: {
-        break;
-    }
-    }
-
-    return GET_PKG_ERROR;
-}
-
-LiDARMeasureDataType& LdLidarProtocol::getPCDPacketData(void) {
-    return pcdpkg_data_;
-}
-
 } // namespace ldlidar
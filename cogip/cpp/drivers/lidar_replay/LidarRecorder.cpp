@@ -0,0 +1,115 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "lidar_replay/LidarRecorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace lidar_replay {
+
+LidarRecorder::LidarRecorder(const std::string& name):
+    shared_memory_(name, false),
+    data_lock_(shared_memory_.getLock(shared_memory::LockName::LidarData)),
+    history_reader_(shared_memory_),
+    running_(false),
+    scan_count_(0),
+    pose_count_(0),
+    missed_scan_count_(0),
+    last_pose_timestamp_(0),
+    scan_(std::make_unique<ScanCopy>())
+{
+    poses_.reserve(models::POSE_BUFFER_SIZE_MAX);
+    pose_timestamps_.reserve(models::POSE_BUFFER_SIZE_MAX);
+}
+
+LidarRecorder::~LidarRecorder()
+{
+    stop();
+}
+
+void LidarRecorder::start(const std::string& path)
+{
+    if (running_.load(std::memory_order_acquire)) {
+        throw std::runtime_error("LidarRecorder: already recording");
+    }
+
+    writer_ = std::make_unique<LidarRecordingWriter>(path);
+    scan_count_.store(0, std::memory_order_relaxed);
+    pose_count_.store(0, std::memory_order_relaxed);
+    missed_scan_count_.store(0, std::memory_order_relaxed);
+
+    // Only the poses and scans published from now on are recorded.
+    last_pose_timestamp_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+    history_reader_.skipToLatest();
+    history_reader_.resetDroppedCount();
+    data_lock_.registerConsumer();
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&LidarRecorder::run, this);
+}
+
+void LidarRecorder::stop()
+{
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();  // At the latest after its wait timeout
+    }
+    recordPoses();
+    writer_.reset();
+}
+
+void LidarRecorder::run()
+{
+    while (running_.load(std::memory_order_relaxed)) {
+        bool updated = data_lock_.waitUpdate(LIDAR_RECORDER_WAIT_TIMEOUT);
+
+        // Poses are recorded first, so those used to convert the scans precede them in the file.
+        recordPoses();
+        if (!updated) {
+            continue;
+        }
+
+        std::uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+        // Scans published while the previous ones were written are still in the history.
+        while (history_reader_.readNext(scan_->data, scan_->header)) {
+            // Scans read late keep their publication time if the driver knows it.
+            std::uint64_t timestamp = scan_->header.end_timestamp ? std::min(scan_->header.end_timestamp, now) : now;
+            writer_->writeScan(timestamp, scan_->data, scan_->header);
+            scan_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        writer_->flush();
+        missed_scan_count_.store(history_reader_.droppedCount(), std::memory_order_relaxed);
+    }
+}
+
+void LidarRecorder::recordPoses()
+{
+    shared_memory_.readPoseCurrentSince(last_pose_timestamp_, poses_, pose_timestamps_);
+    for (std::size_t index = 0; index < poses_.size(); index++) {
+        writer_->writePose({
+            pose_timestamps_[index],
+            static_cast<float>(poses_[index].x),
+            static_cast<float>(poses_[index].y),
+            static_cast<float>(poses_[index].angle)
+        });
+    }
+    if (!poses_.empty()) {
+        last_pose_timestamp_ = pose_timestamps_.back();
+        pose_count_.fetch_add(poses_.size(), std::memory_order_relaxed);
+    }
+}
+
+} // namespace lidar_replay
+
+} // namespace cogip
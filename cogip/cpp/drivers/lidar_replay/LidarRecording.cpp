@@ -0,0 +1,183 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "lidar_replay/LidarRecording.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace lidar_replay {
+
+namespace {
+
+/// Writes a field in host byte order.
+template <typename T>
+void writeField(std::FILE* file, const T& value)
+{
+    std::fwrite(&value, sizeof(T), 1, file);
+}
+
+/// Reads a field in host byte order.
+/// @return False if the end of the file was reached.
+template <typename T>
+bool readField(std::FILE* file, T& value)
+{
+    return std::fread(&value, sizeof(T), 1, file) == 1;
+}
+
+} // namespace
+
+LidarRecordingWriter::LidarRecordingWriter(const std::string& path):
+    file_(std::fopen(path.c_str(), "wb"))
+{
+    if (!file_) {
+        throw std::runtime_error("Cannot create lidar recording " + path + ": " + std::strerror(errno));
+    }
+    std::fwrite(RECORDING_MAGIC, sizeof(RECORDING_MAGIC), 1, file_);
+    writeField(file_, RECORDING_VERSION);
+}
+
+LidarRecordingWriter::~LidarRecordingWriter()
+{
+    std::fclose(file_);
+}
+
+std::size_t LidarRecordingWriter::writeScan(
+    std::uint64_t timestamp,
+    const shared_memory::lidar_data_t& data,
+    const shared_memory::lidar_scan_header_t& header)
+{
+    std::uint32_t count = std::min<std::uint32_t>(header.point_count, shared_memory::MAX_LIDAR_DATA_COUNT - 1);
+
+    writeField(file_, RecordType::Scan);
+    writeField(file_, timestamp);
+    writeField(file_, header.start_timestamp);
+    writeField(file_, header.end_timestamp);
+    writeField(file_, header.source);
+    writeField(file_, count);
+    for (std::uint32_t index = 0; index < count; index++) {
+        recorded_point_t point = {
+            static_cast<float>(data[index][0]),
+            static_cast<float>(data[index][1]),
+            static_cast<float>(data[index][2]),
+            header.point_offsets[index]
+        };
+        writeField(file_, point.angle);
+        writeField(file_, point.distance);
+        writeField(file_, point.intensity);
+        writeField(file_, point.offset);
+    }
+    return count;
+}
+
+void LidarRecordingWriter::writePose(const recorded_pose_t& pose)
+{
+    writeField(file_, RecordType::Pose);
+    writeField(file_, pose.timestamp);
+    writeField(file_, pose.x);
+    writeField(file_, pose.y);
+    writeField(file_, pose.angle);
+}
+
+void LidarRecordingWriter::flush()
+{
+    std::fflush(file_);
+}
+
+LidarRecording::LidarRecording(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("Cannot open lidar recording " + path + ": " + std::strerror(errno));
+    }
+
+    char magic[sizeof(RECORDING_MAGIC)];
+    std::uint32_t version = 0;
+    if (std::fread(magic, sizeof(magic), 1, file) != 1
+        || std::memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0
+        || !readField(file, version)) {
+        std::fclose(file);
+        throw std::runtime_error("Not a lidar recording: " + path);
+    }
+    if (version != 1 && version != RECORDING_VERSION) {
+        std::fclose(file);
+        throw std::runtime_error(
+            "Unsupported lidar recording version " + std::to_string(version) + ": " + path
+        );
+    }
+
+    RecordType type;
+    while (readField(file, type)) {
+        if (type == RecordType::Scan) {
+            recorded_scan_t scan;
+            scan.source = 0;
+            std::uint32_t count = 0;
+            if (!readField(file, scan.timestamp) || !readField(file, scan.start_timestamp)
+                || !readField(file, scan.end_timestamp) || (version > 1 && !readField(file, scan.source))
+                || !readField(file, count)
+                || count >= shared_memory::MAX_LIDAR_DATA_COUNT) {
+                break;
+            }
+            scan.points.resize(count);
+            bool complete = true;
+            for (recorded_point_t& point : scan.points) {
+                complete = readField(file, point.angle) && readField(file, point.distance)
+                    && readField(file, point.intensity) && readField(file, point.offset);
+                if (!complete) {
+                    break;
+                }
+            }
+            if (!complete) {
+                break;
+            }
+            scans_.push_back(std::move(scan));
+        }
+        else if (type == RecordType::Pose) {
+            recorded_pose_t pose;
+            if (!readField(file, pose.timestamp) || !readField(file, pose.x)
+                || !readField(file, pose.y) || !readField(file, pose.angle)) {
+                break;
+            }
+            poses_.push_back(pose);
+        }
+        else {
+            std::fclose(file);
+            throw std::runtime_error(
+                "Unknown record type " + std::to_string(static_cast<int>(type)) + " in lidar recording " + path
+            );
+        }
+    }
+    std::fclose(file);
+}
+
+std::uint64_t LidarRecording::startTimestamp() const
+{
+    if (scans_.empty()) {
+        return poses_.empty() ? 0 : poses_.front().timestamp;
+    }
+    if (poses_.empty()) {
+        return scans_.front().timestamp;
+    }
+    return std::min(scans_.front().timestamp, poses_.front().timestamp);
+}
+
+std::uint64_t LidarRecording::duration() const
+{
+    std::uint64_t end = 0;
+    if (!scans_.empty()) {
+        end = scans_.back().timestamp;
+    }
+    if (!poses_.empty()) {
+        end = std::max(end, poses_.back().timestamp);
+    }
+    return end > 0 ? end - startTimestamp() : 0;
+}
+
+} // namespace lidar_replay
+
+} // namespace cogip
@@ -0,0 +1,191 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "lidar_replay/ReplayLidar.hpp"
+#include "logger/Trace.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace lidar_replay {
+
+namespace {
+
+/// Current CLOCK_MONOTONIC time (ns).
+std::uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+} // namespace
+
+ReplayLidar::ReplayLidar():
+    shared_memory_(nullptr),
+    data_write_lock_(nullptr),
+    speed_(1.0),
+    replay_poses_(true),
+    running_(false),
+    stop_requested_(false),
+    scan_count_(0),
+    pose_count_(0)
+{
+}
+
+ReplayLidar::~ReplayLidar()
+{
+    stop();
+}
+
+bool ReplayLidar::connect(const std::string& path)
+{
+    stop();
+    try {
+        recording_ = std::make_unique<LidarRecording>(path);
+    }
+    catch (const std::runtime_error& error) {
+        std::cerr << "ReplayLidar: " << error.what() << std::endl;
+        recording_.reset();
+        return false;
+    }
+    return true;
+}
+
+bool ReplayLidar::disconnect()
+{
+    stop();
+    recording_.reset();
+    return true;
+}
+
+bool ReplayLidar::start()
+{
+    if (!recording_ || !shared_memory_) {
+        return false;
+    }
+    stop();
+
+    scan_count_.store(0, std::memory_order_relaxed);
+    pose_count_.store(0, std::memory_order_relaxed);
+    stop_requested_.store(false, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&ReplayLidar::run, this);
+    return true;
+}
+
+bool ReplayLidar::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_.store(true, std::memory_order_relaxed);
+    }
+    condition_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    return true;
+}
+
+bool ReplayLidar::waitFinished(double timeout_seconds)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto finished = [this]() { return !running_.load(std::memory_order_acquire); };
+    if (timeout_seconds < 0) {
+        condition_.wait(lock, finished);
+        return true;
+    }
+    return condition_.wait_for(lock, std::chrono::duration<double>(timeout_seconds), finished);
+}
+
+void ReplayLidar::run()
+{
+    const std::vector<recorded_scan_t>& scans = recording_->scans();
+    const std::vector<recorded_pose_t>& poses = recording_->poses();
+    std::uint64_t record_start = recording_->startTimestamp();
+    std::uint64_t replay_start = now_ns();
+    // Unsigned arithmetic wraps, so the shift also applies to recordings of a previous boot.
+    std::uint64_t shift = replay_start - record_start;
+
+    std::size_t scan_index = 0;
+    std::size_t pose_index = replay_poses_ ? 0 : poses.size();
+    while (scan_index < scans.size() || pose_index < poses.size()) {
+        // Records are replayed in time order, a pose before a scan of the same time.
+        bool pose_first = pose_index < poses.size()
+            && (scan_index == scans.size() || poses[pose_index].timestamp <= scans[scan_index].timestamp);
+        std::uint64_t timestamp = pose_first ? poses[pose_index].timestamp : scans[scan_index].timestamp;
+        if (!waitRecordTime(timestamp - record_start, replay_start)) {
+            break;
+        }
+
+        if (pose_first) {
+            const recorded_pose_t& pose = poses[pose_index++];
+            shared_memory_->pushPoseCurrent(pose.x, pose.y, pose.angle, pose.timestamp + shift);
+            pose_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            publishScan(scans[scan_index++], shift);
+            scan_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false, std::memory_order_release);
+    }
+    condition_.notify_all();
+}
+
+bool ReplayLidar::waitRecordTime(std::uint64_t elapsed, std::uint64_t replay_start)
+{
+    if (speed_ <= 0) {
+        return !stop_requested_.load(std::memory_order_relaxed);
+    }
+
+    auto deadline = std::chrono::steady_clock::time_point(
+        std::chrono::nanoseconds(replay_start + static_cast<std::uint64_t>(elapsed / speed_))
+    );
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !condition_.wait_until(lock, deadline, [this]() {
+        return stop_requested_.load(std::memory_order_relaxed);
+    });
+}
+
+void ReplayLidar::publishScan(const recorded_scan_t& scan, std::uint64_t shift)
+{
+    COGIP_TRACE_SPAN("ReplayLidar::publishScan");
+    std::size_t count = scan.points.size();
+
+    shared_memory::lidar_data_buffer_t& buffer = shared_memory_->getLidarDataBuffer();
+    shared_memory::lidar_data_t& slot = shared_memory::tripleBufferBeginWrite(buffer);
+    shared_memory::lidar_scan_header_t& header = shared_memory_->getLidarScanHeader(slot);
+    header.start_timestamp = scan.start_timestamp ? scan.start_timestamp + shift : 0;
+    header.end_timestamp = scan.end_timestamp ? scan.end_timestamp + shift : 0;
+    header.point_count = static_cast<std::uint32_t>(count);
+    header.source = scan.source;
+    for (std::size_t index = 0; index < count; index++) {
+        const recorded_point_t& point = scan.points[index];
+        slot[index][0] = point.angle;
+        slot[index][1] = point.distance;
+        slot[index][2] = point.intensity;
+        header.point_offsets[index] = point.offset;
+    }
+
+    // Mark as end of data
+    slot[count][0] = -1.0;
+    slot[count][1] = -1.0;
+    slot[count][2] = -1.0;
+
+    shared_memory_->publishLidarScan();
+    if (data_write_lock_ != nullptr) {
+        data_write_lock_->postUpdate();
+    }
+}
+
+} // namespace lidar_replay
+
+} // namespace cogip
@@ -0,0 +1,63 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "lidar_replay/LidarRecorder.hpp"
+#include "lidar_replay/ReplayLidar.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/string.h>
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace cogip {
+
+namespace lidar_replay {
+
+NB_MODULE(lidar_replay, m) {
+    auto shared_memory_module = nb::module_::import_("cogip.cpp.libraries.shared_memory");
+
+    nb::class_<LidarRecorder>(m, "LidarRecorder",
+                              "Recorder of the lidar scans and current poses of a shared memory")
+        .def(nb::init<const std::string&>(), "Constructor", "name"_a)
+        .def("start", &LidarRecorder::start, "Start recording in a new file", "path"_a)
+        .def("stop", &LidarRecorder::stop, nb::call_guard<nb::gil_scoped_release>(),
+             "Stop recording and close the file")
+        .def("is_running", &LidarRecorder::isRunning, "Whether the recorder thread is running")
+        .def("scan_count", &LidarRecorder::scanCount, "Number of scans recorded since the last start")
+        .def("pose_count", &LidarRecorder::poseCount, "Number of poses recorded since the last start")
+        .def("missed_scan_count", &LidarRecorder::missedScanCount,
+             "Number of scans missed by the recorder since the last start")
+    ;
+
+    nb::class_<ReplayLidar>(m, "ReplayLidar", "Lidar driver replaying a recording in the shared memory")
+        .def(nb::init<>(), "Constructor")
+        .def("connect", &ReplayLidar::connect, "Load a recording", "path"_a)
+        .def("disconnect", &ReplayLidar::disconnect, nb::call_guard<nb::gil_scoped_release>(),
+             "Unload the recording")
+        .def("start", &ReplayLidar::start, nb::call_guard<nb::gil_scoped_release>(),
+             "Start replaying the recording from its beginning")
+        .def("stop", &ReplayLidar::stop, nb::call_guard<nb::gil_scoped_release>(), "Stop the replay")
+        .def("is_running", &ReplayLidar::isRunning, "Whether the replay is running")
+        .def("wait_finished", &ReplayLidar::waitFinished, nb::call_guard<nb::gil_scoped_release>(),
+             "Wait for the end of the replay, return False on timeout", "timeout"_a = -1.0)
+        .def("set_data_write_lock", &ReplayLidar::setDataWriteLock, "Set the data write lock", "lock"_a)
+        .def("set_shared_memory", &ReplayLidar::setSharedMemory,
+             "Publish scans in the lidar_data triple buffer of the shared memory", "shared_memory"_a)
+        .def("set_speed", &ReplayLidar::setSpeed,
+             "Set the replay speed, 1 for real time, 0 for max speed", "speed"_a)
+        .def("set_replay_poses", &ReplayLidar::setReplayPoses,
+             "Enable the replay of the recorded poses", "replay_poses"_a)
+        .def("recorded_scan_count", &ReplayLidar::recordedScanCount, "Number of scans of the loaded recording")
+        .def("recorded_pose_count", &ReplayLidar::recordedPoseCount, "Number of poses of the loaded recording")
+        .def("recording_duration", &ReplayLidar::recordingDuration,
+             "Duration of the loaded recording in seconds")
+        .def("scan_count", &ReplayLidar::scanCount, "Number of scans published since the last start")
+        .def("pose_count", &ReplayLidar::poseCount, "Number of poses pushed since the last start")
+    ;
+}
+
+} // namespace lidar_replay
+
+} // namespace cogip
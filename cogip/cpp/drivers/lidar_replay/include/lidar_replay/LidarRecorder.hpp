@@ -0,0 +1,100 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     drivers_lidar_replay
+/// @{
+/// @file
+/// @brief       Recorder of the lidar scans and current poses of a shared memory
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include "lidar_replay/LidarRecording.hpp"
+#include "shared_memory/LidarScanHistoryReader.hpp"
+#include "shared_memory/SharedMemory.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace cogip {
+
+namespace lidar_replay {
+
+/// Wait timeout of the recorder thread in seconds, poses are still recorded while no scan arrives.
+constexpr double LIDAR_RECORDER_WAIT_TIMEOUT = 0.1;
+
+/// @class LidarRecorder
+/// Records the scans published by a lidar driver and the current poses in a recording file.
+///
+/// Scans are recorded after decoding and filtering, as found in the lidar_data shared memory,
+/// so the same recording can be replayed whatever the lidar model.
+/// The recorder is woken up by the LidarData lock updates and reads all new scans from the scan history,
+/// so it only misses scans when it falls more than LIDAR_SCAN_HISTORY_SIZE scans behind the driver.
+class LidarRecorder {
+public:
+    /// Constructor.
+    /// @param name Name of the shared memory.
+    explicit LidarRecorder(const std::string& name);
+
+    /// Stops recording.
+    ~LidarRecorder();
+
+    LidarRecorder(const LidarRecorder&) = delete;             ///< Deleted copy constructor.
+    LidarRecorder& operator=(const LidarRecorder&) = delete;  ///< Deleted copy assignment.
+
+    /// Starts recording in a new file, in a dedicated thread.
+    /// @param path Path of the recording file, replaced if it exists.
+    /// @throws std::runtime_error if already recording or if the file cannot be created.
+    void start(const std::string& path);
+
+    /// Stops recording and closes the file. Does nothing if not recording.
+    void stop();
+
+    /// Whether the recorder thread is running.
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /// Number of scans recorded since the last start.
+    std::size_t scanCount() const { return scan_count_.load(std::memory_order_relaxed); }
+
+    /// Number of poses recorded since the last start.
+    std::size_t poseCount() const { return pose_count_.load(std::memory_order_relaxed); }
+
+    /// Number of scans published by the driver but missed by the recorder since the last start.
+    std::size_t missedScanCount() const { return missed_scan_count_.load(std::memory_order_relaxed); }
+
+private:
+    /// Function executed by the recorder thread.
+    void run();
+
+    /// Records the poses pushed since the last recorded one.
+    void recordPoses();
+
+    /// Copy of a scan read from the shared memory.
+    struct ScanCopy {
+        shared_memory::lidar_data_t data;           ///< Lidar data.
+        shared_memory::lidar_scan_header_t header;  ///< Timing header.
+    };
+
+    shared_memory::SharedMemory shared_memory_;     ///< Shared memory of the driver.
+    shared_memory::WritePriorityLock& data_lock_;   ///< Lock posting the lidar data updates.
+    shared_memory::LidarScanHistoryReader history_reader_;  ///< Reader of the scans to record.
+    std::unique_ptr<LidarRecordingWriter> writer_;  ///< Recording file, open while recording.
+    std::thread thread_;                            ///< Recorder thread.
+    std::atomic<bool> running_;                     ///< Recorder thread state.
+    std::atomic<std::size_t> scan_count_;           ///< Number of recorded scans.
+    std::atomic<std::size_t> pose_count_;           ///< Number of recorded poses.
+    std::atomic<std::size_t> missed_scan_count_;    ///< Number of missed scans.
+    std::uint64_t last_pose_timestamp_;             ///< Time of the last recorded pose (ns).
+    std::unique_ptr<ScanCopy> scan_;                ///< Scan being recorded.
+    std::vector<models::pose_t> poses_;             ///< Poses being recorded.
+    std::vector<std::uint64_t> pose_timestamps_;    ///< Times of the poses being recorded.
+};
+
+} // namespace lidar_replay
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,133 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     drivers_lidar_replay
+/// @{
+/// @file
+/// @brief       Binary file of recorded lidar scans and current poses
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include "shared_memory/shared_data.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace cogip {
+
+namespace lidar_replay {
+
+/// Magic bytes at the start of a recording file.
+constexpr char RECORDING_MAGIC[8] = {'C', 'O', 'G', 'I', 'P', 'L', 'D', 'R'};
+
+/// Version of the recording file format.
+/// Version 1 files, without the lidar source of the scans, are still read as scans of lidar 0.
+constexpr std::uint32_t RECORDING_VERSION = 2;
+
+/// Type of a record, the first byte of each record in the file.
+enum class RecordType : std::uint8_t {
+    Scan = 1,  ///< Lidar scan, as published in the lidar_data shared memory.
+    Pose = 2,  ///< Pose pushed in the pose_current_buffer shared memory.
+};
+
+/// Recorded point, in single precision to keep files compact.
+struct recorded_point_t {
+    float angle;           ///< Angle in degrees.
+    float distance;        ///< Distance in mm.
+    float intensity;       ///< Intensity.
+    std::uint32_t offset;  ///< Time of the point relative to the scan start (ns), 0 if unknown.
+};
+
+/// Recorded lidar scan.
+struct recorded_scan_t {
+    std::uint64_t timestamp;        ///< Time the scan was published (ns, CLOCK_MONOTONIC).
+    std::uint64_t start_timestamp;  ///< Time of the first point of the scan revolution (ns), 0 if unknown.
+    std::uint64_t end_timestamp;    ///< Time of the last point of the scan revolution (ns), 0 if unknown.
+    std::uint32_t source;           ///< Index of the lidar of the robot which measured the scan.
+    std::vector<recorded_point_t> points;  ///< Points of the scan.
+};
+
+/// Recorded current pose.
+struct recorded_pose_t {
+    std::uint64_t timestamp;  ///< Time of the pose (ns, CLOCK_MONOTONIC).
+    float x;                  ///< X coordinate in mm.
+    float y;                  ///< Y coordinate in mm.
+    float angle;              ///< Orientation in degrees.
+};
+
+/// Writes a recording file.
+///
+/// The file starts with RECORDING_MAGIC and RECORDING_VERSION, followed by records
+/// made of a RecordType byte and their fields in host byte order, without padding:
+/// - scan: timestamp, start_timestamp, end_timestamp (uint64), source, point count (uint32),
+///   then angle, distance, intensity (float) and offset (uint32) of each point,
+/// - pose: timestamp (uint64), x, y, angle (float).
+class LidarRecordingWriter {
+public:
+    /// Creates the file and writes its header.
+    /// @param path Path of the file, replaced if it exists.
+    /// @throws std::runtime_error if the file cannot be created.
+    explicit LidarRecordingWriter(const std::string& path);
+
+    /// Closes the file.
+    ~LidarRecordingWriter();
+
+    LidarRecordingWriter(const LidarRecordingWriter&) = delete;             ///< Deleted copy constructor.
+    LidarRecordingWriter& operator=(const LidarRecordingWriter&) = delete;  ///< Deleted copy assignment.
+
+    /// Writes a scan.
+    /// @param timestamp Time the scan was published (ns, CLOCK_MONOTONIC).
+    /// @param data Lidar data.
+    /// @param header Timing header of the scan, its point_count is the number of points of the data.
+    /// @return Number of points written.
+    std::size_t writeScan(
+        std::uint64_t timestamp,
+        const shared_memory::lidar_data_t& data,
+        const shared_memory::lidar_scan_header_t& header
+    );
+
+    /// Writes a pose.
+    void writePose(const recorded_pose_t& pose);
+
+    /// Flushes the records written so far to the file.
+    void flush();
+
+private:
+    std::FILE* file_;  ///< Recording file.
+};
+
+/// Recording file loaded in memory, so reading it does not disturb a replay.
+class LidarRecording {
+public:
+    /// Loads a recording file.
+    /// A record truncated at the end of the file, by a recorder killed while writing it, is ignored.
+    /// @param path Path of the file.
+    /// @throws std::runtime_error if the file cannot be read or is not a recording.
+    explicit LidarRecording(const std::string& path);
+
+    /// Recorded scans, in publication order.
+    const std::vector<recorded_scan_t>& scans() const { return scans_; }
+
+    /// Recorded poses, in time order.
+    const std::vector<recorded_pose_t>& poses() const { return poses_; }
+
+    /// Time of the first record (ns, CLOCK_MONOTONIC), 0 if the recording is empty.
+    std::uint64_t startTimestamp() const;
+
+    /// Duration between the first and the last record (ns).
+    std::uint64_t duration() const;
+
+private:
+    std::vector<recorded_scan_t> scans_;  ///< Recorded scans.
+    std::vector<recorded_pose_t> poses_;  ///< Recorded poses.
+};
+
+} // namespace lidar_replay
+
+} // namespace cogip
+
+/// @}
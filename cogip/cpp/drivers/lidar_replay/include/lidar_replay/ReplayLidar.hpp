@@ -0,0 +1,131 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     drivers_lidar_replay
+/// @{
+/// @file
+/// @brief       Lidar driver replaying a recording in the shared memory
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include "lidar_replay/LidarRecording.hpp"
+#include "shared_memory/SharedMemory.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace cogip {
+
+namespace lidar_replay {
+
+/// @class ReplayLidar
+/// Lidar driver publishing recorded scans in the lidar_data shared memory,
+/// with the same calls as the hardware drivers, so the detector pipeline runs without a lidar.
+///
+/// Recorded poses are pushed in the pose_current_buffer at their time, interleaved with the scans.
+/// All recorded timestamps are shifted by the time elapsed between the recording and the replay start,
+/// so the replayed scans and poses keep their relative timing whatever the replay speed.
+class ReplayLidar {
+public:
+    /// Constructor.
+    ReplayLidar();
+
+    /// Stops the replay.
+    ~ReplayLidar();
+
+    ReplayLidar(const ReplayLidar&) = delete;             ///< Deleted copy constructor.
+    ReplayLidar& operator=(const ReplayLidar&) = delete;  ///< Deleted copy assignment.
+
+    /// Loads a recording, the replacement of the serial port of the hardware drivers.
+    /// @param path Path of the recording file.
+    /// @return `true` if the recording was loaded, `false` otherwise.
+    bool connect(const std::string& path);
+
+    /// Unloads the recording.
+    /// @return `true`.
+    bool disconnect();
+
+    /// Starts replaying the recording from its beginning, in a dedicated thread.
+    /// @return `true` if the replay started, `false` if no recording is loaded or no shared memory is set.
+    bool start();
+
+    /// Stops the replay.
+    /// @return `true`.
+    bool stop();
+
+    /// Whether the replay thread is running. It stops by itself at the end of the recording.
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /// Waits for the end of the replay.
+    /// @param timeout_seconds Timeout in seconds. If negative, wait indefinitely.
+    /// @return `true` if the replay is finished, `false` if timed out.
+    bool waitFinished(double timeout_seconds = -1.0);
+
+    /// Sets the data write lock, used to post an update after each scan.
+    void setDataWriteLock(shared_memory::WritePriorityLock& lock) { data_write_lock_ = &lock; }
+
+    /// Sets the shared memory receiving the scans and poses.
+    void setSharedMemory(shared_memory::SharedMemory& shared_memory) { shared_memory_ = &shared_memory; }
+
+    /// Sets the replay speed.
+    /// @param speed Ratio of the recording duration to the replay duration, 1 for real time,
+    ///              0 to publish as fast as possible: consumers then only get the scans they keep up with.
+    void setSpeed(double speed) { speed_ = speed; }
+
+    /// Enables the replay of the recorded poses, enabled by default.
+    /// Disable it if another process pushes the current poses.
+    void setReplayPoses(bool replay_poses) { replay_poses_ = replay_poses; }
+
+    /// Number of scans of the loaded recording.
+    std::size_t recordedScanCount() const { return recording_ ? recording_->scans().size() : 0; }
+
+    /// Number of poses of the loaded recording.
+    std::size_t recordedPoseCount() const { return recording_ ? recording_->poses().size() : 0; }
+
+    /// Duration of the loaded recording in seconds.
+    double recordingDuration() const { return recording_ ? recording_->duration() * 1e-9 : 0.0; }
+
+    /// Number of scans published since the last start.
+    std::size_t scanCount() const { return scan_count_.load(std::memory_order_relaxed); }
+
+    /// Number of poses pushed since the last start.
+    std::size_t poseCount() const { return pose_count_.load(std::memory_order_relaxed); }
+
+private:
+    /// Function executed by the replay thread.
+    void run();
+
+    /// Sleeps until the replay time of a record, scaled by the replay speed.
+    /// @param elapsed Time of the record since the start of the recording (ns).
+    /// @param replay_start Time the replay started (ns, CLOCK_MONOTONIC).
+    /// @return False if the replay was stopped meanwhile.
+    bool waitRecordTime(std::uint64_t elapsed, std::uint64_t replay_start);
+
+    /// Publishes a scan with shifted timestamps.
+    void publishScan(const recorded_scan_t& scan, std::uint64_t shift);
+
+    std::unique_ptr<LidarRecording> recording_;          ///< Loaded recording.
+    shared_memory::SharedMemory* shared_memory_;         ///< Shared memory receiving the scans and poses.
+    shared_memory::WritePriorityLock* data_write_lock_;  ///< Lock posting the lidar data updates, if set.
+    double speed_;                                       ///< Replay speed, 0 for max speed.
+    bool replay_poses_;                                  ///< Whether recorded poses are pushed.
+    std::thread thread_;                                 ///< Replay thread.
+    std::atomic<bool> running_;                          ///< Replay thread state.
+    std::atomic<bool> stop_requested_;                   ///< Set to stop the replay thread.
+    std::mutex mutex_;                                   ///< Protects the wait of the replay thread.
+    std::condition_variable condition_;                  ///< Wakes the replay thread on stop, and waitFinished() at the end.
+    std::atomic<std::size_t> scan_count_;                ///< Number of published scans.
+    std::atomic<std::size_t> pose_count_;                ///< Number of pushed poses.
+};
+
+} // namespace lidar_replay
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,368 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "lidar_sim/SimLidar.hpp"
+#include "logger/Trace.hpp"
+#include "utils/trigonometry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace cogip {
+
+namespace lidar_sim {
+
+namespace {
+
+/// Maximum number of circles to raycast, the monitor obstacles and the planner circles.
+constexpr std::size_t MAX_CIRCLE_COUNT = models::CIRCLE_LIST_SIZE_MAX + obstacles::OBSTACLE_LIST_SIZE_MAX;
+
+/// Maximum number of segments to raycast, the table borders and the sides of the planner rectangles.
+constexpr std::size_t MAX_SEGMENT_COUNT = 4 + obstacles::OBSTACLE_LIST_SIZE_MAX * models::COMPACT_COORDS_LIST_SIZE_MAX;
+
+/// Current CLOCK_MONOTONIC time (ns).
+std::uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+} // namespace
+
+SimLidar::SimLidar(double (*external_lidar_data)[3]):
+    LidarDriver(external_lidar_data),
+    angular_resolution_(1.0),
+    scan_frequency_(10.0),
+    range_(SIM_LIDAR_DEFAULT_RANGE),
+    distance_noise_(0.0),
+    angle_noise_(0.0),
+    offset_x_(0.0),
+    offset_y_(0.0),
+    mounting_angle_(0.0),
+    monitor_obstacles_(true),
+    planner_circles_(false),
+    speed_(1.0),
+    running_(false),
+    stop_requested_(false),
+    scan_count_(0),
+    circle_x_(MAX_CIRCLE_COUNT),
+    circle_y_(MAX_CIRCLE_COUNT),
+    circle_radius2_(MAX_CIRCLE_COUNT),
+    circle_count_(0),
+    segment_x_(MAX_SEGMENT_COUNT),
+    segment_y_(MAX_SEGMENT_COUNT),
+    segment_dx_(MAX_SEGMENT_COUNT),
+    segment_dy_(MAX_SEGMENT_COUNT),
+    segment_count_(0)
+{
+}
+
+SimLidar::~SimLidar()
+{
+    stop();
+}
+
+bool SimLidar::start()
+{
+    if (getSharedMemory() == nullptr) {
+        return false;
+    }
+    stop();
+
+    scan_count_.store(0, std::memory_order_relaxed);
+    stop_requested_.store(false, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&SimLidar::run, this);
+    return true;
+}
+
+bool SimLidar::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_.store(true, std::memory_order_relaxed);
+    }
+    condition_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    return true;
+}
+
+bool SimLidar::scanOnce()
+{
+    if (getSharedMemory() == nullptr || isRunning()) {
+        return false;
+    }
+    // The scan ends now, as if it had been measured during the last revolution.
+    std::uint64_t duration = speed_ > 0 ? static_cast<std::uint64_t>(1e9 / scan_frequency_ / speed_) : 0;
+    simulateScan(now_ns() - duration, duration);
+    scan_count_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SimLidar::setAngularResolution(double resolution)
+{
+    if (!(resolution > 0) || std::ceil(360.0 / resolution) > lidar_driver::MAX_SCAN_POINT_COUNT) {
+        throw std::invalid_argument(
+            "Angular resolution must give between 1 and " + std::to_string(lidar_driver::MAX_SCAN_POINT_COUNT)
+            + " rays per turn"
+        );
+    }
+    angular_resolution_ = resolution;
+}
+
+void SimLidar::setScanFrequency(double frequency)
+{
+    if (!(frequency > 0)) {
+        throw std::invalid_argument("Scan frequency must be positive");
+    }
+    scan_frequency_ = frequency;
+}
+
+void SimLidar::setRange(double range)
+{
+    if (!(range > 0)) {
+        throw std::invalid_argument("Range must be positive");
+    }
+    range_ = range;
+}
+
+void SimLidar::setNoise(double distance_noise, double angle_noise)
+{
+    if (distance_noise < 0 || angle_noise < 0) {
+        throw std::invalid_argument("Noise deviations must not be negative");
+    }
+    distance_noise_ = distance_noise;
+    angle_noise_ = angle_noise;
+}
+
+void SimLidar::setMounting(double offset_x, double offset_y, double angle)
+{
+    offset_x_ = offset_x;
+    offset_y_ = offset_y;
+    mounting_angle_ = angle;
+}
+
+void SimLidar::run()
+{
+    std::uint64_t simulation_start = now_ns();
+    std::uint64_t scan_index = 0;
+    while (!stop_requested_.load(std::memory_order_relaxed)) {
+        double speed = speed_;
+        std::uint64_t duration = speed > 0 ? static_cast<std::uint64_t>(1e9 / scan_frequency_ / speed) : 0;
+        std::uint64_t start_timestamp = now_ns();
+
+        if (speed > 0) {
+            // Scans are scheduled from the simulation start, so the frequency does not drift with the scan duration,
+            // and published at the end of their revolution, as the hardware drivers.
+            start_timestamp = simulation_start + scan_index * duration;
+            auto deadline = std::chrono::steady_clock::time_point(
+                std::chrono::nanoseconds(start_timestamp + duration)
+            );
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (condition_.wait_until(lock, deadline, [this]() {
+                    return stop_requested_.load(std::memory_order_relaxed);
+                })) {
+                break;
+            }
+            lock.unlock();
+            std::uint64_t now = now_ns();
+            if (now > start_timestamp + 2 * duration) {
+                // Late by more than a revolution, restart the schedule instead of publishing a burst of scans.
+                start_timestamp = now - duration;
+                simulation_start = start_timestamp;
+                scan_index = 0;
+            }
+        }
+
+        simulateScan(start_timestamp, duration);
+        scan_count_.fetch_add(1, std::memory_order_relaxed);
+        scan_index++;
+    }
+
+    running_.store(false, std::memory_order_release);
+}
+
+void SimLidar::simulateScan(std::uint64_t start_timestamp, std::uint64_t duration)
+{
+    COGIP_TRACE_SPAN("SimLidar::simulateScan");
+    shared_memory::SharedMemory& shared_memory = *getSharedMemory();
+
+    // Place the lidar on the robot.
+    models::pose_t pose = shared_memory.readPoseCurrent();
+    double robot_angle_rad = DEG2RAD(pose.angle);
+    double cos_robot = std::cos(robot_angle_rad);
+    double sin_robot = std::sin(robot_angle_rad);
+    double origin_x = pose.x + offset_x_ * cos_robot - offset_y_ * sin_robot;
+    double origin_y = pose.y + offset_x_ * sin_robot + offset_y_ * cos_robot;
+    double heading = pose.angle + mounting_angle_;
+
+    double resolution = angular_resolution_;
+    std::size_t ray_count = std::min(
+        static_cast<std::size_t>(std::ceil(360.0 / resolution)), lidar_driver::MAX_SCAN_POINT_COUNT
+    );
+    std::normal_distribution<double> angle_noise(0.0, angle_noise_ > 0 ? angle_noise_ : 1.0);
+    for (std::size_t index = 0; index < ray_count; index++) {
+        double angle = heading + index * resolution;
+        if (angle_noise_ > 0) {
+            angle += angle_noise(random_generator_);
+        }
+        double angle_rad = DEG2RAD(angle);
+        ray_dx_[index] = std::cos(angle_rad);
+        ray_dy_[index] = std::sin(angle_rad);
+        ray_distances_[index] = range_;
+    }
+
+    loadObstacles();
+    castSegments(origin_x, origin_y, ray_count);
+    castCircles(origin_x, origin_y, ray_count);
+
+    std::normal_distribution<double> distance_noise(0.0, distance_noise_ > 0 ? distance_noise_ : 1.0);
+    beginScan(start_timestamp);
+    for (std::size_t index = 0; index < ray_count; index++) {
+        double distance = ray_distances_[index];
+        if (distance >= range_) {
+            continue;
+        }
+        if (distance_noise_ > 0) {
+            distance = std::max(0.0, distance + distance_noise(random_generator_));
+        }
+        addPoint(index * resolution, distance, SIM_LIDAR_INTENSITY, start_timestamp + index * duration / ray_count);
+    }
+    publishScan(start_timestamp + (ray_count - 1) * duration / ray_count);
+}
+
+void SimLidar::loadObstacles()
+{
+    shared_memory::SharedMemory& shared_memory = *getSharedMemory();
+    circle_count_ = 0;
+    segment_count_ = 0;
+
+    // Table borders, set by the planner, none until then.
+    const double (&limits)[4] = shared_memory.getTableLimits();
+    double x_min = limits[0], x_max = limits[1], y_min = limits[2], y_max = limits[3];
+    if (x_min < x_max && y_min < y_max) {
+        const double corners[5][2] = { {x_min, y_min}, {x_max, y_min}, {x_max, y_max}, {x_min, y_max}, {x_min, y_min} };
+        for (std::size_t index = 0; index < 4; index++) {
+            segment_x_[segment_count_] = corners[index][0];
+            segment_y_[segment_count_] = corners[index][1];
+            segment_dx_[segment_count_] = corners[index + 1][0] - corners[index][0];
+            segment_dy_[segment_count_] = corners[index + 1][1] - corners[index][1];
+            segment_count_++;
+        }
+    }
+
+    if (monitor_obstacles_) {
+        shared_memory::WritePriorityLock& lock = shared_memory.getLock(shared_memory::LockName::MonitorObstacles);
+        models::CircleList& monitor_obstacles = *shared_memory.getMonitorObstacles();
+        lock.startReading();
+        std::size_t count = std::min(monitor_obstacles.size(), models::CIRCLE_LIST_SIZE_MAX);
+        for (std::size_t index = 0; index < count; index++) {
+            const models::circle_t& circle = *monitor_obstacles.get_data(index);
+            circle_x_[circle_count_] = circle.x;
+            circle_y_[circle_count_] = circle.y;
+            circle_radius2_[circle_count_] = circle.radius * circle.radius;
+            circle_count_++;
+        }
+        lock.finishReading();
+    }
+
+    // The copy restarts from the obstacles above if the planner overwrote its lists meanwhile.
+    std::size_t base_circle_count = circle_count_;
+    std::size_t base_segment_count = segment_count_;
+    shared_memory.readObstacles([&](const shared_memory::planner_obstacles_t& planner_obstacles) {
+        circle_count_ = base_circle_count;
+        segment_count_ = base_segment_count;
+        if (planner_circles_) {
+            std::size_t count = std::min(planner_obstacles.circles.count, obstacles::OBSTACLE_LIST_SIZE_MAX);
+            for (std::size_t index = 0; index < count; index++) {
+                const obstacles::compact_obstacle_circle_t& circle = planner_obstacles.circles.elems[index];
+                circle_x_[circle_count_] = circle.center.x;
+                circle_y_[circle_count_] = circle.center.y;
+                circle_radius2_[circle_count_] = circle.radius * circle.radius;
+                circle_count_++;
+            }
+        }
+        std::size_t count = std::min(planner_obstacles.rectangles.count, obstacles::OBSTACLE_LIST_SIZE_MAX);
+        for (std::size_t index = 0; index < count; index++) {
+            const models::basic_coords_list_t<models::COMPACT_COORDS_LIST_SIZE_MAX>& points
+                = planner_obstacles.rectangles.elems[index].points;
+            std::size_t point_count = std::min(points.count, models::COMPACT_COORDS_LIST_SIZE_MAX);
+            for (std::size_t point = 0; point < point_count; point++) {
+                const models::coords_t& from = points.elems[point];
+                const models::coords_t& to = points.elems[(point + 1) % point_count];
+                segment_x_[segment_count_] = from.x;
+                segment_y_[segment_count_] = from.y;
+                segment_dx_[segment_count_] = to.x - from.x;
+                segment_dy_[segment_count_] = to.y - from.y;
+                segment_count_++;
+            }
+        }
+    });
+}
+
+void SimLidar::castCircles(double origin_x, double origin_y, std::size_t ray_count)
+{
+    const double* ray_dx = ray_dx_.data();
+    const double* ray_dy = ray_dy_.data();
+    double* ray_distances = ray_distances_.data();
+    for (std::size_t circle = 0; circle < circle_count_; circle++) {
+        double center_x = circle_x_[circle] - origin_x;
+        double center_y = circle_y_[circle] - origin_y;
+        double center_distance2 = center_x * center_x + center_y * center_y;
+        double radius2 = circle_radius2_[circle];
+        // A lidar inside a circle does not see it, like the robot inside an inflated obstacle.
+        if (center_distance2 <= radius2) {
+            continue;
+        }
+        double reach = range_ + std::sqrt(radius2);
+        if (center_distance2 >= reach * reach) {
+            continue;
+        }
+        double c = center_distance2 - radius2;
+        // The ray enters the circle at b - sqrt(b² - c), b being the projection of the center on the ray.
+        for (std::size_t ray = 0; ray < ray_count; ray++) {
+            double b = center_x * ray_dx[ray] + center_y * ray_dy[ray];
+            double discriminant = b * b - c;
+            double distance = b - std::sqrt(std::max(discriminant, 0.0));
+            bool hit = discriminant >= 0 && b > 0 && distance < ray_distances[ray];
+            ray_distances[ray] = hit ? distance : ray_distances[ray];
+        }
+    }
+}
+
+void SimLidar::castSegments(double origin_x, double origin_y, std::size_t ray_count)
+{
+    const double* ray_dx = ray_dx_.data();
+    const double* ray_dy = ray_dy_.data();
+    double* ray_distances = ray_distances_.data();
+    for (std::size_t segment = 0; segment < segment_count_; segment++) {
+        double start_x = segment_x_[segment] - origin_x;
+        double start_y = segment_y_[segment] - origin_y;
+        double dx = segment_dx_[segment];
+        double dy = segment_dy_[segment];
+        double start_cross = start_x * dy - start_y * dx;
+        // Solve origin + distance * ray = start + u * segment, with cross products over the ray and the segment.
+        for (std::size_t ray = 0; ray < ray_count; ray++) {
+            double denominator = ray_dx[ray] * dy - ray_dy[ray] * dx;
+            double u_numerator = start_x * ray_dy[ray] - start_y * ray_dx[ray];
+            bool parallel = std::abs(denominator) < std::numeric_limits<double>::epsilon();
+            double inverse = parallel ? 0.0 : 1.0 / denominator;
+            double distance = start_cross * inverse;
+            double u = u_numerator * inverse;
+            bool hit = !parallel && distance > 0 && u >= 0 && u <= 1 && distance < ray_distances[ray];
+            ray_distances[ray] = hit ? distance : ray_distances[ray];
+        }
+    }
+}
+
+} // namespace lidar_sim
+
+} // namespace cogip
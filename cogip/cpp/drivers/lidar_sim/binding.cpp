@@ -0,0 +1,64 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "lidar_sim/SimLidar.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace cogip {
+
+namespace lidar_sim {
+
+NB_MODULE(lidar_sim, m) {
+    auto shared_memory_module = nb::module_::import_("cogip.cpp.libraries.shared_memory");
+    auto lidar_driver_module = nb::module_::import_("cogip.cpp.drivers.lidar_driver");
+
+    m.attr("SIM_LIDAR_DEFAULT_RANGE") = SIM_LIDAR_DEFAULT_RANGE;
+
+    nb::class_<SimLidar, lidar_driver::LidarDriver>(m, "SimLidar",
+                                                    "Lidar driver simulating scans from the obstacles of the shared memory")
+        .def(nb::init<>(), "Constructor that internally manages memory")
+        .def(
+            "__init__",
+            [](SimLidar* self, nb::ndarray<double, nb::numpy, nb::shape<lidar_driver::MAX_DATA_COUNT, 3>> external_lidar_data) {
+                new (self) SimLidar(reinterpret_cast<double(*)[3]>(external_lidar_data.data()));
+            },
+            "Constructor accepting nanobind::ndarray",
+            "external_lidar_data"_a,
+            nb::keep_alive<1, 2>()
+        )
+        .def("start", &SimLidar::start, nb::call_guard<nb::gil_scoped_release>(),
+             "Start publishing scans at the scan frequency")
+        .def("stop", &SimLidar::stop, nb::call_guard<nb::gil_scoped_release>(), "Stop the simulation")
+        .def("disconnect", &SimLidar::disconnect, nb::call_guard<nb::gil_scoped_release>(), "Stop the simulation")
+        .def("is_running", &SimLidar::isRunning, "Whether the simulation is running")
+        .def("scan_once", &SimLidar::scanOnce, nb::call_guard<nb::gil_scoped_release>(),
+             "Simulate and publish one scan while the simulation is not running")
+        .def("set_angular_resolution", &SimLidar::setAngularResolution, "Set the angle between two rays (deg)",
+             "resolution"_a)
+        .def("get_angular_resolution", &SimLidar::getAngularResolution, "Get the angle between two rays (deg)")
+        .def("set_scan_frequency", &SimLidar::setScanFrequency, "Set the number of scans per second", "frequency"_a)
+        .def("set_range", &SimLidar::setRange, "Set the range of the rays (mm)", "range"_a)
+        .def("set_noise", &SimLidar::setNoise,
+             "Set the standard deviations of the distance (mm) and ray direction (deg) noises",
+             "distance_noise"_a, "angle_noise"_a = 0.0)
+        .def("set_seed", &SimLidar::setSeed, "Seed the noise generator", "seed"_a)
+        .def("set_mounting", &SimLidar::setMounting, "Set the position of the lidar on the robot",
+             "offset_x"_a, "offset_y"_a, "angle"_a = 0.0)
+        .def("set_monitor_obstacles", &SimLidar::setMonitorObstacles,
+             "Raycast the circles of the monitor obstacles", "enabled"_a)
+        .def("set_planner_circles", &SimLidar::setPlannerCircles,
+             "Raycast the circles of the published planner obstacles", "enabled"_a)
+        .def("set_speed", &SimLidar::setSpeed, "Set the simulation speed, 1 for real time, 0 for max speed", "speed"_a)
+        .def("scan_count", &SimLidar::scanCount, "Number of scans published since the last start")
+    ;
+}
+
+} // namespace lidar_sim
+
+} // namespace cogip
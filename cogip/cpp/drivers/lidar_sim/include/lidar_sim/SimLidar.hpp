@@ -0,0 +1,180 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     drivers_lidar_sim
+/// @{
+/// @file
+/// @brief       Lidar driver simulating scans from the obstacles of the shared memory
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include "lidar_driver/LidarDriver.hpp"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace cogip {
+
+namespace lidar_sim {
+
+/// Default range of the simulated lidar (mm).
+constexpr double SIM_LIDAR_DEFAULT_RANGE = 12000.0;
+
+/// Intensity of the simulated points.
+constexpr double SIM_LIDAR_INTENSITY = 200.0;
+
+/// @class SimLidar
+/// Lidar driver raycasting the obstacles of the shared memory from the current pose,
+/// and publishing the scans through the publish stage of the hardware drivers,
+/// so the detector pipeline runs in simulation with the same filters, binning and timing headers.
+///
+/// Each scan casts one ray per angular step from the lidar, placed on the last current pose with its mounting offset,
+/// against the table borders, the rectangles of the published planner obstacles,
+/// the circles of the monitor obstacles and optionally the circles of the published planner obstacles.
+/// Rays are cast against each obstacle in turn, over arrays of ray directions the compiler vectorizes.
+/// Rays hitting nothing within range produce no point, as a real lidar.
+///
+/// The planner circles are the obstacles detected from the lidar itself, possibly inflated,
+/// so raycasting them feeds the detections back to the detector. They are disabled by default.
+class SimLidar : public lidar_driver::LidarDriver {
+public:
+    /// Constructor.
+    /// @param external_lidar_data Lidar data array of MAX_DATA_COUNT rows, allocated internally if null.
+    explicit SimLidar(double (*external_lidar_data)[3] = nullptr);
+
+    /// Stops the simulation.
+    ~SimLidar() override;
+
+    /// Starts publishing scans at the scan frequency, in a dedicated thread.
+    /// @return `true` if the simulation started, `false` if no shared memory is set.
+    bool start();
+
+    /// Stops the simulation.
+    /// @return `true`.
+    bool stop();
+
+    /// Stops the simulation, there is no port to close.
+    /// @return `true`.
+    bool disconnect() { return stop(); }
+
+    /// Whether the simulation thread is running.
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /// Simulates and publishes one scan, while the simulation thread is not running.
+    /// @return `true` if the scan was published, `false` if no shared memory is set or the thread is running.
+    bool scanOnce();
+
+    /// Set the angle between two rays (deg).
+    /// @throws std::invalid_argument if it is not positive or gives more than MAX_SCAN_POINT_COUNT rays per turn.
+    void setAngularResolution(double resolution);
+
+    /// Get the angle between two rays (deg).
+    double getAngularResolution() const { return angular_resolution_; }
+
+    /// Set the number of scans per second.
+    /// @throws std::invalid_argument if it is not positive.
+    void setScanFrequency(double frequency);
+
+    /// Set the range of the rays (mm).
+    /// @throws std::invalid_argument if it is not positive.
+    void setRange(double range);
+
+    /// Set the standard deviations of the gaussian noise added to the measures.
+    /// @param distance_noise Noise of the distances (mm), 0 to disable it.
+    /// @param angle_noise Noise of the ray directions (deg), 0 to disable it.
+    /// @throws std::invalid_argument if a deviation is negative.
+    void setNoise(double distance_noise, double angle_noise);
+
+    /// Seed the noise generator, so simulations can be repeated.
+    void setSeed(std::uint32_t seed) { random_generator_.seed(seed); }
+
+    /// Set the position of the lidar on the robot.
+    /// @param offset_x Offset on the X axis of the robot (mm).
+    /// @param offset_y Offset on the Y axis of the robot (mm).
+    /// @param angle Angle of the lidar 0 deg axis from the X axis of the robot, counter clockwise (deg).
+    void setMounting(double offset_x, double offset_y, double angle);
+
+    /// Raycast the circles of the monitor obstacles, enabled by default.
+    void setMonitorObstacles(bool enabled) { monitor_obstacles_ = enabled; }
+
+    /// Raycast the circles of the published planner obstacles, disabled by default.
+    void setPlannerCircles(bool enabled) { planner_circles_ = enabled; }
+
+    /// Set the simulation speed.
+    /// @param speed Ratio of the simulated time to the elapsed time, 1 for real time,
+    ///              0 to publish as fast as possible: consumers then only get the scans they keep up with.
+    void setSpeed(double speed) { speed_ = speed; }
+
+    /// Number of scans published since the last start.
+    std::size_t scanCount() const { return scan_count_.load(std::memory_order_relaxed); }
+
+private:
+    /// Function executed by the simulation thread.
+    void run();
+
+    /// Raycasts the obstacles and publishes a scan.
+    /// @param start_timestamp Time of the first ray (ns, CLOCK_MONOTONIC).
+    /// @param duration Time between the first ray and the end of the revolution (ns).
+    void simulateScan(std::uint64_t start_timestamp, std::uint64_t duration);
+
+    /// Copies the obstacles of the shared memory as circles and segments.
+    void loadObstacles();
+
+    /// Shortens the ray distances hitting the circles.
+    void castCircles(double origin_x, double origin_y, std::size_t ray_count);
+
+    /// Shortens the ray distances hitting the segments.
+    void castSegments(double origin_x, double origin_y, std::size_t ray_count);
+
+    double angular_resolution_;  ///< Angle between two rays (deg)
+    double scan_frequency_;      ///< Number of scans per second
+    double range_;               ///< Range of the rays (mm)
+    double distance_noise_;      ///< Standard deviation of the distance noise (mm)
+    double angle_noise_;         ///< Standard deviation of the ray direction noise (deg)
+    double offset_x_;            ///< Offset of the lidar on the X axis of the robot (mm)
+    double offset_y_;            ///< Offset of the lidar on the Y axis of the robot (mm)
+    double mounting_angle_;      ///< Angle of the lidar on the robot (deg)
+    bool monitor_obstacles_;     ///< Whether the monitor obstacles are raycast
+    bool planner_circles_;       ///< Whether the planner circles are raycast
+    double speed_;               ///< Simulation speed, 0 for max speed
+    std::mt19937 random_generator_;  ///< Noise generator
+
+    std::thread thread_;                 ///< Simulation thread.
+    std::atomic<bool> running_;          ///< Simulation thread state.
+    std::atomic<bool> stop_requested_;   ///< Set to stop the simulation thread.
+    std::mutex mutex_;                   ///< Protects the wait of the simulation thread.
+    std::condition_variable condition_;  ///< Wakes the simulation thread on stop.
+    std::atomic<std::size_t> scan_count_;  ///< Number of published scans.
+
+    /// Ray directions and distances, as arrays the cast kernels vectorize over.
+    std::array<double, lidar_driver::MAX_SCAN_POINT_COUNT> ray_dx_;
+    std::array<double, lidar_driver::MAX_SCAN_POINT_COUNT> ray_dy_;
+    std::array<double, lidar_driver::MAX_SCAN_POINT_COUNT> ray_distances_;
+
+    /// Circles to raycast, as center and squared radius, allocated once with the driver.
+    std::vector<double> circle_x_;
+    std::vector<double> circle_y_;
+    std::vector<double> circle_radius2_;
+    std::size_t circle_count_;  ///< Number of circles to raycast
+
+    /// Segments to raycast, as start point and vector to the end point, allocated once with the driver.
+    std::vector<double> segment_x_;
+    std::vector<double> segment_y_;
+    std::vector<double> segment_dx_;
+    std::vector<double> segment_dy_;
+    std::size_t segment_count_;  ///< Number of segments to raycast
+};
+
+} // namespace lidar_sim
+
+} // namespace cogip
+
+/// @}
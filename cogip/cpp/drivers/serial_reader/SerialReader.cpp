@@ -0,0 +1,223 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "serial_reader/SerialReader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace cogip {
+
+namespace serial_reader {
+
+SerialReader::SerialReader(std::size_t capacity):
+    ring_(capacity),
+    read_index_(0),
+    write_index_(0),
+    dropped_bytes_(0),
+    fd_(-1),
+    stop_fd_(-1),
+    running_(false)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("Serial reader ring capacity must not be 0");
+    }
+}
+
+SerialReader::~SerialReader()
+{
+    stop();
+}
+
+void SerialReader::start(int fd, ReadCallback callback)
+{
+    if (isRunning()) {
+        throw std::runtime_error("Serial reader is already started");
+    }
+    // Release the thread if it stopped by itself on a serial port failure.
+    stop();
+
+    if (fd < 0) {
+        throw std::invalid_argument("Serial reader needs an open file descriptor");
+    }
+
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0) {
+        throw std::runtime_error(std::string("Failed to create serial reader eventfd: ") + std::strerror(errno));
+    }
+
+    fd_ = fd;
+    callback_ = std::move(callback);
+    flush();
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&SerialReader::run, this);
+    utils::tryApplyThreadConfig(thread_.native_handle(), thread_config_);
+}
+
+void SerialReader::setThreadConfig(const utils::thread_config_t& config)
+{
+    utils::checkThreadConfig(config);
+    thread_config_ = config;
+    if (isRunning()) {
+        utils::applyThreadConfig(thread_.native_handle(), thread_config_);
+    }
+}
+
+void SerialReader::stop()
+{
+    if (!thread_.joinable()) {
+        return;
+    }
+
+    std::uint64_t one = 1;
+    if (::write(stop_fd_, &one, sizeof(one)) < 0) {
+        std::cerr << "Failed to wake up serial reader: " << std::strerror(errno) << std::endl;
+    }
+    thread_.join();
+
+    ::close(stop_fd_);
+    stop_fd_ = -1;
+    fd_ = -1;
+    callback_ = nullptr;
+    flush();
+}
+
+std::size_t SerialReader::available() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_index_ - read_index_;
+}
+
+std::size_t SerialReader::waitForData(std::size_t count, std::uint32_t timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    data_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this, count] {
+        return write_index_ - read_index_ >= count || !isRunning();
+    });
+    return write_index_ - read_index_;
+}
+
+std::size_t SerialReader::read(std::uint8_t* data, std::size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size = std::min<std::size_t>(size, write_index_ - read_index_);
+
+    // Copy in at most two parts, before and after the end of the ring.
+    std::size_t offset = read_index_ % ring_.size();
+    std::size_t first = std::min(size, ring_.size() - offset);
+    std::memcpy(data, ring_.data() + offset, first);
+    std::memcpy(data + first, ring_.data(), size - first);
+    read_index_ += size;
+
+    return size;
+}
+
+void SerialReader::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    read_index_ = write_index_;
+}
+
+std::uint64_t SerialReader::droppedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_bytes_;
+}
+
+void SerialReader::run()
+{
+    pollfd fds[2] = {
+        { fd_, POLLIN, 0 },
+        { stop_fd_, POLLIN, 0 },
+    };
+
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Serial reader poll failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (fds[0].revents & (POLLERR | POLLNVAL)) {
+            std::cerr << "Serial reader stopped on serial port error" << std::endl;
+            break;
+        }
+        if (!(fds[0].revents & (POLLIN | POLLHUP))) {
+            continue;
+        }
+
+        if (callback_) {
+            // Callback mode: the ring is only used as read buffer.
+            ssize_t size = ::read(fd_, ring_.data(), ring_.size());
+            if (size < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            if (size == 0 && !(fds[0].revents & POLLHUP)) {
+                continue;
+            }
+            if (size <= 0) {
+                std::cerr << "Serial reader stopped, serial port closed" << std::endl;
+                break;
+            }
+            callback_(ring_.data(), static_cast<std::size_t>(size));
+            continue;
+        }
+
+        // Buffered mode: read straight into the free part of the ring, up to its end.
+        // Consumers only access buffered bytes, so the read itself is done without the lock.
+        std::size_t offset;
+        std::size_t free_size;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (write_index_ - read_index_ == ring_.size()) {
+                // Drop the oldest bytes to make room for at least one contiguous part.
+                std::uint64_t drop = ring_.size() - write_index_ % ring_.size();
+                read_index_ += drop;
+                dropped_bytes_ += drop;
+            }
+            offset = write_index_ % ring_.size();
+            free_size = std::min<std::size_t>(ring_.size() - (write_index_ - read_index_), ring_.size() - offset);
+        }
+
+        ssize_t size = ::read(fd_, ring_.data() + offset, free_size);
+        if (size < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (size == 0 && !(fds[0].revents & POLLHUP)) {
+            continue;
+        }
+        if (size <= 0) {
+            std::cerr << "Serial reader stopped, serial port closed" << std::endl;
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            write_index_ += size;
+        }
+        data_cv_.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false, std::memory_order_release);
+    }
+    data_cv_.notify_all();
+}
+
+} // namespace serial_reader
+
+} // namespace cogip
@@ -0,0 +1,103 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include "utils/ThreadConfig.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cogip {
+
+namespace serial_reader {
+
+/// Default capacity of the byte ring in bytes.
+constexpr std::size_t DEFAULT_RING_CAPACITY = 8192;
+
+/// @class SerialReader
+/// Reads a serial port from a dedicated thread sleeping in poll() until bytes arrive.
+///
+/// Bytes are either passed to a callback, with the exact count of each read,
+/// or buffered in a byte ring allocated once at construction, for drivers pulling their data with timeouts.
+/// If the ring is full, the oldest bytes are dropped.
+class SerialReader {
+public:
+    /// Function called from the reader thread with the bytes of each read.
+    using ReadCallback = std::function<void(const std::uint8_t* data, std::size_t size)>;
+
+    /// Constructs a stopped reader.
+    /// @param capacity Capacity of the byte ring, also the maximum size of a single read.
+    explicit SerialReader(std::size_t capacity = DEFAULT_RING_CAPACITY);
+
+    /// Stops the reader thread.
+    ~SerialReader();
+
+    SerialReader(const SerialReader&) = delete;             ///< Deleted copy constructor.
+    SerialReader& operator=(const SerialReader&) = delete;  ///< Deleted copy assignment.
+
+    /// Starts the reader thread.
+    /// @param fd File descriptor of the open serial port, it must stay open until stop().
+    /// @param callback Function receiving the bytes of each read, if empty bytes are buffered in the ring.
+    void start(int fd, ReadCallback callback = nullptr);
+
+    /// Stops the reader thread and empties the ring. Does nothing if the reader is stopped.
+    void stop();
+
+    /// Set the scheduling of the reader thread, applied at each start and at once if the thread runs.
+    /// @throws std::invalid_argument if the configuration is invalid.
+    /// @throws std::runtime_error if the system refuses the configuration of the running thread.
+    void setThreadConfig(const utils::thread_config_t& config);
+
+    /// Whether the reader thread is running. It stops by itself if the serial port fails or hangs up.
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /// Number of bytes buffered in the ring.
+    std::size_t available() const;
+
+    /// Waits until the ring holds at least a number of bytes.
+    /// @param count Number of bytes to wait for.
+    /// @param timeout_ms Maximum time to wait in milliseconds.
+    /// @returns Number of bytes buffered when waking up, less than count on timeout.
+    std::size_t waitForData(std::size_t count, std::uint32_t timeout_ms);
+
+    /// Copies bytes out of the ring.
+    /// @param data Output buffer.
+    /// @param size Maximum number of bytes to copy.
+    /// @returns Number of bytes copied.
+    std::size_t read(std::uint8_t* data, std::size_t size);
+
+    /// Drops all bytes buffered in the ring.
+    void flush();
+
+    /// Number of bytes dropped because the ring was full.
+    std::uint64_t droppedBytes() const;
+
+private:
+    /// Loop of the reader thread.
+    void run();
+
+    std::vector<std::uint8_t> ring_;  ///< Byte ring, also the read buffer in callback mode.
+    std::uint64_t read_index_;        ///< Count of bytes consumed, taken modulo the capacity to access the ring.
+    std::uint64_t write_index_;       ///< Count of bytes buffered, taken modulo the capacity to access the ring.
+    std::uint64_t dropped_bytes_;     ///< Count of bytes dropped because the ring was full.
+    mutable std::mutex mutex_;        ///< Protects the ring indexes.
+    std::condition_variable data_cv_; ///< Notified when bytes are buffered or the reader stops.
+
+    int fd_;                          ///< Serial port file descriptor.
+    int stop_fd_;                     ///< Eventfd waking the reader thread up to stop it.
+    ReadCallback callback_;           ///< Function receiving the bytes, empty to buffer them.
+    std::atomic<bool> running_;       ///< Whether the reader thread is running.
+    std::thread thread_;              ///< Reader thread.
+    utils::thread_config_t thread_config_;  ///< Scheduling of the reader thread.
+};
+
+} // namespace serial_reader
+
+} // namespace cogip
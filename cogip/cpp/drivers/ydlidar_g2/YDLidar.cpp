@@ -1,5 +1,6 @@
 #include "ydlidar_g2/timer.h"
 #include "ydlidar_g2/YDLidar.h"
+#include "logger/Trace.hpp"
 
 #include <algorithm>
 #include <cmath>
@@ -14,41 +15,18 @@ using namespace std;
 namespace ydlidar {
 
 YDLidar::YDLidar(double (*external_lidar_data)[3]) :
-    lidar_data_(external_lidar_data),
-    external_data_(external_lidar_data != nullptr) {
-    if (!external_data_) {
-        // Allocate memory if external pointer is not provided
-        lidar_data_ = new double[MAX_DATA_COUNT][3]();
-    }
-
-    commonInit();
-}
-
-YDLidar::YDLidar(nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>> external_lidar_raw_points) :
-    lidar_data_(reinterpret_cast<double(*)[3]>(external_lidar_raw_points.data())),
-    external_data_(true) {
-    if (!lidar_data_) {
-        throw std::runtime_error("Failed to initialize from external NumPy array.");
-    }
-
+    LidarDriver(external_lidar_data) {
     commonInit();
 }
 
 void YDLidar::commonInit() {
     lidar_ptr_ = nullptr;
-    data_write_lock_ = nullptr;
-    min_intensity_ = 0;
-    min_distance_ = 0;
-    max_distance_ = std::numeric_limits<uint16_t>::max();
-    min_invalid_angle_ = 0;
-    max_invalid_angle_ = 0;
     sample_rate_ = 5;
     scan_frequency_ = 12;
     refresh_interval_ = int64_t(std::ceil(1000.0 / scan_frequency_));
     is_scanning_ = false;
     frequency_offset_ = 0.4f;
     point_time_ = static_cast<int>(1e9 / 5000);
-    global_nodes_ = new node_info_t[MAX_SCAN_NODES];
     first_node_time_ = getCurrentTime();
     last_node_time_ = getCurrentTime();
     last_frequency_ = 0;
@@ -57,18 +35,30 @@ void YDLidar::commonInit() {
 
 YDLidar::~YDLidar() {
     disconnect();
+}
+
+void YDLidar::setRxThreadConfig(const cogip::utils::thread_config_t& config) {
+    cogip::utils::checkThreadConfig(config);
+    rx_thread_config_ = config;
+    if (lidar_ptr_) {
+        lidar_ptr_->setRxThreadConfig(rx_thread_config_);
+    }
+}
 
-    if (global_nodes_) {
-        delete[] global_nodes_;
-        global_nodes_ = NULL;
+void YDLidar::setScanThreadConfig(const cogip::utils::thread_config_t& config) {
+    cogip::utils::checkThreadConfig(config);
+    scan_thread_config_ = config;
+    if (lidar_ptr_) {
+        lidar_ptr_->setScanThreadConfig(scan_thread_config_);
     }
+}
 
-    if (!external_data_) {
-        // Deallocate memory only if it was internally allocated
-        delete[] lidar_data_;
+void YDLidar::setPublishThreadConfig(const cogip::utils::thread_config_t& config) {
+    cogip::utils::checkThreadConfig(config);
+    publish_thread_config_ = config;
+    if (update_shm_thread_.joinable()) {
+        cogip::utils::applyThreadConfig(update_shm_thread_.native_handle(), publish_thread_config_);
     }
-    lidar_data_ = nullptr;
-    data_write_lock_ = nullptr;
 }
 
 bool YDLidar::connect(const std::string& serial_port_name) {
@@ -85,6 +75,9 @@ bool YDLidar::connect(const std::string& serial_port_name) {
 
         std::cout << "[YDLidar] Initialization succeeded" << std::endl;
     }
+    lidar_ptr_->setRxThreadConfig(rx_thread_config_);
+    lidar_ptr_->setScanThreadConfig(scan_thread_config_);
+    lidar_ptr_->setHealthDriver(this);
 
     result_t op_result = lidar_ptr_->connect(serial_port_name.c_str());
 
@@ -106,7 +99,8 @@ bool YDLidar::connect(const std::string& serial_port_name) {
     }
 
     update_shm_thread_exit_flag_ = false;
-    update_shm_thread_ = new std::thread(&YDLidar::updateSharedMemory, this);
+    update_shm_thread_ = std::thread(&YDLidar::updateSharedMemory, this);
+    cogip::utils::tryApplyThreadConfig(update_shm_thread_.native_handle(), publish_thread_config_);
 
     std::cout << "[YDLidar] Init success" << std::endl;
 
@@ -143,7 +137,11 @@ bool YDLidar::start() {
     return true;
 }
 
-bool YDLidar::doProcessSimple(laser_scan_t& outscan) {
+bool YDLidar::processScan(uint64_t& end_timestamp) {
+    COGIP_TRACE_SPAN("YDLidar::processScan");
+    beginScan(0);
+    end_timestamp = 0;
+
     if (!checkHardware()) {
         delay(200 / scan_frequency_);
         all_node_ = 0;
@@ -151,16 +149,16 @@ bool YDLidar::doProcessSimple(laser_scan_t& outscan) {
         return false;
     }
 
-    size_t count = MAX_SCAN_NODES;
+    const node_info_t* nodes = nullptr;
+    size_t count = 0;
 
-    // Wait scan data:
+    // Wait scan data, read in place:
     uint64_t tim_scan_start = getCurrentTime();
     uint64_t startTs = tim_scan_start;
-    result_t op_result = lidar_ptr_->grabScanData(global_nodes_, count);
+    result_t op_result = lidar_ptr_->grabScanData(nodes, count);
     uint64_t tim_scan_end = getCurrentTime();
     uint64_t endTs = tim_scan_end;
     uint64_t sys_scan_time = tim_scan_end - tim_scan_start;
-    outscan.points.clear();
 
     // Fill in scan data:
     if (IS_OK(op_result)) {
@@ -171,14 +169,14 @@ bool YDLidar::doProcessSimple(laser_scan_t& outscan) {
 
         bool HighPayLoad = false;
 
-        if (global_nodes_[0].stamp > 0 &&
-            global_nodes_[0].stamp < tim_scan_start) {
-            tim_scan_end = global_nodes_[0].stamp;
+        if (nodes[0].stamp > 0 &&
+            nodes[0].stamp < tim_scan_start) {
+            tim_scan_end = nodes[0].stamp;
             HighPayLoad = true;
         }
 
         tim_scan_end -= point_time_;
-        tim_scan_end -= global_nodes_[0].delay_time;
+        tim_scan_end -= nodes[0].delay_time;
         tim_scan_start = tim_scan_end - scan_time;
 
         if (!HighPayLoad && tim_scan_start < startTs) {
@@ -202,6 +200,8 @@ bool YDLidar::doProcessSimple(laser_scan_t& outscan) {
 
         last_node_time_ = tim_scan_end;
 
+        beginScan(tim_scan_start);
+
         int all_node_count = count;
 
         float scanfrequency = 0.0;
@@ -211,44 +211,34 @@ bool YDLidar::doProcessSimple(laser_scan_t& outscan) {
         float angle = 0.0;
 
         for (int i = 0; i < count; i++) {
-            const node_info_t& node = global_nodes_[i];
-
             // Get angle
             angle = static_cast<float>(
-                (global_nodes_[i].angle_q6_checkbit >> LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) / 64.0f
+                (nodes[i].angle_q6_checkbit >> LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) / 64.0f
                 );
 
             // Counter clockwise
             angle = 360 - angle;
 
             // Get range
-            range = static_cast<float>(global_nodes_[i].distance_q2 / 4.f);
+            range = static_cast<float>(nodes[i].distance_q2 / 4.f);
 
             // Get intensity
-            intensity = static_cast<float>(global_nodes_[i].sync_quality);
+            intensity = static_cast<float>(nodes[i].sync_quality);
             // Original range is on 10 bits, so from 0 to 1023.
             // Convert it in the range from 0 to 255.
             intensity = intensity / 4.0;
 
-            if (
-                (angle <= min_invalid_angle_ || angle >= max_invalid_angle_) &&
-                (range >= min_distance_ && range <= max_distance_) &&
-                (intensity >= min_intensity_)
-                ) {
-                laser_point_t point;
-                point.angle = angle;
-                point.range = range;
-                point.intensity = intensity;
-
-                outscan.points.push_back(point);
-            }
+            // Nodes are evenly spaced between the scan start and end times.
+            addPoint(angle, range, intensity, tim_scan_start + point_time_ * i);
 
-            if (global_nodes_[i].scan_frequency != 0) {
-                scanfrequency = global_nodes_[i].scan_frequency / 10.0;
+            if (nodes[i].scan_frequency != 0) {
+                scanfrequency = nodes[i].scan_frequency / 10.0;
             }
 
         }
 
+        end_timestamp = tim_scan_end;
+
         // resample sample rate
         resample(scanfrequency, count, tim_scan_end, tim_scan_start);
         return true;
@@ -266,34 +256,14 @@ bool YDLidar::doProcessSimple(laser_scan_t& outscan) {
 }
 
 void YDLidar::updateSharedMemory() {
-    laser_scan_t scan;
-
     while (!update_shm_thread_exit_flag_.load()) {
         auto loop_start_time = std::chrono::steady_clock::now();
 
-        doProcessSimple(scan);
-        if (data_write_lock_ != nullptr) {
-            data_write_lock_->startWriting();
-        }
-        size_t index = 0;
-        for (auto point : scan.points) {
-            if (index >= MAX_DATA_COUNT - 1) {
-                std::cerr << "[YDLidar] Warning: Scan data exceeds buffer size (" << MAX_DATA_COUNT << "). Truncating." << std::endl;
-                break;
-            }
+        // An empty scan is published if no scan was grabbed, so readers see the lidar is not scanning.
+        uint64_t end_timestamp = 0;
+        processScan(end_timestamp);
+        publishScan(end_timestamp);
 
-            lidar_data_[index][0] = point.angle;
-            lidar_data_[index][1] = point.range;
-            lidar_data_[index][2] = point.intensity;
-            index++;
-        }
-        lidar_data_[index][0] = -1;
-        lidar_data_[index][1] = -1;
-        lidar_data_[index][2] = -1;
-        if (data_write_lock_ != nullptr) {
-            data_write_lock_->finishWriting();
-            data_write_lock_->postUpdate();
-        }
         auto loop_end_time = std::chrono::steady_clock::now();
         auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(loop_end_time - loop_start_time);
         if (elapsed_time < std::chrono::milliseconds(refresh_interval_)) {
@@ -321,10 +291,8 @@ bool YDLidar::stop() {
 void YDLidar::disconnect() {
     update_shm_thread_exit_flag_ = true;
 
-    if ((update_shm_thread_ != nullptr) && update_shm_thread_->joinable()) {
-        update_shm_thread_->join();
-        delete update_shm_thread_;
-        update_shm_thread_ = nullptr;
+    if (update_shm_thread_.joinable()) {
+        update_shm_thread_.join();
     }
 
     if (lidar_ptr_) {
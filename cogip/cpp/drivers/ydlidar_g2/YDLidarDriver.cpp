@@ -11,9 +11,12 @@ namespace ydlidar {
 
 YDlidarDriver::YDlidarDriver() {
     intensity_bit_ = 10;
-    scan_node_buf_ = new node_info_t[MAX_SCAN_NODES];
-    scan_node_count_ = 0;
-    package_sample_index_ = 0;
+    scan_node_buf_ = new node_info_t[SCAN_SLOT_COUNT * MAX_SCAN_NODES];
+    memset(scan_node_buf_, 0, SCAN_SLOT_COUNT * MAX_SCAN_NODES * sizeof(node_info_t));
+    memset(scan_node_counts_, 0, sizeof(scan_node_counts_));
+    scan_write_slot_ = 0;
+    scan_ready_slot_ = 1;
+    scan_read_slot_ = 2;
     serial_ = nullptr;
     is_scanning_ = false;
     is_connected_ = false;
@@ -26,15 +29,13 @@ YDlidarDriver::YDlidarDriver() {
     interval_sample_angle_ = 0.0;
     first_sample_angle_ = 0;
     last_sample_angle_ = 0;
-    check_sum_ = 0;
-    checksum_cal_ = 0;
-    sample_num_and_ct_cal_ = 0;
-    last_sample_angle_cal_ = 0;
     checksum_result_ = true;
-    val_u8_to_u16_ = 0;
     package_ct_ = CT_Normal;
     now_package_num = 0;
-    package_sample_num_ = 0;
+    scan_bytes_begin_ = 0;
+    scan_bytes_end_ = 0;
+    package_node_count_ = 0;
+    package_node_pos_ = 0;
     last_device_byte_ = 0x00;
     async_recv_pos_ = 0;
     async_size_ = 0;
@@ -60,6 +61,8 @@ YDlidarDriver::~YDlidarDriver() {
 
     ScopedLocker lck(cmd_lock_);
 
+    serial_reader_.stop();
+
     if (serial_) {
         if (serial_->IsOpen()) {
             serial_->FlushInputBuffer();
@@ -96,6 +99,10 @@ result_t YDlidarDriver::connect(const char* port_path) {
         is_connected_ = true;
     }
 
+    if (!serial_reader_.isRunning()) {
+        serial_reader_.start(serial_->GetFileDescriptor());
+    }
+
     stopScan();
     std::this_thread::sleep_for(std::chrono::milliseconds(1100));
     clearDTR();
@@ -124,6 +131,12 @@ void YDlidarDriver::clearDTR() {
     }
 }
 void YDlidarDriver::flushSerial() {
+    // Drop the bytes and nodes of the packages being decoded.
+    scan_bytes_begin_ = 0;
+    scan_bytes_end_ = 0;
+    package_node_count_ = 0;
+    package_node_pos_ = 0;
+
     if (!is_connected_) {
         return;
     }
@@ -131,6 +144,9 @@ void YDlidarDriver::flushSerial() {
     serial_->FlushIOBuffers();
 
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // Also drop the bytes already moved to the reader ring.
+    serial_reader_.flush();
 }
 
 
@@ -143,6 +159,8 @@ void YDlidarDriver::disconnect() {
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
     ScopedLocker l(cmd_lock_);
 
+    serial_reader_.stop();
+
     if (serial_) {
         if (serial_->IsOpen()) {
             serial_->Close();
@@ -231,17 +249,12 @@ result_t YDlidarDriver::getData(uint8_t* data, size_t size) {
         return RESULT_FAIL;
     }
 
-    static LibSerial::DataBuffer buffer(1024);
-
-    try {
-        serial_->Read(buffer, size, DEFAULT_TIMEOUT);
-    }
-    catch (const LibSerial::ReadTimeout& e) {
+    if (serial_reader_.waitForData(size, DEFAULT_TIMEOUT) < size) {
         return RESULT_FAIL;
     }
-
-    for (size_t i = 0; i < size; i++) {
-        data[i] = buffer[i];
+    serial_reader_.read(data, size);
+    if (health_driver_) {
+        health_driver_->countBytesRead(size);
     }
 
     return RESULT_OK;
@@ -321,27 +334,13 @@ result_t YDlidarDriver::waitForData(size_t data_count, uint32_t timeout, size_t*
         returned_size = &length;
     }
 
-    auto start_time = std::chrono::steady_clock::now();
-
-    while (true) {
-        // Check if data is available
-        size_t available_bytes = serial_->GetNumberOfBytesAvailable();
-        if (available_bytes >= data_count) {
-            *returned_size = available_bytes;
-            return RESULT_OK;
-        }
-
-        // Check if the timeout has been reached
-        auto current_time = std::chrono::steady_clock::now();
-        auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - start_time).count();
-        if (elapsed_time >= timeout) {
-            *returned_size = available_bytes;
-            return RESULT_TIMEOUT;
-        }
-
-        // Sleep for a short period before checking again
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // The reader thread wakes us up as soon as enough bytes are buffered.
+    *returned_size = serial_reader_.waitForData(data_count, timeout);
+    if (*returned_size >= data_count) {
+        return RESULT_OK;
     }
+
+    return serial_reader_.isRunning() ? RESULT_TIMEOUT : RESULT_FAIL;
 }
 
 void YDlidarDriver::CheckLaserStatus() {
@@ -362,10 +361,12 @@ void YDlidarDriver::CheckLaserStatus() {
 int YDlidarDriver::cacheScanData() {
     node_info_t      local_buf[128];
     size_t         count = 128;
-    node_info_t      local_scan[MAX_SCAN_NODES];
+    node_info_t*     local_scan = scan_node_buf_ + scan_write_slot_ * MAX_SCAN_NODES;
     size_t         scan_count = 0;
     result_t       ans = RESULT_FAIL;
-    memset(local_scan, 0, sizeof(local_scan));
+    memset(local_scan, 0, MAX_SCAN_NODES * sizeof(node_info_t));
+    // Drop a circle left by a previous scan.
+    scan_ready_slot_.fetch_and(static_cast<uint8_t>(~SCAN_SLOT_FRESH), std::memory_order_relaxed);
 
     flushSerial();
     waitScanData(local_buf, count);
@@ -385,6 +386,12 @@ int YDlidarDriver::cacheScanData() {
             else {
                 timeout_count++;
                 local_scan[0].sync_flag = NODE_NOT_SYNC;
+                if (health_driver_) {
+                    health_driver_->countReadTimeout();
+                    if (scan_count > 0) {
+                        health_driver_->countDroppedRevolution();
+                    }
+                }
 
                 if (driver_errno_ == NoError) {
                     setDriverError(TimeoutError);
@@ -401,12 +408,19 @@ int YDlidarDriver::cacheScanData() {
         for (size_t pos = 0; pos < count; ++pos) {
             if (local_buf[pos].sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT) {
                 if (local_scan[0].sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT) {
-                    lock_.lock(); // timeout lock, wait resource copy
+                    // Publish the circle and continue in the slot released by the previous publication.
                     local_scan[0].delay_time = local_buf[pos].delay_time;
-                    memcpy(scan_node_buf_, local_scan, scan_count * sizeof(node_info_t));
-                    scan_node_count_ = scan_count;
+                    scan_node_counts_[scan_write_slot_] = scan_count;
+                    uint8_t released = scan_ready_slot_.exchange(
+                        scan_write_slot_ | SCAN_SLOT_FRESH, std::memory_order_acq_rel
+                    );
+                    if ((released & SCAN_SLOT_FRESH) && health_driver_) {
+                        // The previous circle was replaced before being grabbed.
+                        health_driver_->countDroppedRevolution();
+                    }
+                    scan_write_slot_ = released & ~SCAN_SLOT_FRESH;
+                    local_scan = scan_node_buf_ + scan_write_slot_ * MAX_SCAN_NODES;
                     data_event_.set();
-                    lock_.unlock();
                 }
 
                 scan_count = 0;
@@ -414,7 +428,7 @@ int YDlidarDriver::cacheScanData() {
 
             local_scan[scan_count++] = local_buf[pos];
 
-            if (scan_count == _countof(local_scan)) {
+            if (scan_count == MAX_SCAN_NODES) {
                 scan_count -= 1;
             }
         }
@@ -642,304 +656,217 @@ void YDlidarDriver::checkBlockStatus(uint8_t currentByte) {
     }
 }
 
-result_t YDlidarDriver::parseResponseHeader(
-    uint8_t* packageBuffer,
-    uint32_t timeout) {
-    int recvPos = 0;
-    uint32_t startTs = getHDTimer();
-    uint32_t waitTime = 0;
-    block_rev_size = 0;
-    package_sample_num_ = 0;
-    uint8_t package_type = 0;
-    result_t ans = RESULT_TIMEOUT;
-
-    while ((waitTime = getHDTimer() - startTs) <= timeout) {
-        size_t remainSize = PACKAGE_PAID_BYTES - recvPos;
-        size_t recvSize = 0;
-        ans = waitForData(remainSize, timeout - waitTime, &recvSize);
+namespace {
 
-        if (!IS_OK(ans))
-            return ans;
-
-        if (recvSize > remainSize)
-            recvSize = remainSize;
+/// Checksum of a scan package: the xor of the header words, the quality bytes and the little-endian distances.
+/// Its low byte is then the xor of the quality and distance low bytes and its high byte the xor of the distance high bytes,
+/// so the samples are folded with two byte loops instead of one branch per byte.
+uint16_t packageCheckSum(const uint8_t* package, size_t sample_count) {
+    const node_package_t* header = reinterpret_cast<const node_package_t*>(package);
+    uint16_t checksum = PH;
+    checksum ^= header->package_first_sample_angle;
+    checksum ^= header->package_ct | (header->now_package_num << 8);
+    checksum ^= header->package_last_sample_angle;
 
-        getData(global_recv_buffer_, recvSize);
+    const uint8_t* samples = package + PACKAGE_PAID_BYTES;
+    size_t size = sample_count * sizeof(package_node_t);
+    uint8_t all_bytes = 0;
+    uint8_t high_bytes = 0;
+    for (size_t pos = 0; pos < size; ++pos) {
+        all_bytes ^= samples[pos];
+    }
+    for (size_t pos = 2; pos < size; pos += sizeof(package_node_t)) {
+        high_bytes ^= samples[pos];
+    }
 
-        for (size_t pos = 0; pos < recvSize; ++pos) {
-            uint8_t currentByte = global_recv_buffer_[pos];
+    return checksum ^ static_cast<uint16_t>((all_bytes ^ high_bytes) | (high_bytes << 8));
+}
 
-            switch (recvPos) {
-            case 0:
-                if (currentByte != PH1) {
-                    checkBlockStatus(currentByte);
-                    continue;
-                }
-                break;
+} // namespace
 
-            case 1:
-            {
-                checksum_cal_ = PH;
-                if (currentByte == PH2) {
-                    if (driver_errno_ == BlockError) {
-                        setDriverError(NoError);
-                    }
-                }
-                else if (currentByte == PH3) {
-                    recvPos = 0;
-                    size_t lastPos = pos - 1;
-                    int remainSize = SIZE_STAMP_PACKAGE - (recvSize - pos + 1);
-                    if (remainSize > 0) {
-                        size_t lastSize = recvSize;
-                        ans = waitForData(remainSize, timeout - waitTime, &recvSize);
-                        if (!IS_OK(ans))
-                            return ans;
-                        if (recvSize > remainSize)
-                            recvSize = remainSize;
-                        getData(&global_recv_buffer_[lastSize], recvSize);
-                        recvSize += lastSize;
-                        pos = PACKAGE_PAID_BYTES;
-                    }
-                    else {
-                        pos += 6;
-                    }
+result_t YDlidarDriver::readScanBytes(size_t needed, uint32_t timeout) {
+    // Keep the undecoded bytes at the start of the buffer, so a package is always contiguous.
+    if (scan_bytes_begin_ > 0) {
+        memmove(scan_bytes_, scan_bytes_ + scan_bytes_begin_, scan_bytes_end_ - scan_bytes_begin_);
+        scan_bytes_end_ -= scan_bytes_begin_;
+        scan_bytes_begin_ = 0;
+    }
 
-                    uint8_t csc = 0;
-                    uint8_t csr = 0;
-                    for (int i = 0; i < SIZE_STAMP_PACKAGE; ++i) {
-                        if (i == 2)
-                            csr = global_recv_buffer_[lastPos + i];
-                        else
-                            csc ^= global_recv_buffer_[lastPos + i];
-                    }
-                    if (csc != csr) {
-                        std::cerr << "Stamp checksum error c[0x" << std::hex << static_cast<int>(csc)
-                                  << "] != r[0x" << static_cast<int>(csr) << "]" << std::dec << std::endl;
-                    }
-                    else {
-                        stamp_package_t sp;
-                        memcpy(&sp, &global_recv_buffer_[lastPos], SIZE_STAMP_PACKAGE);
-                        stamp_ = uint64_t(sp.stamp) * 1000000;
-                    }
+    size_t missing = needed > scan_bytes_end_ ? needed - scan_bytes_end_ : 1;
+    result_t ans = waitForData(missing, timeout);
+    if (!IS_OK(ans)) {
+        return ans;
+    }
 
-                    continue;
-                }
-                else {
-                    has_package_error = true;
-                    recvPos = 0;
-                    continue;
-                }
-                break;
-            }
-            case 2:
-                sample_num_and_ct_cal_ = currentByte;
-                package_type = currentByte & 0x01;
-
-                if ((package_type == CT_Normal) ||
-                    (package_type == CT_RingStart)) {
-                    if (package_type == CT_RingStart) {
-                        scan_frequency_ = (currentByte & 0xFE) >> 1;
-                    }
-                }
-                else {
-                    has_package_error = true;
-                    recvPos = 0;
-                    continue;
-                }
-                break;
+    // Take everything already received, usually several packages at once.
+    size_t size = serial_reader_.read(scan_bytes_ + scan_bytes_end_, SCAN_BYTES_SIZE - scan_bytes_end_);
+    scan_bytes_end_ += size;
+    if (health_driver_) {
+        health_driver_->countBytesRead(size);
+    }
 
-            case 3:
-                sample_num_and_ct_cal_ += (currentByte * 0x100);
-                package_sample_num_ = currentByte;
-                break;
+    return RESULT_OK;
+}
 
-            case 4:
-                if (currentByte & LIDAR_RESP_MEASUREMENT_CHECKBIT) {
-                    first_sample_angle_ = currentByte;
-                }
-                else {
-                    has_package_error = true;
-                    recvPos = 0;
-                    continue;
-                }
-                break;
+void YDlidarDriver::parseStampPackage(const uint8_t* package) {
+    uint8_t csc = 0;
+    uint8_t csr = 0;
+    for (size_t i = 0; i < SIZE_STAMP_PACKAGE; ++i) {
+        if (i == 2)
+            csr = package[i];
+        else
+            csc ^= package[i];
+    }
+    if (health_driver_) {
+        health_driver_->countPacket(csc == csr, getCurrentTime());
+    }
+    if (csc != csr) {
+        std::cerr << "Stamp checksum error c[0x" << std::hex << static_cast<int>(csc)
+                  << "] != r[0x" << static_cast<int>(csr) << "]" << std::dec << std::endl;
+    }
+    else {
+        stamp_package_t sp;
+        memcpy(&sp, package, SIZE_STAMP_PACKAGE);
+        stamp_ = uint64_t(sp.stamp) * 1000000;
+    }
+}
 
-            case 5:
-                first_sample_angle_ += currentByte * 0x100;
-                checksum_cal_ ^= first_sample_angle_;
-                first_sample_angle_ = first_sample_angle_ >> 1;
-                break;
+result_t YDlidarDriver::decodeScanPackage(uint32_t timeout) {
+    uint32_t startTs = getHDTimer();
+    uint32_t waitTime = 0;
+    block_rev_size = 0;
 
-            case 6:
-                if (currentByte & LIDAR_RESP_MEASUREMENT_CHECKBIT) {
-                    last_sample_angle_ = currentByte;
-                }
-                else {
-                    has_package_error = true;
-                    recvPos = 0;
+    while (true) {
+        const uint8_t* begin = scan_bytes_ + scan_bytes_begin_;
+        const uint8_t* end = scan_bytes_ + scan_bytes_end_;
+
+        // Skip to the next package head, the skipped bytes may show a blocked device.
+        const uint8_t* head = static_cast<const uint8_t*>(memchr(begin, PH1, end - begin));
+        if (head == nullptr) {
+            head = end;
+        }
+        for (const uint8_t* byte = begin; byte < head; ++byte) {
+            checkBlockStatus(*byte);
+        }
+        scan_bytes_begin_ = head - scan_bytes_;
+
+        size_t buffered = end - head;
+        size_t needed = 2;
+        if (buffered >= needed) {
+            if (head[1] == PH3) {
+                needed = SIZE_STAMP_PACKAGE;
+                if (buffered >= needed) {
+                    parseStampPackage(head);
+                    scan_bytes_begin_ += needed;
                     continue;
                 }
+            }
+            else if (head[1] != PH2) {
+                has_package_error = true;
+                scan_bytes_begin_++;
+                continue;
+            }
+            else {
+                needed = PACKAGE_PAID_BYTES;
+                if (buffered >= needed) {
+                    if (!(head[4] & LIDAR_RESP_MEASUREMENT_CHECKBIT) || !(head[6] & LIDAR_RESP_MEASUREMENT_CHECKBIT)) {
+                        has_package_error = true;
+                        scan_bytes_begin_++;
+                        continue;
+                    }
+                    if (driver_errno_ == BlockError) {
+                        setDriverError(NoError);
+                    }
 
-                break;
-
-            case 7:
-                last_sample_angle_ = currentByte * 0x100 + last_sample_angle_;
-                last_sample_angle_cal_ = last_sample_angle_;
-                last_sample_angle_ = last_sample_angle_ >> 1;
-
-                if (package_sample_num_ == 1) {
-                    interval_sample_angle_ = 0;
-                }
-                else {
-                    if (last_sample_angle_ < first_sample_angle_) {
-                        if ((first_sample_angle_ > 270 * 64) && (last_sample_angle_ < 90 * 64)) {
-                            interval_sample_angle_ = (float)((360 * 64 + last_sample_angle_ -
-                                first_sample_angle_) /
-                                ((
-                                    package_sample_num_ - 1) *
-                                    1.0));
-                            interval_sample_angle_last_package_ = interval_sample_angle_;
-                        }
-                        else {
-                            interval_sample_angle_ = interval_sample_angle_last_package_;
+                    needed += head[3] * package_sample_bytes;
+                    if (buffered >= needed) {
+                        // The package is complete in the buffer, decode it in place.
+                        decodePackageNodes(reinterpret_cast<const node_package_t*>(head));
+                        scan_bytes_begin_ += needed;
+                        if (package_node_count_ > 0) {
+                            return RESULT_OK;
                         }
-                    }
-                    else {
-                        interval_sample_angle_ = (float)((last_sample_angle_ - first_sample_angle_) / ((
-                            package_sample_num_ - 1) *
-                            1.0));
-                        interval_sample_angle_last_package_ = interval_sample_angle_;
+                        continue;
                     }
                 }
-
-                break;
-
-            case 8:
-                check_sum_ = currentByte;
-                break;
-
-            case 9:
-                check_sum_ += (currentByte * 0x100);
-                break;
             }
-
-            packageBuffer[recvPos++] = currentByte;
         }
 
-        if (recvPos == PACKAGE_PAID_BYTES) {
-            ans = RESULT_OK;
-            break;
+        if ((waitTime = getHDTimer() - startTs) > timeout) {
+            return RESULT_TIMEOUT;
+        }
+        result_t ans = readScanBytes(needed, timeout - waitTime);
+        if (!IS_OK(ans)) {
+            return ans;
         }
-
-        ans = RESULT_TIMEOUT;
     }
-
-    return ans;
 }
 
-result_t YDlidarDriver::parseResponseScanData(
-    uint8_t* packageBuffer,
-    uint32_t timeout) {
-    int recvPos = 0;
-    uint32_t startTs = getHDTimer();
-    uint32_t waitTime = 0;
-    result_t ans = RESULT_TIMEOUT;
-
-    while ((waitTime = getHDTimer() - startTs) <= timeout) {
-        size_t remainSize = package_sample_num_ * package_sample_bytes - recvPos;
-        size_t recvSize = 0;
-        ans = waitForData(remainSize, timeout - waitTime, &recvSize);
-
-        if (!IS_OK(ans))
-            return ans;
-
-        if (recvSize > remainSize)
-            recvSize = remainSize;
-
-        getData(global_recv_buffer_, recvSize);
+void YDlidarDriver::decodePackageNodes(const node_package_t* package) {
+    package_ct_ = package->package_ct;
+    now_package_num = package->now_package_num;
+    if ((package_ct_ & 0x01) == CT_RingStart) {
+        scan_frequency_ = (package_ct_ & 0xFE) >> 1;
+    }
+    first_sample_angle_ = package->package_first_sample_angle >> 1;
+    last_sample_angle_ = package->package_last_sample_angle >> 1;
 
-        for (size_t pos = 0; pos < recvSize; ++pos) {
-            if (recvPos % 3 == 2) {
-                val_u8_to_u16_ += global_recv_buffer_[pos] * 0x100;
-                checksum_cal_ ^= val_u8_to_u16_;
-            }
-            else if (recvPos % 3 == 1) {
-                val_u8_to_u16_ = global_recv_buffer_[pos];
+    if (now_package_num == 1) {
+        interval_sample_angle_ = 0;
+    }
+    else {
+        if (last_sample_angle_ < first_sample_angle_) {
+            if ((first_sample_angle_ > 270 * 64) && (last_sample_angle_ < 90 * 64)) {
+                interval_sample_angle_ = (float)((360 * 64 + last_sample_angle_ -
+                    first_sample_angle_) /
+                    ((
+                        now_package_num - 1) *
+                        1.0));
+                interval_sample_angle_last_package_ = interval_sample_angle_;
             }
             else {
-                checksum_cal_ ^= global_recv_buffer_[pos];
+                interval_sample_angle_ = interval_sample_angle_last_package_;
             }
-
-            packageBuffer[PACKAGE_PAID_BYTES + recvPos] = global_recv_buffer_[pos];
-            recvPos++;
         }
-
-        if (package_sample_num_ * package_sample_bytes == recvPos) {
-            ans = RESULT_OK;
-            break;
+        else {
+            interval_sample_angle_ = (float)((last_sample_angle_ - first_sample_angle_) / ((
+                now_package_num - 1) *
+                1.0));
+            interval_sample_angle_last_package_ = interval_sample_angle_;
         }
     }
 
-    if (package_sample_num_ * package_sample_bytes != recvPos) {
-        return RESULT_FAIL;
+    checksum_result_ = packageCheckSum(reinterpret_cast<const uint8_t*>(package), now_package_num) == package->checksum;
+    if (!checksum_result_) {
+        has_package_error = true;
     }
-
-    return ans;
-}
-
-result_t YDlidarDriver::waitPackage(node_info_t* node, uint32_t timeout) {
-    node->index = 255;
-    node->scan_frequency = 0;
-    node->error_package = 0;
-    node->debug_info = 0xff;
-
-    if (package_sample_index_ == 0) {
-        uint8_t* packageBuffer = (uint8_t*)&package_.package_head;
-        result_t ans = parseResponseHeader(packageBuffer, timeout);
-        if (!IS_OK(ans)) {
-            return ans;
-        }
-
-        ans = parseResponseScanData(packageBuffer, timeout);
-        if (!IS_OK(ans)) {
-            return ans;
-        }
-
-        calculateCheckSum(node);
-        calculatePackageCT();
+    if (health_driver_) {
+        health_driver_->countPacket(checksum_result_, getCurrentTime());
     }
 
-    parseNodeDebugFromBuffer(node);
-    parseNodeFromBuffer(node);
-    return RESULT_OK;
-}
-
-void YDlidarDriver::calculateCheckSum(node_info_t* node) {
-    checksum_cal_ ^= sample_num_and_ct_cal_;
-    checksum_cal_ ^= last_sample_angle_cal_;
-
-    if (checksum_cal_ != check_sum_) {
-        checksum_result_ = false;
-        has_package_error = true;
-        node->error_package = 1;
-    }
-    else {
-        checksum_result_ = true;
+    uint64_t stamp = stamp_ ? stamp_ : getCurrentTime();
+    for (uint16_t index = 0; index < now_package_num; ++index) {
+        node_info_t* node = &package_nodes_[index];
+        node->index = 255;
+        node->scan_frequency = 0;
+        node->error_package = (index == 0 && !checksum_result_) ? 1 : 0;
+        node->debug_info = 0xff;
+        node->stamp = stamp;
+        parseNodeDebugFromBuffer(node, index);
+        parseNodeFromBuffer(node, package->package_sample[index], index);
     }
-}
 
-void YDlidarDriver::calculatePackageCT() {
-    package_ct_ = package_.package_ct;
-    now_package_num = package_.now_package_num;
+    package_node_count_ = now_package_num;
+    package_node_pos_ = 0;
 }
 
-void YDlidarDriver::parseNodeDebugFromBuffer(node_info_t* node) {
+void YDlidarDriver::parseNodeDebugFromBuffer(node_info_t* node, uint16_t index) {
     if ((package_ct_ & 0x01) == CT_Normal) {
         node->sync_flag = NODE_NOT_SYNC;
         node->debug_info = 0xff;
 
         if (!has_package_error) {
-            if (package_sample_index_ == 0) {
+            if (index == 0) {
                 package_index++;
                 node->debug_info = (package_ct_ >> 1);
                 node->index = package_index;
@@ -964,22 +891,21 @@ void YDlidarDriver::parseNodeDebugFromBuffer(node_info_t* node) {
     }
 }
 
-void YDlidarDriver::parseNodeFromBuffer(node_info_t* node) {
+void YDlidarDriver::parseNodeFromBuffer(node_info_t* node, const package_node_t& sample, uint16_t index) {
     int32_t AngleCorrectForDistance = 0;
     node->sync_quality = NODE_DEFAULT_QUALITY;
     node->delay_time = 0;
-    node->stamp = stamp_ ? stamp_ : getCurrentTime();
     node->scan_frequency = scan_frequency_;
     node->is = 0;
 
     if (checksum_result_) {
-        node->sync_quality = ((uint16_t)((package_.package_sample[package_sample_index_].PackageSampleDistance & 0x03) <<
+        uint16_t distance = sample.PackageSampleDistance;
+        node->sync_quality = ((uint16_t)((distance & 0x03) <<
             LIDAR_RESP_MEASUREMENT_ANGLE_SAMPLE_SHIFT) |
-            (package_.package_sample[package_sample_index_].PackageSampleQuality));
+            (sample.PackageSampleQuality));
 
-        node->distance_q2 =
-            package_.package_sample[package_sample_index_].PackageSampleDistance & 0xfffc;
-        node->is = package_.package_sample[package_sample_index_].PackageSampleDistance & 0x0003;
+        node->distance_q2 = distance & 0xfffc;
+        node->is = distance & 0x0003;
 
         if (node->distance_q2 != 0) {
             AngleCorrectForDistance = (int32_t)(((atan(((21.8 * (155.3 - (node->distance_q2 / 4.0))) / 155.3) / (node->distance_q2 / 4.0))) * 180.0 / 3.1415) * 64.0);
@@ -989,7 +915,7 @@ void YDlidarDriver::parseNodeFromBuffer(node_info_t* node) {
             AngleCorrectForDistance = 0;
         }
 
-        float sampleAngle = interval_sample_angle_ * package_sample_index_;
+        float sampleAngle = interval_sample_angle_ * index;
 
         if ((first_sample_angle_ + sampleAngle +
             AngleCorrectForDistance) < 0) {
@@ -1017,13 +943,6 @@ void YDlidarDriver::parseNodeFromBuffer(node_info_t* node) {
         node->distance_q2 = 0;
         node->scan_frequency = 0;
     }
-
-    package_sample_index_++;
-
-    if (package_sample_index_ >= now_package_num) {
-        package_sample_index_ = 0;
-        checksum_result_ = false;
-    }
 }
 
 result_t YDlidarDriver::waitScanData(
@@ -1042,18 +961,21 @@ result_t YDlidarDriver::waitScanData(
 
     while ((waitTime = getHDTimer() - startTs) <= timeout &&
         recvNodeCount < count) {
-        node_info_t node;
-        ans = waitPackage(&node, timeout - waitTime);
+        if (package_node_pos_ == package_node_count_) {
+            ans = decodeScanPackage(timeout - waitTime);
 
-        if (!IS_OK(ans)) {
-            count = recvNodeCount;
-            return ans;
+            if (!IS_OK(ans)) {
+                count = recvNodeCount;
+                return ans;
+            }
         }
 
+        const node_info_t& node = package_nodes_[package_node_pos_++];
         nodebuffer[recvNodeCount++] = node;
 
         if (node.sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT) {
-            size_t size = serial_->GetNumberOfBytesAvailable();
+            // Bytes staged for decoding are still to be processed, as those left in the reader.
+            size_t size = (scan_bytes_end_ - scan_bytes_begin_) + serial_reader_.available();
             uint64_t delayTime = 0;
             if (size > PACKAGE_PAID_BYTES) {
                 size_t packageNum = 0;
@@ -1084,6 +1006,22 @@ result_t YDlidarDriver::waitScanData(
 }
 
 result_t YDlidarDriver::grabScanData(node_info_t* nodebuffer, size_t& count,
+    uint32_t timeout) {
+    const node_info_t* nodes = nullptr;
+    size_t size = 0;
+    result_t ans = grabScanData(nodes, size, timeout);
+
+    if (!IS_OK(ans)) {
+        count = 0;
+        return ans;
+    }
+
+    count = min(count, size);
+    memcpy(nodebuffer, nodes, count * sizeof(node_info_t));
+    return RESULT_OK;
+}
+
+result_t YDlidarDriver::grabScanData(const node_info_t*& nodes, size_t& count,
     uint32_t timeout) {
     switch (data_event_.wait(timeout)) {
     case Event::EVENT_TIMEOUT:
@@ -1092,15 +1030,15 @@ result_t YDlidarDriver::grabScanData(node_info_t* nodebuffer, size_t& count,
 
     case Event::EVENT_OK:
     {
-        if (scan_node_count_ == 0) {
+        if (!(scan_ready_slot_.load(std::memory_order_relaxed) & SCAN_SLOT_FRESH)) {
+            count = 0;
             return RESULT_FAIL;
         }
 
-        ScopedLocker l(lock_);
-        size_t size_to_copy = min(count, scan_node_count_);
-        memcpy(nodebuffer, scan_node_buf_, size_to_copy * sizeof(node_info_t));
-        count = size_to_copy;
-        scan_node_count_ = 0;
+        // Take the latest circle and give the previously read slot back to the scanning thread.
+        scan_read_slot_ = scan_ready_slot_.exchange(scan_read_slot_, std::memory_order_acq_rel) & ~SCAN_SLOT_FRESH;
+        nodes = scan_node_buf_ + scan_read_slot_ * MAX_SCAN_NODES;
+        count = scan_node_counts_[scan_read_slot_];
     }
     return RESULT_OK;
 
@@ -1253,10 +1191,19 @@ result_t YDlidarDriver::createThread() {
         return RESULT_FAIL;
     }
 
+    cogip::utils::tryApplyThreadConfig((pthread_t)thread_.getHandle(), scan_thread_config_);
     is_scanning_ = true;
     return RESULT_OK;
 }
 
+void YDlidarDriver::setScanThreadConfig(const cogip::utils::thread_config_t& config) {
+    cogip::utils::checkThreadConfig(config);
+    scan_thread_config_ = config;
+    if (is_scanning_ && thread_.getHandle() != 0) {
+        cogip::utils::applyThreadConfig((pthread_t)thread_.getHandle(), scan_thread_config_);
+    }
+}
+
 
 result_t YDlidarDriver::startAutoScan(bool force, uint32_t timeout) {
     result_t ans;
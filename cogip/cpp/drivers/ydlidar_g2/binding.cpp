@@ -14,23 +14,31 @@ namespace ydlidar {
 
 NB_MODULE(ydlidar_g2, m) {
     auto shared_memory_module = nb::module_::import_("cogip.cpp.libraries.shared_memory");
+    auto lidar_driver_module = nb::module_::import_("cogip.cpp.drivers.lidar_driver");
+    auto utils_module = nb::module_::import_("cogip.cpp.libraries.utils");
 
-    nb::class_<YDLidar>(m, "YDLidar")
+    nb::class_<YDLidar, cogip::lidar_driver::LidarDriver>(m, "YDLidar")
         .def(nb::init<>(), "Constructor that internally manages memory")
-        .def(nb::init<nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>>>(),
+        .def(
+            "__init__",
+            [](YDLidar* self, nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>> external_lidar_data) {
+                new (self) YDLidar(reinterpret_cast<double(*)[3]>(external_lidar_data.data()));
+            },
             "Constructor accepting nanobind::ndarray",
-            "external_lidar_data"_a
+            "external_lidar_data"_a,
+            nb::keep_alive<1, 2>()
         )
         .def("connect", &YDLidar::connect)
         .def("start", &YDLidar::start)
         .def("stop", &YDLidar::stop)
         .def("disconnect", &YDLidar::disconnect)
-        .def("set_data_write_lock", &YDLidar::setDataWriteLock, "Set the data write lock", "lock"_a)
-        .def("set_min_intensity", &YDLidar::setMinIntensity, "Set the minimum intensity value to validate data", "min_intensity"_a)
-        .def("set_min_distance", &YDLidar::setMinDistance, "Set the minimum distance to validate data", "min_distance"_a)
-        .def("set_max_distance", &YDLidar::setMaxDistance, "Set the maximum distance to validate data", "max_distance"_a)
-        .def("set_invalid_angle_range", &YDLidar::setInvalidAngleRange, "Set the invalid angle range", "min_angle"_a, "max_angle"_a)
         .def("set_scan_frequency", &YDLidar::setScanFrequency, "Set the scan frequency (in kHz)", "frequency"_a)
+        .def("set_rx_thread_config", &YDLidar::setRxThreadConfig,
+             "Set the scheduling of the thread reading the serial port", "config"_a)
+        .def("set_scan_thread_config", &YDLidar::setScanThreadConfig,
+             "Set the scheduling of the thread decoding the scans", "config"_a)
+        .def("set_publish_thread_config", &YDLidar::setPublishThreadConfig,
+             "Set the scheduling of the thread publishing the scans", "config"_a)
     ;
 }
 
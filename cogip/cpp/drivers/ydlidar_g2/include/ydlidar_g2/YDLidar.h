@@ -2,17 +2,14 @@
 
 #include "YDLidarDriver.h"
 
-#include "shared_memory/WritePriorityLock.hpp"
-
-#include <nanobind/nanobind.h>
-#include <nanobind/ndarray.h>
+#include "lidar_driver/LidarDriver.hpp"
 
+#include <atomic>
+#include <cmath>
 #include <map>
 #include <string>
 #include <thread>
 
-namespace nb = nanobind;
-
 /**
  * YDLidar G2 properties:
  * - Baudrate: 230400
@@ -26,42 +23,16 @@ namespace nb = nanobind;
 
 namespace ydlidar {
 
-constexpr std::size_t MAX_DATA_COUNT = 1024;
-
-#pragma pack(1)
-
-/**
- * @brief The Laser Point struct
- */
-typedef struct {
-/// lidar angle. unit(degree)
-float angle;
-/// lidar range. unit(mm)
-float range;
-/// lidar intensity
-float intensity;
-} laser_point_t;
-
-#pragma pack()
+using cogip::lidar_driver::MAX_DATA_COUNT;
 
-/**
- * @brief The Laser Scan Data struct
- */
-typedef struct {
-    /// Array of lidar points
-    std::vector<laser_point_t> points;
-} laser_scan_t;
-
-class YDLidar {
+/// Decoder of the YDLidar G2 scans, feeding them to the publish stage of LidarDriver from its own thread.
+class YDLidar : public cogip::lidar_driver::LidarDriver {
 public:
     /// Constructor with optional external memory pointer
     explicit YDLidar(double (*external_lidar_data)[3] = nullptr);
 
-    /// Constructor accepting a nanobind::ndarray
-    explicit YDLidar(nb::ndarray<double, nb::numpy, nb::shape<MAX_DATA_COUNT, 3>> external_lidar_data);
-
     /// Destructor
-    ~YDLidar();
+    ~YDLidar() override;
 
     /// Opens the communication port and asserts the initialization parameters.
     /// @param serial_port_name The serial device system path (e.g., "/dev/ttyUSB0").
@@ -74,14 +45,6 @@ public:
      */
     bool start();
 
-    /**
-     * @brief Get the LiDAR Scan Data. start is successful before doProcessSimple scan data.
-     * @param[out] outscan             LiDAR Scan Data
-     * @param[out] hardwareError       hardware error status
-     * @return true if successfully started, otherwise false.
-     */
-    bool doProcessSimple(laser_scan_t& outscan);
-
     /**
      * @brief Stop the device scanning thread and disable motor.
      * @return true if successfully Stoped, otherwise false.
@@ -93,32 +56,27 @@ public:
      */
     void disconnect();
 
-    /// Set the minimum intensity value to validate data.
-    void setMinIntensity(uint8_t min_intensity) { min_intensity_ = min_intensity; }
-
-    /// Set the minimum distance to validate data.
-    void setMinDistance(uint16_t min_distance) { min_distance_ = min_distance; }
-
-    /// Set the maximum distance to validate data.
-    void setMaxDistance(uint16_t max_distance) { max_distance_ = max_distance; }
-
-    /// Set the data write lock.
-    void setDataWriteLock(cogip::shared_memory::WritePriorityLock& lock) {
-        data_write_lock_ = &lock;
-    };
-
-    /// Set invalid angle range
-    void setInvalidAngleRange(uint16_t min_angle, uint16_t max_angle) {
-        min_invalid_angle_ = min_angle;
-        max_invalid_angle_ = max_angle;
-    };
-
     /// Set scan frequency (in kHz)
     void setScanFrequency(float frequency) {
         scan_frequency_ = frequency;
         refresh_interval_ = int64_t(std::ceil(1000.0 / scan_frequency_));
     };
 
+    /// Set the scheduling of the thread reading the serial port, applied at once and at each connection.
+    /// @throws std::invalid_argument if the configuration is invalid.
+    /// @throws std::runtime_error if the system refuses the configuration of the running thread.
+    void setRxThreadConfig(const cogip::utils::thread_config_t& config);
+
+    /// Set the scheduling of the thread decoding the scans, applied at once and at each start.
+    /// @throws std::invalid_argument if the configuration is invalid.
+    /// @throws std::runtime_error if the system refuses the configuration of the running thread.
+    void setScanThreadConfig(const cogip::utils::thread_config_t& config);
+
+    /// Set the scheduling of the thread publishing the scans, applied at once and at each connection.
+    /// @throws std::invalid_argument if the configuration is invalid.
+    /// @throws std::runtime_error if the system refuses the configuration of the running thread.
+    void setPublishThreadConfig(const cogip::utils::thread_config_t& config);
+
 private:
     /**
      * @brief check LiDAR health state and device information
@@ -162,18 +120,20 @@ private:
     void resample(int frequency, int count, uint64_t tim_scan_end,
         uint64_t tim_scan_start);
 
+    /**
+     * @brief Grab a scan and add its points to a new scan of LidarDriver, which is empty if no scan was grabbed.
+     * @param[out] end_timestamp Time of the last point of the scan, 0 if no scan was grabbed
+     * @return true if a scan was grabbed, otherwise false.
+     */
+    bool processScan(uint64_t& end_timestamp);
+
     void updateSharedMemory();
 
-    bool external_data_;      ///< Flag to indicate if memory is externally managed
-    double (*lidar_data_)[3]; ///< Pointer to lidar data memory
-    cogip::shared_memory::WritePriorityLock* data_write_lock_;
     std::atomic<bool> update_shm_thread_exit_flag_;
-    std::thread* update_shm_thread_;
-    uint8_t min_intensity_;              ///< LiDAR minimum intensity
-    uint16_t min_invalid_angle_;         ///< LiDAR minimum angle
-    uint16_t max_invalid_angle_;         ///< LiDAR maximum angle
-    uint16_t max_distance_;              ///< LiDAR maximum range
-    uint16_t min_distance_;              ///< LiDAR minimum range
+    std::thread update_shm_thread_;      ///< Thread grabbing and publishing the scans
+    cogip::utils::thread_config_t rx_thread_config_;       ///< Scheduling of the serial reader thread
+    cogip::utils::thread_config_t scan_thread_config_;     ///< Scheduling of the scan decoding thread
+    cogip::utils::thread_config_t publish_thread_config_;  ///< Scheduling of update_shm_thread_
     float scan_frequency_;               ///< LiDAR scanning frequency
     int64_t refresh_interval_;           ///< LiDAR shared data refresh interval
     int sample_rate_;                    ///< LiDAR sample rate
@@ -182,7 +142,6 @@ private:
     ydlidar::YDlidarDriver* lidar_ptr_;  ///< LiDAR Driver Interface pointer
     uint64_t point_time_;                ///< Time interval between two sampling point
     uint64_t last_node_time_;            ///< Latest LiDAR Start Node Time
-    node_info_t* global_nodes_;          ///< global nodes buffer
     double last_frequency_;              ///< Latest Scan Frequency
     uint64_t first_node_time_;           ///< Calculate real-time sample rate start time
     uint64_t all_node_;                  ///< Sum of sampling points
@@ -4,6 +4,10 @@
 #include "thread.h"
 #include "ydlidar_protocol.h"
 
+#include "lidar_driver/LidarDriver.hpp"
+#include "serial_reader/SerialReader.hpp"
+#include "utils/ThreadConfig.hpp"
+
 #include <libserial/SerialPort.h>
 
 #include <atomic>
@@ -146,6 +150,20 @@ public:
     result_t grabScanData(node_info_t* nodebuffer, size_t& count,
         uint32_t timeout = DEFAULT_TIMEOUT);
 
+    /**
+     * @brief Get a circle of laser data without copying it
+     * @param[out] nodes     Laser data, valid until the next call to grabScanData()
+     * @param[out] count     one circle of laser points
+     * @param[in] timeout    timeout
+     * @return return status
+     * @retval RESULT_OK       success
+     * @retval RESULT_TIMEOUT  wait timeout
+     * @retval RESULT_FAILED   failed
+     * @note Only one thread can grab scan data.
+     */
+    result_t grabScanData(const node_info_t*& nodes, size_t& count,
+        uint32_t timeout = DEFAULT_TIMEOUT);
+
     /**
      * @brief start motor
      * @return return status
@@ -176,6 +194,28 @@ public:
         return point_time_;
     }
 
+    /**
+     * @brief Set the scheduling of the scanning thread.
+     * @note Applied at each start of the scan and at once if the thread runs.
+     * @throws std::invalid_argument if the configuration is invalid.
+     * @throws std::runtime_error if the system refuses the configuration of the running thread.
+     */
+    void setScanThreadConfig(const cogip::utils::thread_config_t& config);
+
+    /**
+     * @brief Set the driver whose health counters count the bytes, packets and circles of the scanning thread.
+     * @param health_driver The driver, none if null. It must outlive the scan.
+     */
+    void setHealthDriver(cogip::lidar_driver::LidarDriver* health_driver) { health_driver_ = health_driver; }
+
+    /**
+     * @brief Set the scheduling of the thread reading the serial port.
+     * @note Applied at each connection and at once if the thread runs.
+     */
+    void setRxThreadConfig(const cogip::utils::thread_config_t& config) {
+        serial_reader_.setThreadConfig(config);
+    }
+
     /**
     * @brief Get lidar scan frequency
     * @param[in] frequency    scanning frequency
@@ -374,28 +414,26 @@ protected:
     result_t waitDevicePackage(uint32_t timeout = DEFAULT_TIMEOUT);
 
     /**
-     * @brief parseResponseHeader
-     * @param packageBuffer
-     * @param timeout
-     * @return
+     * @brief Move all bytes received by the reader to the decoding buffer
+     * @param[in] needed   number of undecoded bytes to wait for
+     * @param[in] timeout  timeout
+     * @return status
+     * @retval RESULT_OK       success
+     * @retval RESULT_TIMEOUT  timeout
+     * @retval RESULT_FAILED   failed
      */
-    result_t parseResponseHeader(uint8_t* packageBuffer,
-        uint32_t timeout = DEFAULT_TIMEOUT);
+    result_t readScanBytes(size_t needed, uint32_t timeout = DEFAULT_TIMEOUT);
 
     /**
-     * @brief parseResponseScanData
-     * @param packageBuffer
-     * @param timeout
-     * @return
+     * @brief Decode the next scan package of the decoding buffer into its nodes
+     * @note Packages are located, validated and decoded in place, bytes are read only when a package is incomplete.
+     * @param[in] timeout  timeout
+     * @return status
+     * @retval RESULT_OK       success
+     * @retval RESULT_TIMEOUT  timeout
+     * @retval RESULT_FAILED   failed
      */
-    result_t parseResponseScanData(uint8_t* packageBuffer,
-        uint32_t timeout = DEFAULT_TIMEOUT);
-    /**
-    * @brief Unpacking
-    * @param[in] node lidar point information
-    * @param[in] timeout     timeout
-    */
-    result_t waitPackage(node_info_t* node, uint32_t timeout = DEFAULT_TIMEOUT);
+    result_t decodeScanPackage(uint32_t timeout = DEFAULT_TIMEOUT);
 
     /**
     * @brief get unpacked data
@@ -506,25 +544,31 @@ protected:
     void checkBlockStatus(uint8_t currentByte);
 
     /**
-     * @brief calculateCheckSum
-     * @param node
+     * @brief Parse a time stamp package
+     * @param package  package of SIZE_STAMP_PACKAGE bytes
      */
-    void calculateCheckSum(node_info_t* node);
+    void parseStampPackage(const uint8_t* package);
 
     /**
-     * @brief calculatePackageCT
+     * @brief Check a complete scan package and decode all its nodes
+     * @param package  package with its samples
      */
-    void calculatePackageCT();
+    void decodePackageNodes(const node_package_t* package);
 
     /**
      * @brief parseNodeDebugFromBuffer
+     * @param node   node to fill
+     * @param index  index of the sample in the package
      */
-    void parseNodeDebugFromBuffer(node_info_t* node);
+    void parseNodeDebugFromBuffer(node_info_t* node, uint16_t index);
 
     /**
      * @brief parseNodeFromBuffer
+     * @param node    node to fill
+     * @param sample  sample of the package
+     * @param index   index of the sample in the package
      */
-    void parseNodeFromBuffer(node_info_t* node);
+    void parseNodeFromBuffer(node_info_t* node, const package_node_t& sample, uint16_t index);
 
 private:
     /// LiDAR Scanning state
@@ -537,6 +581,8 @@ private:
     Locker lock_;
     /// Parse Data thread
     Thread thread_;
+    /// Scheduling of the parse data thread
+    cogip::utils::thread_config_t scan_thread_config_;
     /// command locker
     Locker cmd_lock_;
     /// driver error locker
@@ -544,12 +590,21 @@ private:
     /// LiDAR intensity bit
     int intensity_bit_;
     uint32_t point_time_;
-    /// LiDAR Point pointer
+    /// Number of scan slots: the scanning thread fills one, one holds the latest circle
+    /// and the consumer reads the last one in place, so neither waits for the other.
+    static constexpr uint8_t SCAN_SLOT_COUNT = 3;
+    /// Flag of scan_ready_slot_ set while the slot holds a circle not grabbed yet
+    static constexpr uint8_t SCAN_SLOT_FRESH = 0x80;
+    /// LiDAR Point pointer, SCAN_SLOT_COUNT slots of MAX_SCAN_NODES points
     node_info_t* scan_node_buf_;
-    /// LiDAR scan count
-    size_t scan_node_count_;
-    /// package sample index
-    uint16_t package_sample_index_;
+    /// LiDAR scan count of each slot
+    size_t scan_node_counts_[SCAN_SLOT_COUNT];
+    /// Slot filled by the scanning thread
+    uint8_t scan_write_slot_;
+    /// Slot holding the latest circle, exchanged with the write or read slot
+    std::atomic<uint8_t> scan_ready_slot_;
+    /// Slot read by the consumer
+    uint8_t scan_read_slot_;
     /// number of last error
     driver_error_t driver_errno_;
     /// invalid node count
@@ -558,26 +613,35 @@ private:
     int package_sample_bytes;
     /// serial port
     LibSerial::SerialPort* serial_;
-    /// has intensity protocol package
-    node_package_t package_;
+    /// reader thread buffering the bytes received on the serial port
+    cogip::serial_reader::SerialReader serial_reader_;
+    /// driver counting the health of the scanning thread, if set
+    cogip::lidar_driver::LidarDriver* health_driver_ = nullptr;
+    /// Size of the decoding buffer, enough for several packages of the largest size
+    static constexpr size_t SCAN_BYTES_SIZE = 4096;
+    /// Bytes moved from the reader, decoded in place
+    uint8_t scan_bytes_[SCAN_BYTES_SIZE];
+    /// Position of the first undecoded byte
+    size_t scan_bytes_begin_;
+    /// End of the bytes of the decoding buffer
+    size_t scan_bytes_end_;
+    /// Nodes of the last decoded package
+    node_info_t package_nodes_[PACKAGE_SAMPLE_MAX_LENGTH];
+    /// Number of nodes of the last decoded package
+    size_t package_node_count_;
+    /// Next node of the last decoded package returned by waitScanData
+    size_t package_node_pos_;
     float interval_sample_angle_;
     float interval_sample_angle_last_package_;
     /// First sample angle
     uint16_t first_sample_angle_;
     /// last sample angle
     uint16_t last_sample_angle_;
-    /// checksum
-    uint16_t check_sum_;
     /// scan frequency
     uint8_t scan_frequency_;
-    uint16_t checksum_cal_;
-    uint16_t sample_num_and_ct_cal_;
-    uint16_t last_sample_angle_cal_;
     bool checksum_result_;
-    uint16_t val_u8_to_u16_;
     uint8_t package_ct_;
     uint8_t now_package_num;
-    uint8_t package_sample_num_;
     uint8_t* global_recv_buffer_;
     bool has_device_header_;
     uint8_t last_device_byte_;
@@ -8,7 +8,8 @@ uint32_t getHDTimer() {
     return static_cast<uint32_t>(duration.count());
 }
 uint64_t getCurrentTime() {
-    auto now = std::chrono::system_clock::now();
+    // steady_clock is CLOCK_MONOTONIC, the clock of the pose buffer timestamps.
+    auto now = std::chrono::steady_clock::now();
     auto duration = now.time_since_epoch();
     return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
 }
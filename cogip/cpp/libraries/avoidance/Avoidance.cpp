@@ -5,10 +5,13 @@
 
 // Standard includes
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <deque>
 #include <iostream>
-#include <map>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 // Project includes
@@ -16,7 +19,9 @@
 #include "obstacles/ObstaclePolygon.hpp"
 #include "utils/trigonometry.hpp"
 #include "models/Coords.hpp"
+#include "models/PoseValue.hpp"
 #include "logger/PythonLogger.hpp"
+#include "logger/Trace.hpp"
 
 #define START_INDEX     0
 #define FINISH_INDEX    1
@@ -26,10 +31,21 @@ namespace cogip {
 namespace avoidance {
 
 Avoidance::Avoidance(const std::string& name):
-    shared_memory_(shared_memory::SharedMemory(name, false)),
+    Avoidance(nullptr, std::make_unique<shared_memory::SharedMemory>(name, false))
+{
+}
+
+Avoidance::Avoidance(shared_memory::SharedMemory& shared_memory):
+    Avoidance(&shared_memory, nullptr)
+{
+}
+
+Avoidance::Avoidance(shared_memory::SharedMemory* shared_memory, std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory):
+    owned_shared_memory_(std::move(owned_shared_memory)),
+    shared_memory_(shared_memory ? *shared_memory : *owned_shared_memory_),
     shared_memory_properties_(shared_memory_.getProperties()),
-    table_limits_(shared_memory_.getTableLimits()),
-    is_avoidance_computed_(false)
+    is_avoidance_computed_(false),
+    table_limits_(shared_memory_.getTableLimits())
 {
     // table limits margin is the half of the max robot size,
     // increase of the bounding box margin to not touch the borders during rotations.
@@ -39,215 +55,1588 @@ Avoidance::Avoidance(const std::string& name):
     );
 }
 
-bool Avoidance::avoidance(const models::Coords& start,
-                          const models::Coords& finish) {
-    logger::debug << "avoidance: Starting computation" << std::endl;
+void Avoidance::begin_cycle()
+{
+    path_size_ = 0;
+    arena_.reset();
+}
+
+bool Avoidance::set_path(const models::Vec2* points, size_t count)
+{
+    if (count > path_capacity) {
+        std::cerr << "avoidance: Path of " << count << " points exceeds " << path_capacity << " points" << std::endl;
+        path_size_ = 0;
+        return false;
+    }
+    std::copy_n(points, count, path_.begin());
+    path_size_ = count;
+    return true;
+}
+
+bool Avoidance::prepare_poses(const models::Coords& start,
+                              const models::Coords& finish) {
+    // Initialize start and finish poses
+    start_pose_ = models::Vec2(start);
+    finish_pose_ = models::Vec2(finish);
+    goal_pose_ = finish_pose_;
+    is_avoidance_computed_ = false;
+    finish_projected_ = false;
+    finish_blocked_ = false;
+    goal_reached_ = true;
+    graph_path_ready_ = false;
+    begin_cycle();
+
+    COGIP_LOG_DEBUG << "start = " << start << std::endl;
+    COGIP_LOG_DEBUG << "start_pose_ = " << start_pose_ << std::endl;
+    COGIP_LOG_DEBUG << "finish = " << finish << std::endl;
+    COGIP_LOG_DEBUG << "finish_pose_ = " << finish_pose_ << std::endl;
+
+    // Validate that the finish pose is inside borders
+    if (!is_point_in_table_limits(finish_pose_)) {
+        if (!reach_nearest_goal_) {
+            std::cerr << "avoidance: Finish pose is outside the borders" << std::endl;
+            return false;
+        }
+        finish_pose_ = nearest_point_in_table_limits(finish_pose_);
+        finish_projected_ = true;
+        COGIP_LOG_DEBUG << "finish pose outside the borders, updated: " << finish_pose_ << std::endl;
+    }
+
+    // Obstacles may have moved since the last call.
+    update_obstacle_set();
+
+    // Validate that the start and finish poses are not inside any obstacles
+    for (size_t k = 0; k < obstacle_set_.size(); k++) {
+        if (obstacle_set_.is_point_inside(k, finish_pose_.x, finish_pose_.y)) {
+            if (!reach_nearest_goal_) {
+                std::cerr << "avoidance: Finish pose is inside an obstacle" << std::endl;
+                return false;
+            }
+            finish_pose_ = obstacle_set_.nearest_point(k, finish_pose_);
+            finish_projected_ = true;
+            COGIP_LOG_DEBUG << "finish pose inside obstacle, updated: " << finish_pose_ << std::endl;
+        }
+        if (obstacle_set_.is_point_inside(k, start_pose_.x, start_pose_.y)) {
+            start_pose_ = obstacle_set_.nearest_point(k, start_pose_);
+            COGIP_LOG_DEBUG << "start pose inside obstacle, updated: " << start_pose_ << std::endl;
+        }
+    }
+
+    // A projection may land in another obstacle or out of the table:
+    // the graph search then leads to the reachable vertex nearest to the requested finish pose.
+    if (finish_projected_) {
+        finish_blocked_ = !is_point_in_table_limits(finish_pose_);
+        for (size_t k = 0; k < obstacle_set_.size() && !finish_blocked_; k++) {
+            finish_blocked_ = obstacle_set_.is_point_inside(k, finish_pose_.x, finish_pose_.y);
+        }
+    }
+
+    COGIP_LOG_DEBUG << "avoidance: Poses validated" << std::endl;
+
+    // Prepare valid points for pathfinding
+    valid_points_ = {start_pose_, finish_pose_};
+    terminal_count_ = FINISH_INDEX + 1;
+    COGIP_LOG_DEBUG << "valid_points_[0] = " << valid_points_[0] << std::endl;
+    COGIP_LOG_DEBUG << "valid_points_[1] = " << valid_points_[1] << std::endl;
+    return true;
+}
+
+bool Avoidance::avoidance(const models::Coords& start,
+                          const models::Coords& finish) {
+    COGIP_TRACE_SPAN("Avoidance::avoidance");
+    COGIP_LOG_DEBUG << "avoidance: Starting computation" << std::endl;
+    cached_path_.clear();
+
+    if (!prepare_poses(start, finish)) {
+        return false;
+    }
+    if (planning_engine_ == PlanningEngine::GRID) {
+        return grid_avoidance();
+    }
+
+    // Build avoidance graph and compute path using Dijkstra
+    COGIP_LOG_DEBUG << "avoidance: Building graph and computing path" << std::endl;
+    build_avoidance_graph();
+
+    bool ret = dijkstra();
+    if (ret) {
+        graph_path_ready_ = goal_reached_;
+        post_process_path();
+        cache_path();
+        COGIP_LOG_DEBUG << "avoidance: Path successfully computed" << std::endl;
+    } else {
+        std::cerr << "avoidance: Failed to compute path" << std::endl;
+    }
+
+    return ret;
+}
+
+bool Avoidance::avoidance(const models::Coords& start,
+                          const models::Coords& finish,
+                          double budget,
+                          bool& optimal) {
+    COGIP_TRACE_SPAN("Avoidance::avoidance");
+    COGIP_LOG_DEBUG << "avoidance: Starting computation within " << budget << "s" << std::endl;
+    const auto begin = std::chrono::steady_clock::now();
+    optimal = false;
+    cached_path_.clear();
+
+    if (!prepare_poses(start, finish)) {
+        return false;
+    }
+
+    // The grid search cost is bounded by the grid size: no coarse fallback.
+    if (planning_engine_ == PlanningEngine::GRID) {
+        optimal = grid_avoidance();
+        return optimal;
+    }
+
+    // Direct segment: when free, it is the shortest path.
+    // With a clearance penalty, it is only the cheapest one if it has no penalty.
+    vertex_slots_.assign(valid_points_.size(), ObstacleSet::no_slot);
+    if (clearance_weight_ > 0) {
+        update_clearance_field();
+    }
+    const models::Vec2& direct_start = valid_points_[START_INDEX];
+    const models::Vec2& direct_finish = valid_points_[FINISH_INDEX];
+    if (!finish_blocked_ && find_blocking_obstacle(START_INDEX, FINISH_INDEX) < 0 &&
+        is_clear_of_moving_obstacles(direct_start, direct_finish, 0) &&
+        (clearance_weight_ == 0 || edge_cost(direct_start, direct_finish) <= direct_start.distance(direct_finish))) {
+        set_path(&valid_points_[START_INDEX], 1);
+        is_avoidance_computed_ = true;
+        optimal = true;
+        cache_path();
+        COGIP_LOG_DEBUG << "avoidance: Direct path is free" << std::endl;
+        return true;
+    }
+
+    has_deadline_ = (budget > 0);
+    build_aborted_ = false;
+    deadline_ = begin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(budget)
+    );
+    auto remaining = [this]() {
+        return std::chrono::duration<double>(deadline_ - std::chrono::steady_clock::now()).count();
+    };
+
+    // Point validity does not depend on the graph: it is checked once for both graphs.
+    check_obstacle_points();
+
+    // Coarse graph: one bounding box point out of coarse_point_stride.
+    // Skipped when the previous full graph took well within the remaining budget.
+    // The path is kept aside since the full graph search overwrites it.
+    std::pmr::vector<models::Vec2> coarse_path(arena_.resource());
+    if (has_deadline_ && (full_build_duration_ < 0 || 2 * full_build_duration_ > remaining())) {
+        point_stride_ = coarse_point_stride;
+        build_avoidance_graph(false);
+        point_stride_ = 1;
+        if (!build_aborted_ && dijkstra()) {
+            coarse_path.assign(path_.begin(), path_.begin() + path_size_);
+            COGIP_LOG_DEBUG << "avoidance: Coarse path found with " << coarse_path.size() << " points" << std::endl;
+        }
+    }
+
+    // Full graph, only kept if built before the deadline.
+    if (!has_deadline_ || (!build_aborted_ && remaining() > 0)) {
+        auto full_begin = std::chrono::steady_clock::now();
+        valid_points_.resize(terminal_count_);
+        build_avoidance_graph(false);
+        if (!build_aborted_) {
+            full_build_duration_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - full_begin).count();
+            has_deadline_ = false;
+            optimal = dijkstra();
+            if (optimal) {
+                graph_path_ready_ = goal_reached_;
+                post_process_path();
+                cache_path();
+            }
+            return optimal;
+        }
+    }
+    has_deadline_ = false;
+    COGIP_LOG_DEBUG << "avoidance: Deadline reached" << std::endl;
+
+    is_avoidance_computed_ = false;
+    if (coarse_path.empty()) {
+        path_size_ = 0;
+        std::cerr << "avoidance: No path found within " << budget << "s" << std::endl;
+        return false;
+    }
+    set_path(coarse_path.data(), coarse_path.size());
+    is_avoidance_computed_ = true;
+    post_process_path();
+    return true;
+}
+
+bool Avoidance::grid_avoidance()
+{
+    COGIP_TRACE_SPAN("Avoidance::grid_avoidance");
+    if (!grid_planner_.is_built()) {
+        grid_planner_.build(
+            obstacle_set_,
+            table_limits_[0] + table_limits_margin_, table_limits_[1] - table_limits_margin_,
+            table_limits_[2] + table_limits_margin_, table_limits_[3] - table_limits_margin_
+        );
+    }
+    if (finish_blocked_ || !grid_planner_.find_path(start_pose_, finish_pose_, grid_path_)) {
+        std::cerr << "avoidance: No path found on the grid" << std::endl;
+        return false;
+    }
+
+    // The path does not hold finish, copy_path() adds it.
+    if (!set_path(grid_path_.data(), grid_path_.size() - 1)) {
+        return false;
+    }
+    is_avoidance_computed_ = true;
+    print_path();
+    post_process_path();
+    cache_path();
+    return true;
+}
+
+/// Distance from a point to segment [AB].
+static double distance_to_segment(const models::Vec2& p, const models::Vec2& a, const models::Vec2& b)
+{
+    const models::Vec2 ab = b - a;
+    const double length2 = ab.dot(ab);
+    const double t = (length2 > 0) ? std::clamp((p - a).dot(ab) / length2, 0.0, 1.0) : 0.0;
+    return p.distance(a + ab * t);
+}
+
+void Avoidance::cache_path()
+{
+    // A path to the nearest reachable point must not be reused once the finish pose is free.
+    if (!goal_reached_) {
+        cached_path_.clear();
+        return;
+    }
+    cached_path_.assign(path_.begin(), path_.begin() + path_size_);
+    cached_path_.push_back(finish_pose_);
+}
+
+bool Avoidance::validate_cached_path(const models::Coords& current_pose, std::vector<double>& path)
+{
+    path.clear();
+    if (cached_path_.size() < 2) {
+        return false;
+    }
+
+    // Obstacles may have moved since the path was computed.
+    update_obstacle_set();
+
+    // Segment tests do not detect ends inside an obstacle: avoidance() handles these poses.
+    const models::Vec2 current(current_pose);
+    const size_t last = cached_path_.size() - 1;
+    bool valid = is_point_in_table_limits(cached_path_[last]);
+    for (size_t k = 0; k < obstacle_set_.size() && valid; k++) {
+        valid = !obstacle_set_.is_point_inside(k, current.x, current.y) &&
+                !obstacle_set_.is_point_inside(k, cached_path_[last].x, cached_path_[last].y);
+    }
+
+    // The robot is heading to the end of the nearest segment.
+    size_t next = 1;
+    double nearest = std::numeric_limits<double>::infinity();
+    for (size_t i = 1; i <= last; i++) {
+        double distance = distance_to_segment(current, cached_path_[i - 1], cached_path_[i]);
+        if (distance < nearest) {
+            nearest = distance;
+            next = i;
+        }
+    }
+
+    // Re-anchor: go straight to the farthest remaining vertex in sight.
+    size_t target = last;
+    while (valid && target > next && !is_segment_free(current, cached_path_[target])) {
+        target--;
+    }
+    valid = valid && (target > next || is_segment_free(current, cached_path_[next]));
+    double travelled = current.distance(cached_path_[target]);
+    for (size_t i = target + 1; valid && i <= last; i++) {
+        valid = is_segment_free(cached_path_[i - 1], cached_path_[i], travelled);
+        travelled += cached_path_[i - 1].distance(cached_path_[i]);
+    }
+    if (!valid) {
+        COGIP_LOG_DEBUG << "validate_cached_path: cached path is blocked" << std::endl;
+        cached_path_.clear();
+        return false;
+    }
+
+    cached_path_.erase(cached_path_.begin(), cached_path_.begin() + target);
+    cached_path_.insert(cached_path_.begin(), current);
+
+    // Expose the path as after avoidance(). The graph was built from another start.
+    start_pose_ = current;
+    finish_pose_ = cached_path_.back();
+    graph_path_ready_ = false;
+    begin_cycle();
+    set_path(cached_path_.data(), cached_path_.size() - 1);
+    is_avoidance_computed_ = true;
+    copy_path(models::Coords(finish_pose_.x, finish_pose_.y), path);
+    COGIP_LOG_DEBUG << "validate_cached_path: cached path reused with " << cached_path_.size() << " points" << std::endl;
+    return true;
+}
+
+bool Avoidance::is_segment_free(const models::Vec2& a, const models::Vec2& b, double departure) const
+{
+    return !obstacle_grid_.visit_segment(
+        a.x, a.y, b.x, b.y,
+        [&](uint32_t k) {
+            return obstacle_set_.is_segment_crossing(k, a.x, a.y, b.x, b.y);
+        }
+    ) && is_clear_of_moving_obstacles(a, b, departure);
+}
+
+bool Avoidance::is_clear_of_moving_obstacles(const models::Vec2& a, const models::Vec2& b, double departure) const
+{
+    if (!time_aware_) {
+        return true;
+    }
+
+    // In the frame moving with an obstacle, the robot goes straight from A - v.tA to B - v.tB,
+    // and the obstacle stays at its current position. Beyond the horizon the obstacle stops,
+    // so the relative motion bends where the robot is at the horizon.
+    const double t_a = departure / planning_speed_;
+    const double t_b = (departure + a.distance(b)) / planning_speed_;
+    const bool split = (t_a < prediction_horizon_ && prediction_horizon_ < t_b);
+    const models::Vec2 m = split ? a + (b - a) * ((prediction_horizon_ - t_a) / (t_b - t_a)) : b;
+    const double t_m = std::min(t_b, prediction_horizon_);
+    const double t_a_clamped = std::min(t_a, prediction_horizon_);
+    for (uint32_t k : moving_obstacles_) {
+        const models::Vec2 v(obstacle_set_.velocity_x(k), obstacle_set_.velocity_y(k));
+        const models::Vec2 relative_a = a - v * t_a_clamped;
+        const models::Vec2 relative_m = m - v * t_m;
+        if (obstacle_set_.is_segment_crossing(k, relative_a.x, relative_a.y, relative_m.x, relative_m.y)) {
+            return false;
+        }
+        if (split) {
+            const models::Vec2 relative_b = b - v * prediction_horizon_;
+            if (obstacle_set_.is_segment_crossing(k, relative_m.x, relative_m.y, relative_b.x, relative_b.y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Avoidance::update_moving_obstacles()
+{
+    moving_obstacles_.clear();
+    for (size_t k = 0; k < obstacle_set_.size(); k++) {
+        if (std::hypot(obstacle_set_.velocity_x(k), obstacle_set_.velocity_y(k)) >= moving_speed_threshold) {
+            moving_obstacles_.push_back(k);
+        }
+    }
+}
+
+void Avoidance::post_process_path()
+{
+    COGIP_TRACE_SPAN("Avoidance::post_process_path");
+    if (path_post_processing_ == PathPostProcessing::NONE || path_size_ < 2) {
+        return;
+    }
+
+    // Work on the points, finish included.
+    std::pmr::vector<models::Vec2> points(path_.begin(), path_.begin() + path_size_, arena_.resource());
+    points.push_back(finish_pose_);
+    const size_t raw_size = points.size();
+
+    // With a clearance penalty, a shortcut may pass closer to obstacles than the path it replaces:
+    // it is only kept if it does not cost more.
+    const bool weighted = clearance_weight_ > 0;
+    if (weighted) {
+        update_clearance_field();
+    }
+    auto is_cheaper = [this, &points](size_t i, size_t j) {
+        double cost = 0;
+        for (size_t k = i; k < j; k++) {
+            cost += edge_cost(points[k], points[k + 1]);
+        }
+        return edge_cost(points[i], points[j]) <= cost;
+    };
+
+    // Shortcut: from each kept vertex, jump to the farthest vertex reachable in a straight line.
+    // Path lengths before each segment give the times moving obstacles are checked at.
+    std::pmr::vector<models::Vec2> processed(arena_.resource());
+    processed.push_back(points.front());
+    double travelled = 0;
+    for (size_t i = 0; i + 1 < points.size();) {
+        size_t j = points.size() - 1;
+        while (j > i + 1 && !(is_segment_free(points[i], points[j], travelled) && (!weighted || is_cheaper(i, j)))) {
+            j--;
+        }
+        processed.push_back(points[j]);
+        travelled += points[i].distance(points[j]);
+        i = j;
+    }
+
+    // Smooth: replace each corner by two points on its segments when the cut is free.
+    // Parts of the segments between the new points and their neighbors were already free.
+    // Stops before the path outgrows its capacity.
+    if (path_post_processing_ == PathPostProcessing::SMOOTH) {
+        for (size_t iteration = 0; iteration < smoothing_iterations; iteration++) {
+            points.assign(processed.begin(), processed.end());
+            processed.clear();
+            processed.push_back(points.front());
+            travelled = 0;
+            for (size_t i = 1; i + 1 < points.size(); i++) {
+                const models::Vec2& corner = points[i];
+                models::Vec2 before = corner + (points[i - 1] - corner) * smoothing_ratio;
+                models::Vec2 after = corner + (points[i + 1] - corner) * smoothing_ratio;
+                double departure = travelled + processed.back().distance(before);
+                if (is_segment_free(before, after, departure) &&
+                    (!weighted || edge_cost(before, after) <= edge_cost(before, corner) + edge_cost(corner, after))) {
+                    processed.push_back(before);
+                    processed.push_back(after);
+                    travelled = departure + before.distance(after);
+                }
+                else {
+                    travelled += processed.back().distance(corner);
+                    processed.push_back(corner);
+                }
+            }
+            processed.push_back(points.back());
+            if (processed.size() - 1 > path_capacity) {
+                processed.swap(points);
+                break;
+            }
+        }
+    }
+
+    // The path does not hold finish, copy_path() adds it.
+    set_path(processed.data(), processed.size() - 1);
+    COGIP_LOG_DEBUG << "post_process_path: " << raw_size << " points reduced to " << processed.size() << std::endl;
+}
+
+bool Avoidance::compute_path(const models::Coords& start,
+                             const models::Coords& finish,
+                             std::vector<double>& path)
+{
+    path.clear();
+    if (!avoidance(start, finish)) {
+        return false;
+    }
+    copy_path(get_finish_pose(), path);
+    return true;
+}
+
+bool Avoidance::compute_path(const models::Coords& start,
+                             const models::Coords& finish,
+                             double budget,
+                             std::vector<double>& path,
+                             bool& optimal)
+{
+    path.clear();
+    if (!avoidance(start, finish, budget, optimal)) {
+        return false;
+    }
+    copy_path(get_finish_pose(), path);
+    return true;
+}
+
+void Avoidance::copy_path(const models::Coords& finish, std::vector<double>& path) const
+{
+    path.reserve(2 * (path_size_ + 1));
+    for (const models::Vec2& point : get_path()) {
+        double x = point.x;
+        double y = point.y;
+        bool duplicate = false;
+        for (size_t i = 0; i < path.size() && !duplicate; i += 2) {
+            duplicate = (path[i] == x && path[i + 1] == y);
+        }
+        if (!duplicate) {
+            path.push_back(x);
+            path.push_back(y);
+        }
+    }
+    path.push_back(finish.x());
+    path.push_back(finish.y());
+}
+
+void Avoidance::compute_path_costs(const std::vector<models::Vec2>& starts,
+                                   const std::vector<models::Vec2>& goals,
+                                   std::vector<double>& costs)
+{
+    constexpr double MAX_DISTANCE = std::numeric_limits<double>::infinity();
+    costs.assign(starts.size() * goals.size(), MAX_DISTANCE);
+
+    // The path is computed on a previous graph.
+    begin_cycle();
+    is_avoidance_computed_ = false;
+    graph_path_ready_ = false;
+
+    update_obstacle_set();
+
+    // Starts come first, then valid goals, then obstacle points.
+    valid_points_.clear();
+    for (models::Vec2 start : starts) {
+        for (size_t k = 0; k < obstacle_set_.size(); k++) {
+            if (obstacle_set_.is_point_inside(k, start.x, start.y)) {
+                start = obstacle_set_.nearest_point(k, start);
+            }
+        }
+        valid_points_.push_back(start);
+    }
+    goal_vertices_.assign(goals.size(), UINT32_MAX);
+    for (size_t g = 0; g < goals.size(); g++) {
+        const models::Vec2& goal = goals[g];
+        if (!is_point_in_table_limits(goal)) {
+            continue;
+        }
+        bool inside = false;
+        for (size_t k = 0; k < obstacle_set_.size() && !inside; k++) {
+            inside = obstacle_set_.is_point_inside(k, goal.x, goal.y);
+        }
+        if (!inside) {
+            goal_vertices_[g] = valid_points_.size();
+            valid_points_.push_back(goal);
+        }
+    }
+    terminal_count_ = valid_points_.size();
+
+    build_avoidance_graph();
+
+    for (size_t s = 0; s < starts.size(); s++) {
+        single_source_distances(s);
+        double* row = &costs[s * goals.size()];
+        for (size_t g = 0; g < goals.size(); g++) {
+            if (goal_vertices_[g] != UINT32_MAX) {
+                row[g] = distances_[goal_vertices_[g]];
+            }
+        }
+    }
+
+    COGIP_LOG_DEBUG << "compute_path_costs: " << starts.size() << "x" << goals.size()
+                    << " costs computed on " << valid_points_.size() << " vertices" << std::endl;
+}
+
+size_t Avoidance::compute_alternative_paths(size_t count)
+{
+    COGIP_TRACE_SPAN("Avoidance::compute_alternative_paths");
+    clear_alternative_paths();
+    if (count == 0 || !graph_path_ready_ || path_vertices_.size() < 2) {
+        return 0;
+    }
+
+    // Graph path with the cost from start to each of its vertices.
+    struct GraphPath {
+        std::vector<uint32_t> vertices;
+        std::vector<double> costs;
+    };
+    auto make_path = [this](std::vector<uint32_t> vertices) {
+        GraphPath path{std::move(vertices), {}};
+        path.costs.reserve(path.vertices.size());
+        path.costs.push_back(0);
+        for (size_t i = 1; i < path.vertices.size(); i++) {
+            path.costs.push_back(path.costs.back() + graph_edge_weight(path.vertices[i - 1], path.vertices[i]));
+        }
+        return path;
+    };
+
+    std::vector<GraphPath> shortest;   // Paths enumerated by increasing cost.
+    std::vector<GraphPath> candidates; // Spur paths not enumerated yet.
+    std::vector<size_t> kept;          // Indices in shortest of the paths differing enough.
+    shortest.push_back(make_path(path_vertices_));
+    kept.push_back(0);
+
+    // Part of the cost of a path on edges of the kept paths, in either direction.
+    auto overlap = [&](const GraphPath& path) {
+        double shared = 0;
+        for (size_t i = 1; i < path.vertices.size(); i++) {
+            uint32_t a = path.vertices[i - 1];
+            uint32_t b = path.vertices[i];
+            bool found = false;
+            for (size_t k = 0; k < kept.size() && !found; k++) {
+                const std::vector<uint32_t>& other = shortest[kept[k]].vertices;
+                for (size_t j = 1; j < other.size() && !found; j++) {
+                    found = (other[j - 1] == a && other[j] == b) || (other[j - 1] == b && other[j] == a);
+                }
+            }
+            if (found) {
+                shared += path.costs[i] - path.costs[i - 1];
+            }
+        }
+        return path.costs.back() > 0 ? shared / path.costs.back() : 1.0;
+    };
+
+    spur_removed_.assign(valid_points_.size(), 0);
+    std::vector<uint32_t> blocked;
+    std::vector<uint32_t> spur_vertices;
+    const size_t max_paths = count * alternative_search_factor;
+    while (kept.size() < count && shortest.size() < max_paths) {
+        const size_t last = shortest.size() - 1;
+        for (size_t i = 0; i + 1 < shortest[last].vertices.size(); i++) {
+            const std::vector<uint32_t>& root = shortest[last].vertices;
+
+            // Edges leaving the spur vertex along the enumerated paths sharing the root are removed,
+            // and root vertices before the spur vertex too, so the spur path gives a new loopless path.
+            blocked.clear();
+            for (const GraphPath& path : shortest) {
+                if (path.vertices.size() > i + 1 && std::equal(root.begin(), root.begin() + i + 1, path.vertices.begin())) {
+                    blocked.push_back(path.vertices[i + 1]);
+                }
+            }
+            for (size_t j = 0; j < i; j++) {
+                spur_removed_[root[j]] = 1;
+            }
+            bool found = spur_search(root[i], shortest[last].costs[i], blocked, spur_vertices);
+            for (size_t j = 0; j < i; j++) {
+                spur_removed_[root[j]] = 0;
+            }
+            if (!found || i + spur_vertices.size() > path_capacity + 1) {
+                continue;
+            }
+
+            std::vector<uint32_t> vertices(root.begin(), root.begin() + i);
+            vertices.insert(vertices.end(), spur_vertices.begin(), spur_vertices.end());
+            bool known = false;
+            for (size_t k = 0; k < candidates.size() && !known; k++) {
+                known = candidates[k].vertices == vertices;
+            }
+            if (!known) {
+                candidates.push_back(make_path(std::move(vertices)));
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+
+        auto next = std::min_element(candidates.begin(), candidates.end(), [](const GraphPath& a, const GraphPath& b) {
+            return a.costs.back() < b.costs.back();
+        });
+        shortest.push_back(std::move(*next));
+        candidates.erase(next);
+        if (overlap(shortest.back()) <= alternative_max_overlap_) {
+            kept.push_back(shortest.size() - 1);
+        }
+    }
+
+    for (size_t index : kept) {
+        const GraphPath& path = shortest[index];
+        std::vector<models::Vec2> points;
+        points.reserve(path.vertices.size());
+        for (uint32_t v : path.vertices) {
+            points.push_back(valid_points_[v]);
+        }
+        alternative_paths_.push_back(std::move(points));
+        alternative_costs_.push_back(path.costs.back());
+    }
+    COGIP_LOG_DEBUG << "compute_alternative_paths: " << kept.size() << " paths kept out of "
+                    << shortest.size() << " enumerated" << std::endl;
+    return kept.size();
+}
+
+bool Avoidance::use_alternative_path(const models::Coords& current_pose, std::vector<double>& path)
+{
+    path.clear();
+    while (!alternative_paths_.empty()) {
+        cached_path_ = std::move(alternative_paths_.front());
+        alternative_paths_.erase(alternative_paths_.begin());
+        alternative_costs_.erase(alternative_costs_.begin());
+        if (validate_cached_path(current_pose, path)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Avoidance::clear_alternative_paths()
+{
+    alternative_paths_.clear();
+    alternative_costs_.clear();
+}
+
+void Avoidance::set_alternative_max_overlap(double overlap)
+{
+    if (!(overlap >= 0 && overlap <= 1)) {
+        throw std::invalid_argument("Alternative path overlap must be between 0 and 1");
+    }
+    alternative_max_overlap_ = overlap;
+}
+
+double Avoidance::graph_edge_weight(uint32_t a, uint32_t b) const
+{
+    for (uint32_t e = graph_offsets_[a]; e < graph_offsets_[a + 1]; e++) {
+        if (graph_neighbors_[e] == b) {
+            return graph_weights_[e];
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+bool Avoidance::spur_search(uint32_t spur, double departure, const std::vector<uint32_t>& blocked, std::vector<uint32_t>& vertices)
+{
+    constexpr double MAX_DISTANCE = std::numeric_limits<double>::infinity();
+    const size_t count = valid_points_.size();
+    const uint32_t finish = FINISH_INDEX;
+    const models::Vec2& finish_point = valid_points_[finish];
+    const bool check_moving = time_aware_ && !moving_obstacles_.empty();
+
+    checked_.assign(count, false);
+    distances_.assign(count, MAX_DISTANCE);
+    parents_.assign(count, -1);
+    open_set_.reset(count);
+
+    // Edge costs are never below lengths, so the Euclidean heuristic is admissible.
+    distances_[spur] = 0;
+    open_set_.push(spur, valid_points_[spur].distance(finish_point));
+    while (!open_set_.empty()) {
+        uint32_t v = open_set_.pop();
+        if (v == finish) {
+            break;
+        }
+        checked_[v] = true;
+
+        for (uint32_t e = graph_offsets_[v]; e < graph_offsets_[v + 1]; e++) {
+            uint32_t neighbor = graph_neighbors_[e];
+            if (checked_[neighbor] || spur_removed_[neighbor]) {
+                continue;
+            }
+            if (v == spur && std::find(blocked.begin(), blocked.end(), neighbor) != blocked.end()) {
+                continue;
+            }
+            double distance = distances_[v] + graph_weights_[e];
+            if (distance >= distances_[neighbor]) {
+                continue;
+            }
+            if (check_moving && !is_clear_of_moving_obstacles(valid_points_[v], valid_points_[neighbor], departure + distances_[v])) {
+                continue;
+            }
+            distances_[neighbor] = distance;
+            parents_[neighbor] = v;
+            open_set_.push(neighbor, distance + valid_points_[neighbor].distance(finish_point));
+        }
+    }
+
+    if (distances_[finish] == MAX_DISTANCE) {
+        return false;
+    }
+    vertices.clear();
+    for (int current = finish; current != -1; current = parents_[current]) {
+        vertices.push_back(current);
+    }
+    std::reverse(vertices.begin(), vertices.end());
+    return true;
+}
+
+bool Avoidance::publish_path(const models::Coords& start)
+{
+    // The pose order may be overwritten by the planner at any time: work on a copy.
+    const models::pose_order_t pose_order = shared_memory_.getData()->avoidance_pose_order;
+    models::Coords finish(pose_order.x, pose_order.y);
+
+    if (!compute_path(start, finish, published_path_)) {
+        return false;
+    }
+
+    make_path_poses(published_path_, pose_order, published_poses_);
+    write_avoidance_path(published_poses_);
+    return true;
+}
+
+void Avoidance::make_path_poses(
+    const std::vector<double>& path,
+    const models::pose_order_t& pose_order,
+    std::vector<models::pose_order_t>& poses)
+{
+    poses.clear();
+    size_t point_count = path.size() / 2;
+    for (size_t i = 0; i + 1 < point_count; i++) {
+        models::pose_order_t pose{};
+        pose.x = path[2 * i];
+        pose.y = path[2 * i + 1];
+        pose.max_speed_linear = pose_order.max_speed_linear;
+        pose.max_speed_angular = pose_order.max_speed_angular;
+        pose.motion_direction = pose_order.motion_direction;
+        pose.timeout_ms = pose_order.timeout_ms;
+        pose.bypass_final_orientation = true;
+        pose.is_intermediate = true;
+        poses.push_back(pose);
+    }
+    poses.push_back(pose_order);
+}
+
+void Avoidance::write_avoidance_path(const std::vector<models::pose_order_t>& poses, bool new_path)
+{
+    COGIP_TRACE_SPAN("Avoidance::write_avoidance_path");
+    models::pose_order_list_t& avoidance_path = shared_memory_.getData()->avoidance_path;
+    shared_memory::WritePriorityLock& lock = shared_memory_.getLock(shared_memory::LockName::AvoidancePath);
+
+    size_t count = poses.empty() ? 0 : poses.size() - 1;
+    if (count > models::POSE_ORDER_LIST_SIZE_MAX) {
+        COGIP_LOG_WARNING << "write_avoidance_path: path truncated to "
+                          << models::POSE_ORDER_LIST_SIZE_MAX << " poses" << std::endl;
+        count = models::POSE_ORDER_LIST_SIZE_MAX;
+    }
+    // Keep the final pose when truncating.
+    auto path_pose = [&](size_t i) -> const models::pose_order_t& {
+        return i + 1 < count ? poses[i + 1] : poses.back();
+    };
+
+    lock.startWriting();
+    // Only the poses after the common prefix with the published path are written.
+    size_t first_changed = 0;
+    size_t common_count = std::min<size_t>(count, avoidance_path.count);
+    while (first_changed < common_count && avoidance_path.elems[first_changed] == path_pose(first_changed)) {
+        first_changed++;
+    }
+    for (size_t i = first_changed; i < count; i++) {
+        avoidance_path.elems[i] = path_pose(i);
+    }
+    avoidance_path.count = count;
+    std::uint64_t path_id = shared_memory_.commitAvoidancePath(first_changed, new_path);
+    lock.finishWriting();
+    lock.postUpdate();
+    shared_memory_.stampLatency(shared_memory::LatencyStage::AvoidancePath, obstacles_latency_frame_);
+
+    COGIP_LOG_DEBUG << "write_avoidance_path: path " << path_id << " updated with " << count
+                    << " poses from index " << first_changed << std::endl;
+}
+
+bool Avoidance::is_point_in_obstacles(const models::Coords& point, const cogip::obstacles::Obstacle* filter) const
+{
+    for (const auto& obstacle : dynamic_obstacles_) {
+        if (&obstacle.get() == filter) {
+            continue;
+        }
+        if (obstacle.get().is_point_near(models::Vec2(point)) && obstacle.get().is_point_inside(point)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Avoidance::check_recompute(const models::Coords& start,
+                                const models::Coords& stop)
+{
+    update_obstacle_set();
 
-    // Initialize start and finish poses
-    start_pose_ = start;
-    finish_pose_ = finish;
-    is_avoidance_computed_ = false;
+    return obstacle_grid_.visit_segment(
+        start.x(), start.y(), stop.x(), stop.y(),
+        [&](uint32_t k) {
+            return is_point_in_table_limits(obstacle_set_.center_x(k), obstacle_set_.center_y(k)) &&
+                   obstacle_set_.is_segment_crossing(k, start.x(), start.y(), stop.x(), stop.y());
+        }
+    );
+}
 
-    logger::debug << "start = " << start << std::endl;
-    logger::debug << "start_pose_ = " << start_pose_ << std::endl;
-    logger::debug << "finish = " << finish << std::endl;
-    logger::debug << "finish_pose_ = " << finish_pose_ << std::endl;
+void Avoidance::update_obstacle_set()
+{
+    if (apply_footprint(obstacle_set_)) {
+        // Cached edges were tested with the previous footprint.
+        obstacle_set_dirty_ = true;
+        obstacle_slots_.clear();
+    }
+    if (!obstacle_set_dirty_ && snapshot_loaded_) {
+        return;
+    }
+    obstacle_set_.build(dynamic_obstacles_);
+    obstacle_grid_.build(obstacle_set_);
+    grid_planner_.invalidate();
+    clearance_field_.invalidate();
+    update_moving_obstacles();
+    update_roadmap();
+    obstacle_set_dirty_ = false;
+}
 
-    // Validate that the finish pose is inside borders
-    if (!is_point_in_table_limits(finish_pose_)) {
-        std::cerr << "avoidance: Finish pose is outside the borders" << std::endl;
+bool Avoidance::apply_footprint(ObstacleSet& obstacles) const
+{
+    double length = 0;
+    double width = 0;
+    if (shared_memory_properties_.footprint_avoidance) {
+        length = shared_memory_properties_.robot_length;
+        width = shared_memory_properties_.robot_width;
+    }
+    if (obstacles.footprint_length() == length && obstacles.footprint_width() == width) {
         return false;
     }
+    obstacles.set_footprint(length, width);
+    return true;
+}
 
-    // Validate that the start and finish poses are not inside any obstacles
-    for (const auto& obstacle : dynamic_obstacles_) {
-        auto& current_obstacle = obstacle.get();
-        if (current_obstacle.is_point_inside(finish_pose_)) {
-            std::cerr << "avoidance: Finish pose is inside an obstacle" << std::endl;
-            return false;
+void Avoidance::check_obstacle_points()
+{
+    const size_t count = obstacle_set_.size();
+    const double* points_x = obstacle_set_.bounding_box_x();
+    const double* points_y = obstacle_set_.bounding_box_y();
+
+    // Each bounding box point owns the slot of its index in the obstacle set.
+    // Point tests are independent: run them in parallel, one obstacle per iteration.
+    point_valid_.assign(obstacle_set_.bounding_box_offset(count), false);
+    parallel_for(count, 1, [&](size_t, size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            if (!is_point_in_table_limits(obstacle_set_.center_x(k), obstacle_set_.center_y(k))) {
+                continue;
+            }
+            uint32_t first = obstacle_set_.bounding_box_offset(k);
+            uint32_t last = obstacle_set_.bounding_box_offset(k + 1);
+            obstacle_set_.points_inside(points_x + first, points_y + first, last - first, &point_valid_[first]);
+            for (uint32_t slot = first; slot < last; slot++) {
+                point_valid_[slot] = !point_valid_[slot] && is_point_in_table_limits(points_x[slot], points_y[slot]);
+            }
         }
-        if (current_obstacle.is_point_inside(start_pose_)) {
-            start_pose_ = current_obstacle.nearest_point(start_pose_);
-            logger::debug << "start pose inside obstacle, updated: " << start_pose_ << std::endl;
+    });
+}
+
+void Avoidance::validate_obstacle_points()
+{
+    const size_t count = obstacle_set_.size();
+    const double* points_x = obstacle_set_.bounding_box_x();
+    const double* points_y = obstacle_set_.bounding_box_y();
+
+    // Collect valid points in obstacle order, so vertex numbering does not depend on scheduling.
+    vertex_slots_.assign(valid_points_.size(), ObstacleSet::no_slot);
+    vertex_obstacles_.assign(valid_points_.size(), UINT32_MAX);
+    for (size_t k = 0; k < count; k++) {
+        for (uint32_t slot = obstacle_set_.bounding_box_offset(k); slot < obstacle_set_.bounding_box_offset(k + 1); slot += point_stride_) {
+            if (!point_valid_[slot]) {
+                continue;
+            }
+            valid_points_.emplace_back(points_x[slot], points_y[slot]);
+            vertex_slots_.push_back(slot);
+            vertex_obstacles_.push_back(k);
         }
     }
 
-    logger::debug << "avoidance: Poses validated" << std::endl;
+    COGIP_LOG_DEBUG << "validate_obstacle_points: number of valid points = " << valid_points_.size() << std::endl;
+    if (logger::is_enabled(logger::LogLevel::DEBUG)) {
+        for (const auto& point : valid_points_) {
+            logger::debug << "{" << point << "}" << std::endl;
+        }
+    }
+}
 
-    // Prepare valid points for pathfinding
-    valid_points_ = {start_pose_, finish_pose_};
-    logger::debug << "valid_points_[0] = " << valid_points_[0] << std::endl;
-    logger::debug << "valid_points_[1] = " << valid_points_[1] << std::endl;
+void Avoidance::set_worker_count(size_t count)
+{
+    if (count == worker_count()) {
+        return;
+    }
+    worker_pool_.reset();
+    if (count > 1) {
+        worker_pool_ = std::make_unique<WorkerPool>(count);
+    }
+}
 
-    // Build avoidance graph and compute path using Dijkstra
-    logger::debug << "avoidance: Building graph and computing path" << std::endl;
-    build_avoidance_graph();
+void Avoidance::parallel_for(size_t count, size_t chunk, const WorkerPool::Task& task)
+{
+    if (worker_pool_) {
+        worker_pool_->parallel_for(count, chunk, task);
+    }
+    else {
+        task(0, 0, count);
+    }
+}
 
-    bool ret = dijkstra();
-    if (ret) {
-        logger::debug << "avoidance: Path successfully computed" << std::endl;
-    } else {
-        std::cerr << "avoidance: Failed to compute path" << std::endl;
+void Avoidance::set_planning_speed(double speed)
+{
+    if (!(speed > 0)) {
+        throw std::invalid_argument("Avoidance: planning speed must be positive");
     }
+    planning_speed_ = speed;
+}
 
-    return ret;
+void Avoidance::set_prediction_horizon(double horizon)
+{
+    if (!(horizon >= 0)) {
+        throw std::invalid_argument("Avoidance: prediction horizon must not be negative");
+    }
+    prediction_horizon_ = horizon;
 }
 
-bool Avoidance::is_point_in_obstacles(const models::Coords& point, const cogip::obstacles::Obstacle* filter) const
+void Avoidance::set_clearance_weight(double weight)
 {
-    for (const auto& obstacle : dynamic_obstacles_) {
-        if (&obstacle.get() == filter) {
-            continue;
+    if (!(weight >= 0)) {
+        throw std::invalid_argument("Avoidance: clearance weight must not be negative");
+    }
+    clearance_weight_ = weight;
+}
+
+void Avoidance::set_clearance_distance(double distance)
+{
+    if (!(distance > 0)) {
+        throw std::invalid_argument("Avoidance: clearance distance must be positive");
+    }
+    clearance_distance_ = distance;
+}
+
+double Avoidance::clearance(const models::Coords& point)
+{
+    update_obstacle_set();
+    update_clearance_field();
+    return clearance_field_.distance(models::Vec2(point.x(), point.y()));
+}
+
+void Avoidance::update_clearance_field()
+{
+    if (!clearance_field_.is_built()) {
+        clearance_field_.build(
+            obstacle_set_,
+            table_limits_[0] + table_limits_margin_, table_limits_[1] - table_limits_margin_,
+            table_limits_[2] + table_limits_margin_, table_limits_[3] - table_limits_margin_
+        );
+    }
+}
+
+double Avoidance::edge_cost(const models::Vec2& a, const models::Vec2& b) const
+{
+    double cost = a.distance(b);
+    if (clearance_weight_ > 0) {
+        cost += clearance_weight_ * clearance_field_.penalty(a, b, clearance_distance_);
+    }
+    return cost;
+}
+
+void Avoidance::set_incremental(bool incremental)
+{
+    incremental_ = incremental;
+    obstacle_hashes_.clear();
+    obstacle_slots_.clear();
+    visibility_cache_.clear();
+    visibility_cache_.shrink_to_fit();
+}
+
+int Avoidance::find_blocking_obstacle(uint32_t i, uint32_t j, bool changed_only)
+{
+    const models::Vec2& a = valid_points_[i];
+    const models::Vec2& b = valid_points_[j];
+    const uint32_t slot_a = vertex_slots_[i];
+    const uint32_t slot_b = vertex_slots_[j];
+    int blocker = -1;
+    obstacle_grid_.visit_segment(
+        a.x, a.y, b.x, b.y,
+        [&](uint32_t k) {
+            if (changed_only && !obstacle_changed_[k]) {
+                return false;
+            }
+            if (obstacle_set_.is_segment_crossing(k, a.x, a.y, b.x, b.y, slot_a, slot_b)) {
+                blocker = k;
+                return true;
+            }
+            return false;
         }
-        if (obstacle.get().is_point_inside(point)) {
-            return true;
+    );
+    return blocker;
+}
+
+bool Avoidance::find_blocking_obstacle_from_roadmap(uint32_t i, uint32_t j, int& blocker)
+{
+    const uint32_t obstacle_i = vertex_obstacles_[i];
+    const uint32_t obstacle_j = vertex_obstacles_[j];
+    const uint32_t fixed_i = roadmap_obstacles_[obstacle_i];
+    const uint32_t fixed_j = roadmap_obstacles_[obstacle_j];
+    if (fixed_i == UINT32_MAX || fixed_j == UINT32_MAX) {
+        return false;
+    }
+
+    // Fixed obstacles have the same points in the set and in the roadmap.
+    const uint32_t point_i = roadmap_.point_offset(fixed_i) + vertex_slots_[i] - obstacle_set_.bounding_box_offset(obstacle_i);
+    const uint32_t point_j = roadmap_.point_offset(fixed_j) + vertex_slots_[j] - obstacle_set_.bounding_box_offset(obstacle_j);
+    const int16_t fixed_blocker = roadmap_.blocker(point_i, point_j);
+    if (fixed_blocker == StaticRoadmap::free) {
+        // Other obstacles are few: test them directly rather than walking the grid.
+        const models::Vec2& a = valid_points_[i];
+        const models::Vec2& b = valid_points_[j];
+        blocker = -1;
+        for (uint32_t k : roadmap_others_) {
+            if (obstacle_set_.is_segment_crossing(k, a.x, a.y, b.x, b.y, vertex_slots_[i], vertex_slots_[j])) {
+                blocker = k;
+                break;
+            }
         }
     }
-    return false;
+    else if (roadmap_present_[fixed_blocker] != UINT32_MAX) {
+        blocker = roadmap_present_[fixed_blocker];
+    }
+    else {
+        // The blocking fixed obstacle is disabled: another one may still block.
+        blocker = find_blocking_obstacle(i, j);
+    }
+    return true;
 }
 
-bool Avoidance::check_recompute(const models::Coords& start,
-                                const models::Coords& stop)
+void Avoidance::set_roadmap_directory(const std::string& directory)
 {
-    for (auto obstacle : dynamic_obstacles_) {
-        if (!is_point_in_table_limits(obstacle.get().center())) {
-            continue;
+    roadmap_directory_ = directory;
+    obstacle_set_dirty_ = true;
+}
+
+bool Avoidance::set_static_obstacles(const std::vector<std::reference_wrapper<obstacles::Obstacle>>& obstacles)
+{
+    const RoadmapKey key = RoadmapKey::from_properties(shared_memory_properties_);
+    ObstacleSet fixed_obstacles;
+    apply_footprint(fixed_obstacles);
+    fixed_obstacles.build(obstacles);
+
+    // A saved roadmap is only reused if it was built for these very obstacles.
+    bool loaded = false;
+    if (!roadmap_directory_.empty()) {
+        StaticRoadmap saved;
+        std::string path = roadmap_directory_ + "/" + key.file_name();
+        loaded = saved.load(path, key) && saved.obstacle_count() == fixed_obstacles.size();
+        for (size_t k = 0; loaded && k < fixed_obstacles.size(); k++) {
+            loaded = (saved.obstacle_hash(k) == StaticRoadmap::hash_obstacle(fixed_obstacles, k));
         }
-        if (obstacle.get().is_segment_crossing(start, stop)) {
-            return true;
+        if (loaded) {
+            roadmap_ = std::move(saved);
         }
     }
-    return false;
+    if (!loaded) {
+        roadmap_.build(key, fixed_obstacles);
+        if (!roadmap_directory_.empty()) {
+            std::string path = roadmap_directory_ + "/" + key.file_name();
+            if (!roadmap_.save(path)) {
+                COGIP_LOG_WARNING << "set_static_obstacles: cannot write " << path << std::endl;
+            }
+        }
+    }
+    COGIP_LOG_DEBUG << "set_static_obstacles: roadmap of " << roadmap_.obstacle_count() << " obstacles "
+                    << (loaded ? "loaded" : "computed") << std::endl;
+
+    obstacle_set_dirty_ = true;
+    return loaded;
 }
 
-void Avoidance::validate_obstacle_points()
+void Avoidance::update_roadmap()
 {
-    for (const auto& obstacle_wrapper : dynamic_obstacles_) {
-        auto& obstacle = obstacle_wrapper.get();
+    COGIP_TRACE_SPAN("Avoidance::update_roadmap");
+    const size_t count = obstacle_set_.size();
+    roadmap_active_ = false;
+
+    if (shared_memory_properties_.disable_fixed_obstacles) {
+        return;
+    }
+    const RoadmapKey key = RoadmapKey::from_properties(shared_memory_properties_);
+    if ((roadmap_.empty() || !(roadmap_.key() == key)) && !roadmap_directory_.empty()) {
+        if (roadmap_.load(roadmap_directory_ + "/" + key.file_name(), key)) {
+            COGIP_LOG_DEBUG << "update_roadmap: roadmap of " << roadmap_.obstacle_count() << " obstacles loaded" << std::endl;
+        }
+    }
+    if (roadmap_.empty() || !(roadmap_.key() == key)) {
+        return;
+    }
 
-        if (!is_point_in_table_limits(obstacle.center())) {
+    roadmap_obstacles_.assign(count, UINT32_MAX);
+    roadmap_present_.assign(roadmap_.obstacle_count(), UINT32_MAX);
+    roadmap_others_.clear();
+    for (size_t k = 0; k < count; k++) {
+        int fixed = roadmap_.find_obstacle(StaticRoadmap::hash_obstacle(obstacle_set_, k));
+        if (fixed < 0 || roadmap_present_[fixed] != UINT32_MAX) {
+            roadmap_others_.push_back(k);
             continue;
         }
+        roadmap_obstacles_[k] = fixed;
+        roadmap_present_[fixed] = k;
+        roadmap_active_ = true;
+    }
+}
 
-        for (const auto& point : obstacle.bounding_box()) {
-            if (!is_point_in_table_limits(point) || is_point_in_obstacles(point, nullptr)) {
-                continue;
-            }
-            valid_points_.emplace_back(point.x(), point.y());
+/// Hash the obstacle geometry used by the graph: center, radius and bounding box points.
+static uint64_t hash_obstacle(obstacles::Obstacle& obstacle)
+{
+    // FNV-1a over the raw bits of each value.
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; i++) {
+            hash ^= (bits >> (i * 8)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    models::PoseValue center(obstacle.center());
+    mix(center.x);
+    mix(center.y);
+    mix(center.angle);
+    mix(obstacle.radius());
+    for (const models::coords_t& point : obstacle.bounding_box().view()) {
+        mix(point.x);
+        mix(point.y);
+    }
+    return hash;
+}
+
+void Avoidance::update_obstacle_cache()
+{
+    const size_t count = dynamic_obstacles_.size();
+
+    // Slot layout changes when obstacles are added, removed or change their number of points:
+    // in that case, nothing can be reused.
+    bool same_layout = (obstacle_slots_.size() == count + 1);
+    uint32_t slot = 0;
+    for (size_t k = 0; k < count && same_layout; k++) {
+        same_layout = (obstacle_slots_[k] == slot);
+        slot += dynamic_obstacles_[k].get().bounding_box().size();
+    }
+    same_layout = same_layout && (obstacle_slots_[count] == slot);
+    if (count > INT16_MAX) {
+        throw std::runtime_error("Avoidance: too many obstacles for incremental mode");
+    }
+
+    if (!same_layout) {
+        obstacle_slots_.resize(count + 1);
+        slot = 0;
+        for (size_t k = 0; k < count; k++) {
+            obstacle_slots_[k] = slot;
+            slot += dynamic_obstacles_[k].get().bounding_box().size();
         }
+        obstacle_slots_[count] = slot;
+        obstacle_hashes_.assign(count, 0);
+        visibility_cache_.assign(static_cast<size_t>(slot) * (slot - 1) / 2 + 1, visibility_unknown);
+        COGIP_LOG_DEBUG << "update_obstacle_cache: obstacle layout changed, " << slot << " slots" << std::endl;
     }
 
-    logger::debug << "validate_obstacle_points: number of valid points = " << valid_points_.size() << std::endl;
-    for (const auto& point : valid_points_) {
-        logger::debug << "{" << point << "}" << std::endl;
+    obstacle_changed_.assign(count, !same_layout);
+    any_obstacle_changed_ = !same_layout;
+    for (size_t k = 0; k < count; k++) {
+        uint64_t hash = hash_obstacle(dynamic_obstacles_[k].get());
+        if (hash != obstacle_hashes_[k]) {
+            obstacle_hashes_[k] = hash;
+            obstacle_changed_[k] = true;
+            any_obstacle_changed_ = true;
+        }
     }
 }
 
-void Avoidance::build_avoidance_graph()
+void Avoidance::build_edges(size_t begin, size_t end, std::vector<std::tuple<uint32_t, uint32_t, double>>& edges)
 {
-    logger::debug << "build_avoidance_graph: build avoidance graph" << std::endl;
+    // The cache only holds results of full graphs.
+    const bool use_cache = incremental_ && point_stride_ == 1;
 
-    validate_obstacle_points();
-    graph_.clear();
+    for (size_t i = begin; i < end; i++) {
+        // Rows are checked against the deadline one by one, the graph is incomplete once aborted.
+        if (has_deadline_ && (build_aborted_ || std::chrono::steady_clock::now() > deadline_)) {
+            build_aborted_ = true;
+            return;
+        }
 
-    for (size_t i = 0; i < valid_points_.size(); i++) {
         const auto& point_i = valid_points_[i];
         for (size_t j = i + 1; j < valid_points_.size(); j++) {
             const auto& point_j = valid_points_[j];
-            bool collide = false;
-            for (const auto& obstacle : dynamic_obstacles_) {
-                if (obstacle.get().is_segment_crossing(point_i, point_j)) {
-                    collide = true;
-                    break;
+            int blocker;
+
+            // Leading vertices are start and finish, or path cost queries: their edges are always fully tested.
+            if (i >= terminal_count_ && roadmap_active_ && find_blocking_obstacle_from_roadmap(i, j, blocker)) {
+                if (use_cache) {
+                    uint32_t slot_j = vertex_slots_[j];
+                    visibility_cache_[static_cast<size_t>(slot_j) * (slot_j - 1) / 2 + vertex_slots_[i]] =
+                        (blocker < 0) ? visibility_free : blocker;
+                }
+            }
+            else if (!use_cache || i < terminal_count_) {
+                blocker = find_blocking_obstacle(i, j);
+            }
+            else {
+                uint32_t slot_i = vertex_slots_[i];
+                uint32_t slot_j = vertex_slots_[j];
+                int16_t& cached = visibility_cache_[static_cast<size_t>(slot_j) * (slot_j - 1) / 2 + slot_i];
+
+                if (cached == visibility_unknown ||
+                    obstacle_changed_[vertex_obstacles_[i]] ||
+                    obstacle_changed_[vertex_obstacles_[j]]) {
+                    blocker = find_blocking_obstacle(i, j);
                 }
+                else if (cached == visibility_free) {
+                    blocker = find_blocking_obstacle(i, j, true);
+                }
+                else if (obstacle_changed_[cached]) {
+                    blocker = find_blocking_obstacle(i, j);
+                }
+                else {
+                    blocker = cached;
+                }
+                cached = (blocker < 0) ? visibility_free : blocker;
+            }
+
+            if (blocker < 0) {
+                edges.emplace_back(i, j, edge_cost(point_i, point_j));
             }
-            if (!collide) {
-                double distance = utils::calculate_distance(
-                    point_i.x(),
-                    point_i.y(),
-                    point_j.x(),
-                    point_j.y()
-                );
-                graph_[i][j] = distance;
-                graph_[j][i] = distance;
+        }
+    }
+}
+
+void Avoidance::invalidate_unused_slots()
+{
+    // Pairs skipped because a point is currently invalid were not updated:
+    // their results are stale if obstacles changed.
+    if (!any_obstacle_changed_) {
+        return;
+    }
+    slot_valid_.assign(obstacle_slots_.back(), false);
+    for (size_t v = terminal_count_; v < vertex_slots_.size(); v++) {
+        slot_valid_[vertex_slots_[v]] = true;
+    }
+    for (uint32_t slot_j = 1; slot_j < slot_valid_.size(); slot_j++) {
+        int16_t* row = &visibility_cache_[static_cast<size_t>(slot_j) * (slot_j - 1) / 2];
+        for (uint32_t slot_i = 0; slot_i < slot_j; slot_i++) {
+            if (!slot_valid_[slot_i] || !slot_valid_[slot_j]) {
+                row[slot_i] = visibility_unknown;
             }
         }
     }
+}
+
+void Avoidance::build_avoidance_graph(bool check_points)
+{
+    COGIP_TRACE_SPAN("Avoidance::build_avoidance_graph");
+    COGIP_LOG_DEBUG << "build_avoidance_graph: build avoidance graph" << std::endl;
+
+    const bool use_cache = incremental_ && point_stride_ == 1;
+    if (use_cache) {
+        update_obstacle_cache();
+    }
+    if (check_points) {
+        check_obstacle_points();
+    }
+    validate_obstacle_points();
+    if (clearance_weight_ > 0) {
+        update_clearance_field();
+    }
+    graph_edges_.clear();
+    build_aborted_ = false;
+
+    if (worker_pool_) {
+        // Each worker collects its own edges, which are merged in (i, j) order
+        // so the graph is identical to a sequential build.
+        worker_edges_.resize(worker_pool_->size());
+        for (auto& edges : worker_edges_) {
+            edges.clear();
+        }
+        worker_pool_->parallel_for(valid_points_.size(), 1, [this](size_t worker, size_t begin, size_t end) {
+            build_edges(begin, end, worker_edges_[worker]);
+        });
+        for (const auto& edges : worker_edges_) {
+            graph_edges_.insert(graph_edges_.end(), edges.begin(), edges.end());
+        }
+        std::sort(graph_edges_.begin(), graph_edges_.end());
+    }
+    else {
+        build_edges(0, valid_points_.size(), graph_edges_);
+    }
+
+    if (build_aborted_) {
+        // Obstacle hashes are already updated but some cached pairs were not:
+        // reset the cache layout so the next build re-tests everything.
+        if (use_cache) {
+            obstacle_slots_.clear();
+        }
+        COGIP_LOG_DEBUG << "build_avoidance_graph: deadline reached, graph discarded" << std::endl;
+        return;
+    }
 
+    if (use_cache) {
+        invalidate_unused_slots();
+    }
+
+    pack_graph();
     print_graph();
 }
 
+void Avoidance::pack_graph()
+{
+    const size_t vertices = valid_points_.size();
+
+    // Count the degree of each vertex, shifted by one so the prefix sum gives the offsets.
+    graph_offsets_.assign(vertices + 1, 0);
+    for (const auto& [i, j, weight] : graph_edges_) {
+        graph_offsets_[i + 1]++;
+        graph_offsets_[j + 1]++;
+    }
+    for (size_t v = 0; v < vertices; v++) {
+        graph_offsets_[v + 1] += graph_offsets_[v];
+    }
+
+    // Scatter both directions of each edge at the write cursor of its source vertex.
+    graph_neighbors_.resize(graph_offsets_[vertices]);
+    graph_weights_.resize(graph_offsets_[vertices]);
+    graph_cursors_.assign(graph_offsets_.begin(), graph_offsets_.end() - 1);
+    for (const auto& [i, j, weight] : graph_edges_) {
+        uint32_t& cursor_i = graph_cursors_[i];
+        graph_neighbors_[cursor_i] = j;
+        graph_weights_[cursor_i++] = weight;
+        uint32_t& cursor_j = graph_cursors_[j];
+        graph_neighbors_[cursor_j] = i;
+        graph_weights_[cursor_j++] = weight;
+    }
+}
+
 bool Avoidance::dijkstra()
 {
+    COGIP_TRACE_SPAN("Avoidance::dijkstra");
     constexpr double MAX_DISTANCE = std::numeric_limits<double>::infinity();
-    logger::debug << "dijkstra: Compute Dijkstra" << std::endl;
+    COGIP_LOG_DEBUG << "dijkstra: Compute "
+                    << (search_algorithm_ == SearchAlgorithm::ASTAR ? "A*" : "Dijkstra") << std::endl;
 
-    std::map<int, bool> checked;
-    std::map<int, double> distances;
-    std::map<int, int> parents;
+    const size_t vertices = valid_points_.size();
+    const uint32_t start = START_INDEX;
+    const uint32_t finish = FINISH_INDEX;
+    const bool use_heuristic = (search_algorithm_ == SearchAlgorithm::ASTAR);
+    const double finish_x = valid_points_[finish].x;
+    const double finish_y = valid_points_[finish].y;
+    const bool check_moving = time_aware_ && !moving_obstacles_.empty();
 
-    int start = START_INDEX;
-    int finish = FINISH_INDEX;
+    // Euclidean distance to finish never overestimates the remaining path length,
+    // so A* returns the same shortest path as Dijkstra.
+    auto heuristic = [&](uint32_t v) {
+        if (!use_heuristic) {
+            return 0.0;
+        }
+        return utils::calculate_distance(valid_points_[v].x, valid_points_[v].y, finish_x, finish_y);
+    };
 
-    for (size_t i = 0; i < valid_points_.size(); ++i) {
-        checked[i] = false;
-        distances[i] = MAX_DISTANCE;
-        parents[i] = -1;
-    }
-    path_.clear();
-    distances[start] = 0;
+    checked_.assign(vertices, false);
+    distances_.assign(vertices, MAX_DISTANCE);
+    parents_.assign(vertices, -1);
+    open_set_.reset(vertices);
+    path_size_ = 0;
+    finish_pose_ = valid_points_[finish];
+    goal_reached_ = !finish_projected_;
 
-    if (graph_.find(start) == graph_.end() || graph_[start].empty()) {
+    if (graph_offsets_[start] == graph_offsets_[start + 1]) {
         std::cerr << "dijkstra: Start pose has no reachable neighbors" << std::endl;
         is_avoidance_computed_ = false;
         return false;
     }
 
-    int v = start;
-    while ((v != finish) && !checked[v]) {
-        checked[v] = true;
+    distances_[start] = 0;
+    open_set_.push(start, heuristic(start));
 
-        for (const auto& [neighbor, weight] : graph_[v]) {
-            if (distances[neighbor] > distances[v] + weight) {
-                distances[neighbor] = distances[v] + weight;
-                parents[neighbor] = v;
-            }
+    while (!open_set_.empty()) {
+        uint32_t v = open_set_.pop();
+        if (v == finish) {
+            break;
         }
+        checked_[v] = true;
 
-        double min_distance = MAX_DISTANCE;
-        for (const auto& [index, distance] : distances) {
-            if (!checked[index] && distance < min_distance) {
-                min_distance = distance;
-                v = index;
+        for (uint32_t e = graph_offsets_[v]; e < graph_offsets_[v + 1]; e++) {
+            uint32_t neighbor = graph_neighbors_[e];
+            if (checked_[neighbor] || (neighbor == finish && finish_blocked_)) {
+                continue;
+            }
+            double distance = distances_[v] + graph_weights_[e];
+            if (distance >= distances_[neighbor]) {
+                continue;
             }
+            // The edge is left when the robot has travelled the shortest distance to v.
+            if (check_moving && !is_clear_of_moving_obstacles(valid_points_[v], valid_points_[neighbor], distances_[v])) {
+                continue;
+            }
+            distances_[neighbor] = distance;
+            parents_[neighbor] = v;
+            open_set_.push(neighbor, distance + heuristic(neighbor));
         }
+    }
 
-        if (min_distance == MAX_DISTANCE) {
-            std::cerr << "dijkstra: No more points to check" << std::endl;
-            is_avoidance_computed_ = false;
-            return false;
+    // The search exhausted the vertices reachable from start: lead to the one nearest to the requested finish.
+    uint32_t target = finish;
+    if (distances_[finish] == MAX_DISTANCE && reach_nearest_goal_) {
+        target = start;
+        double nearest = valid_points_[start].distance(goal_pose_);
+        for (uint32_t v = 0; v < vertices; v++) {
+            if (distances_[v] != MAX_DISTANCE && valid_points_[v].distance(goal_pose_) < nearest) {
+                nearest = valid_points_[v].distance(goal_pose_);
+                target = v;
+            }
+        }
+        if (target != start) {
+            finish_pose_ = valid_points_[target];
+            goal_reached_ = false;
+            COGIP_LOG_DEBUG << "dijkstra: Finish unreachable, nearest reachable point: " << finish_pose_ << std::endl;
         }
     }
 
-    print_parents(parents);
+    if (distances_[target] == MAX_DISTANCE || target == start) {
+        std::cerr << "dijkstra: No more points to check" << std::endl;
+        is_avoidance_computed_ = false;
+        return false;
+    }
+
+    print_parents(parents_);
 
-    int current = parents[finish];
-    while (current != -1 && current != start) {
-        path_.emplace_front(valid_points_[current]);
-        current = parents[current];
+    // Count the path vertices, start included, target excluded, then fill the path backwards.
+    size_t count = 1;
+    int current = parents_[target];
+    while (current != -1 && current != static_cast<int>(start)) {
+        count++;
+        current = parents_[current];
+    }
+    if (count > path_capacity) {
+        std::cerr << "dijkstra: Path of " << count << " points exceeds " << path_capacity << " points" << std::endl;
+        is_avoidance_computed_ = false;
+        return false;
+    }
+    size_t index = count;
+    current = parents_[target];
+    while (current != -1 && current != static_cast<int>(start)) {
+        path_[--index] = valid_points_[current];
+        current = parents_[current];
     }
-    path_.emplace_front(valid_points_[start]);
+    path_[0] = valid_points_[start];
+    path_size_ = count;
+    path_vertices_.clear();
+    for (current = static_cast<int>(target); current != -1; current = parents_[current]) {
+        path_vertices_.push_back(current);
+    }
+    std::reverse(path_vertices_.begin(), path_vertices_.end());
 
     is_avoidance_computed_ = true;
     print_path();
     return true;
 }
 
+void Avoidance::single_source_distances(uint32_t source)
+{
+    const size_t vertices = valid_points_.size();
+
+    checked_.assign(vertices, false);
+    distances_.assign(vertices, std::numeric_limits<double>::infinity());
+    open_set_.reset(vertices);
+
+    distances_[source] = 0;
+    open_set_.push(source, 0);
+
+    // No target: expand until every reachable vertex is settled.
+    while (!open_set_.empty()) {
+        uint32_t v = open_set_.pop();
+        checked_[v] = true;
+
+        // Other queries are path ends only, so each cost is the length of the path avoidance() would return.
+        if (v < terminal_count_ && v != source) {
+            continue;
+        }
+
+        for (uint32_t e = graph_offsets_[v]; e < graph_offsets_[v + 1]; e++) {
+            uint32_t neighbor = graph_neighbors_[e];
+            if (checked_[neighbor]) {
+                continue;
+            }
+            double distance = distances_[v] + graph_weights_[e];
+            if (distance < distances_[neighbor]) {
+                distances_[neighbor] = distance;
+                open_set_.push(neighbor, distance);
+            }
+        }
+    }
+}
+
+models::Vec2 Avoidance::nearest_point_in_table_limits(const models::Vec2& point) const
+{
+    // Limits are exclusive: stay just inside them.
+    const double x_min = table_limits_[0] + table_limits_margin_;
+    const double x_max = table_limits_[1] - table_limits_margin_;
+    const double y_min = table_limits_[2] + table_limits_margin_;
+    const double y_max = table_limits_[3] - table_limits_margin_;
+    return models::Vec2(
+        std::clamp(point.x, std::nextafter(x_min, x_max), std::nextafter(x_max, x_min)),
+        std::clamp(point.y, std::nextafter(y_min, y_max), std::nextafter(y_max, y_min))
+    );
+}
+
 models::Coords Avoidance::get_path_pose(uint8_t index) const
 {
     // Check if index is within range of _path
     if (index < get_path_size()) {
-        return path_[index];
+        const models::Vec2& point = path_[index];
+        return models::Coords(point.x, point.y);
     }
 
     // If index is out of range, throw an exception
@@ -256,38 +1645,120 @@ models::Coords Avoidance::get_path_pose(uint8_t index) const
 
 void Avoidance::add_dynamic_obstacle(cogip::obstacles::Obstacle& obstacle) {
     dynamic_obstacles_.emplace_back(obstacle);
+    obstacle_set_dirty_ = true;
+    snapshot_loaded_ = false;
 }
 
 void Avoidance::clear_dynamic_obstacles() {
     dynamic_obstacles_.clear();
+    obstacle_set_dirty_ = true;
+    snapshot_loaded_ = false;
+}
+
+bool Avoidance::load_obstacles_from_shared_memory() {
+    COGIP_TRACE_SPAN("Avoidance::load_obstacles_from_shared_memory");
+    // Obstacles were not written since the last load.
+    if (snapshot_loaded_ && shared_memory_.getGeneration(shared_memory::LockName::Obstacles) == snapshot_generation_) {
+        return false;
+    }
+
+    ObstacleSnapshot& snapshot = snapshots_[1 - front_snapshot_];
+
+    // The frame is read before the obstacles, so it is not more recent than the detector obstacles they come from.
+    obstacles_latency_frame_ = shared_memory_.readLatencyFrame(shared_memory::LatencyStage::DetectorObstacles);
+
+    // Only copy the used coordinates of the published lists, the copy restarts if the planner overwrote them.
+    uint64_t generation = shared_memory_.readObstacles([&snapshot](const shared_memory::planner_obstacles_t& lists) {
+        snapshot.clear();
+        size_t circle_count = std::min(lists.circles.count, obstacles::OBSTACLE_LIST_SIZE_MAX);
+        size_t rectangle_count = std::min(lists.rectangles.count, obstacles::OBSTACLE_LIST_SIZE_MAX);
+        for (size_t i = 0; i < circle_count; i++) {
+            snapshot.add_circle(lists.circles.elems[i]);
+        }
+        for (size_t i = 0; i < rectangle_count; i++) {
+            snapshot.add_rectangle(lists.rectangles.elems[i]);
+        }
+    });
+
+    if (snapshot_loaded_ && snapshot == snapshots_[front_snapshot_]) {
+        snapshot_generation_ = generation;
+        return false;
+    }
+    front_snapshot_ = 1 - front_snapshot_;
+
+    // Rebuild compact obstacle structures, only needed by the obstacle classes.
+    if (snapshot_circle_data_.size() < snapshot.circle_count()) {
+        snapshot_circle_data_.resize(snapshot.circle_count());
+    }
+    if (snapshot_rectangle_data_.size() < snapshot.rectangle_count()) {
+        snapshot_rectangle_data_.resize(snapshot.rectangle_count());
+    }
+
+    clear_dynamic_obstacles();
+    snapshot_circles_.clear();
+    snapshot_rectangles_.clear();
+    for (size_t i = 0; i < snapshot.circle_count(); i++) {
+        snapshot.restore_circle(i, snapshot_circle_data_[i]);
+        add_dynamic_obstacle(snapshot_circles_.emplace_back(&snapshot_circle_data_[i]));
+    }
+    for (size_t i = 0; i < snapshot.rectangle_count(); i++) {
+        snapshot.restore_rectangle(i, snapshot_rectangle_data_[i]);
+        add_dynamic_obstacle(snapshot_rectangles_.emplace_back(&snapshot_rectangle_data_[i]));
+    }
+    if (apply_footprint(obstacle_set_)) {
+        obstacle_slots_.clear();
+    }
+    obstacle_set_.load(snapshot);
+    obstacle_grid_.build(obstacle_set_);
+    grid_planner_.invalidate();
+    clearance_field_.invalidate();
+    update_moving_obstacles();
+    update_roadmap();
+    obstacle_set_dirty_ = false;
+    snapshot_loaded_ = true;
+    snapshot_generation_ = generation;
+
+    return true;
 }
 
 void Avoidance::print_graph() {
-    for (const auto& [node, edges] : graph_) {
-        logger::debug << "Point " << node << "("
-                        << valid_points_[node].x() << ", "
-                        << valid_points_[node].y() << ") -> { " << std::endl;
-        for (const auto& [neighbor, distance] : edges) {
-            logger::debug << "    (" << neighbor << ": " << distance << ")" << std::endl;
+    if (!logger::is_enabled(logger::LogLevel::DEBUG)) {
+        return;
+    }
+    for (size_t node = 0; node + 1 < graph_offsets_.size(); node++) {
+        if (graph_offsets_[node] == graph_offsets_[node + 1]) {
+            continue;
+        }
+        COGIP_LOG_DEBUG << "Point " << node << "("
+                        << valid_points_[node].x << ", "
+                        << valid_points_[node].y << ") -> { " << std::endl;
+        for (uint32_t e = graph_offsets_[node]; e < graph_offsets_[node + 1]; e++) {
+            COGIP_LOG_DEBUG << "    (" << graph_neighbors_[e] << ": " << graph_weights_[e] << ")" << std::endl;
         }
-        logger::debug << "}" << std::endl;
+        COGIP_LOG_DEBUG << "}" << std::endl;
     }
 }
 
 void Avoidance::print_path() {
-    logger::debug << "Path (size = " << path_.size() << "): " << std::endl;
-    for (const auto& coords : path_) {
-        logger::debug << "    (" << coords.get().x() << ", " << coords.get().y() << ")" << std::endl;
+    if (!logger::is_enabled(logger::LogLevel::DEBUG)) {
+        return;
     }
-    logger::debug << std::endl;
+    COGIP_LOG_DEBUG << "Path (size = " << path_size_ << "): " << std::endl;
+    for (const models::Vec2& point : get_path()) {
+        COGIP_LOG_DEBUG << "    (" << point.x << ", " << point.y << ")" << std::endl;
+    }
+    COGIP_LOG_DEBUG << std::endl;
 }
 
-void Avoidance::print_parents(const std::map<int, int>& parents) {
-    logger::debug << "Parents: " << std::endl;
-    for (const auto& [child, parent] : parents) {
-        logger::debug << "    (" << child << ", " << parent << ")" << std::endl;
+void Avoidance::print_parents(const std::vector<int>& parents) {
+    if (!logger::is_enabled(logger::LogLevel::DEBUG)) {
+        return;
+    }
+    COGIP_LOG_DEBUG << "Parents: " << std::endl;
+    for (size_t child = 0; child < parents.size(); child++) {
+        COGIP_LOG_DEBUG << "    (" << child << ", " << parents[child] << ")" << std::endl;
     }
-    logger::debug << std::endl;
+    COGIP_LOG_DEBUG << std::endl;
 }
 
 } // namespace avoidance
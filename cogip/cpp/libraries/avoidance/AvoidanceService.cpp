@@ -0,0 +1,463 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+// Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Project includes
+#include "avoidance/AvoidanceService.hpp"
+#include "logger/PythonLogger.hpp"
+#include "utils/trigonometry.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// Minimum distance (mm) between two poses to consider the robot or the path has moved.
+constexpr double min_moved_distance = 20.0;
+
+/// Minimum angle (degrees) between two poses to consider the robot or the path has turned.
+constexpr double min_turned_angle = 5.0;
+
+/// Default cycle period if path_refresh_interval is not set.
+constexpr double default_refresh_interval = 0.2;
+
+/// Timeout of the reflex thread waits for lidar points (s), to check regularly whether it must exit.
+constexpr double reflex_wait_timeout = 0.2;
+
+/// Part of the cycle period given to path planning, the rest is left to obstacle loading and publishing.
+constexpr double planning_budget_ratio = 0.8;
+
+/// Compare all fields of two pose orders.
+static bool same_pose_order(const models::pose_order_t& a, const models::pose_order_t& b)
+{
+    return a.x == b.x && a.y == b.y && a.angle == b.angle &&
+           a.max_speed_linear == b.max_speed_linear &&
+           a.max_speed_angular == b.max_speed_angular &&
+           a.motion_direction == b.motion_direction &&
+           a.bypass_anti_blocking == b.bypass_anti_blocking &&
+           a.bypass_final_orientation == b.bypass_final_orientation &&
+           a.timeout_ms == b.timeout_ms &&
+           a.is_intermediate == b.is_intermediate &&
+           a.stop_before_distance == b.stop_before_distance;
+}
+
+AvoidanceService::AvoidanceService(const std::string& name):
+    AvoidanceService(nullptr, std::make_unique<shared_memory::SharedMemory>(name, false))
+{
+}
+
+AvoidanceService::AvoidanceService(shared_memory::SharedMemory& shared_memory):
+    AvoidanceService(&shared_memory, nullptr)
+{
+}
+
+AvoidanceService::AvoidanceService(
+    shared_memory::SharedMemory* shared_memory,
+    std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory
+):
+    owned_shared_memory_(std::move(owned_shared_memory)),
+    shared_memory_(shared_memory ? *shared_memory : *owned_shared_memory_),
+    data_(shared_memory_.getData()),
+    properties_(shared_memory_.getProperties()),
+    obstacles_lock_(shared_memory_.getLock(shared_memory::LockName::Obstacles)),
+    blocked_lock_(shared_memory_.getLock(shared_memory::LockName::AvoidanceBlocked)),
+    lidar_coords_lock_(shared_memory_.getLock(shared_memory::LockName::LidarCoords)),
+    avoidance_(shared_memory_)
+{
+}
+
+AvoidanceService::~AvoidanceService()
+{
+    stop();
+}
+
+void AvoidanceService::start()
+{
+    if (running_) {
+        return;
+    }
+    obstacles_lock_.registerConsumer();
+    lidar_coords_lock_.registerConsumer();
+    has_pose_order_ = false;
+    reset_last_path();
+    reflex_blocked_ = false;
+    running_ = true;
+    thread_ = std::thread(&AvoidanceService::run, this);
+    reflex_thread_ = std::thread(&AvoidanceService::run_reflex, this);
+}
+
+void AvoidanceService::stop()
+{
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (reflex_thread_.joinable()) {
+        reflex_thread_.join();
+    }
+}
+
+void AvoidanceService::run()
+{
+    COGIP_LOG_INFO << "AvoidanceService: started" << std::endl;
+
+    while (running_ && !data_->avoidance_exiting) {
+        double interval = properties_.path_refresh_interval;
+        if (interval <= 0) {
+            interval = default_refresh_interval;
+        }
+
+        // Wake up as soon as obstacles are updated, or at least once per interval.
+        obstacles_lock_.waitUpdate(interval);
+        if (!running_ || data_->avoidance_exiting) {
+            break;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        cycle();
+        double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (duration > interval) {
+            COGIP_LOG_WARNING << "AvoidanceService: cycle duration " << duration << "s > " << interval << "s" << std::endl;
+        }
+    }
+
+    running_ = false;
+    COGIP_LOG_INFO << "AvoidanceService: exited" << std::endl;
+}
+
+void AvoidanceService::run_reflex()
+{
+    while (running_ && !data_->avoidance_exiting) {
+        if (!lidar_coords_lock_.waitUpdate(reflex_wait_timeout) || !reflex_enabled_) {
+            continue;
+        }
+        if (static_cast<AvoidanceStrategy>(properties_.avoidance_strategy) == AvoidanceStrategy::Disabled) {
+            continue;
+        }
+
+        models::pose_order_t target;
+        {
+            std::lock_guard<std::mutex> lock(reflex_mutex_);
+            if (!has_reflex_target_) {
+                continue;
+            }
+            target = reflex_target_;
+        }
+
+        models::pose_t pose_current = shared_memory_.readPoseCurrent();
+        if (!shared_memory_.isLidarCoordsNearSegment(pose_current.x, pose_current.y, target.x, target.y, reflex_clearance())) {
+            continue;
+        }
+
+        // The path is checked again once the next cycle publishes a new one.
+        {
+            std::lock_guard<std::mutex> lock(reflex_mutex_);
+            has_reflex_target_ = false;
+        }
+        reflex_blocked_ = true;
+        blocked_lock_.postUpdate();
+        if (debug_) {
+            COGIP_LOG_DEBUG << "AvoidanceService: lidar points on the path to " << target << std::endl;
+        }
+    }
+}
+
+double AvoidanceService::reflex_clearance() const
+{
+    double clearance = reflex_clearance_;
+    if (clearance <= 0) {
+        clearance = properties_.robot_width / 2.0;
+    }
+    return clearance;
+}
+
+void AvoidanceService::set_reflex_target(const models::pose_order_t& target)
+{
+    std::lock_guard<std::mutex> lock(reflex_mutex_);
+    reflex_target_ = target;
+    has_reflex_target_ = true;
+}
+
+void AvoidanceService::reset_last_path()
+{
+    has_last_pose_current_ = false;
+    has_last_emitted_ = false;
+    refine_path_ = false;
+    std::lock_guard<std::mutex> lock(reflex_mutex_);
+    has_reflex_target_ = false;
+}
+
+void AvoidanceService::cycle()
+{
+    // The reflex thread found lidar points on the published path: replan from scratch.
+    if (reflex_blocked_.exchange(false)) {
+        reset_last_path();
+        avoidance_.clear_cached_path();
+    }
+
+    // Check if a new pose order has been computed
+    if (data_->avoidance_has_new_pose_order) {
+        pose_order_ = data_->avoidance_pose_order;
+        has_pose_order_ = true;
+        data_->avoidance_has_pose_order = true;
+        data_->avoidance_has_new_pose_order = false;
+        reset_last_path();
+        avoidance_.clear_cached_path();
+        avoidance_.clear_alternative_paths();
+        if (debug_) {
+            COGIP_LOG_DEBUG << "AvoidanceService: new pose order received: " << pose_order_ << std::endl;
+        }
+    }
+
+    if (!data_->avoidance_has_pose_order || !has_pose_order_) {
+        reset_last_path();
+        return;
+    }
+
+    // Get current pose
+    models::pose_t pose_current = shared_memory_.readPoseCurrent();
+
+    if (has_last_pose_current_) {
+        // Check if pose order is far enough from current pose
+        double dist_xy = utils::calculate_distance(pose_current.x, pose_current.y, pose_order_.x, pose_order_.y);
+        double dist_angle = std::fabs(pose_current.angle - pose_order_.angle);
+        if (dist_xy < min_moved_distance && dist_angle < min_turned_angle) {
+            return;
+        }
+
+        // Check if robot has moved enough since the last path was computed
+        if (last_pose_current_.x != pose_current.x || last_pose_current_.y != pose_current.y) {
+            double dist = utils::calculate_distance(
+                pose_current.x, pose_current.y, last_pose_current_.x, last_pose_current_.y
+            );
+            if (dist < min_moved_distance) {
+                return;
+            }
+        }
+    }
+
+    auto strategy = static_cast<AvoidanceStrategy>(properties_.avoidance_strategy);
+    if (strategy == AvoidanceStrategy::Disabled) {
+        avoidance_.clear_dynamic_obstacles();
+    }
+    else {
+        avoidance_.load_obstacles_from_shared_memory();
+    }
+
+    PathStatus status = compute_path(pose_current);
+    if (status == PathStatus::Unchanged) {
+        return;
+    }
+    if (status == PathStatus::Blocked) {
+        if (debug_) {
+            COGIP_LOG_DEBUG << "AvoidanceService: no path found" << std::endl;
+        }
+        reset_last_path();
+        blocked_lock_.postUpdate();
+        return;
+    }
+
+    last_pose_current_ = pose_current;
+    has_last_pose_current_ = true;
+
+    // Only one pose means the pose order is reached.
+    if (path_.size() < 2) {
+        return;
+    }
+
+    const models::pose_order_t& next = path_[1];
+    if (has_last_emitted_) {
+        double dist_xy = utils::calculate_distance(last_emitted_.x, last_emitted_.y, next.x, next.y);
+        if (!next.bypass_final_orientation) {
+            double dist_angle = std::fabs(next.angle - last_emitted_.angle);
+            if (dist_xy < min_moved_distance && dist_angle < min_turned_angle) {
+                return;
+            }
+        }
+        else if (dist_xy < min_moved_distance) {
+            return;
+        }
+        if (same_pose_order(last_emitted_, next)) {
+            return;
+        }
+    }
+
+    if (data_->avoidance_has_new_pose_order) {
+        return;
+    }
+
+    // Nothing was published since the last pose order or blocking, the robot must restart toward the path.
+    bool new_path = !has_last_emitted_;
+    last_emitted_ = next;
+    has_last_emitted_ = true;
+
+    if (pose_order_.stop_before_distance > 0.0) {
+        apply_stop_before_distance();
+    }
+
+    avoidance_.write_avoidance_path(path_, new_path);
+    set_reflex_target(path_[1]);
+    if (debug_) {
+        COGIP_LOG_DEBUG << "AvoidanceService: path updated with " << path_.size() - 1 << " poses" << std::endl;
+    }
+}
+
+AvoidanceService::PathStatus AvoidanceService::compute_path(const models::pose_t& pose_current)
+{
+    models::Coords current(pose_current.x, pose_current.y);
+    models::Coords order(pose_order_.x, pose_order_.y);
+    auto strategy = static_cast<AvoidanceStrategy>(properties_.avoidance_strategy);
+
+    if (strategy == AvoidanceStrategy::AvoidanceCpp || strategy == AvoidanceStrategy::AvoidanceGrid) {
+        avoidance_.set_planning_engine(
+            strategy == AvoidanceStrategy::AvoidanceGrid ? PlanningEngine::GRID : PlanningEngine::VISIBILITY_GRAPH
+        );
+
+        // Path is recomputed only if the pose order is reachable
+        // or an obstacle prevents to reach next path pose.
+        bool recompute = refine_path_ || (
+            (!avoidance_.check_recompute(current, order) && properties_.robot_id == 1 &&
+             !(has_last_emitted_ && same_pose_order(last_emitted_, pose_order_))) ||
+            !has_last_emitted_ ||
+            avoidance_.check_recompute(current, models::Coords(last_emitted_.x, last_emitted_.y))
+        );
+        if (!recompute) {
+            return PathStatus::Unchanged;
+        }
+        // The previous path is kept while it is free: no graph to build.
+        // An alternative path is not kept, the best path is computed again on the next cycle.
+        if (!refine_path_ && avoidance_.validate_cached_path(current, path_points_)) {
+            Avoidance::make_path_poses(path_points_, pose_order_, path_);
+            return PathStatus::Found;
+        }
+        if (!refine_path_ && switch_to_alternative_path(current)) {
+            refine_path_ = true;
+            Avoidance::make_path_poses(path_points_, pose_order_, path_);
+            return PathStatus::Found;
+        }
+        refine_path_ = false;
+
+        // Plan within the cycle period, so a fresh path is published on every cycle,
+        // even if it is not the shortest one.
+        double interval = properties_.path_refresh_interval;
+        if (interval <= 0) {
+            interval = default_refresh_interval;
+        }
+        bool optimal = false;
+        if (!avoidance_.compute_path(current, order, interval * planning_budget_ratio, path_points_, optimal)) {
+            return PathStatus::Blocked;
+        }
+        if (debug_ && !optimal) {
+            COGIP_LOG_DEBUG << "AvoidanceService: planning budget spent, using the coarse path" << std::endl;
+        }
+        // The graph is still there: alternatives cost a few searches, no build.
+        size_t alternatives = alternative_count_;
+        if (alternatives > 1) {
+            avoidance_.compute_alternative_paths(alternatives);
+        }
+    }
+    else {
+        if (avoidance_.is_point_in_obstacles(current)) {
+            return PathStatus::Blocked;
+        }
+        if (avoidance_.is_point_in_obstacles(order)) {
+            return PathStatus::Blocked;
+        }
+        if (strategy == AvoidanceStrategy::Disabled || (current.x() == order.x() && current.y() == order.y())) {
+            // Straight line, or rotation only: the avoidance would not find any path
+            path_points_ = { current.x(), current.y(), order.x(), order.y() };
+        }
+        else if (!avoidance_.compute_path(current, order, path_points_) || path_points_.size() > 4) {
+            // Stop and go: wait while an obstacle is on the way
+            return PathStatus::Blocked;
+        }
+    }
+
+    Avoidance::make_path_poses(path_points_, pose_order_, path_);
+    return PathStatus::Found;
+}
+
+bool AvoidanceService::switch_to_alternative_path(const models::Coords& current)
+{
+    // The obstacles may not show the lidar points which blocked the path yet: check the first segment against them.
+    bool check_lidar = reflex_enabled_;
+    double clearance = reflex_clearance();
+    while (avoidance_.use_alternative_path(current, path_points_)) {
+        if (!check_lidar || !shared_memory_.isLidarCoordsNearSegment(
+                path_points_[0], path_points_[1], path_points_[2], path_points_[3], clearance)) {
+            if (debug_) {
+                COGIP_LOG_DEBUG << "AvoidanceService: switched to an alternative path with "
+                                << path_points_.size() / 2 << " points" << std::endl;
+            }
+            return true;
+        }
+    }
+    avoidance_.clear_cached_path();
+    return false;
+}
+
+void AvoidanceService::apply_stop_before_distance()
+{
+    const double distance = pose_order_.stop_before_distance;
+    const models::pose_order_t start = path_[0];
+
+    auto stop_pose = [&](double x, double y) {
+        models::pose_order_t pose{};
+        pose.x = x;
+        pose.y = y;
+        pose.angle = RAD2DEG(std::atan2(pose_order_.y - y, pose_order_.x - x));
+        if (pose_order_.motion_direction == models::MotionDirection::backward_only) {
+            pose.angle += 180;
+        }
+        pose.max_speed_linear = pose_order_.max_speed_linear;
+        pose.max_speed_angular = pose_order_.max_speed_angular;
+        pose.motion_direction = pose_order_.motion_direction;
+        pose.bypass_final_orientation = pose_order_.bypass_final_orientation;
+        pose.timeout_ms = pose_order_.timeout_ms;
+        return pose;
+    };
+
+    // Already within stop distance: stay in place but turn toward the target.
+    if (utils::calculate_distance(start.x, start.y, pose_order_.x, pose_order_.y) <= distance) {
+        path_.resize(1);
+        path_.push_back(stop_pose(start.x, start.y));
+        return;
+    }
+
+    // Otherwise, stop where the path enters the circle of radius distance around the target.
+    for (size_t i = 1; i < path_.size(); i++) {
+        const models::pose_order_t& p1 = path_[i - 1];
+        const models::pose_order_t& p2 = path_[i];
+        if (utils::calculate_distance(p2.x, p2.y, pose_order_.x, pose_order_.y) > distance) {
+            continue;
+        }
+
+        // Solve |p1 + t * (p2 - p1) - target| = distance
+        double ax = p1.x - pose_order_.x;
+        double ay = p1.y - pose_order_.y;
+        double bx = p2.x - p1.x;
+        double by = p2.y - p1.y;
+        double a = bx * bx + by * by;
+        double b = 2 * (ax * bx + ay * by);
+        double c = ax * ax + ay * ay - distance * distance;
+        double delta = b * b - 4 * a * c;
+        if (delta < 0 || a == 0) {
+            continue;
+        }
+        double t = std::clamp((-b - std::sqrt(delta)) / (2 * a), 0.0, 1.0);
+
+        models::pose_order_t pose = stop_pose(p1.x + t * bx, p1.y + t * by);
+        path_.resize(i);
+        path_.push_back(pose);
+        return;
+    }
+}
+
+} // namespace avoidance
+
+} // namespace cogip
@@ -0,0 +1,153 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Project includes
+#include "avoidance/ClearanceField.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// Distance of cells with no occupied cell in their column, larger than any table in cells,
+/// small enough for its square to stay finite.
+constexpr double far_distance = 1e6;
+
+void ClearanceField::set_cell_size(double cell_size)
+{
+    if (cell_size <= 0) {
+        throw std::invalid_argument("ClearanceField: cell size must be positive");
+    }
+    cell_size_ = cell_size;
+    built_ = false;
+}
+
+void ClearanceField::build(const ObstacleSet& obstacles, double x_min, double x_max, double y_min, double y_max)
+{
+    x_min_ = x_min;
+    y_min_ = y_min;
+    cols_ = std::max(1, static_cast<int>(std::ceil((x_max - x_min) / cell_size_)));
+    rows_ = std::max(1, static_cast<int>(std::ceil((y_max - y_min) / cell_size_)));
+    const size_t cols = cols_;
+    const size_t cell_count = cols * rows_;
+    occupied_.assign(cell_count, 0);
+
+    // Only cells within the circumscribed circle of an obstacle are tested.
+    for (size_t k = 0; k < obstacles.size(); k++) {
+        double radius = obstacles.radius(k);
+        int x0 = std::max(0, static_cast<int>(std::floor((obstacles.center_x(k) - radius - x_min_) / cell_size_)));
+        int x1 = std::min(cols_ - 1, static_cast<int>(std::floor((obstacles.center_x(k) + radius - x_min_) / cell_size_)));
+        int y0 = std::max(0, static_cast<int>(std::floor((obstacles.center_y(k) - radius - y_min_) / cell_size_)));
+        int y1 = std::min(rows_ - 1, static_cast<int>(std::floor((obstacles.center_y(k) + radius - y_min_) / cell_size_)));
+        for (int cy = y0; cy <= y1; cy++) {
+            double y = y_min_ + (cy + 0.5) * cell_size_;
+            for (int cx = x0; cx <= x1; cx++) {
+                uint8_t& cell = occupied_[cy * cols + cx];
+                if (!cell && obstacles.is_point_inside(k, x_min_ + (cx + 0.5) * cell_size_, y)) {
+                    cell = 1;
+                }
+            }
+        }
+    }
+
+    // First pass: distance along each column, scanning whole rows down then up.
+    column_.resize(cell_count);
+    for (size_t x = 0; x < cols; x++) {
+        column_[x] = occupied_[x] ? 0.0 : far_distance;
+    }
+    for (int y = 1; y < rows_; y++) {
+        const uint8_t* occupied = &occupied_[y * cols];
+        const double* previous = &column_[(y - 1) * cols];
+        double* current = &column_[y * cols];
+        for (size_t x = 0; x < cols; x++) {
+            current[x] = occupied[x] ? 0.0 : std::min(previous[x] + 1.0, far_distance);
+        }
+    }
+    for (int y = rows_ - 2; y >= 0; y--) {
+        const double* next = &column_[(y + 1) * cols];
+        double* current = &column_[y * cols];
+        for (size_t x = 0; x < cols; x++) {
+            current[x] = std::min(current[x], next[x] + 1.0);
+        }
+    }
+
+    // Second pass: along each row, lower envelope of the parabolas (x - q)^2 + column(q)^2.
+    distances_.resize(cell_count);
+    row_.resize(cols);
+    envelope_.resize(cols);
+    bounds_.resize(cols + 1);
+    for (int y = 0; y < rows_; y++) {
+        const double* column = &column_[y * cols];
+        for (size_t x = 0; x < cols; x++) {
+            row_[x] = column[x] * column[x];
+        }
+
+        int k = 0;
+        envelope_[0] = 0;
+        bounds_[0] = -std::numeric_limits<double>::infinity();
+        bounds_[1] = std::numeric_limits<double>::infinity();
+        for (int q = 1; q < cols_; q++) {
+            // Drop the parabolas hidden by the new one; the first bound is -inf so k stays >= 0.
+            double s;
+            while (true) {
+                int v = envelope_[k];
+                s = ((row_[q] + q * q) - (row_[v] + v * v)) / (2.0 * (q - v));
+                if (s > bounds_[k]) {
+                    break;
+                }
+                k--;
+            }
+            k++;
+            envelope_[k] = q;
+            bounds_[k] = s;
+            bounds_[k + 1] = std::numeric_limits<double>::infinity();
+        }
+
+        float* distances = &distances_[y * cols];
+        k = 0;
+        for (int x = 0; x < cols_; x++) {
+            while (bounds_[k + 1] < x) {
+                k++;
+            }
+            int v = envelope_[k];
+            double dx = x - v;
+            distances[x] = static_cast<float>(std::sqrt(dx * dx + row_[v]) * cell_size_);
+        }
+    }
+    built_ = true;
+}
+
+double ClearanceField::distance(const models::Vec2& p) const
+{
+    double fx = std::floor((p.x - x_min_) / cell_size_);
+    double fy = std::floor((p.y - y_min_) / cell_size_);
+    if (!built_ || !(fx >= 0 && fx < cols_ && fy >= 0 && fy < rows_)) {
+        return 0;
+    }
+    return distances_[static_cast<size_t>(fy) * cols_ + static_cast<size_t>(fx)];
+}
+
+double ClearanceField::penalty(const models::Vec2& a, const models::Vec2& b, double clearance) const
+{
+    const double length = a.distance(b);
+    const size_t count = std::max<size_t>(1, static_cast<size_t>(std::ceil(length / cell_size_)));
+    const double step = length / count;
+    const models::Vec2 delta = (b - a) * (1.0 / count);
+    double total = 0;
+    for (size_t i = 0; i < count; i++) {
+        double d = distance(a + delta * (i + 0.5));
+        total += std::max(0.0, 1.0 - d / clearance);
+    }
+    return total * step;
+}
+
+} // namespace avoidance
+
+} // namespace cogip
@@ -0,0 +1,370 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+// Project includes
+#include "avoidance/Avoidance.hpp"
+#include "avoidance/GoapPlanner.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// Number of nodes of a level handed out at once to a worker.
+constexpr size_t expansion_chunk = 16;
+
+/// Marks an empty slot of the transposition tables.
+constexpr uint32_t empty_slot = std::numeric_limits<uint32_t>::max();
+
+uint64_t GoapPlanner::state_hash(const Node& node)
+{
+    uint64_t hash = node.done * 0x9e3779b97f4a7c15ull;
+    hash ^= node.world + 0x632be59bd9b4e019ull + (hash << 6) + (hash >> 2);
+    hash ^= (static_cast<uint64_t>(node.first) << 16 | node.position) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    return hash * 0xff51afd7ed558ccdull;
+}
+
+GoapPlanner::GoapPlanner(size_t workers):
+    points_(1),
+    action_points_(1, 1),
+    shard_nodes_(shard_count),
+    shard_tables_(shard_count)
+{
+    set_worker_count(workers);
+}
+
+size_t GoapPlanner::add_action(const GoapAction& action)
+{
+    if (actions_.size() >= max_actions) {
+        throw std::invalid_argument("GoapPlanner: too many actions");
+    }
+    if (points_.size() + action.poses.size() > std::numeric_limits<uint16_t>::max()) {
+        throw std::invalid_argument("GoapPlanner: too many action poses");
+    }
+    actions_.push_back(action);
+    points_.insert(points_.end(), action.poses.begin(), action.poses.end());
+    action_points_.push_back(points_.size());
+    costs_.clear();
+    return actions_.size() - 1;
+}
+
+void GoapPlanner::clear_actions()
+{
+    actions_.clear();
+    points_.resize(1);
+    action_points_.assign(1, 1);
+    costs_.clear();
+}
+
+void GoapPlanner::set_start(const models::Vec2& start)
+{
+    points_[0] = start;
+    costs_.clear();
+}
+
+void GoapPlanner::compute_costs(Avoidance& avoidance)
+{
+    avoidance.compute_path_costs(points_, points_, costs_);
+    size_t count = points_.size();
+    for (size_t from = 0; from < count; from++) {
+        for (size_t to = 0; to < count; to++) {
+            double& cost = costs_[from * count + to];
+            if (!std::isfinite(cost)) {
+                cost = points_[from].distance(points_[to]);
+            }
+        }
+    }
+}
+
+void GoapPlanner::set_average_speed(double speed)
+{
+    if (!(speed > 0)) {
+        throw std::invalid_argument("GoapPlanner: average speed must be positive");
+    }
+    average_speed_ = speed;
+}
+
+void GoapPlanner::set_worker_count(size_t count)
+{
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (count == worker_count()) {
+        return;
+    }
+    worker_pool_.reset();
+    if (count > 1) {
+        worker_pool_ = std::make_unique<WorkerPool>(count);
+    }
+}
+
+double GoapPlanner::cost(size_t from, size_t to) const
+{
+    if (costs_.empty()) {
+        return points_[from].distance(points_[to]);
+    }
+    return costs_[from * points_.size() + to];
+}
+
+uint16_t GoapPlanner::end_position(size_t action, uint16_t position) const
+{
+    if (action_points_[action] == action_points_[action + 1]) {
+        return position;
+    }
+    return static_cast<uint16_t>(action_points_[action + 1] - 1);
+}
+
+void GoapPlanner::prepare_times()
+{
+    size_t action_count = actions_.size();
+    entry_costs_.assign(points_.size() * action_count, 0.0);
+    action_times_.assign(action_count, 0.0);
+    for (size_t action = 0; action < action_count; action++) {
+        size_t begin = action_points_[action];
+        size_t end = action_points_[action + 1];
+        double time = actions_[action].duration;
+        for (size_t point = begin + 1; point < end; point++) {
+            time += cost(point - 1, point) / average_speed_;
+        }
+        action_times_[action] = time;
+        if (begin == end) {
+            continue;
+        }
+        for (size_t position = 0; position < points_.size(); position++) {
+            entry_costs_[position * action_count + action] = cost(position, begin) / average_speed_;
+        }
+    }
+}
+
+void GoapPlanner::expand(const Node& node, uint32_t index, size_t worker, size_t depth, double countdown, bool last)
+{
+    // As in the Python evaluation, no action starts once the countdown is over.
+    if (node.time >= countdown) {
+        return;
+    }
+
+    std::vector<Node>* children = &worker_children_[worker * shard_count];
+    size_t action_count = actions_.size();
+    for (size_t action = 0; action < action_count; action++) {
+        uint64_t bit = uint64_t(1) << action;
+        const GoapAction& description = actions_[action];
+        if ((node.done & bit) || (node.world & description.required) != description.required) {
+            continue;
+        }
+        if (depth == 1 && !description.first_allowed) {
+            continue;
+        }
+
+        Node child;
+        child.done = node.done | bit;
+        child.world = (node.world & ~description.clears) | description.sets;
+        child.time = node.time + entry_costs_[node.position * action_count + action] + action_times_[action];
+        child.reward = node.reward + description.reward;
+        child.parent = index;
+        child.action = static_cast<uint16_t>(action);
+        child.position = end_position(action, node.position);
+        child.first = depth == 1 ? child.action : node.first;
+        if (last) {
+            if (better_plan(child, worker_best_[worker])) {
+                worker_best_[worker] = child;
+            }
+            continue;
+        }
+        children[state_hash(child) >> (64 - shard_bits)].push_back(child);
+    }
+}
+
+void GoapPlanner::merge_shard(size_t shard)
+{
+    std::vector<Node>& nodes = shard_nodes_[shard];
+    std::vector<uint32_t>& table = shard_tables_[shard];
+    nodes.clear();
+
+    size_t count = 0;
+    for (size_t worker = 0; worker < worker_children_.size() / shard_count; worker++) {
+        count += worker_children_[worker * shard_count + shard].size();
+    }
+    size_t capacity = 16;
+    while (capacity < 2 * count) {
+        capacity *= 2;
+    }
+    table.assign(capacity, empty_slot);
+
+    for (size_t worker = 0; worker < worker_children_.size() / shard_count; worker++) {
+        for (const Node& child : worker_children_[worker * shard_count + shard]) {
+            size_t slot = static_cast<size_t>(state_hash(child)) & (capacity - 1);
+            while (table[slot] != empty_slot && !same_state(nodes[table[slot]], child)) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            if (table[slot] == empty_slot) {
+                table[slot] = static_cast<uint32_t>(nodes.size());
+                nodes.push_back(child);
+            }
+            else if (child.time < nodes[table[slot]].time) {
+                nodes[table[slot]] = child;
+            }
+        }
+    }
+}
+
+bool GoapPlanner::better_plan(const Node& a, const Node& b) const
+{
+    if (a.reward != b.reward) {
+        return a.reward > b.reward;
+    }
+    double weight_a = actions_[a.first].weight;
+    double weight_b = actions_[b.first].weight;
+    if (weight_a != weight_b) {
+        return weight_a > weight_b;
+    }
+    if (a.time != b.time) {
+        return a.time < b.time;
+    }
+    return a.first < b.first;
+}
+
+GoapPlan GoapPlanner::search(uint64_t world, double countdown, size_t depth, double budget)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(budget, 0.0))
+    );
+
+    GoapPlan plan;
+    prepare_times();
+    depth = std::min(depth, actions_.size());
+    size_t workers = worker_count();
+    worker_children_.resize(workers * shard_count);
+    worker_best_.resize(workers);
+
+    Node root{};
+    root.world = world;
+    levels_.assign(1, std::vector<Node>{ root });
+
+    bool has_best = false;
+    size_t best_level = 0;  // The best node is the first node of its level.
+    std::atomic<bool> expired{false};
+    std::atomic<size_t> expanded{0};
+    plan.complete = true;
+
+    for (size_t level = 1; level <= depth; level++) {
+        const std::vector<Node>& frontier = levels_[level - 1];
+        bool last = level == depth;
+        for (auto& children : worker_children_) {
+            children.clear();
+        }
+        for (Node& best : worker_best_) {
+            best = Node{};
+            best.reward = -std::numeric_limits<double>::infinity();
+        }
+
+        auto task = [&](size_t worker, size_t begin, size_t end) {
+            size_t count = 0;
+            for (size_t index = begin; index < end; index++) {
+                if (budget > 0 && std::chrono::steady_clock::now() > deadline) {
+                    expired = true;
+                    break;
+                }
+                expand(frontier[index], static_cast<uint32_t>(index), worker, level, countdown, last);
+                count++;
+            }
+            expanded += count;
+        };
+        if (worker_pool_) {
+            worker_pool_->parallel_for(frontier.size(), expansion_chunk, task);
+        }
+        else {
+            task(0, 0, frontier.size());
+        }
+
+        // A level expanded partially is dropped, the plan comes from the complete levels.
+        if (expired) {
+            plan.complete = false;
+            break;
+        }
+
+        std::vector<Node> nodes;
+        if (last) {
+            for (const Node& best : worker_best_) {
+                if (std::isfinite(best.reward) && (nodes.empty() || better_plan(best, nodes[0]))) {
+                    nodes.assign(1, best);
+                }
+            }
+        }
+        else {
+            auto merge = [&](size_t, size_t begin, size_t end) {
+                for (size_t shard = begin; shard < end; shard++) {
+                    merge_shard(shard);
+                }
+            };
+            if (worker_pool_) {
+                worker_pool_->parallel_for(shard_count, 1, merge);
+            }
+            else {
+                merge(0, 0, shard_count);
+            }
+            size_t count = 0;
+            for (const auto& shard_nodes : shard_nodes_) {
+                count += shard_nodes.size();
+            }
+            nodes.reserve(count);
+            for (const auto& shard_nodes : shard_nodes_) {
+                nodes.insert(nodes.end(), shard_nodes.begin(), shard_nodes.end());
+            }
+        }
+
+        // The best node of the level is kept first, so the beam never drops it.
+        size_t level_best = 0;
+        for (size_t index = 1; index < nodes.size(); index++) {
+            if (better_plan(nodes[index], nodes[level_best])) {
+                level_best = index;
+            }
+        }
+        if (!nodes.empty()) {
+            std::swap(nodes[0], nodes[level_best]);
+            if (!has_best || better_plan(nodes[0], levels_[best_level][0])) {
+                has_best = true;
+                best_level = level;
+            }
+        }
+        if (beam_width_ > 0 && nodes.size() > beam_width_) {
+            std::nth_element(nodes.begin() + 1, nodes.begin() + beam_width_, nodes.end(), [](const Node& a, const Node& b) {
+                return a.reward != b.reward ? a.reward > b.reward : a.time < b.time;
+            });
+            nodes.resize(beam_width_);
+        }
+        levels_.push_back(std::move(nodes));
+
+        plan.depth = level;
+        if (levels_.back().empty()) {
+            break;
+        }
+    }
+
+    plan.expanded_nodes = expanded;
+    if (has_best) {
+        const Node* node = &levels_[best_level][0];
+        plan.reward = node->reward;
+        plan.time = node->time;
+        plan.actions.resize(best_level);
+        for (size_t level = best_level; level > 0; level--) {
+            plan.actions[level - 1] = node->action;
+            node = &levels_[level - 1][node->parent];
+        }
+    }
+    return plan;
+}
+
+} // namespace avoidance
+
+} // namespace cogip
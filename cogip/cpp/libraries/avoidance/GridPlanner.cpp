@@ -0,0 +1,238 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+// Project includes
+#include "avoidance/GridPlanner.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// Marks parents of cells not reached yet.
+constexpr uint32_t no_parent = std::numeric_limits<uint32_t>::max();
+
+void GridPlanner::set_cell_size(double cell_size)
+{
+    if (cell_size <= 0) {
+        throw std::invalid_argument("GridPlanner: cell size must be positive");
+    }
+    cell_size_ = cell_size;
+    built_ = false;
+}
+
+void GridPlanner::build(const ObstacleSet& obstacles, double x_min, double x_max, double y_min, double y_max)
+{
+    x_min_ = x_min;
+    y_min_ = y_min;
+    cols_ = std::max(1, static_cast<int>(std::ceil((x_max - x_min) / cell_size_)));
+    rows_ = std::max(1, static_cast<int>(std::ceil((y_max - y_min) / cell_size_)));
+    const size_t cell_count = static_cast<size_t>(cols_) * rows_;
+    raster_.assign((cell_count + 63) / 64, 0);
+
+    // The last column and row may extend beyond the limits.
+    for (int cy = 0; cy < rows_; cy++) {
+        for (int cx = 0; cx < cols_; cx++) {
+            double x = x_min_ + (cx + 0.5) * cell_size_;
+            double y = y_min_ + (cy + 0.5) * cell_size_;
+            if (x >= x_max || y >= y_max) {
+                block(cx, cy);
+            }
+        }
+    }
+
+    // Only cells within the circumscribed circle of an obstacle are tested.
+    for (size_t k = 0; k < obstacles.size(); k++) {
+        double radius = obstacles.radius(k);
+        int x0 = std::max(0, static_cast<int>(std::floor((obstacles.center_x(k) - radius - x_min_) / cell_size_)));
+        int x1 = std::min(cols_ - 1, static_cast<int>(std::floor((obstacles.center_x(k) + radius - x_min_) / cell_size_)));
+        int y0 = std::max(0, static_cast<int>(std::floor((obstacles.center_y(k) - radius - y_min_) / cell_size_)));
+        int y1 = std::min(rows_ - 1, static_cast<int>(std::floor((obstacles.center_y(k) + radius - y_min_) / cell_size_)));
+        for (int cy = y0; cy <= y1; cy++) {
+            double y = y_min_ + (cy + 0.5) * cell_size_;
+            for (int cx = x0; cx <= x1; cx++) {
+                if (!is_blocked(cx, cy) && obstacles.is_point_inside(k, x_min_ + (cx + 0.5) * cell_size_, y)) {
+                    block(cx, cy);
+                }
+            }
+        }
+    }
+    built_ = true;
+}
+
+bool GridPlanner::is_free(int cx, int cy) const
+{
+    if (cx < 0 || cx >= cols_ || cy < 0 || cy >= rows_) {
+        return false;
+    }
+    uint32_t cell = static_cast<uint32_t>(cy) * cols_ + cx;
+    return cell == start_cell_ || cell == finish_cell_ || !is_blocked(cx, cy);
+}
+
+models::Vec2 GridPlanner::point(uint32_t cell) const
+{
+    if (cell == start_cell_) {
+        return start_;
+    }
+    if (cell == finish_cell_) {
+        return finish_;
+    }
+    return models::Vec2(x_min_ + (cell % cols_ + 0.5) * cell_size_, y_min_ + (cell / cols_ + 0.5) * cell_size_);
+}
+
+bool GridPlanner::line_of_sight(uint32_t from, uint32_t to) const
+{
+    int x0 = from % cols_;
+    int y0 = from / cols_;
+    const int x1 = to % cols_;
+    const int y1 = to / cols_;
+    const int dx = std::abs(x1 - x0);
+    const int dy = -std::abs(y1 - y0);
+    const int sx = (x0 < x1) ? 1 : -1;
+    const int sy = (y0 < y1) ? 1 : -1;
+    int error = dx + dy;
+    while (x0 != x1 || y0 != y1) {
+        int e2 = 2 * error;
+        bool step_x = (e2 >= dy);
+        bool step_y = (e2 <= dx);
+        if (step_x && step_y && (!is_free(x0 + sx, y0) || !is_free(x0, y0 + sy))) {
+            return false;
+        }
+        if (step_x) {
+            error += dy;
+            x0 += sx;
+        }
+        if (step_y) {
+            error += dx;
+            y0 += sy;
+        }
+        if (!is_free(x0, y0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GridPlanner::set_vertex(uint32_t cell)
+{
+    uint32_t parent = parents_[cell];
+    if (parent == cell || line_of_sight(parent, cell)) {
+        return;
+    }
+
+    // Line of sight was assumed when the cell was reached: fall back to the best expanded neighbor.
+    const int cx = cell % cols_;
+    const int cy = cell / cols_;
+    const models::Vec2 p = point(cell);
+    g_[cell] = std::numeric_limits<double>::infinity();
+    for (int ny = cy - 1; ny <= cy + 1; ny++) {
+        for (int nx = cx - 1; nx <= cx + 1; nx++) {
+            if (!is_free(nx, ny)) {
+                continue;
+            }
+            uint32_t neighbor = static_cast<uint32_t>(ny) * cols_ + nx;
+            if (neighbor == cell || !closed_[neighbor]) {
+                continue;
+            }
+            double g = g_[neighbor] + point(neighbor).distance(p);
+            if (g < g_[cell]) {
+                g_[cell] = g;
+                parents_[cell] = neighbor;
+            }
+        }
+    }
+}
+
+bool GridPlanner::find_path(const models::Vec2& start, const models::Vec2& finish, std::vector<models::Vec2>& path)
+{
+    path.clear();
+    if (!built_ || cols_ == 0) {
+        return false;
+    }
+
+    auto cell_of = [this](const models::Vec2& p) {
+        int cx = std::clamp(static_cast<int>(std::floor((p.x - x_min_) / cell_size_)), 0, cols_ - 1);
+        int cy = std::clamp(static_cast<int>(std::floor((p.y - y_min_) / cell_size_)), 0, rows_ - 1);
+        return static_cast<uint32_t>(cy) * cols_ + cx;
+    };
+    start_ = start;
+    finish_ = finish;
+    start_cell_ = cell_of(start);
+    finish_cell_ = cell_of(finish);
+    if (start_cell_ == finish_cell_) {
+        path.push_back(start);
+        path.push_back(finish);
+        return true;
+    }
+
+    const size_t cell_count = static_cast<size_t>(cols_) * rows_;
+    g_.assign(cell_count, std::numeric_limits<double>::infinity());
+    parents_.assign(cell_count, no_parent);
+    closed_.assign(cell_count, false);
+    open_set_.reset(cell_count);
+
+    g_[start_cell_] = 0;
+    parents_[start_cell_] = start_cell_;
+    open_set_.push(start_cell_, start_.distance(finish_));
+
+    bool found = false;
+    while (!open_set_.empty()) {
+        uint32_t cell = open_set_.pop();
+        set_vertex(cell);
+        if (cell == finish_cell_) {
+            found = true;
+            break;
+        }
+        closed_[cell] = true;
+
+        // Lazy Theta*: neighbors are linked to the parent of the cell, line of sight is checked at expansion.
+        const uint32_t parent = parents_[cell];
+        const models::Vec2 parent_point = point(parent);
+        const int cx = cell % cols_;
+        const int cy = cell / cols_;
+        for (int ny = cy - 1; ny <= cy + 1; ny++) {
+            for (int nx = cx - 1; nx <= cx + 1; nx++) {
+                if (!is_free(nx, ny)) {
+                    continue;
+                }
+                // Diagonal moves must not cut a blocked corner.
+                if (nx != cx && ny != cy && (!is_free(nx, cy) || !is_free(cx, ny))) {
+                    continue;
+                }
+                uint32_t neighbor = static_cast<uint32_t>(ny) * cols_ + nx;
+                if (closed_[neighbor]) {
+                    continue;
+                }
+                const models::Vec2 p = point(neighbor);
+                double g = g_[parent] + parent_point.distance(p);
+                if (g < g_[neighbor]) {
+                    g_[neighbor] = g;
+                    parents_[neighbor] = parent;
+                    open_set_.push(neighbor, g + p.distance(finish_));
+                }
+            }
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    for (uint32_t cell = finish_cell_; cell != start_cell_; cell = parents_[cell]) {
+        path.push_back(point(cell));
+    }
+    path.push_back(start_);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+} // namespace avoidance
+
+} // namespace cogip
@@ -0,0 +1,83 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+
+// Project includes
+#include "avoidance/ObstacleGrid.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// Padding added around obstacle circles to absorb rounding in the cell traversal.
+constexpr double grid_padding = 1.0;
+
+void ObstacleGrid::build(const ObstacleSet& obstacles)
+{
+    cols_ = 0;
+    rows_ = 0;
+    ranges_.resize(obstacles.size());
+    if (obstacles.size() == 0) {
+        return;
+    }
+
+    // Grid bounds are the union of the obstacle bounding squares.
+    x_min_ = y_min_ = INFINITY;
+    x_max_ = y_max_ = -INFINITY;
+    for (size_t k = 0; k < obstacles.size(); k++) {
+        double radius = obstacles.radius(k) + grid_padding;
+        x_min_ = std::min(x_min_, obstacles.center_x(k) - radius);
+        x_max_ = std::max(x_max_, obstacles.center_x(k) + radius);
+        y_min_ = std::min(y_min_, obstacles.center_y(k) - radius);
+        y_max_ = std::max(y_max_, obstacles.center_y(k) + radius);
+    }
+
+    // About two cells per obstacle along each axis of the larger side.
+    double extent = std::max(x_max_ - x_min_, y_max_ - y_min_);
+    int cells = std::clamp(static_cast<int>(2 * std::ceil(std::sqrt(obstacles.size()))), 1, max_cells_per_axis);
+    double cell_size = extent / cells;
+    inv_cell_size_ = 1.0 / cell_size;
+    cols_ = std::clamp(static_cast<int>(std::ceil((x_max_ - x_min_) * inv_cell_size_)), 1, max_cells_per_axis);
+    rows_ = std::clamp(static_cast<int>(std::ceil((y_max_ - y_min_) * inv_cell_size_)), 1, max_cells_per_axis);
+
+    // Count items per cell, shifted by one so the prefix sum gives the offsets.
+    size_t cell_count = static_cast<size_t>(cols_) * rows_;
+    cell_offsets_.assign(cell_count + 1, 0);
+    for (size_t k = 0; k < obstacles.size(); k++) {
+        double radius = obstacles.radius(k) + grid_padding;
+        CellRange& range = ranges_[k];
+        range.x0 = clamp_cell((obstacles.center_x(k) - radius - x_min_) * inv_cell_size_, cols_);
+        range.x1 = clamp_cell((obstacles.center_x(k) + radius - x_min_) * inv_cell_size_, cols_);
+        range.y0 = clamp_cell((obstacles.center_y(k) - radius - y_min_) * inv_cell_size_, rows_);
+        range.y1 = clamp_cell((obstacles.center_y(k) + radius - y_min_) * inv_cell_size_, rows_);
+        for (int y = range.y0; y <= range.y1; y++) {
+            for (int x = range.x0; x <= range.x1; x++) {
+                cell_offsets_[static_cast<size_t>(y) * cols_ + x + 1]++;
+            }
+        }
+    }
+    for (size_t cell = 0; cell < cell_count; cell++) {
+        cell_offsets_[cell + 1] += cell_offsets_[cell];
+    }
+
+    // Scatter obstacle indices in increasing order, so each cell lists them sorted.
+    cell_items_.resize(cell_offsets_[cell_count]);
+    cell_cursors_.assign(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for (size_t k = 0; k < obstacles.size(); k++) {
+        const CellRange& range = ranges_[k];
+        for (int y = range.y0; y <= range.y1; y++) {
+            for (int x = range.x0; x <= range.x1; x++) {
+                cell_items_[cell_cursors_[static_cast<size_t>(y) * cols_ + x]++] = k;
+            }
+        }
+    }
+}
+
+} // namespace avoidance
+
+} // namespace cogip
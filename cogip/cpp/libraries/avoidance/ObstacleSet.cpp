@@ -0,0 +1,645 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+// Project includes
+#include "avoidance/ObstacleSet.hpp"
+#include "obstacles/ObstacleCircle.hpp"
+#include "obstacles/ObstaclePolygon.hpp"
+#include "utils/predicates.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// Largest squared distance whose square root is not above a radius,
+/// so comparing squared distances to it gives the same result as `std::sqrt(d2) <= radius`.
+static double inside_threshold(double radius)
+{
+    if (!(radius >= 0) || std::isinf(radius)) {
+        // Negative radius: no point is inside. NaN and infinity compare as the radius.
+        return radius < 0 ? -1.0 : radius;
+    }
+    double threshold = radius * radius;
+    while (std::sqrt(threshold) > radius) {
+        threshold = std::nextafter(threshold, 0.0);
+    }
+    for (double next = std::nextafter(threshold, INFINITY);
+         !std::isinf(next) && std::sqrt(next) <= radius;
+         next = std::nextafter(threshold, INFINITY)) {
+        threshold = next;
+    }
+    return threshold;
+}
+
+/// Circle test of segment [AB], same as ObstacleCircle::is_segment_crossing().
+/// @param length Length of segment [AB].
+static inline bool is_segment_crossing_circle(
+    double cx, double cy, double radius, double threshold,
+    double ax, double ay, double bx, double by, double length)
+{
+    double abx = bx - ax;
+    double aby = by - ay;
+    double acx = cx - ax;
+    double acy = cy - ay;
+    double bcx = cx - bx;
+    double bcy = cy - by;
+
+    // Bitwise operators keep the test branch-free.
+    bool line_crossing = std::abs(abx * acy - aby * acx) / length < radius;
+    bool a_inside = acx * acx + acy * acy <= threshold;
+    bool b_inside = bcx * bcx + bcy * bcy <= threshold;
+    bool between = (abx * acx + aby * acy >= 0) & ((-abx) * bcx + (-aby) * bcy >= 0);
+    return line_crossing & (a_inside | b_inside | between);
+}
+
+/// Test of segment [AB] against polygon edge [CD] and point C, same as one iteration of
+/// ObstaclePolygon::is_segment_crossing(), without the test on polygon point indices.
+static inline bool is_segment_crossing_edge(
+    double cx, double cy, double dx, double dy,
+    double ax, double ay, double bx, double by)
+{
+    // [AB] crosses [CD], or C is on [AB].
+    return utils::are_segments_crossing(ax, ay, bx, by, cx, cy, dx, dy) ||
+           utils::is_point_on_segment(cx, cy, ax, ay, bx, by);
+}
+
+/// Squared distance from point P to segment [CD].
+static inline double segment_distance_squared(double px, double py, double cx, double cy, double dx, double dy)
+{
+    double cdx = dx - cx;
+    double cdy = dy - cy;
+    double cpx = px - cx;
+    double cpy = py - cy;
+    double length_squared = cdx * cdx + cdy * cdy;
+    double t = length_squared > 0 ? std::clamp((cpx * cdx + cpy * cdy) / length_squared, 0.0, 1.0) : 0.0;
+    double ex = cpx - t * cdx;
+    double ey = cpy - t * cdy;
+    return ex * ex + ey * ey;
+}
+
+/// Polygon points of an obstacle of any maximum number of points, or nullptr if it is not a polygon.
+static models::CoordsList* polygon_points(obstacles::Obstacle& obstacle)
+{
+    if (auto* polygon = dynamic_cast<obstacles::ObstaclePolygon*>(&obstacle)) {
+        return &polygon->points();
+    }
+    if (auto* polygon = dynamic_cast<obstacles::CompactObstaclePolygon*>(&obstacle)) {
+        return &polygon->points();
+    }
+    return nullptr;
+}
+
+/// Checks if an obstacle is a circle of any maximum number of points, and retrieves its velocity.
+static bool is_circle(obstacles::Obstacle& obstacle, double& vx, double& vy)
+{
+    if (auto* circle = dynamic_cast<obstacles::ObstacleCircle*>(&obstacle)) {
+        vx = circle->vx();
+        vy = circle->vy();
+        return true;
+    }
+    if (auto* circle = dynamic_cast<obstacles::CompactObstacleCircle*>(&obstacle)) {
+        vx = circle->vx();
+        vy = circle->vy();
+        return true;
+    }
+    return false;
+}
+
+/// First element of a coordinate list, nullptr if empty.
+static const models::coords_t* list_data(models::CoordsList& list)
+{
+    return list.size() ? list.get_data(0) : nullptr;
+}
+
+ObstacleSet::ObstacleSet()
+{
+    clear();
+}
+
+void ObstacleSet::clear()
+{
+    shapes_.clear();
+    shape_indices_.clear();
+    center_x_.clear();
+    center_y_.clear();
+    radius_.clear();
+    velocity_x_.clear();
+    velocity_y_.clear();
+    bounding_box_offsets_.assign(1, 0);
+    bounding_box_x_.clear();
+    bounding_box_y_.clear();
+    bounding_box_vertices_.clear();
+
+    circle_obstacles_.clear();
+    circle_x_.clear();
+    circle_y_.clear();
+    circle_radius_.clear();
+    circle_threshold_.clear();
+    circle_margin_.clear();
+
+    polygon_obstacles_.clear();
+    polygon_offsets_.assign(1, 0);
+    edge_polygons_.clear();
+    edge_x_.clear();
+    edge_y_.clear();
+    edge_next_x_.clear();
+    edge_next_y_.clear();
+}
+
+void ObstacleSet::set_footprint(double length, double width)
+{
+    footprint_half_length_ = std::max(length, 0.0) / 2;
+    footprint_half_width_ = std::max(width, 0.0) / 2;
+    footprint_radius_ = std::hypot(footprint_half_length_, footprint_half_width_);
+}
+
+void ObstacleSet::build(const std::vector<std::reference_wrapper<obstacles::Obstacle>>& obstacles)
+{
+    clear();
+    for (const auto& obstacle_wrapper : obstacles) {
+        obstacles::Obstacle& obstacle = obstacle_wrapper.get();
+        models::CoordsList& bounding_box = obstacle.bounding_box();
+        if (models::CoordsList* points = polygon_points(obstacle)) {
+            add_polygon(obstacle.center().x(), obstacle.center().y(), obstacle.radius(),
+                        list_data(*points), points->size(),
+                        list_data(bounding_box), bounding_box.size());
+        }
+        else if (double vx, vy; is_circle(obstacle, vx, vy)) {
+            add_circle(obstacle.center().x(), obstacle.center().y(), obstacle.radius(),
+                       obstacle.bounding_box_margin(),
+                       list_data(bounding_box), bounding_box.size(), vx, vy);
+        }
+        else {
+            throw std::invalid_argument("ObstacleSet: unsupported obstacle type");
+        }
+    }
+}
+
+void ObstacleSet::load(const ObstacleSnapshot& snapshot)
+{
+    clear();
+    for (size_t i = 0; i < snapshot.circle_count(); i++) {
+        const ObstacleSnapshot::Record& record = snapshot.circle(i);
+        add_circle(record.center.x, record.center.y, record.radius, record.bounding_box_margin,
+                   snapshot.coords(record.bounding_box_offset), record.bounding_box_count,
+                   record.vx, record.vy);
+    }
+    for (size_t i = 0; i < snapshot.rectangle_count(); i++) {
+        const ObstacleSnapshot::Record& record = snapshot.rectangle(i);
+        add_polygon(record.center.x, record.center.y, record.radius,
+                    snapshot.coords(record.points_offset), record.points_count,
+                    snapshot.coords(record.bounding_box_offset), record.bounding_box_count);
+    }
+}
+
+void ObstacleSet::add_obstacle(Shape shape, uint32_t shape_index, double x, double y, double radius,
+                               const models::coords_t* bounding_box, size_t bounding_box_count)
+{
+    shapes_.push_back(shape);
+    shape_indices_.push_back(shape_index);
+    center_x_.push_back(x);
+    center_y_.push_back(y);
+    radius_.push_back(radius + footprint_radius_);
+    velocity_x_.push_back(0);
+    velocity_y_.push_back(0);
+    for (size_t i = 0; i < bounding_box_count; i++) {
+        bounding_box_x_.push_back(bounding_box[i].x);
+        bounding_box_y_.push_back(bounding_box[i].y);
+        bounding_box_vertices_.push_back(-1);
+    }
+    bounding_box_offsets_.push_back(bounding_box_x_.size());
+}
+
+void ObstacleSet::add_circle(double x, double y, double radius, double bounding_box_margin,
+                             const models::coords_t* bounding_box, size_t bounding_box_count,
+                             double vx, double vy)
+{
+    circle_obstacles_.push_back(shapes_.size());
+    add_obstacle(Shape::Circle, circle_x_.size(), x, y, radius, bounding_box, bounding_box_count);
+    velocity_x_.back() = vx;
+    velocity_y_.back() = vy;
+    circle_x_.push_back(x);
+    circle_y_.push_back(y);
+    circle_radius_.push_back(radius);
+    circle_threshold_.push_back(inside_threshold(radius));
+    circle_margin_.push_back(bounding_box_margin);
+}
+
+void ObstacleSet::add_polygon(double x, double y, double radius,
+                              const models::coords_t* points, size_t points_count,
+                              const models::coords_t* bounding_box, size_t bounding_box_count)
+{
+    const size_t index = shapes_.size();
+    const uint32_t polygon = polygon_obstacles_.size();
+    polygon_obstacles_.push_back(index);
+    add_obstacle(Shape::Polygon, polygon, x, y, radius, bounding_box, bounding_box_count);
+    for (size_t i = 0; i < points_count; i++) {
+        const models::coords_t& next = points[(i + 1) % points_count];
+        edge_polygons_.push_back(polygon);
+        edge_x_.push_back(points[i].x);
+        edge_y_.push_back(points[i].y);
+        edge_next_x_.push_back(next.x);
+        edge_next_y_.push_back(next.y);
+    }
+    polygon_offsets_.push_back(edge_x_.size());
+
+    // Bounding box points equal to polygon points, when the margin is null.
+    for (uint32_t slot = bounding_box_offsets_[index]; slot < bounding_box_offsets_[index + 1]; slot++) {
+        bounding_box_vertices_[slot] = find_polygon_point(polygon, bounding_box_x_[slot], bounding_box_y_[slot]);
+    }
+}
+
+int ObstacleSet::find_polygon_point(size_t polygon, double x, double y) const
+{
+    const uint32_t begin = polygon_offsets_[polygon];
+    for (uint32_t e = begin; e < polygon_offsets_[polygon + 1]; e++) {
+        if (edge_x_[e] == x && edge_y_[e] == y) {
+            return e - begin;
+        }
+    }
+    return -1;
+}
+
+bool ObstacleSet::is_point_inside(size_t index, double x, double y) const
+{
+    if (footprint_radius_ > 0) {
+        return is_footprint_inside(index, x, y);
+    }
+
+    uint32_t shape_index = shape_indices_[index];
+    if (shapes_[index] == Shape::Circle) {
+        double dx = x - circle_x_[shape_index];
+        double dy = y - circle_y_[shape_index];
+        return dx * dx + dy * dy <= circle_threshold_[shape_index];
+    }
+
+    if (!obstacles::is_point_near_circle({center_x_[index], center_y_[index]}, radius_[index], {x, y})) {
+        return false;
+    }
+
+    // Inside a convex polygon if on the left of all its edges.
+    for (uint32_t e = polygon_offsets_[shape_index]; e < polygon_offsets_[shape_index + 1]; e++) {
+        if (utils::orient2d(edge_x_[e], edge_y_[e], edge_next_x_[e], edge_next_y_[e], x, y) <= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ObstacleSet::is_segment_near(size_t index, double ax, double ay, double bx, double by) const
+{
+    return obstacles::is_segment_near_circle({center_x_[index], center_y_[index]}, radius_[index], {ax, ay}, {bx, by});
+}
+
+bool ObstacleSet::is_segment_crossing(size_t index, double ax, double ay, double bx, double by) const
+{
+    if (!is_segment_near(index, ax, ay, bx, by)) {
+        return false;
+    }
+    if (footprint_radius_ > 0) {
+        return is_footprint_crossing(index, ax, ay, bx, by);
+    }
+
+    uint32_t shape_index = shape_indices_[index];
+    if (shapes_[index] == Shape::Circle) {
+        return is_segment_crossing_circle(
+            circle_x_[shape_index], circle_y_[shape_index],
+            circle_radius_[shape_index], circle_threshold_[shape_index],
+            ax, ay, bx, by, std::hypot(bx - ax, by - ay)
+        );
+    }
+    return is_segment_crossing_polygon(
+        shape_index, ax, ay, bx, by,
+        find_polygon_point(shape_index, ax, ay), find_polygon_point(shape_index, bx, by)
+    );
+}
+
+bool ObstacleSet::is_segment_crossing(size_t index, double ax, double ay, double bx, double by,
+                                      uint32_t slot_a, uint32_t slot_b) const
+{
+    // Bounding box points are away from the obstacles with a footprint, slots are not needed.
+    if (shapes_[index] == Shape::Circle || footprint_radius_ > 0) {
+        return is_segment_crossing(index, ax, ay, bx, by);
+    }
+    if (!is_segment_near(index, ax, ay, bx, by)) {
+        return false;
+    }
+
+    // Polygon point matching a bounding box point, known for the points of this obstacle only.
+    const uint32_t shape_index = shape_indices_[index];
+    auto polygon_point = [&](uint32_t slot, double x, double y) {
+        if (slot == no_slot) {
+            return find_polygon_point(shape_index, x, y);
+        }
+        if (slot < bounding_box_offsets_[index] || slot >= bounding_box_offsets_[index + 1]) {
+            return -1;
+        }
+        return static_cast<int>(bounding_box_vertices_[slot]);
+    };
+    return is_segment_crossing_polygon(
+        shape_index, ax, ay, bx, by, polygon_point(slot_a, ax, ay), polygon_point(slot_b, bx, by)
+    );
+}
+
+bool ObstacleSet::is_segment_crossing_polygon(size_t polygon, double ax, double ay, double bx, double by,
+                                              int index_a, int index_b) const
+{
+    const uint32_t begin = polygon_offsets_[polygon];
+    const uint32_t end = polygon_offsets_[polygon + 1];
+    if (begin == end) {
+        return false;
+    }
+
+    // A segment between two polygon points that are not consecutive in the list crosses the polygon.
+    if (index_a >= 0 && index_b >= 0 && std::abs(index_a - index_b) != 1) {
+        return true;
+    }
+
+    double hit[batch_size];
+    for (uint32_t first = begin; first < end; first += batch_size) {
+        const size_t count = std::min<size_t>(batch_size, end - first);
+        const double* cx = &edge_x_[first];
+        const double* cy = &edge_y_[first];
+        const double* dx = &edge_next_x_[first];
+        const double* dy = &edge_next_y_[first];
+        for (size_t i = 0; i < count; i++) {
+            hit[i] = is_segment_crossing_edge(cx[i], cy[i], dx[i], dy[i], ax, ay, bx, by) ? 1.0 : 0.0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (hit[i] != 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool ObstacleSet::is_footprint_inside(size_t index, double x, double y) const
+{
+    if (!obstacles::is_point_near_circle({center_x_[index], center_y_[index]}, radius_[index], {x, y})) {
+        return false;
+    }
+
+    uint32_t shape_index = shape_indices_[index];
+    if (shapes_[index] == Shape::Circle) {
+        double dx = x - circle_x_[shape_index];
+        double dy = y - circle_y_[shape_index];
+        double clearance = circle_radius_[shape_index] + footprint_radius_;
+        return dx * dx + dy * dy <= clearance * clearance;
+    }
+
+    // Inside the polygon, or closer to one of its edges than the rotation radius.
+    const uint32_t begin = polygon_offsets_[shape_index];
+    const uint32_t end = polygon_offsets_[shape_index + 1];
+    if (begin == end) {
+        return false;
+    }
+    bool inside = true;
+    double distance_squared = std::numeric_limits<double>::max();
+    for (uint32_t e = begin; e < end; e++) {
+        inside = inside && utils::orient2d(edge_x_[e], edge_y_[e], edge_next_x_[e], edge_next_y_[e], x, y) > 0;
+        distance_squared = std::min(
+            distance_squared,
+            segment_distance_squared(x, y, edge_x_[e], edge_y_[e], edge_next_x_[e], edge_next_y_[e])
+        );
+    }
+    return inside || distance_squared < footprint_radius_ * footprint_radius_;
+}
+
+bool ObstacleSet::is_footprint_crossing(size_t index, double ax, double ay, double bx, double by) const
+{
+    const double length = std::hypot(bx - ax, by - ay);
+    if (length == 0) {
+        return is_footprint_inside(index, ax, ay);
+    }
+
+    // Rectangle swept by the robot heading along [AB]: centered on the middle of [AB],
+    // with axis U along [AB] and axis V across it.
+    const double ux = (bx - ax) / length;
+    const double uy = (by - ay) / length;
+    const double mx = (ax + bx) / 2;
+    const double my = (ay + by) / 2;
+    const double half_length = length / 2 + footprint_half_length_;
+    const double half_width = footprint_half_width_;
+
+    uint32_t shape_index = shape_indices_[index];
+    if (shapes_[index] == Shape::Circle) {
+        // Distance from the center to the rectangle, in rectangle coordinates.
+        double px = circle_x_[shape_index] - mx;
+        double py = circle_y_[shape_index] - my;
+        double along = std::max(std::abs(px * ux + py * uy) - half_length, 0.0);
+        double across = std::max(std::abs(py * ux - px * uy) - half_width, 0.0);
+        double radius = circle_radius_[shape_index];
+        return along * along + across * across < radius * radius;
+    }
+
+    // Separating axis test between two convex polygons: rectangle axes, then polygon edge normals.
+    const uint32_t begin = polygon_offsets_[shape_index];
+    const uint32_t end = polygon_offsets_[shape_index + 1];
+    if (begin == end) {
+        return false;
+    }
+    auto is_separated = [&](double nx, double ny, double extent) {
+        double low = std::numeric_limits<double>::max();
+        double high = std::numeric_limits<double>::lowest();
+        for (uint32_t e = begin; e < end; e++) {
+            double projection = (edge_x_[e] - mx) * nx + (edge_y_[e] - my) * ny;
+            low = std::min(low, projection);
+            high = std::max(high, projection);
+        }
+        return low >= extent || high <= -extent;
+    };
+    if (is_separated(ux, uy, half_length) || is_separated(-uy, ux, half_width)) {
+        return false;
+    }
+    for (uint32_t e = begin; e < end; e++) {
+        double nx = edge_y_[e] - edge_next_y_[e];
+        double ny = edge_next_x_[e] - edge_x_[e];
+        double extent = half_length * std::abs(ux * nx + uy * ny) + half_width * std::abs(ux * ny - uy * nx);
+        if (is_separated(nx, ny, extent)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+models::Vec2 ObstacleSet::nearest_point(size_t index, const models::Vec2& p) const
+{
+    uint32_t shape_index = shape_indices_[index];
+    if (shapes_[index] == Shape::Circle) {
+        // Project the point on the circle enlarged by the bounding box margin.
+        double cx = circle_x_[shape_index];
+        double cy = circle_y_[shape_index];
+        double vx = p.x - cx;
+        double vy = p.y - cy;
+        double norm = std::hypot(vx, vy);
+        double effective_radius = circle_radius_[shape_index] + circle_margin_[shape_index];
+        if (norm == 0) {
+            return models::Vec2(cx + effective_radius, cy);
+        }
+        double scale = effective_radius / norm;
+        return models::Vec2(cx + vx * scale, cy + vy * scale);
+    }
+
+    if (footprint_radius_ > 0) {
+        // Polygon points are too close for the robot, use the nearest bounding box point.
+        models::Vec2 closest_point = p;
+        double min_distance = std::numeric_limits<double>::max();
+        for (uint32_t point = bounding_box_offsets_[index]; point < bounding_box_offsets_[index + 1]; point++) {
+            double distance = p.distance(bounding_box_x_[point], bounding_box_y_[point]);
+            if (distance < min_distance) {
+                min_distance = distance;
+                closest_point = models::Vec2(bounding_box_x_[point], bounding_box_y_[point]);
+            }
+        }
+        return closest_point;
+    }
+
+    // Nearest polygon point.
+    double min_distance = std::numeric_limits<double>::max();
+    models::Vec2 closest_point = p;
+    for (uint32_t e = polygon_offsets_[shape_index]; e < polygon_offsets_[shape_index + 1]; e++) {
+        double distance = p.distance(edge_x_[e], edge_y_[e]);
+        if (distance < min_distance) {
+            min_distance = distance;
+            closest_point = models::Vec2(edge_x_[e], edge_y_[e]);
+        }
+    }
+    return closest_point;
+}
+
+void ObstacleSet::points_inside(const double* x, const double* y, size_t count, uint8_t* inside) const
+{
+    if (footprint_radius_ > 0) {
+        for (size_t j = 0; j < count; j++) {
+            inside[j] = false;
+            for (size_t k = 0; k < size() && !inside[j]; k++) {
+                inside[j] = is_footprint_inside(k, x[j], y[j]);
+            }
+        }
+        return;
+    }
+
+    double hit[batch_size];
+    double in_polygon[batch_size];
+    for (size_t first = 0; first < count; first += batch_size) {
+        const size_t n = std::min(batch_size, count - first);
+        const double* px = x + first;
+        const double* py = y + first;
+        std::fill_n(hit, n, 0.0);
+
+        for (size_t c = 0; c < circle_x_.size(); c++) {
+            const double cx = circle_x_[c];
+            const double cy = circle_y_[c];
+            const double threshold = circle_threshold_[c];
+            for (size_t j = 0; j < n; j++) {
+                double dx = px[j] - cx;
+                double dy = py[j] - cy;
+                hit[j] = (dx * dx + dy * dy <= threshold) ? 1.0 : hit[j];
+            }
+        }
+
+        for (size_t polygon = 0; polygon + 1 < polygon_offsets_.size(); polygon++) {
+            std::fill_n(in_polygon, n, 1.0);
+            for (uint32_t e = polygon_offsets_[polygon]; e < polygon_offsets_[polygon + 1]; e++) {
+                const double ex = edge_x_[e];
+                const double ey = edge_y_[e];
+                const double fx = edge_next_x_[e];
+                const double fy = edge_next_y_[e];
+                for (size_t j = 0; j < n; j++) {
+                    in_polygon[j] = (utils::orient2d(ex, ey, fx, fy, px[j], py[j]) > 0) ? in_polygon[j] : 0.0;
+                }
+            }
+            for (size_t j = 0; j < n; j++) {
+                hit[j] = (in_polygon[j] != 0) ? 1.0 : hit[j];
+            }
+        }
+
+        for (size_t j = 0; j < n; j++) {
+            inside[first + j] = (hit[j] != 0);
+        }
+    }
+}
+
+void ObstacleSet::segment_crossings(double ax, double ay, double bx, double by, std::vector<uint32_t>& crossed) const
+{
+    crossed.clear();
+    if (footprint_radius_ > 0) {
+        for (size_t k = 0; k < size(); k++) {
+            if (is_segment_crossing(k, ax, ay, bx, by)) {
+                crossed.push_back(k);
+            }
+        }
+        return;
+    }
+
+    const double length = std::hypot(bx - ax, by - ay);
+    double hit[batch_size];
+    for (size_t first = 0; first < circle_x_.size(); first += batch_size) {
+        const size_t count = std::min(batch_size, circle_x_.size() - first);
+        const double* cx = &circle_x_[first];
+        const double* cy = &circle_y_[first];
+        const double* radius = &circle_radius_[first];
+        const double* threshold = &circle_threshold_[first];
+        for (size_t i = 0; i < count; i++) {
+            hit[i] = is_segment_crossing_circle(cx[i], cy[i], radius[i], threshold[i], ax, ay, bx, by, length) ? 1.0 : 0.0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (hit[i] != 0) {
+                crossed.push_back(circle_obstacles_[first + i]);
+            }
+        }
+    }
+
+    // Edges of all polygons are tested in the same batches: rectangles have too few edges
+    // to fill a batch on their own. Results are then reduced polygon by polygon, in edge order.
+    bool polygon_hit = false;
+    int index_a = -1;
+    int index_b = -1;
+    for (size_t first = 0; first < edge_x_.size(); first += batch_size) {
+        const size_t count = std::min(batch_size, edge_x_.size() - first);
+        const double* cx = &edge_x_[first];
+        const double* cy = &edge_y_[first];
+        const double* dx = &edge_next_x_[first];
+        const double* dy = &edge_next_y_[first];
+        for (size_t i = 0; i < count; i++) {
+            hit[i] = is_segment_crossing_edge(cx[i], cy[i], dx[i], dy[i], ax, ay, bx, by) ? 1.0 : 0.0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t edge = first + i;
+            const uint32_t polygon = edge_polygons_[edge];
+            const int point = edge - polygon_offsets_[polygon];
+            if (point == 0) {
+                polygon_hit = false;
+                index_a = -1;
+                index_b = -1;
+            }
+            polygon_hit = polygon_hit || hit[i] != 0;
+            if (index_a < 0 && cx[i] == ax && cy[i] == ay) {
+                index_a = point;
+            }
+            if (index_b < 0 && cx[i] == bx && cy[i] == by) {
+                index_b = point;
+            }
+            if (edge + 1 == polygon_offsets_[polygon + 1] &&
+                (polygon_hit || (index_a >= 0 && index_b >= 0 && std::abs(index_a - index_b) != 1))) {
+                crossed.push_back(polygon_obstacles_[polygon]);
+            }
+        }
+    }
+
+    std::sort(crossed.begin(), crossed.end());
+}
+
+} // namespace avoidance
+
+} // namespace cogip
@@ -0,0 +1,224 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+// Standard includes
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// Project includes
+#include "avoidance/StaticRoadmap.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// File signature followed by the format version.
+static constexpr char roadmap_magic[4] = {'C', 'G', 'R', 'M'};
+static constexpr uint32_t roadmap_version = 2;
+
+RoadmapKey RoadmapKey::from_properties(const shared_memory::shared_properties_t& properties)
+{
+    RoadmapKey key;
+    key.table = properties.table;
+    key.robot_width = properties.robot_width;
+    key.robot_length = properties.robot_length;
+    key.obstacle_bb_margin = properties.obstacle_bb_margin;
+    key.obstacle_bb_vertices = properties.obstacle_bb_vertices;
+    key.footprint_avoidance = properties.footprint_avoidance ? 1 : 0;
+    return key;
+}
+
+std::string RoadmapKey::file_name() const
+{
+    // The margin is written exactly, the key is also checked on load.
+    uint64_t margin_bits;
+    std::memcpy(&margin_bits, &obstacle_bb_margin, sizeof(margin_bits));
+    std::ostringstream oss;
+    oss << "roadmap_t" << static_cast<int>(table)
+        << "_w" << robot_width
+        << "_l" << robot_length
+        << "_m" << std::hex << margin_bits << std::dec
+        << "_v" << static_cast<int>(obstacle_bb_vertices)
+        << "_f" << static_cast<int>(footprint_avoidance)
+        << ".bin";
+    return oss.str();
+}
+
+void StaticRoadmap::clear()
+{
+    key_ = RoadmapKey();
+    hashes_.clear();
+    point_offsets_.clear();
+    blockers_.clear();
+}
+
+uint64_t StaticRoadmap::hash_obstacle(const ObstacleSet& obstacles, size_t index)
+{
+    // FNV-1a over the raw bits of each value.
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; i++) {
+            hash ^= (bits >> (i * 8)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    mix(obstacles.center_x(index));
+    mix(obstacles.center_y(index));
+    mix(obstacles.radius(index));
+    for (uint32_t point = obstacles.bounding_box_offset(index); point < obstacles.bounding_box_offset(index + 1); point++) {
+        mix(obstacles.bounding_box_x()[point]);
+        mix(obstacles.bounding_box_y()[point]);
+    }
+    return hash;
+}
+
+int StaticRoadmap::find_obstacle(uint64_t hash) const
+{
+    for (size_t k = 0; k < hashes_.size(); k++) {
+        if (hashes_[k] == hash) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+void StaticRoadmap::build(const RoadmapKey& key, const ObstacleSet& obstacles)
+{
+    const size_t count = obstacles.size();
+    if (count > INT16_MAX) {
+        throw std::runtime_error("StaticRoadmap: too many obstacles");
+    }
+
+    key_ = key;
+    hashes_.resize(count);
+    point_offsets_.resize(count + 1);
+    for (size_t k = 0; k < count; k++) {
+        hashes_[k] = hash_obstacle(obstacles, k);
+        point_offsets_[k] = obstacles.bounding_box_offset(k);
+    }
+    point_offsets_[count] = obstacles.bounding_box_offset(count);
+
+    // Points of the roadmap are the bounding box points of the set, in the same order,
+    // so they are passed as slots to the segment test.
+    const uint32_t points = point_offsets_[count];
+    const double* x = obstacles.bounding_box_x();
+    const double* y = obstacles.bounding_box_y();
+    blockers_.assign(points > 0 ? static_cast<size_t>(points) * (points - 1) / 2 : 0, free);
+    for (uint32_t b = 1; b < points; b++) {
+        int16_t* row = &blockers_[static_cast<size_t>(b) * (b - 1) / 2];
+        for (uint32_t a = 0; a < b; a++) {
+            for (size_t k = 0; k < count; k++) {
+                if (obstacles.is_segment_crossing(k, x[a], y[a], x[b], y[b], a, b)) {
+                    row[a] = k;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool StaticRoadmap::save(const std::string& path) const
+{
+    std::error_code error;
+    std::filesystem::path file(path);
+    if (file.has_parent_path()) {
+        std::filesystem::create_directories(file.parent_path(), error);
+    }
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        auto write = [&out](const void* data, size_t size) {
+            out.write(static_cast<const char*>(data), size);
+        };
+        uint32_t count = hashes_.size();
+        uint32_t blockers = blockers_.size();
+        write(roadmap_magic, sizeof(roadmap_magic));
+        write(&roadmap_version, sizeof(roadmap_version));
+        write(&key_.table, sizeof(key_.table));
+        write(&key_.robot_width, sizeof(key_.robot_width));
+        write(&key_.robot_length, sizeof(key_.robot_length));
+        write(&key_.obstacle_bb_margin, sizeof(key_.obstacle_bb_margin));
+        write(&key_.obstacle_bb_vertices, sizeof(key_.obstacle_bb_vertices));
+        write(&key_.footprint_avoidance, sizeof(key_.footprint_avoidance));
+        write(&count, sizeof(count));
+        write(hashes_.data(), count * sizeof(uint64_t));
+        write(point_offsets_.data(), (count + 1) * sizeof(uint32_t));
+        write(&blockers, sizeof(blockers));
+        write(blockers_.data(), blockers * sizeof(int16_t));
+        if (!out) {
+            return false;
+        }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool StaticRoadmap::load(const std::string& path, const RoadmapKey& key)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    auto read = [&in](void* data, size_t size) {
+        in.read(static_cast<char*>(data), size);
+        return static_cast<bool>(in);
+    };
+
+    char magic[sizeof(roadmap_magic)];
+    uint32_t version;
+    RoadmapKey file_key;
+    if (!read(magic, sizeof(magic)) || std::memcmp(magic, roadmap_magic, sizeof(magic)) != 0 ||
+        !read(&version, sizeof(version)) || version != roadmap_version ||
+        !read(&file_key.table, sizeof(file_key.table)) ||
+        !read(&file_key.robot_width, sizeof(file_key.robot_width)) ||
+        !read(&file_key.robot_length, sizeof(file_key.robot_length)) ||
+        !read(&file_key.obstacle_bb_margin, sizeof(file_key.obstacle_bb_margin)) ||
+        !read(&file_key.obstacle_bb_vertices, sizeof(file_key.obstacle_bb_vertices)) ||
+        !read(&file_key.footprint_avoidance, sizeof(file_key.footprint_avoidance)) ||
+        !(file_key == key)) {
+        return false;
+    }
+
+    uint32_t count;
+    if (!read(&count, sizeof(count)) || count > INT16_MAX) {
+        return false;
+    }
+    std::vector<uint64_t> hashes(count);
+    std::vector<uint32_t> point_offsets(count + 1);
+    uint32_t blockers;
+    if (!read(hashes.data(), count * sizeof(uint64_t)) ||
+        !read(point_offsets.data(), (count + 1) * sizeof(uint32_t)) ||
+        !read(&blockers, sizeof(blockers))) {
+        return false;
+    }
+    uint32_t points = point_offsets[count];
+    if (blockers != (points > 0 ? static_cast<size_t>(points) * (points - 1) / 2 : 0)) {
+        return false;
+    }
+    std::vector<int16_t> blocker_data(blockers);
+    if (!read(blocker_data.data(), blockers * sizeof(int16_t))) {
+        return false;
+    }
+
+    key_ = file_key;
+    hashes_ = std::move(hashes);
+    point_offsets_ = std::move(point_offsets);
+    blockers_ = std::move(blocker_data);
+    return true;
+}
+
+} // namespace avoidance
+
+} // namespace cogip
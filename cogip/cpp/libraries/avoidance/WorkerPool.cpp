@@ -0,0 +1,113 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+// Standard includes
+#include <algorithm>
+
+// Project includes
+#include "avoidance/WorkerPool.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+WorkerPool::WorkerPool(size_t workers)
+{
+    for (size_t worker = 1; worker < workers; worker++) {
+        threads_.emplace_back(&WorkerPool::worker_loop, this, worker);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkerPool::parallel_for(size_t count, size_t chunk, const Task& task)
+{
+    if (count == 0) {
+        return;
+    }
+    if (threads_.empty() || count <= chunk) {
+        task(0, 0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        chunk_ = std::max<size_t>(chunk, 1);
+        next_.store(0, std::memory_order_relaxed);
+        error_ = nullptr;
+        running_ = threads_.size();
+        generation_++;
+    }
+    start_cv_.notify_all();
+
+    run_chunks(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return running_ == 0; });
+    task_ = nullptr;
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+void WorkerPool::worker_loop(size_t worker)
+{
+    uint64_t generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stopping_ || generation_ != generation; });
+            if (stopping_) {
+                return;
+            }
+            generation = generation_;
+        }
+
+        run_chunks(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_--;
+        }
+        done_cv_.notify_one();
+    }
+}
+
+void WorkerPool::run_chunks(size_t worker)
+{
+    while (true) {
+        size_t begin = next_.fetch_add(chunk_, std::memory_order_relaxed);
+        if (begin >= count_) {
+            return;
+        }
+        try {
+            (*task_)(worker, begin, std::min(begin + chunk_, count_));
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+            // Hand out no more chunks.
+            next_.store(count_, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace avoidance
+
+} // namespace cogip
@@ -4,11 +4,20 @@
 // directory for more details.
 
 #include "avoidance/Avoidance.hpp"
+#include "avoidance/AvoidanceService.hpp"
+#include "avoidance/GoapPlanner.hpp"
 
 #include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/pair.h>
 #include <nanobind/stl/string.h>
+#include <nanobind/stl/vector.h>
 
+#include <functional>
+#include <memory>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -20,17 +29,291 @@ namespace avoidance {
 NB_MODULE(avoidance, m) {
     auto models_module = nb::module_::import_("cogip.cpp.libraries.models");
     auto obstacles_module = nb::module_::import_("cogip.cpp.libraries.obstacles");
+    auto shared_memory_module = nb::module_::import_("cogip.cpp.libraries.shared_memory");
+
+    nb::enum_<SearchAlgorithm>(m, "SearchAlgorithm")
+        .value("DIJKSTRA", SearchAlgorithm::DIJKSTRA)
+        .value("ASTAR", SearchAlgorithm::ASTAR);
+
+    nb::enum_<PlanningEngine>(m, "PlanningEngine")
+        .value("VISIBILITY_GRAPH", PlanningEngine::VISIBILITY_GRAPH)
+        .value("GRID", PlanningEngine::GRID);
+
+    nb::enum_<PathPostProcessing>(m, "PathPostProcessing")
+        .value("NONE", PathPostProcessing::NONE)
+        .value("SHORTCUT", PathPostProcessing::SHORTCUT)
+        .value("SMOOTH", PathPostProcessing::SMOOTH);
 
     // Bind Avoidance class
     nb::class_<Avoidance>(m, "Avoidance")
         .def(nb::init<const std::string&>(), "Constructor initializing the avoidance system", "name"_a)
+        .def(nb::init<shared_memory::SharedMemory&>(), "shared_memory"_a, nb::keep_alive<1, 2>(),
+             "Constructor on a SharedMemory of the process, usually an in-process one shared with the other stages")
         .def("is_point_in_obstacles", &Avoidance::is_point_in_obstacles, "Checks if a point is inside any obstacle", "point"_a, "filter"_a = nullptr)
+        .def("clearance", &Avoidance::clearance, "Distance from a point to the nearest inflated obstacle in mm, 0 inside (constant time, cell accuracy)", "point"_a)
         .def("get_path_size", &Avoidance::get_path_size, "Retrieves the size of the computed avoidance path")
         .def("get_path_pose", &Avoidance::get_path_pose, "Retrieves the pose at a specific index in the computed path", "index"_a)
-        .def("avoidance", &Avoidance::avoidance, "Builds the avoidance graph between the start and finish positions", "start"_a, "finish"_a)
+        .def("get_path_array",
+            [](nb::handle_t<Avoidance> self) {
+                static_assert(sizeof(models::Vec2) == 2 * sizeof(double), "Vec2 must be two packed doubles");
+                models::Span<const models::Vec2> path = nb::cast<Avoidance&>(self).get_path();
+                return nb::ndarray<const double, nb::numpy, nb::shape<-1, 2>>(
+                    reinterpret_cast<const double*>(path.data()), {path.size(), 2}, self);
+            },
+            "Returns a read-only (N, 2) numpy view of the computed path, start included, finish excluded, "
+            "without copy. The view is overwritten by the next path computation.")
+        .def("avoidance", nb::overload_cast<const models::Coords&, const models::Coords&>(&Avoidance::avoidance),
+            "Builds the avoidance graph between the start and finish positions", "start"_a, "finish"_a)
+        .def("compute_path",
+            [](Avoidance& self, const models::Coords& start, const models::Coords& finish) {
+                auto path = std::make_unique<std::vector<double>>();
+                {
+                    // Graph build and search do not touch Python objects.
+                    nb::gil_scoped_release release;
+                    self.compute_path(start, finish, *path);
+                }
+                size_t rows = path->size() / 2;
+                double* data = path->data();
+                nb::capsule owner(path.release(), [](void* p) noexcept {
+                    delete static_cast<std::vector<double>*>(p);
+                });
+                return nb::ndarray<double, nb::numpy, nb::shape<-1, 2>>(data, {rows, 2}, owner);
+            },
+            "Computes the path between start and finish, both included, "
+            "as an (N, 2) array of [x, y] (empty if no path is found). "
+            "The GIL is released during the computation.",
+            "start"_a, "finish"_a)
+        .def("compute_path_within",
+            [](Avoidance& self, const models::Coords& start, const models::Coords& finish, double budget) {
+                auto path = std::make_unique<std::vector<double>>();
+                bool optimal = false;
+                {
+                    // Graph build and search do not touch Python objects.
+                    nb::gil_scoped_release release;
+                    self.compute_path(start, finish, budget, *path, optimal);
+                }
+                size_t rows = path->size() / 2;
+                double* data = path->data();
+                nb::capsule owner(path.release(), [](void* p) noexcept {
+                    delete static_cast<std::vector<double>*>(p);
+                });
+                return std::make_pair(nb::ndarray<double, nb::numpy, nb::shape<-1, 2>>(data, {rows, 2}, owner), optimal);
+            },
+            "Computes the path between start and finish within a time budget in seconds, "
+            "trying the direct segment, then a coarse graph, then the full graph. "
+            "Returns an (N, 2) array of [x, y] (empty if no path is found) and whether the path is optimal. "
+            "The GIL is released during the computation.",
+            "start"_a, "finish"_a, "budget"_a)
+        .def("validate_cached_path",
+            [](Avoidance& self, const models::Coords& current_pose) {
+                auto path = std::make_unique<std::vector<double>>();
+                {
+                    nb::gil_scoped_release release;
+                    self.validate_cached_path(current_pose, *path);
+                }
+                size_t rows = path->size() / 2;
+                double* data = path->data();
+                nb::capsule owner(path.release(), [](void* p) noexcept {
+                    delete static_cast<std::vector<double>*>(p);
+                });
+                return nb::ndarray<double, nb::numpy, nb::shape<-1, 2>>(data, {rows, 2}, owner);
+            },
+            "Reuses the last computed path from the current pose if its remaining segments are still free, "
+            "as an (N, 2) array of [x, y] like compute_path (empty if a full planning is needed). "
+            "The GIL is released during the computation.",
+            "current_pose"_a)
+        .def("clear_cached_path", &Avoidance::clear_cached_path, "Forgets the cached path, for instance when the destination changes")
+        .def("compute_alternative_paths",
+            [](Avoidance& self, size_t count) {
+                {
+                    // Searches do not touch Python objects.
+                    nb::gil_scoped_release release;
+                    self.compute_alternative_paths(count);
+                }
+                nb::list paths;
+                for (size_t index = 0; index < self.alternative_path_count(); index++) {
+                    const std::vector<models::Vec2>& points = self.alternative_path(index);
+                    auto path = std::make_unique<std::vector<double>>();
+                    path->reserve(2 * points.size());
+                    for (const models::Vec2& point : points) {
+                        path->push_back(point.x);
+                        path->push_back(point.y);
+                    }
+                    double* data = path->data();
+                    nb::capsule owner(path.release(), [](void* p) noexcept {
+                        delete static_cast<std::vector<double>*>(p);
+                    });
+                    paths.append(nb::make_tuple(
+                        nb::ndarray<double, nb::numpy, nb::shape<-1, 2>>(data, {points.size(), 2}, owner),
+                        self.alternative_path_cost(index)
+                    ));
+                }
+                return paths;
+            },
+            "Computes the best paths to the finish pose of the last avoidance call on its graph, "
+            "only keeping paths differing enough from the cheaper ones. "
+            "Returns a list of ((N, 2) array of [x, y], cost), the shortest path first, "
+            "empty if the last path does not come from the full visibility graph. "
+            "The GIL is released during the computation.",
+            "count"_a)
+        .def("use_alternative_path",
+            [](Avoidance& self, const models::Coords& current_pose) {
+                auto path = std::make_unique<std::vector<double>>();
+                {
+                    nb::gil_scoped_release release;
+                    self.use_alternative_path(current_pose, *path);
+                }
+                size_t rows = path->size() / 2;
+                double* data = path->data();
+                nb::capsule owner(path.release(), [](void* p) noexcept {
+                    delete static_cast<std::vector<double>*>(p);
+                });
+                return nb::ndarray<double, nb::numpy, nb::shape<-1, 2>>(data, {rows, 2}, owner);
+            },
+            "Switches to the cheapest alternative path still valid from the current pose, "
+            "as an (N, 2) array of [x, y] like compute_path (empty if no alternative is valid). "
+            "The GIL is released during the computation.",
+            "current_pose"_a)
+        .def("clear_alternative_paths", &Avoidance::clear_alternative_paths, "Forgets the alternative paths, for instance when the destination changes")
+        .def_prop_rw("alternative_max_overlap", &Avoidance::alternative_max_overlap, &Avoidance::set_alternative_max_overlap,
+            "Get or set the part of the cost of an alternative path allowed on edges of the cheaper paths kept, between 0 and 1")
+        .def("compute_path_costs",
+            [](Avoidance& self,
+               nb::ndarray<const double, nb::shape<-1, 2>, nb::c_contig, nb::device::cpu> starts,
+               nb::ndarray<const double, nb::shape<-1, 2>, nb::c_contig, nb::device::cpu> goals) {
+                std::vector<models::Vec2> start_points(starts.shape(0));
+                for (size_t i = 0; i < start_points.size(); i++) {
+                    start_points[i] = models::Vec2(starts(i, 0), starts(i, 1));
+                }
+                std::vector<models::Vec2> goal_points(goals.shape(0));
+                for (size_t i = 0; i < goal_points.size(); i++) {
+                    goal_points[i] = models::Vec2(goals(i, 0), goals(i, 1));
+                }
+                auto costs = std::make_unique<std::vector<double>>();
+                {
+                    // Graph build and searches do not touch Python objects.
+                    nb::gil_scoped_release release;
+                    self.compute_path_costs(start_points, goal_points, *costs);
+                }
+                double* data = costs->data();
+                nb::capsule owner(costs.release(), [](void* p) noexcept {
+                    delete static_cast<std::vector<double>*>(p);
+                });
+                return nb::ndarray<double, nb::numpy, nb::ndim<2>>(data, {start_points.size(), goal_points.size()}, owner);
+            },
+            "Computes the shortest path lengths from each start to each goal with a single graph build, "
+            "as an (N, M) array for (N, 2) starts and (M, 2) goals, infinity for unreachable goals. "
+            "The GIL is released during the computation.",
+            "starts"_a, "goals"_a)
+        .def("publish_path", &Avoidance::publish_path, nb::call_guard<nb::gil_scoped_release>(),
+            "Computes the path toward the avoidance pose order and writes it into the shared avoidance path",
+            "start"_a)
         .def("check_recompute", &Avoidance::check_recompute, "Checks whether recomputation of the path is necessary", "start"_a, "stop"_a)
+        .def_prop_rw("search_algorithm", &Avoidance::search_algorithm, &Avoidance::set_search_algorithm, "Get or set the search algorithm used on the avoidance graph")
+        .def_prop_rw("planning_engine", &Avoidance::planning_engine, &Avoidance::set_planning_engine, "Get or set the planning engine used to compute paths")
+        .def_prop_rw("grid_cell_size", &Avoidance::grid_cell_size, &Avoidance::set_grid_cell_size, "Get or set the cell side length of the grid planning engine in mm")
+        .def_prop_rw("path_post_processing", &Avoidance::path_post_processing, &Avoidance::set_path_post_processing, "Get or set the post-processing applied to computed paths")
+        .def_prop_rw("reach_nearest_goal", &Avoidance::reach_nearest_goal, &Avoidance::set_reach_nearest_goal, "Get or set paths to the nearest reachable point when the finish pose is outside the table or inside an obstacle")
+        .def("goal_reached", &Avoidance::goal_reached, "Checks whether the last computed path leads to the requested finish pose")
+        .def("get_finish_pose", &Avoidance::get_finish_pose, "Retrieves the end of the last computed path")
+        .def_prop_rw("time_aware", &Avoidance::time_aware, &Avoidance::set_time_aware, "Get or set the rejection of edges crossing tracked obstacles moving along their velocity while the robot traverses them")
+        .def_prop_rw("planning_speed", &Avoidance::planning_speed, &Avoidance::set_planning_speed, "Get or set the robot speed used to predict traversal times in mm/s")
+        .def_prop_rw("prediction_horizon", &Avoidance::prediction_horizon, &Avoidance::set_prediction_horizon, "Get or set the duration over which obstacle motion is predicted in seconds")
+        .def_prop_rw("clearance_weight", &Avoidance::clearance_weight, &Avoidance::set_clearance_weight, "Get or set the weight of the clearance penalty in edge costs (0 to disable)")
+        .def_prop_rw("clearance_distance", &Avoidance::clearance_distance, &Avoidance::set_clearance_distance, "Get or set the distance from which edges have no clearance penalty in mm")
+        .def_prop_rw("incremental", &Avoidance::incremental, &Avoidance::set_incremental, "Get or set incremental graph updates, reusing visibility between unchanged obstacles")
+        .def_prop_rw("worker_count", &Avoidance::worker_count, &Avoidance::set_worker_count, "Get or set the number of workers used to build the graph (1 for a sequential build)")
+        .def_prop_rw("roadmap_directory", &Avoidance::roadmap_directory, &Avoidance::set_roadmap_directory, "Get or set the directory where static roadmaps of fixed obstacles are stored (empty to disable)")
+        .def("set_static_obstacles",
+            [](Avoidance& self, const std::vector<obstacles::Obstacle*>& fixed_obstacles) {
+                std::vector<std::reference_wrapper<obstacles::Obstacle>> references;
+                for (obstacles::Obstacle* obstacle : fixed_obstacles) {
+                    references.emplace_back(*obstacle);
+                }
+                nb::gil_scoped_release release;
+                return self.set_static_obstacles(references);
+            },
+            "Sets the fixed table obstacles, whose mutual visibility is loaded from the roadmap directory "
+            "or computed once, returns True if the roadmap was loaded from a file",
+            "obstacles"_a)
+        .def("is_roadmap_active", &Avoidance::is_roadmap_active, "Checks whether the static roadmap is used by the current obstacles")
         .def("add_dynamic_obstacle", &Avoidance::add_dynamic_obstacle, "Adds a dynamic obstacle to the list of obstacles", "obstacle"_a)
         .def("clear_dynamic_obstacles", &Avoidance::clear_dynamic_obstacles, "Clears all dynamic obstacles")
+        .def("load_obstacles_from_shared_memory", &Avoidance::load_obstacles_from_shared_memory, nb::call_guard<nb::gil_scoped_release>(),
+            "Replaces dynamic obstacles by a compact snapshot of the shared circle and rectangle obstacles, "
+            "returns True if they changed since the previous load")
+        .def_prop_ro("obstacles_latency_frame", &Avoidance::obstacles_latency_frame,
+            "Last detector frame stamped when the obstacles were loaded, to stamp the avoidance path latency")
+    ;
+
+    // Bind GOAP search
+    m.attr("GOAP_MAX_ACTIONS") = GoapPlanner::max_actions;
+
+    nb::class_<GoapPlan>(m, "GoapPlan")
+        .def_ro("actions", &GoapPlan::actions, "Indexes of the actions of the best plan, in order, empty if no action is possible")
+        .def_ro("reward", &GoapPlan::reward, "Total reward of the plan")
+        .def_ro("time", &GoapPlan::time, "Time needed by the plan in seconds")
+        .def_ro("expanded_nodes", &GoapPlan::expanded_nodes, "Number of search nodes expanded")
+        .def_ro("depth", &GoapPlan::depth, "Depth fully searched")
+        .def_ro("complete", &GoapPlan::complete, "Whether the search reached the requested depth within the budget")
+    ;
+
+    nb::class_<GoapPlanner>(m, "GoapPlanner")
+        .def(nb::init<size_t>(), "Constructor starting the search workers (0 for one per core)", "workers"_a = 0)
+        .def("add_action",
+            [](GoapPlanner& self,
+               nb::ndarray<const double, nb::shape<-1, 2>, nb::c_contig, nb::device::cpu> poses,
+               double duration, double reward, double weight,
+               uint64_t required, uint64_t sets, uint64_t clears, bool first_allowed) {
+                GoapAction action;
+                action.poses.resize(poses.shape(0));
+                for (size_t i = 0; i < action.poses.size(); i++) {
+                    action.poses[i] = models::Vec2(poses(i, 0), poses(i, 1));
+                }
+                action.duration = duration;
+                action.reward = reward;
+                action.weight = weight;
+                action.required = required;
+                action.sets = sets;
+                action.clears = clears;
+                action.first_allowed = first_allowed;
+                return self.add_action(action);
+            },
+            "Adds an action reaching an (N, 2) array of poses, spending duration seconds besides travelling, "
+            "and returns its index. The action needs the required world bits, then sets and clears world bits",
+            "poses"_a, "duration"_a, "reward"_a, "weight"_a,
+            "required"_a = 0, "sets"_a = 0, "clears"_a = 0, "first_allowed"_a = true)
+        .def("clear_actions", &GoapPlanner::clear_actions, "Removes all actions")
+        .def_prop_ro("action_count", &GoapPlanner::action_count, "Number of actions")
+        .def("set_start",
+            [](GoapPlanner& self, double x, double y) { self.set_start(models::Vec2(x, y)); },
+            "Sets the position of the robot at the start of the plans", "x"_a, "y"_a)
+        .def("compute_costs", &GoapPlanner::compute_costs, nb::call_guard<nb::gil_scoped_release>(),
+            "Uses the path lengths between all poses avoiding the obstacles loaded in the avoidance, "
+            "computed with a single graph build, instead of straight lines",
+            "avoidance"_a)
+        .def("set_average_speed", &GoapPlanner::set_average_speed, "Sets the average robot speed converting path lengths into times in mm/s", "speed"_a)
+        .def_prop_rw("beam_width", &GoapPlanner::beam_width, &GoapPlanner::set_beam_width, "Get or set the maximum number of nodes kept at each level (0 to search all sequences)")
+        .def_prop_rw("worker_count", &GoapPlanner::worker_count, &GoapPlanner::set_worker_count, "Get or set the number of search workers (0 for one per core)")
+        .def("search", &GoapPlanner::search, nb::call_guard<nb::gil_scoped_release>(),
+            "Searches the best sequence of at most depth actions started before the end of the countdown, "
+            "within a budget in seconds (0 for no limit). The GIL is released during the search.",
+            "world"_a, "countdown"_a, "depth"_a, "budget"_a)
+    ;
+
+    // Bind AvoidanceService class
+    nb::class_<AvoidanceService>(m, "AvoidanceService")
+        .def(nb::init<const std::string&>(), "Constructor attaching the avoidance loop to the shared memory", "name"_a)
+        .def(nb::init<shared_memory::SharedMemory&>(), "shared_memory"_a, nb::keep_alive<1, 2>(),
+             "Constructor attaching the avoidance loop to a SharedMemory of the process, usually an in-process one")
+        .def("start", &AvoidanceService::start, "Starts the native avoidance thread")
+        .def("stop", &AvoidanceService::stop, nb::call_guard<nb::gil_scoped_release>(), "Stops the native avoidance thread and waits for it to exit")
+        .def("is_running", &AvoidanceService::is_running, "Checks whether the native avoidance thread is running")
+        .def("set_debug", &AvoidanceService::set_debug, "Enables or disables debug messages", "debug"_a)
+        .def("set_reflex", &AvoidanceService::set_reflex, "Enables or disables the check of the published path against the lidar points", "enabled"_a)
+        .def("set_reflex_clearance", &AvoidanceService::set_reflex_clearance, "Sets the distance to the path below which a lidar point blocks it (mm), 0 for half the robot width", "clearance"_a)
+        .def("set_alternative_count", &AvoidanceService::set_alternative_count, "Sets the number of paths computed with each path, 0 or 1 to disable the switch to alternative paths", "count"_a)
+        .def_prop_ro("avoidance", &AvoidanceService::avoidance, nb::rv_policy::reference_internal, "Avoidance instance used by the loop, to be tuned before start()")
     ;
 
 }
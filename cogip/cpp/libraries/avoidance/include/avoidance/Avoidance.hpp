@@ -22,37 +22,88 @@
 #pragma once
 
 /// Standard includes
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <deque>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <set>
+#include <string>
+#include <tuple>
 #include <vector>
 
-#include <nanobind/nanobind.h>
-#include <nanobind/ndarray.h>
-
 /// Project includes
+#include "avoidance/ClearanceField.hpp"
+#include "avoidance/GridPlanner.hpp"
+#include "avoidance/IndexedHeap.hpp"
+#include "avoidance/ObstacleGrid.hpp"
+#include "avoidance/ObstacleSet.hpp"
+#include "avoidance/ObstacleSnapshot.hpp"
+#include "avoidance/PlanningArena.hpp"
+#include "avoidance/StaticRoadmap.hpp"
+#include "avoidance/WorkerPool.hpp"
 #include "models/Coords.hpp"
+#include "models/Span.hpp"
+#include "models/pose_order_list.hpp"
+#include "models/Vec2.hpp"
+#include "obstacles/ObstacleCircle.hpp"
 #include "obstacles/ObstaclePolygon.hpp"
+#include "obstacles/ObstacleRectangle.hpp"
 #include "shared_memory/SharedMemory.hpp"
 
-namespace nb = nanobind;
-
 namespace cogip {
 
 namespace avoidance {
 
+/// @brief Shortest path search algorithm run on the avoidance graph.
+enum class SearchAlgorithm {
+    DIJKSTRA, ///< Dijkstra's algorithm, expands vertices by distance from start.
+    ASTAR     ///< A* with an Euclidean heuristic toward the finish pose.
+};
+
+/// @brief Planning engine used to compute paths.
+enum class PlanningEngine {
+    VISIBILITY_GRAPH, ///< Shortest path on the visibility graph of obstacle bounding boxes.
+    GRID              ///< Lazy Theta* on a raster of the obstacles, cost bounded by the grid size.
+};
+
+/// @brief Post-processing applied to the path found on the avoidance graph.
+enum class PathPostProcessing {
+    NONE,     ///< Path as found on the graph.
+    SHORTCUT, ///< Vertices skipped greedily while the straight segment is free.
+    SMOOTH    ///< Shortcut, then corners cut while the cut is free, which adds vertices.
+};
+
 /// @brief Class managing the avoidance algorithm and graph representation.
 class Avoidance
 {
 public:
     static constexpr uint32_t max_distance = UINT32_MAX; ///< Maximum distance used for Dijkstra's algorithm.
+    static constexpr uint32_t coarse_point_stride = 2;   ///< Bounding box points skipped by the coarse graph, plus one.
+    static constexpr size_t smoothing_iterations = 3;    ///< Corner cutting passes of PathPostProcessing::SMOOTH.
+    static constexpr double smoothing_ratio = 0.25;      ///< Part of the adjacent segments removed by a corner cut.
+    static constexpr double default_planning_speed = 500.0;   ///< Default robot speed used to predict traversal times (mm/s).
+    static constexpr double default_prediction_horizon = 2.0; ///< Default duration over which obstacle motion is predicted (s).
+    static constexpr double moving_speed_threshold = 50.0;    ///< Speed from which a tracked obstacle is considered moving (mm/s).
+    static constexpr double default_clearance_distance = 200.0; ///< Default distance from which edges have no clearance penalty (mm).
+    static constexpr double default_alternative_max_overlap = 0.5; ///< Default part of an alternative path allowed on edges of a kept path.
+    static constexpr size_t alternative_search_factor = 8; ///< Paths enumerated per alternative path asked, to find differing ones.
+    /// Maximum number of path points, finish excluded, so that the published path fits in a pose order list.
+    static constexpr size_t path_capacity = models::POSE_ORDER_LIST_SIZE_MAX - 1;
 
     /// @brief Constructor initializing the avoidance system with obstacle borders.
     /// @param name Name of the shared memory segment.
     Avoidance(const std::string& name);
 
+    /// @brief Constructor on a shared memory of the process, usually an in-process one
+    /// shared with the drivers and the converter of an in-process pipeline.
+    /// @param shared_memory Shared memory, it must outlive the avoidance.
+    Avoidance(shared_memory::SharedMemory& shared_memory);
+
     /// @brief Checks if a point is inside any obstacle.
     /// @param point The coordinates of the point to check.
     /// @param filter Optional filter to specify a subset of obstacles. Checks all if null.
@@ -61,7 +112,11 @@ public:
 
     /// @brief Retrieves the size of the computed avoidance path.
     /// @return The number of poses in the path, including start and finish.
-    size_t get_path_size() const { return path_.size(); }
+    size_t get_path_size() const { return path_size_; }
+
+    /// @brief Retrieves the computed avoidance path, start included, finish excluded.
+    /// @return View on the path points, invalidated by the next path computation.
+    models::Span<const models::Vec2> get_path() const { return {path_.data(), path_size_}; }
 
     /// @brief Retrieves the pose at a specific index in the computed path.
     /// @param index The index of the pose in the path.
@@ -74,12 +129,298 @@ public:
     /// @return True if the graph was successfully built, false otherwise.
     bool avoidance(const models::Coords& start, const models::Coords& finish);
 
+    /// @brief Builds the avoidance graph within a time budget.
+    /// Stages run in order until one gives an optimal path or the budget is spent:
+    /// the direct segment, a coarse graph on one bounding box point out of `coarse_point_stride`,
+    /// then the full graph. The graph builds are interrupted once the budget is spent,
+    /// and the best path found so far is kept.
+    /// @param start The starting position.
+    /// @param finish The finishing position.
+    /// @param budget Time budget in seconds, unbounded if not positive.
+    /// @param[out] optimal True if the path is the shortest one, false if it comes from the coarse graph.
+    /// @return True if a path was found, false otherwise.
+    bool avoidance(const models::Coords& start, const models::Coords& finish, double budget, bool& optimal);
+
+    /// @brief Builds the avoidance graph and copies the resulting path in a single call.
+    /// The path goes from start to finish, both included, without duplicated points.
+    /// @param start The starting position.
+    /// @param finish The finishing position.
+    /// @param[out] path Flat array of [x, y] pairs, cleared first and left empty if no path is found.
+    /// @return True if a path was found, false otherwise.
+    bool compute_path(const models::Coords& start, const models::Coords& finish, std::vector<double>& path);
+
+    /// @brief Builds the avoidance graph within a time budget and copies the resulting path in a single call.
+    /// See the time-budgeted avoidance() for the planning stages.
+    /// @param start The starting position.
+    /// @param finish The finishing position.
+    /// @param budget Time budget in seconds, unbounded if not positive.
+    /// @param[out] path Flat array of [x, y] pairs, cleared first and left empty if no path is found.
+    /// @param[out] optimal True if the path is the shortest one.
+    /// @return True if a path was found, false otherwise.
+    bool compute_path(
+        const models::Coords& start,
+        const models::Coords& finish,
+        double budget,
+        std::vector<double>& path,
+        bool& optimal
+    );
+
+    /// @brief Reuses the last computed path from the current pose, if it is still free.
+    /// The path is re-anchored on the current pose: the robot goes to the farthest vertex,
+    /// beyond the nearest path segment, that it reaches in a straight line.
+    /// Remaining segments are re-tested against the current obstacles, without building any graph.
+    /// The cache holds the last path found by avoidance(), only when it was optimal,
+    /// and is cleared when a check fails, so the caller then runs a full planning.
+    /// @param current_pose The current position, new start of the path.
+    /// @param[out] path Flat array of [x, y] pairs as given by compute_path(), cleared first and left empty if the path is not valid.
+    /// @return True if the cached path is still valid.
+    bool validate_cached_path(const models::Coords& current_pose, std::vector<double>& path);
+
+    /// @brief Forgets the cached path, for instance when the destination changes.
+    void clear_cached_path() { cached_path_.clear(); }
+
+    /// @brief Computes the best paths to the finish pose of the last avoidance() call on its graph, without building it again.
+    /// Yen's algorithm enumerates the loopless graph paths by increasing cost, each one deviating from a previous one
+    /// at a spur vertex searched with A*. A path is only kept if at most alternative_max_overlap() of its cost
+    /// runs on edges of the paths already kept, so alternatives go around obstacles another way
+    /// instead of moving a single vertex. At most `alternative_search_factor` paths per alternative are enumerated.
+    /// Alternatives are graph paths, without post-processing. In time_aware() mode their edges are checked as in the search.
+    /// Only a path found on the full visibility graph has alternatives: not a direct segment, a coarse path,
+    /// a grid path or a path to the nearest reachable point.
+    /// @param count Maximum number of paths, the shortest one included.
+    /// @return The number of paths found, 0 if the last path has no alternatives.
+    size_t compute_alternative_paths(size_t count);
+
+    /// @brief Retrieves the number of paths left by compute_alternative_paths() and use_alternative_path().
+    size_t alternative_path_count() const { return alternative_paths_.size(); }
+
+    /// @brief Retrieves an alternative path, start and finish included, the cheapest one first.
+    /// @throws std::out_of_range if the index is not below alternative_path_count().
+    const std::vector<models::Vec2>& alternative_path(size_t index) const { return alternative_paths_.at(index); }
+
+    /// @brief Retrieves the cost of an alternative path on the graph, as the edge costs of the search.
+    /// @throws std::out_of_range if the index is not below alternative_path_count().
+    double alternative_path_cost(size_t index) const { return alternative_costs_.at(index); }
+
+    /// @brief Switches to the cheapest alternative path still valid from the current pose, without building any graph.
+    /// Alternatives are tried in order as the cached path of validate_cached_path(), and removed once tried,
+    /// so a next call goes on with the following ones.
+    /// @param current_pose The current position, new start of the path.
+    /// @param[out] path Flat array of [x, y] pairs as given by compute_path(), cleared first and left empty if no alternative is valid.
+    /// @return True if an alternative path is valid, it is then the cached path.
+    bool use_alternative_path(const models::Coords& current_pose, std::vector<double>& path);
+
+    /// @brief Forgets the alternative paths, for instance when the destination changes.
+    void clear_alternative_paths();
+
+    /// @brief Retrieves the part of the cost of an alternative path allowed on edges of the paths already kept.
+    double alternative_max_overlap() const { return alternative_max_overlap_; }
+
+    /// @brief Sets the part of the cost of an alternative path allowed on edges of the paths already kept.
+    /// @param overlap Ratio between 0, for paths sharing no edge, and 1, for the plain k shortest paths.
+    /// @throws std::invalid_argument if the ratio is not between 0 and 1.
+    void set_alternative_max_overlap(double overlap);
+
+    /// @brief Computes the shortest path length from each start to each goal with a single graph build.
+    /// All starts and goals are added to the obstacle visibility graph, which is built once,
+    /// then a one-to-many Dijkstra runs from each start.
+    /// As in avoidance(), a start inside an obstacle is moved to the nearest point of the obstacle.
+    /// The path computed by the previous avoidance() call is discarded.
+    /// @param starts Start positions.
+    /// @param goals Goal positions.
+    /// @param[out] costs Row-major matrix of path lengths, one row per start and one column per goal,
+    ///                   infinity if the goal is unreachable, outside the table limits or inside an obstacle.
+    void compute_path_costs(
+        const std::vector<models::Vec2>& starts,
+        const std::vector<models::Vec2>& goals,
+        std::vector<double>& costs
+    );
+
+    /// @brief Computes the path toward the avoidance pose order and publishes it in shared memory.
+    /// The path is written into `avoidance_path` under the `AvoidancePath` lock, then consumers are notified.
+    /// Intermediate poses inherit speeds, timeout and motion direction from `avoidance_pose_order`,
+    /// and the last pose is `avoidance_pose_order` itself.
+    /// Nothing is written if no path is found.
+    /// @param start The starting position.
+    /// @return True if a path was found and published, false otherwise.
+    bool publish_path(const models::Coords& start);
+
+    /// @brief Converts a path computed by compute_path() into pose orders.
+    /// All poses inherit speeds, timeout and motion direction from the pose order.
+    /// The first pose is the start, intermediate poses bypass final orientation,
+    /// and the last pose is the pose order itself.
+    /// @param path Flat array of [x, y] pairs, with at least start and finish.
+    /// @param pose_order The pose order the path leads to.
+    /// @param[out] poses The pose orders, cleared first.
+    static void make_path_poses(
+        const std::vector<double>& path,
+        const models::pose_order_t& pose_order,
+        std::vector<models::pose_order_t>& poses
+    );
+
+    /// @brief Writes a path into shared memory `avoidance_path` and notifies consumers.
+    /// The first pose is skipped since the robot is already there.
+    /// Only the poses differing from the published path are written, and `avoidance_path_version`
+    /// gets a new path id if the first pose changed.
+    /// @param poses The path poses, including start.
+    /// @param new_path True to give the path a new id even if its first pose did not change,
+    ///                 such as when it leads to a new pose order.
+    void write_avoidance_path(const std::vector<models::pose_order_t>& poses, bool new_path = false);
+
     /// @brief Checks whether recomputation of the path is necessary.
     /// @param start The starting position.
     /// @param stop The stopping position.
     /// @return True if recomputation is needed, false otherwise.
     bool check_recompute(const models::Coords& start, const models::Coords& stop);
 
+    /// @brief Retrieves the search algorithm used on the avoidance graph.
+    SearchAlgorithm search_algorithm() const { return search_algorithm_; }
+
+    /// @brief Selects the search algorithm used on the avoidance graph.
+    /// @param algorithm The search algorithm.
+    void set_search_algorithm(SearchAlgorithm algorithm) { search_algorithm_ = algorithm; }
+
+    /// @brief Retrieves the planning engine used to compute paths.
+    PlanningEngine planning_engine() const { return planning_engine_; }
+
+    /// @brief Selects the planning engine used to compute paths.
+    /// The visibility graph cost grows with the square of the number of bounding box points,
+    /// the grid cost only depends on the table size and grid_cell_size().
+    /// Path costs between several points are always computed on the visibility graph.
+    /// @param engine The planning engine.
+    void set_planning_engine(PlanningEngine engine) { planning_engine_ = engine; }
+
+    /// @brief Retrieves the cell side length of the grid planning engine in mm.
+    double grid_cell_size() const { return grid_planner_.cell_size(); }
+
+    /// @brief Sets the cell side length of the grid planning engine.
+    /// @param cell_size Cell side length in mm.
+    void set_grid_cell_size(double cell_size) { grid_planner_.set_cell_size(cell_size); }
+
+    /// @brief Retrieves the post-processing applied to computed paths.
+    PathPostProcessing path_post_processing() const { return path_post_processing_; }
+
+    /// @brief Selects the post-processing applied to computed paths.
+    /// Each path vertex becomes an intermediate pose where the robot slows down and turns,
+    /// so removing vertices shortens the motion. Segments are tested against the same obstacles as the graph.
+    /// @param post_processing The post-processing.
+    void set_path_post_processing(PathPostProcessing post_processing) { path_post_processing_ = post_processing; }
+
+    /// @brief Checks whether paths lead to the nearest reachable point when the finish pose is blocked.
+    bool reach_nearest_goal() const { return reach_nearest_goal_; }
+
+    /// @brief Enables or disables paths to the nearest reachable point when the finish pose is blocked.
+    /// A finish pose outside the table limits or inside an obstacle is projected on the limits or on the obstacle.
+    /// If the projected pose is still unreachable, the graph search leads to the reachable vertex
+    /// nearest to the requested finish pose, found by the same search. A single planning cycle then
+    /// brings the robot as close as possible to a target occupied by an opponent.
+    /// @param enabled True to enable, false to fail on blocked finish poses.
+    void set_reach_nearest_goal(bool enabled) { reach_nearest_goal_ = enabled; }
+
+    /// @brief Checks whether the last computed path leads to the requested finish pose.
+    /// Only false in reach_nearest_goal() mode, when the path leads to the nearest reachable point instead.
+    bool goal_reached() const { return goal_reached_; }
+
+    /// @brief Retrieves the end of the last computed path.
+    /// The requested finish pose, unless goal_reached() is false.
+    models::Coords get_finish_pose() const { return models::Coords(finish_pose_.x, finish_pose_.y); }
+
+    /// @brief Checks whether edges are also checked against the predicted motion of tracked obstacles.
+    bool time_aware() const { return time_aware_; }
+
+    /// @brief Enables or disables time-aware planning against moving obstacles.
+    /// The robot is assumed to follow the path at planning_speed(), so each edge is traversed
+    /// during a time window given by the path length before it. An edge is rejected if the robot
+    /// meets, during this window, a circle obstacle moving along its tracked velocity:
+    /// the edge is tested against the obstacle in the frame moving with it, like a velocity obstacle.
+    /// Obstacles stop moving after prediction_horizon(). The graph itself is still built
+    /// against the current obstacle positions, so the mode only rejects more paths.
+    /// Edges are checked by the search of the visibility graph, the direct path and the post-processing;
+    /// the grid engine and compute_path_costs() ignore obstacle motion.
+    /// @param enabled True to enable time-aware planning.
+    void set_time_aware(bool enabled) { time_aware_ = enabled; }
+
+    /// @brief Retrieves the robot speed used to predict traversal times in mm/s.
+    double planning_speed() const { return planning_speed_; }
+
+    /// @brief Sets the robot speed used to predict traversal times.
+    /// @param speed Average speed along the path in mm/s, must be positive.
+    void set_planning_speed(double speed);
+
+    /// @brief Retrieves the duration over which obstacle motion is predicted in seconds.
+    double prediction_horizon() const { return prediction_horizon_; }
+
+    /// @brief Sets the duration over which obstacle motion is predicted.
+    /// Tracked velocities are not reliable for long: obstacles are kept at their position at the horizon.
+    /// @param horizon Duration in seconds, must not be negative.
+    void set_prediction_horizon(double horizon);
+
+    /// @brief Retrieves the weight of the clearance penalty in edge costs, 0 if disabled.
+    double clearance_weight() const { return clearance_weight_; }
+
+    /// @brief Sets the weight of the clearance penalty in edge costs.
+    /// The cost of an edge is its length plus the weight times the length of the edge closer than
+    /// clearance_distance() to an obstacle, scaled by how close it gets: with weight 1, a segment grazing
+    /// an obstacle costs twice its length. Distances are sampled every cell along the edge from the
+    /// clearance field, rebuilt when obstacles change. Costs are never below lengths, so the A* heuristic
+    /// stays admissible, and post-processing only keeps changes that do not increase the cost.
+    /// The grid engine ignores the penalty and compute_path_costs() returns weighted costs.
+    /// @param weight Penalty weight, 0 to disable, must not be negative.
+    void set_clearance_weight(double weight);
+
+    /// @brief Retrieves the distance from which edges have no clearance penalty in mm.
+    double clearance_distance() const { return clearance_distance_; }
+
+    /// @brief Sets the distance from which edges have no clearance penalty.
+    /// @param distance Distance to the inflated obstacles in mm, must be positive.
+    void set_clearance_distance(double distance);
+
+    /// @brief Distance from a point to the nearest obstacle, inflated by the robot footprint.
+    /// Looked up in the clearance field, which is rebuilt first if obstacles changed.
+    /// The distance is measured between cells of ClearanceField::default_cell_size, so a zero distance
+    /// is a constant time, approximate occupancy test; is_point_in_obstacles() stays exact.
+    /// @param point The point.
+    /// @return Distance in mm, 0 inside an obstacle or outside the table limits.
+    double clearance(const models::Coords& point);
+
+    /// @brief Checks whether visibility edges between obstacles are kept between calls.
+    bool incremental() const { return incremental_; }
+
+    /// @brief Enables or disables incremental graph updates.
+    /// In incremental mode, edges between obstacle vertices are cached and only
+    /// re-tested against obstacles whose geometry changed since the previous call.
+    /// @param incremental True to enable incremental updates.
+    void set_incremental(bool incremental);
+
+    /// @brief Retrieves the number of workers used to build the graph.
+    size_t worker_count() const { return worker_pool_ ? worker_pool_->size() : 1; }
+
+    /// @brief Sets the number of workers used to build the graph.
+    /// Worker threads are created once here and reused by every build.
+    /// @param count Number of workers including the calling thread, 0 or 1 to build sequentially.
+    void set_worker_count(size_t count);
+
+    /// @brief Retrieves the directory where static roadmaps are stored, empty if none.
+    const std::string& roadmap_directory() const { return roadmap_directory_; }
+
+    /// @brief Sets the directory where static roadmaps are stored.
+    /// When set, the roadmap matching the current table and robot footprint is loaded
+    /// from this directory whenever obstacles change and no matching roadmap is loaded yet.
+    /// @param directory The directory, empty to disable loading and saving.
+    void set_roadmap_directory(const std::string& directory);
+
+    /// @brief Sets the fixed table obstacles, whose mutual visibility is computed only once.
+    /// The roadmap is loaded from the roadmap directory if it holds one for the current key
+    /// and these obstacles, otherwise it is computed and saved there.
+    /// Fixed obstacles must still be part of the obstacles used by the graph:
+    /// they are recognized there by their geometry.
+    /// @param obstacles The fixed obstacles, built with the current shared properties.
+    /// @return True if the roadmap was loaded from a file, false if it was computed.
+    bool set_static_obstacles(const std::vector<std::reference_wrapper<obstacles::Obstacle>>& obstacles);
+
+    /// @brief Checks whether the static roadmap is used by the current obstacles.
+    bool is_roadmap_active() const { return roadmap_active_; }
+
     /// @brief Adds a dynamic obstacle to the list of obstacles.
     /// @param obstacle The dynamic obstacle to add.
     void add_dynamic_obstacle(obstacles::Obstacle& obstacle);
@@ -87,53 +428,307 @@ public:
     /// @brief Clears all dynamic obstacles.
     void clear_dynamic_obstacles();
 
-private:
-    shared_memory::SharedMemory shared_memory_; ///< Shared memory instance.
-    shared_memory::shared_properties_t& shared_memory_properties_; ///< Pointer to shared properties in shared memory.
-    std::vector<models::Coords> valid_points_; ///< List of valid points for graph vertices.
-    std::map<uint64_t, std::map<uint64_t, double>> graph_; ///< Graph representation using adjacency lists.
+    /// @brief Replaces dynamic obstacles by the circle and rectangle obstacles of the shared memory.
+    /// The `Obstacles` lock is held only while the obstacles are copied into a compact snapshot,
+    /// which holds the used coordinates only. Obstacles are then rebuilt from the snapshot,
+    /// unless it is identical to the previously loaded one.
+    /// Nothing is copied if the `Obstacles` generation did not change since the last load.
+    /// @return True if the dynamic obstacles changed.
+    bool load_obstacles_from_shared_memory();
+
+    /// @brief Last frame stamped by the detector obstacles when the obstacles were last loaded.
+    /// The planner copies the detector obstacles to the shared obstacles, so the frame is the latest one
+    /// the loaded obstacles may come from. write_avoidance_path() stamps the avoidance path latency with it.
+    const shared_memory::latency_frame_t& obstacles_latency_frame() const { return obstacles_latency_frame_; }
 
-    models::Coords start_pose_;  ///< The starting pose for path computation.
-    models::Coords finish_pose_; ///< The finishing pose for path computation.
+private:
+    /// Constructor using either a given shared memory or its own one.
+    Avoidance(shared_memory::SharedMemory* shared_memory, std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory);
 
-    std::deque<std::reference_wrapper<models::Coords>> path_; ///< Path from start to finish.
+    std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory_; ///< Shared memory mapped by the avoidance, if any.
+    shared_memory::SharedMemory& shared_memory_; ///< Shared memory instance.
+    shared_memory::shared_properties_t& shared_memory_properties_; ///< Pointer to shared properties in shared memory.
+    std::vector<models::Vec2> valid_points_;   ///< List of valid points for graph vertices.
+
+    /// Visibility graph stored in compressed sparse row (CSR) layout.
+    /// Neighbors of vertex `v` are `graph_neighbors_[graph_offsets_[v] .. graph_offsets_[v + 1]]`.
+    /// All buffers are cleared but never shrunk, so they are reused across planning cycles.
+    std::vector<uint32_t> graph_offsets_;   ///< Index of the first neighbor of each vertex (vertex count + 1 entries).
+    std::vector<uint32_t> graph_neighbors_; ///< Neighbor vertex indices, grouped by vertex.
+    std::vector<double> graph_weights_;     ///< Edge weights, parallel to `graph_neighbors_`.
+    std::vector<std::tuple<uint32_t, uint32_t, double>> graph_edges_; ///< Undirected edges (i < j) collected before CSR packing.
+    std::vector<uint32_t> graph_cursors_;   ///< Per-vertex write position used while packing.
+
+    size_t terminal_count_ = 2;     ///< Number of leading graph vertices that are not obstacle points: start and finish, or path cost queries.
+    std::vector<uint32_t> goal_vertices_; ///< Graph vertex of each path cost goal, UINT32_MAX if invalid.
+
+    std::vector<double> distances_; ///< Dijkstra distances from start, per vertex.
+    std::vector<int> parents_;      ///< Dijkstra parent of each vertex, -1 if none.
+    std::vector<uint32_t> path_vertices_; ///< Graph vertices of the last path found by dijkstra(), start to target.
+    std::vector<bool> checked_;     ///< Dijkstra visited flags, per vertex.
+    IndexedHeap open_set_;          ///< Vertices discovered but not yet expanded, by estimated cost.
+    SearchAlgorithm search_algorithm_ = SearchAlgorithm::DIJKSTRA; ///< Algorithm run by dijkstra().
+    PlanningEngine planning_engine_ = PlanningEngine::VISIBILITY_GRAPH; ///< Engine run by avoidance().
+    GridPlanner grid_planner_;                   ///< Grid engine, its raster is rebuilt with the obstacle set.
+    std::vector<models::Vec2> grid_path_;        ///< Path found by the grid engine, finish included.
+    ClearanceField clearance_field_;             ///< Distance to obstacles, rebuilt with the obstacle set.
+    double clearance_weight_ = 0;                ///< Weight of the clearance penalty in edge costs.
+    double clearance_distance_ = default_clearance_distance; ///< Distance from which edges have no penalty.
+
+    /// Incremental graph update state.
+    /// Each bounding box point of each obstacle owns a stable slot, whatever its validity.
+    /// For each slot pair, the cache records whether the segment is free or which obstacle blocked it.
+    static constexpr int16_t visibility_free = -1;    ///< Cached segment crosses no obstacle.
+    static constexpr int16_t visibility_unknown = -2; ///< Cached segment must be fully re-tested.
+    bool incremental_ = false;                 ///< Whether incremental graph updates are enabled.
+    bool any_obstacle_changed_ = true;         ///< Whether any obstacle changed since the previous build.
+    std::vector<uint64_t> obstacle_hashes_;    ///< Geometry hash of each obstacle at the previous build.
+    std::vector<bool> obstacle_changed_;       ///< Whether each obstacle changed since the previous build.
+    std::vector<uint32_t> obstacle_slots_;     ///< First slot of each obstacle, followed by the total slot count.
+    std::vector<uint32_t> vertex_slots_;       ///< Slot of each graph vertex, ObstacleSet::no_slot for start and finish.
+    std::vector<uint32_t> vertex_obstacles_;   ///< Obstacle owning each graph vertex, UINT32_MAX for start and finish.
+    std::vector<int16_t> visibility_cache_;    ///< Triangular slot pair matrix of visibility results.
+    std::vector<bool> slot_valid_;             ///< Whether each slot is a graph vertex in the current build.
+
+    /// Static roadmap of the fixed obstacles.
+    StaticRoadmap roadmap_;                    ///< Visibility between the points of the fixed obstacles.
+    std::string roadmap_directory_;            ///< Directory of roadmap files, empty if none.
+    bool roadmap_active_ = false;              ///< Whether some obstacles of the set are in the roadmap.
+    std::vector<uint32_t> roadmap_obstacles_;  ///< Roadmap index of each obstacle of the set, UINT32_MAX if not fixed.
+    std::vector<uint32_t> roadmap_present_;    ///< Set index of each roadmap obstacle, UINT32_MAX if absent.
+    std::vector<uint32_t> roadmap_others_;     ///< Set indices of the obstacles that are not in the roadmap.
+
+    /// Time-budgeted planning state.
+    uint32_t point_stride_ = 1;                      ///< Stride between bounding box points used as graph vertices.
+    bool has_deadline_ = false;                      ///< Whether graph builds are bounded by deadline_.
+    std::chrono::steady_clock::time_point deadline_; ///< Time after which graph builds are interrupted.
+    std::atomic<bool> build_aborted_{false};         ///< Whether the last graph build was interrupted.
+    double full_build_duration_ = -1;                ///< Duration of the last full graph build in seconds, -1 if none.
+
+    std::unique_ptr<WorkerPool> worker_pool_;  ///< Workers for parallel builds, null when sequential.
+    std::vector<std::vector<std::tuple<uint32_t, uint32_t, double>>> worker_edges_; ///< Edges found by each worker.
+    std::vector<uint8_t> point_valid_;         ///< Whether each bounding box point is a valid vertex, per slot.
+
+    models::Vec2 start_pose_;  ///< The starting pose for path computation.
+    models::Vec2 finish_pose_; ///< The finishing pose for path computation.
+    models::Vec2 goal_pose_;   ///< The requested finishing pose, before any projection.
+
+    PlanningArena arena_; ///< Memory of the path temporaries, released at the start of each cycle.
+    std::array<models::Vec2, path_capacity> path_; ///< Path from start to finish excluded.
+    size_t path_size_ = 0; ///< Number of points in path_.
+    std::vector<models::Vec2> cached_path_; ///< Last optimal path, finish included, empty if none.
+    bool graph_path_ready_ = false;       ///< Whether path_vertices_ is a path to finish on the full graph, which is kept.
+    std::vector<std::vector<models::Vec2>> alternative_paths_; ///< Alternative paths, finish included, cheapest first.
+    std::vector<double> alternative_costs_;                    ///< Graph cost of each alternative path.
+    double alternative_max_overlap_ = default_alternative_max_overlap; ///< Part of an alternative allowed on kept edges.
+    std::vector<uint8_t> spur_removed_;   ///< Vertices of the root path, excluded from spur searches.
+    PathPostProcessing path_post_processing_ = PathPostProcessing::SHORTCUT; ///< Post-processing applied by avoidance().
+    std::vector<double> published_path_; ///< Last path computed by publish_path(), as [x, y] pairs.
+    std::vector<models::pose_order_t> published_poses_; ///< Last path published by publish_path().
     bool is_avoidance_computed_; ///< Flag indicating whether the path has been computed.
+    bool reach_nearest_goal_ = false; ///< Whether blocked finish poses are replaced by the nearest reachable point.
+    bool finish_projected_ = false;   ///< Whether finish_pose_ was projected out of obstacles or into table limits.
+    bool finish_blocked_ = false;     ///< Whether the projected finish pose is still unreachable.
+    bool goal_reached_ = true;        ///< Whether the last path leads to the requested finish pose.
+    bool time_aware_ = false;         ///< Whether edges are checked against moving obstacles.
+    double planning_speed_ = default_planning_speed;         ///< Robot speed used to predict traversal times.
+    double prediction_horizon_ = default_prediction_horizon; ///< Duration over which obstacle motion is predicted.
+    std::vector<uint32_t> moving_obstacles_; ///< Obstacles of the set moving faster than moving_speed_threshold.
 
     double *table_limits_; ///< The limits of the table.
     double table_limits_margin_;  ///< Margin inside the table limits.
 
     std::vector<std::reference_wrapper<obstacles::Obstacle>> dynamic_obstacles_; ///< List of dynamic obstacles.
+    ObstacleSet obstacle_set_;          ///< Copy of dynamic obstacles used by collision tests.
+    ObstacleGrid obstacle_grid_;        ///< Broad phase index over the obstacle set.
+    bool obstacle_set_dirty_ = true;    ///< Whether obstacles were added or removed since the set was built.
+
+    /// Obstacles loaded from shared memory.
+    /// The back snapshot is copied from the published lists, then swapped with the front one.
+    ObstacleSnapshot snapshots_[2];                        ///< Front and back obstacle snapshots.
+    size_t front_snapshot_ = 0;                            ///< Index of the last loaded snapshot.
+    bool snapshot_loaded_ = false;                         ///< Whether dynamic obstacles are the front snapshot.
+    uint64_t snapshot_generation_ = 0;                     ///< Obstacles generation of the front snapshot.
+    shared_memory::latency_frame_t obstacles_latency_frame_{};  ///< Detector frame of the last obstacles load.
+    std::vector<obstacles::compact_obstacle_circle_t> snapshot_circle_data_;     ///< Circles rebuilt from the snapshot.
+    std::vector<obstacles::compact_obstacle_polygon_t> snapshot_rectangle_data_; ///< Rectangles rebuilt from the snapshot.
+    std::deque<obstacles::CompactObstacleCircle> snapshot_circles_;              ///< Wrappers on snapshot_circle_data_.
+    std::deque<obstacles::CompactObstacleRectangle> snapshot_rectangles_;        ///< Wrappers on snapshot_rectangle_data_.
+
+    /// @brief Releases the path and the temporaries of the previous cycle.
+    void begin_cycle();
+
+    /// @brief Replaces the path.
+    /// @param points Path points, start included, finish excluded.
+    /// @param count Number of points.
+    /// @return False, leaving the path empty, if the points do not fit in the path.
+    bool set_path(const models::Vec2* points, size_t count);
+
+    /// @brief Validates start and finish poses and makes them the first graph vertices.
+    /// A start inside an obstacle is moved to the nearest point of the obstacle.
+    /// @param start The starting position.
+    /// @param finish The finishing position.
+    /// @return False if the finish pose is outside the table or inside an obstacle.
+    bool prepare_poses(const models::Coords& start, const models::Coords& finish);
 
-    /// @brief Validates the obstacle points and ensures they can be used for graph building.
+    /// @brief Computes the path with the grid engine, after prepare_poses().
+    /// @return True if a path was found, false otherwise.
+    bool grid_avoidance();
+
+    /// @brief Keeps the current path, finish included, for validate_cached_path().
+    void cache_path();
+
+    /// @brief Applies the selected post-processing to the path found on the graph.
+    void post_process_path();
+
+    /// @brief Builds the clearance field if obstacles changed since it was built.
+    void update_clearance_field();
+
+    /// @brief Cost of an edge, its length plus the clearance penalty if enabled.
+    /// The clearance field must be up to date when the penalty is enabled.
+    /// @param a First end of the edge.
+    /// @param b Second end of the edge.
+    /// @return The edge cost in mm.
+    double edge_cost(const models::Vec2& a, const models::Vec2& b) const;
+
+    /// @brief Checks whether a segment crosses no obstacle, its ends being compared to polygon points.
+    /// In time_aware() mode, the segment must also be clear of moving obstacles.
+    /// @param a First end of the segment.
+    /// @param b Second end of the segment.
+    /// @param departure Path length before the segment, giving the time the robot reaches A.
+    /// @return True if the segment is free.
+    bool is_segment_free(const models::Vec2& a, const models::Vec2& b, double departure = 0) const;
+
+    /// @brief Checks whether the robot meets no moving obstacle along a segment.
+    /// @param a First end of the segment.
+    /// @param b Second end of the segment.
+    /// @param departure Path length before the segment, giving the time the robot reaches A.
+    /// @return True if no moving obstacle is met, always true if time_aware() is disabled.
+    bool is_clear_of_moving_obstacles(const models::Vec2& a, const models::Vec2& b, double departure) const;
+
+    /// @brief Collects the moving obstacles of the set after it is rebuilt.
+    void update_moving_obstacles();
+
+    /// @brief Copies the computed path as [x, y] pairs, without duplicated points, followed by finish.
+    void copy_path(const models::Coords& finish, std::vector<double>& path) const;
+
+    /// @brief Rebuilds the obstacle set and its grid from dynamic obstacles if needed.
+    /// Obstacles loaded from shared memory only change on reload, while obstacles
+    /// added with add_dynamic_obstacle() may have moved: they are copied again on each call.
+    void update_obstacle_set();
+
+    /// @brief Sets the robot footprint of an obstacle set from the shared properties, a point robot if disabled.
+    /// @param obstacles The obstacle set, to rebuild if the footprint changed.
+    /// @return True if the footprint changed.
+    bool apply_footprint(ObstacleSet& obstacles) const;
+
+    /// @brief Checks which obstacle points are inside the table and outside any obstacle, into `point_valid_`.
+    void check_obstacle_points();
+
+    /// @brief Adds the valid obstacle points to the graph vertices, one out of `point_stride_` per obstacle.
     void validate_obstacle_points();
 
     /// @brief Builds the avoidance graph using the validated points.
-    void build_avoidance_graph();
-
-    /// @brief Prints the graph for debugging purposes.
+    /// If the deadline is reached, `build_aborted_` is set and the graph must not be searched.
+    /// @param check_points Check obstacle points first, false if `point_valid_` is up to date.
+    void build_avoidance_graph(bool check_points = true);
+
+    /// @brief Finds an obstacle crossed by the segment between two graph vertices.
+    /// Vertex slots are passed to the obstacle set, so the vertices are not compared to polygon points.
+    /// @param i First vertex of the segment.
+    /// @param j Second vertex of the segment.
+    /// @param changed_only Only test obstacles that changed since the previous build.
+    /// @return Index of the first crossed obstacle, or -1 if none.
+    int find_blocking_obstacle(uint32_t i, uint32_t j, bool changed_only = false);
+
+    /// @brief Matches the obstacles of the set with the static roadmap, loading it first if needed.
+    void update_roadmap();
+
+    /// @brief Finds an obstacle crossed by the segment between two vertices of fixed obstacles.
+    /// The roadmap gives the result for fixed obstacles, only other obstacles are tested, without the grid.
+    /// @param i First vertex of the segment.
+    /// @param j Second vertex of the segment.
+    /// @param[out] blocker Index of the first crossed obstacle, or -1 if none.
+    /// @return False if a vertex does not belong to a fixed obstacle, blocker is then not set.
+    bool find_blocking_obstacle_from_roadmap(uint32_t i, uint32_t j, int& blocker);
+
+    /// @brief Compares obstacles with the previous build and invalidates the visibility cache accordingly.
+    void update_obstacle_cache();
+
+    /// @brief Tests the segments from vertices [begin, end) to every following vertex.
+    /// In incremental mode, cached visibility results between obstacle vertices are reused and updated.
+    /// @param begin First vertex.
+    /// @param end Vertex after the last one.
+    /// @param edges Collected free edges.
+    void build_edges(size_t begin, size_t end, std::vector<std::tuple<uint32_t, uint32_t, double>>& edges);
+
+    /// @brief Invalidates cached visibility results between slots that are not graph vertices.
+    void invalidate_unused_slots();
+
+    /// @brief Runs a loop on the worker pool, or sequentially if there is none.
+    void parallel_for(size_t count, size_t chunk, const WorkerPool::Task& task);
+
+    /// @brief Prints the graph for debugging purposes, only if the debug level is enabled.
     void print_graph();
 
-    /// @brief Prints the computed path for debugging purposes.
+    /// @brief Prints the computed path for debugging purposes, only if the debug level is enabled.
     void print_path();
 
-    /// @brief Prints the parent map used in pathfinding algorithms.
-    /// @param parent The map of parent nodes.
-    void print_parents(const std::map<int, int>& parent);
+    /// @brief Prints the parent array used in pathfinding algorithms, only if the debug level is enabled.
+    /// @param parents The parent of each vertex, -1 if none.
+    void print_parents(const std::vector<int>& parents);
+
+    /// @brief Packs the collected edges into the CSR arrays.
+    void pack_graph();
 
     /// @brief Executes Dijkstra's algorithm on the graph to find the shortest path.
+    /// Runs A* instead when selected with set_search_algorithm().
     /// @return True if a path was found, false otherwise.
     bool dijkstra();
 
+    /// @brief Weight of the graph edge between two vertices.
+    /// @return The weight, infinity if the vertices are not adjacent.
+    double graph_edge_weight(uint32_t a, uint32_t b) const;
+
+    /// @brief Runs A* from a spur vertex of Yen's algorithm to the finish vertex.
+    /// Vertices marked in `spur_removed_` are skipped, as the edges from the spur vertex to the blocked neighbors.
+    /// @param spur The spur vertex.
+    /// @param departure Path cost before the spur vertex, giving the times moving obstacles are checked at.
+    /// @param blocked Neighbors of the spur vertex not to go to.
+    /// @param[out] vertices Path from the spur vertex to finish, both included.
+    /// @return True if finish was reached.
+    bool spur_search(uint32_t spur, double departure, const std::vector<uint32_t>& blocked, std::vector<uint32_t>& vertices);
+
+    /// @brief Runs Dijkstra's algorithm from a vertex to every vertex of the graph.
+    /// Leading vertices other than the source are path ends only, they are not expanded.
+    /// Distances are left in `distances_`, infinity for unreachable vertices.
+    /// @param source The source vertex.
+    void single_source_distances(uint32_t source);
+
+    /// @brief Projects a point inside the table limits.
+    /// @param point The point to project.
+    /// @return The nearest point within the table limits.
+    models::Vec2 nearest_point_in_table_limits(const models::Vec2& point) const;
+
     /// @brief Checks if a point is within the table limits.
     /// @param point The coordinates of the point to check.
     /// @return True if the point is within the table limits, false otherwise.
-    bool is_point_in_table_limits(const models::Coords& point) const
+    bool is_point_in_table_limits(const models::Vec2& point) const
+    {
+        return is_point_in_table_limits(point.x, point.y);
+    }
+
+    /// @brief Checks if a point is within the table limits.
+    /// @param x X coordinate of the point to check.
+    /// @param y Y coordinate of the point to check.
+    /// @return True if the point is within the table limits, false otherwise.
+    bool is_point_in_table_limits(double x, double y) const
     {
         return (
-            (table_limits_[0] + table_limits_margin_ < point.x() &&
-            point.x() < table_limits_[1] - table_limits_margin_) &&
-            (table_limits_[2] + table_limits_margin_ < point.y() &&
-            point.y() < table_limits_[3] - table_limits_margin_)
+            (table_limits_[0] + table_limits_margin_ < x &&
+            x < table_limits_[1] - table_limits_margin_) &&
+            (table_limits_[2] + table_limits_margin_ < y &&
+            y < table_limits_[3] - table_limits_margin_)
         );
     }
 };
@@ -0,0 +1,180 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Native avoidance loop publishing paths in shared memory.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Project includes
+#include "avoidance/Avoidance.hpp"
+#include "models/pose.hpp"
+#include "models/pose_order.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Avoidance strategies, matching `AvoidanceStrategy` of the planner.
+enum class AvoidanceStrategy : uint8_t {
+    Disabled = 0,     ///< Go straight to the pose order.
+    StopAndGo = 1,    ///< Go straight to the pose order if no obstacle is on the way, otherwise wait.
+    AvoidanceCpp = 2, ///< Avoid obstacles using the visibility graph.
+    AvoidanceGrid = 3 ///< Avoid obstacles using lazy Theta* on an obstacle raster.
+};
+
+/// @brief Native thread running the avoidance loop of the planner avoidance process.
+///
+/// Each cycle reads the pose order and current pose from shared memory, takes a
+/// snapshot of the obstacles, computes a path and publishes it in `avoidance_path`,
+/// or posts an `AvoidanceBlocked` event if no path is found.
+/// Cycles are triggered by `Obstacles` updates, or by `path_refresh_interval` timeouts.
+///
+/// Between cycles, a reflex thread checks each new lidar scan against the segment from the current pose
+/// to the first pose of the published path: if a lidar point is within the reflex clearance of it,
+/// an `AvoidanceBlocked` event is posted at once and the next cycle computes a new path,
+/// without waiting for the detector to publish the point as an obstacle.
+///
+/// Each path found on the full visibility graph comes with alternative paths going around obstacles another way.
+/// When the published path is blocked, the service switches at once to the first alternative still free,
+/// also clear of the lidar points if the reflex is enabled, and the next cycle computes the best path again.
+class AvoidanceService
+{
+public:
+    /// @brief Constructor.
+    /// @param name Name of the shared memory segment.
+    AvoidanceService(const std::string& name);
+
+    /// @brief Constructor on a shared memory of the process, usually an in-process one
+    /// shared with the drivers and the converter of an in-process pipeline.
+    /// The service waits for updates on the Obstacles and LidarCoords locks of this instance,
+    /// no other consumer may wait on them through the same instance.
+    /// @param shared_memory Shared memory, it must outlive the service.
+    AvoidanceService(shared_memory::SharedMemory& shared_memory);
+
+    /// @brief Destructor, stops the thread if running.
+    ~AvoidanceService();
+
+    /// @brief Starts the avoidance thread.
+    void start();
+
+    /// @brief Stops the avoidance thread and waits for it to exit.
+    void stop();
+
+    /// @brief Checks whether the avoidance thread is running.
+    bool is_running() const { return running_; }
+
+    /// @brief Access to the underlying avoidance instance to tune it before start().
+    Avoidance& avoidance() { return avoidance_; }
+
+    /// @brief Enables or disables debug messages.
+    void set_debug(bool debug) { debug_ = debug; }
+
+    /// @brief Enables or disables the check of the published path against the lidar points, enabled by default.
+    void set_reflex(bool enabled) { reflex_enabled_ = enabled; }
+
+    /// @brief Sets the distance to the path below which a lidar point blocks it (mm).
+    /// @param clearance Clearance, 0 to use half the robot width.
+    void set_reflex_clearance(double clearance) { reflex_clearance_ = clearance; }
+
+    /// @brief Sets the number of paths computed with each path on the full visibility graph, itself included.
+    /// @param count Number of paths, 0 or 1 to disable the switch to alternative paths.
+    void set_alternative_count(size_t count) { alternative_count_ = count; }
+
+    static constexpr size_t default_alternative_count = 3;  ///< Default number of paths computed with each path.
+
+private:
+    /// Result of a path computation.
+    enum class PathStatus {
+        Found,     ///< A new path is available in path_.
+        Blocked,   ///< No path to the pose order.
+        Unchanged  ///< The last published path is still valid.
+    };
+
+    /// Constructor using either a given shared memory or its own one.
+    AvoidanceService(
+        shared_memory::SharedMemory* shared_memory,
+        std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory
+    );
+
+    std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory_;  ///< Shared memory mapped by the service, if any.
+    shared_memory::SharedMemory& shared_memory_;         ///< Shared memory instance, also used by avoidance_.
+    shared_memory::shared_data_t* data_;                 ///< Shared data.
+    shared_memory::shared_properties_t& properties_;     ///< Shared properties.
+    shared_memory::WritePriorityLock& obstacles_lock_;   ///< Lock of the obstacle lists, waited for updates.
+    shared_memory::WritePriorityLock& blocked_lock_;     ///< Lock used to post AvoidanceBlocked events.
+    shared_memory::WritePriorityLock& lidar_coords_lock_;  ///< Lock of the lidar points, waited for by the reflex thread.
+    Avoidance avoidance_;                                ///< Path computation.
+
+    std::thread thread_;                 ///< Avoidance thread.
+    std::atomic<bool> running_{false};   ///< True while the thread must keep running.
+    bool debug_ = false;                 ///< Debug flag for logging.
+
+    std::thread reflex_thread_;                 ///< Thread checking the published path against the lidar points.
+    std::atomic<bool> reflex_enabled_{true};    ///< Whether the reflex thread checks the path.
+    std::atomic<double> reflex_clearance_{0};   ///< Clearance of the path (mm), 0 for half the robot width.
+    std::atomic<bool> reflex_blocked_{false};   ///< Set by the reflex thread when the path is blocked.
+    std::mutex reflex_mutex_;                   ///< Protects the reflex target.
+    bool has_reflex_target_ = false;            ///< Whether reflex_target_ is set.
+    models::pose_order_t reflex_target_{};      ///< First pose of the published path, checked by the reflex thread.
+    std::atomic<size_t> alternative_count_{default_alternative_count};  ///< Number of paths computed with each path.
+
+    /// Loop state, only accessed from the avoidance thread.
+    bool has_pose_order_ = false;                 ///< Whether pose_order_ is set.
+    models::pose_order_t pose_order_{};           ///< Current pose order.
+    bool has_last_pose_current_ = false;          ///< Whether last_pose_current_ is set.
+    models::pose_t last_pose_current_{};          ///< Current pose when the last path was published.
+    bool has_last_emitted_ = false;               ///< Whether last_emitted_ is set.
+    models::pose_order_t last_emitted_{};         ///< First pose of the last published path.
+    bool refine_path_ = false;                    ///< Whether the published path is an alternative to compute again.
+
+    std::vector<double> path_points_;                ///< Computed path as [x, y] pairs.
+    std::vector<models::pose_order_t> path_;         ///< Computed path, starting at the current pose.
+
+    /// Body of the avoidance thread.
+    void run();
+
+    /// Body of the reflex thread.
+    void run_reflex();
+
+    /// Distance to the path below which a lidar point blocks it (mm).
+    double reflex_clearance() const;
+
+    /// Switches to the first alternative path still free into path_points_.
+    /// @return True if an alternative path is available.
+    bool switch_to_alternative_path(const models::Coords& current);
+
+    /// Sets the pose checked by the reflex thread.
+    void set_reflex_target(const models::pose_order_t& target);
+
+    /// Runs one avoidance cycle.
+    void cycle();
+
+    /// Computes the path for the current strategy into path_.
+    PathStatus compute_path(const models::pose_t& pose_current);
+
+    /// Replaces the end of path_ to stop before the pose order.
+    void apply_stop_before_distance();
+
+    /// Resets the state tracking the last published path, and stops checking it.
+    void reset_last_path();
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,102 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Distance to the nearest obstacle over the table.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Project includes
+#include "avoidance/ObstacleSet.hpp"
+#include "models/Vec2.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Distance from each cell of the table to the nearest obstacle cell.
+///
+/// The table is divided in square cells, occupied when their center is inside an obstacle of the set,
+/// so the distances include the footprint of the set. The exact Euclidean distance transform
+/// runs in two passes: distances along columns, as branch-free loops over whole rows
+/// so the compiler can vectorize them, then the lower envelope of parabolas along each row.
+/// The field is rebuilt only when the obstacles change. Its cost is linear in the number of cells,
+/// and queries cost one lookup, so sampling a segment costs O(length / cell size).
+/// Queries are const, so they can be called from several threads.
+class ClearanceField
+{
+public:
+    static constexpr double default_cell_size = 20.0; ///< Default cell side length in mm.
+
+    /// @brief Retrieves the cell side length in mm.
+    double cell_size() const { return cell_size_; }
+
+    /// @brief Sets the cell side length, which invalidates the field.
+    /// @param cell_size Cell side length in mm.
+    void set_cell_size(double cell_size);
+
+    /// @brief Marks the field as outdated, to rebuild it before the next query.
+    void invalidate() { built_ = false; }
+
+    /// @brief Checks whether the field is up to date.
+    bool is_built() const { return built_; }
+
+    /// @brief Computes the field of the obstacles over the table limits.
+    /// @param obstacles The obstacles.
+    /// @param x_min Lower X limit of the table.
+    /// @param x_max Upper X limit of the table.
+    /// @param y_min Lower Y limit of the table.
+    /// @param y_max Upper Y limit of the table.
+    void build(const ObstacleSet& obstacles, double x_min, double x_max, double y_min, double y_max);
+
+    /// @brief Distance from a point to the nearest obstacle, measured between cell centers.
+    /// @param p The point.
+    /// @return Distance in mm, 0 inside an obstacle or outside the table limits.
+    double distance(const models::Vec2& p) const;
+
+    /// @brief Integrates the clearance penalty along segment [AB].
+    /// The penalty of a point is `1 - distance / clearance` below `clearance`, 0 beyond.
+    /// It is sampled at the middle of each cell-sized part of the segment.
+    /// @param a First end of the segment.
+    /// @param b Second end of the segment.
+    /// @param clearance Distance from which points have no penalty, in mm.
+    /// @return Integral of the penalty along the segment, in mm, between 0 and the segment length.
+    double penalty(const models::Vec2& a, const models::Vec2& b, double clearance) const;
+
+    /// @brief Number of cells along X.
+    int cols() const { return cols_; }
+
+    /// @brief Number of cells along Y.
+    int rows() const { return rows_; }
+
+private:
+    double cell_size_ = default_cell_size; ///< Cell side length.
+    double x_min_ = 0;                     ///< Lower X bound of the field.
+    double y_min_ = 0;                     ///< Lower Y bound of the field.
+    int cols_ = 0;                         ///< Number of cells along X.
+    int rows_ = 0;                         ///< Number of cells along Y.
+    bool built_ = false;                   ///< Whether the field matches the current obstacles.
+
+    std::vector<uint8_t> occupied_;  ///< Whether each cell center is inside an obstacle, row-major.
+    std::vector<double> column_;     ///< Distance along its column to the nearest occupied cell, in cells.
+    std::vector<float> distances_;   ///< Distance of each cell to the nearest occupied cell, in mm.
+    std::vector<double> row_;        ///< Squared column distances of the row being transformed.
+    std::vector<int> envelope_;      ///< Parabolas of the lower envelope of the row.
+    std::vector<double> bounds_;     ///< Boundaries between the parabolas of the envelope.
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,191 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Native GOAP search of the best sequence of game actions.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Project includes
+#include "avoidance/WorkerPool.hpp"
+#include "models/Vec2.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+class Avoidance;
+
+/// @brief Compact description of a game action for the GOAP search.
+///
+/// The planner measures each action once from the current game state,
+/// the search then assumes its reward and duration do not depend on the actions done before.
+/// Dependencies between actions are described by bits of a world state.
+struct GoapAction {
+    std::vector<models::Vec2> poses;  ///< Poses reached in order by the action.
+    double duration = 0;              ///< Time spent by the action besides travelling between its poses (s).
+    double reward = 0;                ///< Score earned by the action.
+    double weight = 0;                ///< Weight of the action, to choose between plans of the same reward.
+    uint64_t required = 0;            ///< World bits which must be set to start the action.
+    uint64_t sets = 0;                ///< World bits set by the action.
+    uint64_t clears = 0;              ///< World bits cleared by the action.
+    bool first_allowed = true;        ///< Whether the action can start a plan, false for recycled actions.
+};
+
+/// @brief Result of a GOAP search.
+struct GoapPlan {
+    std::vector<size_t> actions;  ///< Indexes of the actions of the best plan, in order, empty if no action is possible.
+    double reward = 0;            ///< Total reward of the plan.
+    double time = 0;              ///< Time needed by the plan (s).
+    size_t expanded_nodes = 0;    ///< Number of search nodes expanded.
+    size_t depth = 0;             ///< Depth fully searched.
+    bool complete = false;        ///< Whether the search reached the requested depth within the budget.
+};
+
+/// @brief Best-first GOAP search over the sequences of game actions.
+///
+/// A search state packs the set of done actions in a 64-bit mask, the world bits,
+/// the position of the robot (the last pose of the last action) and the first action of the plan.
+/// The tree is expanded level by level, one action per level, the nodes of a level being handed out
+/// to the workers of the pool in small chunks, so workers done early take over the remaining nodes.
+/// A transposition table merges the sequences reaching the same state and keeps the fastest one:
+/// they earn the same reward and have the same future, so the choice of the first action stays exact.
+/// Workers file their children by shard of the state hash without locking, then shards are merged in parallel.
+/// Children of the last level are only compared to the best plan, they are never stored.
+/// An optional beam keeps only the most rewarding nodes of each level.
+///
+/// Travel times come from a matrix of path lengths between all poses,
+/// computed once per decision by the batch path cost oracle of Avoidance, straight lines by default.
+/// A plan is scored like the Python evaluation: highest reward, then highest weight of its first action.
+class GoapPlanner
+{
+public:
+    static constexpr size_t max_actions = 64;         ///< Maximum number of actions, the size of the done mask.
+    static constexpr double default_average_speed = 100.0;  ///< Average robot speed of Action.evaluate() (mm/s).
+
+    /// @brief Constructor.
+    /// @param workers Number of workers including the calling thread, 0 for one per core.
+    explicit GoapPlanner(size_t workers = 0);
+
+    /// @brief Adds an action.
+    /// @return Index of the action.
+    /// @throws std::invalid_argument if there are already max_actions actions.
+    size_t add_action(const GoapAction& action);
+
+    /// @brief Removes all actions.
+    void clear_actions();
+
+    /// @brief Retrieves the number of actions.
+    size_t action_count() const { return actions_.size(); }
+
+    /// @brief Sets the position of the robot at the start of the plans.
+    void set_start(const models::Vec2& start);
+
+    /// @brief Replaces the straight line lengths between the start and all action poses by path lengths
+    /// avoiding the obstacles loaded in the avoidance, with a single graph build.
+    /// Pairs without path keep their straight line length.
+    /// Costs are reset by set_start(), add_action() and clear_actions().
+    void compute_costs(Avoidance& avoidance);
+
+    /// @brief Sets the average robot speed converting path lengths into times (mm/s).
+    /// @throws std::invalid_argument if it is not positive.
+    void set_average_speed(double speed);
+
+    /// @brief Retrieves the maximum number of nodes kept at each level, 0 if unlimited.
+    size_t beam_width() const { return beam_width_; }
+
+    /// @brief Sets the maximum number of nodes kept at each level, 0 to search all sequences.
+    void set_beam_width(size_t width) { beam_width_ = width; }
+
+    /// @brief Retrieves the number of workers, including the calling thread.
+    size_t worker_count() const { return worker_pool_ ? worker_pool_->size() : 1; }
+
+    /// @brief Sets the number of workers.
+    /// @param count Number of workers including the calling thread, 0 for one per core.
+    void set_worker_count(size_t count);
+
+    /// @brief Searches the best sequence of actions.
+    /// Actions are only started while the countdown is not over, as in the Python evaluation.
+    /// If the budget is spent, the best plan among the nodes already expanded is returned.
+    /// @param world World bits at the start.
+    /// @param countdown Remaining game time (s).
+    /// @param depth Maximum number of actions of a plan.
+    /// @param budget Time budget of the search (s), 0 or negative for no limit.
+    GoapPlan search(uint64_t world, double countdown, size_t depth, double budget);
+
+private:
+    /// Search node.
+    struct Node {
+        uint64_t done;      ///< Mask of done actions.
+        uint64_t world;     ///< World bits.
+        double time;        ///< Time since the start (s).
+        double reward;      ///< Reward since the start.
+        uint32_t parent;    ///< Index of the parent in the previous level.
+        uint16_t action;    ///< Last action.
+        uint16_t position;  ///< Point where the robot stands.
+        uint16_t first;     ///< First action of the plan.
+    };
+
+    static constexpr size_t shard_bits = 6;                 ///< Bits of the state hash selecting a shard.
+    static constexpr size_t shard_count = 1 << shard_bits;  ///< Number of shards of the transposition table.
+
+    std::vector<GoapAction> actions_;     ///< Actions.
+    std::vector<models::Vec2> points_;    ///< Start, then the poses of all actions.
+    std::vector<size_t> action_points_;   ///< Index in points_ of the first pose of each action, then the end.
+    std::vector<double> costs_;           ///< Row-major path lengths between points_, empty for straight lines.
+    std::vector<double> entry_costs_;     ///< Travel time to the first pose of each action from each position.
+    std::vector<double> action_times_;    ///< Time of each action from its first pose to its end (s).
+    double average_speed_ = default_average_speed;  ///< Average robot speed (mm/s).
+    size_t beam_width_ = 0;               ///< Maximum number of nodes kept at each level, 0 if unlimited.
+    std::unique_ptr<WorkerPool> worker_pool_;  ///< Workers expanding the levels, null if sequential.
+
+    std::vector<std::vector<Node>> levels_;          ///< Nodes kept at each level.
+    std::vector<std::vector<Node>> worker_children_; ///< Children created by each worker for each shard.
+    std::vector<std::vector<Node>> shard_nodes_;     ///< Fastest child of each state of each shard.
+    std::vector<Node> worker_best_;                  ///< Best child of the last level found by each worker.
+    std::vector<std::vector<uint32_t>> shard_tables_;  ///< Open addressing tables of the states of each shard.
+
+    /// Path length between two points.
+    double cost(size_t from, size_t to) const;
+
+    /// Position of the robot after an action.
+    uint16_t end_position(size_t action, uint16_t position) const;
+
+    /// Computes the travel and action times used by the search.
+    void prepare_times();
+
+    /// Expands a node into the children of a worker.
+    /// Children of the last level are not kept, only the best one of each worker.
+    void expand(const Node& node, uint32_t index, size_t worker, size_t depth, double countdown, bool last);
+
+    /// Keeps the fastest child of each state of a shard in shard_nodes_.
+    void merge_shard(size_t shard);
+
+    /// Hash of the state of a node: done actions, world bits, position and first action.
+    static uint64_t state_hash(const Node& node);
+
+    /// Whether two nodes have the same state.
+    static bool same_state(const Node& a, const Node& b) {
+        return a.done == b.done && a.world == b.world && a.position == b.position && a.first == b.first;
+    }
+
+    /// Whether a node makes a better plan than another.
+    bool better_plan(const Node& a, const Node& b) const;
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,131 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Any-angle path planning on an obstacle raster (lazy Theta*).
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Project includes
+#include "avoidance/IndexedHeap.hpp"
+#include "avoidance/ObstacleSet.hpp"
+#include "models/Vec2.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Lazy Theta* planner on a raster of the obstacles.
+///
+/// The table is divided in square cells, blocked when their center is inside an obstacle
+/// or outside the table limits. The raster is a bitset, rebuilt only when the obstacles change.
+/// Paths go from cell center to cell center along any angle, with line of sight tested
+/// by Bresenham traversals of the raster, so the search cost depends on the grid size only,
+/// not on the number of obstacles or of their bounding box points.
+/// Search buffers are kept between searches and only grow.
+class GridPlanner
+{
+public:
+    static constexpr double default_cell_size = 20.0; ///< Default cell side length in mm.
+
+    /// @brief Retrieves the cell side length in mm.
+    double cell_size() const { return cell_size_; }
+
+    /// @brief Sets the cell side length, which invalidates the raster.
+    /// Obstacles thinner than a cell may be missed by the raster, smaller cells increase the search cost.
+    /// @param cell_size Cell side length in mm.
+    void set_cell_size(double cell_size);
+
+    /// @brief Marks the raster as outdated, to rebuild it before the next search.
+    void invalidate() { built_ = false; }
+
+    /// @brief Checks whether the raster is up to date.
+    bool is_built() const { return built_; }
+
+    /// @brief Rasterizes the obstacles over the table limits.
+    /// @param obstacles The obstacles.
+    /// @param x_min Lower X limit of the table.
+    /// @param x_max Upper X limit of the table.
+    /// @param y_min Lower Y limit of the table.
+    /// @param y_max Upper Y limit of the table.
+    void build(const ObstacleSet& obstacles, double x_min, double x_max, double y_min, double y_max);
+
+    /// @brief Searches a path between two points with lazy Theta*.
+    /// The cells of start and finish are considered free, so the robot can leave a cell
+    /// blocked by the margin of an obstacle it is touching.
+    /// @param start The starting point.
+    /// @param finish The finishing point.
+    /// @param[out] path Path points, start and finish included, empty if no path is found.
+    /// @return True if a path was found, false otherwise.
+    bool find_path(const models::Vec2& start, const models::Vec2& finish, std::vector<models::Vec2>& path);
+
+    /// @brief Number of cells along X.
+    int cols() const { return cols_; }
+
+    /// @brief Number of cells along Y.
+    int rows() const { return rows_; }
+
+    /// @brief Checks whether a cell is blocked.
+    /// @param cx Column of the cell.
+    /// @param cy Row of the cell.
+    bool is_blocked(int cx, int cy) const
+    {
+        size_t cell = static_cast<size_t>(cy) * cols_ + cx;
+        return (raster_[cell >> 6] >> (cell & 63)) & 1;
+    }
+
+private:
+    double cell_size_ = default_cell_size; ///< Cell side length.
+    double x_min_ = 0;                     ///< Lower X bound of the raster.
+    double y_min_ = 0;                     ///< Lower Y bound of the raster.
+    int cols_ = 0;                         ///< Number of cells along X.
+    int rows_ = 0;                         ///< Number of cells along Y.
+    bool built_ = false;                   ///< Whether the raster matches the current obstacles.
+
+    std::vector<uint64_t> raster_;  ///< One bit per cell, set if blocked.
+    std::vector<double> g_;         ///< Path length from start to each cell.
+    std::vector<uint32_t> parents_; ///< Parent of each cell, in line of sight.
+    std::vector<uint8_t> closed_;   ///< Whether each cell was expanded.
+    IndexedHeap open_set_;          ///< Cells to expand, by estimated path length.
+
+    uint32_t start_cell_ = 0;  ///< Cell of the current start.
+    uint32_t finish_cell_ = 0; ///< Cell of the current finish.
+    models::Vec2 start_;       ///< Current start, used in place of the center of its cell.
+    models::Vec2 finish_;      ///< Current finish, used in place of the center of its cell.
+
+    /// @brief Marks a cell as blocked.
+    void block(int cx, int cy)
+    {
+        size_t cell = static_cast<size_t>(cy) * cols_ + cx;
+        raster_[cell >> 6] |= uint64_t(1) << (cell & 63);
+    }
+
+    /// @brief Checks whether a cell can be crossed by the current search.
+    bool is_free(int cx, int cy) const;
+
+    /// @brief Position of a cell in the current search: its center, or start or finish.
+    models::Vec2 point(uint32_t cell) const;
+
+    /// @brief Checks the line of sight between two cells by a Bresenham traversal.
+    /// Diagonal steps also require the two cells sharing the crossed corner to be free.
+    bool line_of_sight(uint32_t from, uint32_t to) const;
+
+    /// @brief Gives a cell the best parent among its expanded neighbors if it has no line of sight to its parent.
+    void set_vertex(uint32_t cell);
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,130 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Indexed binary min-heap used by the graph searches.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Binary min-heap over vertex indices [0, capacity) with decrease-key support.
+///
+/// Keys and heap positions are stored in plain vectors indexed by vertex,
+/// so a vertex can be re-prioritized in O(log V) without duplicate entries.
+/// Buffers are kept between searches and only grow.
+class IndexedHeap
+{
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max(); ///< Position of a vertex not in the heap.
+
+    /// @brief Empties the heap and prepares it for vertices in [0, capacity).
+    /// @param capacity Number of vertices.
+    void reset(size_t capacity)
+    {
+        heap_.clear();
+        positions_.assign(capacity, npos);
+        keys_.resize(capacity);
+    }
+
+    /// @brief Checks whether the heap is empty.
+    bool empty() const { return heap_.empty(); }
+
+    /// @brief Inserts a vertex, or lowers its key if it is already queued with a higher one.
+    /// @param vertex The vertex index.
+    /// @param key The new priority.
+    void push(uint32_t vertex, double key)
+    {
+        if (positions_[vertex] == npos) {
+            positions_[vertex] = heap_.size();
+            heap_.push_back(vertex);
+        }
+        else if (key >= keys_[vertex]) {
+            return;
+        }
+        keys_[vertex] = key;
+        sift_up(positions_[vertex]);
+    }
+
+    /// @brief Removes and returns the vertex with the lowest key.
+    /// The heap must not be empty.
+    uint32_t pop()
+    {
+        uint32_t top = heap_.front();
+        positions_[top] = npos;
+        uint32_t last = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            heap_[0] = last;
+            positions_[last] = 0;
+            sift_down(0);
+        }
+        return top;
+    }
+
+private:
+    std::vector<uint32_t> heap_;      ///< Binary heap of vertex indices.
+    std::vector<uint32_t> positions_; ///< Position of each vertex in heap_, npos if absent.
+    std::vector<double> keys_;        ///< Priority of each queued vertex.
+
+    void place(size_t index, uint32_t vertex)
+    {
+        heap_[index] = vertex;
+        positions_[vertex] = index;
+    }
+
+    void sift_up(size_t index)
+    {
+        uint32_t vertex = heap_[index];
+        double key = keys_[vertex];
+        while (index > 0) {
+            size_t parent = (index - 1) / 2;
+            if (keys_[heap_[parent]] <= key) {
+                break;
+            }
+            place(index, heap_[parent]);
+            index = parent;
+        }
+        place(index, vertex);
+    }
+
+    void sift_down(size_t index)
+    {
+        uint32_t vertex = heap_[index];
+        double key = keys_[vertex];
+        size_t size = heap_.size();
+        while (true) {
+            size_t child = 2 * index + 1;
+            if (child >= size) {
+                break;
+            }
+            if (child + 1 < size && keys_[heap_[child + 1]] < keys_[heap_[child]]) {
+                child++;
+            }
+            if (key <= keys_[heap_[child]]) {
+                break;
+            }
+            place(index, heap_[child]);
+            index = child;
+        }
+        place(index, vertex);
+    }
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
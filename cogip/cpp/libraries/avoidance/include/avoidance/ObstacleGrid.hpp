@@ -0,0 +1,172 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Uniform grid over obstacles, used as broad phase for segment queries.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Project includes
+#include "avoidance/ObstacleSet.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Uniform grid indexing obstacles by the bounding square of their circumscribed circle.
+///
+/// The grid covers the union of all obstacle squares, so any part of a segment
+/// outside the grid cannot cross an obstacle.
+/// Cell contents are stored in CSR layout and buffers are reused between builds.
+class ObstacleGrid
+{
+public:
+    static constexpr int max_cells_per_axis = 64; ///< Upper bound of the grid resolution.
+
+    /// @brief Rebuilds the grid from the current obstacle positions.
+    /// @param obstacles The obstacles to index. Indices passed to visitors refer to this set.
+    void build(const ObstacleSet& obstacles);
+
+    /// @brief Calls a visitor once for each obstacle whose cells are crossed by segment [AB].
+    /// Obstacles are visited in traversal order from A to B.
+    /// The visitor takes the obstacle index and returns true to stop the traversal.
+    /// This method is const and keeps no per-query state, so it can be called from several threads.
+    /// @param ax X coordinate of point A.
+    /// @param ay Y coordinate of point A.
+    /// @param bx X coordinate of point B.
+    /// @param by Y coordinate of point B.
+    /// @param visit The visitor.
+    /// @return True if the visitor stopped the traversal, false otherwise.
+    template<typename Visitor>
+    bool visit_segment(double ax, double ay, double bx, double by, Visitor visit) const
+    {
+        if (cols_ == 0) {
+            return false;
+        }
+
+        // Clip the segment to the grid bounds (Liang-Barsky).
+        double dx = bx - ax;
+        double dy = by - ay;
+        double t0 = 0.0;
+        double t1 = 1.0;
+        if (!clip(-dx, ax - x_min_, t0, t1) || !clip(dx, x_max_ - ax, t0, t1) ||
+            !clip(-dy, ay - y_min_, t0, t1) || !clip(dy, y_max_ - ay, t0, t1)) {
+            return false;
+        }
+
+        // Walk the cells crossed by the clipped segment (Amanatides-Woo).
+        double sx = (ax + t0 * dx - x_min_) * inv_cell_size_;
+        double sy = (ay + t0 * dy - y_min_) * inv_cell_size_;
+        double ex = (ax + t1 * dx - x_min_) * inv_cell_size_;
+        double ey = (ay + t1 * dy - y_min_) * inv_cell_size_;
+        int cx = clamp_cell(sx, cols_);
+        int cy = clamp_cell(sy, rows_);
+        int last_cx = clamp_cell(ex, cols_);
+        int last_cy = clamp_cell(ey, rows_);
+        int step_x = (dx > 0) ? 1 : -1;
+        int step_y = (dy > 0) ? 1 : -1;
+        double gdx = ex - sx;
+        double gdy = ey - sy;
+        double t_delta_x = (gdx != 0) ? std::abs(1.0 / gdx) : INFINITY;
+        double t_delta_y = (gdy != 0) ? std::abs(1.0 / gdy) : INFINITY;
+        double t_max_x = (gdx != 0) ? ((step_x > 0 ? (cx + 1 - sx) : (sx - cx)) * t_delta_x) : INFINITY;
+        double t_max_y = (gdy != 0) ? ((step_y > 0 ? (cy + 1 - sy) : (sy - cy)) * t_delta_y) : INFINITY;
+
+        int prev_cx = -1;
+        int prev_cy = -1;
+        int max_steps = cols_ + rows_ + 2;
+        while (max_steps-- > 0) {
+            size_t cell = static_cast<size_t>(cy) * cols_ + cx;
+            for (uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; i++) {
+                uint32_t index = cell_items_[i];
+                // A segment crosses the cell rectangle of an obstacle in consecutive cells:
+                // skip the obstacle if it was already reported in the previous cell.
+                const CellRange& range = ranges_[index];
+                if (range.contains(prev_cx, prev_cy)) {
+                    continue;
+                }
+                if (visit(index)) {
+                    return true;
+                }
+            }
+            if (cx == last_cx && cy == last_cy) {
+                break;
+            }
+            prev_cx = cx;
+            prev_cy = cy;
+            if (t_max_x < t_max_y) {
+                cx += step_x;
+                t_max_x += t_delta_x;
+            }
+            else {
+                cy += step_y;
+                t_max_y += t_delta_y;
+            }
+            if (cx < 0 || cx >= cols_ || cy < 0 || cy >= rows_) {
+                break;
+            }
+        }
+        return false;
+    }
+
+private:
+    /// Inclusive range of cells covered by an obstacle.
+    struct CellRange {
+        int x0, y0, x1, y1;
+        bool contains(int x, int y) const { return x0 <= x && x <= x1 && y0 <= y && y <= y1; }
+    };
+
+    double x_min_ = 0;          ///< Grid lower X bound.
+    double y_min_ = 0;          ///< Grid lower Y bound.
+    double x_max_ = 0;          ///< Grid upper X bound.
+    double y_max_ = 0;          ///< Grid upper Y bound.
+    double inv_cell_size_ = 0;  ///< Inverse of the cell side length.
+    int cols_ = 0;              ///< Number of cells along X.
+    int rows_ = 0;              ///< Number of cells along Y.
+
+    std::vector<uint32_t> cell_offsets_; ///< Index of the first item of each cell (cell count + 1 entries).
+    std::vector<uint32_t> cell_items_;   ///< Obstacle indices, grouped by cell.
+    std::vector<uint32_t> cell_cursors_; ///< Per-cell write position used while building.
+    std::vector<CellRange> ranges_;      ///< Cells covered by each obstacle.
+
+    /// Clip step of the Liang-Barsky algorithm.
+    static bool clip(double p, double q, double& t0, double& t1)
+    {
+        if (p == 0) {
+            return q >= 0;
+        }
+        double t = q / p;
+        if (p < 0) {
+            if (t > t1) return false;
+            t0 = std::max(t0, t);
+        }
+        else {
+            if (t < t0) return false;
+            t1 = std::min(t1, t);
+        }
+        return true;
+    }
+
+    /// Convert a grid coordinate to a cell index inside [0, count).
+    static int clamp_cell(double value, int count)
+    {
+        return std::clamp(static_cast<int>(std::floor(value)), 0, count - 1);
+    }
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
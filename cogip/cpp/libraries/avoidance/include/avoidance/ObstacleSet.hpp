@@ -0,0 +1,257 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Structure-of-arrays copy of the obstacles with batched collision tests.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Project includes
+#include "avoidance/ObstacleSnapshot.hpp"
+#include "models/Vec2.hpp"
+#include "models/coords.hpp"
+#include "obstacles/Obstacle.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Circle and polygon obstacles stored in contiguous arrays.
+///
+/// Obstacles keep their index of the vector or snapshot they were loaded from.
+/// Circles are stored as center and radius arrays, polygon edges and bounding box points
+/// of all obstacles are packed in coordinate arrays where each obstacle owns a span.
+/// Tests give the same results as the virtual methods of the obstacle classes,
+/// but run without indirect calls. Tests of a single obstacle start with a broad phase
+/// against its circumscribed circle. Batched tests are written as branch-free loops
+/// over these arrays so the compiler can vectorize them.
+///
+/// With a robot footprint, obstacles are the real ones instead of being inflated by the robot size:
+/// segments are tested with the rectangle the robot sweeps along them, heading along the segment,
+/// and points keep the radius of the footprint rotation away from obstacles, since the robot turns there.
+///
+/// Geometry is copied: the set must be rebuilt when obstacles move.
+/// Buffers are cleared but never shrunk, so they are reused between builds.
+/// Queries are const and keep no state, so they can be called from several threads.
+class ObstacleSet
+{
+public:
+    /// Slot of a point that is not a bounding box point of the set.
+    static constexpr uint32_t no_slot = UINT32_MAX;
+
+    /// @brief Constructor of an empty set.
+    ObstacleSet();
+
+    /// @brief Empties the set.
+    void clear();
+
+    /// @brief Sets the robot footprint used by the tests, applied to obstacles added afterwards.
+    /// Bounding box margins of the obstacles must be larger than the footprint rotation radius,
+    /// so bounding box points are free positions for the robot.
+    /// @param length Length of the robot, along its heading (mm). 0 for a point robot.
+    /// @param width Width of the robot (mm). 0 for a point robot.
+    void set_footprint(double length, double width);
+
+    /// @brief Length of the robot footprint, 0 for a point robot.
+    double footprint_length() const { return footprint_half_length_ * 2; }
+
+    /// @brief Width of the robot footprint, 0 for a point robot.
+    double footprint_width() const { return footprint_half_width_ * 2; }
+
+    /// @brief Rebuilds the set from obstacle objects.
+    /// Only circle, polygon and rectangle obstacles are supported.
+    /// @param obstacles The obstacles to copy. Indices of the set refer to this vector.
+    void build(const std::vector<std::reference_wrapper<obstacles::Obstacle>>& obstacles);
+
+    /// @brief Rebuilds the set from a snapshot of the shared obstacles.
+    /// Circles come first, then rectangles, in snapshot order.
+    /// @param snapshot The snapshot to copy.
+    void load(const ObstacleSnapshot& snapshot);
+
+    /// @brief Appends a circle obstacle.
+    /// @param x X coordinate of the center.
+    /// @param y Y coordinate of the center.
+    /// @param radius Circle radius.
+    /// @param bounding_box_margin Margin for the bounding box.
+    /// @param bounding_box Bounding box points.
+    /// @param bounding_box_count Number of bounding box points.
+    /// @param vx Velocity along X of the tracked obstacle (mm/s).
+    /// @param vy Velocity along Y of the tracked obstacle (mm/s).
+    void add_circle(double x, double y, double radius, double bounding_box_margin,
+                    const models::coords_t* bounding_box, size_t bounding_box_count,
+                    double vx = 0, double vy = 0);
+
+    /// @brief Appends a polygon obstacle.
+    /// @param x X coordinate of the center.
+    /// @param y Y coordinate of the center.
+    /// @param radius Circumscribed circle radius.
+    /// @param points Polygon points.
+    /// @param points_count Number of polygon points.
+    /// @param bounding_box Bounding box points.
+    /// @param bounding_box_count Number of bounding box points.
+    void add_polygon(double x, double y, double radius,
+                     const models::coords_t* points, size_t points_count,
+                     const models::coords_t* bounding_box, size_t bounding_box_count);
+
+    /// @brief Number of obstacles.
+    size_t size() const { return shapes_.size(); }
+
+    /// @brief X coordinate of the center of an obstacle.
+    double center_x(size_t index) const { return center_x_[index]; }
+
+    /// @brief Y coordinate of the center of an obstacle.
+    double center_y(size_t index) const { return center_y_[index]; }
+
+    /// @brief Circumscribed circle radius of an obstacle, enlarged by the footprint rotation radius.
+    double radius(size_t index) const { return radius_[index]; }
+
+    /// @brief Velocity along X of an obstacle (mm/s), 0 for polygons.
+    double velocity_x(size_t index) const { return velocity_x_[index]; }
+
+    /// @brief Velocity along Y of an obstacle (mm/s), 0 for polygons.
+    double velocity_y(size_t index) const { return velocity_y_[index]; }
+
+    /// @brief First bounding box point of an obstacle.
+    /// The bounding box points of all obstacles are consecutive,
+    /// the entry after the last obstacle is the total number of points.
+    uint32_t bounding_box_offset(size_t index) const { return bounding_box_offsets_[index]; }
+
+    /// @brief X coordinates of the bounding box points of all obstacles.
+    const double* bounding_box_x() const { return bounding_box_x_.data(); }
+
+    /// @brief Y coordinates of the bounding box points of all obstacles.
+    const double* bounding_box_y() const { return bounding_box_y_.data(); }
+
+    /// @brief Checks if a point is inside an obstacle.
+    /// @param index Obstacle index.
+    /// @param x X coordinate of the point.
+    /// @param y Y coordinate of the point.
+    /// @return True if the point is inside the obstacle.
+    bool is_point_inside(size_t index, double x, double y) const;
+
+    /// @brief Checks if segment [AB] crosses an obstacle.
+    /// @param index Obstacle index.
+    /// @param ax X coordinate of point A.
+    /// @param ay Y coordinate of point A.
+    /// @param bx X coordinate of point B.
+    /// @param by Y coordinate of point B.
+    /// @return True if the segment crosses the obstacle.
+    bool is_segment_crossing(size_t index, double ax, double ay, double bx, double by) const;
+
+    /// @brief Checks if segment [AB] crosses an obstacle, A and B being known bounding box points.
+    /// A segment between two non-consecutive points of a polygon crosses it. Points are matched
+    /// with polygon points at build time, so this test does not compare coordinates:
+    /// a bounding box point only matches points of the obstacle it belongs to.
+    /// @param index Obstacle index.
+    /// @param ax X coordinate of point A.
+    /// @param ay Y coordinate of point A.
+    /// @param bx X coordinate of point B.
+    /// @param by Y coordinate of point B.
+    /// @param slot_a Bounding box point index of A, or no_slot to compare its coordinates.
+    /// @param slot_b Bounding box point index of B, or no_slot to compare its coordinates.
+    /// @return True if the segment crosses the obstacle.
+    bool is_segment_crossing(size_t index, double ax, double ay, double bx, double by,
+                             uint32_t slot_a, uint32_t slot_b) const;
+
+    /// @brief Finds the nearest point of an obstacle perimeter from a given point.
+    /// @param index Obstacle index.
+    /// @param p The point.
+    /// @return The nearest point.
+    models::Vec2 nearest_point(size_t index, const models::Vec2& p) const;
+
+    /// @brief Checks which points are inside any obstacle.
+    /// @param x X coordinates of the points.
+    /// @param y Y coordinates of the points.
+    /// @param count Number of points.
+    /// @param[out] inside For each point, 1 if it is inside an obstacle, 0 otherwise.
+    void points_inside(const double* x, const double* y, size_t count, uint8_t* inside) const;
+
+    /// @brief Finds all obstacles crossed by segment [AB].
+    /// Edges of all polygons are tested in a single batched pass.
+    /// @param ax X coordinate of point A.
+    /// @param ay Y coordinate of point A.
+    /// @param bx X coordinate of point B.
+    /// @param by Y coordinate of point B.
+    /// @param[out] crossed Indices of the crossed obstacles in increasing order, cleared first.
+    void segment_crossings(double ax, double ay, double bx, double by, std::vector<uint32_t>& crossed) const;
+
+private:
+    /// Number of points or obstacles processed by one pass of a batched test.
+    static constexpr size_t batch_size = 64;
+
+    /// Obstacle shape.
+    enum class Shape : uint8_t {
+        Circle,  ///< Circle obstacle.
+        Polygon  ///< Convex polygon obstacle, including rectangles.
+    };
+
+    double footprint_half_length_ = 0;           ///< Half length of the robot footprint.
+    double footprint_half_width_ = 0;            ///< Half width of the robot footprint.
+    double footprint_radius_ = 0;                ///< Footprint rotation radius, 0 for a point robot.
+
+    std::vector<Shape> shapes_;                  ///< Shape of each obstacle.
+    std::vector<uint32_t> shape_indices_;        ///< Index of each obstacle among the ones of its shape.
+    std::vector<double> center_x_;               ///< Center X coordinate of each obstacle.
+    std::vector<double> center_y_;               ///< Center Y coordinate of each obstacle.
+    std::vector<double> radius_;                 ///< Circumscribed circle radius of each obstacle.
+    std::vector<double> velocity_x_;             ///< Velocity along X of each obstacle.
+    std::vector<double> velocity_y_;             ///< Velocity along Y of each obstacle.
+    std::vector<uint32_t> bounding_box_offsets_; ///< First bounding box point of each obstacle, followed by the point count.
+    std::vector<double> bounding_box_x_;         ///< Bounding box point X coordinates.
+    std::vector<double> bounding_box_y_;         ///< Bounding box point Y coordinates.
+    std::vector<int32_t> bounding_box_vertices_; ///< Polygon point equal to each bounding box point in its obstacle, -1 if none.
+
+    std::vector<uint32_t> circle_obstacles_;     ///< Obstacle index of each circle.
+    std::vector<double> circle_x_;               ///< Center X coordinate of each circle.
+    std::vector<double> circle_y_;               ///< Center Y coordinate of each circle.
+    std::vector<double> circle_radius_;          ///< Radius of each circle.
+    std::vector<double> circle_threshold_;       ///< Largest squared distance to the center of an inside point.
+    std::vector<double> circle_margin_;          ///< Bounding box margin of each circle.
+
+    std::vector<uint32_t> polygon_obstacles_;    ///< Obstacle index of each polygon.
+    std::vector<uint32_t> polygon_offsets_;      ///< First edge of each polygon, followed by the edge count.
+    std::vector<uint32_t> edge_polygons_;        ///< Polygon of each edge.
+    std::vector<double> edge_x_;                 ///< X coordinate of the polygon point starting each edge.
+    std::vector<double> edge_y_;                 ///< Y coordinate of the polygon point starting each edge.
+    std::vector<double> edge_next_x_;            ///< X coordinate of the polygon point ending each edge.
+    std::vector<double> edge_next_y_;            ///< Y coordinate of the polygon point ending each edge.
+
+    /// Appends the fields shared by all shapes.
+    void add_obstacle(Shape shape, uint32_t shape_index, double x, double y, double radius,
+                      const models::coords_t* bounding_box, size_t bounding_box_count);
+
+    /// Broad phase test of segment [AB] against the circumscribed circle of an obstacle.
+    bool is_segment_near(size_t index, double ax, double ay, double bx, double by) const;
+
+    /// Index of the first point of a polygon equal to a point, -1 if none.
+    int find_polygon_point(size_t polygon, double x, double y) const;
+
+    /// Checks if segment [AB] crosses a polygon, edges are tested in batches.
+    /// @param index_a Index of A in the polygon points, -1 if not a polygon point.
+    /// @param index_b Index of B in the polygon points, -1 if not a polygon point.
+    bool is_segment_crossing_polygon(size_t polygon, double ax, double ay, double bx, double by,
+                                     int index_a, int index_b) const;
+
+    /// Checks if the robot footprint, inside the footprint rotation radius of a point, touches an obstacle.
+    bool is_footprint_inside(size_t index, double x, double y) const;
+
+    /// Checks if the rectangle swept by the robot footprint along segment [AB] crosses an obstacle.
+    bool is_footprint_crossing(size_t index, double ax, double ay, double bx, double by) const;
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,208 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Compact copy of the shared obstacle lists.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Project includes
+#include "models/coords_list.hpp"
+#include "obstacles/obstacle_circle.hpp"
+#include "obstacles/obstacle_polygon.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Compact copy of circle and rectangle obstacles.
+///
+/// Obstacle structures embed fixed-size coordinate lists, 32 entries in shared memory,
+/// so copying them as is moves about 0.5 KB per circle and 1 KB per rectangle.
+/// A snapshot only keeps the obstacle parameters and the coordinates actually used,
+/// all packed in a single coordinate array.
+/// Buffers are cleared but never shrunk, so they are reused between snapshots.
+class ObstacleSnapshot
+{
+public:
+    /// Parameters of one obstacle, coordinates are ranges of the shared coordinate array.
+    struct Record {
+        uint32_t id;                         ///< Optional identifier.
+        models::pose_t center;               ///< Obstacle center.
+        double radius;                       ///< Obstacle circumscribed circle radius.
+        double vx;                           ///< Velocity along X of a tracked circle, 0 for rectangles.
+        double vy;                           ///< Velocity along Y of a tracked circle, 0 for rectangles.
+        double bounding_box_margin;          ///< Margin for the bounding box.
+        double length_x;                     ///< Rectangle length along X, unused for circles.
+        double length_y;                     ///< Rectangle length along Y, unused for circles.
+        uint32_t points_offset;              ///< First polygon point, unused for circles.
+        uint32_t points_count;               ///< Number of polygon points, 0 for circles.
+        uint32_t bounding_box_offset;        ///< First bounding box point.
+        uint32_t bounding_box_count;         ///< Number of bounding box points.
+        uint8_t bounding_box_points_number;  ///< Number of points to define the bounding box.
+    };
+
+    /// @brief Empties the snapshot.
+    void clear()
+    {
+        circles_.clear();
+        rectangles_.clear();
+        coords_.clear();
+    }
+
+    /// @brief Appends a circle obstacle.
+    template <std::size_t N>
+    void add_circle(const obstacles::basic_obstacle_circle_t<N>& obstacle)
+    {
+        Record& record = circles_.emplace_back();
+        set_header(record, obstacle.id, obstacle.center, obstacle.radius,
+                   obstacle.bounding_box_margin, obstacle.bounding_box_points_number);
+        record.vx = obstacle.vx;
+        record.vy = obstacle.vy;
+        record.length_x = 0;
+        record.length_y = 0;
+        record.points_offset = coords_.size();
+        record.points_count = 0;
+        append_coords(obstacle.bounding_box, record.bounding_box_offset, record.bounding_box_count);
+    }
+
+    /// @brief Appends a rectangle obstacle.
+    template <std::size_t N>
+    void add_rectangle(const obstacles::basic_obstacle_polygon_t<N>& obstacle)
+    {
+        Record& record = rectangles_.emplace_back();
+        set_header(record, obstacle.id, obstacle.center, obstacle.radius,
+                   obstacle.bounding_box_margin, obstacle.bounding_box_points_number);
+        record.vx = 0;
+        record.vy = 0;
+        record.length_x = obstacle.length_x;
+        record.length_y = obstacle.length_y;
+        append_coords(obstacle.points, record.points_offset, record.points_count);
+        append_coords(obstacle.bounding_box, record.bounding_box_offset, record.bounding_box_count);
+    }
+
+    /// @brief Number of circle obstacles.
+    size_t circle_count() const { return circles_.size(); }
+
+    /// @brief Number of rectangle obstacles.
+    size_t rectangle_count() const { return rectangles_.size(); }
+
+    /// @brief Parameters of a circle obstacle.
+    const Record& circle(size_t index) const { return circles_[index]; }
+
+    /// @brief Parameters of a rectangle obstacle.
+    const Record& rectangle(size_t index) const { return rectangles_[index]; }
+
+    /// @brief Coordinates starting at an offset of a record.
+    const models::coords_t* coords(uint32_t offset) const { return coords_.data() + offset; }
+
+    /// @brief Writes a circle obstacle into an obstacle structure.
+    /// Only the used entries of the coordinate lists are written, truncated to the list size.
+    template <std::size_t N>
+    void restore_circle(size_t index, obstacles::basic_obstacle_circle_t<N>& obstacle) const
+    {
+        const Record& record = circles_[index];
+        obstacle.id = record.id;
+        obstacle.center = record.center;
+        obstacle.radius = record.radius;
+        obstacle.vx = record.vx;
+        obstacle.vy = record.vy;
+        obstacle.bounding_box_margin = record.bounding_box_margin;
+        obstacle.bounding_box_points_number = record.bounding_box_points_number;
+        restore_coords(record.bounding_box_offset, record.bounding_box_count, obstacle.bounding_box);
+    }
+
+    /// @brief Writes a rectangle obstacle into an obstacle structure.
+    /// Only the used entries of the coordinate lists are written, truncated to the list size.
+    template <std::size_t N>
+    void restore_rectangle(size_t index, obstacles::basic_obstacle_polygon_t<N>& obstacle) const
+    {
+        const Record& record = rectangles_[index];
+        obstacle.id = record.id;
+        obstacle.center = record.center;
+        obstacle.radius = record.radius;
+        obstacle.bounding_box_margin = record.bounding_box_margin;
+        obstacle.bounding_box_points_number = record.bounding_box_points_number;
+        obstacle.length_x = record.length_x;
+        obstacle.length_y = record.length_y;
+        restore_coords(record.points_offset, record.points_count, obstacle.points);
+        restore_coords(record.bounding_box_offset, record.bounding_box_count, obstacle.bounding_box);
+    }
+
+    /// @brief Checks whether two snapshots hold the same obstacles.
+    bool operator==(const ObstacleSnapshot& other) const
+    {
+        return same_records(circles_, other.circles_) &&
+               same_records(rectangles_, other.rectangles_) &&
+               coords_.size() == other.coords_.size() &&
+               std::equal(coords_.begin(), coords_.end(), other.coords_.begin(),
+                          [](const models::coords_t& a, const models::coords_t& b) {
+                              return a.x == b.x && a.y == b.y;
+                          });
+    }
+
+    /// @brief Checks whether two snapshots hold different obstacles.
+    bool operator!=(const ObstacleSnapshot& other) const { return !(*this == other); }
+
+private:
+    std::vector<Record> circles_;          ///< Circle obstacles.
+    std::vector<Record> rectangles_;       ///< Rectangle obstacles.
+    std::vector<models::coords_t> coords_; ///< Polygon and bounding box points of all obstacles.
+
+    static void set_header(Record& record, uint32_t id, const models::pose_t& center, double radius,
+                           double bounding_box_margin, uint8_t bounding_box_points_number)
+    {
+        record.id = id;
+        record.center = center;
+        record.radius = radius;
+        record.bounding_box_margin = bounding_box_margin;
+        record.bounding_box_points_number = bounding_box_points_number;
+    }
+
+    template <std::size_t N>
+    void append_coords(const models::basic_coords_list_t<N>& list, uint32_t& offset, uint32_t& count)
+    {
+        count = std::min(list.count, N);
+        offset = coords_.size();
+        coords_.insert(coords_.end(), list.elems, list.elems + count);
+    }
+
+    template <std::size_t N>
+    void restore_coords(uint32_t offset, uint32_t count, models::basic_coords_list_t<N>& list) const
+    {
+        list.count = std::min<std::size_t>(count, N);
+        std::copy(coords_.begin() + offset, coords_.begin() + offset + list.count, list.elems);
+    }
+
+    static bool same_records(const std::vector<Record>& a, const std::vector<Record>& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Record& r1, const Record& r2) {
+            return r1.id == r2.id &&
+                   r1.center.x == r2.center.x && r1.center.y == r2.center.y &&
+                   r1.center.angle == r2.center.angle &&
+                   r1.radius == r2.radius &&
+                   r1.vx == r2.vx && r1.vy == r2.vy &&
+                   r1.bounding_box_margin == r2.bounding_box_margin &&
+                   r1.length_x == r2.length_x && r1.length_y == r2.length_y &&
+                   r1.points_count == r2.points_count &&
+                   r1.bounding_box_count == r2.bounding_box_count &&
+                   r1.bounding_box_points_number == r2.bounding_box_points_number;
+        });
+    }
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,104 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Monotonic arena holding the temporaries of a planning cycle.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Monotonic arena holding the temporaries of a planning cycle.
+///
+/// Allocations bump a pointer in a buffer owned by the arena and are all freed at once by reset(),
+/// at the start of the next cycle. Memory needed beyond the buffer during a cycle comes from the heap,
+/// and the buffer is enlarged by that amount at the next reset: after a few cycles,
+/// planning allocates nothing from the heap, whatever the fragmentation of a long match.
+class PlanningArena
+{
+public:
+    static constexpr size_t initial_size = 64 * 1024; ///< Initial size of the buffer in bytes.
+
+    PlanningArena() : buffer_(initial_size)
+    {
+        resource_.emplace(buffer_.data(), buffer_.size(), &overflow_);
+    }
+
+    PlanningArena(const PlanningArena&) = delete;
+    PlanningArena& operator=(const PlanningArena&) = delete;
+
+    /// @brief Memory resource of the arena, to give to the allocators of pmr containers.
+    /// The resource keeps its address across resets.
+    std::pmr::memory_resource* resource() { return &*resource_; }
+
+    /// @brief Frees all allocations of the cycle, enlarging the buffer if the cycle overflowed it.
+    /// Containers using the arena must have released their storage before, not just been cleared.
+    void reset()
+    {
+        resource_.reset();
+        size_t overflow = overflow_.take_allocated();
+        if (overflow > 0) {
+            buffer_.resize(buffer_.size() + overflow);
+        }
+        resource_.emplace(buffer_.data(), buffer_.size(), &overflow_);
+    }
+
+    /// @brief Size of the buffer in bytes.
+    size_t capacity() const { return buffer_.size(); }
+
+private:
+    /// Heap resource counting the bytes allocated when the buffer is exhausted.
+    class OverflowResource : public std::pmr::memory_resource
+    {
+    public:
+        /// Returns the bytes allocated since the previous call.
+        size_t take_allocated()
+        {
+            size_t allocated = allocated_;
+            allocated_ = 0;
+            return allocated;
+        }
+
+    private:
+        size_t allocated_ = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            allocated_ += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    OverflowResource overflow_;   ///< Upstream of the monotonic resource.
+    std::vector<std::byte> buffer_; ///< Memory of the allocations.
+    std::optional<std::pmr::monotonic_buffer_resource> resource_; ///< Allocator of the current cycle.
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,130 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Precomputed visibility between the bounding box points of fixed obstacles.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Project includes
+#include "avoidance/ObstacleSet.hpp"
+#include "shared_memory/shared_properties.hpp"
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Properties a static roadmap depends on, besides the obstacle geometry.
+struct RoadmapKey {
+    uint8_t table = 0;                ///< Table ID.
+    uint16_t robot_width = 0;         ///< Width of the robot (mm).
+    uint16_t robot_length = 0;        ///< Length of the robot (mm).
+    double obstacle_bb_margin = 0;    ///< Margin for the bounding box of the obstacles.
+    uint8_t obstacle_bb_vertices = 0; ///< Number of vertices for the bounding box of the obstacles.
+    uint8_t footprint_avoidance = 0;  ///< 1 if segments are tested with the robot footprint.
+
+    /// @brief Builds the key of the current shared properties.
+    static RoadmapKey from_properties(const shared_memory::shared_properties_t& properties);
+
+    /// @brief Name of the file storing the roadmap of this key.
+    std::string file_name() const;
+
+    bool operator==(const RoadmapKey& other) const {
+        return table == other.table
+            && robot_width == other.robot_width && robot_length == other.robot_length
+            && obstacle_bb_margin == other.obstacle_bb_margin && obstacle_bb_vertices == other.obstacle_bb_vertices
+            && footprint_avoidance == other.footprint_avoidance;
+    }
+};
+
+/// @brief Visibility between the bounding box points of fixed obstacles.
+///
+/// Fixed table obstacles do not move during a match, so the segments between their
+/// bounding box points only need to be tested against them once per table and robot footprint.
+/// For each pair of points, the roadmap records whether the segment is free or which
+/// fixed obstacle blocks it. Avoidance then only tests free segments against other obstacles.
+///
+/// Fixed obstacles are identified by a hash of their geometry, so they are recognized among
+/// the shared obstacles without any marker. A roadmap can be saved to a file and loaded by
+/// other processes, or by the next match with the same key.
+class StaticRoadmap
+{
+public:
+    static constexpr int16_t free = -1; ///< Segment crossing no fixed obstacle.
+
+    /// @brief Empties the roadmap.
+    void clear();
+
+    /// @brief Checks whether the roadmap holds no obstacle.
+    bool empty() const { return hashes_.empty(); }
+
+    /// @brief Key the roadmap was built for.
+    const RoadmapKey& key() const { return key_; }
+
+    /// @brief Computes the roadmap of a set of fixed obstacles.
+    /// @param key Key the obstacles were built for.
+    /// @param obstacles The fixed obstacles.
+    void build(const RoadmapKey& key, const ObstacleSet& obstacles);
+
+    /// @brief Writes the roadmap to a file, creating its directory if needed.
+    /// The file is written under a temporary name then renamed, so readers never see a partial file.
+    /// @param path Path of the file.
+    /// @return True if the file was written.
+    bool save(const std::string& path) const;
+
+    /// @brief Reads a roadmap written by save().
+    /// The roadmap is left unchanged if the file is missing, invalid or built for another key.
+    /// @param path Path of the file.
+    /// @param key Expected key.
+    /// @return True if the roadmap was loaded.
+    bool load(const std::string& path, const RoadmapKey& key);
+
+    /// @brief Number of fixed obstacles.
+    size_t obstacle_count() const { return hashes_.size(); }
+
+    /// @brief Geometry hash of a fixed obstacle.
+    uint64_t obstacle_hash(size_t index) const { return hashes_[index]; }
+
+    /// @brief Index of the fixed obstacle with a geometry hash, -1 if none.
+    int find_obstacle(uint64_t hash) const;
+
+    /// @brief First point of a fixed obstacle, points of all obstacles are consecutive.
+    uint32_t point_offset(size_t index) const { return point_offsets_[index]; }
+
+    /// @brief Fixed obstacle blocking the segment between two points, or `free`.
+    /// @param point_a First point, different from point_b.
+    /// @param point_b Second point.
+    int16_t blocker(uint32_t point_a, uint32_t point_b) const
+    {
+        if (point_a > point_b) {
+            std::swap(point_a, point_b);
+        }
+        return blockers_[static_cast<size_t>(point_b) * (point_b - 1) / 2 + point_a];
+    }
+
+    /// @brief Hashes the geometry of an obstacle of a set: center, radius and bounding box points.
+    static uint64_t hash_obstacle(const ObstacleSet& obstacles, size_t index);
+
+private:
+    RoadmapKey key_;                       ///< Key the roadmap was built for.
+    std::vector<uint64_t> hashes_;         ///< Geometry hash of each fixed obstacle.
+    std::vector<uint32_t> point_offsets_;  ///< First point of each obstacle, followed by the total point count.
+    std::vector<int16_t> blockers_;        ///< Triangular point pair matrix of blocking obstacles.
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
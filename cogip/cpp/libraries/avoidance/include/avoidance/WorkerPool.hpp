@@ -0,0 +1,110 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @ingroup     lib_avoidance
+/// @{
+/// @file
+/// @brief       Persistent worker threads running parallel loops.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cogip {
+
+namespace avoidance {
+
+/// @brief Fixed set of threads sharing the iterations of parallel loops.
+///
+/// Threads are created once and sleep between loops.
+/// The calling thread takes part in each loop as worker 0.
+class WorkerPool
+{
+public:
+    /// @brief Loop body, called with the worker index and a range [begin, end) of iterations.
+    ///
+    /// Non-owning reference to a callable, so passing a lambda to parallel_for() does not allocate.
+    /// The callable must outlive the parallel_for() call, which a lambda passed as argument does.
+    class Task
+    {
+    public:
+        template <typename Callable,
+                  typename = std::enable_if_t<!std::is_same_v<std::decay_t<Callable>, Task>>>
+        Task(Callable&& callable) noexcept :
+            callable_(const_cast<void*>(static_cast<const void*>(std::addressof(callable)))),
+            call_([](void* callable, size_t worker, size_t begin, size_t end) {
+                (*static_cast<std::remove_reference_t<Callable>*>(callable))(worker, begin, end);
+            })
+        {
+        }
+
+        void operator()(size_t worker, size_t begin, size_t end) const
+        {
+            call_(callable_, worker, begin, end);
+        }
+
+    private:
+        void* callable_;                                 ///< Address of the referenced callable.
+        void (*call_)(void*, size_t, size_t, size_t);    ///< Calls the callable with its actual type.
+    };
+
+    /// @brief Constructor starting the worker threads.
+    /// @param workers Total number of workers, including the calling thread.
+    explicit WorkerPool(size_t workers);
+
+    /// @brief Destructor stopping and joining the worker threads.
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /// @brief Returns the total number of workers, including the calling thread.
+    size_t size() const { return threads_.size() + 1; }
+
+    /// @brief Runs a loop over [0, count) in chunks of iterations, and waits for its completion.
+    /// Chunks are handed out dynamically, so iterations of uneven cost are balanced.
+    /// The first exception thrown by the task is rethrown in the calling thread.
+    /// @param count Number of iterations.
+    /// @param chunk Number of iterations handed out at once.
+    /// @param task The loop body.
+    void parallel_for(size_t count, size_t chunk, const Task& task);
+
+private:
+    std::vector<std::thread> threads_;     ///< Worker threads, excluding the calling thread.
+    std::mutex mutex_;                     ///< Protects the loop state below.
+    std::condition_variable start_cv_;     ///< Signals a new loop or stop to the workers.
+    std::condition_variable done_cv_;      ///< Signals the end of the loop to the caller.
+    uint64_t generation_ = 0;              ///< Incremented for each loop.
+    size_t running_ = 0;                   ///< Number of worker threads still in the current loop.
+    bool stopping_ = false;                ///< Set when the pool is destroyed.
+    const Task* task_ = nullptr;           ///< Body of the current loop.
+    size_t count_ = 0;                     ///< Iterations of the current loop.
+    size_t chunk_ = 1;                     ///< Chunk size of the current loop.
+    std::atomic<size_t> next_{0};          ///< Next iteration to hand out.
+    std::exception_ptr error_;             ///< First exception thrown by the current loop.
+
+    /// Body of the worker threads.
+    void worker_loop(size_t worker);
+
+    /// Runs chunks of the current loop until all are handed out.
+    void run_chunks(size_t worker);
+};
+
+} // namespace avoidance
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,91 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "logger/LogRing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace cogip {
+
+namespace logger {
+
+static_assert((LogRing::capacity & (LogRing::capacity - 1)) == 0, "LogRing capacity must be a power of two");
+
+LogRecord LogRecord::make(LogLevel level, std::string_view text)
+{
+    // Kernel thread ID, as shown by ps and top, read once per thread.
+    thread_local const uint64_t current_thread_id = static_cast<uint64_t>(::syscall(SYS_gettid));
+
+    LogRecord record;
+    record.level = level;
+    record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    record.thread_id = current_thread_id;
+    record.size = std::min(text.size(), message_size_max);
+    std::memcpy(record.message, text.data(), record.size);
+    return record;
+}
+
+LogRing::LogRing() : cells_(new Cell[capacity])
+{
+    for (size_t i = 0; i < capacity; i++) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool LogRing::push(LogLevel level, std::string_view message)
+{
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[position & (capacity - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0) {
+            // Slot free for this lap: claim it, or retry from the position another producer reached.
+            if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            // Slot not read yet since the previous lap: the ring is full.
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else {
+            position = enqueue_position_.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->record = LogRecord::make(level, message);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+size_t LogRing::pop(std::vector<LogRecord>& records, size_t count)
+{
+    size_t popped = 0;
+    while (popped < count) {
+        Cell& cell = cells_[dequeue_position_ & (capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeue_position_ + 1) {
+            // Empty, or the next record is still being written.
+            break;
+        }
+        records.push_back(cell.record);
+        cell.sequence.store(dequeue_position_ + capacity, std::memory_order_release);
+        dequeue_position_++;
+        popped++;
+    }
+    return popped;
+}
+
+} // namespace logger
+
+} // namespace cogip
@@ -1,4 +1,8 @@
 #include "logger/PythonLogger.hpp"
+#include "logger/LogRing.hpp"
+
+#include <chrono>
+#include <thread>
 
 namespace cogip {
 
@@ -7,13 +11,76 @@ namespace logger {
 // Function that will be defined on the Python side
 std::function<void(const std::string&, LogLevel)> py_log_callback;
 
+/// Interval between two drains of the log ring.
+static constexpr std::chrono::milliseconds drain_period(10);
+
+/// Largest number of records handed to the batch callback at once.
+static constexpr size_t drain_batch_size = 64;
+
+// Asynchronous backend: logging threads queue records, the drain thread hands them to Python.
+static LogRing log_ring;
+static std::atomic<bool> async_enabled{false};
+static std::atomic<bool> drain_stop{false};
+static struct DrainThread {
+    std::thread thread;
+    // Not joined at exit if the backend was not disabled: the process must not abort.
+    ~DrainThread() { if (thread.joinable()) thread.detach(); }
+} drain_thread;
+static BatchCallback batch_callback;
+
+/// Sends a message to the ring if the asynchronous backend is enabled, to the Python callback otherwise.
+static void forward(const std::string& message, LogLevel level) {
+    if (async_enabled.load(std::memory_order_acquire)) {
+        log_ring.push(level, message);
+    }
+    else if (py_log_callback) {  // Ensure callback is valid
+        py_log_callback(message, level);
+    }
+}
+
+/// Drain thread loop, until stopped and the ring is empty.
+static void drain() {
+    std::vector<LogRecord> records;
+    records.reserve(drain_batch_size);
+    uint64_t reported_drops = log_ring.dropped();
+    for (;;) {
+        bool stopping = drain_stop.load(std::memory_order_acquire);
+        while (log_ring.pop(records, drain_batch_size) > 0) {
+            batch_callback(records);
+            records.clear();
+        }
+        uint64_t drops = log_ring.dropped();
+        if (drops != reported_drops) {
+            std::string message = "logger: " + std::to_string(drops - reported_drops) + " messages dropped, log ring full";
+            records.push_back(LogRecord::make(LogLevel::WARNING, message));
+            batch_callback(records);
+            records.clear();
+            reported_drops = drops;
+        }
+        if (stopping) {
+            return;
+        }
+        std::this_thread::sleep_for(drain_period);
+    }
+}
+
+std::string& PythonLogger::buffer() {
+    // Few loggers exist, a linear search is enough.
+    thread_local std::vector<std::pair<const PythonLogger*, std::string>> buffers;
+    for (auto& [owner, buffer] : buffers) {
+        if (owner == this) {
+            return buffer;
+        }
+    }
+    return buffers.emplace_back(this, std::string()).second;
+}
+
 int PythonLogger::overflow(int c) {
     if (c != EOF) {
+        std::string& buffer_ = buffer();
         if (c == '\n') {
             // When we encounter a newline, we send the buffer to the Python logger
-            if (py_log_callback) {  // Ensure callback is valid
-                py_log_callback(buffer_, default_level_);
-            }
+            forward(buffer_, default_level_);
             buffer_.clear();
         } else {
             buffer_ += static_cast<char>(c);
@@ -23,8 +90,9 @@ int PythonLogger::overflow(int c) {
 }
 
 int PythonLogger::sync() {
-    if (!buffer_.empty() && py_log_callback) {  // Ensure callback is valid
-        py_log_callback(buffer_, default_level_);
+    std::string& buffer_ = buffer();
+    if (!buffer_.empty()) {
+        forward(buffer_, default_level_);
         buffer_.clear();
     }
     return 0;
@@ -34,13 +102,41 @@ int PythonLogger::sync() {
 PythonLogger stdout_buf(LogLevel::INFO);
 PythonLogger stderr_buf(LogLevel::ERROR);
 
-void set_logger_callback(std::function<void(const std::string&, LogLevel)> callback) {
+void set_logger_callback(std::function<void(const std::string&, LogLevel)> callback, LogLevel level) {
     py_log_callback = callback;
+    set_logger_level(level);
     std::cout.rdbuf(&stdout_buf);
     std::cerr.rdbuf(&stderr_buf);
 }
 
+void set_logger_level(LogLevel level) {
+    enabled_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void enable_async_logging(BatchCallback callback) {
+    disable_async_logging();
+    batch_callback = callback;
+    drain_stop.store(false, std::memory_order_relaxed);
+    drain_thread.thread = std::thread(drain);
+    async_enabled.store(true, std::memory_order_release);
+}
+
+void disable_async_logging() {
+    if (!drain_thread.thread.joinable()) {
+        return;
+    }
+    async_enabled.store(false, std::memory_order_release);
+    drain_stop.store(true, std::memory_order_release);
+    drain_thread.thread.join();
+}
+
+uint64_t dropped_log_count() {
+    return log_ring.dropped();
+}
+
 void unset_logger_callback() {
+    disable_async_logging();
+    enabled_level.store(static_cast<int>(LogLevel::ERROR) + 1, std::memory_order_relaxed);
     py_log_callback = nullptr;
     std::cout.rdbuf(nullptr);  // Reset to default
     std::cerr.rdbuf(nullptr);  // Reset to default
@@ -48,19 +144,19 @@ void unset_logger_callback() {
 
 // API for explicit logging in C++
 void log_debug(const std::string& message) {
-    if (py_log_callback) py_log_callback(message, LogLevel::DEBUG);
+    if (is_enabled(LogLevel::DEBUG)) forward(message, LogLevel::DEBUG);
 }
 
 void log_info(const std::string& message) {
-    if (py_log_callback) py_log_callback(message, LogLevel::INFO);
+    if (is_enabled(LogLevel::INFO)) forward(message, LogLevel::INFO);
 }
 
 void log_warning(const std::string& message) {
-    if (py_log_callback) py_log_callback(message, LogLevel::WARNING);
+    if (is_enabled(LogLevel::WARNING)) forward(message, LogLevel::WARNING);
 }
 
 void log_error(const std::string& message) {
-    if (py_log_callback) py_log_callback(message, LogLevel::ERROR);
+    if (is_enabled(LogLevel::ERROR)) forward(message, LogLevel::ERROR);
 }
 
 } // namespace logger
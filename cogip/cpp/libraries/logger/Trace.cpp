@@ -0,0 +1,165 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "logger/Trace.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace cogip {
+
+namespace logger {
+
+namespace {
+
+/// Span recorded by a thread.
+struct TraceEvent {
+    const char* name;   ///< Span name
+    uint64_t start;     ///< Start time, in nanoseconds
+    uint64_t duration;  ///< Duration, in nanoseconds
+};
+
+/// Spans of a thread. Only the owning thread writes, a dump reads the published spans.
+struct ThreadTrace {
+    /// Number of spans kept per thread and recording.
+    static constexpr size_t capacity = 1 << 16;
+
+    uint64_t thread_id = 0;                        ///< Kernel ID of the thread
+    uint64_t recording = 0;                        ///< Recording the spans belong to
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[capacity]};  ///< Spans
+    std::atomic<size_t> count{0};                  ///< Number of published spans
+};
+
+std::mutex registry_mutex;                          ///< Protects the registry and the process name
+std::vector<std::unique_ptr<ThreadTrace>> registry; ///< Buffers of all threads that recorded spans
+std::string trace_process_name;                     ///< Process name of the current recording
+std::atomic<uint64_t> recording{0};                 ///< Current recording, incremented at each start
+std::atomic<uint64_t> dropped{0};                   ///< Spans dropped by the current recording
+
+/// Buffer of the calling thread, registered at its first span.
+/// Buffers outlive their threads so a dump can still read their spans.
+ThreadTrace& thread_trace()
+{
+    thread_local ThreadTrace* local = nullptr;
+    if (!local) {
+        auto trace = std::make_unique<ThreadTrace>();
+        trace->thread_id = static_cast<uint64_t>(::syscall(SYS_gettid));
+        local = trace.get();
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(std::move(trace));
+    }
+    return *local;
+}
+
+/// Writes a JSON string, escaping quotes, backslashes and control characters.
+void write_json_string(std::FILE* file, const std::string& text)
+{
+    std::fputc('"', file);
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(c, file);
+        }
+        else if (c < 0x20) {
+            std::fprintf(file, "\\u%04x", c);
+        }
+        else {
+            std::fputc(c, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+} // namespace
+
+void record_trace_span(const char* name, uint64_t start, uint64_t end)
+{
+    ThreadTrace& trace = thread_trace();
+    uint64_t current = recording.load(std::memory_order_relaxed);
+    if (trace.recording != current) {
+        // First span of this thread in a new recording: forget the previous one.
+        trace.recording = current;
+        trace.count.store(0, std::memory_order_relaxed);
+    }
+
+    size_t count = trace.count.load(std::memory_order_relaxed);
+    if (count == ThreadTrace::capacity) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    trace.events[count] = { name, start, end - start };
+    trace.count.store(count + 1, std::memory_order_release);
+}
+
+void start_tracing(const std::string& process_name)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    trace_process_name = process_name;
+    dropped.store(0, std::memory_order_relaxed);
+    recording.fetch_add(1, std::memory_order_relaxed);
+    trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+void stop_tracing()
+{
+    trace_enabled.store(false, std::memory_order_relaxed);
+}
+
+bool dump_trace(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    uint64_t current = recording.load(std::memory_order_relaxed);
+    long pid = static_cast<long>(::getpid());
+
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":0,\"args\":{\"name\":", pid);
+    write_json_string(file, trace_process_name);
+    std::fprintf(file, "}}");
+
+    for (const auto& trace : registry) {
+        if (trace->recording != current) {
+            continue;
+        }
+        // Spans published before this point are complete, later ones are ignored.
+        size_t count = trace->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            const TraceEvent& event = trace->events[i];
+            std::fprintf(
+                file,
+                ",\n{\"name\":\"%s\",\"cat\":\"cogip\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%lu}",
+                event.name,
+                event.start / 1000.,
+                event.duration / 1000.,
+                pid,
+                static_cast<unsigned long>(trace->thread_id)
+            );
+        }
+    }
+
+    std::fprintf(
+        file,
+        "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_spans\":%lu}}\n",
+        static_cast<unsigned long>(dropped.load(std::memory_order_relaxed))
+    );
+    return std::fclose(file) == 0;
+}
+
+uint64_t dropped_trace_spans()
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+} // namespace logger
+
+} // namespace cogip
@@ -3,10 +3,13 @@
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
 #include "logger/PythonLogger.hpp"
+#include "logger/Trace.hpp"
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/function.h>
 #include <nanobind/stl/string.h>
+#include <nanobind/stl/string_view.h>
+#include <nanobind/stl/vector.h>
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -15,6 +18,9 @@ namespace cogip {
 
 namespace logger {
 
+// Python batch callback of the asynchronous backend, only released while holding the GIL.
+static nb::object py_batch_callback;
+
 NB_MODULE(logger, m) {
     nb::enum_<LogLevel>(m, "LogLevel")
         .value("DEBUG", LogLevel::DEBUG)
@@ -22,8 +28,61 @@ NB_MODULE(logger, m) {
         .value("WARNING", LogLevel::WARNING)
         .value("ERROR", LogLevel::ERROR);
 
-        m.def("set_logger_callback", &set_logger_callback, "Set the Python logger callback");
-        m.def("unset_logger_callback", &unset_logger_callback, "Unset the Python logger callback");
+        m.def("set_logger_callback", &set_logger_callback, "callback"_a, "level"_a = LogLevel::DEBUG,
+              "Set the Python logger callback and the lowest level it handles");
+        m.def("set_logger_level", &set_logger_level, "level"_a,
+              "Set the lowest level handled by the Python logger callback");
+        m.def("unset_logger_callback", []() {
+                {
+                    // The drain thread needs the GIL to hand its last records to Python.
+                    nb::gil_scoped_release release;
+                    disable_async_logging();
+                }
+                py_batch_callback.reset();
+                unset_logger_callback();
+            }, "Unset the Python logger callback, disabling the asynchronous backend first");
+
+    nb::class_<LogRecord>(m, "LogRecord", "Log record of the asynchronous backend")
+        .def_ro("level", &LogRecord::level, "Log level")
+        .def_prop_ro("timestamp", [](const LogRecord& record) { return record.timestamp * 1e-9; },
+                     "Time of the log call, in seconds since the epoch")
+        .def_ro("thread_id", &LogRecord::thread_id, "Kernel ID of the logging thread")
+        .def_prop_ro("message", &LogRecord::view, "Message");
+
+    m.def("enable_async_logging", [](nb::callable callback) {
+            {
+                nb::gil_scoped_release release;
+                disable_async_logging();
+            }
+            py_batch_callback = callback;
+            enable_async_logging([](const std::vector<LogRecord>& records) {
+                nb::gil_scoped_acquire acquire;
+                try {
+                    py_batch_callback(records);
+                }
+                catch (nb::python_error& error) {
+                    // Nothing can catch it on the drain thread.
+                    error.discard_as_unraisable("cogip.cpp.libraries.logger batch callback");
+                }
+            });
+        }, "callback"_a,
+        "Queue C++ log records in a lock-free ring, handed in batches to the callback from a drain thread");
+    m.def("disable_async_logging", []() {
+            {
+                nb::gil_scoped_release release;
+                disable_async_logging();
+            }
+            py_batch_callback.reset();
+        }, "Stop the asynchronous backend after handing the queued records to the callback");
+    m.def("dropped_log_count", &dropped_log_count, "Number of C++ log records dropped because the ring was full");
+
+    m.def("start_tracing", &start_tracing, "process_name"_a,
+          "Start recording C++ tracing spans, discarding the previous recording");
+    m.def("stop_tracing", &stop_tracing, "Stop recording C++ tracing spans");
+    m.def("is_tracing", &is_tracing, "Check if C++ tracing spans are recorded");
+    m.def("dump_trace", &dump_trace, "path"_a, nb::call_guard<nb::gil_scoped_release>(),
+          "Write the recorded spans as a Chrome / Perfetto JSON trace, return False if the file could not be written");
+    m.def("dropped_trace_spans", &dropped_trace_spans, "Number of spans dropped because a thread buffer was full");
 }
 
 } // namespace logger
@@ -0,0 +1,91 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_logger
+/// @{
+/// @file
+/// @brief       Lock-free ring of log records for the asynchronous logging backend
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include "LogLevel.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace cogip {
+
+namespace logger {
+
+/// Log message formatted by the logging thread, with the time and thread of the log call.
+struct LogRecord {
+    /// Longest message kept, longer messages are truncated.
+    static constexpr size_t message_size_max = 230;
+
+    LogLevel level;                   ///< Log level
+    uint64_t timestamp;               ///< Time of the log call, in nanoseconds since the epoch
+    uint64_t thread_id;               ///< Kernel ID of the logging thread
+    uint16_t size;                    ///< Message size
+    char message[message_size_max];   ///< Message, not null-terminated
+
+    /// Builds a record of the calling thread at the current time.
+    /// @param level The log level
+    /// @param text The message, truncated to message_size_max
+    static LogRecord make(LogLevel level, std::string_view text);
+
+    /// Message of the record.
+    std::string_view view() const { return std::string_view(message, size); }
+};
+
+/// Fixed-size ring of log records with several producers and a single consumer.
+///
+/// Producers never block: a slot is claimed with a compare-and-swap on the write position,
+/// and the record is dropped if the ring is full. Each slot carries a sequence number telling
+/// whether it is free for the producers of a lap or ready for the consumer.
+class LogRing {
+public:
+    /// Number of records, a power of two.
+    static constexpr size_t capacity = 1024;
+
+    /// Constructor of an empty ring.
+    LogRing();
+
+    /// Queues a record, from any thread.
+    /// @param level The log level
+    /// @param message The message, truncated to LogRecord::message_size_max
+    /// @return False if the ring was full and the record dropped
+    bool push(LogLevel level, std::string_view message);
+
+    /// Dequeues records, from the consumer thread only.
+    /// @param[out] records Vector the records are appended to
+    /// @param count Largest number of records to dequeue
+    /// @return Number of dequeued records
+    size_t pop(std::vector<LogRecord>& records, size_t count);
+
+    /// Number of records dropped because the ring was full.
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    /// Ring slot.
+    struct Cell {
+        std::atomic<size_t> sequence;  ///< Write position the slot is free for, or read position + 1 once written
+        LogRecord record;              ///< Queued record
+    };
+
+    std::unique_ptr<Cell[]> cells_;                       ///< Ring slots
+    alignas(64) std::atomic<size_t> enqueue_position_{0}; ///< Next write position, shared by producers
+    alignas(64) size_t dequeue_position_ = 0;             ///< Next read position, owned by the consumer
+    alignas(64) std::atomic<uint64_t> dropped_{0};        ///< Number of dropped records
+};
+
+} // namespace logger
+
+} // namespace cogip
+
+/// @}
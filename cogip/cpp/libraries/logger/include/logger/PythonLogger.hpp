@@ -16,11 +16,16 @@
 #pragma once
 
 #include "LogLevel.hpp"
+#include "LogRing.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <streambuf>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace cogip {
 
@@ -48,7 +53,10 @@ protected:
     virtual int sync();
 
 private:
-    std::string buffer_; ///< Buffer to hold the data before sending it to the Python logger
+    /// Buffer to hold the data of the calling thread before sending it to the Python logger
+    /// Each thread has its own buffer, so lines logged at the same time by several threads are not mixed.
+    std::string& buffer();
+
     LogLevel default_level_; ///< Default log level
 };
 
@@ -71,17 +79,53 @@ private:
     PythonLogger buffer_; ///< Buffer to hold the data before sending it to the Python logger
 };
 
-PythonStreamLogger debug(LogLevel::DEBUG);
-PythonStreamLogger info(LogLevel::INFO);
-PythonStreamLogger warning(LogLevel::WARNING);
-PythonStreamLogger error(LogLevel::ERROR);
+// Inline so that every library including this header shares the same streams.
+inline PythonStreamLogger debug(LogLevel::DEBUG);
+inline PythonStreamLogger info(LogLevel::INFO);
+inline PythonStreamLogger warning(LogLevel::WARNING);
+inline PythonStreamLogger error(LogLevel::ERROR);
+
+/// Lowest level forwarded to Python, cached from the level of the Python logger.
+/// Above ERROR when no callback is set, so all levels are disabled.
+inline std::atomic<int> enabled_level{static_cast<int>(LogLevel::ERROR) + 1};
+
+/// Checks if messages of a level reach the Python logger.
+/// @param level The log level
+/// @return True if the level is enabled
+inline bool is_enabled(LogLevel level)
+{
+    return static_cast<int>(level) >= enabled_level.load(std::memory_order_relaxed);
+}
 
 /// Function to set the Python callback
-void set_logger_callback(std::function<void(const std::string&, LogLevel)> callback);
+/// @param callback The Python callback
+/// @param level Lowest level of the Python logger
+void set_logger_callback(std::function<void(const std::string&, LogLevel)> callback, LogLevel level = LogLevel::DEBUG);
 
-/// Function to unset the Python callback
+/// Function to update the lowest level forwarded to the Python callback
+/// @param level Lowest level of the Python logger
+void set_logger_level(LogLevel level);
+
+/// Function to unset the Python callback, disabling the asynchronous backend first
 void unset_logger_callback();
 
+/// Callback receiving batches of records from the drain thread of the asynchronous backend
+using BatchCallback = std::function<void(const std::vector<LogRecord>&)>;
+
+/// Function to enable the asynchronous backend
+/// Logging threads then only queue records in a lock-free ring, without waiting for Python:
+/// records are dropped if the ring is full. A drain thread hands queued records to the callback
+/// in batches, and reports the number of dropped records as a warning.
+/// @param callback The batch callback, called from the drain thread
+void enable_async_logging(BatchCallback callback);
+
+/// Function to disable the asynchronous backend
+/// Queued records are handed to the batch callback before the drain thread stops.
+void disable_async_logging();
+
+/// Number of records dropped by the asynchronous backend because its ring was full
+uint64_t dropped_log_count();
+
 // API for explicit logging in C++
 void log_debug(const std::string& message);
 
@@ -95,4 +139,15 @@ void log_error(const std::string& message);
 
 } // namespace cogip
 
+/// Streams to a logger only if its level is enabled.
+/// When the level is disabled, the streamed expressions are neither evaluated nor formatted:
+/// `COGIP_LOG_DEBUG << "path size = " << path.size() << std::endl;`
+#define COGIP_LOG(level, stream) \
+    if (!::cogip::logger::is_enabled(::cogip::logger::LogLevel::level)) {} else ::cogip::logger::stream
+
+#define COGIP_LOG_DEBUG COGIP_LOG(DEBUG, debug)        ///< Level-gated debug stream.
+#define COGIP_LOG_INFO COGIP_LOG(INFO, info)           ///< Level-gated info stream.
+#define COGIP_LOG_WARNING COGIP_LOG(WARNING, warning)  ///< Level-gated warning stream.
+#define COGIP_LOG_ERROR COGIP_LOG(ERROR, error)        ///< Level-gated error stream.
+
 /// @}
@@ -0,0 +1,105 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_logger
+/// @{
+/// @file
+/// @brief       Scoped tracing spans exported as a Chrome / Perfetto JSON timeline
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cogip {
+
+namespace logger {
+
+/// Tracing flag, checked by each span.
+inline std::atomic<bool> trace_enabled{false};
+
+/// Checks if spans are recorded.
+inline bool is_tracing()
+{
+    return trace_enabled.load(std::memory_order_relaxed);
+}
+
+/// Trace clock, in nanoseconds.
+/// The monotonic clock is shared by all processes, so their timelines can be merged.
+inline uint64_t trace_clock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/// Records a span in the buffer of the calling thread.
+/// Spans are dropped once the buffer of the thread is full.
+/// @param name Span name, a string literal
+/// @param start Start time, from trace_clock()
+/// @param end End time, from trace_clock()
+void record_trace_span(const char* name, uint64_t start, uint64_t end);
+
+/// Starts a new recording, discarding the spans of the previous one.
+/// @param process_name Name of the process in the timeline, including the shared memory name
+///                     so processes of the same robot are grouped
+void start_tracing(const std::string& process_name);
+
+/// Stops recording, recorded spans are kept until the next start.
+void stop_tracing();
+
+/// Writes the spans of the current or last recording as a Chrome / Perfetto JSON trace.
+/// Traces of several processes can be merged by concatenating their `traceEvents` arrays.
+/// @param path Path of the file
+/// @return True if the file was written
+bool dump_trace(const std::string& path);
+
+/// Number of spans dropped by the current or last recording because a thread buffer was full.
+uint64_t dropped_trace_spans();
+
+/// Span covering the lifetime of the object.
+/// When tracing is disabled, the span only costs a relaxed atomic load.
+class TraceSpan {
+public:
+    /// Constructor, starting the span if tracing is enabled.
+    /// @param name Span name, a string literal
+    explicit TraceSpan(const char* name) :
+        name_(is_tracing() ? name : nullptr),
+        start_(name_ ? trace_clock() : 0)
+    {
+    }
+
+    /// Destructor, recording the span if it was started.
+    ~TraceSpan()
+    {
+        if (name_) {
+            record_trace_span(name_, start_, trace_clock());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;  ///< Span name, nullptr if not recorded
+    uint64_t start_;    ///< Start time
+};
+
+} // namespace logger
+
+} // namespace cogip
+
+#define COGIP_TRACE_CONCAT_(a, b) a##b
+#define COGIP_TRACE_CONCAT(a, b) COGIP_TRACE_CONCAT_(a, b)
+
+/// Traces the enclosing scope under a name, which must be a string literal:
+/// `COGIP_TRACE_SPAN("Avoidance::dijkstra");`
+#define COGIP_TRACE_SPAN(name) \
+    ::cogip::logger::TraceSpan COGIP_TRACE_CONCAT(cogip_trace_span_, __LINE__)(name)
+
+/// @}
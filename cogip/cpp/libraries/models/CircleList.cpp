@@ -8,7 +8,7 @@ namespace cogip {
 
 namespace models {
 
-void CircleList::append(double x, double y, double radius)
+void CircleList::append(double x, double y, double radius, std::uint32_t id, double vx, double vy)
 {
     if (size() >= max_size()) {
         throw std::runtime_error("CircleList is full");
@@ -16,6 +16,9 @@ void CircleList::append(double x, double y, double radius)
     list_->elems[list_->count].x = x;
     list_->elems[list_->count].y = y;
     list_->elems[list_->count].radius = radius;
+    list_->elems[list_->count].id = id;
+    list_->elems[list_->count].vx = vx;
+    list_->elems[list_->count].vy = vy;
     list_->count++;
 }
 
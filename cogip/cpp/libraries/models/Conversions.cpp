@@ -0,0 +1,43 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "models/Conversions.hpp"
+#include "utils/trigonometry.hpp"
+
+#include <cmath>
+
+namespace cogip {
+
+namespace models {
+
+void polarToCoords(const polar_t* polars, std::size_t count, coords_t* coords, const pose_t* frame)
+{
+    double origin_x = frame ? frame->x : 0.0;
+    double origin_y = frame ? frame->y : 0.0;
+    double origin_angle = frame ? frame->angle : 0.0;
+    for (std::size_t i = 0; i < count; i++) {
+        // Both fields are read before writing, so the conversion also works in place.
+        double distance = polars[i].distance;
+        double angle_rad = DEG2RAD((polars[i].angle + origin_angle));
+        coords[i].x = origin_x + distance * std::cos(angle_rad);
+        coords[i].y = origin_y + distance * std::sin(angle_rad);
+    }
+}
+
+void coordsToPolar(const coords_t* coords, std::size_t count, polar_t* polars, const pose_t* frame)
+{
+    double origin_x = frame ? frame->x : 0.0;
+    double origin_y = frame ? frame->y : 0.0;
+    double origin_angle = frame ? frame->angle : 0.0;
+    for (std::size_t i = 0; i < count; i++) {
+        double dx = coords[i].x - origin_x;
+        double dy = coords[i].y - origin_y;
+        polars[i].distance = std::hypot(dx, dy);
+        polars[i].angle = utils::limit_angle_deg(RAD2DEG(std::atan2(dy, dx)) - origin_angle);
+    }
+}
+
+} // namespace models
+
+} // namespace cogip
@@ -3,6 +3,7 @@
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
 #include "models/Coords.hpp"
+#include "utils/predicates.hpp"
 
 #include <cmath>
 #include <cstring>
@@ -70,21 +71,7 @@ double Coords::distance(double x, double y) const
 
 bool Coords::on_segment(const Coords& a, const Coords& b) const
 {
-    bool res = false;
-
-    if ((b.x() - a.x()) / (b.y() - a.y()) == (b.x() - x()) / (b.y() - y())) {
-        if (a.x() < b.x()) {
-            if ((x() < b.x()) && (x() > a.x())) {
-                res = true;
-            }
-        }
-        else {
-            if ((x() < a.x()) && (x() > b.x())) {
-                res = true;
-            }
-        }
-    }
-    return res;
+    return utils::is_point_on_segment(x(), y(), a.x(), a.y(), b.x(), b.y());
 }
 
 } // namespace models
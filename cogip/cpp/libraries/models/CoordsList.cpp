@@ -13,17 +13,17 @@ void CoordsList::append(double x, double y)
     if (size() >= max_size()) {
         throw std::runtime_error("CoordsList is full");
     }
-    list_->elems[list_->count].x = x;
-    list_->elems[list_->count].y = y;
-    list_->count++;
+    elems_[*count_].x = x;
+    elems_[*count_].y = y;
+    (*count_)++;
 }
 
 void CoordsList::set(std::size_t index, double x, double y) {
     if (index >= size()) {
         throw std::runtime_error("index out of range");
     }
-    list_->elems[index].x = x;
-    list_->elems[index].y = y;
+    elems_[index].x = x;
+    elems_[index].y = y;
 }
 
 } // namespace models
@@ -4,8 +4,10 @@
 
 #include "models/PoseBuffer.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <time.h>
 
 namespace cogip {
 
@@ -15,14 +17,11 @@ PoseBuffer::PoseBuffer(pose_buffer_t* data):
     data_(data),
     external_data_(data != nullptr)
 {
+    // External data is initialized by its owner, so processes attaching to a shared buffer keep its poses.
     if (!external_data_) {
         // Allocate memory if external pointer is not provided
         data_ = new pose_buffer_t();
     }
-    data_->head = 0;
-    data_->tail = 0;
-    data_->full = false;
-
 }
 
 PoseBuffer::~PoseBuffer()
@@ -32,38 +31,119 @@ PoseBuffer::~PoseBuffer()
     }
 };
 
-std::size_t PoseBuffer::size() const
+void PoseBuffer::push(float x, float y, float angle)
 {
-    if (data_->full) return POSE_BUFFER_SIZE_MAX;
-    if (data_->head >= data_->tail) return data_->head - data_->tail;
-    return POSE_BUFFER_SIZE_MAX + data_->head - data_->tail;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    push(x, y, angle, static_cast<std::uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec);
 };
 
-void PoseBuffer::push(float x, float y, float angle)
+void PoseBuffer::push(float x, float y, float angle, std::uint64_t timestamp)
 {
-    data_->poses[data_->head].x = x;
-    data_->poses[data_->head].y = y;
-    data_->poses[data_->head].angle = angle;
-    if (data_->full) {
-        data_->tail = (data_->tail + 1) % POSE_BUFFER_SIZE_MAX; // Advance tail if full
-    }
-    data_->head = (data_->head + 1) % POSE_BUFFER_SIZE_MAX;
-    data_->full = (data_->head == data_->tail);
+    std::uint64_t write_index = data_->write_index.load(std::memory_order_relaxed);
+    std::size_t index = write_index % POSE_BUFFER_SIZE_MAX;
+    // Readers see the previous publication before the writes of the slot, so they detect the overwrite.
+    std::atomic_thread_fence(std::memory_order_release);
+    data_->timestamps[index] = timestamp;
+    data_->poses[index].x = x;
+    data_->poses[index].y = y;
+    data_->poses[index].angle = angle;
+    data_->write_index.store(write_index + 1, std::memory_order_release);
 };
 
 Pose PoseBuffer::get(std::size_t n) const
 {
-    if (size() == 0) {
-        return Pose(); // Return an empty Pose if the buffer is empty
-    }
+    pose_t pose = read_pose(n);
+    return size() ? Pose(pose.x, pose.y, pose.angle) : Pose();
+};
+
+pose_t PoseBuffer::read_pose(std::size_t n) const
+{
+    pose_t pose = {};
+    read([&](std::uint64_t write_index) {
+        std::size_t count = readableCount(write_index);
+        if (count == 0) {
+            pose = {};
+            return write_index;
+        }
+        // Adjust n to be within bounds
+        std::uint64_t number = write_index - 1 - std::min(n, count - 1);
+        pose = data_->poses[number % POSE_BUFFER_SIZE_MAX];
+        return number;
+    });
+    return pose;
+};
 
-    if (n >= size()) {
-        n = size() - 1; // Adjust n to be within bounds
+std::uint64_t PoseBuffer::timestamp(std::size_t n) const
+{
+    std::uint64_t timestamp = 0;
+    read([&](std::uint64_t write_index) {
+        std::size_t count = readableCount(write_index);
+        if (count == 0) {
+            timestamp = 0;
+            return write_index;
+        }
+        std::uint64_t number = write_index - 1 - std::min(n, count - 1);
+        timestamp = data_->timestamps[number % POSE_BUFFER_SIZE_MAX];
+        return number;
+    });
+    return timestamp;
+};
+
+Pose PoseBuffer::at_time(std::uint64_t timestamp) const
+{
+    std::size_t count = 0;
+    pose_t p0 = {};
+    pose_t p1 = {};
+    std::uint64_t t0 = 0;
+    std::uint64_t t1 = 0;
+    read([&](std::uint64_t write_index) {
+        count = readableCount(write_index);
+        std::uint64_t oldest = write_index - count;
+        if (count == 0) {
+            return oldest;
+        }
+
+        // Find the oldest pose not older than timestamp, indexes are counted from the oldest pose.
+        std::size_t low = 0;
+        std::size_t high = count;
+        while (low < high) {
+            std::size_t middle = (low + high) / 2;
+            if (data_->timestamps[(oldest + middle) % POSE_BUFFER_SIZE_MAX] < timestamp) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+
+        // Times outside of the buffer use the same pose on both sides.
+        std::size_t before = low == 0 ? 0 : (low == count ? count - 1 : low - 1);
+        std::size_t after = low == count ? count - 1 : low;
+        p0 = data_->poses[(oldest + before) % POSE_BUFFER_SIZE_MAX];
+        p1 = data_->poses[(oldest + after) % POSE_BUFFER_SIZE_MAX];
+        t0 = data_->timestamps[(oldest + before) % POSE_BUFFER_SIZE_MAX];
+        t1 = data_->timestamps[(oldest + after) % POSE_BUFFER_SIZE_MAX];
+        // The binary search read timestamps down to the oldest pose.
+        return oldest;
+    });
+
+    if (count == 0) {
+        return Pose();
     }
+    if (t1 <= t0) {
+        return Pose(p0.x, p0.y, p0.angle);
+    }
+
+    double ratio = static_cast<double>(timestamp - t0) / static_cast<double>(t1 - t0);
 
-    // Calculate index relative to head (reverse order)
-    size_t index = (data_->head + POSE_BUFFER_SIZE_MAX - 1 - n) % POSE_BUFFER_SIZE_MAX;
-    return Pose(&data_->poses[index]);
+    // Turn the shortest way between both orientations.
+    double angle = p0.angle + ratio * utils::limit_angle_deg(p1.angle - p0.angle);
+    return Pose(
+        p0.x + ratio * (p1.x - p0.x),
+        p0.y + ratio * (p1.y - p0.y),
+        utils::limit_angle_deg(angle)
+    );
 };
 
 } // namespace models
@@ -2,6 +2,7 @@
 // This file is subject to the terms and conditions of the GNU Lesser
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
+#include "models/Conversions.hpp"
 #include "models/CoordsList.hpp"
 #include "models/CircleList.hpp"
 #include "models/Pose.hpp"
@@ -12,7 +13,9 @@
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/string.h>
 
+#include <optional>
 #include <sstream>
+#include <stdexcept>
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -25,8 +28,66 @@ using CoordsIterator = NbSharedArrayIterator<Coords, CoordsList>;
 using CircleIterator = NbSharedArrayIterator<Circle, CircleList>;
 using PoseOrderIterator = NbSharedArrayIterator<PoseOrder, PoseOrderList>;
 
+/// Numpy structured dtype of circle_t.
+static nb::object circle_dtype()
+{
+    return nb_structured_dtype({
+        {"x", nb_format<double>(), offsetof(circle_t, x)},
+        {"y", nb_format<double>(), offsetof(circle_t, y)},
+        {"radius", nb_format<double>(), offsetof(circle_t, radius)},
+        {"id", nb_format<std::uint32_t>(), offsetof(circle_t, id)},
+        {"vx", nb_format<double>(), offsetof(circle_t, vx)},
+        {"vy", nb_format<double>(), offsetof(circle_t, vy)},
+    }, sizeof(circle_t));
+}
+
+/// Numpy array of points, one row of two doubles per point, such as [distance, angle] or [x, y].
+template <typename T>
+using PointsArray = nb::ndarray<T, nb::numpy, nb::shape<-1, 2>, nb::c_contig, nb::device::cpu>;
+
+/// Checks that an output array of points has the size of the input array.
+static void check_points_size(const PointsArray<const double>& input, const PointsArray<double>& output)
+{
+    if (output.shape(0) != input.shape(0)) {
+        throw std::invalid_argument(
+            "Output array has " + std::to_string(output.shape(0)) + " rows, expected " + std::to_string(input.shape(0))
+        );
+    }
+}
+
+/// Returns the pose_t of an optional Pose.
+static std::optional<pose_t> frame_pose(const Pose* frame)
+{
+    if (!frame) {
+        return std::nullopt;
+    }
+    return pose_t{frame->x(), frame->y(), frame->angle()};
+}
+
+/// Numpy structured dtype of pose_order_t.
+static nb::object pose_order_dtype()
+{
+    return nb_structured_dtype({
+        {"x", nb_format<double>(), offsetof(pose_order_t, x)},
+        {"y", nb_format<double>(), offsetof(pose_order_t, y)},
+        {"angle", nb_format<double>(), offsetof(pose_order_t, angle)},
+        {"max_speed_linear", nb_format<std::uint8_t>(), offsetof(pose_order_t, max_speed_linear)},
+        {"max_speed_angular", nb_format<std::uint8_t>(), offsetof(pose_order_t, max_speed_angular)},
+        {"motion_direction", nb_format<MotionDirection>(), offsetof(pose_order_t, motion_direction)},
+        {"bypass_anti_blocking", nb_format<bool>(), offsetof(pose_order_t, bypass_anti_blocking)},
+        {"bypass_final_orientation", nb_format<bool>(), offsetof(pose_order_t, bypass_final_orientation)},
+        {"timeout_ms", nb_format<std::uint32_t>(), offsetof(pose_order_t, timeout_ms)},
+        {"is_intermediate", nb_format<bool>(), offsetof(pose_order_t, is_intermediate)},
+        {"stop_before_distance", nb_format<double>(), offsetof(pose_order_t, stop_before_distance)},
+    }, sizeof(pose_order_t));
+}
+
 NB_MODULE(models, m) {
 
+    // Structured dtypes of the list elements, built once at import
+    nb::object circle_dtype_obj = circle_dtype();
+    nb::object pose_order_dtype_obj = pose_order_dtype();
+
     m.doc() = "models module for Python bindings";
 
     // Bind MotionDirection enum
@@ -80,6 +141,15 @@ NB_MODULE(models, m) {
         })
     ;
 
+    // Bind compact_coords_list_t structure
+    nb::class_<compact_coords_list_t>(m, "CompactCoordsListT")
+        .def("__repr__", [](const compact_coords_list_t& list) {
+            std::ostringstream oss;
+            oss << list;
+            return oss.str();
+        })
+    ;
+
     // Bind CoordsIterator class
     nb::class_<CoordsIterator>(m, "CoordsArrayIterator")
         .def("__next__", &CoordsIterator::next, "Get the next element")  // Python's equivalent of `__next__`
@@ -90,6 +160,7 @@ NB_MODULE(models, m) {
     // Bind CoordsList class
     nb::class_<CoordsList>(m, "CoordsList")
         .def(nb::init<coords_list_t*>(), "Constructor with existing data", "coords_list"_a = nullptr)
+        .def(nb::init<compact_coords_list_t*>(), "Constructor with existing compact data", "coords_list"_a)
         .def("clear", &CoordsList::clear, "Clear the list")
         .def("size", &CoordsList::size, "Get the number of coordinates")
         .def("max_size", &CoordsList::max_size, "Get the maximum number of coordinates")
@@ -100,7 +171,7 @@ NB_MODULE(models, m) {
         .def("set", nb::overload_cast<std::size_t, double, double>(&CoordsList::set), "Set coordinates at index", "index"_a, "x"_a, "y"_a)
         .def("set", nb::overload_cast<std::size_t, const Coords&>(&CoordsList::set), "Set Coords at index", "index"_a, "coords"_a)
         .def("__setitem__", nb::overload_cast<std::size_t, const Coords&>(&CoordsList::set), "Set Coords at index", "index"_a, "coords"_a)
-        .def("get_index", &CoordsList::getIndex, "Return index of elem or -1 if not found", "elem"_a)
+        .def("get_index", nb::overload_cast<const Coords&>(&CoordsList::getIndex, nb::const_), "Return index of elem or -1 if not found", "elem"_a)
         .def("__len__", &CoordsList::size, "Return the length of the list")
         .def("__iter__", [](CoordsList& self) { return CoordsIterator(self, 0); }, "Return an iterator object")
         .def("__repr__", [](const CoordsList& self) {
@@ -180,8 +251,8 @@ NB_MODULE(models, m) {
 
     // Bind pose_buffer_t structure
     nb::class_<pose_buffer_t>(m, "PoseBufferT")
-        .def_rw("head", &pose_buffer_t::head, "Next write pose")
-        .def_rw("tail", &pose_buffer_t::tail, "Oldest pose")
+        .def_prop_ro("write_index", [](const pose_buffer_t& buffer) { return buffer.write_index.load(std::memory_order_acquire); },
+                     "Number of poses pushed since the creation of the buffer")
         .def("__repr__", [](const pose_buffer_t& buffer) {
             std::ostringstream oss;
             oss << buffer;
@@ -194,9 +265,19 @@ NB_MODULE(models, m) {
         .def(nb::init<pose_buffer_t*>(), "Constructor", "data"_a = nullptr)
         .def_prop_ro("head", &PoseBuffer::head, "Next write pose")
         .def_prop_ro("tail", &PoseBuffer::tail, "Oldest pose")
-        .def("push", &PoseBuffer::push, "Get last pose pushed in the buffer", "x"_a, "y"_a, "angle"_a)
+        .def_prop_ro("write_index", &PoseBuffer::writeIndex, "Number of poses pushed since the creation of the buffer")
+        .def("size", &PoseBuffer::size, "Get the number of readable poses")
+        .def("push", nb::overload_cast<float, float, float>(&PoseBuffer::push),
+             "Add a new pose to the buffer, timestamped with the current monotonic time", "x"_a, "y"_a, "angle"_a)
+        .def("push", nb::overload_cast<float, float, float, std::uint64_t>(&PoseBuffer::push),
+             "Add a new pose to the buffer with its monotonic time (ns), see time.monotonic_ns()",
+             "x"_a, "y"_a, "angle"_a, "timestamp"_a)
         .def_prop_ro("last", &PoseBuffer::last, "Get last pose pushed in the buffer")
         .def("get", &PoseBuffer::get, "Get the N-th position from head (0 is the most recent)", "n"_a)
+        .def("timestamp", &PoseBuffer::timestamp,
+             "Get the monotonic time (ns) of the N-th position from head (0 is the most recent)", "n"_a)
+        .def("at_time", &PoseBuffer::at_time,
+             "Get the pose interpolated at a given monotonic time (ns), see time.monotonic_ns()", "timestamp"_a)
         .def("__repr__", [](const PoseBuffer &buffer) {
             std::ostringstream oss;
             oss << buffer;
@@ -318,6 +399,13 @@ NB_MODULE(models, m) {
         .def("__setitem__", nb::overload_cast<std::size_t, const PoseOrder&>(&PoseOrderList::set), "Set PoseOrder at index", "index"_a, "pose_order"_a)
         .def("__len__", &PoseOrderList::size, "Return the length of the list")
         .def("__iter__", [](PoseOrderList& self) { return PoseOrderIterator(self, 0); }, "Return an iterator object")
+        .def_prop_ro_static("dtype", [pose_order_dtype_obj](nb::handle) { return pose_order_dtype_obj; }, "Numpy structured dtype of the pose orders")
+        .def("as_ndarray", [pose_order_dtype_obj](nb::handle_t<PoseOrderList> self) {
+            return nb_list_view(nb::cast<PoseOrderList&>(self), self, pose_order_dtype_obj);
+        }, "Return a numpy view of the pose orders, without copy")
+        .def("assign_from_ndarray", [pose_order_dtype_obj](PoseOrderList& self, nb::handle array) {
+            nb_list_assign(self, array, pose_order_dtype_obj);
+        }, "Replace all pose orders by the elements of a numpy array of dtype PoseOrderList.dtype", "array"_a)
         .def("__repr__", [](const PoseOrderList& self) {
             std::ostringstream oss;
             oss << "PoseOrderList(size=" << self.size() << ", max_size=" << self.max_size() << ")";
@@ -330,6 +418,9 @@ NB_MODULE(models, m) {
         .def_rw("x", &circle_t::x, "X coordinate")
         .def_rw("y", &circle_t::y, "Y coordinate")
         .def_rw("radius", &circle_t::radius, "Radius")
+        .def_rw("id", &circle_t::id, "Identifier of the tracked obstacle, 0 if not tracked")
+        .def_rw("vx", &circle_t::vx, "Velocity along X of the tracked obstacle (mm/s)")
+        .def_rw("vy", &circle_t::vy, "Velocity along Y of the tracked obstacle (mm/s)")
     ;
 
     // Bind Circle class
@@ -347,6 +438,9 @@ NB_MODULE(models, m) {
         .def_prop_rw("y", &Circle::y, &Circle::set_y, "Get or set the Y coordinate")
         .def_prop_rw("coords", &Circle::coords, &Circle::set_coords, "Get/set coordinates to/from a Coords object")
         .def_prop_rw("radius", &Circle::radius, &Circle::set_radius, "Get or set the radius")
+        .def_prop_rw("id", &Circle::id, &Circle::set_id, "Get or set the identifier of the tracked obstacle, 0 if not tracked")
+        .def_prop_rw("vx", &Circle::vx, &Circle::set_vx, "Get or set the velocity along X of the tracked obstacle (mm/s)")
+        .def_prop_rw("vy", &Circle::vy, &Circle::set_vy, "Get or set the velocity along Y of the tracked obstacle (mm/s)")
         .def("__eq__", [](const Circle &self, const Circle &other) { return self == other; }, "Equality operator for Circle")
         .def(
             "__repr__",
@@ -383,20 +477,62 @@ NB_MODULE(models, m) {
         .def("max_size", &CircleList::max_size, "Get the maximum number of circles")
         .def("get", &CircleList::get, "Get Circle at index", "index"_a)
         .def("__getitem__", &CircleList::operator[], "Get Circle at index", "index"_a)
-        .def("append", nb::overload_cast<double, double, double>(&CircleList::append), "Append circle", "x"_a, "y"_a, "radius"_a = 0.0)
+        .def("append", nb::overload_cast<double, double, double, std::uint32_t, double, double>(&CircleList::append), "Append circle",
+             "x"_a, "y"_a, "radius"_a = 0.0, "id"_a = 0, "vx"_a = 0.0, "vy"_a = 0.0)
         .def("append", nb::overload_cast<const Circle&>(&CircleList::append), "Append Circle", "circle"_a)
         .def("set", nb::overload_cast<std::size_t, double, double, double>(&CircleList::set), "Set circle at index", "index"_a, "x"_a, "y"_a, "radius"_a = 0.0)
         .def("set", nb::overload_cast<std::size_t, const Circle&>(&CircleList::set), "Set Circle at index", "index"_a, "circle"_a)
         .def("__setitem__", nb::overload_cast<std::size_t, const Circle&>(&CircleList::set), "Set Circle at index", "index"_a, "circle"_a)
-        .def("get_index", &CircleList::getIndex, "Return index of elem or -1 if not found", "elem"_a)
+        .def("get_index", nb::overload_cast<const Circle&>(&CircleList::getIndex, nb::const_), "Return index of elem or -1 if not found", "elem"_a)
         .def("__len__", &CircleList::size, "Return the length of the list")
         .def("__iter__", [](CircleList& self) { return CircleIterator(self, 0); }, "Return an iterator object")
+        .def_prop_ro_static("dtype", [circle_dtype_obj](nb::handle) { return circle_dtype_obj; }, "Numpy structured dtype of the circles")
+        .def("as_ndarray", [circle_dtype_obj](nb::handle_t<CircleList> self) {
+            return nb_list_view(nb::cast<CircleList&>(self), self, circle_dtype_obj);
+        }, "Return a numpy view of the circles, without copy")
+        .def("assign_from_ndarray", [circle_dtype_obj](CircleList& self, nb::handle array) {
+            nb_list_assign(self, array, circle_dtype_obj);
+        }, "Replace all circles by the elements of a numpy array of dtype CircleList.dtype", "array"_a)
         .def("__repr__", [](const CircleList& self) {
             std::ostringstream oss;
             oss << "CircleList(size=" << self.size() << ", max_size=" << self.max_size() << ")";
             return oss.str();
         })
     ;
+
+    // Bind batch conversions
+    m.def(
+        "polar_to_coords",
+        [](PointsArray<const double> polars, PointsArray<double> coords, const Pose* frame) {
+            check_points_size(polars, coords);
+            std::optional<pose_t> pose = frame_pose(frame);
+            nb::gil_scoped_release release;
+            polarToCoords(
+                reinterpret_cast<const polar_t*>(polars.data()), polars.shape(0),
+                reinterpret_cast<coords_t*>(coords.data()), pose ? &*pose : nullptr
+            );
+        },
+        "polars"_a, "coords"_a, "frame"_a = nb::none(),
+        "Convert an array of [distance, angle] rows (degrees) to [x, y] rows written in the coords array,\n"
+        "relative to the frame pose if given, such as lidar points relative to the robot to table coordinates.\n"
+        "The arrays must have the same number of rows, they may be the same array, nothing is allocated."
+    );
+    m.def(
+        "coords_to_polar",
+        [](PointsArray<const double> coords, PointsArray<double> polars, const Pose* frame) {
+            check_points_size(coords, polars);
+            std::optional<pose_t> pose = frame_pose(frame);
+            nb::gil_scoped_release release;
+            coordsToPolar(
+                reinterpret_cast<const coords_t*>(coords.data()), coords.shape(0),
+                reinterpret_cast<polar_t*>(polars.data()), pose ? &*pose : nullptr
+            );
+        },
+        "coords"_a, "polars"_a, "frame"_a = nb::none(),
+        "Convert an array of [x, y] rows to [distance, angle] rows (degrees, in [-180, 180]) written in the polars array,\n"
+        "relative to the frame pose if given. The arrays must have the same number of rows, they may be the same array,\n"
+        "nothing is allocated."
+    );
 }
 
 } // namespace models
@@ -76,6 +76,30 @@ public:
         double radius              ///< [in] new radius
     ) { data_->radius = radius; };
 
+    /// Return the identifier of the tracked obstacle, 0 if not tracked.
+    std::uint32_t id(void) const { return data_->id; };
+
+    /// Set the identifier of the tracked obstacle.
+    void set_id(
+        std::uint32_t id           ///< [in] new identifier
+    ) { data_->id = id; };
+
+    /// Return the velocity along X of the tracked obstacle (mm/s).
+    double vx(void) const { return data_->vx; };
+
+    /// Set the velocity along X of the tracked obstacle.
+    void set_vx(
+        double vx                  ///< [in] new velocity along X (mm/s)
+    ) { data_->vx = vx; };
+
+    /// Return the velocity along Y of the tracked obstacle (mm/s).
+    double vy(void) const { return data_->vy; };
+
+    /// Set the velocity along Y of the tracked obstacle.
+    void set_vy(
+        double vy                  ///< [in] new velocity along Y (mm/s)
+    ) { data_->vy = vy; };
+
     /// Check if this circle is equal to another.
     /// @return true if circles are equal, false otherwise
     bool operator == (
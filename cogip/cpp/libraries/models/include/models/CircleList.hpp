@@ -20,10 +20,18 @@ namespace cogip {
 
 namespace models {
 
+/// Circles are equal if they have the same center and radius, like `Circle`.
+template <>
+struct ElemEqual<circle_t> {
+    bool operator()(const circle_t& a, const circle_t& b) const {
+        return a.x == b.x && a.y == b.y && a.radius == b.radius;
+    }
+};
+
 class CircleList: public List<circle_t, Circle, circle_list_t, CIRCLE_LIST_SIZE_MAX> {
 public:
     CircleList(circle_list_t* list = nullptr) : List(list) {};
-    void append(double x, double y, double radius = 0.0);
+    void append(double x, double y, double radius = 0.0, std::uint32_t id = 0, double vx = 0.0, double vy = 0.0);
     void append(const circle_t* elem) { append(elem->x, elem->y); };
     void append(const Circle& elem) { append(elem.x(), elem.y()); };
     void set(std::size_t index, double x, double y, double radius = 0.0);
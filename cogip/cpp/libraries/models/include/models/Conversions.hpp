@@ -0,0 +1,51 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_models
+/// @{
+/// @file
+/// @brief       Batch conversions between polar and Cartesian coordinates
+/// @author      Eric Courtois <eric.courtois@gmail.com>
+
+#pragma once
+
+#include "models/coords.hpp"
+#include "models/polar.hpp"
+#include "models/pose.hpp"
+
+#include <cstddef>
+
+namespace cogip {
+
+namespace models {
+
+static_assert(sizeof(polar_t) == 2 * sizeof(double), "polar_t must be viewable as [distance, angle] rows");
+static_assert(sizeof(coords_t) == 2 * sizeof(double), "coords_t must be viewable as [x, y] rows");
+
+/// Converts polar coordinates to Cartesian coordinates.
+/// Angles are in degrees. Without frame, polars are relative to the origin and the X axis.
+/// With a frame, they are relative to its position and orientation, and coords are in the frame of the pose,
+/// such as lidar points relative to the robot converted to table coordinates.
+/// No memory is allocated.
+/// @param polars Polar coordinates to convert.
+/// @param count Number of coordinates.
+/// @param[out] coords Cartesian coordinates, count elements provided by the caller, may be the polars array itself.
+/// @param frame Pose the polar coordinates are relative to, or nullptr.
+void polarToCoords(const polar_t* polars, std::size_t count, coords_t* coords, const pose_t* frame = nullptr);
+
+/// Converts Cartesian coordinates to polar coordinates, the inverse of polarToCoords().
+/// Angles are in degrees, in [-180, 180]. With a frame, polars are relative to its position and orientation,
+/// like `Pose::operator-`.
+/// No memory is allocated.
+/// @param coords Cartesian coordinates to convert.
+/// @param count Number of coordinates.
+/// @param[out] polars Polar coordinates, count elements provided by the caller, may be the coords array itself.
+/// @param frame Pose the polar coordinates are relative to, or nullptr.
+void coordsToPolar(const coords_t* coords, std::size_t count, polar_t* polars, const pose_t* frame = nullptr);
+
+} // namespace models
+
+} // namespace cogip
+
+/// @}
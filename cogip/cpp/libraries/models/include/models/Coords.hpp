@@ -79,7 +79,8 @@ public:
     ) const { return distance(dest.x(), dest.y()); };
 
     /// Check if this Coords is placed on a segment defined by two Coords A,B.
-    /// @return true if on [AB], false otherwise
+    /// Collinearity is tested with an exact orientation predicate.
+    /// @return true if on [AB], endpoints excluded, false otherwise
     bool on_segment(
         const Coords& a,    ///< [in] point A
         const Coords& b     ///< [in] point A
@@ -12,23 +12,115 @@
 
 #include "models/coords_list.hpp"
 #include "models/Coords.hpp"
-#include "models/List.hpp"
+#include "models/Span.hpp"
+#include "models/Vec2.hpp"
 
 #include <ostream>
+#include <stdexcept>
 
 namespace cogip {
 
 namespace models {
 
-class CoordsList: public List<coords_t, Coords, coords_list_t, COORDS_LIST_SIZE_MAX> {
+/// List of coords wrapping a coords list structure of any maximum size.
+/// Unlike the other lists, the maximum size is known at runtime,
+/// so the same class wraps both the full and the compact coords lists.
+class CoordsList {
 public:
-    CoordsList(coords_list_t* list = nullptr) : List(list) {};
+    /// Constructor.
+    /// @param list Pointer to an existing data structure.
+    ///             If nullptr, will allocate a full one internally.
+    CoordsList(coords_list_t* list = nullptr):
+        owned_list_(list == nullptr ? new coords_list_t() : nullptr),
+        count_(list == nullptr ? &owned_list_->count : &list->count),
+        elems_(list == nullptr ? owned_list_->elems : list->elems),
+        max_size_(COORDS_LIST_SIZE_MAX)
+    {
+    };
+
+    /// Constructor wrapping an existing data structure of another maximum size.
+    /// @param list Pointer to an existing data structure.
+    template <std::size_t N>
+    CoordsList(basic_coords_list_t<N>* list):
+        owned_list_(nullptr),
+        count_(&list->count),
+        elems_(list->elems),
+        max_size_(N)
+    {
+    };
+
+    /// Destructor.
+    ~CoordsList() { delete owned_list_; };
+
+    void clear() { *count_ = 0; };
+
+    std::size_t size() const { return *count_; };
+
+    std::size_t max_size() const { return max_size_; };
+
+    coords_t* get_data(std::size_t index) {
+        if (index >= size()) {
+            throw std::runtime_error("index out of range");
+        }
+        return &elems_[index];
+    };
+
+    Coords get(std::size_t index) { return Coords(get_data(index)); };
+
+    Coords operator[](std::size_t index) { return get(index); }
+
+    /// Return a view on the used coords, iterating their structures without wrapper nor range check.
+    Span<coords_t> view() { return Span<coords_t>(elems_, *count_); };
+
+    /// Return a read-only view on the used coords, see view().
+    Span<const coords_t> view() const { return Span<const coords_t>(elems_, *count_); };
+
+    int getIndex(const Coords &elem) const {
+        for (std::size_t i{0}; i < size(); ++i) {
+            if (elem == elems_[i]) {
+                return i;
+            }
+        }
+        return -1;
+    };
+
+    int getIndex(const Vec2 &elem) const {
+        for (std::size_t i{0}; i < size(); ++i) {
+            if (elem == elems_[i]) {
+                return i;
+            }
+        }
+        return -1;
+    };
+
     void append(double x, double y);
     void append(const coords_t* elem) { append(elem->x, elem->y); };
     void append(const Coords& elem) { append(elem.x(), elem.y()); };
     void set(std::size_t index, double x, double y);
     void set(std::size_t index, const coords_t* elem) { set(index, elem->x, elem->y); };
     void set(std::size_t index, const Coords& elem) { set(index, elem.x(), elem.y()); };
+
+    // Iterator class
+    class Iterator {
+    public:
+        Iterator(coords_t* ptr) : ptr_(ptr) {}
+        Iterator operator++() { ++ptr_; return *this; }
+        bool operator!=(const Iterator& other) const { return ptr_ != other.ptr_; }
+        const Coords operator*() const { return Coords(ptr_); }
+
+    protected:
+        coords_t* ptr_;
+    };
+
+    // Iterator methods
+    Iterator begin() const { return Iterator(&elems_[0]); }
+    Iterator end() const { return Iterator(&elems_[*count_]); }
+
+private:
+    coords_list_t* owned_list_;  ///< Data structure allocated internally, nullptr if externally managed
+    std::size_t* count_;         ///< Pointer to the number of coords
+    coords_t* elems_;            ///< Pointer to the coords
+    std::size_t max_size_;       ///< Maximum number of coords of the data structure
 };
 
 /// Overloads the stream insertion operator for `CoordsList`.
@@ -10,6 +10,9 @@
 
 #pragma once
 
+#include "models/Span.hpp"
+
+#include <algorithm>
 #include <cstddef>
 #include <stdexcept>
 
@@ -17,6 +20,14 @@ namespace cogip {
 
 namespace models {
 
+/// Equality of two element structures of a list, used by List::getIndex() on structures.
+/// The default uses the equality operator of the structure,
+/// element types without one specialize it with the comparison of their fields.
+template <typename ElemTypeC>
+struct ElemEqual {
+    bool operator()(const ElemTypeC& a, const ElemTypeC& b) const { return a == b; }
+};
+
 template<
     typename ElemTypeC,
     typename ElemTypeCpp,
@@ -51,6 +62,9 @@ public:
 
     std::size_t max_size() const { return LIST_SIZE_MAX; };
 
+    /// Maximum number of elements, known at compile time.
+    static constexpr std::size_t capacity() { return LIST_SIZE_MAX; };
+
     ElemTypeC* get_data(std::size_t index) {
         if (index >= size()) {
             throw std::runtime_error("index out of range");
@@ -60,8 +74,28 @@ public:
 
     ElemTypeCpp get(std::size_t index) { return ElemTypeCpp(get_data(index)); };
 
+    /// Return the underlying array of elements, of which the first size() are used.
+    ElemTypeC* data() { return list_->elems; };
+
+    /// Replace all elements by a copy of an array of elements.
+    /// @param elems First element to copy.
+    /// @param count Number of elements to copy.
+    void assign(const ElemTypeC* elems, std::size_t count) {
+        if (count > LIST_SIZE_MAX) {
+            throw std::runtime_error("too many elements");
+        }
+        std::copy(elems, elems + count, list_->elems);
+        list_->count = count;
+    };
+
     ElemTypeCpp operator[](std::size_t index) { return get(index); }
 
+    /// Return a view on the used elements, iterating their structures without wrapper nor range check.
+    Span<ElemTypeC> view() { return Span<ElemTypeC>(list_->elems, list_->count); };
+
+    /// Return a read-only view on the used elements, see view().
+    Span<const ElemTypeC> view() const { return Span<const ElemTypeC>(list_->elems, list_->count); };
+
     int getIndex(const ElemTypeCpp &elem) const {
         for (std::size_t i{0}; i < size(); ++i) {
             if (elem == list_->elems[i]) {
@@ -71,6 +105,15 @@ public:
         return -1;
     };
 
+    /// Return the index of the first element equal to a structure, -1 if not found.
+    /// Elements are compared with ElemEqual, without building any wrapper.
+    int getIndex(const ElemTypeC &elem) const {
+        const ElemTypeC* found = std::find_if(list_->elems, list_->elems + size(), [&](const ElemTypeC& other) {
+            return ElemEqual<ElemTypeC>()(elem, other);
+        });
+        return found == list_->elems + size() ? -1 : static_cast<int>(found - list_->elems);
+    };
+
     // Iterator class
     class Iterator {
     public:
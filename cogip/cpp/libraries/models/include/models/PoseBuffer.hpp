@@ -13,12 +13,20 @@
 #include "models/pose_buffer.hpp"
 #include "models/Pose.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <ostream>
 
 namespace cogip {
 
 namespace models {
 
+/// Circular buffer of timestamped poses, with a single producer and any number of lock-free consumers.
+///
+/// Only one thread or process pushes poses. Readers never take a lock and never delay the producer:
+/// they copy the poses they need, then check with the write index that the producer did not overwrite them
+/// meanwhile, and read again if it did. To leave the producer one free slot to write,
+/// at most POSE_BUFFER_SIZE_MAX - 1 poses are readable.
 class PoseBuffer {
 public:
     /// Constructor.
@@ -33,27 +41,74 @@ public:
     /// Return the pointer to the underlying data structure.
     pose_buffer_t* data() { return data_; };
 
+    /// Return the number of poses pushed since the creation of the buffer.
+    std::uint64_t writeIndex() const { return data_->write_index.load(std::memory_order_acquire); };
+
     /// Return head.
-    double head() const { return data_->head; };
+    double head() const { return writeIndex() % POSE_BUFFER_SIZE_MAX; };
 
     /// Return tail.
-    double tail() const { return data_->tail; };
+    double tail() const { return (writeIndex() - size()) % POSE_BUFFER_SIZE_MAX; };
 
     /// Return true if the buffer is full, false otherwise.
-    double full() const { return data_->full; };
+    double full() const { return size() == POSE_BUFFER_SIZE_MAX - 1; };
 
     /// Get the number of stored positions
-    std::size_t size() const;
+    std::size_t size() const { return readableCount(writeIndex()); };
 
-    /// Add a new pose to the buffer.
+    /// Add a new pose to the buffer, timestamped with the current CLOCK_MONOTONIC time.
     void push(float x, float y, float angle);
 
+    /// Add a new pose to the buffer with its CLOCK_MONOTONIC time (ns).
+    /// Timestamps must not decrease from one push to the next.
+    void push(float x, float y, float angle, std::uint64_t timestamp);
+
     /// Get last pose pushed in the buffer.
-    Pose last() const { return size() ? get(0) : Pose(); };
+    Pose last() const { return get(0); };
 
-    /// Get the N-th position from head (0 is the most recent).
+    /// Get a copy of the N-th position from head (0 is the most recent).
+    /// Returns a null pose if the buffer is empty.
     Pose get(std::size_t n) const;
 
+    /// Get a copy of the N-th position from head (0 is the most recent), without allocating a Pose.
+    /// Returns a null pose if the buffer is empty.
+    pose_t read_pose(std::size_t n) const;
+
+    /// Get the CLOCK_MONOTONIC time (ns) of the N-th position from head (0 is the most recent).
+    /// Returns 0 if the buffer is empty.
+    std::uint64_t timestamp(std::size_t n) const;
+
+    /// Get the pose at a given CLOCK_MONOTONIC time (ns).
+    /// The two poses around the time are found by binary search and interpolated,
+    /// times outside of the buffer return the oldest or the most recent pose.
+    /// The returned pose owns its data.
+    Pose at_time(std::uint64_t timestamp) const;
+
+    /// Reads poses of the buffer without blocking the producer.
+    /// @param read Function reading the poses, given the write index. It returns the number of the oldest pose
+    ///             it read, and runs again if that pose was overwritten meanwhile, so it must not have side effects
+    ///             outside of its output. Pose number k is at index k % POSE_BUFFER_SIZE_MAX, the readable poses
+    ///             are the readableCount() poses before the write index.
+    template <typename Read>
+    void read(Read&& read) const
+    {
+        while (true) {
+            std::uint64_t write_index = data_->write_index.load(std::memory_order_acquire);
+            std::uint64_t oldest = read(write_index);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // The producer writes pose k while the write index is k, its slot is the one of pose k - POSE_BUFFER_SIZE_MAX.
+            if (data_->write_index.load(std::memory_order_relaxed) < oldest + POSE_BUFFER_SIZE_MAX) {
+                return;
+            }
+        }
+    }
+
+    /// Number of readable poses for a given write index.
+    static std::size_t readableCount(std::uint64_t write_index)
+    {
+        return write_index < POSE_BUFFER_SIZE_MAX - 1 ? write_index : POSE_BUFFER_SIZE_MAX - 1;
+    }
+
 protected:
     pose_buffer_t* data_;   ///< pointer to internal data structure
     bool external_data_;    ///< Flag to indicate if memory is externally managed
@@ -0,0 +1,74 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_models
+/// @{
+/// @file
+/// @brief       PoseValue declaration
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include "models/pose.hpp"
+#include "models/Pose.hpp"
+#include "models/Vec2.hpp"
+
+#include <ostream>
+#include <type_traits>
+
+namespace cogip {
+
+namespace models {
+
+/// Pose stored by value, the counterpart of Pose as Vec2 is of Coords.
+struct PoseValue {
+    double x = 0.0;      ///< X coordinate.
+    double y = 0.0;      ///< Y coordinate.
+    double angle = 0.0;  ///< Orientation angle in degrees.
+
+    /// Constructor of the null pose.
+    constexpr PoseValue() = default;
+
+    /// Constructor with initial values.
+    constexpr PoseValue(
+        double x,           ///< [in] X coordinate
+        double y,           ///< [in] Y coordinate
+        double angle=0.0    ///< [in] orientation
+    ) : x(x), y(y), angle(angle) {}
+
+    /// Constructor from a pose_t.
+    constexpr PoseValue(
+        const pose_t& pose  ///< [in] pose to copy
+    ) : x(pose.x), y(pose.y), angle(pose.angle) {}
+
+    /// Constructor from a Pose.
+    explicit PoseValue(
+        const Pose& pose    ///< [in] pose to copy
+    ) : x(pose.x()), y(pose.y()), angle(pose.angle()) {}
+
+    /// Return coordinates.
+    constexpr Vec2 coords() const { return {x, y}; }
+
+    /// Check if this pose is equal to another.
+    constexpr bool operator==(const PoseValue& other) const {
+        return x == other.x && y == other.y && angle == other.angle;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<PoseValue>, "PoseValue must be trivially copyable");
+
+/// Overloads the stream insertion operator for `PoseValue`.
+/// @param os The output stream.
+/// @param pose The pose to print.
+/// @return A reference to the output stream.
+inline std::ostream& operator<<(std::ostream& os, const PoseValue& pose) {
+    os << "PoseValue(x=" << pose.x << ", y=" << pose.y << ", angle=" << pose.angle << ")";
+    return os;
+}
+
+} // namespace models
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,51 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_models
+/// @{
+/// @file
+/// @brief       Span class declaration
+/// @author      Eric Courtois <eric.courtois@gmail.com>
+
+#pragma once
+
+#include <cstddef>
+
+namespace cogip {
+
+namespace models {
+
+/// View on contiguous elements of a list, giving direct access to their structures.
+/// Accesses are not range-checked and build no wrapper, so hot loops iterate the raw structures.
+/// The view is invalidated if the list is resized.
+template <typename T>
+class Span {
+public:
+    /// Constructor.
+    /// @param data First element.
+    /// @param size Number of elements.
+    constexpr Span(T* data, std::size_t size): data_(data), size_(size) {}
+
+    constexpr T* data() const { return data_; }
+
+    constexpr std::size_t size() const { return size_; }
+
+    constexpr bool empty() const { return size_ == 0; }
+
+    constexpr T& operator[](std::size_t index) const { return data_[index]; }
+
+    constexpr T* begin() const { return data_; }
+
+    constexpr T* end() const { return data_ + size_; }
+
+private:
+    T* data_;           ///< First element
+    std::size_t size_;  ///< Number of elements
+};
+
+} // namespace models
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,115 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_models
+/// @{
+/// @file
+/// @brief       Vec2 declaration
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include "models/coords.hpp"
+#include "models/Coords.hpp"
+#include "utils/predicates.hpp"
+
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
+namespace cogip {
+
+namespace models {
+
+/// Coordinates along X and Y axis, stored by value.
+///
+/// Unlike Coords, which wraps a coords_t that may be allocated on the heap
+/// and is read through virtual accessors, Vec2 is a plain value:
+/// temporaries live on the stack and accesses are inlined.
+/// It is meant for geometry in hot paths, Coords remains the type used by the Python bindings.
+struct Vec2 {
+    double x = 0.0;  ///< X coordinate.
+    double y = 0.0;  ///< Y coordinate.
+
+    /// Constructor of the origin.
+    constexpr Vec2() = default;
+
+    /// Constructor with initial values.
+    constexpr Vec2(
+        double x,   ///< [in] X coordinate
+        double y    ///< [in] Y coordinate
+    ) : x(x), y(y) {}
+
+    /// Constructor from a coords_t.
+    constexpr Vec2(
+        const coords_t& coords  ///< [in] coordinates to copy
+    ) : x(coords.x), y(coords.y) {}
+
+    /// Constructor from a Coords.
+    explicit Vec2(
+        const Coords& coords    ///< [in] coordinates to copy
+    ) : x(coords.x()), y(coords.y()) {}
+
+    /// Vector sum.
+    constexpr Vec2 operator+(const Vec2& other) const { return {x + other.x, y + other.y}; }
+
+    /// Vector difference.
+    constexpr Vec2 operator-(const Vec2& other) const { return {x - other.x, y - other.y}; }
+
+    /// Opposite vector.
+    constexpr Vec2 operator-() const { return {-x, -y}; }
+
+    /// Product by a scalar.
+    constexpr Vec2 operator*(double factor) const { return {x * factor, y * factor}; }
+
+    /// Dot product.
+    constexpr double dot(const Vec2& other) const { return x * other.x + y * other.y; }
+
+    /// Z component of the cross product.
+    constexpr double cross(const Vec2& other) const { return x * other.y - y * other.x; }
+
+    /// Vector norm.
+    double norm() const { return std::hypot(x, y); }
+
+    /// Compute the distance to the destination.
+    double distance(
+        double x,           ///< [in] X destination
+        double y            ///< [in] Y destination
+    ) const { return std::sqrt((x - this->x) * (x - this->x) + (y - this->y) * (y - this->y)); }
+
+    double distance(
+        const Vec2& dest    ///< [in] destination
+    ) const { return distance(dest.x, dest.y); }
+
+    /// Check if this point is placed on a segment defined by two points A,B.
+    /// Same test as Coords::on_segment(), exact for collinear points.
+    /// @return true if on [AB], endpoints excluded, false otherwise
+    bool on_segment(
+        const Vec2& a,      ///< [in] point A
+        const Vec2& b       ///< [in] point B
+    ) const { return utils::is_point_on_segment(x, y, a.x, a.y, b.x, b.y); }
+
+    /// Check if this point is equal to another.
+    constexpr bool operator==(const Vec2& other) const { return x == other.x && y == other.y; }
+
+    /// Check if this point is equal to a coords_t.
+    constexpr bool operator==(const coords_t& other) const { return x == other.x && y == other.y; }
+};
+
+static_assert(std::is_trivially_copyable_v<Vec2>, "Vec2 must be trivially copyable");
+
+/// Overloads the stream insertion operator for `Vec2`.
+/// @param os The output stream.
+/// @param vec The point to print.
+/// @return A reference to the output stream.
+inline std::ostream& operator<<(std::ostream& os, const Vec2& vec) {
+    os << "Vec2(x=" << vec.x << ", y=" << vec.y << ")";
+    return os;
+}
+
+} // namespace models
+
+} // namespace cogip
+
+/// @}
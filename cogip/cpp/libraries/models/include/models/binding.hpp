@@ -10,7 +10,18 @@
 
 #pragma once
 
+#include "models/coords.hpp"
+#include "models/coords_list.hpp"
+#include "models/pose.hpp"
+
 #include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -45,6 +56,116 @@ private:
     std::size_t index_; ///< Current index in the array.
 };
 
+/// Field of a C structure, described for a numpy structured dtype.
+struct NbField {
+    const char* name;    ///< Field name.
+    nb::object format;   ///< Numpy format of the field: type string, dtype or (dtype, shape) tuple.
+    std::size_t offset;  ///< Offset of the field in the structure.
+};
+
+/// Returns the numpy type string of a scalar type.
+template <typename T>
+nb::object nb_format()
+{
+    if constexpr (std::is_enum_v<T>) {
+        return nb_format<std::underlying_type_t<T>>();
+    }
+    else if constexpr (std::is_same_v<T, bool>) {
+        return nb::str("?");
+    }
+    else {
+        const char* kind = std::is_floating_point_v<T> ? "f" : (std::is_unsigned_v<T> ? "u" : "i");
+        return nb::str((kind + std::to_string(sizeof(T))).c_str());
+    }
+}
+
+/// Builds a numpy structured dtype with the layout of a C structure.
+/// @param fields Fields of the structure.
+/// @param itemsize Size of the structure, including padding.
+inline nb::object nb_structured_dtype(std::initializer_list<NbField> fields, std::size_t itemsize)
+{
+    nb::list names;
+    nb::list formats;
+    nb::list offsets;
+    for (const NbField& field : fields) {
+        names.append(field.name);
+        formats.append(field.format);
+        offsets.append(field.offset);
+    }
+    nb::dict spec;
+    spec["names"] = names;
+    spec["formats"] = formats;
+    spec["offsets"] = offsets;
+    spec["itemsize"] = itemsize;
+    return nb::module_::import_("numpy").attr("dtype")(spec);
+}
+
+/// Numpy structured dtype of coords_t.
+inline nb::object nb_coords_dtype()
+{
+    return nb_structured_dtype({
+        {"x", nb_format<double>(), offsetof(coords_t, x)},
+        {"y", nb_format<double>(), offsetof(coords_t, y)},
+    }, sizeof(coords_t));
+}
+
+/// Numpy structured dtype of pose_t.
+inline nb::object nb_pose_dtype()
+{
+    return nb_structured_dtype({
+        {"x", nb_format<double>(), offsetof(pose_t, x)},
+        {"y", nb_format<double>(), offsetof(pose_t, y)},
+        {"angle", nb_format<double>(), offsetof(pose_t, angle)},
+    }, sizeof(pose_t));
+}
+
+/// Numpy structured dtype of a coords list structure, all its entries included.
+template <std::size_t N>
+nb::object nb_coords_list_dtype()
+{
+    return nb_structured_dtype({
+        {"count", nb_format<std::size_t>(), offsetof(basic_coords_list_t<N>, count)},
+        {"elems", nb::make_tuple(nb_coords_dtype(), nb::make_tuple(N)), offsetof(basic_coords_list_t<N>, elems)},
+    }, sizeof(basic_coords_list_t<N>));
+}
+
+/// Returns a numpy view of the used elements of a list, with a structured dtype.
+/// Nothing is copied: the view reads and writes the list memory, shared memory included.
+/// It keeps the list alive, and its size is the list size when the view was created.
+/// @param list The list.
+/// @param owner Python object owning the list memory.
+/// @param dtype Structured dtype of the list elements.
+template <typename ListType>
+nb::object nb_list_view(ListType& list, nb::handle owner, nb::handle dtype)
+{
+    using ElemType = std::remove_pointer_t<decltype(list.data())>;
+    nb::ndarray<std::uint8_t, nb::numpy, nb::ndim<2>> bytes(
+        list.data(), {list.size(), sizeof(ElemType)}, owner
+    );
+    return bytes.cast().attr("view")(dtype).attr("reshape")(-1);
+}
+
+/// Replaces the elements of a list by the elements of a numpy array, in a single copy.
+/// @param list The list.
+/// @param array One-dimensional array with the structured dtype of the list elements.
+/// @param dtype Structured dtype of the list elements.
+template <typename ListType>
+void nb_list_assign(ListType& list, nb::handle array, nb::handle dtype)
+{
+    using ElemType = std::remove_pointer_t<decltype(list.data())>;
+    nb::module_ np = nb::module_::import_("numpy");
+    nb::object source = np.attr("asarray")(array);
+    if (!source.attr("dtype").equal(dtype)) {
+        throw nb::type_error("array dtype does not match the list element dtype");
+    }
+    if (nb::cast<std::size_t>(source.attr("ndim")) != 1) {
+        throw nb::value_error("array must be one-dimensional");
+    }
+    nb::object bytes = np.attr("ascontiguousarray")(source).attr("view")(np.attr("uint8"));
+    auto data = nb::cast<nb::ndarray<const std::uint8_t, nb::ndim<1>, nb::c_contig, nb::device::cpu>>(bytes);
+    list.assign(reinterpret_cast<const ElemType*>(data.data()), data.shape(0) / sizeof(ElemType));
+}
+
 } // namespace models
 
 } // namespace cogip
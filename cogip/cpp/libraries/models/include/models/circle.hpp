@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <ostream>
 
 namespace cogip {
@@ -21,6 +22,9 @@ typedef struct {
     double x;       ///< X-coordinate of the circle center.
     double y;       ///< Y-coordinate of the circle center.
     double radius;  ///< Radius of the circle.
+    std::uint32_t id;  ///< Identifier of the tracked obstacle, 0 if not tracked.
+    double vx;      ///< Velocity along X of the tracked obstacle (mm/s).
+    double vy;      ///< Velocity along Y of the tracked obstacle (mm/s).
 } circle_t;
 
 /// Overloads the stream insertion operator for `circle_t`.
@@ -29,7 +33,8 @@ typedef struct {
 /// @param circle The circle to print.
 /// @return A reference to the output stream.
 inline std::ostream& operator<<(std::ostream& os, const circle_t& circle) {
-    os << "circle_t(x=" << circle.x << ", y=" << circle.y << ", radius=" << circle.radius << ")";
+    os << "circle_t(x=" << circle.x << ", y=" << circle.y << ", radius=" << circle.radius
+       << ", id=" << circle.id << ", vx=" << circle.vx << ", vy=" << circle.vy << ")";
     return os;
 }
 
@@ -20,17 +20,27 @@ namespace models {
 
 constexpr std::size_t COORDS_LIST_SIZE_MAX = 256;
 
-typedef struct {
+/// Maximum number of coords of the compact lists, enough for the obstacle polygons and bounding boxes.
+constexpr std::size_t COMPACT_COORDS_LIST_SIZE_MAX = 32;
+
+/// List of coords with a fixed maximum size.
+/// @tparam N Maximum number of coords.
+template <std::size_t N>
+struct basic_coords_list_t {
     std::size_t count;
-    coords_t elems[COORDS_LIST_SIZE_MAX];
-} coords_list_t;
+    coords_t elems[N];
+};
+
+typedef basic_coords_list_t<COORDS_LIST_SIZE_MAX> coords_list_t;
+typedef basic_coords_list_t<COMPACT_COORDS_LIST_SIZE_MAX> compact_coords_list_t;
 
 /// Overloads the stream insertion operator for `coords_list_t`.
 /// Prints the coords_list_t in a human-readable format.
 /// @param os The output stream.
 /// @param coords_list The coords_list_t to print.
 /// @return A reference to the output stream.
-inline std::ostream& operator<<(std::ostream& os, const coords_list_t& coords_list) {
+template <std::size_t N>
+inline std::ostream& operator<<(std::ostream& os, const basic_coords_list_t<N>& coords_list) {
     os << "coords_list_t(count=" << coords_list.count << ", coords=[";
     for (std::size_t i = 0; i < coords_list.count; ++i) {
         if (i > 0) os << ", ";
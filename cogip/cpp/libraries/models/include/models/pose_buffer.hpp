@@ -12,6 +12,8 @@
 
 #include "models/pose.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <ostream>
 
 namespace cogip {
@@ -20,29 +22,27 @@ namespace models {
 
 constexpr std::size_t POSE_BUFFER_SIZE_MAX = 256;
 
-/// A circular buffer to store pose_t.
+/// A circular buffer to store pose_t, written by a single producer and read by any number of consumers.
+///
+/// The pose number k (starting at 0) is stored at index k % POSE_BUFFER_SIZE_MAX.
+/// The producer writes the pose first, then publishes it by incrementing write_index,
+/// so consumers read the poses without a lock and detect from write_index the poses overwritten meanwhile.
 typedef struct {
     pose_t poses[POSE_BUFFER_SIZE_MAX];  ///< Poses list
-    size_t head;                         ///< Next write pose
-    size_t tail;                         ///< Oldest pose
-    bool full;                           ///< Indicates if the buffer is full
+    std::uint64_t timestamps[POSE_BUFFER_SIZE_MAX];  ///< CLOCK_MONOTONIC time of each pose (ns)
+    std::atomic<std::uint64_t> write_index;  ///< Number of poses pushed since the creation of the buffer
 } pose_buffer_t;
 
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "pose buffer write index must be lock-free to be shared");
+
 /// Overloads the stream insertion operator for `pose_buffer_t`.
 /// Prints the pose in a human-readable format.
 /// @param os The output stream.
 /// @param buffer The buffer to print.
 /// @return A reference to the output stream.
 inline std::ostream& operator<<(std::ostream& os, const pose_buffer_t& buffer) {
-        size_t size = 0;
-        if (buffer.head >= buffer.tail){
-            size = buffer.head - buffer.tail;
-        }
-        else {
-            size = POSE_BUFFER_SIZE_MAX + buffer.head - buffer.tail;
-        }
-
-    os << "pose_buffer_t(size=" << size << "/" << POSE_BUFFER_SIZE_MAX << ", head=" << buffer.head << ", tail=" << buffer.tail << ")";
+    std::uint64_t write_index = buffer.write_index.load(std::memory_order_acquire);
+    os << "pose_buffer_t(write_index=" << write_index << ", head=" << write_index % POSE_BUFFER_SIZE_MAX << ")";
     return os;
 }
 
@@ -39,6 +39,19 @@ typedef struct {
     double stop_before_distance; ///< Distance to stop before reaching the pose.
 } pose_order_t;
 
+/// Compares two pose orders field by field.
+inline bool operator==(const pose_order_t& a, const pose_order_t& b) {
+    return a.x == b.x && a.y == b.y && a.angle == b.angle
+        && a.max_speed_linear == b.max_speed_linear
+        && a.max_speed_angular == b.max_speed_angular
+        && a.motion_direction == b.motion_direction
+        && a.bypass_anti_blocking == b.bypass_anti_blocking
+        && a.bypass_final_orientation == b.bypass_final_orientation
+        && a.timeout_ms == b.timeout_ms
+        && a.is_intermediate == b.is_intermediate
+        && a.stop_before_distance == b.stop_before_distance;
+}
+
 /// Overloads the stream insertion operator for `pose_order_t`.
 /// Prints the pose in a human-readable format.
 /// @param os The output stream.
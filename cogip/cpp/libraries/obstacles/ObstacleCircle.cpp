@@ -12,35 +12,38 @@ namespace cogip {
 
 namespace obstacles {
 
-ObstacleCircle::ObstacleCircle(obstacle_circle_t* data):
-    data_(data == nullptr ? new obstacle_circle_t() : data),
+template <std::size_t N>
+BasicObstacleCircle<N>::BasicObstacleCircle(basic_obstacle_circle_t<N>* data):
+    data_(data == nullptr ? new basic_obstacle_circle_t<N>() : data),
     external_data_(data != nullptr),
     center_(models::Pose(&data_->center)),
     bounding_box_(models::CoordsList(&data_->bounding_box))
 {
 }
 
-ObstacleCircle::ObstacleCircle(const ObstacleCircle& other, bool deep_copy):
-    data_(deep_copy ? new obstacle_circle_t() : other.data_),
+template <std::size_t N>
+BasicObstacleCircle<N>::BasicObstacleCircle(const BasicObstacleCircle& other, bool deep_copy):
+    data_(deep_copy ? new basic_obstacle_circle_t<N>() : other.data_),
     external_data_(!deep_copy),
     center_(models::Pose(&data_->center)),
     bounding_box_(models::CoordsList(&data_->bounding_box))
 {
     if (deep_copy) {
-        memcpy(data_, other.data_, sizeof(obstacle_circle_t));
+        memcpy(data_, other.data_, sizeof(basic_obstacle_circle_t<N>));
     }
 }
 
-ObstacleCircle::ObstacleCircle(
+template <std::size_t N>
+BasicObstacleCircle<N>::BasicObstacleCircle(
     double x,
     double y,
     double angle,
     double radius,
     double bounding_box_margin,
     uint8_t bounding_box_points_number,
-    obstacle_circle_t* data
+    basic_obstacle_circle_t<N>* data
 ):
-    data_(data == nullptr ? new obstacle_circle_t() : data),
+    data_(data == nullptr ? new basic_obstacle_circle_t<N>() : data),
     external_data_(data != nullptr),
     center_(models::Pose(&data_->center)),
     bounding_box_(models::CoordsList(&data_->bounding_box))
@@ -50,19 +53,23 @@ ObstacleCircle::ObstacleCircle(
     data_->center.y = y;
     data_->center.angle = angle;
     data_->radius = radius;
+    data_->vx = 0;
+    data_->vy = 0;
     data_->bounding_box_margin = bounding_box_margin;
     data_->bounding_box_points_number = bounding_box_points_number;
     update_bounding_box();
 }
 
-ObstacleCircle::~ObstacleCircle()
+template <std::size_t N>
+BasicObstacleCircle<N>::~BasicObstacleCircle()
 {
     if (!external_data_) {
         delete data_;
     }
 }
 
-bool ObstacleCircle::is_segment_crossing(const models::Coords& a, const models::Coords& b)
+template <std::size_t N>
+bool BasicObstacleCircle<N>::is_segment_crossing(const models::Vec2& a, const models::Vec2& b)
 {
     if (!is_line_crossing_circle(a, b)) {
         return false;
@@ -71,26 +78,24 @@ bool ObstacleCircle::is_segment_crossing(const models::Coords& a, const models::
         return true;
     }
 
-    models::Coords vect_ab(b.x() - a.x(), b.y() - a.y());
-    models::Coords vect_ac(data_->center.x - a.x(), data_->center.y - a.y());
-    models::Coords vect_bc(data_->center.x - b.x(), data_->center.y - b.y());
+    models::Vec2 center(data_->center.x, data_->center.y);
+    models::Vec2 vect_ab = b - a;
+    models::Vec2 vect_ac = center - a;
+    models::Vec2 vect_bc = center - b;
 
-    double scal1 = vect_ab.x() * vect_ac.x() + vect_ab.y() * vect_ac.y();
-    double scal2 = (-vect_ab.x()) * vect_bc.x() + (-vect_ab.y()) * vect_bc.y();
+    double scal1 = vect_ab.dot(vect_ac);
+    double scal2 = (-vect_ab).dot(vect_bc);
 
     return (scal1 >= 0 && scal2 >= 0);
 }
 
-bool ObstacleCircle::is_segment_crossing(double ax, double ay, double bx, double by)
-{
-    return is_segment_crossing(models::Coords(ax, ay), models::Coords(bx, by));
-}
-
-models::Coords ObstacleCircle::nearest_point(const models::Coords& p)
+template <std::size_t N>
+models::Vec2 BasicObstacleCircle<N>::nearest_point(const models::Vec2& p)
 {
     // Vector from the circle center to the given point
-    models::Coords vect(p.x() - data_->center.x, p.y() - data_->center.y);
-    double vect_norm = std::hypot(vect.x(), vect.y());
+    models::Vec2 center(data_->center.x, data_->center.y);
+    models::Vec2 vect = p - center;
+    double vect_norm = vect.norm();
 
     // Effective radius including the bounding box margin
     double effective_radius = data_->radius + data_->bounding_box_margin;
@@ -98,34 +103,30 @@ models::Coords ObstacleCircle::nearest_point(const models::Coords& p)
     // Special case: if the point is exactly at the center, return a point on the circle
     // This case should never
     if (vect_norm == 0) {
-        return models::Coords(
-            data_->center.x + effective_radius,
-            data_->center.y
-        );
+        return models::Vec2(center.x + effective_radius, center.y);
     }
 
     // Scale the vector to project the point onto the circle perimeter
     double scale = effective_radius / vect_norm;
 
     // Return the projected point on the circle
-    return models::Coords(
-        data_->center.x + vect.x() * scale,
-        data_->center.y + vect.y() * scale
-    );
+    return center + vect * scale;
 }
 
-bool ObstacleCircle::is_line_crossing_circle(const models::Coords& a, const models::Coords& b)
+template <std::size_t N>
+bool BasicObstacleCircle<N>::is_line_crossing_circle(const models::Vec2& a, const models::Vec2& b)
 {
-    models::Coords vect_ab(b.x() - a.x(), b.y() - a.y());
-    models::Coords vect_ac(data_->center.x - a.x(), data_->center.y - a.y());
+    models::Vec2 vect_ab = b - a;
+    models::Vec2 vect_ac = models::Vec2(data_->center.x, data_->center.y) - a;
 
-    double numerator = std::abs(vect_ab.x() * vect_ac.y() - vect_ab.y() * vect_ac.x());
-    double denominator = std::hypot(vect_ab.x(), vect_ab.y());
+    double numerator = std::abs(vect_ab.cross(vect_ac));
+    double denominator = vect_ab.norm();
 
     return (numerator / denominator) < data_->radius;
 }
 
-void ObstacleCircle::update_bounding_box()
+template <std::size_t N>
+void BasicObstacleCircle<N>::update_bounding_box()
 {
     if (data_->radius <= 0) return;
 
@@ -141,6 +142,9 @@ void ObstacleCircle::update_bounding_box()
     }
 }
 
+template class BasicObstacleCircle<models::COORDS_LIST_SIZE_MAX>;
+template class BasicObstacleCircle<models::COMPACT_COORDS_LIST_SIZE_MAX>;
+
 } // namespace obstacles
 
 } // namespace cogip
@@ -4,6 +4,7 @@
 
 // Project includes
 #include "obstacles/ObstaclePolygon.hpp"
+#include "utils/predicates.hpp"
 
 // System includes
 #include <cmath>
@@ -14,40 +15,9 @@ namespace cogip {
 
 namespace obstacles {
 
-/// Check if a segment [AB] crosses a line (CD).
-/// @param[in] a Point A
-/// @param[in] b Point B
-/// @param[in] c Point C
-/// @param[in] d Point D
-/// @return True if the segment crosses the line, false otherwise.
-static bool is_segment_crossing_line(
-    const models::Coords& a, const models::Coords& b,
-    const models::Coords& c, const models::Coords& d)
-{
-    models::Coords ab(b.x() - a.x(), b.y() - a.y());
-    models::Coords ac(c.x() - a.x(), c.y() - a.y());
-    models::Coords ad(d.x() - a.x(), d.y() - a.y());
-
-    double det = (ab.x() * ad.y() - ab.y() * ad.x()) * (ab.x() * ac.y() - ab.y() * ac.x());
-    return (det < 0);
-}
-
-/// Check if a segment [AB] crosses another segment [CD].
-/// @param[in] a Point A
-/// @param[in] b Point B
-/// @param[in] c Point C
-/// @param[in] d Point D
-/// @return True if the segments cross, false otherwise.
-static bool is_segment_crossing_segment(
-    const models::Coords& a, const models::Coords& b,
-    const models::Coords& c, const models::Coords& d)
-{
-    return is_segment_crossing_line(a, b, c, d) &&
-           is_segment_crossing_line(c, d, a, b);
-}
-
-ObstaclePolygon::ObstaclePolygon(obstacle_polygon_t* data):
-    data_(data == nullptr ? new obstacle_polygon_t() : data),
+template <std::size_t N>
+BasicObstaclePolygon<N>::BasicObstaclePolygon(basic_obstacle_polygon_t<N>* data):
+    data_(data == nullptr ? new basic_obstacle_polygon_t<N>() : data),
     external_data_(data != nullptr),
     points_(models::CoordsList(&data_->points)),
     center_(models::Pose(&data_->center)),
@@ -55,8 +25,9 @@ ObstaclePolygon::ObstaclePolygon(obstacle_polygon_t* data):
 {
 }
 
-ObstaclePolygon::ObstaclePolygon(const ObstaclePolygon& other, bool deep_copy):
-    data_(deep_copy ? new obstacle_polygon_t() : other.data_),
+template <std::size_t N>
+BasicObstaclePolygon<N>::BasicObstaclePolygon(const BasicObstaclePolygon& other, bool deep_copy):
+    data_(deep_copy ? new basic_obstacle_polygon_t<N>() : other.data_),
     external_data_(!deep_copy),
     center_(models::Pose(&data_->center)),
     points_(models::CoordsList(&data_->points)),
@@ -64,16 +35,17 @@ ObstaclePolygon::ObstaclePolygon(const ObstaclePolygon& other, bool deep_copy):
 {
     if (deep_copy) {
         // Deep copy at the data level
-        memcpy(data_, other.data_, sizeof(obstacle_polygon_t));
+        memcpy(data_, other.data_, sizeof(basic_obstacle_polygon_t<N>));
     }
 }
 
-ObstaclePolygon::ObstaclePolygon(
+template <std::size_t N>
+BasicObstaclePolygon<N>::BasicObstaclePolygon(
     const models::CoordsList& points,
     double bounding_box_margin,
-    obstacle_polygon_t* data
+    basic_obstacle_polygon_t<N>* data
 ):
-    data_(data == nullptr ? new obstacle_polygon_t() : data),
+    data_(data == nullptr ? new basic_obstacle_polygon_t<N>() : data),
     external_data_(data != nullptr),
     points_(models::CoordsList(&data_->points)),
     center_(models::Pose(&data_->center)),
@@ -91,7 +63,8 @@ ObstaclePolygon::ObstaclePolygon(
     }
 }
 
-int ObstaclePolygon::calculate_polygon_centroid() {
+template <std::size_t N>
+int BasicObstaclePolygon<N>::calculate_polygon_centroid() {
     double x_sum = 0.0;
     double y_sum = 0.0;
     double area = 0.0;
@@ -119,7 +92,8 @@ int ObstaclePolygon::calculate_polygon_centroid() {
     return 0;
 }
 
-int ObstaclePolygon::calculate_polygon_radius() {
+template <std::size_t N>
+int BasicObstaclePolygon<N>::calculate_polygon_radius() {
     int res = calculate_polygon_centroid();
     if (res) {
         return res;
@@ -136,52 +110,52 @@ int ObstaclePolygon::calculate_polygon_radius() {
     return 0;
 }
 
-bool ObstaclePolygon::is_point_inside(double x, double y) {
-    for (std::size_t i = 0; i < points_.size(); i++) {
-        const models::Coords& a = points_[i];
-        const models::Coords& b = points_[(i + 1) % points_.size()];
+template <std::size_t N>
+bool BasicObstaclePolygon<N>::is_point_inside(const models::Vec2& p) {
+    models::Span<models::coords_t> points = points_.view();
+    for (std::size_t i = 0; i < points.size(); i++) {
+        models::Vec2 a(points[i]);
+        models::Vec2 b(points[(i + 1) % points.size()]);
 
-        models::Coords ab(b.x() - a.x(), b.y() - a.y());
-        models::Coords ap(x - a.x(), y - a.y());
-
-        if (ab.x() * ap.y() - ab.y() * ap.x() <= 0) {
+        if (utils::orient2d(a.x, a.y, b.x, b.y, p.x, p.y) <= 0) {
             return false;
         }
     }
     return true;
 }
 
-bool ObstaclePolygon::is_segment_crossing(const models::Coords& a, const models::Coords& b) {
-    for (size_t i = 0; i < points_.size(); i++) {
-        const models::Coords& p = points_[i];
-        const models::Coords& p_next = points_[(i + 1) % points_.size()];
+template <std::size_t N>
+bool BasicObstaclePolygon<N>::is_segment_crossing(const models::Vec2& a, const models::Vec2& b) {
+    if (points_.size() == 0) {
+        return false;
+    }
 
-        if (is_segment_crossing_segment(a, b, p, p_next)) {
-            return true;
-        }
+    // A segment between two polygon points that are not consecutive in the list crosses the polygon.
+    int index = points_.getIndex(a);
+    int index2 = points_.getIndex(b);
+    if (index >= 0 && index2 >= 0 && std::abs(index - index2) != 1) {
+        return true;
+    }
 
-        int index = points_.getIndex(a);
-        int index2 = points_.getIndex(b);
+    models::Span<models::coords_t> points = points_.view();
+    for (size_t i = 0; i < points.size(); i++) {
+        models::Vec2 p(points[i]);
+        models::Vec2 p_next(points[(i + 1) % points.size()]);
 
-        if ((index >= 0 && index2 >= 0 && std::abs(index - index2) != 1) ||
-            p.on_segment(a, b)) {
+        if (utils::are_segments_crossing(a.x, a.y, b.x, b.y, p.x, p.y, p_next.x, p_next.y) || p.on_segment(a, b)) {
             return true;
         }
     }
     return false;
 }
 
-bool ObstaclePolygon::is_segment_crossing(double ax, double ay, double bx, double by)
-{
-    return is_segment_crossing(models::Coords(ax, ay), models::Coords(bx, by));
-}
-
-models::Coords ObstaclePolygon::nearest_point(const models::Coords& p) {
+template <std::size_t N>
+models::Vec2 BasicObstaclePolygon<N>::nearest_point(const models::Vec2& p) {
     double min_distance = std::numeric_limits<double>::max();
-    models::Coords closest_point = p;
+    models::Vec2 closest_point = p;
 
-    for (size_t i = 0; i < points_.size(); i++) {
-        const models::Coords& point = points_[i];
+    for (const models::coords_t& coords : points_.view()) {
+        models::Vec2 point(coords);
         double distance = p.distance(point);
         if (distance < min_distance) {
             min_distance = distance;
@@ -192,7 +166,8 @@ models::Coords ObstaclePolygon::nearest_point(const models::Coords& p) {
     return closest_point;
 }
 
-void ObstaclePolygon::update_bounding_box() {
+template <std::size_t N>
+void BasicObstaclePolygon<N>::update_bounding_box() {
     bounding_box_.clear();
     for (size_t i = 0; i < points_.size(); i++) {
         models::Coords point = points_[i];
@@ -203,6 +178,9 @@ void ObstaclePolygon::update_bounding_box() {
     }
 }
 
+template class BasicObstaclePolygon<models::COORDS_LIST_SIZE_MAX>;
+template class BasicObstaclePolygon<models::COMPACT_COORDS_LIST_SIZE_MAX>;
+
 } // namespace obstacles
 
 } // namespace cogip
@@ -14,47 +14,48 @@ namespace cogip {
 namespace obstacles {
 
 /// Constructor that initializes an obstacle rectangle based on its center, length, and orientation.
-ObstacleRectangle::ObstacleRectangle(
+template <std::size_t N>
+BasicObstacleRectangle<N>::BasicObstacleRectangle(
     double x,
     double y,
     double angle,
     double length_x,
     double length_y,
     double bounding_box_margin,
-    obstacle_polygon_t* data
-): ObstaclePolygon(data)
+    basic_obstacle_polygon_t<N>* data
+): BasicObstaclePolygon<N>(data)
 {
-    data_->id = 0;
-    data_->center.x = x;
-    data_->center.y = y;
-    data_->center.angle = angle;
-    data_->length_x = length_x;
-    data_->length_y = length_y;
-    data_->bounding_box_margin = bounding_box_margin;
-    data_->bounding_box_points_number = 4;
+    this->data_->id = 0;
+    this->data_->center.x = x;
+    this->data_->center.y = y;
+    this->data_->center.angle = angle;
+    this->data_->length_x = length_x;
+    this->data_->length_y = length_y;
+    this->data_->bounding_box_margin = bounding_box_margin;
+    this->data_->bounding_box_points_number = 4;
 
     // Calculate the radius as half of the rectangle's diagonal.
-    data_->radius = std::sqrt(length_x * length_x + length_y * length_y) / 2;
+    this->data_->radius = std::sqrt(length_x * length_x + length_y * length_y) / 2;
 
     // Precompute trigonometric values for efficiency.
     double cos_theta = std::cos(DEG2RAD(angle));
     double sin_theta = std::sin(DEG2RAD(angle));
 
     // Add rectangle vertices relative to the center.
-    points_.clear();
-    points_.append(
+    this->points_.clear();
+    this->points_.append(
         x - (length_x / 2) * cos_theta + (length_y / 2) * sin_theta,
         y - (length_x / 2) * sin_theta - (length_y / 2) * cos_theta
     );
-    points_.append(
+    this->points_.append(
         x + (length_x / 2) * cos_theta + (length_y / 2) * sin_theta,
         y + (length_x / 2) * sin_theta - (length_y / 2) * cos_theta
     );
-    points_.append(
+    this->points_.append(
         x + (length_x / 2) * cos_theta - (length_y / 2) * sin_theta,
         y + (length_x / 2) * sin_theta + (length_y / 2) * cos_theta
     );
-    points_.append(
+    this->points_.append(
         x - (length_x / 2) * cos_theta - (length_y / 2) * sin_theta,
         y - (length_x / 2) * sin_theta + (length_y / 2) * cos_theta
     );
@@ -64,37 +65,41 @@ ObstacleRectangle::ObstacleRectangle(
 }
 
 /// Updates the bounding box of the rectangle, including a margin.
-void ObstacleRectangle::update_bounding_box()
+template <std::size_t N>
+void BasicObstacleRectangle<N>::update_bounding_box()
 {
     // Increase dimensions by the bounding box margin.
-    double length_x = data_->length_x + data_->bounding_box_margin;
-    double length_y = data_->length_y + data_->bounding_box_margin;
+    double length_x = this->data_->length_x + this->data_->bounding_box_margin;
+    double length_y = this->data_->length_y + this->data_->bounding_box_margin;
 
     // Precompute trigonometric values for efficiency.
-    double cos_theta = std::cos(DEG2RAD(data_->center.angle));
-    double sin_theta = std::sin(DEG2RAD(data_->center.angle));
+    double cos_theta = std::cos(DEG2RAD(this->data_->center.angle));
+    double sin_theta = std::sin(DEG2RAD(this->data_->center.angle));
 
-    bounding_box_.clear();
+    this->bounding_box_.clear();
 
     // Add bounding box vertices relative to the center.
-    bounding_box_.append(
-        data_->center.x - (length_x / 2) * cos_theta + (length_y / 2) * sin_theta,
-        data_->center.y - (length_x / 2) * sin_theta - (length_y / 2) * cos_theta
+    this->bounding_box_.append(
+        this->data_->center.x - (length_x / 2) * cos_theta + (length_y / 2) * sin_theta,
+        this->data_->center.y - (length_x / 2) * sin_theta - (length_y / 2) * cos_theta
     );
-    bounding_box_.append(
-        data_->center.x + (length_x / 2) * cos_theta + (length_y / 2) * sin_theta,
-        data_->center.y + (length_x / 2) * sin_theta - (length_y / 2) * cos_theta
+    this->bounding_box_.append(
+        this->data_->center.x + (length_x / 2) * cos_theta + (length_y / 2) * sin_theta,
+        this->data_->center.y + (length_x / 2) * sin_theta - (length_y / 2) * cos_theta
     );
-    bounding_box_.append(
-        data_->center.x + (length_x / 2) * cos_theta - (length_y / 2) * sin_theta,
-        data_->center.y + (length_x / 2) * sin_theta + (length_y / 2) * cos_theta
+    this->bounding_box_.append(
+        this->data_->center.x + (length_x / 2) * cos_theta - (length_y / 2) * sin_theta,
+        this->data_->center.y + (length_x / 2) * sin_theta + (length_y / 2) * cos_theta
     );
-    bounding_box_.append(
-        data_->center.x - (length_x / 2) * cos_theta - (length_y / 2) * sin_theta,
-        data_->center.y - (length_x / 2) * sin_theta + (length_y / 2) * cos_theta
+    this->bounding_box_.append(
+        this->data_->center.x - (length_x / 2) * cos_theta - (length_y / 2) * sin_theta,
+        this->data_->center.y - (length_x / 2) * sin_theta + (length_y / 2) * cos_theta
     );
 }
 
+template class BasicObstacleRectangle<models::COORDS_LIST_SIZE_MAX>;
+template class BasicObstacleRectangle<models::COMPACT_COORDS_LIST_SIZE_MAX>;
+
 } // namespace obstacles
 
 } // namespace cogip
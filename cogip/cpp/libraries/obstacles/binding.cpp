@@ -3,14 +3,20 @@
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
 #include "obstacles/ObstacleCircleList.hpp"
+#include "obstacles/ObstacleListQueries.hpp"
 #include "obstacles/ObstaclePolygonList.hpp"
 #include "obstacles/ObstacleRectangleList.hpp"
 #include "models/binding.hpp"
 
 #include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/optional.h>
 #include <nanobind/stl/string.h>
 
+#include <memory>
+#include <optional>
 #include <sstream>
+#include <vector>
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -19,198 +25,376 @@ namespace cogip {
 
 namespace obstacles {
 
-using ObstacleCircleIterator = models::NbSharedArrayIterator<ObstacleCircle, ObstacleCircleList>;
-using ObstaclePolygonIterator = models::NbSharedArrayIterator<ObstaclePolygon, ObstaclePolygonList>;
-using ObstacleRectangleIterator = models::NbSharedArrayIterator<ObstacleRectangle, ObstacleRectangleList>;
+/// Python names of the obstacle classes of one maximum number of points.
+struct obstacle_names_t {
+    const char* circle_t;
+    const char* circle;
+    const char* circle_iterator;
+    const char* circle_list;
+    const char* polygon_t;
+    const char* polygon;
+    const char* polygon_iterator;
+    const char* polygon_list;
+    const char* rectangle;
+    const char* rectangle_iterator;
+    const char* rectangle_list;
+};
 
-NB_MODULE(obstacles, m) {
-    auto models_module = nb::module_::import_("cogip.cpp.libraries.models");
+/// Numpy structured dtype of basic_obstacle_circle_t.
+template <std::size_t N>
+nb::object obstacle_circle_dtype()
+{
+    using T = basic_obstacle_circle_t<N>;
+    return models::nb_structured_dtype({
+        {"id", models::nb_format<uint32_t>(), offsetof(T, id)},
+        {"center", models::nb_pose_dtype(), offsetof(T, center)},
+        {"radius", models::nb_format<double>(), offsetof(T, radius)},
+        {"vx", models::nb_format<double>(), offsetof(T, vx)},
+        {"vy", models::nb_format<double>(), offsetof(T, vy)},
+        {"bounding_box_margin", models::nb_format<double>(), offsetof(T, bounding_box_margin)},
+        {"bounding_box_points_number", models::nb_format<uint8_t>(), offsetof(T, bounding_box_points_number)},
+        {"bounding_box", models::nb_coords_list_dtype<N>(), offsetof(T, bounding_box)},
+    }, sizeof(T));
+}
+
+/// Numpy structured dtype of basic_obstacle_polygon_t, shared by polygons and rectangles.
+template <std::size_t N>
+nb::object obstacle_polygon_dtype()
+{
+    using T = basic_obstacle_polygon_t<N>;
+    return models::nb_structured_dtype({
+        {"id", models::nb_format<uint32_t>(), offsetof(T, id)},
+        {"center", models::nb_pose_dtype(), offsetof(T, center)},
+        {"radius", models::nb_format<double>(), offsetof(T, radius)},
+        {"points", models::nb_coords_list_dtype<N>(), offsetof(T, points)},
+        {"bounding_box_margin", models::nb_format<double>(), offsetof(T, bounding_box_margin)},
+        {"bounding_box_points_number", models::nb_format<uint8_t>(), offsetof(T, bounding_box_points_number)},
+        {"bounding_box", models::nb_coords_list_dtype<N>(), offsetof(T, bounding_box)},
+        {"length_x", models::nb_format<double>(), offsetof(T, length_x)},
+        {"length_y", models::nb_format<double>(), offsetof(T, length_y)},
+    }, sizeof(T));
+}
+
+/// Bind the numpy bulk accessors of an obstacle list.
+template <typename ListType>
+void bind_list_ndarray(nb::class_<ListType>& cls, nb::object dtype)
+{
+    cls
+        .def_prop_ro_static("dtype", [dtype](nb::handle) { return dtype; }, "Numpy structured dtype of the obstacles")
+        .def("as_ndarray", [dtype](nb::handle_t<ListType> self) {
+            return models::nb_list_view(nb::cast<ListType&>(self), self, dtype);
+        }, "Return a numpy view of the obstacles, without copy")
+        .def("assign_from_ndarray", [dtype](ListType& self, nb::handle array) {
+            models::nb_list_assign(self, array, dtype);
+        }, "Replace all obstacles by the elements of a numpy array of dtype <list class>.dtype", "array"_a)
+    ;
+}
+
+/// 1D float64 array argument of the bulk queries.
+using QueryArray = nb::ndarray<const double, nb::ndim<1>, nb::c_contig, nb::device::cpu>;
+
+/// Return obstacle indices as a numpy int32 array owning its memory.
+static nb::ndarray<int32_t, nb::numpy, nb::ndim<1>> nb_indices(std::unique_ptr<std::vector<int32_t>> indices)
+{
+    std::size_t size = indices->size();
+    int32_t* data = indices->data();
+    nb::capsule owner(indices.release(), [](void* p) noexcept {
+        delete static_cast<std::vector<int32_t>*>(p);
+    });
+    return nb::ndarray<int32_t, nb::numpy, nb::ndim<1>>(data, {size}, owner);
+}
+
+/// Bind the bulk point and segment queries of an obstacle list.
+template <typename ListType>
+void bind_list_queries(nb::class_<ListType>& cls)
+{
+    cls
+        .def("points_inside", [](ListType& self, QueryArray x, QueryArray y) {
+            if (y.shape(0) != x.shape(0)) {
+                throw std::invalid_argument("x and y must have the same length");
+            }
+            auto first = std::make_unique<std::vector<int32_t>>(x.shape(0));
+            {
+                // Obstacle tests do not touch Python objects.
+                nb::gil_scoped_release release;
+                first_obstacles_containing(self, x.data(), y.data(), x.shape(0), first->data());
+            }
+            return nb_indices(std::move(first));
+        },
+        "For each point of 1D arrays of coordinates, return the index of the first obstacle containing it, -1 if none. "
+        "The GIL is released during the tests.",
+        "x"_a, "y"_a)
+        .def("segments_crossing", [](ListType& self, QueryArray ax, QueryArray ay, QueryArray bx, QueryArray by) {
+            std::size_t count = ax.shape(0);
+            if (ay.shape(0) != count || bx.shape(0) != count || by.shape(0) != count) {
+                throw std::invalid_argument("ax, ay, bx and by must have the same length");
+            }
+            auto first = std::make_unique<std::vector<int32_t>>(count);
+            {
+                nb::gil_scoped_release release;
+                first_obstacles_crossed(self, ax.data(), ay.data(), bx.data(), by.data(), count, first->data());
+            }
+            return nb_indices(std::move(first));
+        },
+        "For each segment [AB] of 1D arrays of coordinates, return the index of the first obstacle it crosses, -1 if none. "
+        "The GIL is released during the tests.",
+        "ax"_a, "ay"_a, "bx"_a, "by"_a)
+    ;
+}
+
+/// Bind the obstacle structures, classes and lists with a maximum number of points.
+template <std::size_t N>
+void bind_obstacles(nb::module_& m, const obstacle_names_t& names)
+{
+    using ObstacleCircleIterator = models::NbSharedArrayIterator<BasicObstacleCircle<N>, BasicObstacleCircleList<N>>;
+    using ObstaclePolygonIterator = models::NbSharedArrayIterator<BasicObstaclePolygon<N>, BasicObstaclePolygonList<N>>;
+    using ObstacleRectangleIterator = models::NbSharedArrayIterator<BasicObstacleRectangle<N>, BasicObstacleRectangleList<N>>;
 
     // Bind obstacle_circle_t struct
-    nb::class_<obstacle_circle_t>(m, "ObstacleCircleT")
-        .def(nb::init<>(), "Default constructor for obstacle_circle_t")
-        .def_rw("id", &obstacle_circle_t::id, "Obstacle id")
-        .def_rw("center", &obstacle_circle_t::center, "Obstacle center")
-        .def_rw("radius", &obstacle_circle_t::radius, "Obstacle circumscribed circle radius")
-        .def_rw("bounding_box_margin", &obstacle_circle_t::bounding_box_margin, "Margin for the bounding box")
-        .def_rw("bounding_box_points_number", &obstacle_circle_t::bounding_box_points_number, "Number of points to define the bounding box")
-        .def_rw("bounding_box", &obstacle_circle_t::bounding_box, "Precomputed bounding box for avoidance")
-        .def("__repr__", [](const obstacle_circle_t& obj) {
+    nb::class_<basic_obstacle_circle_t<N>>(m, names.circle_t)
+        .def(nb::init<>(), "Default constructor")
+        .def_rw("id", &basic_obstacle_circle_t<N>::id, "Obstacle id")
+        .def_rw("center", &basic_obstacle_circle_t<N>::center, "Obstacle center")
+        .def_rw("radius", &basic_obstacle_circle_t<N>::radius, "Obstacle circumscribed circle radius")
+        .def_rw("vx", &basic_obstacle_circle_t<N>::vx, "Velocity along X of the tracked obstacle (mm/s)")
+        .def_rw("vy", &basic_obstacle_circle_t<N>::vy, "Velocity along Y of the tracked obstacle (mm/s)")
+        .def_rw("bounding_box_margin", &basic_obstacle_circle_t<N>::bounding_box_margin, "Margin for the bounding box")
+        .def_rw("bounding_box_points_number", &basic_obstacle_circle_t<N>::bounding_box_points_number, "Number of points to define the bounding box")
+        .def_rw("bounding_box", &basic_obstacle_circle_t<N>::bounding_box, "Precomputed bounding box for avoidance")
+        .def("__repr__", [](const basic_obstacle_circle_t<N>& obj) {
             std::ostringstream oss;
             oss << obj;
             return oss.str();
         });
 
-    nb::class_<Obstacle>(m, "Obstacle");
-
     // Bind ObstacleCircle class
-    nb::class_<ObstacleCircle, Obstacle>(m, "ObstacleCircle")
-        .def(nb::init<double, double, double, double, double, uint8_t, obstacle_circle_t*>(),
+    nb::class_<BasicObstacleCircle<N>, Obstacle>(m, names.circle)
+        .def(nb::init<double, double, double, double, double, uint8_t, basic_obstacle_circle_t<N>*>(),
              "Constructor with initial values",
              "x"_a, "y"_a, "angle"_a, "radius"_a, "bounding_box_margin"_a, "bounding_box_points_number"_a, "data"_a = nullptr)
-        .def(nb::init<const ObstacleCircle&, bool>(), "Deep copy constructor", "other"_a, "deep_copy"_a = false)
-        .def("is_point_inside", nb::overload_cast<double, double>(&ObstacleCircle::is_point_inside), "Check if a point is inside the circle", "x"_a, "y"_a)
-        .def("is_point_inside", nb::overload_cast<const models::Coords&>(&ObstacleCircle::is_point_inside), "Check if a point is inside the circle", "dest"_a)
-        .def("is_segment_crossing", nb::overload_cast<double, double, double, double>(&ObstacleCircle::is_segment_crossing), "Check if a segment defined by two points crosses the circle", "ax"_a, "ay"_a, "bx"_a, "by"_a)
-        .def("is_segment_crossing", nb::overload_cast<const models::Coords&, const models::Coords&>(&ObstacleCircle::is_segment_crossing), "Check if a segment defined by two points crosses the circle", "a"_a, "b"_a)
-        .def("nearest_point", &ObstacleCircle::nearest_point, "Find the nearest point on the circle's perimeter to a given point", "p"_a)
-        .def_prop_rw("id", &ObstacleCircle::id, &ObstacleCircle::set_id, "Get or set the obstacle id")
-        .def_prop_rw("center", &ObstacleCircle::center, &ObstacleCircle::set_center, "Get or set the obstacle center")
-        .def_prop_ro("radius", &ObstacleCircle::radius, "Obstacle circumscribed circle radius")
-        .def_prop_ro("bounding_box_margin", &ObstacleCircle::bounding_box_margin, "Margin for the bounding box")
-        .def_prop_ro("bounding_box_points_number", &ObstacleCircle::bounding_box_points_number, "Obstacle circumscribed circle radius")
-        .def_prop_ro("bounding_box", &ObstacleCircle::bounding_box, nb::rv_policy::reference_internal, "The bounding box")
-        .def("__repr__", [](ObstacleCircle& obj) {
+        .def(nb::init<const BasicObstacleCircle<N>&, bool>(), "Deep copy constructor", "other"_a, "deep_copy"_a = false)
+        .def("is_point_inside", nb::overload_cast<double, double>(&BasicObstacleCircle<N>::is_point_inside), "Check if a point is inside the circle", "x"_a, "y"_a)
+        .def("is_point_inside", nb::overload_cast<const models::Coords&>(&BasicObstacleCircle<N>::is_point_inside), "Check if a point is inside the circle", "dest"_a)
+        .def("is_segment_crossing", nb::overload_cast<double, double, double, double>(&BasicObstacleCircle<N>::is_segment_crossing), "Check if a segment defined by two points crosses the circle", "ax"_a, "ay"_a, "bx"_a, "by"_a)
+        .def("is_segment_crossing", nb::overload_cast<const models::Coords&, const models::Coords&>(&BasicObstacleCircle<N>::is_segment_crossing), "Check if a segment defined by two points crosses the circle", "a"_a, "b"_a)
+        .def("nearest_point", nb::overload_cast<const models::Coords&>(&BasicObstacleCircle<N>::nearest_point), "Find the nearest point on the circle's perimeter to a given point", "p"_a)
+        .def_prop_rw("id", &BasicObstacleCircle<N>::id, &BasicObstacleCircle<N>::set_id, "Get or set the obstacle id")
+        .def_prop_rw("center", &BasicObstacleCircle<N>::center, &BasicObstacleCircle<N>::set_center, "Get or set the obstacle center")
+        .def_prop_ro("radius", &BasicObstacleCircle<N>::radius, "Obstacle circumscribed circle radius")
+        .def_prop_rw("vx", &BasicObstacleCircle<N>::vx, &BasicObstacleCircle<N>::set_vx, "Get or set the velocity along X of the tracked obstacle (mm/s)")
+        .def_prop_rw("vy", &BasicObstacleCircle<N>::vy, &BasicObstacleCircle<N>::set_vy, "Get or set the velocity along Y of the tracked obstacle (mm/s)")
+        .def_prop_ro("bounding_box_margin", &BasicObstacleCircle<N>::bounding_box_margin, "Margin for the bounding box")
+        .def_prop_ro("bounding_box_points_number", &BasicObstacleCircle<N>::bounding_box_points_number, "Obstacle circumscribed circle radius")
+        .def_prop_ro("bounding_box", &BasicObstacleCircle<N>::bounding_box, nb::rv_policy::reference_internal, "The bounding box")
+        .def("__repr__", [](BasicObstacleCircle<N>& obj) {
             std::ostringstream oss;
             oss << obj;
             return oss.str();
         });
 
     // Bind ObstacleCircleIterator class
-    nb::class_<ObstacleCircleIterator>(m, "ObstacleCircleIterator")
+    nb::class_<ObstacleCircleIterator>(m, names.circle_iterator)
         .def("__next__", &ObstacleCircleIterator::next, "Get the next element")  // Python's equivalent of `__next__`
         .def("__iter__", [](ObstacleCircleIterator& self) -> ObstacleCircleIterator& {
             return self;  // An iterator must return itself for `__iter__`
         });
 
     // Bind ObstacleCircleList class
-    nb::class_<ObstacleCircleList>(m, "ObstacleCircleList")
-        .def("clear", &ObstacleCircleList::clear, "Clear the list")
-        .def("size", &ObstacleCircleList::size, "Get the number of coordinates")
-        .def("max_size", &ObstacleCircleList::max_size, "Get the maximum number of coordinates")
-        .def("get", &ObstacleCircleList::get, "Get Coords at index", "index"_a)
-        .def("__getitem__", &ObstacleCircleList::operator[], "Get Coords at index", "index"_a)
-        .def("append", nb::overload_cast<double, double, double, double, double, uint8_t, uint32_t>(&ObstacleCircleList::append), "Append obstacle", "x"_a, "y"_a, "angle"_a, "radius"_a, "bounding_box_margin"_a, "bounding_box_points_number"_a, "id"_a = 0)
-        .def("set", nb::overload_cast<std::size_t, double, double, double, double, double, uint8_t, uint32_t>(&ObstacleCircleList::set), "Set coordinates at index", "index"_a, "x"_a, "y"_a, "angle"_a, "radius"_a, "bounding_box_margin"_a, "bounding_box_points_number"_a, "id"_a = 0)
-     //    .def("__setitem__", nb::overload_cast<std::size_t, const ObstacleCircle&>(&ObstacleCircleList::set), "Set ObstacleCircle at index", "index"_a, "elem"_a)
-        .def("get_index", &ObstacleCircleList::getIndex, "Return index of elem or -1 if not found", "elem"_a)
-        .def("__len__", &ObstacleCircleList::size, "Return the length of the list")
-        .def("__iter__", [](ObstacleCircleList& self) { return ObstacleCircleIterator(self, 0); }, "Return an iterator object")
-        .def("__repr__", [](const ObstacleCircleList& self) {
+    auto circle_list = nb::class_<BasicObstacleCircleList<N>>(m, names.circle_list)
+        .def("clear", &BasicObstacleCircleList<N>::clear, "Clear the list")
+        .def("size", &BasicObstacleCircleList<N>::size, "Get the number of coordinates")
+        .def("max_size", &BasicObstacleCircleList<N>::max_size, "Get the maximum number of coordinates")
+        .def("get", &BasicObstacleCircleList<N>::get, "Get Coords at index", "index"_a)
+        .def("__getitem__", &BasicObstacleCircleList<N>::operator[], "Get Coords at index", "index"_a)
+        .def("append", nb::overload_cast<double, double, double, double, double, uint8_t, uint32_t>(&BasicObstacleCircleList<N>::append), "Append obstacle", "x"_a, "y"_a, "angle"_a, "radius"_a, "bounding_box_margin"_a, "bounding_box_points_number"_a, "id"_a = 0)
+        .def("set", nb::overload_cast<std::size_t, double, double, double, double, double, uint8_t, uint32_t>(&BasicObstacleCircleList<N>::set), "Set coordinates at index", "index"_a, "x"_a, "y"_a, "angle"_a, "radius"_a, "bounding_box_margin"_a, "bounding_box_points_number"_a, "id"_a = 0)
+        .def("assign_circles",
+            [](
+                BasicObstacleCircleList<N>& self,
+                nb::ndarray<const double, nb::ndim<1>, nb::c_contig, nb::device::cpu> x,
+                nb::ndarray<const double, nb::ndim<1>, nb::c_contig, nb::device::cpu> y,
+                nb::ndarray<const double, nb::ndim<1>, nb::c_contig, nb::device::cpu> radius,
+                nb::ndarray<const uint32_t, nb::ndim<1>, nb::c_contig, nb::device::cpu> id,
+                double angle,
+                double bounding_box_margin,
+                uint8_t bounding_box_points_number,
+                std::optional<nb::ndarray<const double, nb::ndim<1>, nb::c_contig, nb::device::cpu>> vx,
+                std::optional<nb::ndarray<const double, nb::ndim<1>, nb::c_contig, nb::device::cpu>> vy
+            ) {
+                std::size_t count = x.shape(0);
+                if (y.shape(0) != count || radius.shape(0) != count || id.shape(0) != count) {
+                    throw std::invalid_argument("x, y, radius and id must have the same length");
+                }
+                if (vx.has_value() != vy.has_value()) {
+                    throw std::invalid_argument("vx and vy must be given together");
+                }
+                if (vx && (vx->shape(0) != count || vy->shape(0) != count)) {
+                    throw std::invalid_argument("vx and vy must have the same length as x");
+                }
+                // Bounding boxes are computed without touching Python objects.
+                nb::gil_scoped_release release;
+                self.assign_circles(
+                    x.data(), y.data(), radius.data(), id.data(), count, angle, bounding_box_margin, bounding_box_points_number,
+                    vx ? vx->data() : nullptr, vy ? vy->data() : nullptr);
+            },
+            "Replace all obstacles by circles given as 1D arrays of centers, radii (float64) and ids (uint32), "
+            "sharing the same angle and bounding box parameters, with optional velocities in mm/s (float64, zero if omitted). "
+            "The GIL is released while the bounding boxes are computed.",
+            "x"_a, "y"_a, "radius"_a, "id"_a, "angle"_a, "bounding_box_margin"_a, "bounding_box_points_number"_a,
+            "vx"_a = nb::none(), "vy"_a = nb::none())
+     //    .def("__setitem__", nb::overload_cast<std::size_t, const ObstacleCircle&>(&BasicObstacleCircleList<N>::set), "Set ObstacleCircle at index", "index"_a, "elem"_a)
+        .def("get_index", nb::overload_cast<const BasicObstacleCircle<N>&>(&BasicObstacleCircleList<N>::getIndex, nb::const_), "Return index of elem or -1 if not found", "elem"_a)
+        .def("__len__", &BasicObstacleCircleList<N>::size, "Return the length of the list")
+        .def("__iter__", [](BasicObstacleCircleList<N>& self) { return ObstacleCircleIterator(self, 0); }, "Return an iterator object")
+        .def("__repr__", [names](const BasicObstacleCircleList<N>& self) {
             std::ostringstream oss;
-            oss << "ObstacleCircleList(size=" << self.size() << ", max_size=" << self.max_size() << ")";
+            oss << names.circle_list << "(size=" << self.size() << ", max_size=" << self.max_size() << ")";
             return oss.str();
         })
     ;
+    bind_list_ndarray(circle_list, obstacle_circle_dtype<N>());
+    bind_list_queries(circle_list);
 
     // Bind obstacle_polygon_t struct
-    nb::class_<obstacle_polygon_t>(m, "ObstaclePolygonT")
-        .def(nb::init<>(), "Default constructor for obstacle_polygon_t")
-        .def_rw("id", &obstacle_polygon_t::id, "Obstacle id")
-        .def_rw("center", &obstacle_polygon_t::center, "Obstacle center")
-        .def_rw("radius", &obstacle_polygon_t::radius, "Obstacle circumscribed polygon radius")
-        .def_rw("points", &obstacle_polygon_t::points, "Points defining the polygon")
-        .def_rw("bounding_box_margin", &obstacle_polygon_t::bounding_box_margin, "Margin for the bounding box")
-        .def_rw("bounding_box_points_number", &obstacle_polygon_t::bounding_box_points_number, "Number of points to define the bounding box")
-        .def_rw("bounding_box", &obstacle_polygon_t::bounding_box, "Precomputed bounding box for avoidance")
-        .def_rw("length_x", &obstacle_polygon_t::length_x, "Length of the rectangle along the X-axis")
-        .def_rw("length_y", &obstacle_polygon_t::length_y, "Length of the rectangle along the Y-axis")
-        .def("__repr__", [](const obstacle_polygon_t& obj) {
+    nb::class_<basic_obstacle_polygon_t<N>>(m, names.polygon_t)
+        .def(nb::init<>(), "Default constructor")
+        .def_rw("id", &basic_obstacle_polygon_t<N>::id, "Obstacle id")
+        .def_rw("center", &basic_obstacle_polygon_t<N>::center, "Obstacle center")
+        .def_rw("radius", &basic_obstacle_polygon_t<N>::radius, "Obstacle circumscribed polygon radius")
+        .def_rw("points", &basic_obstacle_polygon_t<N>::points, "Points defining the polygon")
+        .def_rw("bounding_box_margin", &basic_obstacle_polygon_t<N>::bounding_box_margin, "Margin for the bounding box")
+        .def_rw("bounding_box_points_number", &basic_obstacle_polygon_t<N>::bounding_box_points_number, "Number of points to define the bounding box")
+        .def_rw("bounding_box", &basic_obstacle_polygon_t<N>::bounding_box, "Precomputed bounding box for avoidance")
+        .def_rw("length_x", &basic_obstacle_polygon_t<N>::length_x, "Length of the rectangle along the X-axis")
+        .def_rw("length_y", &basic_obstacle_polygon_t<N>::length_y, "Length of the rectangle along the Y-axis")
+        .def("__repr__", [](const basic_obstacle_polygon_t<N>& obj) {
             std::ostringstream oss;
             oss << obj;
             return oss.str();
         });
 
     // Bind ObstaclePolygon class
-    nb::class_<ObstaclePolygon, Obstacle>(m, "ObstaclePolygon")
-        .def(nb::init<const models::CoordsList&, double, obstacle_polygon_t*>(),
+    nb::class_<BasicObstaclePolygon<N>, Obstacle>(m, names.polygon)
+        .def(nb::init<const models::CoordsList&, double, basic_obstacle_polygon_t<N>*>(),
              "Constructor with initial values",
              "points"_a, "bounding_box_margin"_a, "data"_a = nullptr)
-        .def(nb::init<const ObstaclePolygon&, bool>(), "Deep copy constructor", "other"_a, "deep_copy"_a = false)
-        .def("is_point_inside", nb::overload_cast<double, double>(&ObstaclePolygon::is_point_inside), "Check if a point is inside the circle", "x"_a, "y"_a)
-        .def("is_point_inside", nb::overload_cast<const models::Coords&>(&ObstaclePolygon::is_point_inside), "Check if a point is inside the circle", "dest"_a)
-        .def("is_segment_crossing", nb::overload_cast<double, double, double, double>(&ObstaclePolygon::is_segment_crossing), "Check if a segment defined by two points crosses the polygon", "ax"_a, "ay"_a, "bx"_a, "by"_a)
-        .def("is_segment_crossing", nb::overload_cast<const models::Coords&, const models::Coords&>(&ObstaclePolygon::is_segment_crossing), "Check if a segment defined by two points crosses the polygon", "a"_a, "b"_a)
-        .def("nearest_point", &ObstaclePolygon::nearest_point, "Find the nearest point on the polygon's perimeter to a given point", "p"_a)
-        .def_prop_rw("id", &ObstaclePolygon::id, &ObstaclePolygon::set_id, "Get or set the obstacle id")
-        .def_prop_rw("center", &ObstaclePolygon::center, &ObstaclePolygon::set_center, "Get or set the obstacle center")
-        .def_prop_ro("radius", &ObstaclePolygon::radius, "Obstacle circumscribed circle radius")
-        .def_prop_ro("bounding_box_margin", &ObstaclePolygon::bounding_box_margin, "Margin for the bounding box")
-        .def_prop_ro("bounding_box_points_number", &ObstaclePolygon::bounding_box_points_number, "Obstacle circumscribed circle radius")
-        .def_prop_ro("bounding_box", &ObstaclePolygon::bounding_box, nb::rv_policy::reference_internal, "The bounding box")
-        .def("__repr__", [](ObstaclePolygon& obj) {
+        .def(nb::init<const BasicObstaclePolygon<N>&, bool>(), "Deep copy constructor", "other"_a, "deep_copy"_a = false)
+        .def("is_point_inside", nb::overload_cast<double, double>(&BasicObstaclePolygon<N>::is_point_inside), "Check if a point is inside the circle", "x"_a, "y"_a)
+        .def("is_point_inside", nb::overload_cast<const models::Coords&>(&BasicObstaclePolygon<N>::is_point_inside), "Check if a point is inside the circle", "dest"_a)
+        .def("is_segment_crossing", nb::overload_cast<double, double, double, double>(&BasicObstaclePolygon<N>::is_segment_crossing), "Check if a segment defined by two points crosses the polygon", "ax"_a, "ay"_a, "bx"_a, "by"_a)
+        .def("is_segment_crossing", nb::overload_cast<const models::Coords&, const models::Coords&>(&BasicObstaclePolygon<N>::is_segment_crossing), "Check if a segment defined by two points crosses the polygon", "a"_a, "b"_a)
+        .def("nearest_point", nb::overload_cast<const models::Coords&>(&BasicObstaclePolygon<N>::nearest_point), "Find the nearest point on the polygon's perimeter to a given point", "p"_a)
+        .def_prop_rw("id", &BasicObstaclePolygon<N>::id, &BasicObstaclePolygon<N>::set_id, "Get or set the obstacle id")
+        .def_prop_rw("center", &BasicObstaclePolygon<N>::center, &BasicObstaclePolygon<N>::set_center, "Get or set the obstacle center")
+        .def_prop_ro("radius", &BasicObstaclePolygon<N>::radius, "Obstacle circumscribed circle radius")
+        .def_prop_ro("bounding_box_margin", &BasicObstaclePolygon<N>::bounding_box_margin, "Margin for the bounding box")
+        .def_prop_ro("bounding_box_points_number", &BasicObstaclePolygon<N>::bounding_box_points_number, "Obstacle circumscribed circle radius")
+        .def_prop_ro("bounding_box", &BasicObstaclePolygon<N>::bounding_box, nb::rv_policy::reference_internal, "The bounding box")
+        .def("__repr__", [](BasicObstaclePolygon<N>& obj) {
             std::ostringstream oss;
             oss << obj;
             return oss.str();
         });
 
     // Bind ObstaclePolygonIterator class
-    nb::class_<ObstaclePolygonIterator>(m, "ObstaclePolygonIterator")
+    nb::class_<ObstaclePolygonIterator>(m, names.polygon_iterator)
         .def("__next__", &ObstaclePolygonIterator::next, "Get the next element")  // Python's equivalent of `__next__`
         .def("__iter__", [](ObstaclePolygonIterator& self) -> ObstaclePolygonIterator& {
             return self;  // An iterator must return itself for `__iter__`
         });
 
     // Bind ObstaclePolygonList class
-    nb::class_<ObstaclePolygonList>(m, "ObstaclePolygonList")
-        .def("clear", &ObstaclePolygonList::clear, "Clear the list")
-        .def("size", &ObstaclePolygonList::size, "Get the number of coordinates")
-        .def("max_size", &ObstaclePolygonList::max_size, "Get the maximum number of coordinates")
-        .def("get", &ObstaclePolygonList::get, "Get Coords at index", "index"_a)
-        .def("__getitem__", &ObstaclePolygonList::operator[], "Get Coords at index", "index"_a)
-        .def("append", nb::overload_cast<const models::CoordsList&, double, uint32_t>(&ObstaclePolygonList::append), "Append obstacle", "points"_a, "bounding_box_margin"_a, "id"_a = 0)
-        .def("set", nb::overload_cast<std::size_t, const models::CoordsList&, double, uint32_t>(&ObstaclePolygonList::set), "Set coordinates at index", "index"_a, "points"_a, "bounding_box_margin"_a, "id"_a = 0)
-        .def("get_index", &ObstaclePolygonList::getIndex, "Return index of elem or -1 if not found", "elem"_a)
-        .def("__len__", &ObstaclePolygonList::size, "Return the length of the list")
-        .def("__iter__", [](ObstaclePolygonList& self) { return ObstaclePolygonIterator(self, 0); }, "Return an iterator object")
-        .def("__repr__", [](const ObstaclePolygonList& self) {
+    auto polygon_list = nb::class_<BasicObstaclePolygonList<N>>(m, names.polygon_list)
+        .def("clear", &BasicObstaclePolygonList<N>::clear, "Clear the list")
+        .def("size", &BasicObstaclePolygonList<N>::size, "Get the number of coordinates")
+        .def("max_size", &BasicObstaclePolygonList<N>::max_size, "Get the maximum number of coordinates")
+        .def("get", &BasicObstaclePolygonList<N>::get, "Get Coords at index", "index"_a)
+        .def("__getitem__", &BasicObstaclePolygonList<N>::operator[], "Get Coords at index", "index"_a)
+        .def("append", nb::overload_cast<const models::CoordsList&, double, uint32_t>(&BasicObstaclePolygonList<N>::append), "Append obstacle", "points"_a, "bounding_box_margin"_a, "id"_a = 0)
+        .def("set", nb::overload_cast<std::size_t, const models::CoordsList&, double, uint32_t>(&BasicObstaclePolygonList<N>::set), "Set coordinates at index", "index"_a, "points"_a, "bounding_box_margin"_a, "id"_a = 0)
+        .def("get_index", nb::overload_cast<const BasicObstaclePolygon<N>&>(&BasicObstaclePolygonList<N>::getIndex, nb::const_), "Return index of elem or -1 if not found", "elem"_a)
+        .def("__len__", &BasicObstaclePolygonList<N>::size, "Return the length of the list")
+        .def("__iter__", [](BasicObstaclePolygonList<N>& self) { return ObstaclePolygonIterator(self, 0); }, "Return an iterator object")
+        .def("__repr__", [names](const BasicObstaclePolygonList<N>& self) {
             std::ostringstream oss;
-            oss << "ObstaclePolygonList(size=" << self.size() << ", max_size=" << self.max_size() << ")";
+            oss << names.polygon_list << "(size=" << self.size() << ", max_size=" << self.max_size() << ")";
             return oss.str();
         })
     ;
+    bind_list_ndarray(polygon_list, obstacle_polygon_dtype<N>());
+    bind_list_queries(polygon_list);
 
     // Bind ObstacleRectangle class
-    nb::class_<ObstacleRectangle, ObstaclePolygon>(m, "ObstacleRectangle")
-        .def(nb::init<double, double, double, double, double, double, obstacle_polygon_t*>(),
+    nb::class_<BasicObstacleRectangle<N>, BasicObstaclePolygon<N>>(m, names.rectangle)
+        .def(nb::init<double, double, double, double, double, double, basic_obstacle_polygon_t<N>*>(),
              "Constructor with initial values",
              "x"_a, "y"_a, "angle"_a, "length_x"_a, "length_y"_a, "bounding_box_margin"_a, "data"_a = nullptr)
-        .def(nb::init<const ObstacleRectangle&, bool>(), "Deep copy constructor", "other"_a, "deep_copy"_a = false)
-        .def("is_point_inside", nb::overload_cast<double, double>(&ObstacleRectangle::is_point_inside), "Check if a point is inside the circle", "x"_a, "y"_a)
-        .def("is_point_inside", nb::overload_cast<const models::Coords&>(&ObstacleRectangle::is_point_inside), "Check if a point is inside the circle", "dest"_a)
-        .def("is_segment_crossing", nb::overload_cast<double, double, double, double>(&ObstacleRectangle::is_segment_crossing), "Check if a segment defined by two points crosses the rectangle", "ax"_a, "ay"_a, "bx"_a, "by"_a)
-        .def("is_segment_crossing", nb::overload_cast<const models::Coords&, const models::Coords&>(&ObstacleRectangle::is_segment_crossing), "Check if a segment defined by two points crosses the rectangle", "a"_a, "b"_a)
-        .def("nearest_point", &ObstacleRectangle::nearest_point, "Find the nearest point on the rectangle's perimeter to a given point", "p"_a)
-        .def_prop_rw("id", &ObstacleRectangle::id, &ObstacleRectangle::set_id, "Get or set the obstacle id")
-        .def_prop_rw("center", &ObstacleRectangle::center, &ObstacleRectangle::set_center, "Get or set the obstacle center")
-        .def_prop_ro("radius", &ObstacleRectangle::radius, "Obstacle circumscribed circle radius")
-        .def_prop_ro("length_x", &ObstacleRectangle::length_x, "Obstacle circumscribed circle radius")
-        .def_prop_ro("length_y", &ObstacleRectangle::length_y, "Obstacle circumscribed circle radius")
-        .def_prop_ro("bounding_box_margin", &ObstacleRectangle::bounding_box_margin, "Margin for the bounding box")
-        .def_prop_ro("bounding_box_points_number", &ObstacleRectangle::bounding_box_points_number, "Obstacle circumscribed circle radius")
-        .def_prop_ro("bounding_box", &ObstacleRectangle::bounding_box, nb::rv_policy::reference_internal, "The bounding box")
-        .def("__repr__", [](ObstacleRectangle& obj) {
+        .def(nb::init<const BasicObstacleRectangle<N>&, bool>(), "Deep copy constructor", "other"_a, "deep_copy"_a = false)
+        .def("is_point_inside", nb::overload_cast<double, double>(&BasicObstacleRectangle<N>::is_point_inside), "Check if a point is inside the circle", "x"_a, "y"_a)
+        .def("is_point_inside", nb::overload_cast<const models::Coords&>(&BasicObstacleRectangle<N>::is_point_inside), "Check if a point is inside the circle", "dest"_a)
+        .def("is_segment_crossing", nb::overload_cast<double, double, double, double>(&BasicObstacleRectangle<N>::is_segment_crossing), "Check if a segment defined by two points crosses the rectangle", "ax"_a, "ay"_a, "bx"_a, "by"_a)
+        .def("is_segment_crossing", nb::overload_cast<const models::Coords&, const models::Coords&>(&BasicObstacleRectangle<N>::is_segment_crossing), "Check if a segment defined by two points crosses the rectangle", "a"_a, "b"_a)
+        .def("nearest_point", nb::overload_cast<const models::Coords&>(&BasicObstacleRectangle<N>::nearest_point), "Find the nearest point on the rectangle's perimeter to a given point", "p"_a)
+        .def_prop_rw("id", &BasicObstacleRectangle<N>::id, &BasicObstacleRectangle<N>::set_id, "Get or set the obstacle id")
+        .def_prop_rw("center", &BasicObstacleRectangle<N>::center, &BasicObstacleRectangle<N>::set_center, "Get or set the obstacle center")
+        .def_prop_ro("radius", &BasicObstacleRectangle<N>::radius, "Obstacle circumscribed circle radius")
+        .def_prop_ro("length_x", &BasicObstacleRectangle<N>::length_x, "Obstacle circumscribed circle radius")
+        .def_prop_ro("length_y", &BasicObstacleRectangle<N>::length_y, "Obstacle circumscribed circle radius")
+        .def_prop_ro("bounding_box_margin", &BasicObstacleRectangle<N>::bounding_box_margin, "Margin for the bounding box")
+        .def_prop_ro("bounding_box_points_number", &BasicObstacleRectangle<N>::bounding_box_points_number, "Obstacle circumscribed circle radius")
+        .def_prop_ro("bounding_box", &BasicObstacleRectangle<N>::bounding_box, nb::rv_policy::reference_internal, "The bounding box")
+        .def("__repr__", [](BasicObstacleRectangle<N>& obj) {
             std::ostringstream oss;
             oss << obj;
             return oss.str();
         });
 
     // Bind ObstacleRectangleIterator class
-    nb::class_<ObstacleRectangleIterator>(m, "ObstacleRectangleIterator")
+    nb::class_<ObstacleRectangleIterator>(m, names.rectangle_iterator)
         .def("__next__", &ObstacleRectangleIterator::next, "Get the next element")  // Python's equivalent of `__next__`
         .def("__iter__", [](ObstacleRectangleIterator& self) -> ObstacleRectangleIterator& {
             return self;  // An iterator must return itself for `__iter__`
         });
 
     // Bind ObstacleRectangleList class
-    nb::class_<ObstacleRectangleList>(m, "ObstacleRectangleList")
-        .def("clear", &ObstacleRectangleList::clear, "Clear the list")
-        .def("size", &ObstacleRectangleList::size, "Get the number of coordinates")
-        .def("max_size", &ObstacleRectangleList::max_size, "Get the maximum number of coordinates")
-        .def("get", &ObstacleRectangleList::get, "Get Coords at index", "index"_a)
-        .def("__getitem__", &ObstacleRectangleList::operator[], "Get Coords at index", "index"_a)
-        .def("append", nb::overload_cast<double, double, double, double, double, double, uint32_t>(&ObstacleRectangleList::append), "Append obstacle", "x"_a, "y"_a, "angle"_a, "length_x"_a, "length_y"_a, "bounding_box_margin"_a, "id"_a = 0)
-        .def("set", nb::overload_cast<std::size_t, double, double, double, double, double, double, uint32_t>(&ObstacleRectangleList::set), "Set coordinates at index", "index"_a, "x"_a, "y"_a, "angle"_a, "length_x"_a, "length_y"_a, "bounding_box_margin"_a, "id"_a = 0)
-        .def("get_index", &ObstacleRectangleList::getIndex, "Return index of elem or -1 if not found", "elem"_a)
-        .def("__len__", &ObstacleRectangleList::size, "Return the length of the list")
-        .def("__iter__", [](ObstacleRectangleList& self) { return ObstacleRectangleIterator(self, 0); }, "Return an iterator object")
-        .def("__repr__", [](const ObstacleRectangleList& self) {
+    auto rectangle_list = nb::class_<BasicObstacleRectangleList<N>>(m, names.rectangle_list)
+        .def("clear", &BasicObstacleRectangleList<N>::clear, "Clear the list")
+        .def("size", &BasicObstacleRectangleList<N>::size, "Get the number of coordinates")
+        .def("max_size", &BasicObstacleRectangleList<N>::max_size, "Get the maximum number of coordinates")
+        .def("get", &BasicObstacleRectangleList<N>::get, "Get Coords at index", "index"_a)
+        .def("__getitem__", &BasicObstacleRectangleList<N>::operator[], "Get Coords at index", "index"_a)
+        .def("append", nb::overload_cast<double, double, double, double, double, double, uint32_t>(&BasicObstacleRectangleList<N>::append), "Append obstacle", "x"_a, "y"_a, "angle"_a, "length_x"_a, "length_y"_a, "bounding_box_margin"_a, "id"_a = 0)
+        .def("set", nb::overload_cast<std::size_t, double, double, double, double, double, double, uint32_t>(&BasicObstacleRectangleList<N>::set), "Set coordinates at index", "index"_a, "x"_a, "y"_a, "angle"_a, "length_x"_a, "length_y"_a, "bounding_box_margin"_a, "id"_a = 0)
+        .def("get_index", nb::overload_cast<const BasicObstacleRectangle<N>&>(&BasicObstacleRectangleList<N>::getIndex, nb::const_), "Return index of elem or -1 if not found", "elem"_a)
+        .def("__len__", &BasicObstacleRectangleList<N>::size, "Return the length of the list")
+        .def("__iter__", [](BasicObstacleRectangleList<N>& self) { return ObstacleRectangleIterator(self, 0); }, "Return an iterator object")
+        .def("__repr__", [names](const BasicObstacleRectangleList<N>& self) {
             std::ostringstream oss;
-            oss << "ObstacleRectangleList(size=" << self.size() << ", max_size=" << self.max_size() << ")";
+            oss << names.rectangle_list << "(size=" << self.size() << ", max_size=" << self.max_size() << ")";
             return oss.str();
         })
     ;
+    bind_list_ndarray(rectangle_list, obstacle_polygon_dtype<N>());
+    bind_list_queries(rectangle_list);
+}
+
+NB_MODULE(obstacles, m) {
+    auto models_module = nb::module_::import_("cogip.cpp.libraries.models");
+
+    nb::class_<Obstacle>(m, "Obstacle");
+
+    bind_obstacles<models::COORDS_LIST_SIZE_MAX>(m, {
+        "ObstacleCircleT", "ObstacleCircle", "ObstacleCircleIterator", "ObstacleCircleList",
+        "ObstaclePolygonT", "ObstaclePolygon", "ObstaclePolygonIterator", "ObstaclePolygonList",
+        "ObstacleRectangle", "ObstacleRectangleIterator", "ObstacleRectangleList"
+    });
 
+    // Compact obstacles, with at most COMPACT_COORDS_LIST_SIZE_MAX points, are the ones of the shared memory.
+    bind_obstacles<models::COMPACT_COORDS_LIST_SIZE_MAX>(m, {
+        "CompactObstacleCircleT", "CompactObstacleCircle", "CompactObstacleCircleIterator", "CompactObstacleCircleList",
+        "CompactObstaclePolygonT", "CompactObstaclePolygon", "CompactObstaclePolygonIterator", "CompactObstaclePolygonList",
+        "CompactObstacleRectangle", "CompactObstacleRectangleIterator", "CompactObstacleRectangleList"
+    });
 }
 
 } // namespace obstacles
@@ -15,6 +15,7 @@
 
 #include "models/CoordsList.hpp"
 #include "models/Pose.hpp"
+#include "models/Vec2.hpp"
 
 #include <cstdint>
 
@@ -24,6 +25,46 @@ namespace obstacles {
 
 constexpr std::size_t OBSTACLE_LIST_SIZE_MAX = 256;
 
+/// Margin added to the radius by broad phase tests, to absorb rounding errors.
+constexpr double BROAD_PHASE_MARGIN = 1e-3;
+
+/// Broad phase test of a point against a circle, using squared distances only.
+/// @return False if the point is outside the circle, true if it may be inside.
+inline bool is_point_near_circle(const models::Vec2& center, double radius, const models::Vec2& p)
+{
+    models::Vec2 cp = p - center;
+    double limit = radius + BROAD_PHASE_MARGIN;
+    return cp.dot(cp) <= limit * limit;
+}
+
+/// Broad phase test of a segment [AB] against a circle, using squared distances only.
+/// @return False if [AB] does not reach the circle, true if it may cross it.
+inline bool is_segment_near_circle(const models::Vec2& center, double radius,
+                                   const models::Vec2& a, const models::Vec2& b)
+{
+    double limit = radius + BROAD_PHASE_MARGIN;
+    double limit2 = limit * limit;
+    models::Vec2 ab = b - a;
+    models::Vec2 ac = center - a;
+
+    // Nearest point of [AB] is A.
+    double projection = ac.dot(ab);
+    if (projection <= 0) {
+        return ac.dot(ac) <= limit2;
+    }
+
+    // Nearest point of [AB] is B.
+    double length2 = ab.dot(ab);
+    if (projection >= length2) {
+        models::Vec2 bc = center - b;
+        return bc.dot(bc) <= limit2;
+    }
+
+    // Nearest point is inside [AB]: squared distance to the line times the squared length.
+    double cross = ab.cross(ac);
+    return cross * cross <= limit2 * length2;
+}
+
 /// @class Obstacle
 /// @brief Represents a generic obstacle for collision detection and avoidance.
 class Obstacle {
@@ -32,15 +73,19 @@ public:
     Obstacle() {};
 
     /// Check if the given point is inside the obstacle.
+    /// Vec2 overloads are the ones to use in hot paths: they do not allocate.
     virtual bool is_point_inside(double x, double y) = 0;
     virtual bool is_point_inside(const models::Coords& p) = 0;
+    virtual bool is_point_inside(const models::Vec2& p) = 0;
 
     /// Check if a segment defined by two points A,B is crossing an obstacle.
     virtual bool is_segment_crossing(double ax, double ay, double bx, double by) = 0;
     virtual bool is_segment_crossing(const models::Coords& a, const models::Coords& b) = 0;
+    virtual bool is_segment_crossing(const models::Vec2& a, const models::Vec2& b) = 0;
 
     /// Find the nearest point of obstacle perimeter from a given point.
     virtual models::Coords nearest_point(const models::Coords& p) = 0;
+    virtual models::Vec2 nearest_point(const models::Vec2& p) = 0;
 
     /// Return obstacle id.
     virtual uint32_t id() const = 0;
@@ -66,6 +111,18 @@ public:
     /// Get the bounding box.
     virtual models::CoordsList& bounding_box() = 0;
 
+    /// Broad phase test of a point against the circumscribed circle.
+    /// @return False if the point is outside the obstacle, true if the exact test is needed.
+    bool is_point_near(const models::Vec2& p) const {
+        return is_point_near_circle(models::Vec2(center()), radius(), p);
+    }
+
+    /// Broad phase test of a segment [AB] against the circumscribed circle.
+    /// @return False if [AB] does not cross the obstacle, true if the exact test is needed.
+    bool is_segment_near(const models::Vec2& a, const models::Vec2& b) const {
+        return is_segment_near_circle(models::Vec2(center()), radius(), a, b);
+    }
+
 private:
     /// Update bounding box.
     virtual void update_bounding_box() = 0;
@@ -16,49 +16,63 @@ namespace cogip {
 
 namespace obstacles {
 
-/// @class ObstacleCircle
+/// @class BasicObstacleCircle
 /// Circle obstacle defined by its center and radius.
-class ObstacleCircle : public Obstacle {
+/// @tparam N Maximum number of points of the bounding box.
+template <std::size_t N>
+class BasicObstacleCircle : public Obstacle {
 public:
     /// Default constructor.
-    ObstacleCircle() = delete;
+    BasicObstacleCircle() = delete;
 
     /// Constructor.
-    ObstacleCircle(
-        obstacle_circle_t* data  ///< [in] Pointer to an existing data structure
-                                 ///<      If nullptr, will allocate one internally
+    BasicObstacleCircle(
+        basic_obstacle_circle_t<N>* data  ///< [in] Pointer to an existing data structure
+                                          ///<      If nullptr, will allocate one internally
     );
 
     /// Copy constructor.
     /// @param other The obstacle to copy.
     /// @param deep_copy If true, will perform a deep copy of the data.
-    ObstacleCircle(const ObstacleCircle& other, bool deep_copy=false);
+    BasicObstacleCircle(const BasicObstacleCircle& other, bool deep_copy=false);
 
     /// Constructor with initial values.
-    ObstacleCircle(
+    BasicObstacleCircle(
         double x,                            ///< [in] X coordinate of the center.
         double y,                            ///< [in] Y coordinate of the center.
         double angle,                        ///< [in] Orientation angle in degrees.
         double radius,                       ///< [in] Radius of the circle.
         double bounding_box_margin,          ///< [in] Bounding box margin.
         uint8_t bounding_box_points_number,  ///< [in] Number of points for the bounding box.
-        obstacle_circle_t* data=nullptr      ///< [in] Pointer to an existing data structure
-                                             ///<      If nullptr, will allocate one internally
+        basic_obstacle_circle_t<N>* data=nullptr  ///< [in] Pointer to an existing data structure
+                                                  ///<      If nullptr, will allocate one internally
     );
 
     /// Destructor.
-    ~ObstacleCircle();
+    ~BasicObstacleCircle();
 
     /// Check if a point is inside the circle.
-    bool is_point_inside(double x, double y) override { return center_.distance(x, y) <= data_->radius; };
-    bool is_point_inside(const models::Coords& p) override { return is_point_inside(p.x(), p.y()); };
+    bool is_point_inside(double x, double y) override { return is_point_inside(models::Vec2(x, y)); };
+    bool is_point_inside(const models::Coords& p) override { return is_point_inside(models::Vec2(p)); };
+    bool is_point_inside(const models::Vec2& p) override {
+        return p.distance(data_->center.x, data_->center.y) <= data_->radius;
+    };
 
     /// Check if a segment defined by two points crosses the circle.
-    bool is_segment_crossing(double ax, double ay, double bx, double by) override;
-    bool is_segment_crossing(const models::Coords& a, const models::Coords& b) override;
+    bool is_segment_crossing(double ax, double ay, double bx, double by) override {
+        return is_segment_crossing(models::Vec2(ax, ay), models::Vec2(bx, by));
+    };
+    bool is_segment_crossing(const models::Coords& a, const models::Coords& b) override {
+        return is_segment_crossing(models::Vec2(a), models::Vec2(b));
+    };
+    bool is_segment_crossing(const models::Vec2& a, const models::Vec2& b) override;
 
     /// Find the nearest point on the circle's perimeter to a given point.
-    models::Coords nearest_point(const models::Coords& p) override;
+    models::Coords nearest_point(const models::Coords& p) override {
+        models::Vec2 point = nearest_point(models::Vec2(p));
+        return models::Coords(point.x, point.y);
+    };
+    models::Vec2 nearest_point(const models::Vec2& p) override;
 
     /// Return obstacle id.
     uint32_t id() const override { return data_->id; }
@@ -81,6 +95,18 @@ public:
     /// Return obstacle circumscribed circle radius.
     double radius() const override { return data_->radius; }
 
+    /// Return velocity along X of the tracked obstacle (mm/s).
+    double vx() const { return data_->vx; }
+
+    /// Set velocity along X of the tracked obstacle (mm/s).
+    void set_vx(double vx) { data_->vx = vx; }
+
+    /// Return velocity along Y of the tracked obstacle (mm/s).
+    double vy() const { return data_->vy; }
+
+    /// Set velocity along Y of the tracked obstacle (mm/s).
+    void set_vy(double vy) { data_->vy = vy; }
+
     /// Return margin for the bounding box.
     double bounding_box_margin() const override { return data_->bounding_box_margin; }
 
@@ -91,7 +117,7 @@ public:
     virtual models::CoordsList& bounding_box() override { return bounding_box_; };
 
     /// Equality operator.
-    bool operator==(obstacle_circle_t& other) const {
+    bool operator==(basic_obstacle_circle_t<N>& other) const {
         return data_->center.x == other.center.x &&
                data_->center.y == other.center.y &&
                data_->center.angle == other.center.angle &&
@@ -101,7 +127,7 @@ public:
     }
 
 private:
-    obstacle_circle_t* data_;  ///< pointer to internal data structure
+    basic_obstacle_circle_t<N>* data_;  ///< pointer to internal data structure
     bool external_data_;       ///< Flag to indicate if memory is externally managed
 
     /// C++ wrappers.
@@ -114,13 +140,19 @@ private:
     /// Check if a line defined by two points crosses the circle.
     /// @return True if (AB) crosses the circle, false otherwise.
     bool is_line_crossing_circle(
-        const models::Coords& a, ///< [in] Point A.
-        const models::Coords& b  ///< [in] Point B.
+        const models::Vec2& a, ///< [in] Point A.
+        const models::Vec2& b  ///< [in] Point B.
     );
 };
 
+typedef BasicObstacleCircle<models::COORDS_LIST_SIZE_MAX> ObstacleCircle;
+
+/// Circle obstacle wrapping a compact data structure, used in shared memory.
+typedef BasicObstacleCircle<models::COMPACT_COORDS_LIST_SIZE_MAX> CompactObstacleCircle;
+
 // Overload the stream insertion operator for obstacle_circle_t
-inline std::ostream& operator<<(std::ostream& os, ObstacleCircle& obj) {
+template <std::size_t N>
+inline std::ostream& operator<<(std::ostream& os, BasicObstacleCircle<N>& obj) {
     os << "ObstacleCircle(center=" << obj.center()
        << ", radius=" << obj.radius()
        << ", bounding_box_margin=" << obj.bounding_box_margin()
@@ -13,15 +13,38 @@
 #include "obstacles/obstacle_circle_list.hpp"
 #include "models/List.hpp"
 
+#include <cmath>
+#include <stdexcept>
+
 namespace cogip {
 
+namespace models {
+
+/// Obstacles are equal if they have the same geometry, like `BasicObstacleCircle`.
+template <std::size_t N>
+struct ElemEqual<obstacles::basic_obstacle_circle_t<N>> {
+    bool operator()(const obstacles::basic_obstacle_circle_t<N>& a, const obstacles::basic_obstacle_circle_t<N>& b) const {
+        return a.center.x == b.center.x &&
+               a.center.y == b.center.y &&
+               a.center.angle == b.center.angle &&
+               a.radius == b.radius &&
+               a.bounding_box_margin == b.bounding_box_margin &&
+               a.bounding_box_points_number == b.bounding_box_points_number;
+    }
+};
+
+} // namespace models
+
 namespace obstacles {
 
-class ObstacleCircleList:
-    public models::List<obstacle_circle_t, ObstacleCircle, obstacle_circle_list_t, OBSTACLE_LIST_SIZE_MAX>
+/// List of circle obstacles.
+/// @tparam N Maximum number of points of each obstacle.
+template <std::size_t N>
+class BasicObstacleCircleList:
+    public models::List<basic_obstacle_circle_t<N>, BasicObstacleCircle<N>, basic_obstacle_circle_list_t<N>, OBSTACLE_LIST_SIZE_MAX>
 {
 public:
-    ObstacleCircleList(obstacle_circle_list_t* list) : List(list) {};
+    BasicObstacleCircleList(basic_obstacle_circle_list_t<N>* list) : models::List<basic_obstacle_circle_t<N>, BasicObstacleCircle<N>, basic_obstacle_circle_list_t<N>, OBSTACLE_LIST_SIZE_MAX>(list) {};
 
     void append(
         double x,
@@ -32,12 +55,12 @@ public:
         uint8_t bounding_box_points_number,
         uint32_t id = 0
     ) {
-        if (size() >= max_size()) {
+        if (this->size() >= this->max_size()) {
             throw std::runtime_error("ObstacleCircleList is full");
         }
-        list_->count++;
+        this->list_->count++;
         set(
-            size() - 1,
+            this->size() - 1,
             x,
             y,
             angle,
@@ -58,22 +81,96 @@ public:
         uint8_t bounding_box_points_number,
         uint32_t id = 0
     ) {
-        if (index >= size()) {
+        if (index >= this->size()) {
             throw std::runtime_error("index out of range");
         }
-        ObstacleCircle(
+        BasicObstacleCircle<N>(
             x,
             y,
             angle,
             radius,
             bounding_box_margin,
             bounding_box_points_number,
-            &list_->elems[index]
+            &this->list_->elems[index]
         );
-        list_->elems[index].id = id;
+        this->list_->elems[index].id = id;
+    };
+
+    /// Replace all obstacles by circles sharing the same angle and bounding box parameters.
+    /// The vertices of the unit polygon are computed once for the whole batch,
+    /// then each bounding box is scaled and translated from them, without building any wrapper.
+    /// @param x X coordinates of the centers.
+    /// @param y Y coordinates of the centers.
+    /// @param radius Radii of the circles.
+    /// @param ids Identifiers of the obstacles.
+    /// @param count Number of obstacles, size of each array.
+    /// @param angle Orientation angle of the obstacles in degrees.
+    /// @param bounding_box_margin Bounding box margin.
+    /// @param bounding_box_points_number Number of points of the bounding boxes.
+    /// @param vx Velocities along X of the tracked obstacles (mm/s), or nullptr for static obstacles.
+    /// @param vy Velocities along Y of the tracked obstacles (mm/s), or nullptr for static obstacles.
+    void assign_circles(
+        const double* x,
+        const double* y,
+        const double* radius,
+        const uint32_t* ids,
+        std::size_t count,
+        double angle,
+        double bounding_box_margin,
+        uint8_t bounding_box_points_number,
+        const double* vx = nullptr,
+        const double* vy = nullptr
+    ) {
+        if (count > this->max_size()) {
+            throw std::runtime_error("ObstacleCircleList is full");
+        }
+        if (bounding_box_points_number == 0 || bounding_box_points_number > N) {
+            throw std::invalid_argument("invalid number of bounding box points");
+        }
+
+        double unit_x[N];
+        double unit_y[N];
+        for (uint8_t i = 0; i < bounding_box_points_number; ++i) {
+            double vertex_angle = (static_cast<double>(i) * 2 * M_PI) / bounding_box_points_number;
+            unit_x[i] = std::cos(vertex_angle);
+            unit_y[i] = std::sin(vertex_angle);
+        }
+        // Scale of the unit polygon circumscribing a circle of radius 1
+        double circumscribed_scale = 1 / std::cos(M_PI / bounding_box_points_number);
+
+        for (std::size_t index = 0; index < count; ++index) {
+            basic_obstacle_circle_t<N>& obstacle = this->list_->elems[index];
+            obstacle.id = ids[index];
+            obstacle.center.x = x[index];
+            obstacle.center.y = y[index];
+            obstacle.center.angle = angle;
+            obstacle.radius = radius[index];
+            obstacle.vx = vx ? vx[index] : 0;
+            obstacle.vy = vy ? vy[index] : 0;
+            obstacle.bounding_box_margin = bounding_box_margin;
+            obstacle.bounding_box_points_number = bounding_box_points_number;
+
+            if (radius[index] <= 0) {
+                obstacle.bounding_box.count = 0;
+                continue;
+            }
+            double circumscribed_radius = std::fma(radius[index], circumscribed_scale, bounding_box_margin);
+            models::coords_t* vertices = obstacle.bounding_box.elems;
+            for (uint8_t i = 0; i < bounding_box_points_number; ++i) {
+                vertices[i].x = std::fma(circumscribed_radius, unit_x[i], x[index]);
+                vertices[i].y = std::fma(circumscribed_radius, unit_y[i], y[index]);
+            }
+            obstacle.bounding_box.count = bounding_box_points_number;
+        }
+        this->list_->count = count;
     };
 };
 
+typedef BasicObstacleCircleList<models::COORDS_LIST_SIZE_MAX> ObstacleCircleList;
+
+/// List of compact circle obstacles, used in shared memory.
+typedef BasicObstacleCircleList<models::COMPACT_COORDS_LIST_SIZE_MAX> CompactObstacleCircleList;
+
 } // namespace obstacles
 
 } // namespace cogip
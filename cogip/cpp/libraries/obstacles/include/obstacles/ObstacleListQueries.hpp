@@ -0,0 +1,83 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_obstacles
+/// @{
+/// @file
+/// @brief       Bulk point and segment queries on obstacle lists.
+/// @details     Each obstacle is wrapped once and tested against all queries,
+///              with the broad phase test of its circumscribed circle first.
+/// @author      Eric Courtois <eric.courtois@gmail.com>
+
+#pragma once
+
+#include "models/Vec2.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace cogip {
+
+namespace obstacles {
+
+/// Find the first obstacle of a list containing each point.
+/// @param list Obstacle list.
+/// @param x X coordinates of the points.
+/// @param y Y coordinates of the points.
+/// @param count Number of points.
+/// @param[out] first For each point, index of the first obstacle containing it, -1 if none.
+template <typename ListType>
+void first_obstacles_containing(ListType& list, const double* x, const double* y, std::size_t count, int32_t* first)
+{
+    std::fill_n(first, count, -1);
+    for (std::size_t index = 0; index < list.size(); index++) {
+        auto obstacle = list.get(index);
+        for (std::size_t i = 0; i < count; i++) {
+            if (first[i] >= 0) {
+                continue;
+            }
+            models::Vec2 p(x[i], y[i]);
+            if (obstacle.is_point_near(p) && obstacle.is_point_inside(p)) {
+                first[i] = static_cast<int32_t>(index);
+            }
+        }
+    }
+}
+
+/// Find the first obstacle of a list crossed by each segment [AB].
+/// @param list Obstacle list.
+/// @param ax X coordinates of points A.
+/// @param ay Y coordinates of points A.
+/// @param bx X coordinates of points B.
+/// @param by Y coordinates of points B.
+/// @param count Number of segments.
+/// @param[out] first For each segment, index of the first obstacle it crosses, -1 if none.
+template <typename ListType>
+void first_obstacles_crossed(
+    ListType& list,
+    const double* ax, const double* ay, const double* bx, const double* by,
+    std::size_t count, int32_t* first)
+{
+    std::fill_n(first, count, -1);
+    for (std::size_t index = 0; index < list.size(); index++) {
+        auto obstacle = list.get(index);
+        for (std::size_t i = 0; i < count; i++) {
+            if (first[i] >= 0) {
+                continue;
+            }
+            models::Vec2 a(ax[i], ay[i]);
+            models::Vec2 b(bx[i], by[i]);
+            if (obstacle.is_segment_near(a, b) && obstacle.is_segment_crossing(a, b)) {
+                first[i] = static_cast<int32_t>(index);
+            }
+        }
+    }
+}
+
+} // namespace obstacles
+
+} // namespace cogip
+
+/// @}
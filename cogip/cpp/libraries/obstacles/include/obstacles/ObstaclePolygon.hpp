@@ -18,42 +18,54 @@ namespace cogip {
 
 namespace obstacles {
 
-/// @class ObstaclePolygon
+/// @class BasicObstaclePolygon
 /// @brief A polygon obstacle defined by a list of points.
-class ObstaclePolygon : public Obstacle {
+/// @tparam N Maximum number of points of the polygon and of the bounding box.
+template <std::size_t N>
+class BasicObstaclePolygon : public Obstacle {
 public:
     /// Default constructor.
-    ObstaclePolygon() = default;
+    BasicObstaclePolygon() = default;
 
     /// Constructor.
-    ObstaclePolygon(
-        obstacle_polygon_t* data  ///< [in] Pointer to an existing data structure
-                                  ///<      If nullptr, will allocate one internally
+    BasicObstaclePolygon(
+        basic_obstacle_polygon_t<N>* data  ///< [in] Pointer to an existing data structure
+                                           ///<      If nullptr, will allocate one internally
     );
 
     /// Copy constructor.
     /// @param other The obstacle to copy.
     /// @param deep_copy If true, will perform a deep copy of the data.
-    ObstaclePolygon(const ObstaclePolygon& other, bool deep_copy=false);
+    BasicObstaclePolygon(const BasicObstaclePolygon& other, bool deep_copy=false);
 
     /// Constructor with points defining the polygon.
-    ObstaclePolygon(
-        const models::CoordsList& points,    ///< [in] List of points defining the polygon.
-        double bounding_box_margin,          ///< [in] Bounding box margin.
-        obstacle_polygon_t* data=nullptr     ///< [in] Pointer to an existing data structure
-                                             ///<      If nullptr, will allocate one internally
+    BasicObstaclePolygon(
+        const models::CoordsList& points,          ///< [in] List of points defining the polygon.
+        double bounding_box_margin,                ///< [in] Bounding box margin.
+        basic_obstacle_polygon_t<N>* data=nullptr  ///< [in] Pointer to an existing data structure
+                                                   ///<      If nullptr, will allocate one internally
     );
 
     /// Check if a point is inside the polygon.
-    bool is_point_inside(double x, double y) override;
-    bool is_point_inside(const models::Coords& p) override { return is_point_inside(p.x(), p.y()); };
+    bool is_point_inside(double x, double y) override { return is_point_inside(models::Vec2(x, y)); };
+    bool is_point_inside(const models::Coords& p) override { return is_point_inside(models::Vec2(p)); };
+    bool is_point_inside(const models::Vec2& p) override;
 
     /// Check if a segment defined by two points crosses the polygon.
-    bool is_segment_crossing(double ax, double ay, double bx, double by) override;
-    bool is_segment_crossing(const models::Coords& a, const models::Coords& b) override;
+    bool is_segment_crossing(double ax, double ay, double bx, double by) override {
+        return is_segment_crossing(models::Vec2(ax, ay), models::Vec2(bx, by));
+    };
+    bool is_segment_crossing(const models::Coords& a, const models::Coords& b) override {
+        return is_segment_crossing(models::Vec2(a), models::Vec2(b));
+    };
+    bool is_segment_crossing(const models::Vec2& a, const models::Vec2& b) override;
 
     /// Find the nearest point on the polygon's perimeter to a given point.
-    models::Coords nearest_point(const models::Coords& p) override;
+    models::Coords nearest_point(const models::Coords& p) override {
+        models::Vec2 point = nearest_point(models::Vec2(p));
+        return models::Coords(point.x, point.y);
+    };
+    models::Vec2 nearest_point(const models::Vec2& p) override;
 
     /// Return obstacle id.
     uint32_t id() const override { return data_->id; }
@@ -88,7 +100,7 @@ public:
     models::CoordsList& points() { return points_; }
 
     /// Equality operator.
-    bool operator==(obstacle_polygon_t& other) const {
+    bool operator==(basic_obstacle_polygon_t<N>& other) const {
         return data_->center.x == other.center.x &&
                data_->center.y == other.center.y &&
                data_->center.angle == other.center.angle &&
@@ -98,7 +110,7 @@ public:
     };
 
 protected:
-    obstacle_polygon_t* data_;  ///< pointer to internal data structure
+    basic_obstacle_polygon_t<N>* data_;  ///< pointer to internal data structure
     bool external_data_;        ///< Flag to indicate if memory is externally managed
 
     /// C++ wrappers.
@@ -118,8 +130,14 @@ protected:
     int calculate_polygon_radius();
 };
 
+typedef BasicObstaclePolygon<models::COORDS_LIST_SIZE_MAX> ObstaclePolygon;
+
+/// Polygon obstacle wrapping a compact data structure, used in shared memory.
+typedef BasicObstaclePolygon<models::COMPACT_COORDS_LIST_SIZE_MAX> CompactObstaclePolygon;
+
 // Overload the stream insertion operator for ObstaclePolygon
-inline std::ostream& operator<<(std::ostream& os, ObstaclePolygon& obj) {
+template <std::size_t N>
+inline std::ostream& operator<<(std::ostream& os, BasicObstaclePolygon<N>& obj) {
     os << "ObstaclePolygon(center=" << obj.center()
        << ", radius=" << obj.radius()
        << ", points=" << obj.points()
@@ -15,25 +15,45 @@
 
 namespace cogip {
 
+namespace models {
+
+/// Obstacles are equal if they have the same geometry, like `BasicObstaclePolygon`.
+template <std::size_t N>
+struct ElemEqual<obstacles::basic_obstacle_polygon_t<N>> {
+    bool operator()(const obstacles::basic_obstacle_polygon_t<N>& a, const obstacles::basic_obstacle_polygon_t<N>& b) const {
+        return a.center.x == b.center.x &&
+               a.center.y == b.center.y &&
+               a.center.angle == b.center.angle &&
+               a.radius == b.radius &&
+               a.bounding_box_margin == b.bounding_box_margin &&
+               a.bounding_box_points_number == b.bounding_box_points_number;
+    }
+};
+
+} // namespace models
+
 namespace obstacles {
 
-class ObstaclePolygonList:
-    public models::List<obstacle_polygon_t, ObstaclePolygon, obstacle_polygon_list_t, OBSTACLE_LIST_SIZE_MAX>
+/// List of polygon obstacles.
+/// @tparam N Maximum number of points of each obstacle.
+template <std::size_t N>
+class BasicObstaclePolygonList:
+    public models::List<basic_obstacle_polygon_t<N>, BasicObstaclePolygon<N>, basic_obstacle_polygon_list_t<N>, OBSTACLE_LIST_SIZE_MAX>
 {
 public:
-    ObstaclePolygonList(obstacle_polygon_list_t* list) : List(list) {};
+    BasicObstaclePolygonList(basic_obstacle_polygon_list_t<N>* list) : models::List<basic_obstacle_polygon_t<N>, BasicObstaclePolygon<N>, basic_obstacle_polygon_list_t<N>, OBSTACLE_LIST_SIZE_MAX>(list) {};
 
     void append(
         const models::CoordsList& points,    ///< [in] List of points defining the polygon.
         double bounding_box_margin,          ///< [in] Bounding box margin.
         uint32_t id = 0                      ///< [in] Optional identifier.
     ) {
-        if (size() >= max_size()) {
+        if (this->size() >= this->max_size()) {
             throw std::runtime_error("ObstaclePolygonList is full");
         }
-        list_->count++;
+        this->list_->count++;
         set(
-            size() - 1,
+            this->size() - 1,
             points,
             bounding_box_margin,
             id
@@ -46,18 +66,23 @@ public:
         double bounding_box_margin,          ///< [in] Bounding box margin.
         uint32_t id = 0                      ///< [in] Optional identifier.
     ) {
-        if (index >= size()) {
+        if (index >= this->size()) {
             throw std::runtime_error("index out of range");
         }
-        ObstaclePolygon(
+        BasicObstaclePolygon<N>(
             points,
             bounding_box_margin,
-            &list_->elems[index]
+            &this->list_->elems[index]
         );
-        list_->elems[index].id = id;
+        this->list_->elems[index].id = id;
     };
 };
 
+typedef BasicObstaclePolygonList<models::COORDS_LIST_SIZE_MAX> ObstaclePolygonList;
+
+/// List of compact polygon obstacles, used in shared memory.
+typedef BasicObstaclePolygonList<models::COMPACT_COORDS_LIST_SIZE_MAX> CompactObstaclePolygonList;
+
 } // namespace obstacles
 
 } // namespace cogip
@@ -16,47 +16,55 @@ namespace cogip {
 
 namespace obstacles {
 
-/// @class ObstacleRectangle
+/// @class BasicObstacleRectangle
 /// @brief A rectangular obstacle that simplifies the representation of a polygon.
 ///
 /// This class provides a simplified way to define rectangular obstacles by specifying
 /// a center pose, orientation, and lengths along the X and Y axes.
-class ObstacleRectangle : public ObstaclePolygon {
+/// @tparam N Maximum number of points of the polygon and of the bounding box.
+template <std::size_t N>
+class BasicObstacleRectangle : public BasicObstaclePolygon<N> {
 public:
     /// Constructor.
-    ObstacleRectangle(
-        obstacle_polygon_t* data  ///< [in] Pointer to an existing data structure
-                                  ///<      If nullptr, will allocate one internally
-    ): ObstaclePolygon(data) {};
+    BasicObstacleRectangle(
+        basic_obstacle_polygon_t<N>* data  ///< [in] Pointer to an existing data structure
+                                           ///<      If nullptr, will allocate one internally
+    ): BasicObstaclePolygon<N>(data) {};
 
     /// Copy constructor.
     /// @param other The obstacle to copy.
     /// @param deep_copy If true, will perform a deep copy of the data.
-    ObstacleRectangle(const ObstaclePolygon& other, bool deep_copy=false): ObstaclePolygon(other, deep_copy) {};
+    BasicObstacleRectangle(const BasicObstaclePolygon<N>& other, bool deep_copy=false):
+        BasicObstaclePolygon<N>(other, deep_copy) {};
 
     /// Constructor for ObstacleRectangle.
-    ObstacleRectangle(
+    BasicObstacleRectangle(
         double x,                            ///< [in] X coordinate of the center.
         double y,                            ///< [in] Y coordinate of the center.
         double angle,                        ///< [in] Orientation angle in degrees.
         double length_x,                     ///< [in] Length along the X-axis.
         double length_y,                     ///< [in] Length along the Y-axis.
         double bounding_box_margin,          ///< [in] Bounding box margin.
-        obstacle_polygon_t* data=nullptr     ///< [in] Pointer to an existing data structure
-                                             ///<      If nullptr, will allocate one internally
+        basic_obstacle_polygon_t<N>* data=nullptr  ///< [in] Pointer to an existing data structure
+                                                   ///<      If nullptr, will allocate one internally
     );
 
     /// Return length along the X-axis.
-    double length_x() const { return data_->length_x; }
+    double length_x() const { return this->data_->length_x; }
 
     /// Return length along the Y-axis.
-    double length_y() const { return data_->length_y; }
+    double length_y() const { return this->data_->length_y; }
 
 private:
     /// Update the bounding box for the rectangle.
     void update_bounding_box() override;
 };
 
+typedef BasicObstacleRectangle<models::COORDS_LIST_SIZE_MAX> ObstacleRectangle;
+
+/// Rectangle obstacle wrapping a compact data structure, used in shared memory.
+typedef BasicObstacleRectangle<models::COMPACT_COORDS_LIST_SIZE_MAX> CompactObstacleRectangle;
+
 } // namespace obstacles
 
 } // namespace cogip
@@ -10,18 +10,21 @@
 #pragma once
 
 #include "obstacles/ObstacleRectangle.hpp"
-#include "obstacles/obstacle_polygon_list.hpp"
+#include "obstacles/ObstaclePolygonList.hpp"
 #include "models/List.hpp"
 
 namespace cogip {
 
 namespace obstacles {
 
-class ObstacleRectangleList:
-    public models::List<obstacle_polygon_t, ObstacleRectangle, obstacle_polygon_list_t, OBSTACLE_LIST_SIZE_MAX>
+/// List of rectangle obstacles.
+/// @tparam N Maximum number of points of each obstacle.
+template <std::size_t N>
+class BasicObstacleRectangleList:
+    public models::List<basic_obstacle_polygon_t<N>, BasicObstacleRectangle<N>, basic_obstacle_polygon_list_t<N>, OBSTACLE_LIST_SIZE_MAX>
 {
 public:
-    ObstacleRectangleList(obstacle_polygon_list_t* list) : List(list) {};
+    BasicObstacleRectangleList(basic_obstacle_polygon_list_t<N>* list) : models::List<basic_obstacle_polygon_t<N>, BasicObstacleRectangle<N>, basic_obstacle_polygon_list_t<N>, OBSTACLE_LIST_SIZE_MAX>(list) {};
 
     void append(
         double x,                            ///< [in] X coordinate of the center.
@@ -32,12 +35,12 @@ public:
         double bounding_box_margin,          ///< [in] Bounding box margin.
         uint32_t id = 0                      ///< [in] Optional identifier.
     ) {
-        if (size() >= max_size()) {
+        if (this->size() >= this->max_size()) {
             throw std::runtime_error("ObstaclePolygonList is full");
         }
-        list_->count++;
+        this->list_->count++;
         set(
-            size() - 1,
+            this->size() - 1,
             x,
             y,
             angle,
@@ -58,22 +61,27 @@ public:
         double bounding_box_margin,          ///< [in] Bounding box margin.
         uint32_t id = 0                      ///< [in] Optional identifier.
     ) {
-        if (index >= size()) {
+        if (index >= this->size()) {
             throw std::runtime_error("index out of range");
         }
-        ObstacleRectangle(
+        BasicObstacleRectangle<N>(
             x,
             y,
             angle,
             length_x,
             length_y,
             bounding_box_margin,
-            &list_->elems[index]
+            &this->list_->elems[index]
         );
-        list_->elems[index].id = id;
+        this->list_->elems[index].id = id;
     };
 };
 
+typedef BasicObstacleRectangleList<models::COORDS_LIST_SIZE_MAX> ObstacleRectangleList;
+
+/// List of compact rectangle obstacles, used in shared memory.
+typedef BasicObstacleRectangleList<models::COMPACT_COORDS_LIST_SIZE_MAX> CompactObstacleRectangleList;
+
 } // namespace obstacles
 
 } // namespace cogip
@@ -18,19 +18,32 @@ namespace cogip {
 
 namespace obstacles {
 
-typedef struct {
+/// Circle obstacle.
+/// @tparam N Maximum number of points of the bounding box.
+template <std::size_t N>
+struct basic_obstacle_circle_t {
     uint32_t id;                         ///< Optional identifier.
     models::pose_t center;               ///< Obstacle center.
     double radius;                       ///< Obstacle circumscribed circle radius.
+    double vx;                           ///< Velocity along X of the tracked obstacle (mm/s).
+    double vy;                           ///< Velocity along Y of the tracked obstacle (mm/s).
     double bounding_box_margin;          ///< Margin for the bounding box.
     uint8_t bounding_box_points_number;  ///< Number of points to define the bounding box.
-    models::coords_list_t bounding_box;  ///< Precomputed bounding box for avoidance.
-} obstacle_circle_t;
+    models::basic_coords_list_t<N> bounding_box;  ///< Precomputed bounding box for avoidance.
+};
+
+typedef basic_obstacle_circle_t<models::COORDS_LIST_SIZE_MAX> obstacle_circle_t;
+
+/// Circle obstacle with a small bounding box, used in shared memory.
+typedef basic_obstacle_circle_t<models::COMPACT_COORDS_LIST_SIZE_MAX> compact_obstacle_circle_t;
 
 // Overload the stream insertion operator for obstacle_circle_t
-inline std::ostream& operator<<(std::ostream& os, const obstacle_circle_t& obj) {
+template <std::size_t N>
+inline std::ostream& operator<<(std::ostream& os, const basic_obstacle_circle_t<N>& obj) {
     os << "obstacle_circle_t(center=" << obj.center
        << ", radius=" << obj.radius
+       << ", vx=" << obj.vx
+       << ", vy=" << obj.vy
        << ", bounding_box_margin=" << obj.bounding_box_margin
        << ", bounding_box_points_number=" << static_cast<int>(obj.bounding_box_points_number)
        << ", bounding_box=" << obj.bounding_box
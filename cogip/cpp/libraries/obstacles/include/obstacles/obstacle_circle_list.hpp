@@ -16,10 +16,18 @@ namespace cogip {
 
 namespace obstacles {
 
-typedef struct {
+/// List of circle obstacles.
+/// @tparam N Maximum number of points of the bounding boxes.
+template <std::size_t N>
+struct basic_obstacle_circle_list_t {
     std::size_t count;
-    obstacle_circle_t elems[OBSTACLE_LIST_SIZE_MAX];
-} obstacle_circle_list_t;
+    basic_obstacle_circle_t<N> elems[OBSTACLE_LIST_SIZE_MAX];
+};
+
+typedef basic_obstacle_circle_list_t<models::COORDS_LIST_SIZE_MAX> obstacle_circle_list_t;
+
+/// List of compact circle obstacles, used in shared memory.
+typedef basic_obstacle_circle_list_t<models::COMPACT_COORDS_LIST_SIZE_MAX> compact_obstacle_circle_list_t;
 
 
 } // namespace obstacles
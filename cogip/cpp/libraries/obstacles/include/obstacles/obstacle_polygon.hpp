@@ -18,22 +18,31 @@ namespace cogip {
 
 namespace obstacles {
 
-typedef struct {
+/// Polygon obstacle.
+/// @tparam N Maximum number of points of the polygon and of the bounding box.
+template <std::size_t N>
+struct basic_obstacle_polygon_t {
     uint32_t id;                         ///< Optional identifier.
     models::pose_t center;               ///< Obstacle center.
     double radius;                       ///< Obstacle circumscribed circle radius.
-    models::coords_list_t points;        ///< Points defining the polygon.
+    models::basic_coords_list_t<N> points;        ///< Points defining the polygon.
     double bounding_box_margin;          ///< Margin for the bounding box.
     uint8_t bounding_box_points_number;  ///< Number of points to define the bounding box.
-    models::coords_list_t bounding_box;  ///< Precomputed bounding box for avoidance.
+    models::basic_coords_list_t<N> bounding_box;  ///< Precomputed bounding box for avoidance.
     // The following fields are only used for rectangle obstacles, this allows ObstacleRectangle to
     // inherit from ObstaclePolygon by using the same struct.
     double length_x;                     ///< Length of the rectangle along the X-axis.
     double length_y;                     ///< Length of the rectangle along the Y-axis.
-} obstacle_polygon_t;
+};
+
+typedef basic_obstacle_polygon_t<models::COORDS_LIST_SIZE_MAX> obstacle_polygon_t;
+
+/// Polygon obstacle with small point lists, used in shared memory.
+typedef basic_obstacle_polygon_t<models::COMPACT_COORDS_LIST_SIZE_MAX> compact_obstacle_polygon_t;
 
 // Overload the stream insertion operator for obstacle_polygon_t
-inline std::ostream& operator<<(std::ostream& os, const obstacle_polygon_t& obj) {
+template <std::size_t N>
+inline std::ostream& operator<<(std::ostream& os, const basic_obstacle_polygon_t<N>& obj) {
     os << "obstacle_polygon_t(center=" << obj.center
        << ", radius=" << obj.radius
        << ", points=" << obj.points
@@ -16,10 +16,18 @@ namespace cogip {
 
 namespace obstacles {
 
-typedef struct {
+/// List of polygon obstacles.
+/// @tparam N Maximum number of points of the polygons and of the bounding boxes.
+template <std::size_t N>
+struct basic_obstacle_polygon_list_t {
     std::size_t count;
-    obstacle_polygon_t elems[OBSTACLE_LIST_SIZE_MAX];
-} obstacle_polygon_list_t;
+    basic_obstacle_polygon_t<N> elems[OBSTACLE_LIST_SIZE_MAX];
+};
+
+typedef basic_obstacle_polygon_list_t<models::COORDS_LIST_SIZE_MAX> obstacle_polygon_list_t;
+
+/// List of compact polygon obstacles, used in shared memory.
+typedef basic_obstacle_polygon_list_t<models::COMPACT_COORDS_LIST_SIZE_MAX> compact_obstacle_polygon_list_t;
 
 } // namespace obstacles
 
@@ -0,0 +1,221 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "shared_memory/GlobalSharedMemory.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace cogip {
+
+namespace shared_memory {
+
+namespace {
+
+/// Value of the magic number while the first process stamps the layout.
+constexpr std::uint32_t GLOBAL_DATA_STAMPING = 1;
+
+} // namespace
+
+GlobalSharedMemory::GlobalSharedMemory(const std::string& name):
+    name_(name),
+    data_(nullptr)
+{
+    umask(0000); // Allow full permissions (rw-rw-rw-)
+
+    // No process owns the segment, the first one creates it.
+    int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open global shared memory segment: " + std::string(std::strerror(errno)));
+    }
+    struct stat shm_stat;
+    if (fstat(fd, &shm_stat) < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to check global shared memory segment: " + std::string(std::strerror(errno)));
+    }
+    // Processes creating the segment at the same time all set the same size.
+    if (shm_stat.st_size == 0 && ftruncate(fd, sizeof(global_data_t)) < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to set size of global shared memory segment");
+    }
+    if (shm_stat.st_size != 0 && static_cast<std::size_t>(shm_stat.st_size) != sizeof(global_data_t)) {
+        close(fd);
+        throw std::runtime_error("Global shared memory segment size does not match global_data_t, check all processes use the same build");
+    }
+    void* data = mmap(nullptr, sizeof(global_data_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map global shared memory segment");
+    }
+    data_ = static_cast<global_data_t*>(data);
+
+    // A zeroed segment is an empty registry, the first process only stamps its layout.
+    std::uint32_t magic = 0;
+    if (data_->magic.compare_exchange_strong(magic, GLOBAL_DATA_STAMPING, std::memory_order_acquire)) {
+        data_->version = GLOBAL_DATA_VERSION;
+        data_->size = sizeof(global_data_t);
+        data_->magic.store(GLOBAL_DATA_MAGIC, std::memory_order_release);
+        magic = GLOBAL_DATA_MAGIC;
+    }
+    while (magic == GLOBAL_DATA_STAMPING) {
+        std::this_thread::yield();
+        magic = data_->magic.load(std::memory_order_acquire);
+    }
+    if (magic != GLOBAL_DATA_MAGIC || data_->version != GLOBAL_DATA_VERSION || data_->size != sizeof(global_data_t)) {
+        munmap(data_, sizeof(global_data_t));
+        throw std::runtime_error("Global shared memory segment layout does not match global_data_t, check all processes use the same build");
+    }
+}
+
+GlobalSharedMemory::~GlobalSharedMemory()
+{
+    munmap(data_, sizeof(global_data_t));
+}
+
+void GlobalSharedMemory::unlink(const std::string& name)
+{
+    shm_unlink(name.c_str());
+}
+
+void GlobalSharedMemory::registerRobot(std::uint32_t robot_id)
+{
+    if (robot_id == 0) {
+        throw std::invalid_argument("Robot id 0 cannot be registered");
+    }
+    if (findRobot(robot_id)) {
+        return;
+    }
+    for (global_robot_entry_t& entry : data_->robots) {
+        std::uint32_t free_id = 0;
+        if (entry.robot_id.compare_exchange_strong(free_id, robot_id, std::memory_order_acq_rel)) {
+            seqlockWrite(entry.seqlock, [&]() {
+                entry.state.generation = 0;
+                entry.state.timestamp = 0;
+                entry.state.pose = {};
+                entry.state.obstacle_count = 0;
+            });
+            return;
+        }
+    }
+    throw std::runtime_error("Global shared memory registry is full");
+}
+
+void GlobalSharedMemory::unregisterRobot(std::uint32_t robot_id)
+{
+    global_robot_entry_t* entry = findRobot(robot_id);
+    if (entry) {
+        entry->robot_id.store(0, std::memory_order_release);
+    }
+}
+
+std::vector<std::uint32_t> GlobalSharedMemory::robots() const
+{
+    std::vector<std::uint32_t> robot_ids;
+    for (const global_robot_entry_t& entry : data_->robots) {
+        std::uint32_t robot_id = entry.robot_id.load(std::memory_order_acquire);
+        if (robot_id) {
+            robot_ids.push_back(robot_id);
+        }
+    }
+    return robot_ids;
+}
+
+std::uint64_t GlobalSharedMemory::publishRobotState(
+    std::uint32_t robot_id,
+    const models::pose_t& pose,
+    std::uint64_t timestamp,
+    const models::circle_t* obstacles,
+    std::size_t obstacle_count)
+{
+    global_robot_entry_t* entry = findRobot(robot_id);
+    if (!entry) {
+        throw std::runtime_error("Robot " + std::to_string(robot_id) + " is not registered in the global shared memory");
+    }
+    std::uint32_t count = static_cast<std::uint32_t>(std::min(obstacle_count, GLOBAL_ROBOT_OBSTACLES_MAX));
+    std::uint64_t generation = 0;
+    seqlockWrite(entry->seqlock, [&]() {
+        generation = ++entry->state.generation;
+        entry->state.timestamp = timestamp;
+        entry->state.pose = pose;
+        entry->state.obstacle_count = count;
+        std::memcpy(entry->state.obstacles, obstacles, count * sizeof(models::circle_t));
+    });
+    return generation;
+}
+
+std::uint64_t GlobalSharedMemory::publishRobot(std::uint32_t robot_id, SharedMemory& shared_memory)
+{
+    models::circle_t obstacles[GLOBAL_ROBOT_OBSTACLES_MAX];
+    WritePriorityLock& lock = shared_memory.getLock(LockName::DetectorObstacles);
+    lock.startReading();
+    const models::circle_list_t& detector_obstacles = shared_memory.getData()->detector_obstacles;
+    std::size_t count = std::min(detector_obstacles.count, GLOBAL_ROBOT_OBSTACLES_MAX);
+    std::memcpy(obstacles, detector_obstacles.elems, count * sizeof(models::circle_t));
+    lock.finishReading();
+
+    // Pose and timestamp are read from the same slot of the pose buffer.
+    const models::pose_buffer_t* pose_buffer = shared_memory.getPoseCurrentBuffer()->data();
+    models::pose_t pose = {};
+    std::uint64_t timestamp = 0;
+    shared_memory.getPoseCurrentBuffer()->read([&](std::uint64_t write_index) {
+        if (write_index == 0) {
+            return write_index;
+        }
+        std::uint64_t last = write_index - 1;
+        pose = pose_buffer->poses[last % models::POSE_BUFFER_SIZE_MAX];
+        timestamp = pose_buffer->timestamps[last % models::POSE_BUFFER_SIZE_MAX];
+        return last;
+    });
+    return publishRobotState(robot_id, pose, timestamp, obstacles, count);
+}
+
+std::uint64_t GlobalSharedMemory::getGeneration(std::uint32_t robot_id) const
+{
+    const global_robot_entry_t* entry = findRobot(robot_id);
+    if (!entry) {
+        return 0;
+    }
+    std::uint64_t generation = 0;
+    seqlockRead(entry->seqlock, [&]() {
+        generation = entry->state.generation;
+    });
+    return generation;
+}
+
+bool GlobalSharedMemory::readRobotState(std::uint32_t robot_id, global_robot_state_t& state) const
+{
+    const global_robot_entry_t* entry = findRobot(robot_id);
+    if (!entry) {
+        return false;
+    }
+    seqlockRead(entry->seqlock, [&]() {
+        state.generation = entry->state.generation;
+        state.timestamp = entry->state.timestamp;
+        state.pose = entry->state.pose;
+        state.obstacle_count = std::min<std::uint32_t>(entry->state.obstacle_count, GLOBAL_ROBOT_OBSTACLES_MAX);
+        std::memcpy(state.obstacles, entry->state.obstacles, state.obstacle_count * sizeof(models::circle_t));
+    });
+    return true;
+}
+
+global_robot_entry_t* GlobalSharedMemory::findRobot(std::uint32_t robot_id) const
+{
+    for (global_robot_entry_t& entry : data_->robots) {
+        if (robot_id != 0 && entry.robot_id.load(std::memory_order_acquire) == robot_id) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace shared_memory
+
+} // namespace cogip
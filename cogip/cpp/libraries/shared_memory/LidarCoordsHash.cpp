@@ -0,0 +1,133 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "shared_memory/LidarCoordsHash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace shared_memory {
+
+namespace {
+
+/// Squared distance between a point and a segment.
+double segmentDistance2(double px, double py, double ax, double ay, double abx, double aby, double ab2)
+{
+    double t = 0;
+    if (ab2 > 0) {
+        t = std::clamp(((px - ax) * abx + (py - ay) * aby) / ab2, 0.0, 1.0);
+    }
+    double dx = ax + t * abx - px;
+    double dy = ay + t * aby - py;
+    return dx * dx + dy * dy;
+}
+
+} // namespace
+
+void buildLidarCoordsHash(const lidar_coords_t& coords, std::size_t count, double cell_size, lidar_coords_hash_t& hash)
+{
+    if (!(cell_size > 0)) {
+        throw std::invalid_argument("Lidar coords hash cell size must be positive");
+    }
+    if (count > MAX_LIDAR_DATA_COUNT) {
+        throw std::invalid_argument("Too many lidar coords to hash");
+    }
+
+    std::array<std::uint16_t, MAX_LIDAR_DATA_COUNT> buckets;
+    std::array<std::uint16_t, LIDAR_COORDS_HASH_BUCKETS + 1> cursors{};
+
+    hash.cell_size = cell_size;
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t bucket = lidarCoordsHashBucket(
+            static_cast<std::int64_t>(std::floor(coords[i][0] / cell_size)),
+            static_cast<std::int64_t>(std::floor(coords[i][1] / cell_size))
+        );
+        buckets[i] = static_cast<std::uint16_t>(bucket);
+        cursors[bucket + 1]++;
+    }
+    for (std::size_t bucket = 0; bucket < LIDAR_COORDS_HASH_BUCKETS; bucket++) {
+        cursors[bucket + 1] += cursors[bucket];
+    }
+    std::copy(cursors.begin(), cursors.end(), hash.bucket_starts);
+    for (std::size_t i = 0; i < count; i++) {
+        hash.points[cursors[buckets[i]]++] = static_cast<std::uint16_t>(i);
+    }
+}
+
+bool isLidarCoordsNearSegment(
+    const lidar_coords_t& coords,
+    std::size_t count,
+    const lidar_coords_hash_t& hash,
+    double ax,
+    double ay,
+    double bx,
+    double by,
+    double distance
+)
+{
+    count = std::min(count, MAX_LIDAR_DATA_COUNT);
+    if (count == 0 || distance < 0) {
+        return false;
+    }
+
+    double abx = bx - ax;
+    double aby = by - ay;
+    double ab2 = abx * abx + aby * aby;
+    double distance2 = distance * distance;
+
+    auto isNear = [&](std::size_t i) {
+        return segmentDistance2(coords[i][0], coords[i][1], ax, ay, abx, aby, ab2) <= distance2;
+    };
+
+    double cell_size = hash.cell_size;
+    double min_cell_x = 0, min_cell_y = 0, cell_count_x = 0, cell_count_y = 0;
+    if (cell_size > 0) {
+        min_cell_x = std::floor((std::min(ax, bx) - distance) / cell_size);
+        min_cell_y = std::floor((std::min(ay, by) - distance) / cell_size);
+        cell_count_x = std::floor((std::max(ax, bx) + distance) / cell_size) - min_cell_x + 1;
+        cell_count_y = std::floor((std::max(ay, by) + distance) / cell_size) - min_cell_y + 1;
+    }
+
+    // Without hash, or when the segment covers more cells than there are points, a linear scan is cheaper.
+    if (!(cell_size > 0) || cell_count_x * cell_count_y > static_cast<double>(count)) {
+        for (std::size_t i = 0; i < count; i++) {
+            if (isNear(i)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A cell may hold a point within the distance only if its center is within the distance plus its half diagonal.
+    double cell_reach = distance + cell_size * M_SQRT1_2;
+    double cell_reach2 = cell_reach * cell_reach;
+    for (std::int64_t cx = 0; cx < static_cast<std::int64_t>(cell_count_x); cx++) {
+        std::int64_t cell_x = static_cast<std::int64_t>(min_cell_x) + cx;
+        double center_x = (static_cast<double>(cell_x) + 0.5) * cell_size;
+        for (std::int64_t cy = 0; cy < static_cast<std::int64_t>(cell_count_y); cy++) {
+            std::int64_t cell_y = static_cast<std::int64_t>(min_cell_y) + cy;
+            double center_y = (static_cast<double>(cell_y) + 0.5) * cell_size;
+            if (segmentDistance2(center_x, center_y, ax, ay, abx, aby, ab2) > cell_reach2) {
+                continue;
+            }
+            std::size_t bucket = lidarCoordsHashBucket(cell_x, cell_y);
+            std::size_t end = std::min<std::size_t>(hash.bucket_starts[bucket + 1], count);
+            for (std::size_t p = hash.bucket_starts[bucket]; p < end; p++) {
+                std::size_t i = hash.points[p];
+                if (i < count && isNear(i)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace shared_memory
+
+} // namespace cogip
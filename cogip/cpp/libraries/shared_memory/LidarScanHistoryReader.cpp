@@ -0,0 +1,65 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "shared_memory/LidarScanHistoryReader.hpp"
+
+namespace cogip {
+
+namespace shared_memory {
+
+LidarScanHistoryReader::LidarScanHistoryReader(const SharedMemory& shared_memory):
+    shared_memory_(shared_memory),
+    next_sequence_(shared_memory.getLidarScanHistoryHead() + 1),
+    last_sequence_(0),
+    dropped_count_(0)
+{
+}
+
+template <typename Points>
+bool LidarScanHistoryReader::readNextScan(Points& points, lidar_scan_header_t& header)
+{
+    std::uint64_t head = shared_memory_.getLidarScanHistoryHead();
+    while (next_sequence_ <= head) {
+        // Scans older than the ring size are overwritten, skip to the oldest one still available.
+        if (head - next_sequence_ >= LIDAR_SCAN_HISTORY_SIZE) {
+            std::uint64_t oldest = head - LIDAR_SCAN_HISTORY_SIZE + 1;
+            dropped_count_ += oldest - next_sequence_;
+            next_sequence_ = oldest;
+        }
+        if (shared_memory_.readLidarScanHistory(next_sequence_, points, header)) {
+            last_sequence_ = next_sequence_++;
+            return true;
+        }
+        // Overwritten while being copied.
+        dropped_count_++;
+        next_sequence_++;
+        head = shared_memory_.getLidarScanHistoryHead();
+    }
+    return false;
+}
+
+bool LidarScanHistoryReader::readNext(lidar_data_t& data, lidar_scan_header_t& header)
+{
+    return readNextScan(data, header);
+}
+
+bool LidarScanHistoryReader::readNext(lidar_compact_points_t& points, lidar_scan_header_t& header)
+{
+    return readNextScan(points, header);
+}
+
+void LidarScanHistoryReader::skipToLatest()
+{
+    next_sequence_ = shared_memory_.getLidarScanHistoryHead() + 1;
+}
+
+std::uint64_t LidarScanHistoryReader::pendingCount() const
+{
+    std::uint64_t head = shared_memory_.getLidarScanHistoryHead();
+    return head >= next_sequence_ ? head - next_sequence_ + 1 : 0;
+}
+
+} // namespace shared_memory
+
+} // namespace cogip
@@ -3,8 +3,13 @@
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
 #include "shared_memory/SharedMemory.hpp"
+#include "shared_memory/LidarCoordsHash.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
 #include <cstring>
+#include <ctime>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -16,11 +21,92 @@ namespace cogip {
 
 namespace shared_memory {
 
-SharedMemory::SharedMemory(const std::string& name, bool owner):
+namespace {
+
+/// Converts an RGBA image of the simulated camera size to packed RGB.
+void rgbaToRgb(const std::uint8_t* rgba, std::uint8_t* rgb)
+{
+    for (std::size_t pixel = 0; pixel < SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT; pixel++) {
+        rgb[pixel * 3] = rgba[pixel * 4];
+        rgb[pixel * 3 + 1] = rgba[pixel * 4 + 1];
+        rgb[pixel * 3 + 2] = rgba[pixel * 4 + 2];
+    }
+}
+
+/// Converts an RGBA image of the simulated camera size to planar YUV 4:2:0,
+/// with the BT.601 limited range integer coefficients also used by OpenCV.
+/// U and V are computed from the average color of each block of 2 x 2 pixels.
+void rgbaToYuv420(const std::uint8_t* rgba, std::uint8_t* yuv)
+{
+    std::uint8_t* y_plane = yuv;
+    std::uint8_t* u_plane = y_plane + SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT;
+    std::uint8_t* v_plane = u_plane + SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT / 4;
+
+    for (std::size_t pixel = 0; pixel < SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT; pixel++) {
+        int r = rgba[pixel * 4];
+        int g = rgba[pixel * 4 + 1];
+        int b = rgba[pixel * 4 + 2];
+        y_plane[pixel] = static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+
+    for (std::size_t row = 0; row < SIM_CAMERA_HEIGHT / 2; row++) {
+        const std::uint8_t* top = rgba + row * 2 * SIM_CAMERA_WIDTH * 4;
+        const std::uint8_t* bottom = top + SIM_CAMERA_WIDTH * 4;
+        for (std::size_t column = 0; column < SIM_CAMERA_WIDTH / 2; column++) {
+            std::size_t offset = column * 8;
+            int r = (top[offset] + top[offset + 4] + bottom[offset] + bottom[offset + 4] + 2) >> 2;
+            int g = (top[offset + 1] + top[offset + 5] + bottom[offset + 1] + bottom[offset + 5] + 2) >> 2;
+            int b = (top[offset + 2] + top[offset + 6] + bottom[offset + 2] + bottom[offset + 6] + 2) >> 2;
+            std::size_t index = row * SIM_CAMERA_WIDTH / 2 + column;
+            u_plane[index] = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            v_plane[index] = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+/// Calls a function on each seqlock of the shared data, including those of the triple buffers.
+template <typename Function>
+void forEachSeqlock(shared_data_t& data, Function&& function)
+{
+    function(data.pose_order_seqlock);
+    function(data.occupancy_grid_seqlock);
+    function(data.properties_seqlock);
+    for (seqlock_t& lock : data.lidar_data.seqlocks) {
+        function(lock);
+    }
+    for (seqlock_t& lock : data.lidar_coords.seqlocks) {
+        function(lock);
+    }
+    for (lidar_scan_history_entry_t& entry : data.lidar_scan_history.entries) {
+        function(entry.seqlock);
+    }
+    for (latency_histogram_t& histogram : data.latency_histograms) {
+        function(histogram.seqlock);
+    }
+    for (seqlock_t& lock : data.planner_obstacles.seqlocks) {
+        function(lock);
+    }
+}
+
+/// Offset of the first data region in shared_data_t.
+/// The header, generation counters and lock states before it describe the live segment, snapshots do not load them.
+std::size_t snapshotDataOffset(const shared_data_t& data)
+{
+    return reinterpret_cast<const char*>(&data.pose_current_buffer) - reinterpret_cast<const char*>(&data);
+}
+
+} // namespace
+
+SharedMemory::SharedMemory(const std::string& name, bool owner, bool prefault):
     name_(name),
     owner_(owner),
+    in_process_(false),
+    prefault_(prefault),
     shm_fd_(-1),
-    data_(nullptr)
+    data_(nullptr),
+    sim_camera_shm_name_("/" + name + "_sim_camera"),
+    sim_camera_shm_fd_(-1),
+    sim_camera_data_(nullptr)
 {
     int shm_flags = O_RDWR;
     if (owner) {
@@ -39,50 +125,170 @@ SharedMemory::SharedMemory(const std::string& name, bool owner):
             throw std::runtime_error("Failed to set size of shared memory segment");
         }
     }
+    else {
+        // Accessing a segment smaller than expected would raise SIGBUS instead of a clean error.
+        struct stat shm_stat;
+        if (fstat(shm_fd_, &shm_stat) < 0 || static_cast<std::size_t>(shm_stat.st_size) != sizeof(shared_data_t)) {
+            close(shm_fd_);
+            throw std::runtime_error("Shared memory segment size does not match shared_data_t, check all processes use the same build");
+        }
+    }
 
-    data_ = static_cast<shared_data_t*>(mmap(nullptr, sizeof(shared_data_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd_, 0));
+    // The owner allocates the pages itself while initializing the segment,
+    // other processes only map the existing pages.
+    int map_flags = MAP_SHARED;
+    if (prefault_ && !owner_) {
+        map_flags |= MAP_POPULATE;
+    }
+    data_ = static_cast<shared_data_t*>(mmap(nullptr, sizeof(shared_data_t), PROT_READ | PROT_WRITE, map_flags, shm_fd_, 0));
     if (data_ == MAP_FAILED) {
         throw std::runtime_error("Failed to map shared memory segment");
     }
 
+#ifdef MADV_HUGEPAGE
+    // POSIX shared memory lives in tmpfs, which cannot use MAP_HUGETLB but provides transparent huge pages
+    // if /sys/kernel/mm/transparent_hugepage/shmem_enabled is "advise".
+    // The advice must be given before pages are allocated by the initialization below.
+    if (prefault_ && owner_ && madvise(data_, sizeof(shared_data_t), MADV_HUGEPAGE) < 0) {
+        std::cerr << "SharedMemory(\"" << name_ << "\"): transparent huge pages not available: "
+                  << std::strerror(errno) << std::endl;
+    }
+#endif
+
+    if (owner_) {
+        initializeData();
+    }
+    else if (
+        data_->header.magic != SHARED_DATA_MAGIC ||
+        data_->header.version != SHARED_DATA_VERSION ||
+        data_->header.size != sizeof(shared_data_t)
+    ) {
+        munmap(data_, sizeof(shared_data_t));
+        close(shm_fd_);
+        throw std::runtime_error("Shared memory segment layout does not match shared_data_t, check all processes use the same build");
+    }
+
     if (owner_) {
-        std::memset(data_, 0, sizeof(shared_data_t));
+        // Pages of the simulated camera segment are only allocated when written.
+        sim_camera_shm_fd_ = shm_open(sim_camera_shm_name_.c_str(), shm_flags, 0666);
+        if (sim_camera_shm_fd_ < 0) {
+            throw std::runtime_error("Failed to create shared memory segment for simulated camera data");
+        }
+        if (ftruncate(sim_camera_shm_fd_, sizeof(sim_camera_data_t)) < 0) {
+            throw std::runtime_error("Failed to set size of shared memory segment for simulated camera data");
+        }
+    }
+
+    attachData();
+
+    std::cout << "SharedMemory(\"" << name_ << "\", owner=" << owner_ << ", prefault=" << prefault_ << ", size=" << sizeof(shared_data_t) << ") created." << std::endl;
+}
+
+SharedMemory::SharedMemory(const std::string& name, in_process_t, bool prefault):
+    name_(name),
+    owner_(true),
+    in_process_(true),
+    prefault_(prefault),
+    shm_fd_(-1),
+    data_(nullptr),
+    sim_camera_shm_fd_(-1),
+    sim_camera_data_(nullptr)
+{
+    int map_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    data_ = static_cast<shared_data_t*>(mmap(nullptr, sizeof(shared_data_t), PROT_READ | PROT_WRITE, map_flags, -1, 0));
+    if (data_ == MAP_FAILED) {
+        throw std::runtime_error("Failed to map in-process shared data");
+    }
+
+#ifdef MADV_HUGEPAGE
+    // Anonymous memory uses transparent huge pages if /sys/kernel/mm/transparent_hugepage/enabled is "advise".
+    if (prefault_ && madvise(data_, sizeof(shared_data_t), MADV_HUGEPAGE) < 0) {
+        std::cerr << "SharedMemory(\"" << name_ << "\"): transparent huge pages not available: "
+                  << std::strerror(errno) << std::endl;
+    }
+#endif
+
+    // Initializing the data writes every page, so the whole mapping is faulted in as with a named segment owner.
+    initializeData();
+    attachData();
+
+    std::cout << "SharedMemory(\"" << name_ << "\", in_process=1, prefault=" << prefault_ << ", size=" << sizeof(shared_data_t) << ") created." << std::endl;
+}
+
+void SharedMemory::initializeData()
+{
+    std::memset(static_cast<void*>(data_), 0, sizeof(shared_data_t));
+    for (auto& slot : data_->lidar_data.slots) {
         for (std::size_t i{0}; i < MAX_LIDAR_DATA_COUNT; ++i) {
-            data_->lidar_data[i][0] = -1;
-            data_->lidar_data[i][1] = -1;
-            data_->lidar_data[i][2] = -1;
+            slot[i][0] = -1;
+            slot[i][1] = -1;
+            slot[i][2] = -1;
         }
     }
+    for (auto& slot : data_->lidar_coords.slots) {
+        slot[0][0] = -1;
+        slot[0][1] = -1;
+    }
+    data_->header.version = SHARED_DATA_VERSION;
+    data_->header.size = sizeof(shared_data_t);
+    data_->header.magic = SHARED_DATA_MAGIC;
+}
 
+void SharedMemory::attachData()
+{
+    if (prefault_) {
+        // Hot regions are all regions before table_limits, rarely written regions are not locked.
+        std::size_t hot_size = reinterpret_cast<char*>(&data_->table_limits) - reinterpret_cast<char*>(data_);
+        if (mlock(data_, hot_size) < 0) {
+            std::cerr << "SharedMemory(\"" << name_ << "\"): failed to lock " << hot_size << " bytes in RAM: "
+                      << std::strerror(errno) << " (check RLIMIT_MEMLOCK)" << std::endl;
+        }
+    }
+
+    // Lock states live in the segment, so attaching opens no other shared memory object.
     for (const auto& [lock, name] : lock2str) {
-        locks_.emplace(lock, std::make_unique<WritePriorityLock>(name_ + "_" + name, owner_));
+        std::size_t index = static_cast<std::size_t>(lock);
+        locks_.emplace(lock, std::make_unique<WritePriorityLock>(
+            name_ + "_" + name, data_->locks[index], owner_, &data_->generations[index].value
+        ));
     }
     pose_current_buffer_ = new models::PoseBuffer(&data_->pose_current_buffer);
     detector_obstacles_ = new models::CircleList(&data_->detector_obstacles);
     monitor_obstacles_ = new models::CircleList(&data_->monitor_obstacles);
-    circle_obstacles_ = new obstacles::ObstacleCircleList(&data_->circle_obstacles);
-    rectangle_obstacles_ = new obstacles::ObstacleRectangleList(&data_->rectangle_obstacles);
+    for (std::uint32_t copy = 0; copy < PLANNER_OBSTACLES_COPIES; copy++) {
+        circle_obstacles_[copy] = new obstacles::CompactObstacleCircleList(&data_->planner_obstacles.copies[copy].circles);
+        rectangle_obstacles_[copy] = new obstacles::CompactObstacleRectangleList(&data_->planner_obstacles.copies[copy].rectangles);
+    }
     avoidance_new_pose_order_ = new models::PoseOrder(&data_->avoidance_new_pose_order);
     avoidance_pose_order_ = new models::PoseOrder(&data_->avoidance_pose_order);
     avoidance_path_ = new models::PoseOrderList(&data_->avoidance_path);
-
-    std::cout << "SharedMemory(\"" << name_ << "\", owner=" << owner_ << ", size=" << sizeof(shared_data_t) << ") created." << std::endl;
 }
 
 SharedMemory::~SharedMemory() {
-    delete rectangle_obstacles_;
-    delete circle_obstacles_;
+    for (std::uint32_t copy = 0; copy < PLANNER_OBSTACLES_COPIES; copy++) {
+        delete rectangle_obstacles_[copy];
+        delete circle_obstacles_[copy];
+    }
     delete monitor_obstacles_;
     delete detector_obstacles_;
     delete pose_current_buffer_;
 
+    if (sim_camera_data_ != nullptr) {
+        munmap(sim_camera_data_, sizeof(sim_camera_data_t));
+    }
+    if (sim_camera_shm_fd_ != -1) {
+        close(sim_camera_shm_fd_);
+    }
+    if (owner_ && !in_process_) {
+        shm_unlink(sim_camera_shm_name_.c_str());
+    }
     if (data_ != nullptr) {
         munmap(data_, sizeof(shared_data_t));
     }
     if (shm_fd_ != -1) {
         close(shm_fd_);
     }
-    if (owner_) {
+    if (owner_ && !in_process_) {
         shm_unlink(name_.c_str());
     }
     std::cout << "SharedMemory(\"" << name_ << "\", owner=" << owner_ << ") deleted." << std::endl;
@@ -97,6 +303,619 @@ WritePriorityLock& SharedMemory::getLock(LockName lock) {
     return *(it->second);
 }
 
+sim_camera_data_t& SharedMemory::getSimCameraData() {
+    if (sim_camera_data_ != nullptr) {
+        return *sim_camera_data_;
+    }
+    if (in_process_) {
+        // Anonymous pages are zeroed, as the pages of a new segment.
+        void* data = mmap(nullptr, sizeof(sim_camera_data_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Failed to map in-process simulated camera data");
+        }
+        sim_camera_data_ = static_cast<sim_camera_data_t*>(data);
+        return *sim_camera_data_;
+    }
+    if (sim_camera_shm_fd_ < 0) {
+        sim_camera_shm_fd_ = shm_open(sim_camera_shm_name_.c_str(), O_RDWR, 0666);
+        if (sim_camera_shm_fd_ < 0) {
+            throw std::runtime_error("Failed to open shared memory segment for simulated camera data");
+        }
+    }
+    struct stat shm_stat;
+    if (fstat(sim_camera_shm_fd_, &shm_stat) < 0 || static_cast<std::size_t>(shm_stat.st_size) != sizeof(sim_camera_data_t)) {
+        throw std::runtime_error("Simulated camera segment size does not match sim_camera_data_t, check all processes use the same build");
+    }
+    void* data = mmap(nullptr, sizeof(sim_camera_data_t), PROT_READ | PROT_WRITE, MAP_SHARED, sim_camera_shm_fd_, 0);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shared memory segment for simulated camera data");
+    }
+    sim_camera_data_ = static_cast<sim_camera_data_t*>(data);
+    return *sim_camera_data_;
+}
+
+void SharedMemory::requestSimCameraFormat(SimCameraFormat format)
+{
+    getSimCameraData().requested_format.store(static_cast<std::uint32_t>(format), std::memory_order_relaxed);
+}
+
+SimCameraFormat SharedMemory::getRequestedSimCameraFormat()
+{
+    return static_cast<SimCameraFormat>(getSimCameraData().requested_format.load(std::memory_order_relaxed));
+}
+
+std::uint64_t SharedMemory::publishSimCameraFrame(const std::uint8_t* rgba, std::uint64_t timestamp)
+{
+    sim_camera_data_t& camera = getSimCameraData();
+    std::uint32_t latest = camera.frames.latest.load(std::memory_order_relaxed) % TRIPLE_BUFFER_SLOTS;
+    std::uint64_t sequence = camera.headers[latest].sequence + 1;
+    SimCameraFormat format = getRequestedSimCameraFormat();
+
+    // The slot written is the one following the latest, which is also sequence % TRIPLE_BUFFER_SLOTS.
+    sim_camera_frame_t& slot = tripleBufferBeginWrite(camera.frames);
+    sim_camera_frame_header_t& header = camera.headers[&slot - camera.frames.slots];
+    switch (format) {
+    case SimCameraFormat::RGB:
+        rgbaToRgb(rgba, slot);
+        break;
+    case SimCameraFormat::YUV420:
+        rgbaToYuv420(rgba, slot);
+        break;
+    default:
+        format = SimCameraFormat::RGBA;
+        std::memcpy(slot, rgba, simCameraFrameSize(format));
+        break;
+    }
+    header.sequence = sequence;
+    header.timestamp = timestamp;
+    header.format = format;
+    tripleBufferPublish(camera.frames);
+    return sequence;
+}
+
+const std::uint8_t* SharedMemory::getSimCameraFrame(sim_camera_frame_header_t& header)
+{
+    sim_camera_data_t& camera = getSimCameraData();
+    const std::uint8_t* pixels = nullptr;
+    tripleBufferRead(camera.frames, [&](const sim_camera_frame_t& slot) {
+        header = camera.headers[&slot - camera.frames.slots];
+        pixels = slot;
+    });
+    return header.sequence ? pixels : nullptr;
+}
+
+bool SharedMemory::isSimCameraFrameValid(const sim_camera_frame_header_t& header)
+{
+    if (header.sequence == 0) {
+        return false;
+    }
+    sim_camera_data_t& camera = getSimCameraData();
+    std::size_t index = header.sequence % TRIPLE_BUFFER_SLOTS;
+    // Reads of the frame must be complete before the slot state is checked.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::uint32_t state = camera.frames.seqlocks[index].sequence.load(std::memory_order_relaxed);
+    return !(state & 1) && camera.headers[index].sequence == header.sequence;
+}
+
+void SharedMemory::dump(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create shared memory snapshot " + path + ": " + std::strerror(errno));
+    }
+    if (ftruncate(fd, sizeof(shared_data_t)) < 0) {
+        close(fd);
+        throw std::runtime_error("Cannot allocate shared memory snapshot " + path + ": " + std::strerror(errno));
+    }
+    // Pages are allocated now, not while the locks are held.
+    void* snapshot = mmap(nullptr, sizeof(shared_data_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (snapshot == MAP_FAILED) {
+        throw std::runtime_error("Cannot map shared memory snapshot " + path + ": " + std::strerror(errno));
+    }
+
+    for (const auto& [name, lock] : locks_) {
+        lock->startReading();
+    }
+    std::memcpy(snapshot, static_cast<const void*>(data_), sizeof(shared_data_t));
+    for (auto it = locks_.rbegin(); it != locks_.rend(); ++it) {
+        it->second->finishReading();
+    }
+
+    munmap(snapshot, sizeof(shared_data_t));
+}
+
+void SharedMemory::load(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open shared memory snapshot " + path + ": " + std::strerror(errno));
+    }
+    struct stat snapshot_stat;
+    if (fstat(fd, &snapshot_stat) < 0 || static_cast<std::size_t>(snapshot_stat.st_size) != sizeof(shared_data_t)) {
+        close(fd);
+        throw std::runtime_error("Shared memory snapshot size does not match shared_data_t: " + path);
+    }
+    void* mapping = mmap(nullptr, sizeof(shared_data_t), PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map shared memory snapshot " + path + ": " + std::strerror(errno));
+    }
+    const shared_data_t* snapshot = static_cast<const shared_data_t*>(mapping);
+    if (snapshot->header.magic != SHARED_DATA_MAGIC || snapshot->header.version != SHARED_DATA_VERSION) {
+        munmap(mapping, sizeof(shared_data_t));
+        throw std::runtime_error("Shared memory snapshot layout does not match shared_data_t: " + path);
+    }
+
+    std::vector<std::uint32_t> sequences;
+    forEachSeqlock(*data_, [&](seqlock_t& lock) {
+        sequences.push_back(lock.sequence.load(std::memory_order_relaxed));
+    });
+
+    for (const auto& [name, lock] : locks_) {
+        lock->startWriting();
+    }
+    std::size_t offset = snapshotDataOffset(*data_);
+    std::memcpy(
+        reinterpret_cast<char*>(data_) + offset,
+        reinterpret_cast<const char*>(snapshot) + offset,
+        sizeof(shared_data_t) - offset
+    );
+    // Counters of the snapshot are replaced by even values following the live ones.
+    std::size_t index = 0;
+    forEachSeqlock(*data_, [&](seqlock_t& lock) {
+        lock.sequence.store((sequences[index++] + 2) & ~1u, std::memory_order_release);
+    });
+    for (auto it = locks_.rbegin(); it != locks_.rend(); ++it) {
+        it->second->finishWriting();
+    }
+    for (const auto& [name, lock] : locks_) {
+        lock->postUpdate();
+    }
+
+    munmap(mapping, sizeof(shared_data_t));
+}
+
+std::uint64_t SharedMemory::getGeneration(LockName lock) const {
+    return data_->generations[static_cast<std::size_t>(lock)].value.load(std::memory_order_acquire);
+}
+
+models::pose_t SharedMemory::readPoseCurrent(std::size_t n) const {
+    return pose_current_buffer_->read_pose(n);
+}
+
+models::pose_t SharedMemory::readPoseCurrentAt(std::uint64_t timestamp) const {
+    models::Pose interpolated = pose_current_buffer_->at_time(timestamp);
+    return { interpolated.x(), interpolated.y(), interpolated.angle() };
+}
+
+lidar_scan_header_t& SharedMemory::getLidarScanHeader(const lidar_data_t& slot)
+{
+    std::ptrdiff_t index = &slot - data_->lidar_data.slots;
+    if (index < 0 || index >= static_cast<std::ptrdiff_t>(TRIPLE_BUFFER_SLOTS)) {
+        throw std::out_of_range("Lidar data is not a slot of the shared lidar_data triple buffer");
+    }
+    return data_->lidar_scan_headers[index];
+}
+
+std::uint32_t& SharedMemory::getLidarCoordsCount(const lidar_coords_t& slot)
+{
+    std::ptrdiff_t index = &slot - data_->lidar_coords.slots;
+    if (index < 0 || index >= static_cast<std::ptrdiff_t>(TRIPLE_BUFFER_SLOTS)) {
+        throw std::out_of_range("Lidar coords is not a slot of the shared lidar_coords triple buffer");
+    }
+    return data_->lidar_coords_counts[index];
+}
+
+lidar_coords_hash_t& SharedMemory::getLidarCoordsHash(const lidar_coords_t& slot)
+{
+    std::ptrdiff_t index = &slot - data_->lidar_coords.slots;
+    if (index < 0 || index >= static_cast<std::ptrdiff_t>(TRIPLE_BUFFER_SLOTS)) {
+        throw std::out_of_range("Lidar coords is not a slot of the shared lidar_coords triple buffer");
+    }
+    return data_->lidar_coords_hashes[index];
+}
+
+std::size_t SharedMemory::readLidarScan(lidar_data_t& data, lidar_scan_header_t& header) const
+{
+    tripleBufferRead(data_->lidar_data, [&](const lidar_data_t& slot) {
+        const lidar_scan_header_t& slot_header = data_->lidar_scan_headers[&slot - data_->lidar_data.slots];
+        header.start_timestamp = slot_header.start_timestamp;
+        header.end_timestamp = slot_header.end_timestamp;
+        header.point_count = std::min<std::uint32_t>(slot_header.point_count, MAX_LIDAR_DATA_COUNT - 1);
+        header.source = slot_header.source;
+        std::memcpy(header.point_offsets, slot_header.point_offsets, header.point_count * sizeof(std::uint32_t));
+        std::memcpy(data, slot, header.point_count * sizeof(slot[0]));
+    });
+    return header.point_count;
+}
+
+std::size_t SharedMemory::readLidarCoords(lidar_coords_t& coords) const
+{
+    std::size_t count = 0;
+    tripleBufferRead(data_->lidar_coords, [&](const lidar_coords_t& slot) {
+        count = std::min<std::size_t>(data_->lidar_coords_counts[&slot - data_->lidar_coords.slots], MAX_LIDAR_DATA_COUNT - 1);
+        std::memcpy(coords, slot, count * sizeof(slot[0]));
+    });
+    return count;
+}
+
+bool SharedMemory::isLidarCoordsNearSegment(double ax, double ay, double bx, double by, double distance) const
+{
+    bool near = false;
+    tripleBufferRead(data_->lidar_coords, [&](const lidar_coords_t& slot) {
+        std::ptrdiff_t index = &slot - data_->lidar_coords.slots;
+        near = shared_memory::isLidarCoordsNearSegment(
+            slot, data_->lidar_coords_counts[index], data_->lidar_coords_hashes[index], ax, ay, bx, by, distance
+        );
+    });
+    return near;
+}
+
+void SharedMemory::clearLidarScans()
+{
+    for (std::size_t index = 0; index < TRIPLE_BUFFER_SLOTS; index++) {
+        data_->lidar_scan_headers[index].point_count = 0;
+        data_->lidar_scan_headers[index].source = 0;
+        data_->lidar_data.slots[index][0][0] = -1;
+        data_->lidar_coords_counts[index] = 0;
+        data_->lidar_coords_hashes[index].cell_size = 0;
+        data_->lidar_coords.slots[index][0][0] = -1;
+    }
+}
+
+std::uint64_t SharedMemory::publishLidarScan()
+{
+    tripleBufferPublish(data_->lidar_data);
+
+    // The driver is the only writer of the slot, it stays untouched until its next publication.
+    const lidar_data_t& slot = tripleBufferLatest(data_->lidar_data);
+    const lidar_scan_header_t& slot_header = getLidarScanHeader(slot);
+    std::uint32_t count = std::min<std::uint32_t>(slot_header.point_count, MAX_LIDAR_DATA_COUNT - 1);
+
+    lidar_scan_history_t& history = data_->lidar_scan_history;
+    std::uint64_t sequence = history.head.load(std::memory_order_relaxed) + 1;
+    lidar_scan_history_entry_t& entry = history.entries[sequence % LIDAR_SCAN_HISTORY_SIZE];
+    seqlockWrite(entry.seqlock, [&]() {
+        entry.sequence = sequence;
+        entry.header.start_timestamp = slot_header.start_timestamp;
+        entry.header.end_timestamp = slot_header.end_timestamp;
+        entry.header.point_count = count;
+        entry.header.source = slot_header.source;
+        std::memcpy(entry.header.point_offsets, slot_header.point_offsets, count * sizeof(std::uint32_t));
+        compactLidarPoints(slot, count, entry.points);
+    });
+    history.head.store(sequence, std::memory_order_release);
+
+    if (slot_header.end_timestamp != 0) {
+        stampLatency(LatencyStage::LidarData, {sequence, slot_header.end_timestamp});
+    }
+    return sequence;
+}
+
+std::uint64_t SharedMemory::writeLidarScan(
+    const double (*points)[3],
+    std::size_t count,
+    std::uint64_t start_timestamp,
+    std::uint64_t end_timestamp,
+    std::uint32_t source)
+{
+    if (count > MAX_LIDAR_DATA_COUNT - 1) {
+        throw std::invalid_argument("Too many lidar points, the maximum is " + std::to_string(MAX_LIDAR_DATA_COUNT - 1));
+    }
+
+    lidar_data_t& slot = tripleBufferBeginWrite(data_->lidar_data);
+    lidar_scan_header_t& header = getLidarScanHeader(slot);
+    header.start_timestamp = start_timestamp;
+    header.end_timestamp = end_timestamp;
+    header.point_count = static_cast<std::uint32_t>(count);
+    header.source = source;
+    std::memset(header.point_offsets, 0, count * sizeof(std::uint32_t));
+    std::memcpy(slot, points, count * sizeof(slot[0]));
+
+    // Mark as end of data
+    slot[count][0] = -1.0;
+    slot[count][1] = -1.0;
+    slot[count][2] = -1.0;
+
+    return publishLidarScan();
+}
+
+void SharedMemory::stampLatency(LatencyStage stage, const latency_frame_t& frame, std::uint64_t timestamp)
+{
+    if (frame.sequence == 0 || frame.capture_timestamp == 0) {
+        return;
+    }
+    if (timestamp == 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        timestamp = static_cast<std::uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+    }
+    // Clocks of different lidars may run slightly ahead, such frames count as a zero latency.
+    std::uint64_t latency = timestamp > frame.capture_timestamp ? timestamp - frame.capture_timestamp : 0;
+
+    latency_histogram_t& histogram = data_->latency_histograms[static_cast<std::size_t>(stage)];
+    seqlockWrite(histogram.seqlock, [&]() {
+        histogram.last_frame = frame;
+        histogram.last_timestamp = timestamp;
+    });
+    histogram.buckets[latencyBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+    histogram.total.fetch_add(latency, std::memory_order_relaxed);
+    std::uint64_t max = histogram.max.load(std::memory_order_relaxed);
+    while (latency > max && !histogram.max.compare_exchange_weak(max, latency, std::memory_order_relaxed)) {
+    }
+}
+
+latency_frame_t SharedMemory::readLatencyFrame(LatencyStage stage) const
+{
+    const latency_histogram_t& histogram = data_->latency_histograms[static_cast<std::size_t>(stage)];
+    latency_frame_t frame;
+    seqlockRead(histogram.seqlock, [&]() {
+        frame = histogram.last_frame;
+    });
+    return frame;
+}
+
+latency_statistics_t SharedMemory::getLatencyStatistics(LatencyStage stage) const
+{
+    const latency_histogram_t& histogram = data_->latency_histograms[static_cast<std::size_t>(stage)];
+    latency_statistics_t stats{};
+    stats.last_sequence = readLatencyFrame(stage).sequence;
+    stats.max = histogram.max.load(std::memory_order_relaxed);
+    std::uint64_t total = histogram.total.load(std::memory_order_relaxed);
+
+    // Percentiles are computed from the buckets copy, so they are consistent with its count.
+    std::uint64_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+    for (std::size_t bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS; bucket++) {
+        buckets[bucket] = histogram.buckets[bucket].load(std::memory_order_relaxed);
+        stats.count += buckets[bucket];
+    }
+    if (stats.count == 0) {
+        return stats;
+    }
+    stats.mean = double(total) / stats.count;
+
+    auto percentile = [&](double ratio) {
+        std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(ratio * stats.count));
+        std::uint64_t cumulated = 0;
+        for (std::size_t bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS; bucket++) {
+            cumulated += buckets[bucket];
+            if (cumulated >= rank) {
+                return std::min(latencyBucketLowerBound(bucket + 1), stats.max);
+            }
+        }
+        return stats.max;
+    };
+    stats.p50 = percentile(0.50);
+    stats.p99 = percentile(0.99);
+    return stats;
+}
+
+void SharedMemory::resetLatencyStatistics()
+{
+    for (latency_histogram_t& histogram : data_->latency_histograms) {
+        for (std::atomic<std::uint64_t>& bucket : histogram.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        histogram.total.store(0, std::memory_order_relaxed);
+        histogram.max.store(0, std::memory_order_relaxed);
+    }
+}
+
+void SharedMemory::beginObstaclesWrite()
+{
+    std::uint32_t staging = 1 - publishedObstacles();
+    seqlock_t& lock = data_->planner_obstacles.seqlocks[staging];
+    std::uint32_t sequence = lock.sequence.load(std::memory_order_relaxed);
+    // A write started without being published is restarted.
+    if (!(sequence & 1)) {
+        lock.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    data_->planner_obstacles.copies[staging].circles.count = 0;
+    data_->planner_obstacles.copies[staging].rectangles.count = 0;
+}
+
+void SharedMemory::publishObstacles()
+{
+    std::uint32_t staging = 1 - publishedObstacles();
+    seqlock_t& lock = data_->planner_obstacles.seqlocks[staging];
+    std::uint32_t sequence = lock.sequence.load(std::memory_order_relaxed);
+    if (!(sequence & 1)) {
+        throw std::runtime_error("Planner obstacles published without beginObstaclesWrite().");
+    }
+    lock.sequence.store(sequence + 1, std::memory_order_release);
+    data_->planner_obstacles.current.store(staging, std::memory_order_release);
+    data_->generations[static_cast<std::size_t>(LockName::Obstacles)].value.fetch_add(1, std::memory_order_release);
+}
+
+lidar_driver_health_t& SharedMemory::getLidarDriverHealth(std::uint32_t source)
+{
+    if (source >= LIDAR_SOURCES_MAX) {
+        throw std::invalid_argument("Lidar source must be below " + std::to_string(LIDAR_SOURCES_MAX));
+    }
+    return data_->lidar_driver_health[source];
+}
+
+lidar_driver_health_statistics_t SharedMemory::getLidarDriverHealthStatistics(std::uint32_t source) const
+{
+    if (source >= LIDAR_SOURCES_MAX) {
+        throw std::invalid_argument("Lidar source must be below " + std::to_string(LIDAR_SOURCES_MAX));
+    }
+    return readLidarDriverHealth(data_->lidar_driver_health[source]);
+}
+
+void SharedMemory::resetLidarDriverHealth()
+{
+    for (lidar_driver_health_t& health : data_->lidar_driver_health) {
+        health.bytes_read.store(0, std::memory_order_relaxed);
+        health.packets_ok.store(0, std::memory_order_relaxed);
+        health.packets_bad.store(0, std::memory_order_relaxed);
+        health.read_timeouts.store(0, std::memory_order_relaxed);
+        health.revolutions_assembled.store(0, std::memory_order_relaxed);
+        health.revolutions_dropped.store(0, std::memory_order_relaxed);
+        health.max_packet_gap.store(0, std::memory_order_relaxed);
+    }
+}
+
+template <typename Copy>
+bool SharedMemory::readLidarScanHistoryEntry(std::uint64_t sequence, lidar_scan_header_t& header, Copy&& copy) const
+{
+    if (sequence == 0) {
+        return false;
+    }
+    const lidar_scan_history_entry_t& entry = data_->lidar_scan_history.entries[sequence % LIDAR_SCAN_HISTORY_SIZE];
+    bool found = false;
+    seqlockRead(entry.seqlock, [&]() {
+        found = entry.sequence == sequence;
+        if (!found) {
+            return;
+        }
+        header.start_timestamp = entry.header.start_timestamp;
+        header.end_timestamp = entry.header.end_timestamp;
+        header.point_count = std::min<std::uint32_t>(entry.header.point_count, MAX_LIDAR_DATA_COUNT - 1);
+        header.source = entry.header.source;
+        std::memcpy(header.point_offsets, entry.header.point_offsets, header.point_count * sizeof(std::uint32_t));
+        copy(entry.points, header.point_count);
+    });
+    return found;
+}
+
+bool SharedMemory::readLidarScanHistory(std::uint64_t sequence, lidar_data_t& data, lidar_scan_header_t& header) const
+{
+    return readLidarScanHistoryEntry(sequence, header, [&](const lidar_compact_points_t& points, std::size_t count) {
+        expandLidarPoints(points, count, data);
+    });
+}
+
+bool SharedMemory::readLidarScanHistory(
+    std::uint64_t sequence,
+    lidar_compact_points_t& points,
+    lidar_scan_header_t& header) const
+{
+    return readLidarScanHistoryEntry(sequence, header, [&](const lidar_compact_points_t& entry_points, std::size_t count) {
+        std::memcpy(points.angles, entry_points.angles, count * sizeof(points.angles[0]));
+        std::memcpy(points.distances, entry_points.distances, count * sizeof(points.distances[0]));
+        std::memcpy(points.intensities, entry_points.intensities, count * sizeof(points.intensities[0]));
+    });
+}
+
+void SharedMemory::readOccupancyGrid(occupancy_grid_t& grid) const
+{
+    seqlockRead(data_->occupancy_grid_seqlock, [&]() {
+        grid.header = data_->occupancy_grid.header;
+        std::size_t cell_count = std::min<std::size_t>(
+            static_cast<std::size_t>(grid.header.width) * grid.header.height, OCCUPANCY_GRID_MAX_CELLS
+        );
+        std::memcpy(grid.cells, data_->occupancy_grid.cells, cell_count);
+    });
+}
+
+void SharedMemory::writeOccupancyGrid(const occupancy_grid_t& grid)
+{
+    seqlockWrite(data_->occupancy_grid_seqlock, [&]() {
+        data_->occupancy_grid.header = grid.header;
+        std::memcpy(data_->occupancy_grid.cells, grid.cells, static_cast<std::size_t>(grid.header.width) * grid.header.height);
+    });
+}
+
+bool SharedMemory::isPointOccupied(double x, double y) const
+{
+    bool occupied = false;
+    seqlockRead(data_->occupancy_grid_seqlock, [&]() {
+        const occupancy_grid_t& grid = data_->occupancy_grid;
+        occupied = false;
+        if (grid.header.width == 0 || grid.header.height == 0) {
+            return;
+        }
+        double cell_x = std::floor((x - grid.header.origin_x) / grid.header.resolution);
+        double cell_y = std::floor((y - grid.header.origin_y) / grid.header.resolution);
+        if (cell_x < 0 || cell_y < 0 || cell_x >= grid.header.width || cell_y >= grid.header.height) {
+            return;
+        }
+        std::size_t index = static_cast<std::size_t>(cell_y) * grid.header.width + static_cast<std::size_t>(cell_x);
+        occupied = index < OCCUPANCY_GRID_MAX_CELLS && grid.cells[index] > OCCUPANCY_GRID_OCCUPIED;
+    });
+    return occupied;
+}
+
+void SharedMemory::pushPoseCurrent(float x, float y, float angle) {
+    pose_current_buffer_->push(x, y, angle);
+    data_->generations[static_cast<std::size_t>(LockName::PoseCurrent)].value.fetch_add(1, std::memory_order_release);
+}
+
+void SharedMemory::pushPoseCurrent(float x, float y, float angle, std::uint64_t timestamp) {
+    pose_current_buffer_->push(x, y, angle, timestamp);
+    data_->generations[static_cast<std::size_t>(LockName::PoseCurrent)].value.fetch_add(1, std::memory_order_release);
+}
+
+void SharedMemory::readPoseCurrentSince(
+    std::uint64_t timestamp,
+    std::vector<models::pose_t>& poses,
+    std::vector<std::uint64_t>& timestamps) const
+{
+    pose_current_buffer_->read([&](std::uint64_t write_index) {
+        poses.clear();
+        timestamps.clear();
+        const models::pose_buffer_t& buffer = data_->pose_current_buffer;
+        // Walk back from the most recent pose to the first one not newer than the timestamp.
+        std::size_t count = 0;
+        std::size_t size = models::PoseBuffer::readableCount(write_index);
+        while (count < size) {
+            if (buffer.timestamps[(write_index - 1 - count) % models::POSE_BUFFER_SIZE_MAX] <= timestamp) {
+                break;
+            }
+            count++;
+        }
+        for (std::size_t n = count; n > 0; n--) {
+            std::size_t index = (write_index - n) % models::POSE_BUFFER_SIZE_MAX;
+            poses.push_back(buffer.poses[index]);
+            timestamps.push_back(buffer.timestamps[index]);
+        }
+        // The walk read the timestamp of the pose before the first newer one.
+        return write_index - std::min(size, count + 1);
+    });
+}
+
+models::pose_t SharedMemory::readPoseOrder() const {
+    models::pose_t pose_order;
+    seqlockRead(data_->pose_order_seqlock, [&]() {
+        pose_order = data_->pose_order;
+    });
+    return pose_order;
+}
+
+void SharedMemory::writePoseOrder(const models::pose_t& pose_order) {
+    seqlockWrite(data_->pose_order_seqlock, [&]() {
+        data_->pose_order = pose_order;
+    });
+    data_->generations[static_cast<std::size_t>(LockName::PoseOrder)].value.fetch_add(1, std::memory_order_release);
+}
+
+std::uint64_t SharedMemory::commitAvoidancePath(std::size_t first_changed_index, bool new_path) {
+    avoidance_path_version_t& version = data_->avoidance_path_version;
+    if (new_path || first_changed_index == 0) {
+        version.path_id++;
+    }
+    version.first_changed_index = static_cast<std::uint32_t>(first_changed_index);
+    version.commit.fetch_add(1, std::memory_order_release);
+    return version.path_id;
+}
+
+shared_properties_t SharedMemory::readProperties() const {
+    shared_properties_t properties;
+    seqlockRead(data_->properties_seqlock, [&]() {
+        properties = data_->properties;
+    });
+    return properties;
+}
+
+void SharedMemory::writeProperties(const shared_properties_t& properties) {
+    seqlockWrite(data_->properties_seqlock, [&]() {
+        data_->properties = properties;
+    });
+}
+
 } // namespace shared_memory
 
 } // namespace cogip
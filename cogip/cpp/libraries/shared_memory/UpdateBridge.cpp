@@ -0,0 +1,143 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "shared_memory/UpdateBridge.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <stdexcept>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+
+#ifndef SYS_futex_waitv
+#define SYS_futex_waitv 449
+#endif
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// Waiter of futex_waitv(), same layout as struct futex_waitv of kernel headers 5.16+.
+struct futex_waiter_t {
+    std::uint64_t val;       ///< Expected value.
+    std::uint64_t uaddr;     ///< Address of the futex.
+    std::uint32_t flags;     ///< Futex flags.
+    std::uint32_t reserved;  ///< Must be 0.
+};
+
+/// futex_waitv() flag of 32-bit futexes.
+constexpr std::uint32_t FUTEX_WAITER_SIZE_U32 = 0x02;
+
+/// Polling period of the counters when futex_waitv() is not available (ns).
+constexpr long UPDATE_BRIDGE_POLL_PERIOD_NS = 1000000;
+
+UpdateBridge& UpdateBridge::instance()
+{
+    static UpdateBridge bridge;
+    return bridge;
+}
+
+UpdateBridge::UpdateBridge():
+    control_(0),
+    stop_(false)
+{
+}
+
+UpdateBridge::~UpdateBridge()
+{
+    stop_.store(true, std::memory_order_release);
+    wakeUp();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (const watch_t& watch : watches_) {
+        close(watch.fd);
+    }
+}
+
+int UpdateBridge::watch(std::atomic<std::uint32_t>& counter)
+{
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create eventfd for update notifications");
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (watches_.size() >= UPDATE_BRIDGE_WATCHES_MAX) {
+            close(fd);
+            throw std::runtime_error("Too many update counters watched by the process");
+        }
+        // Only updates posted from now on are signaled.
+        watches_.push_back({&counter, counter.load(std::memory_order_acquire), fd});
+        if (!thread_.joinable()) {
+            thread_ = std::thread(&UpdateBridge::run, this);
+        }
+    }
+    wakeUp();
+    return fd;
+}
+
+void UpdateBridge::unwatch(int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(watches_.begin(), watches_.end(), [fd](const watch_t& watch) { return watch.fd == fd; });
+        if (it == watches_.end()) {
+            return;
+        }
+        watches_.erase(it);
+        close(fd);
+    }
+    wakeUp();
+}
+
+void UpdateBridge::wakeUp()
+{
+    control_.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, &control_, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void UpdateBridge::run()
+{
+    bool waitv_supported = true;
+    std::vector<futex_waiter_t> waiters;
+    while (!stop_.load(std::memory_order_acquire)) {
+        std::uint32_t control = control_.load(std::memory_order_acquire);
+        waiters.clear();
+        waiters.push_back({control, reinterpret_cast<std::uintptr_t>(&control_), FUTEX_WAITER_SIZE_U32, 0});
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (watch_t& watch : watches_) {
+                std::uint32_t value = watch.counter->load(std::memory_order_acquire);
+                if (value != watch.signaled) {
+                    watch.signaled = value;
+                    std::uint64_t one = 1;
+                    // Cannot fail: the eventfd counter would need 2^64 - 1 unread signals to overflow.
+                    (void)!write(watch.fd, &one, sizeof(one));
+                }
+                waiters.push_back({value, reinterpret_cast<std::uintptr_t>(watch.counter), FUTEX_WAITER_SIZE_U32, 0});
+            }
+        }
+
+        if (waitv_supported) {
+            // Returns immediately if a counter already differs from the value it was signaled with.
+            long result = syscall(SYS_futex_waitv, waiters.data(), waiters.size(), 0, nullptr, CLOCK_MONOTONIC);
+            if (result < 0 && errno != EAGAIN && errno != EINTR) {
+                waitv_supported = false;
+            }
+        }
+        else {
+            struct timespec period = {0, UPDATE_BRIDGE_POLL_PERIOD_NS};
+            syscall(SYS_futex, &control_, FUTEX_WAIT, control, &period, nullptr, 0);
+        }
+    }
+}
+
+} // namespace shared_memory
+
+} // namespace cogip
@@ -3,6 +3,7 @@
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
 #include "shared_memory/WritePriorityLock.hpp"
+#include "shared_memory/UpdateBridge.hpp"
 
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -11,34 +12,48 @@
 #include <stdexcept>
 #include <iostream>
 #include <time.h>
-#include <signal.h>
-#include <errno.h>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
 namespace cogip {
 
 namespace shared_memory {
 
-WritePriorityLock::WritePriorityLock(const std::string& name, bool owner):
+/// State word layout, see lock_state_t.
+constexpr std::uint32_t READER_MASK = 0x0000ffff;      ///< Active readers.
+constexpr std::uint32_t WRITER_PENDING = 0x00010000;   ///< One pending writer.
+constexpr std::uint32_t WRITER_PENDING_MASK = 0x3fff0000; ///< Pending writers.
+constexpr std::uint32_t WAITERS = 0x40000000;          ///< Some process may be blocked on the word.
+constexpr std::uint32_t WRITER = 0x80000000;           ///< A writer holds the lock.
+
+/// Current CLOCK_MONOTONIC time in nanoseconds.
+static std::uint64_t now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<std::uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/// Adds a duration to a total and updates the maximum.
+static void record_duration(std::atomic<std::uint64_t>& total, std::atomic<std::uint64_t>& max, std::uint64_t duration) {
+    total.fetch_add(duration, std::memory_order_relaxed);
+    std::uint64_t current = max.load(std::memory_order_relaxed);
+    while (duration > current && !max.compare_exchange_weak(current, duration, std::memory_order_relaxed)) {
+    }
+}
+
+WritePriorityLock::WritePriorityLock(const std::string& name, bool owner, std::atomic<std::uint64_t>* generation):
     owner_(owner),
     registered_consumer_(false),
     name_(name),
-    mutex_name_("/" + name_ + "_mutex"),
-    write_lock_name_("/" + name_ + "_write_lock"),
-    update_name_("/" + name_ + "_update"),
-    registration_name_("/" + name_ + "_registration"),
-    reader_count_shm_name_("/" + name_ + "_reader_count"),
-    write_request_shm_name_("/" + name_ + "_write_request"),
-    consumer_count_shm_name_("/" + name_ + "_consumer_count"),
-    sem_mutex_(nullptr),
-    sem_write_lock_(nullptr),
-    my_update_sem_(nullptr),
-    sem_register_(nullptr),
-    reader_shm_fd_(-1),
-    write_request_shm_fd_(-1),
-    consumer_count_shm_fd_(-1),
-    reader_count_(nullptr),
-    write_request_count_(nullptr),
-    consumer_pids_(nullptr),
+    state_shm_name_("/" + name_ + "_state"),
+    state_shm_fd_(-1),
+    state_(nullptr),
+    seen_generation_(0),
+    last_missed_updates_(0),
+    generation_(generation),
+    read_start_(0),
+    update_fd_(-1),
     debug_(false)
 {
     int shm_flags = O_RDWR;
@@ -48,337 +63,328 @@ WritePriorityLock::WritePriorityLock(const std::string& name, bool owner):
 
     umask(0000); // Allow full permissions (rw-rw-rw-)
 
-    // Open or create the mutex semaphore
-    if (owner) {
-        sem_mutex_ = sem_open(mutex_name_.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0666, 1);
-    }
-    else {
-        sem_mutex_ = sem_open(mutex_name_.c_str(), O_RDWR);
-    }
-    if (sem_mutex_ == SEM_FAILED) {
-        throw std::runtime_error("Failed to open mutex semaphore");
+    // Shared memory for lock state
+    state_shm_fd_ = shm_open(state_shm_name_.c_str(), shm_flags, 0666);
+    if (state_shm_fd_ < 0) {
+        throw std::runtime_error("Failed to open shared memory for lock state");
     }
-
-    // Open or create the write lock semaphore
-    if (owner) {
-        sem_write_lock_ = sem_open(write_lock_name_.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0666, 1);
+    if (owner_) {
+        if (ftruncate(state_shm_fd_, sizeof(lock_state_t)) < 0) {
+            throw std::runtime_error("Failed to truncate shared memory for lock state");
+        }
     }
-    else {
-        sem_write_lock_ = sem_open(write_lock_name_.c_str(), O_RDWR);
+    state_ = static_cast<lock_state_t*>(mmap(NULL, sizeof(lock_state_t), PROT_READ | PROT_WRITE, MAP_SHARED, state_shm_fd_, 0));
+    if (state_ == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shared memory for lock state");
     }
-    if (sem_write_lock_ == SEM_FAILED) {
-        throw std::runtime_error("Failed to open write lock semaphore");
+    if (owner_) {
+        state_->update_generation.store(0);
+        reset();
+        resetStatistics();
     }
 
-    // Open or create the register semaphore
-    if (owner) {
-        sem_register_ = sem_open(registration_name_.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0666, 1);
-    }
-    else {
-        sem_register_ = sem_open(registration_name_.c_str(), O_RDWR);
-    }
-    if (sem_register_ == SEM_FAILED) {
-        throw std::runtime_error("Failed to open registration semaphore");
-    }
+}
 
-    // Shared memory for reader count
-    reader_shm_fd_ = shm_open(reader_count_shm_name_.c_str(), shm_flags, 0666);
-    if (reader_shm_fd_ < 0) {
-        throw std::runtime_error("Failed to open shared memory for reader count");
-    }
+WritePriorityLock::WritePriorityLock(
+    const std::string& name,
+    lock_state_t& state,
+    bool owner,
+    std::atomic<std::uint64_t>* generation
+):
+    owner_(owner),
+    registered_consumer_(false),
+    name_(name),
+    state_shm_fd_(-1),
+    state_(&state),
+    seen_generation_(0),
+    last_missed_updates_(0),
+    generation_(generation),
+    read_start_(0),
+    update_fd_(-1),
+    debug_(false)
+{
     if (owner_) {
-        if (ftruncate(reader_shm_fd_, sizeof(int)) < 0) {
-            throw std::runtime_error("Failed to truncate shared memory for reader count");
-        }
-    }
-    reader_count_ = static_cast<int*>(mmap(NULL, sizeof(int), PROT_READ | PROT_WRITE, MAP_SHARED, reader_shm_fd_, 0));
-    if (reader_count_ == MAP_FAILED) {
-        throw std::runtime_error("Failed to map shared memory for reader count");
+        state_->update_generation.store(0);
+        reset();
+        resetStatistics();
     }
+}
 
-    // Shared memory for write request count
-    write_request_shm_fd_ = shm_open(write_request_shm_name_.c_str(), shm_flags, 0666);
-    if (write_request_shm_fd_ < 0) {
-        throw std::runtime_error("Failed to open shared memory for write request count");
-    }
-    if (owner_) {
-        if (ftruncate(write_request_shm_fd_, sizeof(int)) < 0) {
-            throw std::runtime_error("Failed to truncate shared memory for write request count");
-        }
+WritePriorityLock::~WritePriorityLock() {
+    if (update_fd_ >= 0) {
+        UpdateBridge::instance().unwatch(update_fd_);
     }
-    write_request_count_ = static_cast<int*>(mmap(NULL, sizeof(int), PROT_READ | PROT_WRITE, MAP_SHARED, write_request_shm_fd_, 0));
-    if (write_request_count_ == MAP_FAILED) {
-        throw std::runtime_error("Failed to map shared memory for write request count");
+    if (state_shm_fd_ == -1) {
+        // Embedded state, released with the segment containing it.
+        return;
     }
-    // Shared memory for consumer count
-    consumer_count_shm_fd_ = shm_open(consumer_count_shm_name_.c_str(), shm_flags, 0666);
-    if (consumer_count_shm_fd_ < 0) {
-        throw std::runtime_error("Failed to open shared memory for consumer count");
+    if (state_ != nullptr) {
+        munmap(state_, sizeof(lock_state_t));
     }
+    close(state_shm_fd_);
     if (owner_) {
-        if (ftruncate(consumer_count_shm_fd_, MAX_CONSUMERS * sizeof(pid_t)) < 0) {
-            throw std::runtime_error("Failed to truncate shared memory for consumer count");
-        }
-    }
-    consumer_pids_ = static_cast<pid_t*>(mmap(NULL, MAX_CONSUMERS * sizeof(pid_t), PROT_READ | PROT_WRITE, MAP_SHARED, consumer_count_shm_fd_, 0));
-    if (consumer_pids_ == MAP_FAILED) {
-        throw std::runtime_error("Failed to map shared memory for consumer count");
-    }
-    if (owner_) {
-        reset();
+        shm_unlink(state_shm_name_.c_str());
     }
+}
 
+void WritePriorityLock::waitState(std::uint32_t expected) {
+    // The word lives in memory shared between processes, so the futex cannot be private.
+    syscall(SYS_futex, &state_->word, FUTEX_WAIT, expected, nullptr, nullptr, 0);
 }
 
-WritePriorityLock::~WritePriorityLock() {
-    if (registered_consumer_) {
-        sem_wait(sem_register_);
-        pid_t current_pid = getpid();
-        for (int i = 0; i < MAX_CONSUMERS; ++i) {
-            if (consumer_pids_[i] == current_pid) {
-                consumer_pids_[i] = 0;
+void WritePriorityLock::wakeState() {
+    syscall(SYS_futex, &state_->word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void WritePriorityLock::startReading() {
+    if (debug_) std::cout << name_ << " startReading: enter (state=" << std::hex << state_->word.load() << std::dec << ")" << std::endl;
+    lock_counters_t& counters = state_->counters;
+    std::uint64_t wait_start = 0;
+    std::uint32_t state = state_->word.load(std::memory_order_relaxed);
+    while (true) {
+        if ((state & (WRITER | WRITER_PENDING_MASK)) == 0) {
+            // No writer active nor pending: register as reader
+            if (state_->word.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
                 break;
             }
+            continue;
         }
-        sem_post(sem_register_);
-
-        if (my_update_sem_ != nullptr) {
-            sem_close(my_update_sem_);
-            sem_unlink(my_update_sem_name_.c_str());
+        // Wait for writers to finish, flagging that someone must be woken up
+        if (wait_start == 0) {
+            wait_start = now_ns();
         }
-    }
-
-    // Close cached semaphores
-    for (auto& pair : update_sems_cache_) {
-        if (pair.second != nullptr) {
-            sem_close(pair.second);
+        if (!(state & WAITERS) &&
+            !state_->word.compare_exchange_weak(state, state | WAITERS, std::memory_order_relaxed)) {
+            continue;
         }
+        waitState(state | WAITERS);
+        state = state_->word.load(std::memory_order_relaxed);
     }
-    update_sems_cache_.clear();
-
-    if (consumer_pids_ != nullptr) {
-        munmap(consumer_pids_, MAX_CONSUMERS * sizeof(pid_t));
-    }
-    if (write_request_count_ != nullptr) {
-        munmap(write_request_count_, sizeof(int));
-    }
-    if (reader_count_ != nullptr) {
-        munmap(reader_count_, sizeof(int));
-    }
-    if (consumer_count_shm_fd_ != -1) {
-        close(consumer_count_shm_fd_);
-    }
-    if (write_request_shm_fd_ != -1) {
-        close(write_request_shm_fd_);
+    read_start_ = now_ns();
+    counters.read_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (wait_start != 0) {
+        record_duration(counters.read_wait_total, counters.read_wait_max, read_start_ - wait_start);
     }
-    if (reader_shm_fd_ != -1) {
-        close(reader_shm_fd_);
-    }
-    if (sem_register_ != nullptr) {
-        sem_close(sem_register_);
-    }
-    if (sem_write_lock_ != nullptr) {
-        sem_close(sem_write_lock_);
-    }
-    if (sem_mutex_) {
-        sem_close(sem_mutex_);
-    }
-    if (owner_) {
-        sem_unlink(registration_name_.c_str());
-        sem_unlink(mutex_name_.c_str());
-        sem_unlink(write_lock_name_.c_str());
-        shm_unlink(reader_count_shm_name_.c_str());
-        shm_unlink(write_request_shm_name_.c_str());
-        shm_unlink(consumer_count_shm_name_.c_str());
-    }
-}
-
-void WritePriorityLock::startReading() {
-    if (debug_) std::cout << name_ << " startReading: enter, lock sem_mutex_ (write_request_count_=" << *write_request_count_ << ")" << std::endl;
-    sem_wait(sem_mutex_);
-    while (*write_request_count_ > 0) {  // Wait if there are pending writers
-        sem_post(sem_mutex_);
-        usleep(100);  // Small delay to avoid busy waiting
-        sem_wait(sem_mutex_);
-    }
-    (*reader_count_)++;
-    if (*reader_count_ == 1) {
-        if (debug_) std::cout << name_ << " startReading: lock sem_write_lock_ (reader_count_=" << *reader_count_ << ")" << std::endl;
-        sem_wait(sem_write_lock_);  // First reader locks the writer
-    }
-    if (debug_) std::cout << name_ << " startReading: unlock sem_mutex_" << std::endl;
-    sem_post(sem_mutex_);
     if (debug_) std::cout << name_ << " startReading: end" << std::endl;
 }
 
 void WritePriorityLock::finishReading() {
-    if (debug_) std::cout << name_ << " finishReading: enter (reader_count_=" << *reader_count_ << ")" << std::endl;
-    sem_wait(sem_mutex_);
-    (*reader_count_)--;
-    if (*reader_count_ == 0) {
-        if (debug_) std::cout << name_ << " finishReading: unlock sem_write_lock_" << std::endl;
-        sem_post(sem_write_lock_);  // Last reader unlocks the writer
+    if (debug_) std::cout << name_ << " finishReading: enter (state=" << std::hex << state_->word.load() << std::dec << ")" << std::endl;
+    lock_counters_t& counters = state_->counters;
+    record_duration(counters.read_hold_total, counters.read_hold_max, now_ns() - read_start_);
+    std::uint32_t previous = state_->word.fetch_sub(1, std::memory_order_release);
+    if ((previous & READER_MASK) == 1 && (previous & WAITERS)) {
+        // Last reader: wake up pending writers
+        state_->word.fetch_and(~WAITERS, std::memory_order_relaxed);
+        wakeState();
     }
-    if (debug_) std::cout << name_ << " finishReading: unlock sem_mutex_" << std::endl;
-    sem_post(sem_mutex_);
     if (debug_) std::cout << name_ << " finishReading: end" << std::endl;
 }
 
 void WritePriorityLock::startWriting() {
-    if (debug_) std::cout << name_ << " startWriting: enter, lock sem_mutex_ (write_request_count_=" << *write_request_count_ << ")" << std::endl;
-    sem_wait(sem_mutex_);
-    (*write_request_count_)++;
-    if (debug_) std::cout << name_ << " startWriting: unlock sem_mutex_" << std::endl;
-    sem_post(sem_mutex_);
-    if (debug_) std::cout << name_ << " startWriting: lock sem_write_lock_" << std::endl;
-    sem_wait(sem_write_lock_);  // Wait for exclusive write access
+    if (debug_) std::cout << name_ << " startWriting: enter (state=" << std::hex << state_->word.load() << std::dec << ")" << std::endl;
+    lock_counters_t& counters = state_->counters;
+    std::uint64_t wait_start = 0;
+    // Pending writers block new readers
+    std::uint32_t state = state_->word.fetch_add(WRITER_PENDING, std::memory_order_relaxed) + WRITER_PENDING;
+    while (true) {
+        if ((state & (WRITER | READER_MASK)) == 0) {
+            // No reader nor writer active: take the lock
+            std::uint32_t locked = (state - WRITER_PENDING) | WRITER;
+            if (state_->word.compare_exchange_weak(state, locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+        // Wait for active readers or writer to finish, flagging that someone must be woken up
+        if (wait_start == 0) {
+            wait_start = now_ns();
+        }
+        if (!(state & WAITERS) &&
+            !state_->word.compare_exchange_weak(state, state | WAITERS, std::memory_order_relaxed)) {
+            continue;
+        }
+        waitState(state | WAITERS);
+        state = state_->word.load(std::memory_order_relaxed);
+    }
+    std::uint64_t write_start = now_ns();
+    counters.write_start.store(write_start, std::memory_order_relaxed);
+    counters.write_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (wait_start != 0) {
+        std::uint64_t wait = write_start - wait_start;
+        record_duration(counters.write_wait_total, counters.write_wait_max, wait);
+        if (wait >= WRITER_STARVATION_NS) {
+            counters.writer_starvations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
     if (debug_) std::cout << name_ << " startWriting: end" << std::endl;
 }
 
 void WritePriorityLock::finishWriting() {
-    if (debug_) std::cout << name_ << " finishWriting: enter, lock sem_mutex_ (write_request_count_=" << *write_request_count_ << ")" << std::endl;
-    sem_wait(sem_mutex_);
-    (*write_request_count_)--;
-    if (debug_) std::cout << name_ << " finishWriting: unlock sem_mutex_" << *write_request_count_ << std::endl;
-    sem_post(sem_mutex_);
-    if (debug_) std::cout << name_ << " finishWriting: unlock sem_write_lock_" << std::endl;
-    sem_post(sem_write_lock_);  // Release exclusive write access
+    if (debug_) std::cout << name_ << " finishWriting: enter (state=" << std::hex << state_->word.load() << std::dec << ")" << std::endl;
+    lock_counters_t& counters = state_->counters;
+    record_duration(
+        counters.write_hold_total, counters.write_hold_max,
+        now_ns() - counters.write_start.load(std::memory_order_relaxed)
+    );
+    if (generation_ != nullptr) {
+        generation_->fetch_add(1, std::memory_order_release);
+    }
+    std::uint32_t previous = state_->word.fetch_and(~(WRITER | WAITERS), std::memory_order_release);
+    if (previous & WAITERS) {
+        // Wake up pending writers and readers, pending writers go first
+        wakeState();
+    }
     if (debug_) std::cout << name_ << " finishWriting: end" << std::endl;
 }
 
-void WritePriorityLock::registerConsumer() {
-    sem_wait(sem_register_);
-    pid_t current_pid = getpid();
-    int empty_slot = -1;
-
-    for (int i = 0; i < MAX_CONSUMERS; ++i) {
-        pid_t pid = consumer_pids_[i];
-        if (pid != 0) {
-            // Check if process still exists
-            if (kill(pid, 0) == -1 && errno == ESRCH) {
-                // Process is dead, clean up
-                consumer_pids_[i] = 0;
-                std::string dead_sem_name = "/" + name_ + "_update_" + std::to_string(pid);
-                sem_unlink(dead_sem_name.c_str());
-                if (empty_slot == -1) empty_slot = i;
-            } else if (pid == current_pid) {
-                // Already registered
-                empty_slot = i;
-            }
-        } else if (empty_slot == -1) {
-            empty_slot = i;
-        }
-    }
-
-    if (empty_slot != -1) {
-        consumer_pids_[empty_slot] = current_pid;
-    } else {
-        sem_post(sem_register_);
-        throw std::runtime_error("Maximum number of consumers reached");
-    }
-    sem_post(sem_register_);
-
-    my_update_sem_name_ = "/" + name_ + "_update_" + std::to_string(current_pid);
-    my_update_sem_ = sem_open(my_update_sem_name_.c_str(), O_CREAT, 0666, 0);
-    if (my_update_sem_ == SEM_FAILED) {
-        throw std::runtime_error("Failed to open specific update semaphore");
+std::uint64_t WritePriorityLock::generation() const {
+    if (generation_ == nullptr) {
+        return 0;
     }
+    return generation_->load(std::memory_order_acquire);
+}
 
+void WritePriorityLock::registerConsumer() {
+    seen_generation_ = state_->update_generation.load(std::memory_order_acquire);
     registered_consumer_ = true;
 }
 
 void WritePriorityLock::postUpdate() {
-    if (debug_) {
-        std::cout << name_ << " postUpdate: start" << std::endl;
-    }
-
-    for (int i = 0; i < MAX_CONSUMERS; ++i) {
-        pid_t pid = consumer_pids_[i];
-        if (pid != 0) {
-            sem_t* target_sem = nullptr;
-            auto it = update_sems_cache_.find(pid);
-            if (it != update_sems_cache_.end()) {
-                target_sem = it->second;
-            } else {
-                std::string target_sem_name = "/" + name_ + "_update_" + std::to_string(pid);
-                target_sem = sem_open(target_sem_name.c_str(), O_RDWR);
-                if (target_sem != SEM_FAILED) {
-                    update_sems_cache_[pid] = target_sem;
-                } else {
-                    target_sem = nullptr; // could be unlinked or not created yet
-                }
-            }
-
-            if (target_sem != nullptr) {
-                sem_post(target_sem);
-                if (debug_) {
-                    int value;
-                    sem_getvalue(target_sem, &value);
-                    std::cout << name_ << " postUpdate: pid=" << pid << " sem_update_=" << value << std::endl;
-                }
-            }
-        }
-    }
-
-    if (debug_) {
-        std::cout << name_ << " postUpdate: end" << std::endl;
-    }
+    if (debug_) std::cout << name_ << " postUpdate: start" << std::endl;
+    std::uint32_t generation = state_->update_generation.fetch_add(1, std::memory_order_release) + 1;
+    syscall(SYS_futex, &state_->update_generation, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    if (debug_) std::cout << name_ << " postUpdate: end (generation=" << generation << ")" << std::endl;
 }
 
 bool WritePriorityLock::waitUpdate(double timeout_seconds) {
-    if (my_update_sem_ == nullptr) {
+    if (!registered_consumer_) {
         throw std::runtime_error("waitUpdate called but consumer is not registered");
     }
 
     if (debug_) {
-        int value;
-        sem_getvalue(my_update_sem_, &value);
-        std::cout << name_ << " waitUpdate: pid=" << getpid() << " sem_update_=" << value << std::endl;
+        std::cout << name_ << " waitUpdate: pid=" << getpid() << " seen=" << seen_generation_
+                  << " generation=" << state_->update_generation.load() << std::endl;
     }
 
-    if (timeout_seconds < 0) {
-        sem_wait(my_update_sem_);
-        if (debug_) std::cout << name_ << " waitUpdate: end" << std::endl;
-        return true;
-    } else {
-        struct timespec ts;
-        if (clock_gettime(CLOCK_REALTIME, &ts) == -1) {
-            return false;
-        }
-
+    struct timespec deadline;
+    if (timeout_seconds >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
         long seconds = (long)timeout_seconds;
         long nanoseconds = (long)((timeout_seconds - seconds) * 1e9);
+        deadline.tv_sec += seconds;
+        deadline.tv_nsec += nanoseconds;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
 
-        ts.tv_sec += seconds;
-        ts.tv_nsec += nanoseconds;
-        if (ts.tv_nsec >= 1000000000) {
-            ts.tv_sec += 1;
-            ts.tv_nsec -= 1000000000;
+    while (true) {
+        std::uint32_t generation = state_->update_generation.load(std::memory_order_acquire);
+        if (consumeUpdate(generation)) {
+            if (debug_) std::cout << name_ << " waitUpdate: end" << std::endl;
+            return true;
         }
 
-        if (sem_timedwait(my_update_sem_, &ts) == -1) {
-            return false;
+        struct timespec timeout;
+        struct timespec* timeout_ptr = nullptr;
+        if (timeout_seconds >= 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            timeout.tv_sec = deadline.tv_sec - now.tv_sec;
+            timeout.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+            if (timeout.tv_nsec < 0) {
+                timeout.tv_sec -= 1;
+                timeout.tv_nsec += 1000000000;
+            }
+            if (timeout.tv_sec < 0) {
+                return false;
+            }
+            timeout_ptr = &timeout;
         }
-        if (debug_) std::cout << name_ << " waitUpdate: end" << std::endl;
-        return true;
+
+        // The futex only sleeps if no update was posted since the generation was loaded.
+        // FUTEX_WAIT timeouts are relative and measured against CLOCK_MONOTONIC.
+        syscall(SYS_futex, &state_->update_generation, FUTEX_WAIT, generation, timeout_ptr, nullptr, 0);
+    }
+}
+
+bool WritePriorityLock::consumeUpdate(std::uint32_t generation) {
+    if (generation == seen_generation_) {
+        return false;
+    }
+    last_missed_updates_ = generation - seen_generation_ - 1;
+    if (last_missed_updates_ > 0) {
+        state_->counters.missed_updates.fetch_add(last_missed_updates_, std::memory_order_relaxed);
     }
+    seen_generation_ = generation;
+    return true;
+}
+
+int WritePriorityLock::updateFd() {
+    if (!registered_consumer_) {
+        throw std::runtime_error("updateFd called but consumer is not registered");
+    }
+    if (update_fd_ < 0) {
+        update_fd_ = UpdateBridge::instance().watch(state_->update_generation);
+    }
+    return update_fd_;
+}
+
+bool WritePriorityLock::pollUpdate() {
+    if (!registered_consumer_) {
+        throw std::runtime_error("pollUpdate called but consumer is not registered");
+    }
+    if (update_fd_ >= 0) {
+        // Clear the readiness before reading the generation, so a later update signals the descriptor again.
+        std::uint64_t signals;
+        (void)!read(update_fd_, &signals, sizeof(signals));
+    }
+    return consumeUpdate(state_->update_generation.load(std::memory_order_acquire));
 }
 
 void WritePriorityLock::reset() {
     if (debug_) std::cout << name_ << " reset: enter" << std::endl;
-    *reader_count_ = 0;
-    *write_request_count_ = 0;
+    state_->word.store(0);
     registered_consumer_ = false;
-    for (int i = 0; i < MAX_CONSUMERS; ++i) {
-        consumer_pids_[i] = 0;
-    }
-
-    sem_init(sem_mutex_, 1, 1);
-    sem_init(sem_write_lock_, 1, 1);
-    sem_init(sem_register_, 1, 1);
     if (debug_) std::cout << name_ << " reset: end" << std::endl;
 }
 
+lock_statistics_t WritePriorityLock::getStatistics() const {
+    const lock_counters_t& counters = state_->counters;
+    lock_statistics_t stats;
+    stats.read_acquisitions = counters.read_acquisitions.load(std::memory_order_relaxed);
+    stats.write_acquisitions = counters.write_acquisitions.load(std::memory_order_relaxed);
+    stats.read_wait_total = counters.read_wait_total.load(std::memory_order_relaxed);
+    stats.read_wait_max = counters.read_wait_max.load(std::memory_order_relaxed);
+    stats.write_wait_total = counters.write_wait_total.load(std::memory_order_relaxed);
+    stats.write_wait_max = counters.write_wait_max.load(std::memory_order_relaxed);
+    stats.read_hold_total = counters.read_hold_total.load(std::memory_order_relaxed);
+    stats.read_hold_max = counters.read_hold_max.load(std::memory_order_relaxed);
+    stats.write_hold_total = counters.write_hold_total.load(std::memory_order_relaxed);
+    stats.write_hold_max = counters.write_hold_max.load(std::memory_order_relaxed);
+    stats.writer_starvations = counters.writer_starvations.load(std::memory_order_relaxed);
+    stats.missed_updates = counters.missed_updates.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WritePriorityLock::resetStatistics() {
+    lock_counters_t& counters = state_->counters;
+    counters.read_acquisitions.store(0, std::memory_order_relaxed);
+    counters.write_acquisitions.store(0, std::memory_order_relaxed);
+    counters.read_wait_total.store(0, std::memory_order_relaxed);
+    counters.read_wait_max.store(0, std::memory_order_relaxed);
+    counters.write_wait_total.store(0, std::memory_order_relaxed);
+    counters.write_wait_max.store(0, std::memory_order_relaxed);
+    counters.read_hold_total.store(0, std::memory_order_relaxed);
+    counters.read_hold_max.store(0, std::memory_order_relaxed);
+    counters.write_hold_total.store(0, std::memory_order_relaxed);
+    counters.write_hold_max.store(0, std::memory_order_relaxed);
+    counters.writer_starvations.store(0, std::memory_order_relaxed);
+    counters.missed_updates.store(0, std::memory_order_relaxed);
+}
+
 } // namespace shared_memory
 
 } // namespace cogip
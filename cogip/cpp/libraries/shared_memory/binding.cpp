@@ -2,14 +2,20 @@
 // This file is subject to the terms and conditions of the GNU Lesser
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
+#include "shared_memory/GlobalSharedMemory.hpp"
+#include "shared_memory/LidarScanHistoryReader.hpp"
 #include "shared_memory/SharedMemory.hpp"
 
 #include <nanobind/nanobind.h>
 #include <nanobind/ndarray.h>
 #include <nanobind/stl/map.h>
+#include <nanobind/stl/pair.h>
 #include <nanobind/stl/string.h>
 #include <nanobind/stl/unique_ptr.h>
+#include <nanobind/stl/vector.h>
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 namespace nb = nanobind;
@@ -19,13 +25,71 @@ namespace cogip {
 
 namespace shared_memory {
 
+namespace {
+
+/// Wraps points copied in a heap array in a numpy array of one row per point, owning the copy.
+template <std::size_t Columns>
+nb::ndarray<double, nb::numpy, nb::shape<-1, Columns>> pointsToNumpy(double (*points)[Columns], std::size_t count)
+{
+    nb::capsule owner(points, [](void *p) noexcept { delete[] static_cast<double (*)[Columns]>(p); });
+    return nb::ndarray<double, nb::numpy, nb::shape<-1, Columns>>((void *)points, { count, Columns }, owner);
+}
+
+/// Wraps elements copied in a heap vector in a numpy array of a structured dtype, owning the copy.
+template <typename T>
+nb::object elementsToNumpy(std::vector<T>* elems, nb::handle dtype)
+{
+    nb::capsule owner(elems, [](void *p) noexcept { delete static_cast<std::vector<T> *>(p); });
+    nb::ndarray<std::uint8_t, nb::numpy, nb::ndim<2>> bytes(elems->data(), { elems->size(), sizeof(T) }, owner);
+    return bytes.cast().attr("view")(dtype).attr("reshape")(-1);
+}
+
+/// Reads a scan of the history in a numpy array of one row per point.
+/// @param read Function reading the scan in the given data and header, returning false if there is no scan.
+/// @returns A tuple of the points and the timing header, or None.
+template <typename Read>
+nb::object readHistoryScan(Read&& read)
+{
+    auto *copy = new double[MAX_LIDAR_DATA_COUNT][3];
+    lidar_scan_header_t header;
+    if (!read(*reinterpret_cast<lidar_data_t *>(copy), header)) {
+        delete[] copy;
+        return nb::none();
+    }
+    return nb::make_tuple(pointsToNumpy(copy, header.point_count), header);
+}
+
+/// Reads a scan of the history in its compact format, in one numpy array per field.
+/// @param read Function reading the scan in the given points and header, returning false if there is no scan.
+/// @returns A tuple of the angles, distances, intensities and timing header, or None.
+template <typename Read>
+nb::object readCompactHistoryScan(Read&& read)
+{
+    auto *points = new lidar_compact_points_t;
+    lidar_scan_header_t header;
+    if (!read(*points, header)) {
+        delete points;
+        return nb::none();
+    }
+    nb::capsule owner(points, [](void *p) noexcept { delete static_cast<lidar_compact_points_t *>(p); });
+    std::size_t count = header.point_count;
+    return nb::make_tuple(
+        nb::ndarray<std::uint16_t, nb::numpy, nb::shape<-1>>(points->angles, { count }, owner),
+        nb::ndarray<std::uint16_t, nb::numpy, nb::shape<-1>>(points->distances, { count }, owner),
+        nb::ndarray<std::uint8_t, nb::numpy, nb::shape<-1>>(points->intensities, { count }, owner),
+        header
+    );
+}
+
+} // namespace
+
 NB_MODULE(shared_memory, m) {
     auto models_module = nb::module_::import_("cogip.cpp.libraries.models");
     auto obstacles_module = nb::module_::import_("cogip.cpp.libraries.obstacles");
 
     nb::class_<shared_data_t>(m, "SharedData")
         .def(nb::init<>())
-        .def_rw("pose_current_buffer", &shared_data_t::pose_current_buffer)
+        .def_ro("pose_current_buffer", &shared_data_t::pose_current_buffer)
         .def_rw("pose_order", &shared_data_t::pose_order)
         .def("__repr__", [](const shared_data_t &s) {
             std::ostringstream oss;
@@ -47,6 +111,138 @@ NB_MODULE(shared_memory, m) {
         .value("SimCameraData", LockName::SimCameraData)
     ;
 
+    nb::class_<lock_statistics_t>(m, "LockStatistics")
+        .def_ro("read_acquisitions", &lock_statistics_t::read_acquisitions, "Number of read locks taken")
+        .def_ro("write_acquisitions", &lock_statistics_t::write_acquisitions, "Number of write locks taken")
+        .def_ro("read_wait_total", &lock_statistics_t::read_wait_total, "Total time spent waiting for read locks (ns)")
+        .def_ro("read_wait_max", &lock_statistics_t::read_wait_max, "Longest wait for a read lock (ns)")
+        .def_ro("write_wait_total", &lock_statistics_t::write_wait_total, "Total time spent waiting for write locks (ns)")
+        .def_ro("write_wait_max", &lock_statistics_t::write_wait_max, "Longest wait for a write lock (ns)")
+        .def_ro("read_hold_total", &lock_statistics_t::read_hold_total, "Total time read locks were held (ns)")
+        .def_ro("read_hold_max", &lock_statistics_t::read_hold_max, "Longest time a read lock was held (ns)")
+        .def_ro("write_hold_total", &lock_statistics_t::write_hold_total, "Total time write locks were held (ns)")
+        .def_ro("write_hold_max", &lock_statistics_t::write_hold_max, "Longest time a write lock was held (ns)")
+        .def_ro("writer_starvations", &lock_statistics_t::writer_starvations, "Number of writers which waited longer than 10 ms")
+        .def_ro("missed_updates", &lock_statistics_t::missed_updates, "Number of updates coalesced because consumers were late")
+        .def("__repr__", [](const lock_statistics_t& stats) {
+            std::ostringstream oss;
+            oss << stats;
+            return oss.str();
+        })
+    ;
+
+    nb::enum_<LatencyStage>(m, "LatencyStage")
+        .value("LidarData", LatencyStage::LidarData)
+        .value("LidarCoords", LatencyStage::LidarCoords)
+        .value("DetectorObstacles", LatencyStage::DetectorObstacles)
+        .value("AvoidancePath", LatencyStage::AvoidancePath)
+    ;
+
+    nb::class_<latency_frame_t>(m, "LatencyFrame")
+        .def(nb::init<>())
+        .def_rw("sequence", &latency_frame_t::sequence, "Sequence number of the scan in the lidar scan history, 0 if none")
+        .def_rw("capture_timestamp", &latency_frame_t::capture_timestamp,
+                "CLOCK_MONOTONIC time of the end of the scan (ns), 0 if unknown")
+    ;
+
+    nb::class_<latency_statistics_t>(m, "LatencyStatistics")
+        .def_ro("count", &latency_statistics_t::count, "Number of stamped frames")
+        .def_ro("last_sequence", &latency_statistics_t::last_sequence, "Sequence number of the last stamped frame")
+        .def_ro("mean", &latency_statistics_t::mean, "Mean latency from the capture (ns)")
+        .def_ro("p50", &latency_statistics_t::p50, "Median latency from the capture (ns)")
+        .def_ro("p99", &latency_statistics_t::p99, "99th percentile latency from the capture (ns)")
+        .def_ro("max", &latency_statistics_t::max, "Longest latency from the capture (ns)")
+        .def("__repr__", [](const latency_statistics_t& stats) {
+            std::ostringstream oss;
+            oss << stats;
+            return oss.str();
+        })
+    ;
+
+    nb::class_<lidar_driver_health_statistics_t>(m, "LidarDriverHealth")
+        .def_ro("bytes_read", &lidar_driver_health_statistics_t::bytes_read, "Bytes read from the serial port")
+        .def_ro("packets_ok", &lidar_driver_health_statistics_t::packets_ok, "Packets with a valid checksum")
+        .def_ro("packets_bad", &lidar_driver_health_statistics_t::packets_bad, "Packets dropped because of a checksum error")
+        .def_ro("read_timeouts", &lidar_driver_health_statistics_t::read_timeouts,
+                "Reads which timed out before a complete packet was received")
+        .def_ro("revolutions_assembled", &lidar_driver_health_statistics_t::revolutions_assembled, "Revolutions published")
+        .def_ro("revolutions_dropped", &lidar_driver_health_statistics_t::revolutions_dropped,
+                "Revolutions dropped incomplete or never consumed")
+        .def_ro("spin_hz", &lidar_driver_health_statistics_t::spin_hz, "Measured spin frequency of the last revolution (Hz), 0 if unknown")
+        .def_ro("points_per_revolution", &lidar_driver_health_statistics_t::points_per_revolution,
+                "Points decoded in the last revolution, before filtering")
+        .def_ro("max_packet_gap", &lidar_driver_health_statistics_t::max_packet_gap, "Longest time between two valid packets (ns)")
+        .def_ro("last_timestamp", &lidar_driver_health_statistics_t::last_timestamp,
+                "CLOCK_MONOTONIC time of the last published revolution (ns), 0 if none")
+        .def("__repr__", [](const lidar_driver_health_statistics_t& stats) {
+            std::ostringstream oss;
+            oss << stats;
+            return oss.str();
+        })
+    ;
+
+    nb::class_<lidar_scan_header_t>(m, "LidarScanHeader")
+        .def_ro("start_timestamp", &lidar_scan_header_t::start_timestamp,
+                "CLOCK_MONOTONIC time of the first point of the scan revolution (ns), 0 if unknown")
+        .def_ro("end_timestamp", &lidar_scan_header_t::end_timestamp,
+                "CLOCK_MONOTONIC time of the last point of the scan revolution (ns), 0 if unknown")
+        .def_ro("point_count", &lidar_scan_header_t::point_count, "Number of points of the scan")
+        .def_ro("source", &lidar_scan_header_t::source, "Index of the lidar of the robot which measured the scan")
+        .def_prop_ro(
+            "point_offsets",
+            [](const lidar_scan_header_t& header) {
+                std::size_t count = std::min<std::size_t>(header.point_count, MAX_LIDAR_DATA_COUNT);
+                auto *copy = new std::uint32_t[count];
+                std::memcpy(copy, header.point_offsets, count * sizeof(std::uint32_t));
+                nb::capsule owner(copy, [](void *p) noexcept { delete[] static_cast<std::uint32_t *>(p); });
+                return nb::ndarray<std::uint32_t, nb::numpy, nb::shape<-1>>(copy, { count }, owner);
+            },
+            "Copy of the time of each point relative to start_timestamp (ns)"
+        )
+    ;
+
+    nb::class_<avoidance_path_version_t>(m, "AvoidancePathVersion")
+        .def_ro("path_id", &avoidance_path_version_t::path_id,
+                "Identifier of the path, changed when the robot must restart toward the first pose")
+        .def_ro("first_changed_index", &avoidance_path_version_t::first_changed_index,
+                "Index of the first pose written by the last commit")
+        .def_prop_ro(
+            "commit",
+            [](const avoidance_path_version_t& version) { return version.commit.load(std::memory_order_acquire); },
+            "Number of commits of the avoidance path"
+        )
+    ;
+
+    nb::class_<occupancy_grid_header_t>(m, "OccupancyGridHeader")
+        .def_ro("origin_x", &occupancy_grid_header_t::origin_x, "X coordinate of the corner of the first cell (mm)")
+        .def_ro("origin_y", &occupancy_grid_header_t::origin_y, "Y coordinate of the corner of the first cell (mm)")
+        .def_ro("resolution", &occupancy_grid_header_t::resolution, "Size of a cell (mm)")
+        .def_ro("width", &occupancy_grid_header_t::width, "Number of cells along X, 0 if the grid is disabled")
+        .def_ro("height", &occupancy_grid_header_t::height, "Number of cells along Y, 0 if the grid is disabled")
+        .def_ro("timestamp", &occupancy_grid_header_t::timestamp,
+                "CLOCK_MONOTONIC time of the last scan integrated in the grid (ns), 0 if unknown")
+    ;
+
+    nb::enum_<SimCameraFormat>(m, "SimCameraFormat")
+        .value("RGBA", SimCameraFormat::RGBA)
+        .value("RGB", SimCameraFormat::RGB)
+        .value("YUV420", SimCameraFormat::YUV420)
+    ;
+
+    nb::class_<sim_camera_frame_header_t>(m, "SimCameraFrameHeader")
+        .def_ro("sequence", &sim_camera_frame_header_t::sequence, "Number of the frame, starting at 1")
+        .def_ro("timestamp", &sim_camera_frame_header_t::timestamp, "CLOCK_MONOTONIC capture time of the frame (ns)")
+        .def_ro("format", &sim_camera_frame_header_t::format, "Pixel format of the frame")
+    ;
+
+    m.attr("SIM_CAMERA_WIDTH") = SIM_CAMERA_WIDTH;
+    m.attr("SIM_CAMERA_HEIGHT") = SIM_CAMERA_HEIGHT;
+    m.attr("OCCUPANCY_GRID_OCCUPIED") = OCCUPANCY_GRID_OCCUPIED;
+    m.attr("LIDAR_SCAN_HISTORY_SIZE") = LIDAR_SCAN_HISTORY_SIZE;
+    m.attr("LIDAR_SOURCES_MAX") = LIDAR_SOURCES_MAX;
+    m.attr("LIDAR_COMPACT_ANGLE_UNIT") = LIDAR_COMPACT_ANGLE_UNIT;
+    m.attr("LIDAR_COMPACT_DISTANCE_UNIT") = LIDAR_COMPACT_DISTANCE_UNIT;
+
     nb::class_<WritePriorityLock>(m, "WritePriorityLock")
         .def(nb::init<const std::string&, bool>(), "name"_a, "owner"_a = false,
              "Initialize a WritePriorityLock with a unique semaphore name and ownership flag.")
@@ -58,14 +254,27 @@ NB_MODULE(shared_memory, m) {
              "Acquire a write lock, blocking all readers and writers.")
         .def("finish_writing", &WritePriorityLock::finishWriting,
              "Release the write lock.")
+        .def_prop_ro("generation", &WritePriorityLock::generation,
+             "Number of writes of the protected data, 0 if the lock has no generation counter.")
         .def("register_consumer", &WritePriorityLock::registerConsumer,
              "Register the the lock will be used to wait the update signal to read updated data.")
         .def("post_update", &WritePriorityLock::postUpdate,
              "Signal to registered consumers that data was updated.")
         .def("wait_update", &WritePriorityLock::waitUpdate, "timeout_seconds"_a = -1.0, nb::call_guard<nb::gil_scoped_release>(),
              "Wait for the updated signal meaning that data was updated.")
+        .def("update_fd", &WritePriorityLock::updateFd,
+             "File descriptor readable when updates were posted, to watch with an asyncio loop or select/poll. "
+             "Once readable, call poll_update() to consume the updates.")
+        .def("poll_update", &WritePriorityLock::pollUpdate,
+             "Check without blocking if updates were posted since the last call.")
+        .def("last_missed_updates", &WritePriorityLock::lastMissedUpdates,
+             "Number of updates coalesced by the last successful wait_update() call.")
         .def("reset", &WritePriorityLock::reset,
-             "Reset counters and semaphores.")
+             "Reset the lock state.")
+        .def("get_statistics", &WritePriorityLock::getStatistics,
+             "Get a snapshot of the lock statistics, accumulated by all processes since the last reset.")
+        .def("reset_statistics", &WritePriorityLock::resetStatistics,
+             "Reset the lock statistics of all processes.")
         .def("set_debug", &WritePriorityLock::setDebug, "debug"_a,
              "Set/unset debug mode.")
      ;
@@ -87,6 +296,7 @@ NB_MODULE(shared_memory, m) {
         .def_rw("start_position", &shared_properties_t::start_position, "Start position ID")
         .def_rw("avoidance_strategy", &shared_properties_t::avoidance_strategy, "Avoidance strategy ID")
         .def_rw("goap_depth", &shared_properties_t::goap_depth, "Depth of the GOAP search tree, 0 to disable GOAP")
+        .def_rw("footprint_avoidance", &shared_properties_t::footprint_avoidance, "Robot footprint avoidance flag")
         .def("__repr__", [](const shared_properties_t& properties) {
            std::ostringstream oss;
            oss << properties;
@@ -95,14 +305,46 @@ NB_MODULE(shared_memory, m) {
      ;
 
     nb::class_<SharedMemory>(m, "SharedMemory")
-        .def(nb::init<const std::string&, bool>(), "name"_a, "owner"_a = false,
-             "Initialize a SharedMemory with a unique name and ownership flag.")
+        .def(nb::init<const std::string&, bool, bool>(), "name"_a, "owner"_a = false, "prefault"_a = false,
+             "Initialize a SharedMemory with a unique name and ownership flag, "
+             "optionally prefaulting the segment and locking its hot regions in RAM.")
+        .def_static(
+            "create_in_process",
+            [](const std::string& name, bool prefault) {
+                return std::make_unique<SharedMemory>(name, in_process, prefault);
+            },
+            "name"_a, "prefault"_a = false,
+            "Create a SharedMemory in anonymous memory private to the process, for bench, replay and simulation "
+            "pipelines running all stages in one process. Other processes cannot attach to it."
+        )
+        .def("is_in_process", &SharedMemory::isInProcess, "Whether the data is private to the process.")
         .def("get_lock", &SharedMemory::getLock, "lock"_a, nb::rv_policy::reference_internal,
              "Get a lock for a specific part of the shared memory.")
+        .def("get_generation", &SharedMemory::getGeneration, "lock"_a,
+             "Get the number of writes of a part of the shared memory, to skip work if it did not change.")
         .def("get_data", &SharedMemory::getData, nb::rv_policy::reference,
              "Get the shared data.")
+        .def("dump", &SharedMemory::dump, "path"_a, nb::call_guard<nb::gil_scoped_release>(),
+             "Save a consistent snapshot of the shared data in a file, taken while holding all read locks.")
+        .def("load", &SharedMemory::load, "path"_a, nb::call_guard<nb::gil_scoped_release>(),
+             "Load a snapshot saved by dump() in the shared data, holding all write locks, and post an update on each lock.\n"
+             "Producers should be stopped first.")
         .def("get_pose_current_buffer", &SharedMemory::getPoseCurrentBuffer, nb::rv_policy::reference_internal,
              "Get PoseBuffer object wrapping the shared memory pose_current_buffer structure.")
+        .def("read_pose_current", &SharedMemory::readPoseCurrent, "n"_a = 0,
+             "Read a copy of a current pose without taking the PoseCurrent lock, 0 being the last pushed pose.")
+        .def("read_pose_current_at", &SharedMemory::readPoseCurrentAt, "timestamp"_a,
+             "Read a copy of the current pose interpolated at a monotonic time (ns), see time.monotonic_ns().")
+        .def("push_pose_current", nb::overload_cast<float, float, float>(&SharedMemory::pushPoseCurrent),
+             "x"_a, "y"_a, "angle"_a,
+             "Push a current pose, readers using read_pose_current never delay this call.")
+        .def("push_pose_current", nb::overload_cast<float, float, float, std::uint64_t>(&SharedMemory::pushPoseCurrent),
+             "x"_a, "y"_a, "angle"_a, "timestamp"_a,
+             "Push a current pose with its monotonic time (ns), see time.monotonic_ns().")
+        .def("read_pose_order", &SharedMemory::readPoseOrder,
+             "Read a copy of the pose order without taking the PoseOrder lock.")
+        .def("write_pose_order", &SharedMemory::writePoseOrder, "pose_order"_a,
+             "Write the pose order, readers using read_pose_order never delay this call.")
         .def(
             "get_table_limits",
             [](SharedMemory &self) -> nb::ndarray<double, nb::numpy, nb::shape<4>> {
@@ -118,7 +360,9 @@ NB_MODULE(shared_memory, m) {
               return nb::ndarray<double, nb::numpy, nb::shape<MAX_LIDAR_DATA_COUNT, 3>>((void *)data);
           },
           nb::rv_policy::reference_internal,
-          "Get the lidar_data structure from shared memory ."
+          "Get the latest published slot of the lidar_data triple buffer from shared memory.\n"
+          "Only the point_count rows of the scan header are valid, use read_lidar_data() to get exactly the points\n"
+          "of the latest scan, and write_lidar_scan() to publish a scan."
         )
        .def(
           "get_lidar_coords",
@@ -127,18 +371,149 @@ NB_MODULE(shared_memory, m) {
                 return nb::ndarray<double, nb::numpy, nb::shape<MAX_LIDAR_DATA_COUNT, 2>>((void *)data);
           },
           nb::rv_policy::reference_internal,
-          "Get the lidar_coords structure from shared memory ."
+          "Get the latest published slot of the lidar_coords triple buffer from shared memory, terminated by an X of -1.\n"
+          "Use read_lidar_coords() to get exactly the points of the latest scan."
         )
+        .def(
+          "write_lidar_scan",
+          [](SharedMemory &self,
+             nb::ndarray<const double, nb::shape<-1, 3>, nb::c_contig, nb::device::cpu> points,
+             std::uint64_t start_timestamp,
+             std::uint64_t end_timestamp,
+             std::uint32_t source) {
+              return self.writeLidarScan(
+                  reinterpret_cast<const double (*)[3]>(points.data()), points.shape(0),
+                  start_timestamp, end_timestamp, source
+              );
+          },
+          "points"_a, "start_timestamp"_a = 0, "end_timestamp"_a = 0, "source"_a = 0,
+          "Write a lidar scan (one (angle, distance, intensity) row per point) to the next lidar_data slot,\n"
+          "set its header and publish it. Returns the sequence number of the scan in the history.\n"
+          "Post the LidarData update afterwards to wake up the consumers."
+        )
+        .def(
+          "read_lidar_data",
+          [](SharedMemory &self) {
+              auto *copy = new double[MAX_LIDAR_DATA_COUNT][3];
+              lidar_scan_header_t header;
+              std::size_t count = self.readLidarScan(*reinterpret_cast<lidar_data_t *>(copy), header);
+              return pointsToNumpy(copy, count);
+          },
+          "Get a copy of the points (one row per point) of the latest complete lidar scan, without taking the LidarData lock."
+        )
+        .def(
+          "read_lidar_scan",
+          [](SharedMemory &self) {
+              auto *copy = new double[MAX_LIDAR_DATA_COUNT][3];
+              lidar_scan_header_t header;
+              std::size_t count = self.readLidarScan(*reinterpret_cast<lidar_data_t *>(copy), header);
+              return std::make_pair(pointsToNumpy(copy, count), header);
+          },
+          "Get a copy of the points (one row per point) and timing header of the latest complete lidar scan,\n"
+          "without taking the LidarData lock."
+        )
+        .def(
+          "get_lidar_scan_history_head",
+          &SharedMemory::getLidarScanHistoryHead,
+          "Get the sequence number of the last scan of the lidar scan history, 0 if no scan was published."
+        )
+        .def(
+          "read_lidar_scan_history",
+          [](SharedMemory &self, std::uint64_t sequence) {
+              return readHistoryScan([&](lidar_data_t &data, lidar_scan_header_t &header) {
+                  return self.readLidarScanHistory(sequence, data, header);
+              });
+          },
+          "sequence"_a,
+          "Get a copy of the points (one row per point) and timing header of a scan of the lidar scan history,\n"
+          "or None if the scan is not published yet or was already overwritten."
+        )
+        .def(
+          "read_lidar_coords",
+          [](SharedMemory &self) {
+              auto *copy = new double[MAX_LIDAR_DATA_COUNT][2];
+              std::size_t count = self.readLidarCoords(*reinterpret_cast<lidar_coords_t *>(copy));
+              return pointsToNumpy(copy, count);
+          },
+          "Get a copy of the latest complete lidar points (one row per point) in table coordinates,\n"
+          "without taking the LidarCoords lock."
+        )
+        .def("is_lidar_coords_near_segment", &SharedMemory::isLidarCoordsNearSegment,
+             "ax"_a, "ay"_a, "bx"_a, "by"_a, "distance"_a,
+             "Whether a point of the latest lidar coords lies within a distance of the segment from A to B (mm),\n"
+             "without taking the LidarCoords lock.")
+        .def("clear_lidar_scans", &SharedMemory::clearLidarScans,
+             "Mark all lidar_data and lidar_coords slots as empty, before the drivers and the converter start.")
+        .def(
+          "read_occupancy_grid",
+          [](SharedMemory &self) {
+              auto *grid = new occupancy_grid_t;
+              self.readOccupancyGrid(*grid);
+              occupancy_grid_header_t header = grid->header;
+              nb::capsule owner(grid, [](void *p) noexcept { delete static_cast<occupancy_grid_t *>(p); });
+              return std::make_pair(
+                  nb::ndarray<std::int8_t, nb::numpy, nb::ndim<2>>(
+                      (void *)grid->cells, { header.height, header.width }, owner
+                  ),
+                  header
+              );
+          },
+          "Get a copy of the occupancy grid and its geometry, indexed by [y, x], in log-odds."
+        )
+        .def("is_point_occupied", &SharedMemory::isPointOccupied, "x"_a, "y"_a,
+             "Check whether a point is in an occupied cell of the occupancy grid.")
         .def("get_detector_obstacles", &SharedMemory::getDetectorObstacles, nb::rv_policy::reference_internal,
              "Get CircleList object wrapping the shared memory detector_obstacles structure.")
         .def("get_monitor_obstacles", &SharedMemory::getMonitorObstacles, nb::rv_policy::reference_internal,
              "Get CircleList object wrapping the shared memory monitor_obstacles structure.")
         .def("get_circle_obstacles", &SharedMemory::getCircleObstacles, nb::rv_policy::reference_internal,
-             "Get ObstacleCircleList object wrapping the shared memory circle_obstacles structure.")
+             "Get the CompactObstacleCircleList of the published planner circle obstacles, "
+             "untouched until the planner refills them after its next publication.")
         .def("get_rectangle_obstacles", &SharedMemory::getRectangleObstacles, nb::rv_policy::reference_internal,
-             "Get ObstacleRectangleList object wrapping the shared memory rectangle_obstacles structure.")
+             "Get the CompactObstacleRectangleList of the published planner rectangle obstacles, "
+             "untouched until the planner refills them after its next publication.")
+        .def("get_staging_circle_obstacles", &SharedMemory::getStagingCircleObstacles, nb::rv_policy::reference_internal,
+             "Get the CompactObstacleCircleList of the staging planner circle obstacles, "
+             "filled between begin_obstacles_write() and publish_obstacles().")
+        .def("get_staging_rectangle_obstacles", &SharedMemory::getStagingRectangleObstacles, nb::rv_policy::reference_internal,
+             "Get the CompactObstacleRectangleList of the staging planner rectangle obstacles, "
+             "filled between begin_obstacles_write() and publish_obstacles().")
+        .def("begin_obstacles_write", &SharedMemory::beginObstaclesWrite,
+             "Start filling the staging planner obstacle lists, which are emptied.")
+        .def("publish_obstacles", &SharedMemory::publishObstacles,
+             "Publish the staging planner obstacle lists in one store, then post an update on the Obstacles lock.")
+        .def(
+          "copy_obstacles",
+          [](const SharedMemory &self) {
+              using circle_t = obstacles::basic_obstacle_circle_t<models::COMPACT_COORDS_LIST_SIZE_MAX>;
+              using rectangle_t = obstacles::basic_obstacle_polygon_t<models::COMPACT_COORDS_LIST_SIZE_MAX>;
+              auto *circles = new std::vector<circle_t>();
+              auto *rectangles = new std::vector<rectangle_t>();
+              circles->reserve(obstacles::OBSTACLE_LIST_SIZE_MAX);
+              rectangles->reserve(obstacles::OBSTACLE_LIST_SIZE_MAX);
+              {
+                  nb::gil_scoped_release release;
+                  self.readObstacles([&](const planner_obstacles_t &lists) {
+                      const std::size_t circle_count = std::min(lists.circles.count, obstacles::OBSTACLE_LIST_SIZE_MAX);
+                      const std::size_t rectangle_count = std::min(lists.rectangles.count, obstacles::OBSTACLE_LIST_SIZE_MAX);
+                      circles->assign(lists.circles.elems, lists.circles.elems + circle_count);
+                      rectangles->assign(lists.rectangles.elems, lists.rectangles.elems + rectangle_count);
+                  });
+              }
+              return std::make_pair(
+                  elementsToNumpy(circles, nb::type<obstacles::CompactObstacleCircleList>().attr("dtype")),
+                  elementsToNumpy(rectangles, nb::type<obstacles::CompactObstacleRectangleList>().attr("dtype"))
+              );
+          },
+          "Get consistent copies of the published planner circle and rectangle obstacles, "
+          "as numpy arrays of the dtypes of CompactObstacleCircleList and CompactObstacleRectangleList."
+        )
         .def("get_properties", &SharedMemory::getProperties, nb::rv_policy::reference_internal,
              "Get the shared properties.")
+        .def("read_properties", &SharedMemory::readProperties,
+             "Read a consistent copy of the shared properties.")
+        .def("write_properties", &SharedMemory::writeProperties, "properties"_a,
+             "Write all shared properties at once, readers using read_properties never delay this call.")
         .def_prop_rw("avoidance_exiting", &SharedMemory::getAvoidanceExiting, &SharedMemory::setAvoidanceExiting,
              "Get or set the avoidance exiting flag.")
         .def_prop_rw("avoidance_has_new_pose_order", &SharedMemory::getAvoidanceHasNewPoseOrder, &SharedMemory::setAvoidanceHasNewPoseOrder,
@@ -151,16 +526,171 @@ NB_MODULE(shared_memory, m) {
              "Get PoseOrder object wrapping the shared memory avoidance_pose_order structure.")
         .def("get_avoidance_path", &SharedMemory::getAvoidancePath, nb::rv_policy::reference_internal,
              "Get PoseOrderList object wrapping the shared memory avoidance_path structure.")
-        .def("get_sim_camera_data",
-             [](SharedMemory &self) -> nb::ndarray<uint8_t, nb::numpy, nb::shape<SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH, 4>> {
-                 auto &data = self.getSimCameraData();
-                 return nb::ndarray<uint8_t, nb::numpy, nb::shape<SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH, 4>>((void *)data);
-             },
-             nb::rv_policy::reference_internal,
-             "Get the simulated camera data in RGBA format from shared memory ."
+        .def("get_avoidance_path_version", &SharedMemory::getAvoidancePathVersion, nb::rv_policy::reference_internal,
+             "Get the version of the avoidance path, to tell an extended path from a new one.")
+        .def("commit_avoidance_path", &SharedMemory::commitAvoidancePath, "first_changed_index"_a, "new_path"_a = false,
+             "Commit a change of the avoidance path from a pose index, while holding the AvoidancePath lock for writing.\n"
+             "The path gets a new id if its first pose changed or if new_path is set. Returns the id of the path.")
+        .def("stamp_latency", &SharedMemory::stampLatency, "stage"_a, "frame"_a, "timestamp"_a = 0,
+             "Stamp a frame at the end of a stage, adding its latency since its capture to the histogram of the stage.\n"
+             "The timestamp is a monotonic time (ns), see time.monotonic_ns(), 0 for the current time.")
+        .def("read_latency_frame", &SharedMemory::readLatencyFrame, "stage"_a,
+             "Read the last frame stamped by a stage, its sequence is 0 if the stage never stamped a frame.")
+        .def("get_latency_statistics", &SharedMemory::getLatencyStatistics, "stage"_a,
+             "Get the p50/p99/max latency from the capture to the end of a stage, accumulated by all processes.")
+        .def("reset_latency_statistics", &SharedMemory::resetLatencyStatistics,
+             "Reset the latency histograms of all stages.")
+        .def("get_lidar_driver_health", &SharedMemory::getLidarDriverHealthStatistics, "source"_a,
+             "Get a snapshot of the health counters of the driver of a lidar source.")
+        .def("reset_lidar_driver_health", &SharedMemory::resetLidarDriverHealth,
+             "Reset the health counters of the drivers of all lidar sources.")
+        .def("request_sim_camera_format", &SharedMemory::requestSimCameraFormat, "format"_a,
+             "Request the pixel format of the next simulated camera frames.")
+        .def("get_requested_sim_camera_format", &SharedMemory::getRequestedSimCameraFormat,
+             "Get the pixel format requested for the simulated camera frames.")
+        .def(
+          "publish_sim_camera_frame",
+          [](SharedMemory &self,
+             nb::ndarray<const std::uint8_t, nb::shape<SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH, 4>, nb::c_contig> rgba,
+             std::uint64_t timestamp) {
+              nb::gil_scoped_release release;
+              return self.publishSimCameraFrame(rgba.data(), timestamp);
+          },
+          "rgba"_a, "timestamp"_a,
+          "Convert an RGBA image to the requested pixel format and publish it as the latest simulated camera frame,\n"
+          "with its monotonic capture time (ns). Returns the sequence number of the frame."
         )
+        .def(
+          "get_sim_camera_frame",
+          [](SharedMemory &self) -> nb::object {
+              sim_camera_frame_header_t header;
+              const std::uint8_t *pixels = self.getSimCameraFrame(header);
+              if (!pixels) {
+                  return nb::none();
+              }
+              nb::handle owner = nb::find(self);
+              nb::object frame;
+              switch (header.format) {
+              case SimCameraFormat::RGB:
+                  frame = nb::cast(nb::ndarray<const std::uint8_t, nb::numpy, nb::ndim<3>>(
+                      pixels, { SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH, 3 }, owner
+                  ));
+                  break;
+              case SimCameraFormat::YUV420:
+                  frame = nb::cast(nb::ndarray<const std::uint8_t, nb::numpy, nb::ndim<2>>(
+                      pixels, { SIM_CAMERA_HEIGHT * 3 / 2, SIM_CAMERA_WIDTH }, owner
+                  ));
+                  break;
+              default:
+                  frame = nb::cast(nb::ndarray<const std::uint8_t, nb::numpy, nb::ndim<3>>(
+                      pixels, { SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH, 4 }, owner
+                  ));
+                  break;
+              }
+              return nb::make_tuple(frame, header);
+          },
+          "Get a read-only view of the latest simulated camera frame and its header, without copying it, or None.\n"
+          "The view has the (height, width, 3 or 4) shape of RGB and RGBA frames, or the (height * 3 / 2, width) shape\n"
+          "of YUV420 frames expected by cv2.COLOR_YUV2BGR_I420. It is only valid until two more frames are published,\n"
+          "check is_sim_camera_frame_valid() after using it."
+        )
+        .def("is_sim_camera_frame_valid", &SharedMemory::isSimCameraFrameValid, "header"_a,
+             "Check that a frame got from get_sim_camera_frame() was not overwritten.")
+    ;
+
+    nb::class_<LidarScanHistoryReader>(m, "LidarScanHistoryReader")
+        .def(nb::init<const SharedMemory&>(), "shared_memory"_a, nb::keep_alive<1, 2>(),
+             "Initialize a reader of the lidar scan history, starting after the last published scan.")
+        .def(
+          "read_next",
+          [](LidarScanHistoryReader &self) {
+              return readHistoryScan([&](lidar_data_t &data, lidar_scan_header_t &header) {
+                  return self.readNext(data, header);
+              });
+          },
+          "Get a copy of the points (one row per point) and timing header of the next scan not read yet,\n"
+          "or None if all published scans were already read."
+        )
+        .def(
+          "read_next_compact",
+          [](LidarScanHistoryReader &self) {
+              return readCompactHistoryScan([&](lidar_compact_points_t &points, lidar_scan_header_t &header) {
+                  return self.readNext(points, header);
+              });
+          },
+          "Get a copy of the next scan not read yet in the compact format of the history:\n"
+          "angles in LIDAR_COMPACT_ANGLE_UNIT, distances in LIDAR_COMPACT_DISTANCE_UNIT, intensities and timing header,\n"
+          "or None if all published scans were already read."
+        )
+        .def("skip_to_latest", &LidarScanHistoryReader::skipToLatest,
+             "Skip the scans not read yet.")
+        .def_prop_ro("pending_count", &LidarScanHistoryReader::pendingCount,
+             "Number of published scans not read yet, including those already overwritten.")
+        .def_prop_ro("last_sequence", &LidarScanHistoryReader::lastSequence,
+             "Sequence number of the last scan read, 0 if none.")
+        .def_prop_ro("dropped_count", &LidarScanHistoryReader::droppedCount,
+             "Number of scans overwritten before being read.")
+        .def("reset_dropped_count", &LidarScanHistoryReader::resetDroppedCount,
+             "Reset the number of dropped scans.")
     ;
 
+    nb::class_<global_robot_state_t>(m, "GlobalRobotState")
+        .def_ro("generation", &global_robot_state_t::generation, "Number of publications of the robot since its registration")
+        .def_ro("timestamp", &global_robot_state_t::timestamp, "CLOCK_MONOTONIC time of the pose (ns), 0 if unknown")
+        .def_ro("pose", &global_robot_state_t::pose, "Current pose of the robot")
+        .def_ro("obstacle_count", &global_robot_state_t::obstacle_count, "Number of obstacles detected by the robot")
+        .def_prop_ro(
+            "obstacles",
+            [](const global_robot_state_t& state) {
+                return std::vector<models::circle_t>(state.obstacles, state.obstacles + state.obstacle_count);
+            },
+            "Copy of the obstacles detected by the robot"
+        )
+    ;
+
+    m.attr("GLOBAL_SHARED_MEMORY_NAME") = GLOBAL_SHARED_MEMORY_NAME;
+    m.attr("GLOBAL_ROBOTS_MAX") = GLOBAL_ROBOTS_MAX;
+    m.attr("GLOBAL_ROBOT_OBSTACLES_MAX") = GLOBAL_ROBOT_OBSTACLES_MAX;
+
+    nb::class_<GlobalSharedMemory>(m, "GlobalSharedMemory")
+        .def(nb::init<const std::string&>(), "name"_a = GLOBAL_SHARED_MEMORY_NAME,
+             "Open the registry of the robots of the host, creating it if it does not exist.")
+        .def_static("unlink", &GlobalSharedMemory::unlink, "name"_a = GLOBAL_SHARED_MEMORY_NAME,
+             "Remove the registry, processes still attached keep their mapping.")
+        .def("register_robot", &GlobalSharedMemory::registerRobot, "robot_id"_a,
+             "Register a robot, or find its entry if it is already registered.")
+        .def("unregister_robot", &GlobalSharedMemory::unregisterRobot, "robot_id"_a,
+             "Unregister a robot, freeing its entry.")
+        .def("robots", &GlobalSharedMemory::robots,
+             "Get the identifiers of the registered robots.")
+        .def(
+          "publish_robot_state",
+          [](GlobalSharedMemory &self, std::uint32_t robot_id, const models::pose_t &pose, std::uint64_t timestamp,
+             const std::vector<models::circle_t> &obstacles) {
+              return self.publishRobotState(robot_id, pose, timestamp, obstacles.data(), obstacles.size());
+          },
+          "robot_id"_a, "pose"_a, "timestamp"_a, "obstacles"_a,
+          "Publish the pose, with its monotonic time (ns), and the obstacles of a registered robot.\n"
+          "Returns the generation of the published state."
+        )
+        .def("publish_robot", &GlobalSharedMemory::publishRobot, "robot_id"_a, "shared_memory"_a,
+             "Publish the current pose and the detector obstacles of a registered robot from its own shared memory.\n"
+             "Returns the generation of the published state.")
+        .def("get_generation", &GlobalSharedMemory::getGeneration, "robot_id"_a,
+             "Get the generation of the state of a robot, 0 if it is not registered or never published.")
+        .def(
+          "read_robot_state",
+          [](const GlobalSharedMemory &self, std::uint32_t robot_id) -> nb::object {
+              global_robot_state_t state;
+              if (!self.readRobotState(robot_id, state)) {
+                  return nb::none();
+              }
+              return nb::cast(state);
+          },
+          "robot_id"_a,
+          "Get a consistent copy of the state of a robot, or None if it is not registered."
+        )
+    ;
 }
 
 } // namespace shared_memory
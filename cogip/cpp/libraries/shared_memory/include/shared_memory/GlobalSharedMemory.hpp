@@ -0,0 +1,100 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include "shared_memory/global_data.hpp"
+#include "shared_memory/SharedMemory.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// @class GlobalSharedMemory
+/// Registry of the robots running on the same host, such as in the simulator or on a multi-robot bench.
+///
+/// Each robot registers itself, then publishes its current pose and detected obstacles,
+/// usually copied from its own `cogip_{robot_id}` segment with publishRobot().
+/// Other robots read them lock-free, using the seqlock of each entry,
+/// and skip unchanged states using the generation counter of the entry.
+class GlobalSharedMemory {
+public:
+    /// Opens the global segment, creating it if it does not exist.
+    /// @param name Name of the global shared memory segment.
+    /// @throws std::runtime_error if the segment cannot be opened or was created with another layout.
+    explicit GlobalSharedMemory(const std::string& name = GLOBAL_SHARED_MEMORY_NAME);
+
+    /// Unmaps the global segment, it stays available for the other processes.
+    ~GlobalSharedMemory();
+
+    GlobalSharedMemory(const GlobalSharedMemory&) = delete;             ///< Deleted copy constructor.
+    GlobalSharedMemory& operator=(const GlobalSharedMemory&) = delete;  ///< Deleted copy assignment.
+
+    /// Removes the global segment, processes still attached keep their mapping.
+    /// @param name Name of the global shared memory segment.
+    static void unlink(const std::string& name = GLOBAL_SHARED_MEMORY_NAME);
+
+    /// Registers a robot, or finds its entry if it is already registered.
+    /// @param robot_id Identifier of the robot, not 0.
+    /// @throws std::runtime_error if the registry is full.
+    void registerRobot(std::uint32_t robot_id);
+
+    /// Unregisters a robot, its entry is freed for another robot.
+    void unregisterRobot(std::uint32_t robot_id);
+
+    /// Identifiers of the registered robots.
+    std::vector<std::uint32_t> robots() const;
+
+    /// Publishes the state of a registered robot.
+    /// Only the process of the robot writes its state, readers never delay this call.
+    /// @param robot_id Identifier of the robot.
+    /// @param pose Current pose of the robot.
+    /// @param timestamp CLOCK_MONOTONIC time of the pose (ns), 0 if unknown.
+    /// @param obstacles Obstacles detected by the robot, only the first GLOBAL_ROBOT_OBSTACLES_MAX are published.
+    /// @param obstacle_count Number of obstacles.
+    /// @returns Generation of the published state.
+    /// @throws std::runtime_error if the robot is not registered.
+    std::uint64_t publishRobotState(
+        std::uint32_t robot_id,
+        const models::pose_t& pose,
+        std::uint64_t timestamp,
+        const models::circle_t* obstacles,
+        std::size_t obstacle_count
+    );
+
+    /// Publishes the current pose and the detector obstacles of a robot from its own shared memory.
+    /// The DetectorObstacles lock of the robot segment is only held while the obstacles are copied.
+    /// @param robot_id Identifier of the robot.
+    /// @param shared_memory Shared memory of the robot.
+    /// @returns Generation of the published state.
+    /// @throws std::runtime_error if the robot is not registered.
+    std::uint64_t publishRobot(std::uint32_t robot_id, SharedMemory& shared_memory);
+
+    /// Retrieves the generation of the state of a robot, to skip reading an unchanged state.
+    /// @returns Generation of the state, 0 if the robot is not registered or never published.
+    std::uint64_t getGeneration(std::uint32_t robot_id) const;
+
+    /// Reads a consistent copy of the state of a robot, using the seqlock of its entry.
+    /// Only the obstacle_count first obstacles are copied.
+    /// @param robot_id Identifier of the robot.
+    /// @param[out] state State of the robot.
+    /// @returns `true` if the state was read, `false` if the robot is not registered.
+    bool readRobotState(std::uint32_t robot_id, global_robot_state_t& state) const;
+
+private:
+    /// Finds the entry of a registered robot.
+    /// @returns Entry of the robot, or null if it is not registered.
+    global_robot_entry_t* findRobot(std::uint32_t robot_id) const;
+
+    std::string name_;     ///< Name of the global shared memory segment.
+    global_data_t* data_;  ///< Global data.
+};
+
+} // namespace shared_memory
+
+} // namespace cogip
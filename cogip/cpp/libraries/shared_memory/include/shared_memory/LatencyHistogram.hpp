@@ -0,0 +1,113 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include "SeqLock.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// Stages of a lidar frame, from its capture to the avoidance path computed from its obstacles.
+/// The latency of a stage is the time from the capture of the frame to the end of the stage.
+enum class LatencyStage : std::uint32_t {
+    LidarData,          ///< Scan published in lidar_data by the driver.
+    LidarCoords,        ///< Scan converted and published in lidar_coords.
+    DetectorObstacles,  ///< Obstacles clustered from the scan written in detector_obstacles.
+    AvoidancePath,      ///< Avoidance path computed with the obstacles of the scan.
+};
+
+/// Number of `LatencyStage` values.
+constexpr std::size_t LATENCY_STAGE_COUNT = static_cast<std::size_t>(LatencyStage::AvoidancePath) + 1;
+
+/// Number of sub-buckets of each power of two of the latency histograms, the width of a bucket is at most 1/8 of its bound.
+constexpr std::size_t LATENCY_HISTOGRAM_SUB_BUCKETS = 8;
+
+/// Number of buckets of the latency histograms, the last one also counts the latencies above about 4 s.
+constexpr std::size_t LATENCY_HISTOGRAM_BUCKETS = 160;
+
+/// Unit of the latency histogram buckets (ns).
+constexpr std::uint64_t LATENCY_HISTOGRAM_UNIT = 1000;
+
+/// Frame followed through the stages.
+typedef struct {
+    std::uint64_t sequence;           ///< Sequence number of the scan in the lidar scan history, 0 if none.
+    std::uint64_t capture_timestamp;  ///< CLOCK_MONOTONIC time of the end of the scan (ns), 0 if unknown.
+} latency_frame_t;
+
+/// Latency histogram of a stage in shared memory, alone in its cache lines.
+/// Buckets and counters are updated with relaxed atomic operations by the processes running the stage,
+/// every field is consistent but not the whole set.
+typedef struct {
+    alignas(64) seqlock_t seqlock;  ///< Seqlock of last_frame and last_timestamp.
+    latency_frame_t last_frame;     ///< Last frame stamped by the stage.
+    std::uint64_t last_timestamp;   ///< CLOCK_MONOTONIC time of the last stamp (ns).
+    std::atomic<std::uint64_t> total;  ///< Total latency of the stamped frames (ns).
+    std::atomic<std::uint64_t> max;    ///< Longest latency (ns).
+    std::atomic<std::uint64_t> buckets[LATENCY_HISTOGRAM_BUCKETS];  ///< Number of frames of each bucket.
+} latency_histogram_t;
+
+/// Snapshot of the latency histogram of a stage. Latencies are in nanoseconds.
+/// Percentiles are the upper bounds of their buckets, capped by the max, so they are overestimated by at most 1/8.
+typedef struct {
+    std::uint64_t count;          ///< Number of stamped frames.
+    std::uint64_t last_sequence;  ///< Sequence number of the last stamped frame.
+    double mean;                  ///< Mean latency.
+    std::uint64_t p50;            ///< Median latency.
+    std::uint64_t p99;            ///< 99th percentile latency.
+    std::uint64_t max;            ///< Longest latency.
+} latency_statistics_t;
+
+/// Index of the bucket of a latency.
+/// Latencies below 8 units have one bucket per unit, then each power of two is split in 8 buckets.
+/// @param latency Latency (ns).
+inline std::size_t latencyBucket(std::uint64_t latency)
+{
+    std::uint64_t units = latency / LATENCY_HISTOGRAM_UNIT;
+    if (units < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return units;
+    }
+    std::size_t exponent = 63 - __builtin_clzll(units);
+    std::size_t sub_bucket = (units >> (exponent - 3)) & (LATENCY_HISTOGRAM_SUB_BUCKETS - 1);
+    std::size_t bucket = (exponent - 2) * LATENCY_HISTOGRAM_SUB_BUCKETS + sub_bucket;
+    return bucket < LATENCY_HISTOGRAM_BUCKETS ? bucket : LATENCY_HISTOGRAM_BUCKETS - 1;
+}
+
+/// Lower bound of the latencies of a bucket (ns), see latencyBucket().
+inline std::uint64_t latencyBucketLowerBound(std::size_t bucket)
+{
+    if (bucket < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return bucket * LATENCY_HISTOGRAM_UNIT;
+    }
+    std::size_t exponent = bucket / LATENCY_HISTOGRAM_SUB_BUCKETS + 2;
+    std::uint64_t sub_bucket = bucket % LATENCY_HISTOGRAM_SUB_BUCKETS;
+    return ((LATENCY_HISTOGRAM_SUB_BUCKETS + sub_bucket) << (exponent - 3)) * LATENCY_HISTOGRAM_UNIT;
+}
+
+/// Overloads the stream insertion operator for `latency_statistics_t`.
+/// Prints the statistics in a human-readable format.
+/// @param os The output stream.
+/// @param stats The statistics to print.
+/// @return A reference to the output stream.
+inline std::ostream& operator<<(std::ostream& os, const latency_statistics_t& stats) {
+    os << "latency_statistics_t("
+       << "count=" << stats.count << ", "
+       << "last_sequence=" << stats.last_sequence << ", "
+       << "mean=" << stats.mean << ", "
+       << "p50=" << stats.p50 << ", "
+       << "p99=" << stats.p99 << ", "
+       << "max=" << stats.max
+       << ")";
+    return os;
+}
+
+} // namespace shared_memory
+
+} // namespace cogip
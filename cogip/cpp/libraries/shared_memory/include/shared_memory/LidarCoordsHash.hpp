@@ -0,0 +1,57 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include "shared_memory/shared_data.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// Get the bucket of a cell of the spatial hash of the lidar points.
+/// @param cell_x Index of the cell along X.
+/// @param cell_y Index of the cell along Y.
+inline std::size_t lidarCoordsHashBucket(std::int64_t cell_x, std::int64_t cell_y)
+{
+    std::uint64_t hash = static_cast<std::uint64_t>(cell_x) * 73856093u ^ static_cast<std::uint64_t>(cell_y) * 19349663u;
+    return static_cast<std::size_t>(hash) & (LIDAR_COORDS_HASH_BUCKETS - 1);
+}
+
+/// Builds the spatial hash of lidar points, with a counting sort of the points by bucket.
+/// @param coords Lidar points in table coordinates.
+/// @param count Number of points, at most MAX_LIDAR_DATA_COUNT.
+/// @param cell_size Size of the cells (mm).
+/// @param hash Spatial hash to fill.
+/// @throws std::invalid_argument if the cell size is not positive or there are too many points.
+void buildLidarCoordsHash(const lidar_coords_t& coords, std::size_t count, double cell_size, lidar_coords_hash_t& hash);
+
+/// Whether a lidar point lies within a distance of a segment.
+/// Only the points of the cells overlapping the segment inflated by the distance are tested,
+/// all points are tested if the hash is empty or if there are more such cells than points.
+/// @param coords Lidar points in table coordinates.
+/// @param count Number of points.
+/// @param hash Spatial hash of the points.
+/// @param ax X coordinate of the start of the segment (mm).
+/// @param ay Y coordinate of the start of the segment (mm).
+/// @param bx X coordinate of the end of the segment (mm).
+/// @param by Y coordinate of the end of the segment (mm).
+/// @param distance Distance to the segment (mm).
+bool isLidarCoordsNearSegment(
+    const lidar_coords_t& coords,
+    std::size_t count,
+    const lidar_coords_hash_t& hash,
+    double ax,
+    double ay,
+    double bx,
+    double by,
+    double distance
+);
+
+} // namespace shared_memory
+
+} // namespace cogip
@@ -0,0 +1,64 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include "shared_memory/SharedMemory.hpp"
+
+#include <cstdint>
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// @class LidarScanHistoryReader
+/// Reads every scan of the lidar scan history in order, and counts the scans overwritten before being read.
+///
+/// Each consumer owns its reader, readers never block the driver nor each other.
+/// A consumer falling more than LIDAR_SCAN_HISTORY_SIZE scans behind skips to the oldest scan still available.
+class LidarScanHistoryReader {
+public:
+    /// Constructor. The first scan read is the one following the last published scan.
+    /// @param shared_memory Shared memory of the scan history, it must outlive the reader.
+    explicit LidarScanHistoryReader(const SharedMemory& shared_memory);
+
+    /// Reads the next scan not read yet.
+    /// @param[out] data Lidar data of the scan.
+    /// @param[out] header Timing of the scan.
+    /// @returns `true` if a scan was read, `false` if all published scans were already read.
+    bool readNext(lidar_data_t& data, lidar_scan_header_t& header);
+
+    /// Reads the next scan not read yet in the compact format of the history, without expanding it.
+    /// @see readNext(lidar_data_t&, lidar_scan_header_t&)
+    bool readNext(lidar_compact_points_t& points, lidar_scan_header_t& header);
+
+    /// Skips the scans not read yet, the next scan read is the one following the last published scan.
+    void skipToLatest();
+
+    /// Number of published scans not read yet, including those already overwritten.
+    std::uint64_t pendingCount() const;
+
+    /// Sequence number of the last scan read, 0 if none.
+    std::uint64_t lastSequence() const { return last_sequence_; }
+
+    /// Number of scans overwritten before being read since the construction or the last resetDroppedCount().
+    std::uint64_t droppedCount() const { return dropped_count_; }
+
+    /// Resets the number of dropped scans.
+    void resetDroppedCount() { dropped_count_ = 0; }
+
+private:
+    /// Reads the next scan not read yet in the given points type.
+    template <typename Points>
+    bool readNextScan(Points& points, lidar_scan_header_t& header);
+
+    const SharedMemory& shared_memory_;  ///< Shared memory of the scan history.
+    std::uint64_t next_sequence_;        ///< Sequence number of the next scan to read.
+    std::uint64_t last_sequence_;        ///< Sequence number of the last scan read, 0 if none.
+    std::uint64_t dropped_count_;        ///< Number of scans overwritten before being read.
+};
+
+} // namespace shared_memory
+
+} // namespace cogip
@@ -0,0 +1,62 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// Sequence counter protecting a small field of the shared memory.
+///
+/// The counter is odd while a writer updates the field and even otherwise.
+/// Readers copy the field and retry if the counter was odd or changed during the copy,
+/// so they never block writers and never take a semaphore.
+/// Writers are serialized between themselves by the counter, they never wait for readers.
+typedef struct {
+    std::atomic<std::uint32_t> sequence;  ///< Sequence counter, odd during a write.
+} seqlock_t;
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "seqlock counter must be lock-free to be shared");
+
+/// Reads a field protected by a seqlock.
+/// @param lock Seqlock protecting the field.
+/// @param read Function copying the field, it may run several times and must not have side effects.
+template <typename Read>
+void seqlockRead(const seqlock_t& lock, Read&& read)
+{
+    while (true) {
+        std::uint32_t start = lock.sequence.load(std::memory_order_acquire);
+        if (start & 1) {
+            continue;
+        }
+        read();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (lock.sequence.load(std::memory_order_relaxed) == start) {
+            return;
+        }
+    }
+}
+
+/// Writes a field protected by a seqlock.
+/// @param lock Seqlock protecting the field.
+/// @param write Function updating the field.
+template <typename Write>
+void seqlockWrite(seqlock_t& lock, Write&& write)
+{
+    std::uint32_t start = lock.sequence.load(std::memory_order_relaxed);
+    while ((start & 1) || !lock.sequence.compare_exchange_weak(start, start + 1, std::memory_order_acquire)) {
+        start = lock.sequence.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    write();
+    lock.sequence.store(start + 2, std::memory_order_release);
+}
+
+} // namespace shared_memory
+
+} // namespace cogip
@@ -2,6 +2,8 @@
 // This file is subject to the terms and conditions of the GNU Lesser
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
+#pragma once
+
 #include "shared_memory/shared_data.hpp"
 #include "shared_memory/WritePriorityLock.hpp"
 
@@ -13,11 +15,20 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace cogip {
 
 namespace shared_memory {
 
+/// Tag selecting the in-process constructor of SharedMemory.
+struct in_process_t {
+    explicit in_process_t() = default;
+};
+
+/// Tag value selecting the in-process constructor of SharedMemory.
+inline constexpr in_process_t in_process{};
+
 /// @class SharedMemory
 /// Manages shared memory and associated locks for inter-process communication.
 ///
@@ -28,7 +39,17 @@ public:
     /// Constructs a SharedMemory instance.
     /// @param name Unique name of the shared memory segment.
     /// @param owner Whether this instance is the owner of the shared memory.
-    SharedMemory(const std::string& name, bool owner = false);
+    /// @param prefault Whether to fault in the whole segment at construction and lock the hot regions in RAM,
+    ///                 so the first accesses do not take page faults. The owner also asks for transparent huge pages.
+    SharedMemory(const std::string& name, bool owner = false, bool prefault = false);
+
+    /// Constructs a SharedMemory instance in anonymous memory private to the process,
+    /// for bench, replay and simulation builds running all stages in one process.
+    /// The data is laid out and initialized as in a named segment, so stages attached to it behave the same,
+    /// but no shared memory object is created and other processes cannot attach to it.
+    /// @param name Name of the instance, only used in messages and lock names.
+    /// @param prefault Whether to fault in the whole data at construction and lock the hot regions in RAM.
+    SharedMemory(const std::string& name, in_process_t, bool prefault = false);
 
     /// Cleans up shared memory and associated resources.
     ~SharedMemory();
@@ -41,26 +62,207 @@ public:
     SharedMemory(SharedMemory&&) = default;                 ///< Defaulted move constructor.
     SharedMemory& operator=(SharedMemory&&) = default;      ///< Defaulted move assignment.
 
+    /// Whether the data is private to the process, see SharedMemory(const std::string&, in_process_t, bool).
+    bool isInProcess() const { return in_process_; }
+
     /// Retrieves a write-priority lock for the specified lock name.
     /// @param lock Name of the lock to retrieve.
     /// @returns Reference to the `WritePriorityLock` associated with the specified name.
     WritePriorityLock& getLock(LockName lock);
 
+    /// Retrieves the number of writes of a shared memory region.
+    /// The generation is incremented when the region lock is released by a writer,
+    /// and by the pushPoseCurrent() and writePoseOrder() lock-free accessors.
+    /// Lidar triple buffers are not counted, each scan posts an update instead.
+    /// @param lock Name of the lock protecting the region.
+    /// @returns Generation of the region, consumers can skip their work if it did not change since their last read.
+    std::uint64_t getGeneration(LockName lock) const;
+
     /// Retrieves a pointer to the shared memory data structure.
     shared_data_t* getData() { return data_; }
 
     /// Retrieves a pointer to the PoseBuffer object wrapping the shared memory pose_current_buffer structure.
     models::PoseBuffer* getPoseCurrentBuffer() { return pose_current_buffer_; }
 
+    /// Reads a current pose without taking the PoseCurrent lock, see models::PoseBuffer.
+    /// @param n Index of the pose, 0 being the last pushed pose.
+    /// @returns Copy of the pose, or a null pose if the buffer is empty.
+    models::pose_t readPoseCurrent(std::size_t n = 0) const;
+
+    /// Reads the current pose interpolated at a given time without taking the PoseCurrent lock.
+    /// @param timestamp CLOCK_MONOTONIC time (ns).
+    /// @returns Copy of the pose, or a null pose if the buffer is empty.
+    models::pose_t readPoseCurrentAt(std::uint64_t timestamp) const;
+
+    /// Pushes a current pose timestamped with the current CLOCK_MONOTONIC time.
+    /// Only one process pushes the current poses, readers never delay this call.
+    void pushPoseCurrent(float x, float y, float angle);
+
+    /// Pushes a current pose with its CLOCK_MONOTONIC time (ns), see pushPoseCurrent(float, float, float).
+    /// Timestamps must not decrease from one push to the next.
+    void pushPoseCurrent(float x, float y, float angle, std::uint64_t timestamp);
+
+    /// Reads the current poses pushed after a given time, oldest first, without taking the PoseCurrent lock.
+    /// @param timestamp CLOCK_MONOTONIC time (ns), only poses strictly more recent are read.
+    /// @param[out] poses Poses read, the vector is cleared first.
+    /// @param[out] timestamps CLOCK_MONOTONIC time (ns) of each pose, the vector is cleared first.
+    void readPoseCurrentSince(
+        std::uint64_t timestamp,
+        std::vector<models::pose_t>& poses,
+        std::vector<std::uint64_t>& timestamps
+    ) const;
+
+    /// Reads the pose order without taking the PoseOrder lock, using the pose_order seqlock.
+    models::pose_t readPoseOrder() const;
+
+    /// Writes the pose order, using the pose_order seqlock.
+    void writePoseOrder(const models::pose_t& pose_order);
+
+    /// Reads a consistent copy of the shared properties, using the properties seqlock.
+    shared_properties_t readProperties() const;
+
+    /// Writes all shared properties, using the properties seqlock.
+    void writeProperties(const shared_properties_t& properties);
 
     /// Retrieves a pointer to the Coords object wrapping the shared memory table_limits array.
     double (&getTableLimits())[4] { return data_->table_limits; }
 
-    /// Retrieves a pointer to the shared memory lidar_data structure.
-    double (&getLidarData())[MAX_LIDAR_DATA_COUNT][3] { return data_->lidar_data; }
-
-    /// Retrieves a pointer to the shared memory lidar_coords structure.
-    double (&getLidarCoords())[MAX_LIDAR_DATA_COUNT][2] { return data_->lidar_coords; }
+    /// Retrieves the latest published slot of the shared memory lidar_data triple buffer.
+    lidar_data_t& getLidarData() { return tripleBufferLatest(data_->lidar_data); }
+
+    /// Retrieves the latest published slot of the shared memory lidar_coords triple buffer.
+    lidar_coords_t& getLidarCoords() { return tripleBufferLatest(data_->lidar_coords); }
+
+    /// Retrieves the shared memory lidar_data triple buffer.
+    lidar_data_buffer_t& getLidarDataBuffer() { return data_->lidar_data; }
+
+    /// Retrieves the shared memory lidar_coords triple buffer.
+    lidar_coords_buffer_t& getLidarCoordsBuffer() { return data_->lidar_coords; }
+
+    /// Retrieves the timing header of a lidar_data slot.
+    /// Drivers fill it between tripleBufferBeginWrite() and tripleBufferPublish(),
+    /// readers copy it in the same tripleBufferRead() call as the slot to get a consistent scan.
+    /// @param slot Slot of the lidar_data triple buffer.
+    /// @returns Header of the slot.
+    lidar_scan_header_t& getLidarScanHeader(const lidar_data_t& slot);
+
+    /// Retrieves the number of points of a lidar_coords slot.
+    /// The converter sets it between tripleBufferBeginWrite() and tripleBufferPublish(),
+    /// readers copy it in the same tripleBufferRead() call as the slot.
+    /// @param slot Slot of the lidar_coords triple buffer.
+    /// @returns Point count of the slot.
+    std::uint32_t& getLidarCoordsCount(const lidar_coords_t& slot);
+
+    /// Retrieves the spatial hash of a lidar_coords slot.
+    /// The converter builds it between tripleBufferBeginWrite() and tripleBufferPublish(),
+    /// readers use it in the same tripleBufferRead() call as the slot.
+    /// @param slot Slot of the lidar_coords triple buffer.
+    /// @returns Spatial hash of the slot.
+    lidar_coords_hash_t& getLidarCoordsHash(const lidar_coords_t& slot);
+
+    /// Reads a consistent copy of the latest lidar scan and its timing header, without taking the LidarData lock.
+    /// Only the header.point_count points are copied.
+    /// @returns Number of points of the scan.
+    std::size_t readLidarScan(lidar_data_t& data, lidar_scan_header_t& header) const;
+
+    /// Reads a consistent copy of the latest lidar points in table coordinates, without taking the LidarCoords lock.
+    /// Only the points of the slot are copied.
+    /// @returns Number of points.
+    std::size_t readLidarCoords(lidar_coords_t& coords) const;
+
+    /// Whether a point of the latest lidar_coords slot lies within a distance of a segment,
+    /// using the spatial hash of the slot, without taking the LidarCoords lock.
+    /// @param ax X coordinate of the start of the segment (mm).
+    /// @param ay Y coordinate of the start of the segment (mm).
+    /// @param bx X coordinate of the end of the segment (mm).
+    /// @param by Y coordinate of the end of the segment (mm).
+    /// @param distance Distance to the segment (mm).
+    bool isLidarCoordsNearSegment(double ax, double ay, double bx, double by, double distance) const;
+
+    /// Marks all lidar_data and lidar_coords slots as empty, before the drivers and the converter start.
+    void clearLidarScans();
+
+    /// Publishes the lidar_data slot returned by tripleBufferBeginWrite(), and appends it to the scan history.
+    /// Drivers call it instead of tripleBufferPublish(), before posting the LidarData update.
+    /// @returns Sequence number of the scan in the history.
+    std::uint64_t publishLidarScan();
+
+    /// Writes a complete lidar scan to the next lidar_data slot and publishes it, see publishLidarScan().
+    /// Used by writers which do not fill the slot in place, such as the virtual lidar of the monitor.
+    /// Point time offsets are set to 0.
+    /// @param points Points of the scan, one (angle, distance, intensity) row per point.
+    /// @param count Number of points, at most MAX_LIDAR_DATA_COUNT - 1.
+    /// @param start_timestamp Time of the first point of the scan (ns), 0 if unknown.
+    /// @param end_timestamp Time of the last point of the scan (ns), 0 if unknown.
+    /// @param source Index of the lidar of the robot which measured the scan.
+    /// @returns Sequence number of the scan in the history.
+    /// @throws std::invalid_argument if there are too many points.
+    std::uint64_t writeLidarScan(
+        const double (*points)[3],
+        std::size_t count,
+        std::uint64_t start_timestamp = 0,
+        std::uint64_t end_timestamp = 0,
+        std::uint32_t source = 0
+    );
+
+    /// Retrieves the sequence number of the last scan of the history, 0 if no scan was published.
+    std::uint64_t getLidarScanHistoryHead() const {
+        return data_->lidar_scan_history.head.load(std::memory_order_acquire);
+    }
+
+    /// Reads a scan of the history by sequence number, using the seqlock of its entry.
+    /// Only the header.point_count points and their offsets are copied.
+    /// Points are expanded from the compact format of the history, so they are quantized, see lidar_compact_points_t.
+    /// @param sequence Sequence number of the scan.
+    /// @param[out] data Lidar data of the scan.
+    /// @param[out] header Timing of the scan.
+    /// @returns `true` if the scan was read, `false` if it is not published yet or was already overwritten.
+    bool readLidarScanHistory(std::uint64_t sequence, lidar_data_t& data, lidar_scan_header_t& header) const;
+
+    /// Reads a scan of the history by sequence number in the compact format of the history, without expanding it.
+    /// @see readLidarScanHistory(std::uint64_t, lidar_data_t&, lidar_scan_header_t&) const
+    bool readLidarScanHistory(std::uint64_t sequence, lidar_compact_points_t& points, lidar_scan_header_t& header) const;
+
+    /// Reads a consistent copy of the occupancy grid, using the occupancy_grid seqlock.
+    /// Only the cells inside the grid geometry are copied.
+    void readOccupancyGrid(occupancy_grid_t& grid) const;
+
+    /// Writes the occupancy grid, using the occupancy_grid seqlock.
+    /// Only the cells inside the grid geometry are copied.
+    void writeOccupancyGrid(const occupancy_grid_t& grid);
+
+    /// Checks whether a point is in an occupied cell of the occupancy grid, using the occupancy_grid seqlock.
+    /// @returns False if the point is outside the grid or the grid is disabled.
+    bool isPointOccupied(double x, double y) const;
+
+    /// Stamps a frame at the end of a stage, adding its latency since its capture to the histogram of the stage.
+    /// Frames of unknown capture time are not stamped. Stages running in several processes are counted together.
+    /// @param stage Stage of the frame.
+    /// @param frame Frame stamped, usually the last frame of the previous stage read when the stage read its input.
+    /// @param timestamp CLOCK_MONOTONIC time of the end of the stage (ns), 0 for the current time.
+    void stampLatency(LatencyStage stage, const latency_frame_t& frame, std::uint64_t timestamp = 0);
+
+    /// Reads the last frame stamped by a stage, using the seqlock of its histogram.
+    /// @returns The frame, with a sequence number of 0 if the stage never stamped a frame.
+    latency_frame_t readLatencyFrame(LatencyStage stage) const;
+
+    /// Returns a snapshot of the latency histogram of a stage, accumulated by all processes since the last reset.
+    latency_statistics_t getLatencyStatistics(LatencyStage stage) const;
+
+    /// Resets the latency histograms of all stages.
+    void resetLatencyStatistics();
+
+    /// Retrieves the health counters of the driver of a lidar source, written by the driver.
+    /// @throws std::invalid_argument if the source is not below LIDAR_SOURCES_MAX.
+    lidar_driver_health_t& getLidarDriverHealth(std::uint32_t source);
+
+    /// Returns a snapshot of the health counters of the driver of a lidar source.
+    /// @throws std::invalid_argument if the source is not below LIDAR_SOURCES_MAX.
+    lidar_driver_health_statistics_t getLidarDriverHealthStatistics(std::uint32_t source) const;
+
+    /// Resets the health counters of the drivers of all lidar sources.
+    /// Counters incremented by a running driver meanwhile may be lost.
+    void resetLidarDriverHealth();
 
     /// Retrieves a pointer to the shared memory detector_obstacles structure.
     models::CircleList* getDetectorObstacles() { return detector_obstacles_; }
@@ -68,11 +270,54 @@ public:
     /// Retrieves a pointer to the shared memory monitor_obstacles structure.
     models::CircleList* getMonitorObstacles() { return monitor_obstacles_; }
 
-    /// Retrieves a pointer to the shared memory circle_obstacles structure.
-    obstacles::ObstacleCircleList* getCircleObstacles() { return circle_obstacles_; }
-
-    /// Retrieves a pointer to the shared memory rectangle_obstacles structure.
-    obstacles::ObstacleRectangleList* getRectangleObstacles() { return rectangle_obstacles_; }
+    /// Retrieves the published planner circle obstacles.
+    /// They stay untouched until the planner starts refilling them after its next publication,
+    /// readers needing a consistent copy use readObstacles().
+    obstacles::CompactObstacleCircleList* getCircleObstacles() { return circle_obstacles_[publishedObstacles()]; }
+
+    /// Retrieves the published planner rectangle obstacles, see getCircleObstacles().
+    obstacles::CompactObstacleRectangleList* getRectangleObstacles() { return rectangle_obstacles_[publishedObstacles()]; }
+
+    /// Retrieves the staging planner circle obstacles, filled between beginObstaclesWrite() and publishObstacles().
+    obstacles::CompactObstacleCircleList* getStagingCircleObstacles() { return circle_obstacles_[1 - publishedObstacles()]; }
+
+    /// Retrieves the staging planner rectangle obstacles, filled between beginObstaclesWrite() and publishObstacles().
+    obstacles::CompactObstacleRectangleList* getStagingRectangleObstacles() { return rectangle_obstacles_[1 - publishedObstacles()]; }
+
+    /// Starts filling the staging planner obstacle lists, which are emptied.
+    /// Only one process can write the planner obstacles, it must call publishObstacles() when the lists are complete.
+    void beginObstaclesWrite();
+
+    /// Publishes the staging planner obstacle lists in one store and increments the Obstacles generation.
+    /// The writer then posts an update on the Obstacles lock to wake up its consumers.
+    /// @throws std::runtime_error if beginObstaclesWrite() was not called.
+    void publishObstacles();
+
+    /// Reads the published planner obstacle lists without waiting for the planner.
+    /// @param copy Function reading the planner_obstacles_t given as argument, it may run several times
+    ///             and must not have side effects outside of its output.
+    /// @returns Generation of the Obstacles region, never newer than the lists read.
+    template <typename Copy>
+    std::uint64_t readObstacles(Copy&& copy) const
+    {
+        const planner_obstacles_buffer_t& buffer = data_->planner_obstacles;
+        const std::atomic<std::uint64_t>& generation = data_->generations[static_cast<std::size_t>(LockName::Obstacles)].value;
+        while (true) {
+            // The generation is incremented after the index is stored, so it is loaded first.
+            std::uint64_t read_generation = generation.load(std::memory_order_acquire);
+            std::uint32_t index = buffer.current.load(std::memory_order_acquire) % PLANNER_OBSTACLES_COPIES;
+            const seqlock_t& lock = buffer.seqlocks[index];
+            std::uint32_t start = lock.sequence.load(std::memory_order_acquire);
+            if (start & 1) {
+                continue;
+            }
+            copy(buffer.copies[index]);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (lock.sequence.load(std::memory_order_relaxed) == start) {
+                return read_generation;
+            }
+        }
+    }
 
     /// Retrieves a reference to the shared properties structure.
     shared_properties_t& getProperties() { return data_->properties; }
@@ -104,20 +349,101 @@ public:
     /// Retrieves a pointer to the shared memory avoidance_path structure.
     models::PoseOrderList* getAvoidancePath() { return avoidance_path_; }
 
-    /// Retrieves a reference to the simulated camera data in RGBA format.
-    uint8_t (&getSimCameraData())[SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT * 4] { return data_->sim_camera_data; }
+    /// Retrieves a pointer to the shared memory avoidance_path_version structure.
+    avoidance_path_version_t* getAvoidancePathVersion() { return &data_->avoidance_path_version; }
+
+    /// Commits a change of avoidance_path in its version, while holding the AvoidancePath lock for writing.
+    /// The path gets a new id if its first pose changed or if new_path is set.
+    /// @param first_changed_index Index of the first pose written, count if poses were only removed.
+    /// @param new_path True to give the path a new id even if its first pose did not change.
+    /// @returns Id of the committed path.
+    std::uint64_t commitAvoidancePath(std::size_t first_changed_index, bool new_path = false);
+
+    /// Saves a consistent snapshot of the shared data in a file, for post-mortem analysis or fast test setup.
+    /// The file is the image of shared_data_t, starting with its layout header.
+    /// It is allocated and mapped before the locks of all regions are taken for reading, so the locks are only held
+    /// during the copy. The simulated camera segment is not saved.
+    /// @param path Path of the snapshot file, replaced if it exists.
+    /// @throws std::runtime_error if the file cannot be written.
+    void dump(const std::string& path);
+
+    /// Loads a snapshot saved by dump() in the shared data, while holding the locks of all regions for writing,
+    /// then posts an update on each lock.
+    /// Header, generation counters and lock states of the segment are kept, so attached processes are not disturbed,
+    /// and seqlocks are advanced so lock-free readers retry.
+    /// Producers should be stopped first, the regions they write without lock would be mixed with the snapshot.
+    /// @param path Path of the snapshot file.
+    /// @throws std::runtime_error if the file cannot be read or was saved with another layout of shared_data_t.
+    void load(const std::string& path);
+
+    /// Retrieves a reference to the simulated camera segment.
+    /// The frames have their own shared memory segment, mapped by the first call,
+    /// so processes not using it do not pay for it.
+    sim_camera_data_t& getSimCameraData();
+
+    /// Requests the pixel format of the next simulated camera frames.
+    /// The camera tool reading the frames chooses the format, the monitor converts its images to it.
+    void requestSimCameraFormat(SimCameraFormat format);
+
+    /// Retrieves the pixel format requested for the simulated camera frames, RGBA by default.
+    SimCameraFormat getRequestedSimCameraFormat();
+
+    /// Converts an image to the requested pixel format and publishes it as the latest simulated camera frame.
+    /// Only one process can publish frames, readers are never blocked.
+    /// The caller posts the SimCameraData update afterwards.
+    /// @param rgba Image of SIM_CAMERA_WIDTH x SIM_CAMERA_HEIGHT pixels in RGBA format.
+    /// @param timestamp CLOCK_MONOTONIC capture time of the image (ns).
+    /// @returns Sequence number of the frame.
+    std::uint64_t publishSimCameraFrame(const std::uint8_t* rgba, std::uint64_t timestamp);
+
+    /// Retrieves the latest simulated camera frame in place, without copying it.
+    /// The frame stays untouched until the monitor publishes two more frames,
+    /// use isSimCameraFrameValid() after using it to check it was not overwritten meanwhile.
+    /// @param[out] header Header of the frame.
+    /// @returns Pixels of the frame, or null if no frame was published.
+    const std::uint8_t* getSimCameraFrame(sim_camera_frame_header_t& header);
+
+    /// Checks that a frame retrieved by getSimCameraFrame() is still in its slot, complete.
+    /// @param header Header of the frame.
+    bool isSimCameraFrameValid(const sim_camera_frame_header_t& header);
 
 private:
+    /// Reads the header of a scan of the history and copies its points, using the seqlock of its entry.
+    /// @param sequence Sequence number of the scan.
+    /// @param[out] header Timing of the scan.
+    /// @param copy Function copying the given number of points of the entry.
+    /// @returns `true` if the scan was read, `false` if it is not published yet or was already overwritten.
+    template <typename Copy>
+    bool readLidarScanHistoryEntry(std::uint64_t sequence, lidar_scan_header_t& header, Copy&& copy) const;
+
+    /// Initializes the data of a new segment: zeroes, empty lidar slots and layout header.
+    void initializeData();
+
+    /// Locks the hot regions in RAM, then creates the locks and the objects wrapping the data.
+    void attachData();
+
     std::string name_;     ///< Unique name of the shared memory segment.
     bool owner_;           ///< Indicates whether this instance owns the shared memory.
+    bool in_process_;      ///< Indicates whether the data is anonymous memory private to the process.
+    bool prefault_;        ///< Indicates whether the segment is prefaulted and its hot regions locked in RAM.
     int shm_fd_;           ///< File descriptor for the shared memory.
     shared_data_t* data_;  ///< Pointer to the shared memory data structure.
+    std::string sim_camera_shm_name_;       ///< Name of the shared memory segment of the simulated camera data.
+    int sim_camera_shm_fd_;                 ///< File descriptor for the simulated camera data segment.
+    sim_camera_data_t* sim_camera_data_;    ///< Simulated camera data, null until mapped by getSimCameraData().
     std::map<LockName, std::shared_ptr<WritePriorityLock>> locks_;  ///< Map of locks for synchronization.
     models::PoseBuffer* pose_current_buffer_;  ///< Pointer to the PoseBuffer object wrapping the shared memory pose_current_buffer structure.
     models::CircleList* detector_obstacles_;  ///< Pointer to the CircleList object wrapping the shared memory detector_obstacles structure.
     models::CircleList* monitor_obstacles_;  ///< Pointer to the CircleList object wrapping the shared memory monitor_obstacles structure.
-    obstacles::ObstacleCircleList* circle_obstacles_;  ///< Pointer to the ObstacleCircleList object wrapping the shared memory circle_obstacles structure.
-    obstacles::ObstacleRectangleList* rectangle_obstacles_;  ///< Pointer to the ObstacleRectangleList object wrapping the shared memory rectangle_obstacles structure.
+    /// CompactObstacleCircleList objects wrapping the circle obstacles of each copy of the planner obstacles.
+    obstacles::CompactObstacleCircleList* circle_obstacles_[PLANNER_OBSTACLES_COPIES];
+    /// CompactObstacleRectangleList objects wrapping the rectangle obstacles of each copy of the planner obstacles.
+    obstacles::CompactObstacleRectangleList* rectangle_obstacles_[PLANNER_OBSTACLES_COPIES];
+
+    /// Index of the published copy of the planner obstacles.
+    std::uint32_t publishedObstacles() const {
+        return data_->planner_obstacles.current.load(std::memory_order_acquire) % PLANNER_OBSTACLES_COPIES;
+    }
     models::PoseOrder* avoidance_new_pose_order_;  ///< Pointer to the PoseOrder object for the new pose order in avoidance.
     models::PoseOrder* avoidance_pose_order_;  ///< Pointer to the PoseOrder object for the current pose order in avoidance.
     models::PoseOrderList* avoidance_path_;  ///< Pointer to the PoseOrderList object for the avoidance path.
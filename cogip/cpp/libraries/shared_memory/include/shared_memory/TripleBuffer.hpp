@@ -0,0 +1,87 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include "SeqLock.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// Number of slots of a triple buffer.
+constexpr std::uint32_t TRIPLE_BUFFER_SLOTS = 3;
+
+/// Triple buffer shared between one writer and any number of readers.
+///
+/// The writer fills the slot following the latest one, then publishes it by storing its index,
+/// so readers always find a complete value in the latest slot without taking a lock.
+/// Each slot also has a seqlock: a reader still copying a slot when the writer comes back to it,
+/// two publications later, detects the overwrite and retries on the new latest slot.
+template <typename T>
+struct triple_buffer_t {
+    std::atomic<std::uint32_t> latest;           ///< Index of the latest published slot.
+    seqlock_t seqlocks[TRIPLE_BUFFER_SLOTS];     ///< Seqlocks of the slots.
+    T slots[TRIPLE_BUFFER_SLOTS];                ///< Slots.
+};
+
+/// Returns the latest published slot of a triple buffer.
+/// The slot is only guaranteed to stay untouched until the writer publishes twice more.
+template <typename T>
+T& tripleBufferLatest(triple_buffer_t<T>& buffer)
+{
+    return buffer.slots[buffer.latest.load(std::memory_order_acquire) % TRIPLE_BUFFER_SLOTS];
+}
+
+/// Starts writing the next slot of a triple buffer.
+/// Only one writer can use a triple buffer, it must call tripleBufferPublish() when the slot is complete.
+/// @returns The slot to fill.
+template <typename T>
+T& tripleBufferBeginWrite(triple_buffer_t<T>& buffer)
+{
+    std::uint32_t next = (buffer.latest.load(std::memory_order_relaxed) + 1) % TRIPLE_BUFFER_SLOTS;
+    seqlock_t& lock = buffer.seqlocks[next];
+    lock.sequence.store(lock.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return buffer.slots[next];
+}
+
+/// Publishes the slot returned by tripleBufferBeginWrite(), it becomes the latest slot.
+template <typename T>
+void tripleBufferPublish(triple_buffer_t<T>& buffer)
+{
+    std::uint32_t next = (buffer.latest.load(std::memory_order_relaxed) + 1) % TRIPLE_BUFFER_SLOTS;
+    seqlock_t& lock = buffer.seqlocks[next];
+    lock.sequence.store(lock.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    buffer.latest.store(next, std::memory_order_release);
+}
+
+/// Reads the latest published slot of a triple buffer.
+/// @param buffer Triple buffer to read.
+/// @param read Function reading the slot given as argument, it may run several times and must not have side effects
+///             outside of its output.
+template <typename T, typename Read>
+void tripleBufferRead(const triple_buffer_t<T>& buffer, Read&& read)
+{
+    while (true) {
+        std::uint32_t index = buffer.latest.load(std::memory_order_acquire) % TRIPLE_BUFFER_SLOTS;
+        const seqlock_t& lock = buffer.seqlocks[index];
+        std::uint32_t start = lock.sequence.load(std::memory_order_acquire);
+        if (start & 1) {
+            continue;
+        }
+        read(buffer.slots[index]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (lock.sequence.load(std::memory_order_relaxed) == start) {
+            return;
+        }
+    }
+}
+
+} // namespace shared_memory
+
+} // namespace cogip
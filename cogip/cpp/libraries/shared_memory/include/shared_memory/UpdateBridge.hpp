@@ -0,0 +1,75 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// Maximum number of update counters watched by the bridge of a process.
+constexpr std::size_t UPDATE_BRIDGE_WATCHES_MAX = 127;
+
+/// @class UpdateBridge
+/// Turns update notifications of shared memory locks into pollable file descriptors.
+///
+/// Update notifications are futexes, which cannot be polled. The bridge of a process
+/// runs a single thread waiting on the update counters of all watched locks at once
+/// with futex_waitv(), and signals the eventfd of each updated counter.
+/// One asyncio loop or epoll reactor can then multiplex all the updates it consumes,
+/// without a thread blocked in WritePriorityLock::waitUpdate() per lock.
+///
+/// On kernels without futex_waitv() (before 5.16), the thread polls the counters every millisecond.
+class UpdateBridge {
+public:
+    /// The bridge of the process, its thread is started by the first watch.
+    static UpdateBridge& instance();
+
+    /// Stops the thread and closes the remaining eventfds.
+    ~UpdateBridge();
+
+    UpdateBridge(const UpdateBridge&) = delete;
+    UpdateBridge& operator=(const UpdateBridge&) = delete;
+
+    /// Starts watching an update counter.
+    /// @param counter Update counter in shared memory, incremented and woken up by the producer.
+    /// @return Non-blocking eventfd, readable when the counter changed since it was last read.
+    int watch(std::atomic<std::uint32_t>& counter);
+
+    /// Stops watching an update counter and closes its eventfd.
+    /// @param fd Eventfd returned by watch().
+    void unwatch(int fd);
+
+private:
+    /// Watched update counter.
+    struct watch_t {
+        std::atomic<std::uint32_t>* counter;  ///< Update counter in shared memory.
+        std::uint32_t signaled;               ///< Counter value when the eventfd was last signaled.
+        int fd;                               ///< Eventfd signaled on changes.
+    };
+
+    UpdateBridge();
+
+    /// Thread loop: signals changed counters, then waits for the next change or watch list change.
+    void run();
+
+    /// Wakes up the thread so it reloads the watch list.
+    void wakeUp();
+
+    std::mutex mutex_;                    ///< Protects watches_.
+    std::vector<watch_t> watches_;        ///< Watched counters.
+    std::atomic<std::uint32_t> control_;  ///< Incremented to wake up the thread.
+    std::atomic<bool> stop_;              ///< Requests the thread to stop.
+    std::thread thread_;                  ///< Bridge thread.
+};
+
+} // namespace shared_memory
+
+} // namespace cogip
@@ -2,15 +2,96 @@
 // This file is subject to the terms and conditions of the GNU Lesser
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
-#include <semaphore.h>
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
 #include <string>
-#include <unordered_map>
-#include <sys/types.h>
 
 namespace cogip {
 
 namespace shared_memory {
 
+/// Statistics of a lock, accumulated by all processes using it.
+/// Times are in nanoseconds, measured with CLOCK_MONOTONIC.
+typedef struct {
+    std::uint64_t read_acquisitions;   ///< Number of read locks taken.
+    std::uint64_t write_acquisitions;  ///< Number of write locks taken.
+    std::uint64_t read_wait_total;     ///< Total time spent waiting for read locks.
+    std::uint64_t read_wait_max;       ///< Longest wait for a read lock.
+    std::uint64_t write_wait_total;    ///< Total time spent waiting for write locks.
+    std::uint64_t write_wait_max;      ///< Longest wait for a write lock.
+    std::uint64_t read_hold_total;     ///< Total time read locks were held.
+    std::uint64_t read_hold_max;       ///< Longest time a read lock was held.
+    std::uint64_t write_hold_total;    ///< Total time write locks were held.
+    std::uint64_t write_hold_max;      ///< Longest time a write lock was held.
+    std::uint64_t writer_starvations;  ///< Number of writers which waited longer than WRITER_STARVATION_NS.
+    std::uint64_t missed_updates;      ///< Number of updates coalesced by waitUpdate() because consumers were late.
+} lock_statistics_t;
+
+/// Minimum wait of a writer counted as a writer starvation event.
+constexpr std::uint64_t WRITER_STARVATION_NS = 10000000;
+
+/// Overloads the stream insertion operator for `lock_statistics_t`.
+/// Prints the statistics in a human-readable format.
+/// @param os The output stream.
+/// @param stats The statistics to print.
+/// @return A reference to the output stream.
+inline std::ostream& operator<<(std::ostream& os, const lock_statistics_t& stats) {
+    os << "lock_statistics_t("
+       << "read_acquisitions=" << stats.read_acquisitions << ", "
+       << "write_acquisitions=" << stats.write_acquisitions << ", "
+       << "read_wait_total=" << stats.read_wait_total << ", "
+       << "read_wait_max=" << stats.read_wait_max << ", "
+       << "write_wait_total=" << stats.write_wait_total << ", "
+       << "write_wait_max=" << stats.write_wait_max << ", "
+       << "read_hold_total=" << stats.read_hold_total << ", "
+       << "read_hold_max=" << stats.read_hold_max << ", "
+       << "write_hold_total=" << stats.write_hold_total << ", "
+       << "write_hold_max=" << stats.write_hold_max << ", "
+       << "writer_starvations=" << stats.writer_starvations << ", "
+       << "missed_updates=" << stats.missed_updates
+       << ")";
+    return os;
+}
+
+/// Statistics counters of a lock in shared memory, see lock_statistics_t.
+/// Counters are updated with relaxed atomic operations, every field is consistent but not the whole set.
+struct alignas(64) lock_counters_t {
+    std::atomic<std::uint64_t> read_acquisitions;
+    std::atomic<std::uint64_t> write_acquisitions;
+    std::atomic<std::uint64_t> read_wait_total;
+    std::atomic<std::uint64_t> read_wait_max;
+    std::atomic<std::uint64_t> write_wait_total;
+    std::atomic<std::uint64_t> write_wait_max;
+    std::atomic<std::uint64_t> read_hold_total;
+    std::atomic<std::uint64_t> read_hold_max;
+    std::atomic<std::uint64_t> write_hold_total;
+    std::atomic<std::uint64_t> write_hold_max;
+    std::atomic<std::uint64_t> writer_starvations;
+    std::atomic<std::uint64_t> missed_updates;
+    std::atomic<std::uint64_t> write_start;  ///< Time the current write lock was taken.
+};
+
+/// Read/write lock state shared between processes, alone in its cache line.
+///
+/// The state word packs the active reader count (bits 0-15), the pending writer count (bits 16-29),
+/// a waiter flag (bit 30) and the writer flag (bit 31).
+/// Processes block on the word itself with futex(FUTEX_WAIT/FUTEX_WAKE),
+/// so lock operations without contention need no system call.
+///
+/// Update notifications use a generation counter in its own cache line:
+/// postUpdate() increments it and wakes all processes blocked on it with a single system call.
+/// Statistics counters follow, in their own cache lines.
+struct alignas(64) lock_state_t {
+    std::atomic<std::uint32_t> word;  ///< Lock state word.
+    alignas(64) std::atomic<std::uint32_t> update_generation;  ///< Number of posted updates.
+    lock_counters_t counters;  ///< Statistics counters.
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "lock state must be lock-free to be shared");
+
 /// @class WritePriorityLock
 /// Manages a write-priority locking mechanism for shared resources.
 ///
@@ -19,13 +100,35 @@ namespace shared_memory {
 class WritePriorityLock {
 public:
     /// Constructs a WritePriorityLock instance.
-    /// @param name Unique name used for associated semaphores and shared memory.
+    /// @param name Unique name used for the associated shared memory.
     /// @param owner Whether this instance owns and initializes the resources.
-    explicit WritePriorityLock(const std::string& name, bool owner = false);
-
-    /// Cleans up semaphores and shared memory resources.
+    /// @param generation Optional generation counter of the protected data, incremented by finishWriting().
+    explicit WritePriorityLock(
+        const std::string& name,
+        bool owner = false,
+        std::atomic<std::uint64_t>* generation = nullptr
+    );
+
+    /// Constructs a WritePriorityLock instance on a state stored in an existing shared memory segment,
+    /// so the lock opens no shared memory object of its own.
+    /// @param name Name of the lock, only used in debug messages.
+    /// @param state Lock state, in memory shared between processes.
+    /// @param owner Whether this instance initializes the state.
+    /// @param generation Optional generation counter of the protected data, incremented by finishWriting().
+    WritePriorityLock(
+        const std::string& name,
+        lock_state_t& state,
+        bool owner = false,
+        std::atomic<std::uint64_t>* generation = nullptr
+    );
+
+    /// Cleans up shared memory resources.
     ~WritePriorityLock();
 
+    /// Copying is disallowed, copies would release the resources of the original instance.
+    WritePriorityLock(const WritePriorityLock&) = delete;
+    WritePriorityLock& operator=(const WritePriorityLock&) = delete;
+
     /// Acquires a read lock, allowing multiple readers concurrently.
     void startReading();
 
@@ -36,50 +139,78 @@ public:
     void startWriting();
 
     /// Releases the write lock, allowing other readers or writers to proceed.
+    /// Increments the generation counter first, so readers see the new generation with the new data.
     void finishWriting();
 
+    /// Number of writes of the protected data, 0 if the lock has no generation counter.
+    /// A reader holding the read lock gets the generation of the data it reads.
+    std::uint64_t generation() const;
+
     /// Register the the lock will be used to wait the update signal to read updated data.
+    /// Only updates posted after registration are reported by waitUpdate().
     void registerConsumer();
 
     /// Signal to registered consumers that data was updated.
     void postUpdate();
 
     /// Wait for the updated signal meaning that data was updated.
+    /// Returns immediately if updates were posted since the last call,
+    /// several updates posted meanwhile are reported once.
     /// @param timeout_seconds Timeout in seconds. If negative, wait indefinitely.
     /// @return True if the signal was received, false if timed out.
     bool waitUpdate(double timeout_seconds = -1.0);
 
-    /// Reset counters and semaphores.
+    /// File descriptor readable when updates were posted, to multiplex update notifications
+    /// with poll/epoll or an asyncio loop instead of blocking a thread in waitUpdate().
+    /// The descriptor is created on first call and signaled by the UpdateBridge of the process.
+    /// Once readable, call pollUpdate() to consume the updates.
+    /// @return Non-blocking eventfd, closed with the lock.
+    int updateFd();
+
+    /// Check without blocking if updates were posted since the last call,
+    /// same as waitUpdate() with a null timeout, and clear the readiness of updateFd().
+    /// @return True if updates were posted.
+    bool pollUpdate();
+
+    /// Number of updates coalesced by the last successful waitUpdate() call of this instance.
+    std::uint32_t lastMissedUpdates() const { return last_missed_updates_; }
+
+    /// Reset the lock state.
     void reset();
 
+    /// Returns a snapshot of the lock statistics, accumulated by all processes since the last reset.
+    /// Hold times of read locks assume each instance is used by a single thread.
+    lock_statistics_t getStatistics() const;
+
+    /// Reset the lock statistics of all processes.
+    void resetStatistics();
+
     /// Set/unset debug mode.
     void setDebug(bool debug) { debug_ = debug; }
 
 private:
     bool owner_;                    ///< Indicates whether this instance owns the resources.
     bool registered_consumer_;      ///< Indicates if the lock is registered as a consumer.
-    std::string name_;              ///< Base name used for semaphore and shared memory naming.
-    std::string mutex_name_;        ///< Name of the mutex semaphore.
-    std::string write_lock_name_;   ///< Name of the write lock semaphore.
-    std::string update_name_;       ///< Name of the update semaphore.
-    std::string registration_name_; ///< Name of the consumer registration semaphore.
-    std::string reader_count_shm_name_;  ///< Name of the shared memory for reader count.
-    std::string write_request_shm_name_; ///< Name of the shared memory for write request count.
-    std::string consumer_count_shm_name_; ///< Name of the shared memory for consumer count.
-    sem_t* sem_mutex_;              ///< Semaphore for synchronizing access to shared memory.
-    sem_t* sem_write_lock_;         ///< Semaphore for ensuring write access priority.
-    sem_t* my_update_sem_;          ///< Semaphore specific to this process for update signal.
-    std::string my_update_sem_name_;///< Name of my_update_sem_
-    sem_t* sem_register_;           ///< Semaphore for consumer registration.
-    int reader_shm_fd_;             ///< File descriptor for shared memory of reader count.
-    int write_request_shm_fd_;      ///< File descriptor for shared memory of write request count.
-    int consumer_count_shm_fd_;     ///< File descriptor for shared memory of consumer count.
-    int* reader_count_;             ///< Shared memory pointer for reader count.
-    int* write_request_count_;      ///< Shared memory pointer for writer request count.
-    pid_t* consumer_pids_;          ///< Shared memory pointer for consumer PIDs array.
-    std::unordered_map<pid_t, sem_t*> update_sems_cache_; ///< Cache of opened semaphores for postUpdate
+    std::string name_;              ///< Base name used for shared memory naming.
+    std::string state_shm_name_;    ///< Name of the shared memory for the lock state, empty if the state is embedded.
+    int state_shm_fd_;              ///< File descriptor for shared memory of the lock state, -1 if the state is embedded.
+    lock_state_t* state_;           ///< Shared memory pointer for the lock state.
+    std::uint32_t seen_generation_; ///< Update generation seen by the last waitUpdate() call.
+    std::uint32_t last_missed_updates_; ///< Updates coalesced by the last successful waitUpdate() call.
+    std::atomic<std::uint64_t>* generation_; ///< Generation counter of the protected data, may be null.
+    std::uint64_t read_start_;      ///< Time the read lock of this instance was taken.
+    int update_fd_;                 ///< Eventfd of update notifications, -1 if not created.
     bool debug_;                    ///< Debug flag for logging.
-    static constexpr int MAX_CONSUMERS = 32; ///< Maximum number of registered consumers.
+
+    /// Records the updates seen at an update generation, if it differs from the last seen one.
+    /// @return True if updates were posted since the last seen generation.
+    bool consumeUpdate(std::uint32_t generation);
+
+    /// Blocks until the state word is woken up, returns immediately if it differs from expected.
+    void waitState(std::uint32_t expected);
+
+    /// Wakes up all processes blocked on the state word.
+    void wakeState();
 };
 
 } // namespace shared_memory
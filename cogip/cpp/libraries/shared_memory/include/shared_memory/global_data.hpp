@@ -0,0 +1,65 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include "models/circle.hpp"
+#include "models/pose.hpp"
+#include "shared_memory/shared_data.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace cogip {
+
+namespace shared_memory {
+
+/// Default name of the global shared memory segment, shared by all robots of the host.
+constexpr const char* GLOBAL_SHARED_MEMORY_NAME = "cogip_global";
+
+/// Maximum number of robots registered in the global segment.
+constexpr std::size_t GLOBAL_ROBOTS_MAX = 16;
+
+/// Maximum number of obstacles published by each robot in the global segment.
+constexpr std::size_t GLOBAL_ROBOT_OBSTACLES_MAX = 64;
+
+/// Magic number identifying the global shared memory segment ("CGGL").
+constexpr std::uint32_t GLOBAL_DATA_MAGIC = 0x4c474743;
+
+/// Version of the global_data_t layout, to increment on every change of global_data_t or its members.
+constexpr std::uint32_t GLOBAL_DATA_VERSION = 1;
+
+/// State published by a robot in the global segment.
+typedef struct {
+    std::uint64_t generation;  ///< Number of publications of the robot since its registration.
+    std::uint64_t timestamp;   ///< CLOCK_MONOTONIC time of the pose (ns), 0 if unknown.
+    models::pose_t pose;       ///< Current pose of the robot.
+    std::uint32_t obstacle_count;  ///< Number of valid obstacles.
+    models::circle_t obstacles[GLOBAL_ROBOT_OBSTACLES_MAX];  ///< Obstacles detected by the robot.
+} global_robot_state_t;
+
+/// Entry of a robot in the global segment, claimed by setting its robot_id.
+typedef struct {
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> robot_id;  ///< Identifier of the robot, 0 if the entry is free.
+    seqlock_t seqlock;            ///< Seqlock of state.
+    global_robot_state_t state;   ///< Last state published by the robot.
+} global_robot_entry_t;
+
+/// Global shared memory segment, read and written by the processes of all robots of the host.
+///
+/// The segment has no owner: it is created zeroed by the first process opening it,
+/// which is a valid empty registry, and the layout is stamped by the first process checking it.
+/// Each robot only writes its own entry, so robots never wait for each other.
+typedef struct {
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> magic;  ///< GLOBAL_DATA_MAGIC once the layout is stamped.
+    std::uint32_t version;  ///< GLOBAL_DATA_VERSION.
+    std::uint64_t size;     ///< sizeof(global_data_t).
+    global_robot_entry_t robots[GLOBAL_ROBOTS_MAX];  ///< Entries of the registered robots.
+} global_data_t;
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "robot ids must be lock-free to be shared");
+
+} // namespace shared_memory
+
+} // namespace cogip
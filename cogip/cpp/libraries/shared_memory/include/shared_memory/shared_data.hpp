@@ -11,7 +11,13 @@
 #include "obstacles/obstacle_circle_list.hpp"
 #include "obstacles/obstacle_polygon_list.hpp"
 #include "shared_properties.hpp"
+#include "LatencyHistogram.hpp"
+#include "SeqLock.hpp"
+#include "TripleBuffer.hpp"
+#include "WritePriorityLock.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <map>
 #include <ostream>
@@ -21,40 +27,311 @@ namespace cogip {
 namespace shared_memory {
 
 constexpr std::size_t MAX_LIDAR_DATA_COUNT = 1024;
+
+/// Maximum number of lidars of a robot, publishing their scans in the same lidar data.
+constexpr std::size_t LIDAR_SOURCES_MAX = 4;
 constexpr std::size_t SIM_CAMERA_WIDTH = 640;
 constexpr std::size_t SIM_CAMERA_HEIGHT = 480;
 
-/// Represents shared data in shared memory.
+/// Size of a cache line, shared data regions written by different processes never share one.
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/// Lidar data of one scan (angle, distance, intensity).
+/// The number of points is the point_count of the timing header of the slot.
+/// Writers also mark the end with an angle of -1 for readers of the raw slots.
+typedef double lidar_data_t[MAX_LIDAR_DATA_COUNT][3];
+
+/// Angle unit of the compact lidar points (deg), the angle resolution of the LD19 and G2 lidars.
+constexpr double LIDAR_COMPACT_ANGLE_UNIT = 1.0 / 64;
+
+/// Number of compact angle units in a full turn.
+constexpr std::uint32_t LIDAR_COMPACT_ANGLE_TURN = 360 * 64;
+
+/// Distance unit of the compact lidar points (mm), distances up to 16383.75 mm are stored.
+constexpr double LIDAR_COMPACT_DISTANCE_UNIT = 0.25;
+
+/// Lidar points of one scan, quantized and stored by field.
+/// A point takes 5 bytes instead of the 24 bytes of a lidar_data_t row.
 typedef struct {
-    models::pose_buffer_t pose_current_buffer;  ///< The last current poses.
-    models::pose_t pose_order;    ///< The target pose.
-    double table_limits[4];  ///< The limits of the table.
-    double lidar_data[MAX_LIDAR_DATA_COUNT][3];  ///< The Lidar data (angle, distance, intensity).
-    double lidar_coords[MAX_LIDAR_DATA_COUNT][2];  ///< The Lidar points converted in table coordinates.
-    models::circle_list_t detector_obstacles;  ///< The obstacles from detector.
-    models::circle_list_t monitor_obstacles;   ///< The obstacles from monitor.
-    obstacles::obstacle_circle_list_t circle_obstacles;  ///< The circle obstacles from planner.
-    obstacles::obstacle_polygon_list_t rectangle_obstacles;  ///< The rectangle obstacles from planner.
-    shared_properties_t properties;  ///< Shared properties.
-    bool avoidance_exiting;  ///< True if the avoidance process is exiting, false otherwise
-    bool avoidance_has_new_pose_order;  ///< True if the avoidance process should use the new pose order property, false otherwise
-    bool avoidance_has_pose_order;  ///< True if no pose order has been set by the Planner, false otherwise
-    models::pose_order_t avoidance_new_pose_order;  ///< New pose order for the avoidance process
-    models::pose_order_t avoidance_pose_order;  ///< Current pose order for the avoidance process
-    models::pose_order_list_t avoidance_path;  ///< Path for the avoidance process
-    uint8_t sim_camera_data[SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT * 4];  ///< Simulated camera data in RGBA format
-} shared_data_t;
+    std::uint16_t angles[MAX_LIDAR_DATA_COUNT];      ///< Angles in LIDAR_COMPACT_ANGLE_UNIT, in [0, 360) deg.
+    std::uint16_t distances[MAX_LIDAR_DATA_COUNT];   ///< Distances in LIDAR_COMPACT_DISTANCE_UNIT, saturated.
+    std::uint8_t intensities[MAX_LIDAR_DATA_COUNT];  ///< Intensities, saturated at 255.
+} lidar_compact_points_t;
 
-/// Overloads the stream insertion operator for `shared_data_t`.
-/// Prints the shared data in a human-readable format.
+/// Quantizes lidar points, rounding to the nearest unit.
+/// Angles are expected in [0, 360) deg, values out of the range of a field are saturated.
+/// The loop has no branch nor library call, so the compiler can vectorize it.
+/// @param data Lidar data.
+/// @param count Number of points.
+/// @param[out] points Quantized points.
+inline void compactLidarPoints(const lidar_data_t& data, std::size_t count, lidar_compact_points_t& points)
+{
+    for (std::size_t index = 0; index < count; index++) {
+        // An angle rounded up to a full turn is 0.
+        std::uint32_t angle = static_cast<std::uint32_t>(
+            std::clamp(data[index][0] / LIDAR_COMPACT_ANGLE_UNIT + 0.5, 0.0, double(LIDAR_COMPACT_ANGLE_TURN))
+        );
+        points.angles[index] = static_cast<std::uint16_t>(angle - (angle >= LIDAR_COMPACT_ANGLE_TURN) * LIDAR_COMPACT_ANGLE_TURN);
+        points.distances[index] = static_cast<std::uint16_t>(
+            std::clamp(data[index][1] / LIDAR_COMPACT_DISTANCE_UNIT + 0.5, 0.0, 65535.0)
+        );
+        points.intensities[index] = static_cast<std::uint8_t>(std::clamp(data[index][2] + 0.5, 0.0, 255.0));
+    }
+}
+
+/// Expands quantized lidar points to lidar data.
+/// @param points Quantized points.
+/// @param count Number of points.
+/// @param[out] data Lidar data.
+inline void expandLidarPoints(const lidar_compact_points_t& points, std::size_t count, lidar_data_t& data)
+{
+    for (std::size_t index = 0; index < count; index++) {
+        data[index][0] = points.angles[index] * LIDAR_COMPACT_ANGLE_UNIT;
+        data[index][1] = points.distances[index] * LIDAR_COMPACT_DISTANCE_UNIT;
+        data[index][2] = points.intensities[index];
+    }
+}
+
+/// Timing of one lidar scan, written with the lidar_data slot of the same index.
+/// Timestamps use CLOCK_MONOTONIC, the clock of the pose buffer timestamps.
+typedef struct {
+    std::uint64_t start_timestamp;  ///< Time of the first point of the scan revolution (ns), 0 if unknown.
+    std::uint64_t end_timestamp;    ///< Time of the last point of the scan revolution (ns), 0 if unknown.
+    std::uint32_t point_count;      ///< Number of points in the lidar data slot, at most MAX_LIDAR_DATA_COUNT - 1.
+    std::uint32_t source;           ///< Index of the lidar of the robot which measured the scan, below LIDAR_SOURCES_MAX.
+    std::uint32_t point_offsets[MAX_LIDAR_DATA_COUNT];  ///< Time of each point relative to start_timestamp (ns).
+} lidar_scan_header_t;
+
+/// Lidar points of one scan converted in table coordinates.
+/// The number of points is the count of the slot in lidar_coords_counts.
+/// Writers also mark the end with an X coordinate of -1 for readers of the raw slots.
+typedef double lidar_coords_t[MAX_LIDAR_DATA_COUNT][2];
+
+/// Size of the cells of the spatial hash of the lidar points (mm).
+constexpr double LIDAR_COORDS_HASH_CELL_SIZE = 100.0;
+
+/// Number of buckets of the spatial hash of the lidar points, a power of two.
+constexpr std::size_t LIDAR_COORDS_HASH_BUCKETS = 1024;
+static_assert((LIDAR_COORDS_HASH_BUCKETS & (LIDAR_COORDS_HASH_BUCKETS - 1)) == 0, "bucket count must be a power of two");
+
+/// Spatial hash of the points of a lidar_coords slot, built by the converter with the slot.
+/// Each point is stored in the bucket of its cell, several cells may share a bucket:
+/// the indexes of the points of bucket i are points[bucket_starts[i]] to points[bucket_starts[i + 1] - 1].
+typedef struct {
+    double cell_size;  ///< Size of the cells (mm), 0 if the slot has no hash.
+    std::uint16_t bucket_starts[LIDAR_COORDS_HASH_BUCKETS + 1];  ///< Index in points of the first point of each bucket.
+    std::uint16_t points[MAX_LIDAR_DATA_COUNT];  ///< Indexes of the points in the slot, sorted by bucket.
+} lidar_coords_hash_t;
+
+/// Maximum number of cells of the occupancy grid, enough for a 3 m x 2 m table at 10 mm resolution.
+constexpr std::size_t OCCUPANCY_GRID_MAX_CELLS = 65536;
+
+/// Log-odds added to the cell of a lidar point.
+constexpr std::int8_t OCCUPANCY_GRID_HIT = 10;
+
+/// Log-odds added to the cells crossed by the ray to a lidar point.
+constexpr std::int8_t OCCUPANCY_GRID_MISS = -4;
+
+/// Bound of the absolute log-odds of a cell, so a cell left by a moving obstacle is free again after a few scans.
+constexpr std::int8_t OCCUPANCY_GRID_LIMIT = 30;
+
+/// Log-odds above which a cell is occupied, a single scan hitting a free cell does not exceed it.
+constexpr std::int8_t OCCUPANCY_GRID_OCCUPIED = 15;
+
+/// Geometry of the occupancy grid over the table limits.
+typedef struct {
+    double origin_x;           ///< X coordinate of the corner of the first cell (mm).
+    double origin_y;           ///< Y coordinate of the corner of the first cell (mm).
+    double resolution;         ///< Size of a cell (mm).
+    std::uint32_t width;       ///< Number of cells along X, 0 if the grid is disabled.
+    std::uint32_t height;      ///< Number of cells along Y, 0 if the grid is disabled.
+    std::uint64_t timestamp;   ///< CLOCK_MONOTONIC time of the last scan integrated in the grid (ns), 0 if unknown.
+} occupancy_grid_header_t;
+
+/// Occupancy grid built from the lidar points, in log-odds.
+/// Cells are stored by rows along X: the cell of indexes (x, y) is cells[y * width + x].
+typedef struct {
+    occupancy_grid_header_t header;                ///< Geometry of the grid.
+    std::int8_t cells[OCCUPANCY_GRID_MAX_CELLS];   ///< Log-odds of the cells, 0 if unknown.
+} occupancy_grid_t;
+
+/// Triple buffer of lidar data.
+typedef triple_buffer_t<lidar_data_t> lidar_data_buffer_t;
+
+/// Triple buffer of lidar points converted in table coordinates.
+typedef triple_buffer_t<lidar_coords_t> lidar_coords_buffer_t;
+
+/// Pixel formats of the simulated camera frames.
+enum class SimCameraFormat : std::uint32_t {
+    RGBA,    ///< 4 bytes per pixel, the format of the images grabbed by the monitor.
+    RGB,     ///< Packed RGB, 3 bytes per pixel.
+    YUV420,  ///< Planar YUV 4:2:0 (I420, BT.601 limited range): the Y plane, then the U and V planes
+             ///< at half resolution in both directions, 1.5 bytes per pixel.
+};
+
+/// Size of a simulated camera frame in a given pixel format (bytes).
+constexpr std::size_t simCameraFrameSize(SimCameraFormat format)
+{
+    switch (format) {
+    case SimCameraFormat::RGB:
+        return SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT * 3;
+    case SimCameraFormat::YUV420:
+        return SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT * 3 / 2;
+    default:
+        return SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT * 4;
+    }
+}
+
+/// Simulated camera frame, large enough for the RGBA format.
+/// Only the first simCameraFrameSize() bytes of the format of the frame are used.
+typedef std::uint8_t sim_camera_frame_t[SIM_CAMERA_WIDTH * SIM_CAMERA_HEIGHT * 4];
+
+/// Header of a simulated camera frame, written with the sim_camera_frames slot of the same index.
+typedef struct {
+    std::uint64_t sequence;   ///< Number of the frame, starting at 1, 0 if the slot was never published.
+    std::uint64_t timestamp;  ///< CLOCK_MONOTONIC capture time of the frame (ns).
+    SimCameraFormat format;   ///< Pixel format of the frame.
+} sim_camera_frame_header_t;
+
+/// Triple buffer of simulated camera frames.
+typedef triple_buffer_t<sim_camera_frame_t> sim_camera_frame_buffer_t;
+
+/// Simulated camera segment, written by the monitor and read by the camera tools.
+///
+/// The frame of sequence number n is published in the slot n % TRIPLE_BUFFER_SLOTS,
+/// so readers can use the latest frame in place and check afterwards that it was not overwritten.
+typedef struct {
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> requested_format;  ///< SimCameraFormat asked by the reader.
+    alignas(CACHE_LINE_SIZE) sim_camera_frame_header_t headers[TRIPLE_BUFFER_SLOTS];  ///< Header of each slot.
+    alignas(CACHE_LINE_SIZE) sim_camera_frame_buffer_t frames;  ///< Frames.
+} sim_camera_data_t;
+
+/// Number of scans kept in the lidar scan history ring.
+/// Changing it changes the layout of shared_data_t, so SHARED_DATA_VERSION must be incremented too.
+constexpr std::size_t LIDAR_SCAN_HISTORY_SIZE = 8;
+
+/// Scan of the lidar scan history ring.
+typedef struct {
+    alignas(CACHE_LINE_SIZE) seqlock_t seqlock;  ///< Seqlock of the entry, written once per lap of the ring.
+    std::uint64_t sequence;       ///< Sequence number of the scan, 0 if the entry was never written.
+    lidar_scan_header_t header;   ///< Timing of the scan, only the first point_count offsets are valid.
+    lidar_compact_points_t points;  ///< Quantized points, only the first point_count points are valid.
+} lidar_scan_history_entry_t;
+
+/// Ring of the last lidar scans, numbered by a sequence number starting at 1.
+///
+/// The scan of sequence number n is stored in entries[n % LIDAR_SCAN_HISTORY_SIZE] until the driver publishes
+/// the scan n + LIDAR_SCAN_HISTORY_SIZE. Consumers slower than the driver keep reading the older scans
+/// and detect the ones overwritten before they read them from gaps in the sequence numbers.
+/// Points are stored in the compact format, so the ring takes about a third of the size of as many lidar_data slots.
+typedef struct {
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> head;  ///< Sequence number of the last published scan, 0 if none.
+    lidar_scan_history_entry_t entries[LIDAR_SCAN_HISTORY_SIZE];  ///< Scans, indexed by sequence number modulo the size.
+} lidar_scan_history_t;
+
+/// Health counters of a lidar driver, to tell whether a throughput drop comes from the serial link,
+/// the frame decoder or the consumers of the scans.
+///
+/// Each block is written by the driver of one lidar source only, and each counter by a single thread of it,
+/// with relaxed atomic loads and stores: readers see every counter consistent but not the whole set. Counters are cumulated since the driver
+/// started or since the last reset, spin_period, points_per_revolution and last_timestamp describe the last revolution.
+struct alignas(CACHE_LINE_SIZE) lidar_driver_health_t {
+    std::atomic<std::uint64_t> bytes_read;             ///< Bytes read from the serial port.
+    std::atomic<std::uint64_t> packets_ok;             ///< Packets with a valid checksum.
+    std::atomic<std::uint64_t> packets_bad;            ///< Packets dropped because of a checksum error.
+    std::atomic<std::uint64_t> read_timeouts;          ///< Reads which timed out before a complete packet was received.
+    std::atomic<std::uint64_t> revolutions_assembled;  ///< Revolutions published.
+    std::atomic<std::uint64_t> revolutions_dropped;    ///< Revolutions dropped incomplete or never consumed.
+    std::atomic<std::uint64_t> spin_period;            ///< Time between the starts of the last two revolutions (ns), 0 if unknown.
+    std::atomic<std::uint64_t> points_per_revolution;  ///< Points decoded in the last revolution, before filtering.
+    std::atomic<std::uint64_t> max_packet_gap;         ///< Longest time between two valid packets (ns).
+    std::atomic<std::uint64_t> last_timestamp;         ///< CLOCK_MONOTONIC time of the last published revolution (ns), 0 if none.
+};
+
+/// Snapshot of the health counters of a lidar driver, see lidar_driver_health_t.
+typedef struct {
+    std::uint64_t bytes_read;             ///< Bytes read from the serial port.
+    std::uint64_t packets_ok;             ///< Packets with a valid checksum.
+    std::uint64_t packets_bad;            ///< Packets dropped because of a checksum error.
+    std::uint64_t read_timeouts;          ///< Reads which timed out before a complete packet was received.
+    std::uint64_t revolutions_assembled;  ///< Revolutions published.
+    std::uint64_t revolutions_dropped;    ///< Revolutions dropped incomplete or never consumed.
+    double spin_hz;                       ///< Measured spin frequency of the last revolution (Hz), 0 if unknown.
+    std::uint64_t points_per_revolution;  ///< Points decoded in the last revolution, before filtering.
+    std::uint64_t max_packet_gap;         ///< Longest time between two valid packets (ns).
+    std::uint64_t last_timestamp;         ///< CLOCK_MONOTONIC time of the last published revolution (ns), 0 if none.
+} lidar_driver_health_statistics_t;
+
+/// Reads a snapshot of health counters of a lidar driver.
+inline lidar_driver_health_statistics_t readLidarDriverHealth(const lidar_driver_health_t& health) {
+    lidar_driver_health_statistics_t stats{};
+    stats.bytes_read = health.bytes_read.load(std::memory_order_relaxed);
+    stats.packets_ok = health.packets_ok.load(std::memory_order_relaxed);
+    stats.packets_bad = health.packets_bad.load(std::memory_order_relaxed);
+    stats.read_timeouts = health.read_timeouts.load(std::memory_order_relaxed);
+    stats.revolutions_assembled = health.revolutions_assembled.load(std::memory_order_relaxed);
+    stats.revolutions_dropped = health.revolutions_dropped.load(std::memory_order_relaxed);
+    std::uint64_t spin_period = health.spin_period.load(std::memory_order_relaxed);
+    stats.spin_hz = spin_period ? 1e9 / spin_period : 0.0;
+    stats.points_per_revolution = health.points_per_revolution.load(std::memory_order_relaxed);
+    stats.max_packet_gap = health.max_packet_gap.load(std::memory_order_relaxed);
+    stats.last_timestamp = health.last_timestamp.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/// Overloads the stream insertion operator for `lidar_driver_health_statistics_t`.
+/// Prints the statistics in a human-readable format.
 /// @param os The output stream.
-/// @param data The shared data to print.
+/// @param stats The statistics to print.
 /// @return A reference to the output stream.
-inline std::ostream& operator<<(std::ostream& os, const shared_data_t& data) {
-    os << "shared_data_t(size=" << sizeof(shared_data_t) << ")";
+inline std::ostream& operator<<(std::ostream& os, const lidar_driver_health_statistics_t& stats) {
+    os << "lidar_driver_health_statistics_t("
+       << "bytes_read=" << stats.bytes_read << ", "
+       << "packets_ok=" << stats.packets_ok << ", "
+       << "packets_bad=" << stats.packets_bad << ", "
+       << "read_timeouts=" << stats.read_timeouts << ", "
+       << "revolutions_assembled=" << stats.revolutions_assembled << ", "
+       << "revolutions_dropped=" << stats.revolutions_dropped << ", "
+       << "spin_hz=" << stats.spin_hz << ", "
+       << "points_per_revolution=" << stats.points_per_revolution << ", "
+       << "max_packet_gap=" << stats.max_packet_gap << ", "
+       << "last_timestamp=" << stats.last_timestamp
+       << ")";
     return os;
 }
 
+/// Obstacle lists of the planner.
+typedef struct {
+    obstacles::compact_obstacle_circle_list_t circles;      ///< The circle obstacles.
+    obstacles::compact_obstacle_polygon_list_t rectangles;  ///< The rectangle obstacles.
+} planner_obstacles_t;
+
+/// Number of copies of the planner obstacle lists, the published one and the staging one.
+constexpr std::uint32_t PLANNER_OBSTACLES_COPIES = 2;
+
+/// Published and staging copies of the planner obstacle lists.
+///
+/// The planner fills the staging copy without any lock, then publishes it by storing its index,
+/// so readers always find complete lists in the published copy and never wait for the planner.
+/// Each copy has a seqlock: a reader still copying the published lists when the planner starts refilling them,
+/// after its next publication, detects the overwrite and retries on the new published copy.
+typedef struct {
+    std::atomic<std::uint32_t> current;                     ///< Index of the published copy.
+    seqlock_t seqlocks[PLANNER_OBSTACLES_COPIES];           ///< Seqlocks of the copies.
+    alignas(CACHE_LINE_SIZE) planner_obstacles_t copies[PLANNER_OBSTACLES_COPIES];  ///< Copies of the lists.
+} planner_obstacles_buffer_t;
+
+/// Version of avoidance_path, so consumers tell an extended path from a new one without comparing its poses.
+///
+/// The avoidance process only rewrites the poses from first_changed_index, under the AvoidancePath lock.
+/// path_id changes when the first pose changes, or when the path leads to a new pose order:
+/// the robot must then restart toward the first pose, otherwise it keeps following its current target.
+typedef struct {
+    std::uint64_t path_id;  ///< Identifier of the path, 0 if no path was ever published.
+    std::uint32_t first_changed_index;  ///< Index of the first pose written by the last commit, count if poses were only removed.
+    std::atomic<std::uint64_t> commit;  ///< Number of commits of avoidance_path, incremented after each commit.
+} avoidance_path_version_t;
+
 /// Enum representing different locks for shared memory.
 enum class LockName {
     PoseCurrent,  ///< Lock for the pose_current.
@@ -63,12 +340,96 @@ enum class LockName {
     LidarCoords,  ///< Lock for the lidar_coords.
     DetectorObstacles, ///< Lock for the obstacles from detector.
     MonitorObstacles,  ///< Lock for the obstacles from the monitor.
-    Obstacles,    ///< Lock for the circle obstacles from planner.
+    Obstacles,    ///< Lock notifying the publications of the obstacles from planner.
     AvoidanceBlocked,  ///< Lock blocked event from avoidance.
     AvoidancePath,     ///< Lock for the new avoidance path event from avoidance.
-    SimCameraData      ///< Lock for the simulated camera data.
+    SimCameraData      ///< Lock posting the simulated camera frame updates.
 };
 
+/// Number of `LockName` values.
+constexpr std::size_t LOCK_NAME_COUNT = static_cast<std::size_t>(LockName::SimCameraData) + 1;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "generation counters must be lock-free to be shared");
+
+/// Magic number identifying a shared memory segment of cogip tools ("CGIP").
+constexpr std::uint32_t SHARED_DATA_MAGIC = 0x50494743;
+
+/// Version of the shared_data_t layout, to increment on every change of shared_data_t or its members.
+constexpr std::uint32_t SHARED_DATA_VERSION = 19;
+
+/// Header of the shared memory segment, checked by processes opening the segment.
+typedef struct {
+    std::uint32_t magic;    ///< SHARED_DATA_MAGIC.
+    std::uint32_t version;  ///< SHARED_DATA_VERSION.
+    std::uint64_t size;     ///< sizeof(shared_data_t).
+} shared_data_header_t;
+
+/// Generation counter of one shared data region, alone in its cache line.
+struct alignas(CACHE_LINE_SIZE) shared_generation_t {
+    std::atomic<std::uint64_t> value;  ///< Number of writes of the region.
+};
+
+/// Represents shared data in shared memory.
+///
+/// Each group of fields written by the same process at the same rate starts on its own cache line,
+/// so writers do not invalidate the lines read by other processes.
+/// Hot fields come first, large and rarely written fields last.
+/// The simulated camera image, only used in simulation, has its own segment, see SharedMemory::getSimCameraData().
+typedef struct {
+    alignas(CACHE_LINE_SIZE) shared_data_header_t header;  ///< Layout header.
+    shared_generation_t generations[LOCK_NAME_COUNT];  ///< Number of writes of each region, indexed by LockName.
+    lock_state_t locks[LOCK_NAME_COUNT];  ///< State of the lock of each region, indexed by LockName.
+    // Written by copilot
+    alignas(CACHE_LINE_SIZE) models::pose_buffer_t pose_current_buffer;  ///< The last current poses, read without lock.
+    // Written by planner
+    alignas(CACHE_LINE_SIZE) seqlock_t pose_order_seqlock;  ///< Seqlock of pose_order.
+    models::pose_t pose_order;    ///< The target pose.
+    // Written by planner and avoidance
+    alignas(CACHE_LINE_SIZE) bool avoidance_exiting;  ///< True if the avoidance process is exiting, false otherwise
+    bool avoidance_has_new_pose_order;  ///< True if the avoidance process should use the new pose order property, false otherwise
+    bool avoidance_has_pose_order;  ///< True if no pose order has been set by the Planner, false otherwise
+    // Written by planner
+    alignas(CACHE_LINE_SIZE) models::pose_order_t avoidance_new_pose_order;  ///< New pose order for the avoidance process
+    models::pose_order_t avoidance_pose_order;  ///< Current pose order for the avoidance process
+    // Written by avoidance
+    alignas(CACHE_LINE_SIZE) avoidance_path_version_t avoidance_path_version;  ///< Version of avoidance_path.
+    models::pose_order_list_t avoidance_path;  ///< Path for the avoidance process
+    // Written by lidar drivers
+    alignas(CACHE_LINE_SIZE) lidar_data_buffer_t lidar_data;  ///< The Lidar data (angle, distance, intensity).
+    lidar_scan_header_t lidar_scan_headers[TRIPLE_BUFFER_SLOTS];  ///< Timing of each lidar_data slot.
+    lidar_scan_history_t lidar_scan_history;  ///< The last lidar scans, with their timing.
+    lidar_driver_health_t lidar_driver_health[LIDAR_SOURCES_MAX];  ///< Health counters of the driver of each lidar source.
+    // Written by detector
+    alignas(CACHE_LINE_SIZE) lidar_coords_buffer_t lidar_coords;  ///< The Lidar points converted in table coordinates.
+    std::uint32_t lidar_coords_counts[TRIPLE_BUFFER_SLOTS];  ///< Number of points of each lidar_coords slot.
+    lidar_coords_hash_t lidar_coords_hashes[TRIPLE_BUFFER_SLOTS];  ///< Spatial hash of each lidar_coords slot.
+    alignas(CACHE_LINE_SIZE) seqlock_t occupancy_grid_seqlock;  ///< Seqlock of occupancy_grid.
+    occupancy_grid_t occupancy_grid;  ///< Occupancy grid built from the Lidar points.
+    alignas(CACHE_LINE_SIZE) models::circle_list_t detector_obstacles;  ///< The obstacles from detector.
+    // Written by the process running each stage
+    latency_histogram_t latency_histograms[LATENCY_STAGE_COUNT];  ///< Latency of each stage, indexed by LatencyStage.
+    // Written by monitor
+    alignas(CACHE_LINE_SIZE) models::circle_list_t monitor_obstacles;   ///< The obstacles from monitor.
+    // Written by planner
+    alignas(CACHE_LINE_SIZE) planner_obstacles_buffer_t planner_obstacles;  ///< The circle and rectangle obstacles from planner.
+    // Rarely written
+    alignas(CACHE_LINE_SIZE) double table_limits[4];  ///< The limits of the table.
+    alignas(CACHE_LINE_SIZE) seqlock_t properties_seqlock;  ///< Seqlock of properties.
+    shared_properties_t properties;  ///< Shared properties.
+} shared_data_t;
+
+static_assert(alignof(shared_data_t) == CACHE_LINE_SIZE, "shared data regions must be aligned on cache lines");
+
+/// Overloads the stream insertion operator for `shared_data_t`.
+/// Prints the shared data in a human-readable format.
+/// @param os The output stream.
+/// @param data The shared data to print.
+/// @return A reference to the output stream.
+inline std::ostream& operator<<(std::ostream& os, const shared_data_t& data) {
+    os << "shared_data_t(size=" << sizeof(shared_data_t) << ")";
+    return os;
+}
+
 /// Maps `LockName` enum values to their corresponding string representations.
 static std::map<LockName, std::string> lock2str = {
     { LockName::PoseCurrent, "PoseCurrent" },
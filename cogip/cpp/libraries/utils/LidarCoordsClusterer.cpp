@@ -0,0 +1,218 @@
+#include "utils/LidarCoordsClusterer.hpp"
+#include "logger/Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace utils {
+
+namespace {
+
+/// Packs the column and row of a grid cell into a key.
+inline std::uint64_t cellKey(std::int32_t x, std::int32_t y)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+}
+
+} // namespace
+
+LidarCoordsClusterer::LidarCoordsClusterer(const std::string& name):
+    LidarCoordsClusterer(nullptr, std::make_unique<shared_memory::SharedMemory>(name, false))
+{
+}
+
+LidarCoordsClusterer::LidarCoordsClusterer(shared_memory::SharedMemory& shared_memory):
+    LidarCoordsClusterer(&shared_memory, nullptr)
+{
+}
+
+LidarCoordsClusterer::LidarCoordsClusterer(
+    shared_memory::SharedMemory* shared_memory,
+    std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory
+):
+    owned_shared_memory_(std::move(owned_shared_memory)),
+    shared_memory_(shared_memory ? *shared_memory : *owned_shared_memory_),
+    lidar_coords_(shared_memory_.getLidarCoordsBuffer()),
+    detector_obstacles_(*shared_memory_.getDetectorObstacles()),
+    detector_obstacles_lock_(shared_memory_.getLock(shared_memory::LockName::DetectorObstacles)),
+    cluster_eps_(1.0),
+    cluster_min_samples_(1),
+    min_radius_(0.0),
+    track_obstacles_(false),
+    point_count_(0),
+    points_view_(points_.data())
+{
+}
+
+void LidarCoordsClusterer::setClusterEps(double cluster_eps)
+{
+    if (!(cluster_eps > 0)) {
+        throw std::invalid_argument("Cluster eps must be positive");
+    }
+    cluster_eps_ = cluster_eps;
+}
+
+void LidarCoordsClusterer::setTrackObstacles(bool track_obstacles)
+{
+    if (track_obstacles && !track_obstacles_) {
+        tracker_.reset();
+    }
+    track_obstacles_ = track_obstacles;
+}
+
+std::size_t LidarCoordsClusterer::findCell(std::uint64_t key) const
+{
+    // Fibonacci hashing spreads neighbor cells over the table, collisions are resolved by linear probing.
+    std::size_t index = (key * 0x9e3779b97f4a7c15ull) >> (64 - GRID_HASH_BITS);
+    while (cell_heads_[index] >= 0 && cell_keys_[index] != key) {
+        index = (index + 1) & (GRID_HASH_SIZE - 1);
+    }
+    return index;
+}
+
+void LidarCoordsClusterer::buildGrid()
+{
+    cell_heads_.fill(-1);
+    for (std::size_t index = 0; index < point_count_; index++) {
+        cell_x_[index] = static_cast<std::int32_t>(std::floor(points_view_[index][0] / cluster_eps_));
+        cell_y_[index] = static_cast<std::int32_t>(std::floor(points_view_[index][1] / cluster_eps_));
+        std::uint64_t key = cellKey(cell_x_[index], cell_y_[index]);
+        std::size_t cell = findCell(key);
+        cell_keys_[cell] = key;
+        next_in_cell_[index] = cell_heads_[cell];
+        cell_heads_[cell] = static_cast<std::int32_t>(index);
+    }
+}
+
+template <typename Visit>
+void LidarCoordsClusterer::forEachNeighbor(std::size_t index, Visit&& visit) const
+{
+    double x = points_view_[index][0];
+    double y = points_view_[index][1];
+    double max_distance2 = cluster_eps_ * cluster_eps_;
+
+    // Neighbors are at most one cell away since cells are cluster_eps wide.
+    for (std::int32_t dx = -1; dx <= 1; dx++) {
+        for (std::int32_t dy = -1; dy <= 1; dy++) {
+            std::size_t cell = findCell(cellKey(cell_x_[index] + dx, cell_y_[index] + dy));
+            for (std::int32_t other = cell_heads_[cell]; other >= 0; other = next_in_cell_[other]) {
+                double diff_x = points_view_[other][0] - x;
+                double diff_y = points_view_[other][1] - y;
+                if (diff_x * diff_x + diff_y * diff_y <= max_distance2) {
+                    visit(static_cast<std::size_t>(other));
+                }
+            }
+        }
+    }
+}
+
+std::size_t LidarCoordsClusterer::cluster()
+{
+    // Read the latest complete lidar coords, the copy restarts if the converter overwrites them meanwhile.
+    std::size_t count = 0;
+    shared_memory::tripleBufferRead(lidar_coords_, [&](const shared_memory::lidar_coords_t& lidar_coords) {
+        count = std::min<std::size_t>(
+            shared_memory_.getLidarCoordsCount(lidar_coords), shared_memory::MAX_LIDAR_DATA_COUNT - 1
+        );
+        std::memcpy(points_.data(), lidar_coords, count * sizeof(lidar_coords[0]));
+    });
+
+    return cluster(points_.data(), count);
+}
+
+std::size_t LidarCoordsClusterer::cluster(const double (*points)[2], std::size_t count, std::uint64_t timestamp)
+{
+    COGIP_TRACE_SPAN("LidarCoordsClusterer::cluster");
+    // The points are the last published coords, in fused mode the coords just published by the caller.
+    shared_memory::latency_frame_t latency_frame = shared_memory_.readLatencyFrame(shared_memory::LatencyStage::LidarCoords);
+    points_view_ = points;
+    point_count_ = std::min(count, shared_memory::MAX_LIDAR_DATA_COUNT);
+    buildGrid();
+
+    for (std::size_t index = 0; index < point_count_; index++) {
+        std::size_t neighbor_count = 0;
+        forEachNeighbor(index, [&](std::size_t) { neighbor_count++; });
+        core_[index] = neighbor_count >= cluster_min_samples_;
+        labels_[index] = CLUSTER_NOISE;
+    }
+
+    // Each cluster grows from its first core point to the neighbors of all its core points.
+    // Its bounds and the sum of its points are accumulated meanwhile to get its circle.
+    std::size_t cluster_count = 0;
+    for (std::size_t seed = 0; seed < point_count_; seed++) {
+        if (!core_[seed] || labels_[seed] != CLUSTER_NOISE) {
+            continue;
+        }
+
+        std::int32_t label = static_cast<std::int32_t>(cluster_count);
+        std::size_t size = 0;
+        double sum_x = 0, sum_y = 0;
+        double min_x = points_view_[seed][0], max_x = min_x;
+        double min_y = points_view_[seed][1], max_y = min_y;
+        auto add = [&](std::size_t index) {
+            labels_[index] = label;
+            size++;
+            sum_x += points_view_[index][0];
+            sum_y += points_view_[index][1];
+            min_x = std::min(min_x, points_view_[index][0]);
+            max_x = std::max(max_x, points_view_[index][0]);
+            min_y = std::min(min_y, points_view_[index][1]);
+            max_y = std::max(max_y, points_view_[index][1]);
+        };
+
+        // Points are labeled when pushed, so each one is pushed at most once.
+        std::size_t stack_size = 0;
+        add(seed);
+        expansion_stack_[stack_size++] = static_cast<std::int32_t>(seed);
+        while (stack_size > 0) {
+            std::size_t index = expansion_stack_[--stack_size];
+            forEachNeighbor(index, [&](std::size_t neighbor) {
+                if (labels_[neighbor] == CLUSTER_NOISE) {
+                    add(neighbor);
+                    if (core_[neighbor]) {
+                        expansion_stack_[stack_size++] = static_cast<std::int32_t>(neighbor);
+                    }
+                }
+            });
+        }
+
+        models::circle_t& circle = circles_[cluster_count++];
+        circle.x = sum_x / size;
+        circle.y = sum_y / size;
+        circle.radius = std::max({max_x - circle.x, circle.x - min_x, max_y - circle.y, circle.y - min_y, min_radius_});
+    }
+
+    if (track_obstacles_) {
+        if (timestamp == 0) {
+            timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count();
+        }
+        tracker_.update(circles_.data(), cluster_count, timestamp);
+    }
+
+    detector_obstacles_lock_.startWriting();
+    detector_obstacles_.clear();
+    if (track_obstacles_) {
+        tracker_.write(detector_obstacles_);
+    }
+    else {
+        for (std::size_t index = 0; index < cluster_count; index++) {
+            detector_obstacles_.append(circles_[index].x, circles_[index].y, circles_[index].radius);
+        }
+    }
+    detector_obstacles_lock_.finishWriting();
+    detector_obstacles_lock_.postUpdate();
+    shared_memory_.stampLatency(shared_memory::LatencyStage::DetectorObstacles, latency_frame);
+
+    return cluster_count;
+}
+
+} // namespace utils
+
+} // namespace cogip
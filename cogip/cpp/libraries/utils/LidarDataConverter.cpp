@@ -1,26 +1,138 @@
 #include "utils/LidarDataConverter.hpp"
+#include "utils/trigonometry.hpp"
+#include "shared_memory/LidarCoordsHash.hpp"
+#include "logger/Trace.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
 
 namespace cogip {
 
 namespace utils {
 
+namespace {
+
+/// Resolution of the sin/cos table (deg).
+constexpr double SIN_COS_TABLE_STEP = 0.1;
+
+/// Number of steps of the sin/cos table over a full turn.
+constexpr std::size_t SIN_COS_TABLE_SIZE = 3600;
+
+/// Sin/cos table over a full turn, with one more entry to interpolate the last step without wrapping.
+struct SinCosTable {
+    SinCosTable() {
+        for (std::size_t i = 0; i <= SIN_COS_TABLE_SIZE; i++) {
+            double angle_rad = DEG2RAD(i * SIN_COS_TABLE_STEP);
+            cos_values[i] = std::cos(angle_rad);
+            sin_values[i] = std::sin(angle_rad);
+        }
+    }
+
+    std::array<double, SIN_COS_TABLE_SIZE + 1> cos_values;
+    std::array<double, SIN_COS_TABLE_SIZE + 1> sin_values;
+};
+
+const SinCosTable sin_cos_table;
+
+/// Compute the cosine and sine of an angle by linear interpolation in the sin/cos table.
+/// The error is below 4e-7, that is under 2 µm at 4 m, far below the lidar accuracy.
+/// @param angle Angle (deg), in any range.
+inline void sinCosDeg(double angle, double& cos_angle, double& sin_angle)
+{
+    double position = (angle - 360.0 * std::floor(angle / 360.0)) / SIN_COS_TABLE_STEP;
+    std::size_t index = std::min(static_cast<std::size_t>(position), SIN_COS_TABLE_SIZE - 1);
+    double fraction = position - index;
+    cos_angle = sin_cos_table.cos_values[index] + fraction * (sin_cos_table.cos_values[index + 1] - sin_cos_table.cos_values[index]);
+    sin_angle = sin_cos_table.sin_values[index] + fraction * (sin_cos_table.sin_values[index + 1] - sin_cos_table.sin_values[index]);
+}
+
+/// Marks an empty slot of the voxel hash table.
+constexpr std::uint32_t VOXEL_EMPTY = UINT32_MAX;
+
+/// Number of bits of the voxel hash table indexes.
+constexpr unsigned VOXEL_TABLE_BITS = 11;
+static_assert(std::size_t(1) << VOXEL_TABLE_BITS == LIDAR_VOXEL_TABLE_SIZE);
+static_assert(LIDAR_VOXEL_TABLE_SIZE >= 2 * shared_memory::MAX_LIDAR_DATA_COUNT);
+
+/// Normalize an angle to [0, 360) (deg).
+inline double normalizeDeg(double angle)
+{
+    return angle - 360.0 * std::floor(angle / 360.0);
+}
+
+/// Current CLOCK_MONOTONIC time in nanoseconds.
+std::uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/// Adds a duration to a total and updates the maximum.
+void record_duration(std::atomic<std::uint64_t>& total, std::atomic<std::uint64_t>& max, std::uint64_t duration)
+{
+    total.fetch_add(duration, std::memory_order_relaxed);
+    std::uint64_t current = max.load(std::memory_order_relaxed);
+    while (duration > current && !max.compare_exchange_weak(current, duration, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
 LidarDataConverter::LidarDataConverter(const std::string& name):
-    shared_memory_(shared_memory::SharedMemory(name, false)),
-    lidar_data_(shared_memory_.getData()->lidar_data),
-    lidar_coords_(shared_memory_.getData()->lidar_coords),
+    LidarDataConverter(nullptr, std::make_unique<shared_memory::SharedMemory>(name, false))
+{
+}
+
+LidarDataConverter::LidarDataConverter(shared_memory::SharedMemory& shared_memory):
+    LidarDataConverter(&shared_memory, nullptr)
+{
+}
+
+LidarDataConverter::LidarDataConverter(
+    shared_memory::SharedMemory* shared_memory,
+    std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory
+):
+    owned_shared_memory_(std::move(owned_shared_memory)),
+    shared_memory_(shared_memory ? *shared_memory : *owned_shared_memory_),
+    lidar_data_(shared_memory_.getLidarDataBuffer()),
+    lidar_coords_(shared_memory_.getLidarCoordsBuffer()),
     data_read_lock_(shared_memory_.getLock(shared_memory::LockName::LidarData)),
     coords_write_lock_(shared_memory_.getLock(shared_memory::LockName::LidarCoords)),
-    pose_current_buffer_(shared_memory_.getPoseCurrentBuffer()),
     pose_current_index_(0),
+    compact_input_(false),
+    deskew_(false),
+    deskew_block_duration_(0),
+    cluster_obstacles_(false),
+    clusterer_(shared_memory_),
+    occupancy_grid_enabled_(false),
+    occupancy_filter_(false),
+    occupancy_grid_resolution_(10.0),
+    occupancy_grid_reset_resolution_(10.0),
+    occupancy_grid_limits_{0.0, 0.0, 0.0, 0.0},
     table_limits_(shared_memory_.getTableLimits()),
     table_limits_margin_(0.0f),
-    lidar_offset_x_(0.0f),
-    lidar_offset_y_(0.0f),
+    lidar_extrinsics_{},
+    lidar_source_count_(1),
+    merge_max_age_(LIDAR_MERGE_DEFAULT_MAX_AGE),
+    history_reader_(shared_memory_),
+    angle_roi_counts_{},
+    decimation_min_distance_(0.0),
+    decimation_spacing_(0.0),
+    voxel_size_(0.0),
     running_(false),
-    debug_(false)
+    debug_(false),
+    scan_segment_count_(0)
 {
+    for (source_scan_t& source_scan : source_scans_) {
+        source_scan.valid = false;
+    }
+    occupancy_grid_.header = {0.0, 0.0, occupancy_grid_resolution_, 0, 0, 0};
+    resetStatistics();
     data_read_lock_.registerConsumer();
 }
 
@@ -32,102 +144,631 @@ LidarDataConverter::~LidarDataConverter()
 void LidarDataConverter::start()
 {
     if (debug_) std::cout << "LidarDataConverter: starting..." << std::endl;
-    if (running_) {
+    if (running_.exchange(true)) {
         return; // Already running
     }
 
-    running_ = true;
     thread_ = std::thread([this]() {
-        while (running_) {
-            convert(); // Call the convert function
+        while (running_.load(std::memory_order_relaxed)) {
+            convert(LIDAR_DATA_CONVERTER_WAIT_TIMEOUT);
         }
     });
+    tryApplyThreadConfig(thread_.native_handle(), thread_config_);
+}
+
+void LidarDataConverter::setThreadConfig(const thread_config_t& config)
+{
+    checkThreadConfig(config);
+    thread_config_ = config;
+    if (running_.load(std::memory_order_relaxed) && thread_.joinable()) {
+        applyThreadConfig(thread_.native_handle(), thread_config_);
+    }
 }
 
 void LidarDataConverter::stop()
 {
     if (debug_) std::cout << "LidarDataConverter: stopping..." << std::endl;
-    if (!running_) {
+    if (!running_.exchange(false)) {
         return; // Already stopped
     }
     if (debug_) std::cout << "LidarDataConverter: stopping thread..." << std::endl;
-    running_ = false;
     if (thread_.joinable()) {
         if (debug_) std::cout << "LidarDataConverter: joining thread..." << std::endl;
-        data_read_lock_.postUpdate(); // Notify the thread to stop waiting for data
-        thread_.join(); // Wait for the thread to finish
+        thread_.join(); // Wait for the thread to finish, at the latest after its wait timeout
     }
     if (debug_) std::cout << "LidarDataConverter: thread stopped" << std::endl;
 }
 
-void LidarDataConverter::convert()
+std::size_t LidarDataConverter::copyScan()
 {
-    if (debug_) std::cout << "LidarDataConverter: waiting for data..." << std::endl;
-    data_read_lock_.waitUpdate();
-    if (debug_) std::cout << "LidarDataConverter: data updated" << std::endl;
+    std::size_t count = 0;
 
-    // Convert points to global coordinates based on lidar position
-    cogip::models::Pose pose_current = pose_current_buffer_->get(pose_current_index_);
-    double pose_current_x = pose_current.x();
-    double pose_current_y = pose_current.y();
-    double pose_current_angle = pose_current.angle();
+    // Read the latest complete scan, the copy restarts if the lidar driver overwrites it meanwhile.
+    // Only the copy runs inside the read, so the driver is much less likely to overwrite the slot.
+    shared_memory::tripleBufferRead(lidar_data_, [&](const shared_memory::lidar_data_t& lidar_data) {
+        const shared_memory::lidar_scan_header_t& header = shared_memory_.getLidarScanHeader(lidar_data);
+        count = std::min<std::size_t>(header.point_count, shared_memory::MAX_LIDAR_DATA_COUNT - 1);
+        for (std::size_t index = 0; index < count; index++) {
+            scan_angles_[index] = lidar_data[index][0];
+            scan_distances_[index] = lidar_data[index][1];
+        }
 
-    std::size_t index = 0;
-    std::size_t count = 0;
+        scan_header_.start_timestamp = header.start_timestamp;
+        scan_header_.end_timestamp = header.end_timestamp;
+        scan_header_.point_count = static_cast<std::uint32_t>(count);
+        scan_header_.source = header.source;
+        std::memcpy(scan_header_.point_offsets, header.point_offsets, count * sizeof(std::uint32_t));
+    });
 
-    if (debug_) std::cout << "LidarDataConverter: locking write lock..." << std::endl;
-    coords_write_lock_.startWriting();
-    if (debug_) std::cout << "LidarDataConverter: write lock locked" << std::endl;
+    return count;
+}
 
-    // Iterate over the entire Lidar data
+std::size_t LidarDataConverter::copyCompactScan()
+{
+    // The latest scan is overwritten only after LIDAR_SCAN_HISTORY_SIZE publications, the copy hardly ever restarts.
     while (true) {
-        if (lidar_data_[index][0] < 0) {
+        std::uint64_t sequence = shared_memory_.getLidarScanHistoryHead();
+        if (sequence == 0) {
+            scan_header_.start_timestamp = 0;
+            scan_header_.end_timestamp = 0;
+            scan_header_.point_count = 0;
+            return 0;
+        }
+        if (shared_memory_.readLidarScanHistory(sequence, compact_points_, scan_header_)) {
             break;
         }
-        double angle = lidar_data_[index][0];
-        double distance = lidar_data_[index][1];
-        double intensity = lidar_data_[index][2];
+    }
 
-        // Convert Lidar-relative polar to Cartesian
-        double angle_rad = DEG2RAD(angle);
-        double lidar_relative_x = distance * std::cos(angle_rad);
-        double lidar_relative_y = distance * std::sin(angle_rad);
+    std::size_t count = scan_header_.point_count;
+    for (std::size_t index = 0; index < count; index++) {
+        scan_angles_[index] = compact_points_.angles[index] * shared_memory::LIDAR_COMPACT_ANGLE_UNIT;
+        scan_distances_[index] = compact_points_.distances[index] * shared_memory::LIDAR_COMPACT_DISTANCE_UNIT;
+    }
+    return count;
+}
 
-        // Translate point from lidar-centric to robot-centric coordinates
-        double robot_relative_x = lidar_relative_x + lidar_offset_x_;
-        double robot_relative_y = lidar_relative_y + lidar_offset_y_;
+std::size_t LidarDataConverter::copyMergedScans()
+{
+    // Scans coalesced by the wait are still in the history, only the latest scan of each lidar is kept.
+    while (history_reader_.readNext(compact_points_, scan_header_)) {
+        if (scan_header_.source >= lidar_source_count_) {
+            continue;
+        }
+        source_scan_t& source_scan = source_scans_[scan_header_.source];
+        std::size_t count = scan_header_.point_count;
+        source_scan.header.start_timestamp = scan_header_.start_timestamp;
+        source_scan.header.end_timestamp = scan_header_.end_timestamp;
+        source_scan.header.point_count = scan_header_.point_count;
+        source_scan.header.source = scan_header_.source;
+        std::memcpy(source_scan.header.point_offsets, scan_header_.point_offsets, count * sizeof(std::uint32_t));
+        std::memcpy(source_scan.points.angles, compact_points_.angles, count * sizeof(compact_points_.angles[0]));
+        std::memcpy(source_scan.points.distances, compact_points_.distances, count * sizeof(compact_points_.distances[0]));
+        source_scan.valid = true;
+    }
+    dropped_scans_.fetch_add(history_reader_.droppedCount(), std::memory_order_relaxed);
+    history_reader_.resetDroppedCount();
 
-        // Convert robot angle to radians
-        double robot_angle_rad = DEG2RAD(pose_current_angle);
+    std::uint64_t latest_end = 0;
+    for (std::size_t source = 0; source < lidar_source_count_; source++) {
+        if (source_scans_[source].valid) {
+            latest_end = std::max(latest_end, source_scans_[source].header.end_timestamp);
+        }
+    }
 
-        // Apply rotation based on robot's angle
-        double global_x = pose_current_x + (
-            robot_relative_x * std::cos(robot_angle_rad) - robot_relative_y * std::sin(robot_angle_rad)
-        );
-        double global_y = pose_current_y + (
-            robot_relative_x * std::sin(robot_angle_rad) + robot_relative_y * std::cos(robot_angle_rad)
-        );
+    // Each lidar fills a segment of the scan buffers, the merged header only keeps the overall timing.
+    std::size_t count = 0;
+    std::uint64_t dropped = 0;
+    scan_header_.start_timestamp = 0;
+    scan_header_.end_timestamp = latest_end;
+    scan_segment_count_ = 0;
+    for (std::size_t source = 0; source < lidar_source_count_; source++) {
+        const source_scan_t& source_scan = source_scans_[source];
+        const shared_memory::lidar_scan_header_t& header = source_scan.header;
+        if (!source_scan.valid || (header.end_timestamp != 0 && header.end_timestamp + merge_max_age_ < latest_end)) {
+            continue;
+        }
+        std::size_t source_count = std::min<std::size_t>(header.point_count, shared_memory::MAX_LIDAR_DATA_COUNT - 1 - count);
+        dropped += header.point_count - source_count;
+        for (std::size_t index = 0; index < source_count; index++) {
+            scan_angles_[count + index] = source_scan.points.angles[index] * shared_memory::LIDAR_COMPACT_ANGLE_UNIT;
+            scan_distances_[count + index] = source_scan.points.distances[index] * shared_memory::LIDAR_COMPACT_DISTANCE_UNIT;
+        }
+        scan_segments_[scan_segment_count_++] = {count, count + source_count, source, &header};
+        count += source_count;
+        if (header.start_timestamp != 0 && (scan_header_.start_timestamp == 0 || header.start_timestamp < scan_header_.start_timestamp)) {
+            scan_header_.start_timestamp = header.start_timestamp;
+        }
+    }
+    scan_header_.point_count = static_cast<std::uint32_t>(count);
+    scan_header_.source = 0;
+    if (dropped) {
+        merged_points_dropped_.fetch_add(dropped, std::memory_order_relaxed);
+    }
+    return count;
+}
 
-        // Filter points near the borders or outside the table
-        if ((table_limits_[0] + table_limits_margin_ < global_x &&
-            global_x < table_limits_[1] - table_limits_margin_) &&
-            (table_limits_[2] + table_limits_margin_ < global_y &&
-            global_y < table_limits_[3] - table_limits_margin_)
-        ) {
-            lidar_coords_[count][0] = global_x;
-            lidar_coords_[count][1] = global_y;
+std::size_t LidarDataConverter::filterSegments()
+{
+    // Kept points are moved down in place, each segment starts where the previous one ends.
+    std::size_t count = 0;
+    std::size_t dropped = 0;
+    for (std::size_t segment_index = 0; segment_index < scan_segment_count_; segment_index++) {
+        scan_segment_t& segment = scan_segments_[segment_index];
+        const shared_memory::lidar_scan_header_t& header = *segment.header;
+        const std::array<lidar_angle_roi_t, LIDAR_ANGLE_ROIS_MAX>& rois = angle_rois_[segment.source];
+        std::size_t roi_count = angle_roi_counts_[segment.source];
+        std::size_t begin = count;
+        double last_angle = 0.0;
+        double last_distance = 0.0;
+        for (std::size_t index = segment.begin; index < segment.end; index++) {
+            double angle = scan_angles_[index];
+            double distance = scan_distances_[index];
+            if (roi_count) {
+                double normalized_angle = normalizeDeg(angle);
+                bool inside = false;
+                for (std::size_t roi_index = 0; roi_index < roi_count && !inside; roi_index++) {
+                    const lidar_angle_roi_t& roi = rois[roi_index];
+                    inside = roi.min_angle <= roi.max_angle
+                        ? (roi.min_angle <= normalized_angle && normalized_angle <= roi.max_angle)
+                        : (roi.min_angle <= normalized_angle || normalized_angle <= roi.max_angle);
+                }
+                if (!inside) {
+                    continue;
+                }
+            }
+            if (decimation_spacing_ > 0 && count > begin
+                && distance > decimation_min_distance_ && last_distance > decimation_min_distance_
+                && DEG2RAD(std::abs(angle - last_angle)) * distance < decimation_spacing_
+                && std::abs(distance - last_distance) < decimation_spacing_) {
+                continue;
+            }
+            scan_angles_[count] = angle;
+            scan_distances_[count] = distance;
+            scan_offsets_[count] = header.point_offsets[index - segment.begin];
+            last_angle = angle;
+            last_distance = distance;
             count++;
         }
-        index++;
+        dropped += (segment.end - segment.begin) - (count - begin);
+        segment.begin = begin;
+        segment.end = count;
+    }
+    if (dropped) {
+        points_filtered_.fetch_add(dropped, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+std::size_t LidarDataConverter::downsample(shared_memory::lidar_coords_t& lidar_coords, std::size_t count)
+{
+    // The centroid of each voxel replaces the points at the place of its first point, so the order is kept.
+    voxel_slots_.fill(VOXEL_EMPTY);
+    std::size_t voxel_count = 0;
+    for (std::size_t index = 0; index < count; index++) {
+        double x = lidar_coords[index][0];
+        double y = lidar_coords[index][1];
+        auto cell_x = static_cast<std::int64_t>(std::floor(x / voxel_size_));
+        auto cell_y = static_cast<std::int64_t>(std::floor(y / voxel_size_));
+        std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell_x)) << 32)
+            | static_cast<std::uint32_t>(cell_y);
+
+        // The table has at least twice more slots than points, the probe always ends.
+        std::size_t slot = (key * 0x9E3779B97F4A7C15ull) >> (64 - VOXEL_TABLE_BITS);
+        while (voxel_slots_[slot] != VOXEL_EMPTY && voxel_keys_[slot] != key) {
+            slot = (slot + 1) & (LIDAR_VOXEL_TABLE_SIZE - 1);
+        }
+        if (voxel_slots_[slot] == VOXEL_EMPTY) {
+            voxel_keys_[slot] = key;
+            voxel_slots_[slot] = static_cast<std::uint32_t>(voxel_count);
+            voxel_sum_x_[voxel_count] = x;
+            voxel_sum_y_[voxel_count] = y;
+            voxel_counts_[voxel_count] = 1;
+            voxel_count++;
+        }
+        else {
+            std::uint32_t voxel = voxel_slots_[slot];
+            voxel_sum_x_[voxel] += x;
+            voxel_sum_y_[voxel] += y;
+            voxel_counts_[voxel]++;
+        }
+    }
+
+    for (std::size_t voxel = 0; voxel < voxel_count; voxel++) {
+        lidar_coords[voxel][0] = voxel_sum_x_[voxel] / voxel_counts_[voxel];
+        lidar_coords[voxel][1] = voxel_sum_y_[voxel] / voxel_counts_[voxel];
+    }
+    points_downsampled_.fetch_add(count - voxel_count, std::memory_order_relaxed);
+    return voxel_count;
+}
+
+void LidarDataConverter::polarToCartesian(std::size_t begin, std::size_t end, double angle)
+{
+    // Lidar-relative coordinates do not depend on the robot pose, they are computed once per scan.
+    for (std::size_t index = begin; index < end; index++) {
+        double cos_angle, sin_angle;
+        sinCosDeg(scan_angles_[index] + angle, cos_angle, sin_angle);
+        scan_x_[index] = scan_distances_[index] * cos_angle;
+        scan_y_[index] = scan_distances_[index] * sin_angle;
     }
-    lidar_coords_[count][0] = -1.0;  // Mark as end of data
-    lidar_coords_[count][1] = -1.0;
-    lidar_coords_[count][2] = -1.0;
+}
+
+void LidarDataConverter::transformBlock(std::size_t begin, std::size_t end, const cogip::models::pose_t& pose,
+                                        const lidar_extrinsics_t& extrinsics)
+{
+    // The robot rotation and the rotated lidar offset are the same for all points of the block.
+    double robot_angle_rad = DEG2RAD(pose.angle);
+    double cos_robot = std::cos(robot_angle_rad);
+    double sin_robot = std::sin(robot_angle_rad);
+    double origin_x = pose.x + extrinsics.offset_x * cos_robot - extrinsics.offset_y * sin_robot;
+    double origin_y = pose.y + extrinsics.offset_x * sin_robot + extrinsics.offset_y * cos_robot;
 
-    if (debug_) std::cout << "LidarDataConverter: unlock write lock" << std::endl;
-    coords_write_lock_.finishWriting();
+    for (std::size_t index = begin; index < end; index++) {
+        scan_origin_x_[index] = origin_x;
+        scan_origin_y_[index] = origin_y;
+        double lidar_relative_x = scan_x_[index];
+        double lidar_relative_y = scan_y_[index];
+        scan_x_[index] = origin_x + lidar_relative_x * cos_robot - lidar_relative_y * sin_robot;
+        scan_y_[index] = origin_y + lidar_relative_x * sin_robot + lidar_relative_y * cos_robot;
+    }
+}
+
+void LidarDataConverter::setLidarSourceCount(std::size_t count)
+{
+    if (count == 0 || count > shared_memory::LIDAR_SOURCES_MAX) {
+        throw std::invalid_argument(
+            "Lidar source count must be between 1 and " + std::to_string(shared_memory::LIDAR_SOURCES_MAX)
+        );
+    }
+    if (count > 1 && lidar_source_count_ == 1) {
+        // Scans published before the merge was enabled are not merged.
+        history_reader_.skipToLatest();
+        for (source_scan_t& source_scan : source_scans_) {
+            source_scan.valid = false;
+        }
+    }
+    lidar_source_count_ = count;
+}
+
+void LidarDataConverter::setLidarExtrinsics(std::size_t source, double offset_x, double offset_y, double angle)
+{
+    if (source >= shared_memory::LIDAR_SOURCES_MAX) {
+        throw std::invalid_argument("Lidar source must be below " + std::to_string(shared_memory::LIDAR_SOURCES_MAX));
+    }
+    lidar_extrinsics_[source] = {offset_x, offset_y, angle};
+}
+
+lidar_extrinsics_t LidarDataConverter::getLidarExtrinsics(std::size_t source) const
+{
+    if (source >= shared_memory::LIDAR_SOURCES_MAX) {
+        throw std::invalid_argument("Lidar source must be below " + std::to_string(shared_memory::LIDAR_SOURCES_MAX));
+    }
+    return lidar_extrinsics_[source];
+}
+
+void LidarDataConverter::addAngleRoi(std::size_t source, double min_angle, double max_angle)
+{
+    if (source >= shared_memory::LIDAR_SOURCES_MAX) {
+        throw std::invalid_argument("Lidar source must be below " + std::to_string(shared_memory::LIDAR_SOURCES_MAX));
+    }
+    if (angle_roi_counts_[source] >= LIDAR_ANGLE_ROIS_MAX) {
+        throw std::invalid_argument("A lidar has at most " + std::to_string(LIDAR_ANGLE_ROIS_MAX) + " angle ROIs");
+    }
+    // The region is written before it is counted, so the converter thread never reads it half written.
+    angle_rois_[source][angle_roi_counts_[source]] = {normalizeDeg(min_angle), normalizeDeg(max_angle)};
+    angle_roi_counts_[source]++;
+}
+
+void LidarDataConverter::clearAngleRois(std::size_t source)
+{
+    if (source >= shared_memory::LIDAR_SOURCES_MAX) {
+        throw std::invalid_argument("Lidar source must be below " + std::to_string(shared_memory::LIDAR_SOURCES_MAX));
+    }
+    angle_roi_counts_[source] = 0;
+}
+
+void LidarDataConverter::setDecimation(double min_distance, double spacing)
+{
+    if (!(min_distance >= 0 && spacing >= 0)) {
+        throw std::invalid_argument("Decimation min distance and spacing must not be negative");
+    }
+    decimation_min_distance_ = min_distance;
+    decimation_spacing_ = spacing;
+}
+
+void LidarDataConverter::setVoxelSize(double voxel_size)
+{
+    if (!(voxel_size >= 0)) {
+        throw std::invalid_argument("Voxel size must not be negative");
+    }
+    voxel_size_ = voxel_size;
+}
+
+void LidarDataConverter::setOccupancyGridResolution(double resolution)
+{
+    if (!(resolution > 0)) {
+        throw std::invalid_argument("Occupancy grid resolution must be positive");
+    }
+    occupancy_grid_resolution_ = resolution;
+}
+
+void LidarDataConverter::resetOccupancyGrid()
+{
+    shared_memory::occupancy_grid_header_t& header = occupancy_grid_.header;
+    std::copy(table_limits_, table_limits_ + 4, occupancy_grid_limits_);
+    occupancy_grid_reset_resolution_ = occupancy_grid_resolution_;
+    header.origin_x = occupancy_grid_limits_[0];
+    header.origin_y = occupancy_grid_limits_[2];
+    header.resolution = occupancy_grid_resolution_;
+    header.width = 0;
+    header.height = 0;
+    header.timestamp = 0;
+
+    double size_x = occupancy_grid_limits_[1] - occupancy_grid_limits_[0];
+    double size_y = occupancy_grid_limits_[3] - occupancy_grid_limits_[2];
+    if (!(size_x > 0 && size_y > 0)) {
+        return;  // Table limits not set yet
+    }
+
+    // Coarsen the cells until the table fits in the grid.
+    header.resolution = std::max(header.resolution, std::sqrt(size_x * size_y / shared_memory::OCCUPANCY_GRID_MAX_CELLS));
+    while (std::ceil(size_x / header.resolution) * std::ceil(size_y / header.resolution) > shared_memory::OCCUPANCY_GRID_MAX_CELLS) {
+        header.resolution *= 1.01;
+    }
+    header.width = static_cast<std::uint32_t>(std::ceil(size_x / header.resolution));
+    header.height = static_cast<std::uint32_t>(std::ceil(size_y / header.resolution));
+    std::fill_n(occupancy_grid_.cells, header.width * header.height, 0);
+}
+
+void LidarDataConverter::updateOccupancyGrid(std::size_t count)
+{
+    if (!std::equal(table_limits_, table_limits_ + 4, occupancy_grid_limits_)
+        || occupancy_grid_.header.width == 0
+        || occupancy_grid_reset_resolution_ != occupancy_grid_resolution_) {
+        resetOccupancyGrid();
+    }
+
+    const shared_memory::occupancy_grid_header_t& header = occupancy_grid_.header;
+    std::fill_n(scan_occupied_.begin(), count, false);
+    if (header.width == 0) {
+        return;
+    }
+
+    const std::int32_t width = static_cast<std::int32_t>(header.width);
+    const std::int32_t height = static_cast<std::int32_t>(header.height);
+    auto cellOf = [&](double x, double y, std::int32_t& cell_x, std::int32_t& cell_y) {
+        // Clamp before the cast, so far points do not overflow
+        cell_x = static_cast<std::int32_t>(std::floor(std::clamp((x - header.origin_x) / header.resolution, -1.0, double(width))));
+        cell_y = static_cast<std::int32_t>(std::floor(std::clamp((y - header.origin_y) / header.resolution, -1.0, double(height))));
+        return cell_x >= 0 && cell_x < width && cell_y >= 0 && cell_y < height;
+    };
+
+    // Clear the cells crossed by the rays first, so a ray grazing an obstacle
+    // does not cancel the hit of another point of the same scan.
+    for (std::size_t index = 0; index < count; index++) {
+        std::int32_t end_x, end_y;
+        if (!cellOf(scan_x_[index], scan_y_[index], end_x, end_y)) {
+            continue;
+        }
+        std::int32_t x, y;
+        cellOf(scan_origin_x_[index], scan_origin_y_[index], x, y);
+
+        // Bresenham line from the lidar cell to the point cell, excluded.
+        std::int32_t delta_x = std::abs(end_x - x), step_x = x < end_x ? 1 : -1;
+        std::int32_t delta_y = -std::abs(end_y - y), step_y = y < end_y ? 1 : -1;
+        std::int32_t error = delta_x + delta_y;
+        while (x != end_x || y != end_y) {
+            if (x >= 0 && x < width && y >= 0 && y < height) {
+                std::int8_t& cell = occupancy_grid_.cells[y * width + x];
+                cell = static_cast<std::int8_t>(std::max(cell + shared_memory::OCCUPANCY_GRID_MISS, -shared_memory::OCCUPANCY_GRID_LIMIT));
+            }
+            std::int32_t error2 = 2 * error;
+            if (error2 >= delta_y) {
+                error += delta_y;
+                x += step_x;
+            }
+            if (error2 <= delta_x) {
+                error += delta_x;
+                y += step_y;
+            }
+        }
+    }
+
+    for (std::size_t index = 0; index < count; index++) {
+        std::int32_t x, y;
+        if (!cellOf(scan_x_[index], scan_y_[index], x, y)) {
+            continue;
+        }
+        std::int8_t& cell = occupancy_grid_.cells[y * width + x];
+        cell = static_cast<std::int8_t>(std::min(cell + shared_memory::OCCUPANCY_GRID_HIT, +shared_memory::OCCUPANCY_GRID_LIMIT));
+    }
+
+    // Flag the points once all hits are added, so points of the same cell are flagged the same.
+    for (std::size_t index = 0; index < count; index++) {
+        std::int32_t x, y;
+        if (cellOf(scan_x_[index], scan_y_[index], x, y)) {
+            scan_occupied_[index] = occupancy_grid_.cells[y * width + x] > shared_memory::OCCUPANCY_GRID_OCCUPIED;
+        }
+    }
+    occupancy_grid_.header.timestamp = scan_header_.end_timestamp;
+}
+
+bool LidarDataConverter::convert(double timeout_seconds)
+{
+    COGIP_TRACE_SPAN("LidarDataConverter::convert");
+    if (debug_) std::cout << "LidarDataConverter: waiting for data..." << std::endl;
+    if (!data_read_lock_.waitUpdate(timeout_seconds)) {
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+        if (debug_) std::cout << "LidarDataConverter: timed out" << std::endl;
+        return false;
+    }
+    std::uint64_t update_time = now_ns();
+    if (debug_) std::cout << "LidarDataConverter: data updated" << std::endl;
+
+    // Convert points to global coordinates based on lidar position
+    // The seqlock read never delays the writer of the current pose.
+    cogip::models::pose_t pose_current = shared_memory_.readPoseCurrent(pose_current_index_);
+
+    bool merge = lidar_source_count_ > 1;
+    std::size_t read_count = 0;
+    if (merge) {
+        read_count = copyMergedScans();
+    }
+    else {
+        // Updates coalesced by the wait are scans the driver published while the previous one was converted.
+        dropped_scans_.fetch_add(data_read_lock_.lastMissedUpdates(), std::memory_order_relaxed);
+        read_count = compact_input_ ? copyCompactScan() : copyScan();
+        scan_segments_[0] = {0, read_count, 0, &scan_header_};
+        scan_segment_count_ = 1;
+    }
+
+    // The frame followed by the latency accounting is the last scan published when the scans were read.
+    shared_memory::latency_frame_t latency_frame = shared_memory_.readLatencyFrame(shared_memory::LatencyStage::LidarData);
+
+    // Points outside the regions of interest or decimated are dropped before any trigonometry.
+    std::size_t scan_count = filterSegments();
+
+    for (std::size_t segment_index = 0; segment_index < scan_segment_count_; segment_index++) {
+        const scan_segment_t& segment = scan_segments_[segment_index];
+        const shared_memory::lidar_scan_header_t& header = *segment.header;
+        const lidar_extrinsics_t& extrinsics = lidar_extrinsics_[segment.source];
+        polarToCartesian(segment.begin, segment.end, extrinsics.angle);
+
+        // Merged scans of different times are aligned with the pose at their end.
+        cogip::models::pose_t pose = pose_current;
+        if (merge && header.end_timestamp != 0) {
+            pose = shared_memory_.readPoseCurrentAt(header.end_timestamp);
+        }
+
+        // In deskew mode, points are converted with the pose at their time, looked up again for each block.
+        // Points without timing are converted with the pose of the last block.
+        std::size_t block_begin = segment.begin;
+        if (deskew_ && header.start_timestamp != 0) {
+            std::uint64_t block_start = 0;
+            for (std::size_t index = segment.begin; index < segment.end; index++) {
+                std::uint64_t timestamp = header.start_timestamp + scan_offsets_[index];
+                if (index == segment.begin || timestamp < block_start || timestamp - block_start > deskew_block_duration_) {
+                    transformBlock(block_begin, index, pose, extrinsics);
+                    pose = shared_memory_.readPoseCurrentAt(timestamp);
+                    block_begin = index;
+                    block_start = timestamp;
+                }
+            }
+        }
+        transformBlock(block_begin, segment.end, pose, extrinsics);
+    }
+
+    bool occupancy_grid = occupancy_grid_enabled_;
+    if (occupancy_grid) {
+        updateOccupancyGrid(scan_count);
+    }
+    bool occupancy_filter = occupancy_grid && occupancy_filter_ && occupancy_grid_.header.width != 0;
+
+    // Filter points near the borders or outside the table.
+    // Each point is written unconditionally and only kept by incrementing the count, without branch.
+    double min_x = table_limits_[0] + table_limits_margin_;
+    double max_x = table_limits_[1] - table_limits_margin_;
+    double min_y = table_limits_[2] + table_limits_margin_;
+    double max_y = table_limits_[3] - table_limits_margin_;
+
+    shared_memory::lidar_coords_t& lidar_coords = shared_memory::tripleBufferBeginWrite(lidar_coords_);
+    std::size_t count = 0;
+    for (std::size_t index = 0; index < scan_count; index++) {
+        double global_x = scan_x_[index];
+        double global_y = scan_y_[index];
+        lidar_coords[count][0] = global_x;
+        lidar_coords[count][1] = global_y;
+        count += (min_x < global_x) & (global_x < max_x) & (min_y < global_y) & (global_y < max_y)
+            & (!occupancy_filter | scan_occupied_[index]);
+    }
+    if (voxel_size_ > 0) {
+        count = downsample(lidar_coords, count);
+    }
+    lidar_coords[count][0] = -1.0;  // Mark as end of data
+    lidar_coords[count][1] = -1.0;
+    shared_memory_.getLidarCoordsCount(lidar_coords) = static_cast<std::uint32_t>(count);
+    // Hashed with the points, so path clearance queries between detector cycles only test the nearby points.
+    shared_memory::buildLidarCoordsHash(
+        lidar_coords, count, shared_memory::LIDAR_COORDS_HASH_CELL_SIZE, shared_memory_.getLidarCoordsHash(lidar_coords)
+    );
+
+    // Readers now find the new points in the latest slot.
+    shared_memory::tripleBufferPublish(lidar_coords_);
     if (debug_) std::cout << "LidarDataConverter: converted " << count << " points to table coordinates." << std::endl;
     coords_write_lock_.postUpdate();
+    shared_memory_.stampLatency(shared_memory::LatencyStage::LidarCoords, latency_frame);
+
+    // The grid is published after the coords, so it does not delay them.
+    // Disabling it publishes an empty grid, it restarts empty when enabled again.
+    if (occupancy_grid || occupancy_grid_.header.width != 0) {
+        if (!occupancy_grid) {
+            occupancy_grid_.header.width = 0;
+            occupancy_grid_.header.height = 0;
+        }
+        shared_memory_.writeOccupancyGrid(occupancy_grid_);
+    }
+
+    std::uint64_t publish_time = now_ns();
+    conversions_.fetch_add(1, std::memory_order_relaxed);
+    points_in_.fetch_add(read_count, std::memory_order_relaxed);
+    points_out_.fetch_add(count, std::memory_order_relaxed);
+    record_duration(conversion_time_total_, conversion_time_max_, publish_time - update_time);
+    if (scan_header_.end_timestamp != 0 && scan_header_.end_timestamp <= publish_time) {
+        timed_conversions_.fetch_add(1, std::memory_order_relaxed);
+        record_duration(scan_latency_total_, scan_latency_max_, publish_time - scan_header_.end_timestamp);
+    }
+
+    // In fused mode, the coords are clustered in place: this thread is the only writer of the slot,
+    // which stays untouched until its next conversions.
+    if (cluster_obstacles_) {
+        std::size_t obstacle_count = clusterer_.cluster(lidar_coords, count, scan_header_.end_timestamp);
+        record_duration(clustering_time_total_, clustering_time_max_, now_ns() - publish_time);
+        if (debug_) std::cout << "LidarDataConverter: clustered " << obstacle_count << " obstacles." << std::endl;
+    }
+
+    return true;
+}
+
+lidar_data_converter_statistics_t LidarDataConverter::getStatistics() const
+{
+    lidar_data_converter_statistics_t stats;
+    stats.elapsed = now_ns() - statistics_start_.load(std::memory_order_relaxed);
+    stats.conversions = conversions_.load(std::memory_order_relaxed);
+    stats.conversions_per_second = stats.elapsed > 0 ? stats.conversions * 1e9 / stats.elapsed : 0.0;
+    stats.dropped_scans = dropped_scans_.load(std::memory_order_relaxed);
+    stats.timeouts = timeouts_.load(std::memory_order_relaxed);
+    stats.points_in = points_in_.load(std::memory_order_relaxed);
+    stats.points_out = points_out_.load(std::memory_order_relaxed);
+    stats.conversion_time_total = conversion_time_total_.load(std::memory_order_relaxed);
+    stats.conversion_time_max = conversion_time_max_.load(std::memory_order_relaxed);
+    stats.timed_conversions = timed_conversions_.load(std::memory_order_relaxed);
+    stats.scan_latency_total = scan_latency_total_.load(std::memory_order_relaxed);
+    stats.scan_latency_max = scan_latency_max_.load(std::memory_order_relaxed);
+    stats.clustering_time_total = clustering_time_total_.load(std::memory_order_relaxed);
+    stats.clustering_time_max = clustering_time_max_.load(std::memory_order_relaxed);
+    stats.merged_points_dropped = merged_points_dropped_.load(std::memory_order_relaxed);
+    stats.points_filtered = points_filtered_.load(std::memory_order_relaxed);
+    stats.points_downsampled = points_downsampled_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void LidarDataConverter::resetStatistics()
+{
+    statistics_start_.store(now_ns(), std::memory_order_relaxed);
+    conversions_.store(0, std::memory_order_relaxed);
+    dropped_scans_.store(0, std::memory_order_relaxed);
+    timeouts_.store(0, std::memory_order_relaxed);
+    points_in_.store(0, std::memory_order_relaxed);
+    points_out_.store(0, std::memory_order_relaxed);
+    conversion_time_total_.store(0, std::memory_order_relaxed);
+    conversion_time_max_.store(0, std::memory_order_relaxed);
+    timed_conversions_.store(0, std::memory_order_relaxed);
+    scan_latency_total_.store(0, std::memory_order_relaxed);
+    scan_latency_max_.store(0, std::memory_order_relaxed);
+    clustering_time_total_.store(0, std::memory_order_relaxed);
+    clustering_time_max_.store(0, std::memory_order_relaxed);
+    merged_points_dropped_.store(0, std::memory_order_relaxed);
+    points_filtered_.store(0, std::memory_order_relaxed);
+    points_downsampled_.store(0, std::memory_order_relaxed);
 }
 
 } // namespace utils
@@ -0,0 +1,192 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "utils/LidarPipeline.hpp"
+#include "utils/ThreadConfig.hpp"
+
+#include <ctime>
+#include <pthread.h>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace utils {
+
+namespace {
+
+/// Current CLOCK_MONOTONIC time in nanoseconds.
+std::uint64_t now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<std::uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/// Adds a duration to a total and updates the maximum.
+void record_duration(std::atomic<std::uint64_t>& total, std::atomic<std::uint64_t>& max, std::uint64_t duration)
+{
+    total.fetch_add(duration, std::memory_order_relaxed);
+    std::uint64_t current = max.load(std::memory_order_relaxed);
+    while (duration > current && !max.compare_exchange_weak(current, duration, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+LidarPipeline::LidarPipeline(shared_memory::SharedMemory& shared_memory, std::size_t queue_capacity):
+    shared_memory_(shared_memory),
+    converter_(shared_memory),
+    queue_capacity_(queue_capacity)
+{
+    if (queue_capacity_ == 0) {
+        throw std::invalid_argument("Lidar pipeline queue capacity must be positive");
+    }
+}
+
+LidarPipeline::~LidarPipeline()
+{
+    stop();
+}
+
+std::size_t LidarPipeline::addStage(const std::string& name, lidar_pipeline_stage_t stage)
+{
+    if (!stage) {
+        throw std::invalid_argument("Lidar pipeline stage function is empty");
+    }
+    if (running_.load(std::memory_order_acquire)) {
+        throw std::runtime_error("Cannot add a stage to a running lidar pipeline");
+    }
+    stages_.push_back(std::make_unique<Stage>(name, std::move(stage), queue_capacity_));
+    return stages_.size() - 1;
+}
+
+void LidarPipeline::start()
+{
+    if (running_.exchange(true)) {
+        return; // Already running
+    }
+
+    for (std::size_t index = 0; index < stages_.size(); index++) {
+        Stage& stage = *stages_[index];
+        stage.thread = std::thread([this, index, &stage]() {
+            lidar_pipeline_frame_t frame;
+            while (running_.load(std::memory_order_relaxed)) {
+                if (!stage.queue.pop(frame, LIDAR_PIPELINE_WAIT_TIMEOUT)) {
+                    continue;
+                }
+                runStage(stage, frame);
+                queueFrame(index + 1, frame);
+            }
+        });
+        if (!stage.name.empty() && stage.name.size() <= THREAD_NAME_MAX_LENGTH) {
+            pthread_setname_np(stage.thread.native_handle(), stage.name.c_str());
+        }
+    }
+
+    converter_thread_ = std::thread([this]() {
+        lidar_pipeline_frame_t frame;
+        while (running_.load(std::memory_order_relaxed)) {
+            if (convert(LIDAR_DATA_CONVERTER_WAIT_TIMEOUT, frame)) {
+                queueFrame(0, frame);
+            }
+        }
+    });
+}
+
+void LidarPipeline::stop()
+{
+    if (!running_.exchange(false)) {
+        return; // Already stopped
+    }
+    if (converter_thread_.joinable()) {
+        converter_thread_.join();
+    }
+    for (auto& stage : stages_) {
+        stage->queue.wakeConsumer();
+        if (stage->thread.joinable()) {
+            stage->thread.join();
+        }
+        lidar_pipeline_frame_t frame;
+        while (stage->queue.tryPop(frame)) {
+        }
+    }
+}
+
+bool LidarPipeline::step(double timeout_seconds)
+{
+    if (running_.load(std::memory_order_acquire)) {
+        throw std::runtime_error("Cannot step a running lidar pipeline");
+    }
+    lidar_pipeline_frame_t frame;
+    if (!convert(timeout_seconds, frame)) {
+        return false;
+    }
+    for (auto& stage : stages_) {
+        runStage(*stage, frame);
+    }
+    return true;
+}
+
+bool LidarPipeline::convert(double timeout_seconds, lidar_pipeline_frame_t& frame)
+{
+    if (!converter_.convert(timeout_seconds)) {
+        return false;
+    }
+    // The converter runs in this thread, so the latest lidar_coords slot is the one it just published.
+    frame.frame = shared_memory_.readLatencyFrame(shared_memory::LatencyStage::LidarCoords);
+    frame.point_count = shared_memory_.getLidarCoordsCount(shared_memory_.getLidarCoords());
+    frame.publish_timestamp = now_ns();
+    return true;
+}
+
+void LidarPipeline::runStage(Stage& stage, const lidar_pipeline_frame_t& frame)
+{
+    std::uint64_t start = now_ns();
+    stage.function(frame);
+    std::uint64_t end = now_ns();
+    stage.frames.fetch_add(1, std::memory_order_relaxed);
+    record_duration(stage.run_time_total, stage.run_time_max, end - start);
+    if (start >= frame.publish_timestamp) {
+        record_duration(stage.queue_time_total, stage.queue_time_max, start - frame.publish_timestamp);
+    }
+}
+
+void LidarPipeline::queueFrame(std::size_t stage, const lidar_pipeline_frame_t& frame)
+{
+    if (stage >= stages_.size()) {
+        return;
+    }
+    if (!stages_[stage]->queue.tryPush(frame)) {
+        stages_[stage]->dropped_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+lidar_pipeline_stage_statistics_t LidarPipeline::getStageStatistics(std::size_t stage) const
+{
+    const Stage& state = *stages_.at(stage);
+    lidar_pipeline_stage_statistics_t stats;
+    stats.frames = state.frames.load(std::memory_order_relaxed);
+    stats.dropped_frames = state.dropped_frames.load(std::memory_order_relaxed);
+    stats.run_time_total = state.run_time_total.load(std::memory_order_relaxed);
+    stats.run_time_max = state.run_time_max.load(std::memory_order_relaxed);
+    stats.queue_time_total = state.queue_time_total.load(std::memory_order_relaxed);
+    stats.queue_time_max = state.queue_time_max.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void LidarPipeline::resetStatistics()
+{
+    for (auto& stage : stages_) {
+        stage->frames.store(0, std::memory_order_relaxed);
+        stage->dropped_frames.store(0, std::memory_order_relaxed);
+        stage->run_time_total.store(0, std::memory_order_relaxed);
+        stage->run_time_max.store(0, std::memory_order_relaxed);
+        stage->queue_time_total.store(0, std::memory_order_relaxed);
+        stage->queue_time_max.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace utils
+
+} // namespace cogip
@@ -0,0 +1,408 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#include "utils/MonitorFrame.hpp"
+#include "logger/Trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace utils {
+
+namespace {
+
+/// Kind byte of circle obstacles.
+constexpr std::uint8_t OBSTACLE_KIND_CIRCLE = 0;
+
+/// Kind byte of rectangle obstacles.
+constexpr std::uint8_t OBSTACLE_KIND_RECTANGLE = 1;
+
+/// Maximum size of an encoded delta in bytes.
+constexpr std::size_t MAX_DELTA_SIZE = 3;
+
+/// Maximum size of an encoded obstacle in bytes.
+constexpr std::size_t MAX_OBSTACLE_SIZE = 16 + models::COMPACT_COORDS_LIST_SIZE_MAX * 2 * MAX_DELTA_SIZE;
+
+/// Maximum number of items of a frame.
+constexpr std::size_t MAX_ITEMS = std::numeric_limits<std::uint16_t>::max();
+
+/// Appends frame fields in little-endian order.
+class FrameWriter {
+public:
+    explicit FrameWriter(std::vector<std::uint8_t>& frame) : frame_(frame) {}
+
+    void u8(std::uint8_t value) { frame_.push_back(value); }
+
+    void u16(std::uint16_t value)
+    {
+        frame_.push_back(static_cast<std::uint8_t>(value));
+        frame_.push_back(static_cast<std::uint8_t>(value >> 8));
+    }
+
+    void i16(std::int16_t value) { u16(static_cast<std::uint16_t>(value)); }
+
+    void u32(std::uint32_t value)
+    {
+        u16(static_cast<std::uint16_t>(value));
+        u16(static_cast<std::uint16_t>(value >> 16));
+    }
+
+    /// Appends the difference between two quantized values, zigzag-mapped and as a variable length integer.
+    /// The difference wraps around like int16 arithmetic, so it always fits in 16 bits.
+    void delta(std::int16_t value, std::int16_t previous)
+    {
+        auto diff = static_cast<std::int16_t>(static_cast<std::uint16_t>(value) - static_cast<std::uint16_t>(previous));
+        auto zigzag = static_cast<std::uint16_t>((static_cast<std::uint16_t>(diff) << 1) ^ (diff < 0 ? 0xFFFF : 0));
+        while (zigzag >= 0x80) {
+            frame_.push_back(static_cast<std::uint8_t>(zigzag | 0x80));
+            zigzag >>= 7;
+        }
+        frame_.push_back(static_cast<std::uint8_t>(zigzag));
+    }
+
+private:
+    std::vector<std::uint8_t>& frame_;
+};
+
+/// Reads frame fields in little-endian order, throwing on truncated frames.
+class FrameReader {
+public:
+    FrameReader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size), offset_(0) {}
+
+    std::uint8_t u8()
+    {
+        require(1);
+        return data_[offset_++];
+    }
+
+    std::uint16_t u16()
+    {
+        require(2);
+        std::uint16_t value = data_[offset_] | (data_[offset_ + 1] << 8);
+        offset_ += 2;
+        return value;
+    }
+
+    std::int16_t i16() { return static_cast<std::int16_t>(u16()); }
+
+    std::uint32_t u32()
+    {
+        std::uint32_t low = u16();
+        return low | (static_cast<std::uint32_t>(u16()) << 16);
+    }
+
+    /// Reads a value written by FrameWriter::delta().
+    std::int16_t delta(std::int16_t previous)
+    {
+        std::uint32_t zigzag = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            std::uint8_t byte = u8();
+            if (shift > 14) {
+                throw std::invalid_argument("Monitor frame: invalid delta");
+            }
+            zigzag |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+        auto diff = static_cast<std::uint16_t>((zigzag >> 1) ^ (zigzag & 1 ? 0xFFFF : 0));
+        return static_cast<std::int16_t>(static_cast<std::uint16_t>(previous) + diff);
+    }
+
+    bool atEnd() const { return offset_ == size_; }
+
+private:
+    void require(std::size_t bytes) const
+    {
+        if (size_ - offset_ < bytes) {
+            throw std::invalid_argument("Monitor frame: truncated frame");
+        }
+    }
+
+    const std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t offset_;
+};
+
+/// Checks a quantization step and returns it in µm.
+std::uint16_t resolutionMicrometers(double resolution)
+{
+    double micrometers = std::round(resolution * 1000.0);
+    if (!(micrometers >= 1 && micrometers <= std::numeric_limits<std::uint16_t>::max())) {
+        throw std::invalid_argument("Monitor frame: resolution must be between 0.001 and 65.535 mm");
+    }
+    return static_cast<std::uint16_t>(micrometers);
+}
+
+/// Quantizes a value to the nearest multiple of a step, saturated to int16.
+std::int16_t quantize(double value, double step)
+{
+    double q = std::round(value / step);
+    q = std::clamp(q, static_cast<double>(std::numeric_limits<std::int16_t>::min()),
+                   static_cast<double>(std::numeric_limits<std::int16_t>::max()));
+    return static_cast<std::int16_t>(q);
+}
+
+/// Quantizes a length to the nearest multiple of a step, saturated to uint16.
+std::uint16_t quantizeLength(double value, double step)
+{
+    double q = std::round(value / step);
+    q = std::clamp(q, 0.0, static_cast<double>(std::numeric_limits<std::uint16_t>::max()));
+    return static_cast<std::uint16_t>(q);
+}
+
+/// Appends the header of a frame.
+void writeHeader(FrameWriter& writer, MonitorFrameType type, std::uint16_t resolution, std::size_t count)
+{
+    writer.u16(MONITOR_FRAME_MAGIC);
+    writer.u8(MONITOR_FRAME_VERSION);
+    writer.u8(static_cast<std::uint8_t>(type));
+    writer.u16(resolution);
+    writer.u16(static_cast<std::uint16_t>(count));
+}
+
+/// Reads and checks a frame header.
+/// @returns The resolution (mm).
+double readHeader(FrameReader& reader, MonitorFrameType type, std::size_t& count)
+{
+    if (reader.u16() != MONITOR_FRAME_MAGIC) {
+        throw std::invalid_argument("Monitor frame: bad magic");
+    }
+    if (reader.u8() != MONITOR_FRAME_VERSION) {
+        throw std::invalid_argument("Monitor frame: unsupported version");
+    }
+    if (reader.u8() != static_cast<std::uint8_t>(type)) {
+        throw std::invalid_argument("Monitor frame: unexpected frame type");
+    }
+    std::uint16_t resolution = reader.u16();
+    if (resolution == 0) {
+        throw std::invalid_argument("Monitor frame: null resolution");
+    }
+    count = reader.u16();
+    return resolution / 1000.0;
+}
+
+/// Appends the used bounding box points of an obstacle, delta-encoded from its quantized center.
+template <typename T>
+void writeBoundingBox(FrameWriter& writer, const T& obstacle, std::int16_t x, std::int16_t y, double step)
+{
+    std::size_t count = std::min(obstacle.bounding_box.count, models::COMPACT_COORDS_LIST_SIZE_MAX);
+    writer.u8(static_cast<std::uint8_t>(count));
+    for (std::size_t i = 0; i < count; i++) {
+        std::int16_t px = quantize(obstacle.bounding_box.elems[i].x, step);
+        std::int16_t py = quantize(obstacle.bounding_box.elems[i].y, step);
+        writer.delta(px, x);
+        writer.delta(py, y);
+        x = px;
+        y = py;
+    }
+}
+
+/// Checks the input of the encoders.
+void checkCount(std::size_t count)
+{
+    if (count > MAX_ITEMS) {
+        throw std::invalid_argument("Monitor frame: too many items");
+    }
+}
+
+} // namespace
+
+void encodeLidarPoints(const double (*points)[2], std::size_t count, double resolution, std::vector<std::uint8_t>& frame)
+{
+    COGIP_TRACE_SPAN("encodeLidarPoints");
+    std::uint16_t micrometers = resolutionMicrometers(resolution);
+    checkCount(count);
+    const double step = micrometers / 1000.0;
+
+    frame.clear();
+    frame.reserve(MONITOR_FRAME_HEADER_SIZE + count * 2 * MAX_DELTA_SIZE);
+    FrameWriter writer(frame);
+    writeHeader(writer, MonitorFrameType::LidarPoints, micrometers, count);
+    std::int16_t x = 0;
+    std::int16_t y = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        std::int16_t px = quantize(points[i][0], step);
+        std::int16_t py = quantize(points[i][1], step);
+        writer.delta(px, x);
+        writer.delta(py, y);
+        x = px;
+        y = py;
+    }
+}
+
+void encodeObstacles(
+    const obstacles::compact_obstacle_circle_list_t& circles,
+    const obstacles::compact_obstacle_polygon_list_t& rectangles,
+    double resolution,
+    std::vector<std::uint8_t>& frame
+)
+{
+    COGIP_TRACE_SPAN("encodeObstacles");
+    std::uint16_t micrometers = resolutionMicrometers(resolution);
+    const double step = micrometers / 1000.0;
+    std::size_t circle_count = std::min(circles.count, obstacles::OBSTACLE_LIST_SIZE_MAX);
+    std::size_t rectangle_count = std::min(rectangles.count, obstacles::OBSTACLE_LIST_SIZE_MAX);
+
+    frame.clear();
+    FrameWriter writer(frame);
+    writeHeader(writer, MonitorFrameType::Obstacles, micrometers, circle_count + rectangle_count);
+    for (std::size_t i = 0; i < circle_count; i++) {
+        const auto& circle = circles.elems[i];
+        std::int16_t x = quantize(circle.center.x, step);
+        std::int16_t y = quantize(circle.center.y, step);
+        writer.u32(circle.id);
+        writer.u8(OBSTACLE_KIND_CIRCLE);
+        writer.i16(x);
+        writer.i16(y);
+        writer.u16(quantizeLength(circle.radius, step));
+        writer.i16(quantize(circle.vx, 1.0));
+        writer.i16(quantize(circle.vy, 1.0));
+        writeBoundingBox(writer, circle, x, y, step);
+    }
+    for (std::size_t i = 0; i < rectangle_count; i++) {
+        const auto& rectangle = rectangles.elems[i];
+        std::int16_t x = quantize(rectangle.center.x, step);
+        std::int16_t y = quantize(rectangle.center.y, step);
+        writer.u32(rectangle.id);
+        writer.u8(OBSTACLE_KIND_RECTANGLE);
+        writer.i16(x);
+        writer.i16(y);
+        writer.i16(quantize(std::remainder(rectangle.center.angle, 360.0), 0.01));
+        writer.u16(quantizeLength(rectangle.length_x, step));
+        writer.u16(quantizeLength(rectangle.length_y, step));
+        writeBoundingBox(writer, rectangle, x, y, step);
+    }
+}
+
+MonitorFrameType monitorFrameType(const std::uint8_t* data, std::size_t size)
+{
+    FrameReader reader(data, size);
+    if (reader.u16() != MONITOR_FRAME_MAGIC) {
+        throw std::invalid_argument("Monitor frame: bad magic");
+    }
+    if (reader.u8() != MONITOR_FRAME_VERSION) {
+        throw std::invalid_argument("Monitor frame: unsupported version");
+    }
+    std::uint8_t type = reader.u8();
+    if (type != static_cast<std::uint8_t>(MonitorFrameType::LidarPoints) &&
+        type != static_cast<std::uint8_t>(MonitorFrameType::Obstacles)) {
+        throw std::invalid_argument("Monitor frame: unknown frame type");
+    }
+    return static_cast<MonitorFrameType>(type);
+}
+
+void decodeLidarPoints(const std::uint8_t* data, std::size_t size, std::vector<double>& points)
+{
+    FrameReader reader(data, size);
+    std::size_t count;
+    double step = readHeader(reader, MonitorFrameType::LidarPoints, count);
+
+    points.resize(2 * count);
+    std::int16_t x = 0;
+    std::int16_t y = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        x = reader.delta(x);
+        y = reader.delta(y);
+        points[2 * i] = x * step;
+        points[2 * i + 1] = y * step;
+    }
+    if (!reader.atEnd()) {
+        throw std::invalid_argument("Monitor frame: trailing bytes");
+    }
+}
+
+void decodeObstacles(const std::uint8_t* data, std::size_t size, std::vector<monitor_obstacle_t>& obstacles)
+{
+    FrameReader reader(data, size);
+    std::size_t count;
+    double step = readHeader(reader, MonitorFrameType::Obstacles, count);
+
+    obstacles.resize(count);
+    for (auto& obstacle : obstacles) {
+        obstacle = monitor_obstacle_t{};
+        obstacle.id = reader.u32();
+        std::uint8_t kind = reader.u8();
+        std::int16_t x = reader.i16();
+        std::int16_t y = reader.i16();
+        obstacle.x = x * step;
+        obstacle.y = y * step;
+        if (kind == OBSTACLE_KIND_CIRCLE) {
+            obstacle.is_circle = true;
+            obstacle.radius = reader.u16() * step;
+            obstacle.vx = reader.i16();
+            obstacle.vy = reader.i16();
+        }
+        else if (kind == OBSTACLE_KIND_RECTANGLE) {
+            obstacle.is_circle = false;
+            obstacle.angle = reader.i16() * 0.01;
+            obstacle.length_x = reader.u16() * step;
+            obstacle.length_y = reader.u16() * step;
+        }
+        else {
+            throw std::invalid_argument("Monitor frame: unknown obstacle kind");
+        }
+        std::size_t point_count = reader.u8();
+        obstacle.bounding_box.resize(2 * point_count);
+        for (std::size_t i = 0; i < point_count; i++) {
+            x = reader.delta(x);
+            y = reader.delta(y);
+            obstacle.bounding_box[2 * i] = x * step;
+            obstacle.bounding_box[2 * i + 1] = y * step;
+        }
+    }
+    if (!reader.atEnd()) {
+        throw std::invalid_argument("Monitor frame: trailing bytes");
+    }
+}
+
+MonitorFrameEncoder::MonitorFrameEncoder(const std::string& name):
+    shared_memory_(std::make_unique<shared_memory::SharedMemory>(name, false)),
+    lidar_coords_(shared_memory_->getLidarCoordsBuffer()),
+    resolution_(MONITOR_FRAME_DEFAULT_RESOLUTION)
+{
+    lidar_frame_.reserve(MONITOR_FRAME_HEADER_SIZE + shared_memory::MAX_LIDAR_DATA_COUNT * 2 * MAX_DELTA_SIZE);
+    obstacles_frame_.reserve(
+        MONITOR_FRAME_HEADER_SIZE + 2 * obstacles::OBSTACLE_LIST_SIZE_MAX * MAX_OBSTACLE_SIZE
+    );
+}
+
+void MonitorFrameEncoder::setResolution(double resolution)
+{
+    resolutionMicrometers(resolution);
+    resolution_ = resolution;
+}
+
+const std::vector<std::uint8_t>& MonitorFrameEncoder::encodeLidarCoords()
+{
+    // Read the latest complete lidar coords, the copy restarts if the converter overwrites them meanwhile.
+    std::size_t count = 0;
+    shared_memory::tripleBufferRead(lidar_coords_, [&](const shared_memory::lidar_coords_t& lidar_coords) {
+        count = std::min<std::size_t>(
+            shared_memory_->getLidarCoordsCount(lidar_coords), shared_memory::MAX_LIDAR_DATA_COUNT
+        );
+        std::memcpy(points_.data(), lidar_coords, count * sizeof(lidar_coords[0]));
+    });
+
+    encodeLidarPoints(points_.data(), count, resolution_, lidar_frame_);
+    return lidar_frame_;
+}
+
+const std::vector<std::uint8_t>& MonitorFrameEncoder::encodeObstacles()
+{
+    // The resolution is already checked and the frame reserved: encoding can restart without throwing.
+    shared_memory_->readObstacles([this](const shared_memory::planner_obstacles_t& lists) {
+        utils::encodeObstacles(lists.circles, lists.rectangles, resolution_, obstacles_frame_);
+    });
+    return obstacles_frame_;
+}
+
+} // namespace utils
+
+} // namespace cogip
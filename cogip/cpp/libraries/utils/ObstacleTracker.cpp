@@ -0,0 +1,140 @@
+#include "utils/ObstacleTracker.hpp"
+#include "logger/Trace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace utils {
+
+ObstacleTracker::ObstacleTracker():
+    alpha_(0.5),
+    beta_(0.2),
+    gate_distance_(250.0),
+    max_misses_(2),
+    min_hits_(1),
+    next_id_(1),
+    last_timestamp_(0)
+{
+}
+
+void ObstacleTracker::setAlpha(double alpha)
+{
+    if (!(alpha >= 0 && alpha <= 1)) {
+        throw std::invalid_argument("Alpha must be between 0 and 1");
+    }
+    alpha_ = alpha;
+}
+
+void ObstacleTracker::setBeta(double beta)
+{
+    if (!(beta >= 0 && beta <= 1)) {
+        throw std::invalid_argument("Beta must be between 0 and 1");
+    }
+    beta_ = beta;
+}
+
+void ObstacleTracker::setGateDistance(double gate_distance)
+{
+    if (!(gate_distance > 0)) {
+        throw std::invalid_argument("Gate distance must be positive");
+    }
+    gate_distance_ = gate_distance;
+}
+
+void ObstacleTracker::reset()
+{
+    tracks_.clear();
+    next_id_ = 1;
+    last_timestamp_ = 0;
+}
+
+void ObstacleTracker::update(const models::circle_t* detections, std::size_t count, std::uint64_t timestamp)
+{
+    COGIP_TRACE_SPAN("ObstacleTracker::update");
+    double dt = (last_timestamp_ != 0 && timestamp > last_timestamp_) ? (timestamp - last_timestamp_) * 1e-9 : 0.0;
+    last_timestamp_ = timestamp;
+
+    // Predict the tracks at the detection time
+    for (auto& track : tracks_) {
+        track.x += track.vx * dt;
+        track.y += track.vy * dt;
+    }
+
+    // Associate the closest pairs first, each track and each detection at most once
+    double gate_distance2 = gate_distance_ * gate_distance_;
+    candidates_.clear();
+    for (std::size_t t = 0; t < tracks_.size(); t++) {
+        for (std::size_t d = 0; d < count; d++) {
+            double diff_x = detections[d].x - tracks_[t].x;
+            double diff_y = detections[d].y - tracks_[t].y;
+            double distance2 = diff_x * diff_x + diff_y * diff_y;
+            if (distance2 <= gate_distance2) {
+                candidates_.push_back({distance2, static_cast<std::uint32_t>(t), static_cast<std::uint32_t>(d)});
+            }
+        }
+    }
+    std::sort(candidates_.begin(), candidates_.end(), [](const candidate_t& a, const candidate_t& b) {
+        return a.distance2 < b.distance2;
+    });
+
+    track_associated_.assign(tracks_.size(), false);
+    detection_associated_.assign(count, false);
+    for (const auto& candidate : candidates_) {
+        if (track_associated_[candidate.track] || detection_associated_[candidate.detection]) {
+            continue;
+        }
+        track_associated_[candidate.track] = true;
+        detection_associated_[candidate.detection] = true;
+
+        // Alpha-beta correction, the velocity needs the time since the previous update
+        obstacle_track_t& track = tracks_[candidate.track];
+        const models::circle_t& detection = detections[candidate.detection];
+        double residual_x = detection.x - track.x;
+        double residual_y = detection.y - track.y;
+        track.x += alpha_ * residual_x;
+        track.y += alpha_ * residual_y;
+        if (dt > 0) {
+            track.vx += beta_ * residual_x / dt;
+            track.vy += beta_ * residual_y / dt;
+        }
+        track.radius = detection.radius;
+        track.hits++;
+        track.misses = 0;
+    }
+
+    // Drop the tracks missed too many times, keeping the creation order
+    std::size_t kept = 0;
+    for (std::size_t t = 0; t < tracks_.size(); t++) {
+        if (!track_associated_[t] && ++tracks_[t].misses > max_misses_) {
+            continue;
+        }
+        tracks_[kept++] = tracks_[t];
+    }
+    tracks_.resize(kept);
+
+    // Start a track on each unassociated detection
+    for (std::size_t d = 0; d < count; d++) {
+        if (detection_associated_[d]) {
+            continue;
+        }
+        tracks_.push_back({next_id_, detections[d].x, detections[d].y, 0.0, 0.0, detections[d].radius, 1, 0});
+        // 0 means not tracked, skip it when the identifiers wrap around
+        next_id_ = next_id_ + 1 != 0 ? next_id_ + 1 : 1;
+    }
+}
+
+void ObstacleTracker::write(models::CircleList& circles) const
+{
+    for (const auto& track : tracks_) {
+        if (track.hits < min_hits_ || circles.size() >= circles.max_size()) {
+            continue;
+        }
+        circles.append(track.x, track.y, track.radius, track.id, track.vx, track.vy);
+    }
+}
+
+} // namespace utils
+
+} // namespace cogip
@@ -0,0 +1,111 @@
+#include "utils/ThreadConfig.hpp"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace cogip {
+
+namespace utils {
+
+void checkThreadConfig(const thread_config_t& config)
+{
+    if (config.name.size() > THREAD_NAME_MAX_LENGTH) {
+        throw std::invalid_argument(
+            "Thread name '" + config.name + "' is longer than " + std::to_string(THREAD_NAME_MAX_LENGTH) + " characters"
+        );
+    }
+    if (config.priority < 0 || config.priority > THREAD_PRIORITY_MAX) {
+        throw std::invalid_argument(
+            "Thread priority must be between 0 and " + std::to_string(THREAD_PRIORITY_MAX)
+        );
+    }
+    long cpu_count = sysconf(_SC_NPROCESSORS_CONF);
+    for (int cpu : config.cpus) {
+        if (cpu < 0 || cpu >= cpu_count || cpu >= CPU_SETSIZE) {
+            throw std::invalid_argument(
+                "Thread CPU " + std::to_string(cpu) + " does not exist, CPUs are 0 to " + std::to_string(cpu_count - 1)
+            );
+        }
+    }
+}
+
+void applyThreadConfig(pthread_t thread, const thread_config_t& config)
+{
+    checkThreadConfig(config);
+
+    // pthread functions return the error number instead of setting errno.
+    int error = 0;
+    if (!config.name.empty()) {
+        error = pthread_setname_np(thread, config.name.c_str());
+        if (error != 0) {
+            throw std::runtime_error("Failed to set thread name '" + config.name + "': " + std::strerror(error));
+        }
+    }
+
+    // Without CPU list, the thread gets back the CPUs it would inherit from the calling thread when created.
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (config.cpus.empty()) {
+        error = pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (error != 0) {
+            throw std::runtime_error(std::string("Failed to get thread CPU affinity: ") + std::strerror(error));
+        }
+    }
+    for (int cpu : config.cpus) {
+        CPU_SET(cpu, &cpus);
+    }
+    error = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+    if (error != 0) {
+        throw std::runtime_error(std::string("Failed to set thread CPU affinity: ") + std::strerror(error));
+    }
+
+    sched_param param{};
+    param.sched_priority = config.priority;
+    error = pthread_setschedparam(thread, config.priority > 0 ? SCHED_FIFO : SCHED_OTHER, &param);
+    if (error != 0) {
+        throw std::runtime_error(
+            "Failed to set thread priority " + std::to_string(config.priority) + ": " + std::strerror(error)
+            + (error == EPERM ? " (needs CAP_SYS_NICE or RLIMIT_RTPRIO)" : "")
+        );
+    }
+}
+
+bool tryApplyThreadConfig(pthread_t thread, const thread_config_t& config)
+{
+    try {
+        applyThreadConfig(thread, config);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[ThreadConfig] Warning: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void lockProcessMemory()
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        int error = errno;
+        throw std::runtime_error(
+            std::string("Failed to lock process memory: ") + std::strerror(error)
+            + (error == ENOMEM || error == EPERM ? " (needs CAP_IPC_LOCK or a higher RLIMIT_MEMLOCK)" : "")
+        );
+    }
+}
+
+void unlockProcessMemory()
+{
+    if (munlockall() != 0) {
+        throw std::runtime_error(std::string("Failed to unlock process memory: ") + std::strerror(errno));
+    }
+}
+
+} // namespace utils
+
+} // namespace cogip
@@ -2,10 +2,21 @@
 // This file is subject to the terms and conditions of the GNU Lesser
 // General Public License v2.1. See the file LICENSE in the top level directory.
 
+#include "utils/LidarCoordsClusterer.hpp"
 #include "utils/LidarDataConverter.hpp"
+#include "utils/LidarPipeline.hpp"
+#include "utils/MonitorFrame.hpp"
+#include "utils/ObstacleTracker.hpp"
+#include "utils/ThreadConfig.hpp"
 
 #include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/function.h>
 #include <nanobind/stl/string.h>
+#include <nanobind/stl/vector.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -17,17 +28,328 @@ namespace utils {
 NB_MODULE(utils, m) {
     auto shm_module = nb::module_::import_("cogip.cpp.libraries.shared_memory");
 
+    m.attr("THREAD_NAME_MAX_LENGTH") = THREAD_NAME_MAX_LENGTH;
+    m.attr("THREAD_PRIORITY_MAX") = THREAD_PRIORITY_MAX;
+
+    nb::class_<thread_config_t>(m, "ThreadConfig")
+        .def(
+            "__init__",
+            [](thread_config_t* self, const std::string& name, int priority, const std::vector<int>& cpus) {
+                new (self) thread_config_t{name, priority, cpus};
+            },
+            "name"_a = "", "priority"_a = 0, "cpus"_a = std::vector<int>(),
+            "Constructor, the default configuration is the scheduling inherited by a new thread"
+        )
+        .def_rw("name", &thread_config_t::name, "Thread name, at most THREAD_NAME_MAX_LENGTH characters, empty to keep the name")
+        .def_rw("priority", &thread_config_t::priority, "SCHED_FIFO priority from 1 to THREAD_PRIORITY_MAX, 0 for the time-sharing policy")
+        .def_rw("cpus", &thread_config_t::cpus, "CPUs the thread may run on, empty for the CPUs of the calling thread")
+    ;
+
+    m.def("check_thread_config", &checkThreadConfig, "config"_a,
+          "Check a thread configuration, raises ValueError if it is invalid");
+    m.def("lock_process_memory", &lockProcessMemory,
+          "Lock the current and future memory pages of the process in RAM, so real-time threads never wait for page faults");
+    m.def("unlock_process_memory", &unlockProcessMemory, "Unlock the memory pages locked by lock_process_memory()");
+
+    nb::class_<obstacle_track_t>(m, "ObstacleTrack")
+        .def_ro("id", &obstacle_track_t::id, "Identifier, never 0")
+        .def_ro("x", &obstacle_track_t::x, "Estimated X coordinate (mm)")
+        .def_ro("y", &obstacle_track_t::y, "Estimated Y coordinate (mm)")
+        .def_ro("vx", &obstacle_track_t::vx, "Estimated velocity along X (mm/s)")
+        .def_ro("vy", &obstacle_track_t::vy, "Estimated velocity along Y (mm/s)")
+        .def_ro("radius", &obstacle_track_t::radius, "Radius of the last associated detection (mm)")
+        .def_ro("hits", &obstacle_track_t::hits, "Number of associated detections")
+        .def_ro("misses", &obstacle_track_t::misses, "Number of consecutive updates without associated detection")
+    ;
+
+    nb::class_<ObstacleTracker>(m, "ObstacleTracker")
+         .def("reset", &ObstacleTracker::reset, "Drop all tracks, identifiers restart from 1")
+         .def("get_tracks", &ObstacleTracker::tracks, "Get a copy of the tracks, in creation order")
+         .def("set_alpha", &ObstacleTracker::setAlpha, "Set the gain of the position correction, between 0 and 1", "alpha"_a)
+         .def("set_beta", &ObstacleTracker::setBeta, "Set the gain of the velocity correction, between 0 and 1", "beta"_a)
+         .def("set_gate_distance", &ObstacleTracker::setGateDistance,
+              "Set the maximum distance between a predicted track and its associated detection (mm)", "gate_distance"_a)
+         .def("set_max_misses", &ObstacleTracker::setMaxMisses,
+              "Set the number of consecutive updates a track is kept without associated detection", "max_misses"_a)
+         .def("set_min_hits", &ObstacleTracker::setMinHits,
+              "Set the number of associated detections before a track is published", "min_hits"_a)
+    ;
+
+    nb::class_<lidar_data_converter_statistics_t>(m, "LidarDataConverterStatistics")
+        .def_ro("elapsed", &lidar_data_converter_statistics_t::elapsed, "Time since the statistics were reset (ns)")
+        .def_ro("conversions", &lidar_data_converter_statistics_t::conversions, "Number of converted scans")
+        .def_ro("conversions_per_second", &lidar_data_converter_statistics_t::conversions_per_second, "Average conversion rate")
+        .def_ro("dropped_scans", &lidar_data_converter_statistics_t::dropped_scans, "Number of scans published by the driver but never converted")
+        .def_ro("timeouts", &lidar_data_converter_statistics_t::timeouts, "Number of waits for new lidar data which timed out")
+        .def_ro("points_in", &lidar_data_converter_statistics_t::points_in, "Number of points read from the lidar data")
+        .def_ro("points_out", &lidar_data_converter_statistics_t::points_out, "Number of points written to the lidar coords")
+        .def_ro("conversion_time_total", &lidar_data_converter_statistics_t::conversion_time_total, "Total time from the data update to the coords update (ns)")
+        .def_ro("conversion_time_max", &lidar_data_converter_statistics_t::conversion_time_max, "Longest time from the data update to the coords update (ns)")
+        .def_ro("timed_conversions", &lidar_data_converter_statistics_t::timed_conversions, "Number of converted scans with a timing header")
+        .def_ro("scan_latency_total", &lidar_data_converter_statistics_t::scan_latency_total, "Total time from the end of the timed scans to the coords update (ns)")
+        .def_ro("scan_latency_max", &lidar_data_converter_statistics_t::scan_latency_max, "Longest time from the end of a timed scan to the coords update (ns)")
+        .def_ro("clustering_time_total", &lidar_data_converter_statistics_t::clustering_time_total, "Total time spent clustering the coords in fused mode (ns)")
+        .def_ro("clustering_time_max", &lidar_data_converter_statistics_t::clustering_time_max, "Longest time spent clustering the coords of a scan in fused mode (ns)")
+        .def_ro("merged_points_dropped", &lidar_data_converter_statistics_t::merged_points_dropped, "Number of points of merged scans dropped because the lidar coords are full")
+        .def_ro("points_filtered", &lidar_data_converter_statistics_t::points_filtered, "Number of points dropped by the pre-filter, outside the angle ROIs or decimated")
+        .def_ro("points_downsampled", &lidar_data_converter_statistics_t::points_downsampled, "Number of points merged with another point of their voxel")
+    ;
+
+    m.attr("LIDAR_MERGE_DEFAULT_MAX_AGE") = LIDAR_MERGE_DEFAULT_MAX_AGE;
+
+    nb::class_<lidar_extrinsics_t>(m, "LidarExtrinsics")
+        .def_ro("offset_x", &lidar_extrinsics_t::offset_x, "Offset of the lidar on the X axis of the robot (mm)")
+        .def_ro("offset_y", &lidar_extrinsics_t::offset_y, "Offset of the lidar on the Y axis of the robot (mm)")
+        .def_ro("angle", &lidar_extrinsics_t::angle, "Rotation of the lidar relative to the robot (deg, counter clockwise)")
+    ;
+
+    m.attr("LIDAR_ANGLE_ROIS_MAX") = LIDAR_ANGLE_ROIS_MAX;
+
     nb::class_<LidarDataConverter>(m, "LidarDataConverter")
          .def(nb::init<const std::string &>(), "Constructor for LidarDataConverter", "name"_a)
+         .def(nb::init<shared_memory::SharedMemory &>(), "shared_memory"_a, nb::keep_alive<1, 2>(),
+              "Constructor on a SharedMemory of the process, usually an in-process one shared with the other stages")
          .def("start", &LidarDataConverter::start, "Start the LidarDataConverter thread")
          .def("stop", &LidarDataConverter::stop, "Stop the LidarDataConverter thread")
-         .def("convert", &LidarDataConverter::convert, "Convert lidar data to table coordinates")
+         .def("set_thread_config", &LidarDataConverter::setThreadConfig,
+              "Set the scheduling of the converter thread, applied at each start and at once if it runs", "config"_a)
+         .def("convert", &LidarDataConverter::convert, "timeout_seconds"_a = -1.0, nb::call_guard<nb::gil_scoped_release>(),
+              "Wait for new lidar data and convert it to table coordinates, returns False if timed out")
+         .def("get_statistics", &LidarDataConverter::getStatistics, "Get a snapshot of the conversion statistics")
+         .def("reset_statistics", &LidarDataConverter::resetStatistics, "Reset the conversion statistics")
          .def("set_pose_current_index", &LidarDataConverter::setPoseCurrentIndex, "Set the current pose index", "index"_a)
          .def("set_table_limits_margin", &LidarDataConverter::setTableLimitsMargin, "Set the table limits margin", "table_limits_margin"_a)
          .def("set_lidar_offset_x", &LidarDataConverter::setLidarOffsetX, "Set the lidar offset on the X axis", "lidar_offset_x"_a)
          .def("set_lidar_offset_y", &LidarDataConverter::setLidarOffsetY, "Set the lidar offset on the Y axis", "lidar_offset_y"_a)
+         .def("set_lidar_source_count", &LidarDataConverter::setLidarSourceCount,
+              "Set the number of lidars of the robot, their latest scans are merged if more than one", "count"_a)
+         .def("set_lidar_extrinsics", &LidarDataConverter::setLidarExtrinsics,
+              "Set the placement of a lidar in the robot frame (mm, mm, deg)", "source"_a, "offset_x"_a, "offset_y"_a, "angle"_a)
+         .def("get_lidar_extrinsics", &LidarDataConverter::getLidarExtrinsics, "Get the placement of a lidar in the robot frame", "source"_a)
+         .def("set_merge_max_age", &LidarDataConverter::setMergeMaxAge,
+              "Set the maximum age of a merged scan relative to the latest one (ns)", "max_age"_a)
+         .def("add_angle_roi", &LidarDataConverter::addAngleRoi,
+              "Add an angle region of interest to a lidar (deg, lidar frame), its points outside of all regions are dropped",
+              "source"_a, "min_angle"_a, "max_angle"_a)
+         .def("clear_angle_rois", &LidarDataConverter::clearAngleRois, "Remove the angle regions of interest of a lidar", "source"_a)
+         .def("set_decimation", &LidarDataConverter::setDecimation,
+              "Decimate the points beyond min distance to about one point per spacing (mm), spacing 0 to disable",
+              "min_distance"_a, "spacing"_a)
+         .def("set_voxel_size", &LidarDataConverter::setVoxelSize,
+              "Replace the converted points of the same voxel by their centroid (mm), 0 to disable", "voxel_size"_a)
+         .def("set_deskew", &LidarDataConverter::setDeskew,
+              "Convert each point with the robot pose interpolated at its time", "deskew"_a)
+         .def("set_compact_input", &LidarDataConverter::setCompactInput,
+              "Read the scans in the compact format of the lidar scan history, 5 bytes per point instead of 24",
+              "compact_input"_a)
+         .def("set_deskew_block_duration", &LidarDataConverter::setDeskewBlockDuration,
+              "Set the duration of the blocks of points sharing a pose in deskew mode (ns), 0 for each point", "duration"_a)
+         .def("set_cluster_obstacles", &LidarDataConverter::setClusterObstacles,
+              "Cluster the converted coords in the converter thread and write the detector obstacles", "cluster_obstacles"_a)
+         .def("set_cluster_eps", &LidarDataConverter::setClusterEps,
+              "Set the maximum distance between two neighbor points in fused mode (mm)", "cluster_eps"_a)
+         .def("set_cluster_min_samples", &LidarDataConverter::setClusterMinSamples,
+              "Set the minimum number of neighbors of a core point in fused mode, itself included", "cluster_min_samples"_a)
+         .def("set_obstacle_min_radius", &LidarDataConverter::setObstacleMinRadius,
+              "Set the minimum radius of the obstacles in fused mode (mm)", "min_radius"_a)
+         .def("set_track_obstacles", &LidarDataConverter::setTrackObstacles,
+              "Track the obstacles in fused mode, giving them stable identifiers and velocities", "track_obstacles"_a)
+         .def("set_occupancy_grid", &LidarDataConverter::setOccupancyGrid,
+              "Enable the occupancy grid over the table limits, published in the shared memory", "occupancy_grid"_a)
+         .def("set_occupancy_grid_resolution", &LidarDataConverter::setOccupancyGridResolution,
+              "Set the size of the cells of the occupancy grid (mm)", "resolution"_a)
+         .def("set_occupancy_filter", &LidarDataConverter::setOccupancyFilter,
+              "Only keep the lidar coords in occupied cells of the occupancy grid", "occupancy_filter"_a)
+         .def("get_tracker", &LidarDataConverter::tracker, nb::rv_policy::reference_internal, "Get the obstacle tracker used in fused mode")
          .def("set_debug", &LidarDataConverter::setDebug, "Set the debug mode", "debug"_a)
     ;
+
+    m.attr("LIDAR_PIPELINE_DEFAULT_QUEUE_CAPACITY") = LIDAR_PIPELINE_DEFAULT_QUEUE_CAPACITY;
+
+    nb::class_<lidar_pipeline_frame_t>(m, "LidarPipelineFrame")
+        .def_prop_ro("sequence", [](const lidar_pipeline_frame_t& frame) { return frame.frame.sequence; },
+                     "Sequence number of the scan in the lidar scan history, 0 if none")
+        .def_prop_ro("capture_timestamp", [](const lidar_pipeline_frame_t& frame) { return frame.frame.capture_timestamp; },
+                     "CLOCK_MONOTONIC time of the end of the scan (ns), 0 if unknown")
+        .def_ro("point_count", &lidar_pipeline_frame_t::point_count, "Number of points published in lidar_coords")
+        .def_ro("publish_timestamp", &lidar_pipeline_frame_t::publish_timestamp,
+                "CLOCK_MONOTONIC time the points were published (ns)")
+    ;
+
+    nb::class_<lidar_pipeline_stage_statistics_t>(m, "LidarPipelineStageStatistics")
+        .def_ro("frames", &lidar_pipeline_stage_statistics_t::frames, "Number of frames processed by the stage")
+        .def_ro("dropped_frames", &lidar_pipeline_stage_statistics_t::dropped_frames,
+                "Number of frames dropped because the queue of the stage was full")
+        .def_ro("run_time_total", &lidar_pipeline_stage_statistics_t::run_time_total, "Total time spent in the stage (ns)")
+        .def_ro("run_time_max", &lidar_pipeline_stage_statistics_t::run_time_max, "Longest time spent in the stage (ns)")
+        .def_ro("queue_time_total", &lidar_pipeline_stage_statistics_t::queue_time_total,
+                "Total time from the publication of the points to the start of the stage (ns)")
+        .def_ro("queue_time_max", &lidar_pipeline_stage_statistics_t::queue_time_max,
+                "Longest time from the publication of the points to the start of the stage (ns)")
+    ;
+
+    nb::class_<LidarPipeline>(m, "LidarPipeline")
+         .def(nb::init<shared_memory::SharedMemory &, std::size_t>(),
+              "shared_memory"_a, "queue_capacity"_a = LIDAR_PIPELINE_DEFAULT_QUEUE_CAPACITY, nb::keep_alive<1, 2>(),
+              "Constructor of an in-process pipeline running the converter and the following stages in threads")
+         .def("get_converter", &LidarPipeline::converter, nb::rv_policy::reference_internal,
+              "Get the converter of the first stage, to configure it before start()")
+         .def("add_stage", &LidarPipeline::addStage, "name"_a, "stage"_a,
+              "Append a stage called with each LidarPipelineFrame after the previous stages, returns its index")
+         .def("stage_count", &LidarPipeline::stageCount, "Get the number of stages after the converter")
+         .def("start", &LidarPipeline::start, "Start the converter and stage threads")
+         .def("stop", &LidarPipeline::stop, nb::call_guard<nb::gil_scoped_release>(),
+              "Stop the threads and drop the queued frames")
+         .def("is_running", &LidarPipeline::isRunning, "Whether the threads are running")
+         .def("step", &LidarPipeline::step, "timeout_seconds"_a = -1.0, nb::call_guard<nb::gil_scoped_release>(),
+              "Convert the next scan and run all stages on it in the calling thread, returns False if timed out")
+         .def("get_stage_statistics", &LidarPipeline::getStageStatistics, "stage"_a, "Get a snapshot of the statistics of a stage")
+         .def("reset_statistics", &LidarPipeline::resetStatistics, "Reset the statistics of all stages")
+    ;
+
+    m.attr("MONITOR_FRAME_MAGIC") = MONITOR_FRAME_MAGIC;
+    m.attr("MONITOR_FRAME_VERSION") = MONITOR_FRAME_VERSION;
+    m.attr("MONITOR_FRAME_DEFAULT_RESOLUTION") = MONITOR_FRAME_DEFAULT_RESOLUTION;
+
+    nb::enum_<MonitorFrameType>(m, "MonitorFrameType")
+        .value("LidarPoints", MonitorFrameType::LidarPoints, "Lidar points in table coordinates")
+        .value("Obstacles", MonitorFrameType::Obstacles, "Circle and rectangle obstacles of the planner")
+    ;
+
+    m.def(
+        "encode_lidar_points",
+        [](nb::ndarray<const double, nb::shape<-1, 2>, nb::c_contig, nb::device::cpu> points, double resolution) {
+            std::vector<std::uint8_t> frame;
+            encodeLidarPoints(reinterpret_cast<const double (*)[2]>(points.data()), points.shape(0), resolution, frame);
+            return nb::bytes(reinterpret_cast<const char *>(frame.data()), frame.size());
+        },
+        "points"_a, "resolution"_a = MONITOR_FRAME_DEFAULT_RESOLUTION,
+        "Encode an array of [x, y] points (mm) into a lidar points monitor frame"
+    );
+    m.def(
+        "monitor_frame_type",
+        [](nb::bytes frame) {
+            return monitorFrameType(reinterpret_cast<const std::uint8_t *>(frame.c_str()), frame.size());
+        },
+        "frame"_a, "Get the type of a monitor frame, raises ValueError if it is not a valid monitor frame"
+    );
+    m.def(
+        "decode_lidar_points",
+        [](nb::bytes frame) {
+            std::vector<double> points;
+            decodeLidarPoints(reinterpret_cast<const std::uint8_t *>(frame.c_str()), frame.size(), points);
+            std::size_t count = points.size() / 2;
+            auto *copy = new double[std::max<std::size_t>(count, 1)][2];
+            std::memcpy(copy, points.data(), points.size() * sizeof(double));
+            nb::capsule owner(copy, [](void *p) noexcept { delete[] static_cast<double (*)[2]>(p); });
+            return nb::ndarray<double, nb::numpy, nb::shape<-1, 2>>((void *)copy, {count, 2}, owner);
+        },
+        "frame"_a, "Decode a lidar points monitor frame into an array of [x, y] points (mm)"
+    );
+    m.def(
+        "decode_obstacles",
+        [](nb::bytes frame) {
+            std::vector<monitor_obstacle_t> obstacles;
+            decodeObstacles(reinterpret_cast<const std::uint8_t *>(frame.c_str()), frame.size(), obstacles);
+            nb::list result;
+            for (const auto &obstacle : obstacles) {
+                nb::dict item;
+                item["x"] = obstacle.x;
+                item["y"] = obstacle.y;
+                item["angle"] = obstacle.angle;
+                if (obstacle.is_circle) {
+                    item["radius"] = obstacle.radius;
+                    item["vx"] = obstacle.vx;
+                    item["vy"] = obstacle.vy;
+                }
+                else {
+                    item["length_x"] = obstacle.length_x;
+                    item["length_y"] = obstacle.length_y;
+                }
+                nb::list bounding_box;
+                for (std::size_t i = 0; i + 1 < obstacle.bounding_box.size(); i += 2) {
+                    nb::dict point;
+                    point["x"] = obstacle.bounding_box[i];
+                    point["y"] = obstacle.bounding_box[i + 1];
+                    bounding_box.append(point);
+                }
+                item["bounding_box"] = bounding_box;
+                item["id"] = obstacle.id;
+                result.append(item);
+            }
+            return result;
+        },
+        "frame"_a, "Decode an obstacles monitor frame into the obstacle dicts sent to the dashboard"
+    );
+
+    nb::class_<MonitorFrameEncoder>(m, "MonitorFrameEncoder")
+         .def(nb::init<const std::string &>(), "Constructor for MonitorFrameEncoder", "name"_a)
+         .def("set_resolution", &MonitorFrameEncoder::setResolution,
+              "Set the quantization step of coordinates (mm), from 0.001 to 65.535", "resolution"_a)
+         .def("get_resolution", &MonitorFrameEncoder::resolution, "Get the quantization step of coordinates (mm)")
+         .def(
+            "encode_lidar_coords",
+            [](MonitorFrameEncoder &self) {
+                const std::vector<std::uint8_t> *frame;
+                {
+                    nb::gil_scoped_release release;
+                    frame = &self.encodeLidarCoords();
+                }
+                return nb::bytes(reinterpret_cast<const char *>(frame->data()), frame->size());
+            },
+            "Encode the latest lidar coords into a lidar points monitor frame"
+         )
+         .def(
+            "encode_obstacles",
+            [](MonitorFrameEncoder &self) {
+                const std::vector<std::uint8_t> *frame;
+                {
+                    nb::gil_scoped_release release;
+                    frame = &self.encodeObstacles();
+                }
+                return nb::bytes(reinterpret_cast<const char *>(frame->data()), frame->size());
+            },
+            "Encode the planner obstacles into an obstacles monitor frame"
+         )
+    ;
+
+    m.attr("CLUSTER_NOISE") = CLUSTER_NOISE;
+
+    nb::class_<LidarCoordsClusterer>(m, "LidarCoordsClusterer")
+         .def(nb::init<const std::string &>(), "Constructor for LidarCoordsClusterer", "name"_a)
+         .def("cluster", nb::overload_cast<>(&LidarCoordsClusterer::cluster), nb::call_guard<nb::gil_scoped_release>(),
+              "Cluster the latest lidar coords and write the obstacles to the detector obstacles, returns the number of clusters")
+         .def("set_cluster_eps", &LidarCoordsClusterer::setClusterEps,
+              "Set the maximum distance between two neighbor points (mm)", "cluster_eps"_a)
+         .def("set_cluster_min_samples", &LidarCoordsClusterer::setClusterMinSamples,
+              "Set the minimum number of neighbors of a core point, itself included", "cluster_min_samples"_a)
+         .def("set_min_radius", &LidarCoordsClusterer::setMinRadius, "Set the minimum radius of the obstacles (mm)", "min_radius"_a)
+         .def("set_track_obstacles", &LidarCoordsClusterer::setTrackObstacles,
+              "Track the obstacles, giving them stable identifiers and velocities", "track_obstacles"_a)
+         .def("get_tracker", &LidarCoordsClusterer::tracker, nb::rv_policy::reference_internal, "Get the obstacle tracker")
+         .def(
+            "get_points",
+            [](const LidarCoordsClusterer &self) {
+                std::size_t count = self.pointCount();
+                auto *copy = new double[std::max<std::size_t>(count, 1)][2];
+                std::memcpy(copy, self.points(), count * sizeof(*copy));
+                nb::capsule owner(copy, [](void *p) noexcept { delete[] static_cast<double (*)[2]>(p); });
+                return nb::ndarray<double, nb::numpy, nb::shape<-1, 2>>((void *)copy, {count, 2}, owner);
+            },
+            "Get a copy of the points of the last clustered scan"
+         )
+         .def(
+            "get_labels",
+            [](const LidarCoordsClusterer &self) {
+                std::size_t count = self.pointCount();
+                auto *copy = new std::int32_t[std::max<std::size_t>(count, 1)];
+                std::copy(self.labels(), self.labels() + count, copy);
+                nb::capsule owner(copy, [](void *p) noexcept { delete[] static_cast<std::int32_t *>(p); });
+                return nb::ndarray<std::int32_t, nb::numpy, nb::shape<-1>>((void *)copy, {count}, owner);
+            },
+            "Get a copy of the cluster labels of the points of the last clustered scan, CLUSTER_NOISE for noise"
+         )
+    ;
 }
 
 } // namespace utils
@@ -0,0 +1,144 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_utils
+/// @{
+/// @file
+/// @brief       LidarCoordsClusterer class declaration
+/// @author      Eric Courtois <eric.courtois@gmail.com>
+
+#pragma once
+
+#include "shared_memory/SharedMemory.hpp"
+#include "utils/ObstacleTracker.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace cogip {
+
+namespace utils {
+
+/// Label of the points which do not belong to any cluster.
+constexpr std::int32_t CLUSTER_NOISE = -1;
+
+/// Groups the lidar points in table coordinates into obstacles with DBSCAN.
+///
+/// Points are hashed into a uniform grid with a cell size of cluster_eps,
+/// so the neighbors of a point are only searched in its cell and the 8 adjacent cells.
+/// Clusters are the same as scikit-learn DBSCAN with the same parameters:
+/// a point has a neighbor at a distance up to cluster_eps, itself included,
+/// clusters are numbered in the order of their first core point,
+/// and a border point belongs to the first cluster reaching it.
+class LidarCoordsClusterer {
+public:
+    /// Constructs a clusterer with its own mapping of the shared memory.
+    /// @param name Name of the shared memory segment.
+    LidarCoordsClusterer(const std::string& name);
+
+    /// Constructs a clusterer using the shared memory of its owner.
+    /// @param shared_memory Shared memory, it must outlive the clusterer.
+    LidarCoordsClusterer(shared_memory::SharedMemory& shared_memory);
+
+    /// Clusters a copy of the latest lidar coords, see cluster(const double(*)[2], std::size_t).
+    /// @returns Number of clusters.
+    std::size_t cluster();
+
+    /// Clusters points in place and writes one circle per cluster to the detector obstacles,
+    /// under the DetectorObstacles lock, then posts an update on it.
+    /// The circle center is the mean of the cluster points and its radius the largest distance
+    /// from the center to a point along X or Y, at least the minimum radius.
+    /// In tracking mode, the circles update the tracker and the tracks are written instead.
+    /// @param points Points in table coordinates, they must not change until the next call.
+    /// @param count Number of points, at most MAX_LIDAR_DATA_COUNT.
+    /// @param timestamp CLOCK_MONOTONIC time of the points (ns), 0 for the current time.
+    /// @returns Number of clusters.
+    std::size_t cluster(const double (*points)[2], std::size_t count, std::uint64_t timestamp = 0);
+
+    /// Enable the tracking of the obstacles, giving them stable identifiers and velocities.
+    /// Enabling it restarts the tracker.
+    void setTrackObstacles(bool track_obstacles);
+
+    /// Tracker used in tracking mode.
+    ObstacleTracker& tracker() { return tracker_; }
+
+    /// Set the maximum distance between two neighbor points (mm).
+    void setClusterEps(double cluster_eps);
+
+    /// Set the minimum number of neighbors of a core point, itself included.
+    void setClusterMinSamples(std::size_t cluster_min_samples) {
+        cluster_min_samples_ = cluster_min_samples;
+    }
+
+    /// Set the minimum radius of the obstacles (mm).
+    void setMinRadius(double min_radius) {
+        min_radius_ = min_radius;
+    }
+
+    /// Number of points of the last clustered scan.
+    std::size_t pointCount() const { return point_count_; }
+
+    /// Points of the last clustered scan.
+    const double (*points() const)[2] { return points_view_; }
+
+    /// Cluster labels of the points of the last clustered scan, CLUSTER_NOISE for points without cluster.
+    const std::int32_t* labels() const { return labels_.data(); }
+
+private:
+    /// Constructs a clusterer using either a given shared memory or its own one.
+    LidarCoordsClusterer(
+        shared_memory::SharedMemory* shared_memory,
+        std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory
+    );
+
+    /// Number of bits of the grid hash table index.
+    static constexpr std::size_t GRID_HASH_BITS = 11;
+
+    /// Number of entries of the grid hash table, at least twice the number of points, so probe chains stay short.
+    static constexpr std::size_t GRID_HASH_SIZE = std::size_t(1) << GRID_HASH_BITS;
+
+    static_assert(GRID_HASH_SIZE >= 2 * shared_memory::MAX_LIDAR_DATA_COUNT, "Grid hash table too small");
+
+    /// Hash the points into the grid.
+    void buildGrid();
+
+    /// Find the grid cell of a key.
+    /// @returns Index of the cell in the hash table, holding the key or empty if the key is absent.
+    std::size_t findCell(std::uint64_t key) const;
+
+    /// Call a function with the index of each neighbor of a point, itself included.
+    template <typename Visit>
+    void forEachNeighbor(std::size_t index, Visit&& visit) const;
+
+    std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory_;  ///< Shared memory mapped by the clusterer, if any
+    shared_memory::SharedMemory& shared_memory_;                    ///< Shared memory instance
+    shared_memory::lidar_coords_buffer_t& lidar_coords_;            ///< Lidar coords triple buffer
+    models::CircleList& detector_obstacles_;                        ///< Obstacles found by the detector
+    shared_memory::WritePriorityLock& detector_obstacles_lock_;     ///< Lock of the detector obstacles
+    double cluster_eps_;                                            ///< Maximum distance between two neighbors
+    std::size_t cluster_min_samples_;                               ///< Minimum number of neighbors of a core point
+    double min_radius_;                                             ///< Minimum radius of the obstacles
+    bool track_obstacles_;                                          ///< Flag to enable the tracking mode
+    ObstacleTracker tracker_;                                       ///< Tracker of the obstacles
+
+    std::size_t point_count_;                                       ///< Number of points of the last scan
+    const double (*points_view_)[2];                                ///< Points of the last scan
+    std::array<double[2], shared_memory::MAX_LIDAR_DATA_COUNT> points_;             ///< Copy of the latest lidar coords
+    std::array<std::int32_t, shared_memory::MAX_LIDAR_DATA_COUNT> labels_;          ///< Cluster labels of the points
+    std::array<std::int32_t, shared_memory::MAX_LIDAR_DATA_COUNT> cell_x_;          ///< Grid column of the points
+    std::array<std::int32_t, shared_memory::MAX_LIDAR_DATA_COUNT> cell_y_;          ///< Grid row of the points
+    std::array<std::int32_t, shared_memory::MAX_LIDAR_DATA_COUNT> next_in_cell_;    ///< Next point of the same cell, -1 for the last one
+    std::array<bool, shared_memory::MAX_LIDAR_DATA_COUNT> core_;                    ///< Whether the points are core points
+    std::array<std::int32_t, shared_memory::MAX_LIDAR_DATA_COUNT> expansion_stack_; ///< Core points of the cluster being expanded
+    std::array<models::circle_t, shared_memory::MAX_LIDAR_DATA_COUNT> circles_;     ///< Circles of the clusters
+    std::array<std::uint64_t, GRID_HASH_SIZE> cell_keys_;                           ///< Keys of the grid cells
+    std::array<std::int32_t, GRID_HASH_SIZE> cell_heads_;                           ///< First point of the grid cells, -1 for empty entries
+};
+
+} // namespace utils
+
+} // namespace cogip
+
+/// @}
@@ -10,26 +10,106 @@
 
 #pragma once
 
+#include "shared_memory/LidarScanHistoryReader.hpp"
 #include "shared_memory/SharedMemory.hpp"
+#include "utils/LidarCoordsClusterer.hpp"
+#include "utils/ThreadConfig.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
 #include <thread>
 
 namespace cogip {
 
 namespace utils {
 
+/// Timeout of the waits of the converter thread for new lidar data (s).
+/// It bounds the time stop() waits for the thread.
+constexpr double LIDAR_DATA_CONVERTER_WAIT_TIMEOUT = 0.5;
+
+/// Default maximum age of the scans of the other lidars merged with the most recent scan (ns).
+constexpr std::uint64_t LIDAR_MERGE_DEFAULT_MAX_AGE = 200'000'000;
+
+/// Maximum number of angle regions of interest of each lidar.
+constexpr std::size_t LIDAR_ANGLE_ROIS_MAX = 8;
+
+/// Number of slots of the voxel hash table, a power of 2 at least twice MAX_LIDAR_DATA_COUNT.
+constexpr std::size_t LIDAR_VOXEL_TABLE_SIZE = 2048;
+
+/// Angle region of interest of a lidar, in the lidar frame.
+/// It wraps through 0 if the min angle is above the max angle.
+struct lidar_angle_roi_t {
+    double min_angle;  ///< Start of the region (deg, in [0, 360)).
+    double max_angle;  ///< End of the region (deg, in [0, 360)).
+};
+
+/// Placement of a lidar in the robot frame.
+struct lidar_extrinsics_t {
+    double offset_x;  ///< Offset of the lidar on the X axis of the robot (mm).
+    double offset_y;  ///< Offset of the lidar on the Y axis of the robot (mm).
+    double angle;     ///< Angle of the lidar 0 deg axis from the X axis of the robot, counter clockwise (deg).
+};
+
+/// Statistics of a LidarDataConverter, accumulated since its construction or the last reset.
+/// Times are in nanoseconds, measured with CLOCK_MONOTONIC.
+struct lidar_data_converter_statistics_t {
+    std::uint64_t elapsed;               ///< Time since the statistics were reset.
+    std::uint64_t conversions;           ///< Number of converted scans.
+    double conversions_per_second;       ///< Average conversion rate.
+    std::uint64_t dropped_scans;         ///< Number of scans published by the driver but never converted.
+    std::uint64_t timeouts;              ///< Number of waits for new lidar data which timed out.
+    std::uint64_t points_in;             ///< Number of points read from the lidar data.
+    std::uint64_t points_out;            ///< Number of points written to the lidar coords, inside the table.
+    std::uint64_t conversion_time_total; ///< Total time from the data update to the coords update.
+    std::uint64_t conversion_time_max;   ///< Longest time from the data update to the coords update.
+    std::uint64_t timed_conversions;     ///< Number of converted scans with a timing header.
+    std::uint64_t scan_latency_total;    ///< Total time from the end of the scans with a timing header to the coords update.
+    std::uint64_t scan_latency_max;      ///< Longest time from the end of a scan with a timing header to the coords update.
+    std::uint64_t clustering_time_total; ///< Total time spent clustering the coords in fused mode.
+    std::uint64_t clustering_time_max;   ///< Longest time spent clustering the coords of a scan in fused mode.
+    std::uint64_t merged_points_dropped; ///< Number of points of merged scans dropped because the lidar coords are full.
+    std::uint64_t points_filtered;       ///< Number of points dropped by the pre-filter, outside the angle ROIs or decimated.
+    std::uint64_t points_downsampled;    ///< Number of points inside the table merged with another point of their voxel.
+};
+
 class LidarDataConverter {
 public:
+    /// Constructs a converter with its own mapping of the shared memory.
+    /// @param name Name of the shared memory segment.
     LidarDataConverter(const std::string& name);
+
+    /// Constructs a converter on a shared memory of the process, usually an in-process one
+    /// shared with the drivers and the planner of an in-process pipeline.
+    /// The converter waits for updates on the LidarData lock of this instance,
+    /// no other consumer may wait on it through the same instance.
+    /// @param shared_memory Shared memory, it must outlive the converter.
+    LidarDataConverter(shared_memory::SharedMemory& shared_memory);
+
     ~LidarDataConverter();
 
-    /// Start converting lidar data to table coordinates.
+    /// Start converting lidar data to table coordinates in a thread.
     void start();
 
+    /// Set the scheduling of the converter thread, applied at each start and at once if the thread runs.
+    /// @throws std::invalid_argument if the configuration is invalid.
+    /// @throws std::runtime_error if the system refuses the configuration of the running thread.
+    void setThreadConfig(const thread_config_t& config);
+
     /// Stop converting lidar data to table coordinates.
+    /// The thread notices it at the latest after LIDAR_DATA_CONVERTER_WAIT_TIMEOUT.
     void stop();
 
-    /// Convert lidar data to table coordinates.
-    void convert();
+    /// Wait for new lidar data and convert it to table coordinates.
+    /// @param timeout_seconds Timeout in seconds. If negative, wait indefinitely.
+    /// @return True if a scan was converted, false if timed out.
+    bool convert(double timeout_seconds = -1.0);
+
+    /// Returns a snapshot of the statistics.
+    lidar_data_converter_statistics_t getStatistics() const;
+
+    /// Reset the statistics.
+    void resetStatistics();
 
     /// Set current pose index.
     void setPoseCurrentIndex(std::size_t index) {
@@ -41,36 +121,282 @@ public:
         table_limits_margin_ = table_limits_margin;
     }
 
-    /// Set the lidar offset on X axis.
+    /// Set the offset on X axis of the first lidar.
     void setLidarOffsetX(double lidar_offset_x) {
-        lidar_offset_x_ = lidar_offset_x;
+        lidar_extrinsics_[0].offset_x = lidar_offset_x;
     }
 
-    /// Set the lidar offset on Y axis.
+    /// Set the offset on Y axis of the first lidar.
     void setLidarOffsetY(double lidar_offset_y) {
-        lidar_offset_y_ = lidar_offset_y;
+        lidar_extrinsics_[0].offset_y = lidar_offset_y;
+    }
+
+    /// Set the number of lidars of the robot, identified by the source index of their scans.
+    /// With more than one lidar, the latest scan of each lidar is read from the lidar scan history,
+    /// and the scans are merged in the same lidar coords, so scans coalesced by the wait are not lost.
+    /// Each scan is converted with the robot pose at its end, or at each point in deskew mode,
+    /// and scans older than the merge max age compared to the most recent one are left out.
+    /// The points beyond the capacity of the lidar coords are dropped.
+    /// @throws std::invalid_argument if the count is 0 or above shared_memory::LIDAR_SOURCES_MAX.
+    void setLidarSourceCount(std::size_t count);
+
+    /// Set the placement of a lidar in the robot frame.
+    /// @throws std::invalid_argument if the source is not below shared_memory::LIDAR_SOURCES_MAX.
+    void setLidarExtrinsics(std::size_t source, double offset_x, double offset_y, double angle);
+
+    /// Get the placement of a lidar in the robot frame.
+    /// @throws std::invalid_argument if the source is not below shared_memory::LIDAR_SOURCES_MAX.
+    lidar_extrinsics_t getLidarExtrinsics(std::size_t source) const;
+
+    /// Set the maximum age of the scans merged with the most recent one (ns).
+    void setMergeMaxAge(std::uint64_t max_age) {
+        merge_max_age_ = max_age;
+    }
+
+    /// Add an angle region of interest to a lidar.
+    /// Once a lidar has regions of interest, its points outside of all of them are dropped before their conversion,
+    /// so the points hitting the robot mechanics are never converted.
+    /// @param source Index of the lidar.
+    /// @param min_angle Start of the region in the lidar frame (deg), any range.
+    /// @param max_angle End of the region in the lidar frame (deg), any range, the region wraps through 0 if below min_angle.
+    /// @throws std::invalid_argument if the source is not below shared_memory::LIDAR_SOURCES_MAX
+    ///         or if the lidar already has LIDAR_ANGLE_ROIS_MAX regions.
+    void addAngleRoi(std::size_t source, double min_angle, double max_angle);
+
+    /// Remove the angle regions of interest of a lidar, all its points are converted again.
+    /// @throws std::invalid_argument if the source is not below shared_memory::LIDAR_SOURCES_MAX.
+    void clearAngleRois(std::size_t source);
+
+    /// Set the range-dependent angular decimation of the scans, run before their conversion.
+    /// Beyond the min distance, a point is dropped if the arc from the previous kept point of its scan
+    /// is shorter than the spacing and their distances differ by less than the spacing,
+    /// so far walls keep about one point per spacing while obstacle edges and near-field points are kept.
+    /// @param min_distance Distance below which all points are kept (mm).
+    /// @param spacing Minimum spacing between the kept far points (mm), 0 to disable the decimation.
+    /// @throws std::invalid_argument if a parameter is negative.
+    void setDecimation(double min_distance, double spacing);
+
+    /// Set the size of the voxel grid downsampling the converted points inside the table.
+    /// The points of the same cell are replaced by their centroid.
+    /// @param voxel_size Size of the cells (mm), 0 to disable the downsampling.
+    /// @throws std::invalid_argument if the size is negative.
+    void setVoxelSize(double voxel_size);
+
+    /// Enable motion compensation (deskew) of the scans.
+    /// Each point is then converted with the robot pose interpolated at its time,
+    /// using the lidar scan timing headers and the pose buffer timestamps.
+    /// Scans without timing header fall back to the pose at the current pose index.
+    void setDeskew(bool deskew) {
+        deskew_ = deskew;
+    }
+
+    /// Read the scans in the compact format of the lidar scan history instead of the lidar_data triple buffer.
+    /// Each point is read as 5 bytes instead of 24, at the cost of the quantization of the compact format,
+    /// see shared_memory::lidar_compact_points_t.
+    void setCompactInput(bool compact_input) {
+        compact_input_ = compact_input;
+    }
+
+    /// Set the duration of the blocks of points sharing the same interpolated pose in deskew mode.
+    /// @param duration Block duration (ns), 0 to interpolate the pose of each point.
+    void setDeskewBlockDuration(std::uint64_t duration) {
+        deskew_block_duration_ = duration;
+    }
+
+    /// Enable the fused convert-and-cluster mode.
+    /// The converter thread then clusters the coords it just published and writes the obstacles
+    /// to the detector obstacles itself, see LidarCoordsClusterer.
+    void setClusterObstacles(bool cluster_obstacles) {
+        cluster_obstacles_ = cluster_obstacles;
+    }
+
+    /// Set the maximum distance between two neighbor points in fused mode (mm).
+    void setClusterEps(double cluster_eps) {
+        clusterer_.setClusterEps(cluster_eps);
+    }
+
+    /// Set the minimum number of neighbors of a core point in fused mode, itself included.
+    void setClusterMinSamples(std::size_t cluster_min_samples) {
+        clusterer_.setClusterMinSamples(cluster_min_samples);
+    }
+
+    /// Set the minimum radius of the obstacles in fused mode (mm).
+    void setObstacleMinRadius(double min_radius) {
+        clusterer_.setMinRadius(min_radius);
+    }
+
+    /// Enable the tracking of the obstacles in fused mode, see LidarCoordsClusterer::setTrackObstacles().
+    void setTrackObstacles(bool track_obstacles) {
+        clusterer_.setTrackObstacles(track_obstacles);
+    }
+
+    /// Enable the occupancy grid over the table limits, published in the shared memory.
+    /// Each scan adds OCCUPANCY_GRID_HIT to the cells of its points inside the table
+    /// and OCCUPANCY_GRID_MISS to the cells crossed by the rays from the lidar to these points.
+    /// The grid restarts empty when it is enabled or when the table limits or the resolution change.
+    void setOccupancyGrid(bool occupancy_grid) {
+        occupancy_grid_enabled_ = occupancy_grid;
+    }
+
+    /// Set the size of the cells of the occupancy grid (mm).
+    /// It is increased if the table needs more than OCCUPANCY_GRID_MAX_CELLS cells.
+    void setOccupancyGridResolution(double resolution);
+
+    /// Only keep the lidar coords in occupied cells of the occupancy grid,
+    /// so points seen on a single scan are filtered out. Ignored if the grid is disabled.
+    void setOccupancyFilter(bool occupancy_filter) {
+        occupancy_filter_ = occupancy_filter;
     }
 
+    /// Tracker of the obstacles in fused mode.
+    ObstacleTracker& tracker() { return clusterer_.tracker(); }
+
     /// Set the debug mode.
     void setDebug(bool debug) {
         debug_ = debug;
     }
 
 private:
-    shared_memory::SharedMemory shared_memory_;                   ///< Shared memory instance
-    double (*lidar_data_)[3];                                     ///< Pointer to lidar data memory
-    double (*lidar_coords_)[2];                                   ///< Pointer to lidar coords memory
-    cogip::shared_memory::WritePriorityLock data_read_lock_;      ///< Lock for reading lidar data
-    cogip::shared_memory::WritePriorityLock coords_write_lock_;   ///< Lock for writing lidar coordinates
-    models::PoseBuffer* pose_current_buffer_;                     ///< Pointer to the current pose buffer
+    /// Constructs a converter using either a given shared memory or its own one.
+    LidarDataConverter(
+        shared_memory::SharedMemory* shared_memory,
+        std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory
+    );
+
+    /// Copy the latest scan from the lidar data triple buffer to the scan buffers.
+    /// @returns Number of points of the scan.
+    std::size_t copyScan();
+
+    /// Copy the latest scan from the compact lidar scan history to the scan buffers.
+    /// @returns Number of points of the scan.
+    std::size_t copyCompactScan();
+
+    /// Read the new scans of the lidar scan history, then copy the latest scan of each lidar to the scan buffers.
+    /// @returns Number of points of the merged scans.
+    std::size_t copyMergedScans();
+
+    /// Drop the points of the scan buffers outside the angle ROIs of their lidar or removed by the decimation,
+    /// and compact the segments. Also copies the time offsets of the kept points.
+    /// @returns Number of points kept.
+    std::size_t filterSegments();
+
+    /// Replace the points of the same voxel by their centroid, in place.
+    /// @returns Number of points left.
+    std::size_t downsample(shared_memory::lidar_coords_t& lidar_coords, std::size_t count);
+
+    /// Convert Lidar-relative polar coordinates of a segment of the scan buffers to Cartesian coordinates.
+    /// @param begin Index of the first point of the segment.
+    /// @param end Index past the last point of the segment.
+    /// @param angle Angle of the lidar in the robot frame (deg).
+    void polarToCartesian(std::size_t begin, std::size_t end, double angle);
+
+    /// Transform a block of points of the scan buffers to table coordinates.
+    /// @param begin Index of the first point of the block.
+    /// @param end Index past the last point of the block.
+    /// @param pose Robot pose used for all points of the block.
+    /// @param extrinsics Placement of the lidar of the block in the robot frame.
+    void transformBlock(std::size_t begin, std::size_t end, const cogip::models::pose_t& pose,
+                        const lidar_extrinsics_t& extrinsics);
+
+    /// Restart the occupancy grid empty, with the current table limits and resolution.
+    void resetOccupancyGrid();
+
+    /// Integrate the points of the scan buffers, in table coordinates, in the occupancy grid.
+    /// Also flags the points in occupied cells.
+    void updateOccupancyGrid(std::size_t count);
+
+    std::unique_ptr<shared_memory::SharedMemory> owned_shared_memory_;  ///< Shared memory mapped by the converter, if any
+    shared_memory::SharedMemory& shared_memory_;                  ///< Shared memory instance
+    shared_memory::lidar_data_buffer_t& lidar_data_;              ///< Lidar data triple buffer
+    shared_memory::lidar_coords_buffer_t& lidar_coords_;          ///< Lidar coords triple buffer
+    cogip::shared_memory::WritePriorityLock& data_read_lock_;     ///< Lock waited for new lidar data
+    cogip::shared_memory::WritePriorityLock& coords_write_lock_;  ///< Lock posted on new lidar coordinates
     std::size_t pose_current_index_;                              ///< Index of the current pose
+    bool compact_input_;                                          ///< Flag to read the scans from the compact scan history
+    bool deskew_;                                                 ///< Flag to enable motion compensation
+    std::uint64_t deskew_block_duration_;                         ///< Duration of the blocks sharing a pose (ns)
+    bool cluster_obstacles_;                                      ///< Flag to enable the fused convert-and-cluster mode
+    LidarCoordsClusterer clusterer_;                              ///< Clusterer used in fused mode
+    bool occupancy_grid_enabled_;                                 ///< Flag to enable the occupancy grid
+    bool occupancy_filter_;                                       ///< Flag to only keep the points in occupied cells
+    double occupancy_grid_resolution_;                            ///< Requested size of the occupancy grid cells (mm)
+    double occupancy_grid_reset_resolution_;                      ///< Requested size of the cells at the last grid reset (mm)
+    double occupancy_grid_limits_[4];                             ///< Table limits at the last grid reset
     double* table_limits_;                                        ///< Pointer to table limits
     double table_limits_margin_;                                  ///< Margin for table limits
-    double lidar_offset_x_;                                       ///< Lidar offset on X axis
-    double lidar_offset_y_;                                       ///< Lidar offset on Y axis
-    bool running_;                                                ///< Flag to indicate if the converter is running
+    std::array<lidar_extrinsics_t, shared_memory::LIDAR_SOURCES_MAX> lidar_extrinsics_;  ///< Placement of each lidar
+    std::size_t lidar_source_count_;                              ///< Number of lidars of the robot
+    std::uint64_t merge_max_age_;                                 ///< Maximum age of the merged scans (ns)
+    shared_memory::LidarScanHistoryReader history_reader_;        ///< Reader of the scans to merge
+    std::array<std::array<lidar_angle_roi_t, LIDAR_ANGLE_ROIS_MAX>, shared_memory::LIDAR_SOURCES_MAX> angle_rois_;  ///< Angle ROIs of each lidar
+    std::array<std::size_t, shared_memory::LIDAR_SOURCES_MAX> angle_roi_counts_;  ///< Number of angle ROIs of each lidar
+    double decimation_min_distance_;                              ///< Distance below which all points are kept (mm)
+    double decimation_spacing_;                                   ///< Minimum spacing between the kept far points (mm)
+    double voxel_size_;                                           ///< Size of the downsampling voxels (mm)
+    std::atomic<bool> running_;                                   ///< Flag to indicate if the converter is running
     std::thread thread_;                                          ///< Thread for the converter
+    thread_config_t thread_config_;                               ///< Scheduling of the converter thread
     bool debug_;                                                  ///< Flag to enable debug mode
+
+    // Statistics counters, written by the converter thread and read by any thread.
+    // Counters are updated with relaxed atomic operations, every field is consistent but not the whole set.
+    std::atomic<std::uint64_t> statistics_start_;       ///< Time the statistics were reset
+    std::atomic<std::uint64_t> conversions_;            ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> dropped_scans_;          ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> timeouts_;               ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> points_in_;              ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> points_out_;             ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> conversion_time_total_;  ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> conversion_time_max_;    ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> timed_conversions_;      ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> scan_latency_total_;     ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> scan_latency_max_;       ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> clustering_time_total_;  ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> clustering_time_max_;    ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> merged_points_dropped_;  ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> points_filtered_;        ///< See lidar_data_converter_statistics_t
+    std::atomic<std::uint64_t> points_downsampled_;     ///< See lidar_data_converter_statistics_t
+
+    // Scans are copied in structure-of-arrays buffers, so the conversion loops do not depend on each other
+    // and can be vectorized by the compiler.
+    shared_memory::lidar_scan_header_t scan_header_;              ///< Timing header of the copied scan
+    shared_memory::lidar_compact_points_t compact_points_;        ///< Copied scan in compact input mode
+    std::array<double, shared_memory::MAX_LIDAR_DATA_COUNT> scan_angles_;     ///< Angles of the copied scan (deg)
+    std::array<double, shared_memory::MAX_LIDAR_DATA_COUNT> scan_distances_;  ///< Distances of the copied scan
+    std::array<double, shared_memory::MAX_LIDAR_DATA_COUNT> scan_x_;  ///< X coordinates, relative to the lidar then to the table
+    std::array<double, shared_memory::MAX_LIDAR_DATA_COUNT> scan_y_;  ///< Y coordinates, relative to the lidar then to the table
+    std::array<double, shared_memory::MAX_LIDAR_DATA_COUNT> scan_origin_x_;  ///< X coordinates of the lidar at the time of the points
+    std::array<double, shared_memory::MAX_LIDAR_DATA_COUNT> scan_origin_y_;  ///< Y coordinates of the lidar at the time of the points
+    std::array<bool, shared_memory::MAX_LIDAR_DATA_COUNT> scan_occupied_;    ///< Whether the points are in occupied cells
+    std::array<std::uint32_t, shared_memory::MAX_LIDAR_DATA_COUNT> scan_offsets_;  ///< Time offsets of the points from the start of their scan (ns)
+
+    // Voxel grid downsampling, an open addressing hash table from the voxels to their centroids.
+    std::array<std::uint64_t, LIDAR_VOXEL_TABLE_SIZE> voxel_keys_;     ///< Voxel of each slot
+    std::array<std::uint32_t, LIDAR_VOXEL_TABLE_SIZE> voxel_slots_;    ///< Index of the centroid of each slot, or empty
+    std::array<double, shared_memory::MAX_LIDAR_DATA_COUNT> voxel_sum_x_;         ///< Sum of the X coordinates of each voxel
+    std::array<double, shared_memory::MAX_LIDAR_DATA_COUNT> voxel_sum_y_;         ///< Sum of the Y coordinates of each voxel
+    std::array<std::uint32_t, shared_memory::MAX_LIDAR_DATA_COUNT> voxel_counts_; ///< Number of points of each voxel
+
+    /// Latest scan of a lidar, kept to be merged with the scans of the other lidars.
+    struct source_scan_t {
+        bool valid;                                   ///< Whether a scan was read for this lidar
+        shared_memory::lidar_scan_header_t header;    ///< Timing of the scan
+        shared_memory::lidar_compact_points_t points; ///< Points of the scan
+    };
+
+    /// Points of the scan buffers measured by the same lidar in the same scan.
+    struct scan_segment_t {
+        std::size_t begin;                                 ///< Index of the first point
+        std::size_t end;                                   ///< Index past the last point
+        std::size_t source;                                ///< Index of the lidar
+        const shared_memory::lidar_scan_header_t* header;  ///< Timing of the scan
+    };
+
+    std::array<source_scan_t, shared_memory::LIDAR_SOURCES_MAX> source_scans_;     ///< Latest scan of each lidar
+    std::array<scan_segment_t, shared_memory::LIDAR_SOURCES_MAX> scan_segments_;   ///< Segments of the scan buffers
+    std::size_t scan_segment_count_;                                               ///< Number of segments
+
+    shared_memory::occupancy_grid_t occupancy_grid_;              ///< Occupancy grid, copied to the shared memory after each scan
 };
 
 } // namespace utils
@@ -0,0 +1,170 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_utils
+/// @{
+/// @file
+/// @brief       In-process pipeline chaining the lidar data converter and the following stages
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include "shared_memory/SharedMemory.hpp"
+#include "utils/LidarDataConverter.hpp"
+#include "utils/SpscQueue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cogip {
+
+namespace utils {
+
+/// Default number of frames queued before each stage of a LidarPipeline.
+constexpr std::size_t LIDAR_PIPELINE_DEFAULT_QUEUE_CAPACITY = 4;
+
+/// Timeout of the waits of the pipeline threads for a frame (s).
+/// It bounds the time stop() waits for the threads.
+constexpr double LIDAR_PIPELINE_WAIT_TIMEOUT = 0.5;
+
+/// Frame passed from stage to stage of a LidarPipeline.
+struct lidar_pipeline_frame_t {
+    shared_memory::latency_frame_t frame;  ///< Scan converted, as followed by the latency histograms.
+    std::uint32_t point_count;             ///< Number of points published in lidar_coords.
+    std::uint64_t publish_timestamp;       ///< CLOCK_MONOTONIC time the points were published (ns).
+};
+
+/// Function run by a stage of a LidarPipeline on each frame.
+/// It reads the shared memory of the pipeline, as a process attached to it would.
+using lidar_pipeline_stage_t = std::function<void(const lidar_pipeline_frame_t&)>;
+
+/// Statistics of a stage of a LidarPipeline, accumulated since its construction or the last reset.
+/// Times are in nanoseconds, measured with CLOCK_MONOTONIC.
+struct lidar_pipeline_stage_statistics_t {
+    std::uint64_t frames;            ///< Number of frames processed by the stage.
+    std::uint64_t dropped_frames;    ///< Number of frames dropped because the queue of the stage was full.
+    std::uint64_t run_time_total;    ///< Total time spent in the stage function.
+    std::uint64_t run_time_max;      ///< Longest time spent in the stage function.
+    std::uint64_t queue_time_total;  ///< Total time from the publication of the points to the start of the stage.
+    std::uint64_t queue_time_max;    ///< Longest time from the publication of the points to the start of the stage.
+};
+
+/// @class LidarPipeline
+/// Runs the lidar data converter and the following stages in one process, each in its own thread,
+/// chained by lock-free SPSC queues.
+///
+/// Bench, replay and simulation builds attach the drivers, the converter and the planner to one SharedMemory,
+/// usually created in-process, so scans, points and obstacles are exchanged through the same data structures
+/// as between processes, without named segments. The converter thread waits for the scans of the drivers
+/// on the LidarData lock, converts them, then queues a frame for the first stage. Each stage thread pops its frames,
+/// runs its function, then queues the frame for the next stage. A stage which does not keep up drops frames
+/// instead of delaying the previous stages, as processes coalesce updates.
+///
+/// The production build keeps running each stage in its own process, attached to the named segment.
+class LidarPipeline {
+public:
+    /// Constructor.
+    /// @param shared_memory Shared memory of the stages, it must outlive the pipeline.
+    /// @param queue_capacity Number of frames queued before each stage, rounded up to a power of two.
+    /// @throws std::invalid_argument if the queue capacity is 0.
+    LidarPipeline(
+        shared_memory::SharedMemory& shared_memory,
+        std::size_t queue_capacity = LIDAR_PIPELINE_DEFAULT_QUEUE_CAPACITY
+    );
+
+    /// Stops the threads.
+    ~LidarPipeline();
+
+    /// Copying is disallowed, threads run on the pipeline.
+    LidarPipeline(const LidarPipeline&) = delete;
+    LidarPipeline& operator=(const LidarPipeline&) = delete;
+
+    /// Converter of the first stage, configured before start().
+    LidarDataConverter& converter() { return converter_; }
+
+    /// Appends a stage, run on each frame after the previous stages.
+    /// @param name Name of the stage, also the name of its thread if short enough.
+    /// @param stage Function of the stage.
+    /// @returns Index of the stage.
+    /// @throws std::invalid_argument if the function is empty.
+    /// @throws std::runtime_error if the pipeline is running.
+    std::size_t addStage(const std::string& name, lidar_pipeline_stage_t stage);
+
+    /// Number of stages after the converter.
+    std::size_t stageCount() const { return stages_.size(); }
+
+    /// Name of a stage.
+    /// @throws std::out_of_range if the stage does not exist.
+    const std::string& stageName(std::size_t stage) const { return stages_.at(stage)->name; }
+
+    /// Starts the converter and stage threads.
+    void start();
+
+    /// Stops the threads and drops the queued frames.
+    void stop();
+
+    /// Whether the threads are running.
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    /// Converts the next scan and runs all stages on it in the calling thread, while the threads are not running,
+    /// so replays and benches can run the pipeline deterministically.
+    /// @param timeout_seconds Timeout of the wait for the scan in seconds. If negative, wait indefinitely.
+    /// @returns `true` if a scan was converted, `false` if timed out.
+    /// @throws std::runtime_error if the pipeline is running.
+    bool step(double timeout_seconds = -1.0);
+
+    /// Returns a snapshot of the statistics of a stage.
+    /// @throws std::out_of_range if the stage does not exist.
+    lidar_pipeline_stage_statistics_t getStageStatistics(std::size_t stage) const;
+
+    /// Resets the statistics of all stages, the converter statistics are reset by the converter.
+    void resetStatistics();
+
+private:
+    /// Stage after the converter.
+    struct Stage {
+        Stage(const std::string& name, lidar_pipeline_stage_t function, std::size_t queue_capacity):
+            name(name), function(std::move(function)), queue(queue_capacity) {}
+
+        std::string name;                        ///< Name of the stage.
+        lidar_pipeline_stage_t function;         ///< Function of the stage.
+        SpscQueue<lidar_pipeline_frame_t> queue; ///< Frames waiting for the stage.
+        std::thread thread;                      ///< Thread of the stage.
+        std::atomic<std::uint64_t> frames{0};
+        std::atomic<std::uint64_t> dropped_frames{0};
+        std::atomic<std::uint64_t> run_time_total{0};
+        std::atomic<std::uint64_t> run_time_max{0};
+        std::atomic<std::uint64_t> queue_time_total{0};
+        std::atomic<std::uint64_t> queue_time_max{0};
+    };
+
+    /// Converts a scan, then returns the frame of the published points.
+    /// @returns `false` if timed out.
+    bool convert(double timeout_seconds, lidar_pipeline_frame_t& frame);
+
+    /// Runs a stage on a frame and updates its statistics.
+    void runStage(Stage& stage, const lidar_pipeline_frame_t& frame);
+
+    /// Queues a frame for a stage, or drops it if the queue of the stage is full.
+    void queueFrame(std::size_t stage, const lidar_pipeline_frame_t& frame);
+
+    shared_memory::SharedMemory& shared_memory_;  ///< Shared memory of the stages.
+    LidarDataConverter converter_;                ///< First stage.
+    std::size_t queue_capacity_;                  ///< Number of frames queued before each stage.
+    std::vector<std::unique_ptr<Stage>> stages_;  ///< Stages after the converter.
+    std::thread converter_thread_;                ///< Thread of the converter.
+    std::atomic<bool> running_{false};            ///< True while the threads must keep running.
+};
+
+} // namespace utils
+
+} // namespace cogip
+
+/// @}
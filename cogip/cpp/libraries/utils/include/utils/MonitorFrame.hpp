@@ -0,0 +1,148 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_utils
+/// @{
+/// @file
+/// @brief       Compact binary frames of lidar points and obstacles streamed to the monitor
+/// @author      Eric Courtois <eric.courtois@gmail.com>
+
+#pragma once
+
+#include "shared_memory/SharedMemory.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cogip {
+
+namespace utils {
+
+/// First bytes of every monitor frame, "CF" in little-endian order.
+constexpr std::uint16_t MONITOR_FRAME_MAGIC = 0x4643;
+
+/// Version of the monitor frame layout, incremented on every incompatible change.
+constexpr std::uint8_t MONITOR_FRAME_VERSION = 1;
+
+/// Size of the monitor frame header in bytes.
+constexpr std::size_t MONITOR_FRAME_HEADER_SIZE = 8;
+
+/// Default size of the quantization step of coordinates (mm).
+constexpr double MONITOR_FRAME_DEFAULT_RESOLUTION = 1.0;
+
+/// Content of a monitor frame.
+enum class MonitorFrameType : std::uint8_t {
+    LidarPoints = 1,  ///< Lidar points in table coordinates.
+    Obstacles = 2,    ///< Circle and rectangle obstacles of the planner.
+};
+
+/// Obstacle decoded from a monitor frame, coordinates and lengths in mm.
+struct monitor_obstacle_t {
+    std::uint32_t id;          ///< Identifier.
+    bool is_circle;            ///< True for a circle, false for a rectangle.
+    double x;                  ///< X coordinate of the center.
+    double y;                  ///< Y coordinate of the center.
+    double angle;              ///< Orientation of a rectangle (deg), 0 for a circle.
+    double radius;             ///< Radius of a circle, 0 for a rectangle.
+    double length_x;           ///< Length of a rectangle along its X axis, 0 for a circle.
+    double length_y;           ///< Length of a rectangle along its Y axis, 0 for a circle.
+    double vx;                 ///< Velocity of a tracked circle along X (mm/s), 0 for a rectangle.
+    double vy;                 ///< Velocity of a tracked circle along Y (mm/s), 0 for a rectangle.
+    std::vector<double> bounding_box;  ///< Bounding box points, as [x, y] pairs.
+};
+
+/// Monitor frames are little-endian and start with an 8 bytes header:
+/// magic (uint16), version (uint8), type (uint8), resolution in µm (uint16) and item count (uint16).
+///
+/// Coordinates are quantized to int16 multiples of the resolution, which covers ±32 m at 1 mm.
+/// Point sequences are delta-encoded: each point is stored as its difference from the previous one
+/// (from the obstacle center for bounding boxes, from the origin for the first lidar point),
+/// zigzag-mapped then written as a variable length integer of 7 bits per byte.
+/// Consecutive lidar points of a scan are close, so most of them take 2 bytes instead of 16.
+///
+/// A lidar points frame holds the deltas of its count points.
+/// An obstacles frame holds its count obstacles, each made of: id (uint32), kind (uint8, 0 for
+/// a circle, 1 for a rectangle), x and y (int16), then radius (uint16), vx and vy (int16, mm/s)
+/// for a circle, or angle (int16, 0.01 deg), length_x and length_y (uint16) for a rectangle,
+/// and finally the number of bounding box points (uint8) followed by their deltas.
+
+/// Encodes lidar points into a monitor frame.
+/// @param points Points in table coordinates (mm).
+/// @param count Number of points, at most 65535.
+/// @param resolution Quantization step (mm), from 0.001 to 65.535.
+/// @param[out] frame The frame, replaced.
+void encodeLidarPoints(const double (*points)[2], std::size_t count, double resolution, std::vector<std::uint8_t>& frame);
+
+/// Encodes the planner obstacles into a monitor frame, only their used bounding box points are kept.
+/// @param circles Circle obstacles.
+/// @param rectangles Rectangle obstacles.
+/// @param resolution Quantization step (mm), from 0.001 to 65.535.
+/// @param[out] frame The frame, replaced.
+void encodeObstacles(
+    const obstacles::compact_obstacle_circle_list_t& circles,
+    const obstacles::compact_obstacle_polygon_list_t& rectangles,
+    double resolution,
+    std::vector<std::uint8_t>& frame
+);
+
+/// Reads the type of a monitor frame, checking its header.
+/// @throws std::invalid_argument if the frame is truncated, not a monitor frame or of another version.
+MonitorFrameType monitorFrameType(const std::uint8_t* data, std::size_t size);
+
+/// Decodes a lidar points frame.
+/// @param data The frame.
+/// @param size Size of the frame in bytes.
+/// @param[out] points The points, as [x, y] pairs in mm, replaced.
+/// @throws std::invalid_argument if the frame is invalid or not a lidar points frame.
+void decodeLidarPoints(const std::uint8_t* data, std::size_t size, std::vector<double>& points);
+
+/// Decodes an obstacles frame.
+/// @param data The frame.
+/// @param size Size of the frame in bytes.
+/// @param[out] obstacles The obstacles, replaced.
+/// @throws std::invalid_argument if the frame is invalid or not an obstacles frame.
+void decodeObstacles(const std::uint8_t* data, std::size_t size, std::vector<monitor_obstacle_t>& obstacles);
+
+/// Encodes the shared memory lidar coords and planner obstacles into monitor frames,
+/// so they are streamed without being converted to Python objects.
+/// Frame buffers are kept between calls, so encoding does not allocate once they reached their size.
+class MonitorFrameEncoder {
+public:
+    /// Constructs an encoder with its own mapping of the shared memory.
+    /// @param name Name of the shared memory segment.
+    MonitorFrameEncoder(const std::string& name);
+
+    /// Set the quantization step of coordinates (mm), from 0.001 to 65.535.
+    void setResolution(double resolution);
+
+    /// Quantization step of coordinates (mm).
+    double resolution() const { return resolution_; }
+
+    /// Encodes the latest complete lidar coords.
+    /// @returns The frame, valid until the next call.
+    const std::vector<std::uint8_t>& encodeLidarCoords();
+
+    /// Encodes the published planner obstacles straight from the shared memory, without waiting for the planner:
+    /// encoding restarts if the planner overwrote them meanwhile.
+    /// @returns The frame, valid until the next call.
+    const std::vector<std::uint8_t>& encodeObstacles();
+
+private:
+    std::unique_ptr<shared_memory::SharedMemory> shared_memory_;  ///< Shared memory mapped by the encoder
+    shared_memory::lidar_coords_buffer_t& lidar_coords_;          ///< Lidar coords triple buffer
+    double resolution_;                                           ///< Quantization step (mm)
+    std::array<double[2], shared_memory::MAX_LIDAR_DATA_COUNT> points_;  ///< Copy of the latest lidar coords
+    std::vector<std::uint8_t> lidar_frame_;                       ///< Last lidar points frame
+    std::vector<std::uint8_t> obstacles_frame_;                   ///< Last obstacles frame
+};
+
+} // namespace utils
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,100 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_utils
+/// @{
+/// @file
+/// @brief       ObstacleTracker class declaration
+/// @author      Eric Courtois <eric.courtois@gmail.com>
+
+#pragma once
+
+#include "models/CircleList.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace cogip {
+
+namespace utils {
+
+/// State of a tracked obstacle.
+struct obstacle_track_t {
+    std::uint32_t id;     ///< Identifier, never 0.
+    double x;             ///< Estimated X coordinate (mm).
+    double y;             ///< Estimated Y coordinate (mm).
+    double vx;            ///< Estimated velocity along X (mm/s).
+    double vy;            ///< Estimated velocity along Y (mm/s).
+    double radius;        ///< Radius of the last associated detection (mm).
+    std::uint32_t hits;   ///< Number of associated detections.
+    std::uint32_t misses; ///< Number of consecutive updates without associated detection.
+};
+
+/// Gives stable identifiers and velocities to the obstacles detected on successive scans.
+///
+/// Tracks follow a constant-velocity model with an alpha-beta filter.
+/// On each update, tracks are predicted to the detection time, then associated to the detections
+/// by increasing distance, up to the gate distance (greedy nearest neighbor).
+/// Unassociated detections start new tracks, tracks unassociated for more than max_misses updates are dropped.
+class ObstacleTracker {
+public:
+    ObstacleTracker();
+
+    /// Update the tracks with the obstacles detected on a scan.
+    /// @param detections Detected obstacles, only their center and radius are used.
+    /// @param count Number of detected obstacles.
+    /// @param timestamp CLOCK_MONOTONIC time of the detections (ns).
+    void update(const models::circle_t* detections, std::size_t count, std::uint64_t timestamp);
+
+    /// Write the confirmed tracks, with at least min_hits associated detections, to a circle list.
+    /// Tracks missed by the last updates are written at their predicted position.
+    void write(models::CircleList& circles) const;
+
+    /// Drop all tracks, identifiers restart from 1.
+    void reset();
+
+    /// Tracks, in creation order.
+    const std::vector<obstacle_track_t>& tracks() const { return tracks_; }
+
+    /// Set the gain of the position correction, between 0 and 1.
+    void setAlpha(double alpha);
+
+    /// Set the gain of the velocity correction, between 0 and 1.
+    void setBeta(double beta);
+
+    /// Set the maximum distance between a predicted track and its associated detection (mm).
+    void setGateDistance(double gate_distance);
+
+    /// Set the number of consecutive updates a track is kept without associated detection.
+    void setMaxMisses(std::uint32_t max_misses) { max_misses_ = max_misses; }
+
+    /// Set the number of associated detections before a track is written.
+    void setMinHits(std::uint32_t min_hits) { min_hits_ = min_hits; }
+
+private:
+    /// Candidate association between a track and a detection.
+    struct candidate_t {
+        double distance2;       ///< Squared distance between the predicted track and the detection.
+        std::uint32_t track;    ///< Index of the track.
+        std::uint32_t detection;  ///< Index of the detection.
+    };
+
+    double alpha_;                                ///< Gain of the position correction
+    double beta_;                                 ///< Gain of the velocity correction
+    double gate_distance_;                        ///< Maximum association distance (mm)
+    std::uint32_t max_misses_;                    ///< Updates a track is kept without detection
+    std::uint32_t min_hits_;                      ///< Detections before a track is written
+    std::uint32_t next_id_;                       ///< Identifier of the next track
+    std::uint64_t last_timestamp_;                ///< Time of the last update (ns), 0 before the first one
+    std::vector<obstacle_track_t> tracks_;        ///< Tracks
+    std::vector<candidate_t> candidates_;         ///< Candidate associations of the current update
+    std::vector<bool> track_associated_;          ///< Whether the tracks are associated in the current update
+    std::vector<bool> detection_associated_;      ///< Whether the detections are associated in the current update
+};
+
+} // namespace utils
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,163 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @ingroup     lib_utils
+/// @{
+/// @file
+/// @brief       Lock-free single producer single consumer queue
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <stdexcept>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace cogip {
+
+namespace utils {
+
+/// @class SpscQueue
+/// Bounded lock-free queue between one producer thread and one consumer thread of the same process.
+///
+/// Items are copied in a ring of a power of two slots. The producer and the consumer each own an index,
+/// alone in its cache line, and keep a cached copy of the other index, so they only read the line of the other side
+/// when the ring looks full or empty.
+///
+/// The consumer may block in pop() when the queue is empty. It then sleeps on a private futex, only woken by tryPush()
+/// if the consumer announced it is waiting, so a producer never makes a system call while the consumer keeps up.
+template <typename T>
+class SpscQueue {
+public:
+    /// Constructor.
+    /// @param capacity Minimum number of items, rounded up to a power of two.
+    /// @throws std::invalid_argument if the capacity is 0.
+    explicit SpscQueue(std::size_t capacity)
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("SPSC queue capacity must be positive");
+        }
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    /// Copying is disallowed, each side holds indexes in the queue.
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /// Maximum number of items.
+    std::size_t capacity() const { return slots_.size(); }
+
+    /// Approximate number of items, exact if called by the producer or the consumer while the other side is idle.
+    std::size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    /// Appends an item, called by the producer only.
+    /// @return `false` if the queue is full, the item is then not appended.
+    bool tryPush(const T& item)
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+
+        // Paired with the fence of pop(): either the consumer sees the item, or the producer sees it waiting.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_relaxed)) {
+            wakeConsumer();
+        }
+        return true;
+    }
+
+    /// Removes the oldest item, called by the consumer only.
+    /// @return `false` if the queue is empty.
+    bool tryPop(T& item)
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        item = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Removes the oldest item, waiting for one if the queue is empty, called by the consumer only.
+    /// @param timeout_seconds Timeout in seconds. If negative, wait until an item is pushed or wakeConsumer() is called.
+    /// @return `false` if no item was pushed before the timeout or the wake up.
+    bool pop(T& item, double timeout_seconds = -1.0)
+    {
+        if (tryPop(item)) {
+            return true;
+        }
+        struct timespec timeout;
+        struct timespec* timeout_ptr = nullptr;
+        if (timeout_seconds >= 0) {
+            timeout.tv_sec = static_cast<time_t>(timeout_seconds);
+            timeout.tv_nsec = static_cast<long>((timeout_seconds - static_cast<double>(timeout.tv_sec)) * 1e9);
+            timeout_ptr = &timeout;
+        }
+
+        std::uint32_t wake_generation = wake_generation_.load(std::memory_order_acquire);
+        waiting_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool popped = tryPop(item);
+        if (!popped) {
+            // The futex only sleeps if no wake up happened since the generation was loaded.
+            syscall(SYS_futex, &wake_generation_, FUTEX_WAIT_PRIVATE, wake_generation, timeout_ptr, nullptr, 0);
+            popped = tryPop(item);
+        }
+        waiting_.store(false, std::memory_order_relaxed);
+        return popped;
+    }
+
+    /// Wakes up the consumer blocked in pop(), which returns `false` if the queue is still empty.
+    /// Used to stop the consumer thread.
+    void wakeConsumer()
+    {
+        wake_generation_.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, &wake_generation_, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+private:
+    std::vector<T> slots_;  ///< Ring of items.
+    std::size_t mask_;      ///< Number of slots minus one.
+
+    alignas(64) std::atomic<std::size_t> head_{0};  ///< Index of the next item to pop, written by the consumer.
+    std::size_t cached_tail_ = 0;                   ///< Last tail read by the consumer.
+
+    alignas(64) std::atomic<std::size_t> tail_{0};  ///< Index of the next item to push, written by the producer.
+    std::size_t cached_head_ = 0;                   ///< Last head read by the producer.
+
+    /// Wake up state, apart from the indexes so the producer checking it does not steal the line of head_.
+    alignas(64) std::atomic<std::uint32_t> wake_generation_{0};  ///< Futex word incremented by each wake up.
+    std::atomic<bool> waiting_{false};                           ///< Whether the consumer may be blocked in pop().
+};
+
+} // namespace utils
+
+} // namespace cogip
+
+/// @}
@@ -0,0 +1,57 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+#pragma once
+
+#include <pthread.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace cogip {
+
+namespace utils {
+
+/// Maximum length of a thread name, without the terminating null character.
+constexpr std::size_t THREAD_NAME_MAX_LENGTH = 15;
+
+/// Highest SCHED_FIFO priority of a thread.
+constexpr int THREAD_PRIORITY_MAX = 99;
+
+/// Scheduling of a thread.
+/// The default configuration is the scheduling a new thread inherits: time-sharing policy,
+/// on the CPUs of the thread which creates it.
+struct thread_config_t {
+    std::string name;       ///< Name shown by ps and top, at most THREAD_NAME_MAX_LENGTH characters, empty to keep the name.
+    int priority = 0;       ///< SCHED_FIFO priority from 1 to THREAD_PRIORITY_MAX, 0 for the time-sharing policy.
+    std::vector<int> cpus;  ///< CPUs the thread may run on, empty for the CPUs of the calling thread.
+};
+
+/// Check a thread configuration without applying it.
+/// @throws std::invalid_argument if the name is too long, the priority out of range or a CPU does not exist.
+void checkThreadConfig(const thread_config_t& config);
+
+/// Apply a configuration to a running thread.
+/// Real-time priorities need the CAP_SYS_NICE capability or a high enough RLIMIT_RTPRIO.
+/// @throws std::invalid_argument if the configuration is invalid.
+/// @throws std::runtime_error if the system refuses the configuration.
+void applyThreadConfig(pthread_t thread, const thread_config_t& config);
+
+/// Apply a configuration to a thread just started by its owner, reporting failures on the error output.
+/// A thread which cannot get its configuration still runs, with the default scheduling.
+/// @return true if the configuration was applied.
+bool tryApplyThreadConfig(pthread_t thread, const thread_config_t& config);
+
+/// Lock the current and future memory pages of the process in RAM,
+/// so the real-time threads never wait for a page fault.
+/// @throws std::runtime_error if the system refuses it, e.g. above RLIMIT_MEMLOCK without CAP_IPC_LOCK.
+void lockProcessMemory();
+
+/// Unlock the memory pages of the process locked by lockProcessMemory().
+void unlockProcessMemory();
+
+} // namespace utils
+
+} // namespace cogip
@@ -0,0 +1,126 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level directory.
+
+/// @file
+/// @brief       Exact geometric predicates used by obstacle and avoidance tests.
+///
+/// Orientation signs are computed with a floating-point filter: the fast determinant is used
+/// when its rounding error bound proves its sign, otherwise the determinant is evaluated exactly
+/// as an expansion of error-free products and sums (Shewchuk's adaptive predicates).
+/// Collinear and vertex-touching configurations are therefore decided exactly, without tolerance.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace cogip {
+
+namespace utils {
+
+/// Relative error bound of the fast 2D orientation determinant, (3 + 16 eps) eps with eps = 2^-53.
+constexpr double ORIENT2D_ERROR_BOUND = (3.0 + 16.0 * 0x1p-53) * 0x1p-53;
+
+/// Exact sum of two doubles: a + b = hi + lo.
+inline void two_sum(double a, double b, double& hi, double& lo)
+{
+    hi = a + b;
+    double b_virtual = hi - a;
+    double a_virtual = hi - b_virtual;
+    lo = (a - a_virtual) + (b - b_virtual);
+}
+
+/// Exact product of two doubles: a * b = hi + lo.
+inline void two_product(double a, double b, double& hi, double& lo)
+{
+    hi = a * b;
+    lo = std::fma(a, b, -hi);
+}
+
+/// Exact sign of the 2D orientation determinant, without filter.
+/// The six products of the determinant are split into error-free terms, summed into
+/// a nonoverlapping expansion whose largest nonzero component gives the sign.
+/// @return A value with the sign of the determinant, see orient2d().
+inline double orient2d_exact(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    const double factors[6][2] = {
+        {ax, by}, {-ax, cy}, {-ay, bx}, {ay, cx}, {bx, cy}, {-by, cx}
+    };
+    double expansion[12];
+    std::size_t length = 0;
+    for (const auto& factor : factors) {
+        double terms[2];
+        two_product(factor[0], factor[1], terms[0], terms[1]);
+        for (double term : terms) {
+            // Grow the expansion by one term, components stay in increasing magnitude order.
+            double q = term;
+            for (std::size_t i = 0; i < length; i++) {
+                two_sum(q, expansion[i], q, expansion[i]);
+            }
+            expansion[length++] = q;
+        }
+    }
+    for (std::size_t i = length; i > 0; i--) {
+        if (expansion[i - 1] != 0) {
+            return expansion[i - 1];
+        }
+    }
+    return 0;
+}
+
+/// Orientation of point C relative to line (AB).
+/// The sign is exact, the magnitude is only an approximation of twice the area of triangle ABC.
+/// @return Positive if C is on the left of (AB), negative if on the right, zero if A, B and C are collinear.
+inline double orient2d(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    double left = (ax - cx) * (by - cy);
+    double right = (ay - cy) * (bx - cx);
+    double det = left - right;
+    if (std::abs(det) >= ORIENT2D_ERROR_BOUND * (std::abs(left) + std::abs(right))) {
+        return det;
+    }
+    return orient2d_exact(ax, ay, bx, by, cx, cy);
+}
+
+/// Orientation of point C relative to line (AB), for integer coordinates such as table millimetres.
+/// Computed exactly with 64-bit integers, for coordinates within +/-2^30.
+/// @return Positive if C is on the left of (AB), negative if on the right, zero if A, B and C are collinear.
+inline int64_t orient2d(int32_t ax, int32_t ay, int32_t bx, int32_t by, int32_t cx, int32_t cy)
+{
+    return (static_cast<int64_t>(ax) - cx) * (static_cast<int64_t>(by) - cy)
+         - (static_cast<int64_t>(ay) - cy) * (static_cast<int64_t>(bx) - cx);
+}
+
+/// Check if point P lies on segment [AB], endpoints excluded.
+/// A degenerate segment contains no point.
+inline bool is_point_on_segment(double px, double py, double ax, double ay, double bx, double by)
+{
+    if (orient2d(ax, ay, bx, by, px, py) != 0) {
+        return false;
+    }
+    if (ax != bx) {
+        return (ax < bx) ? (px > ax && px < bx) : (px > bx && px < ax);
+    }
+    return (ay < by) ? (py > ay && py < by) : (py > by && py < ay);
+}
+
+/// Check if segments [AB] and [CD] cross at a single point interior to both.
+/// Segments only touching at an endpoint or overlapping along a line do not cross.
+inline bool are_segments_crossing(double ax, double ay, double bx, double by,
+                                  double cx, double cy, double dx, double dy)
+{
+    double c_side = orient2d(ax, ay, bx, by, cx, cy);
+    double d_side = orient2d(ax, ay, bx, by, dx, dy);
+    if (!((c_side > 0 && d_side < 0) || (c_side < 0 && d_side > 0))) {
+        return false;
+    }
+    double a_side = orient2d(cx, cy, dx, dy, ax, ay);
+    double b_side = orient2d(cx, cy, dx, dy, bx, by);
+    return (a_side > 0 && b_side < 0) || (a_side < 0 && b_side > 0);
+}
+
+} // namespace utils
+
+} // namespace cogip
@@ -0,0 +1,63 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @defgroup    tests Tests
+/// @brief       Unit tests of the C++ libraries
+///
+/// Each test executable runs its test cases and returns a non-zero status if a check failed,
+/// so they can be run by CTest. Tests do not need Python nor another process owning the shared memory.
+///
+/// @{
+/// @file
+/// @brief       Minimal unit test checks.
+/// @author      Gilles DOFFE <g.doffe@gmail.com>
+
+#pragma once
+
+// Standard includes
+#include <cstdlib>
+#include <iostream>
+
+namespace cogip {
+
+namespace tests {
+
+/// Number of failed checks of the test executable.
+inline int failures = 0;
+
+/// @brief Records a check, printing it if it failed.
+/// @param condition Result of the check.
+/// @param expression Checked expression.
+/// @param file Source file of the check.
+/// @param line Source line of the check.
+inline void check(bool condition, const char* expression, const char* file, int line)
+{
+    if (!condition) {
+        failures++;
+        std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+    }
+}
+
+/// @brief Prints the test result.
+/// @param name Test name.
+/// @return Exit status of the test executable.
+inline int report(const char* name)
+{
+    if (failures) {
+        std::cerr << name << ": " << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << name << ": passed" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+} // namespace tests
+
+} // namespace cogip
+
+/// Checks a condition, the test goes on if it fails.
+#define COGIP_CHECK(condition) ::cogip::tests::check((condition), #condition, __FILE__, __LINE__)
+
+/// @}
@@ -0,0 +1,208 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @file
+/// @brief       Tests of LidarCoordsClusterer against a brute-force DBSCAN.
+///
+/// The reference is a transcription of scikit-learn DBSCAN with brute-force neighborhoods:
+/// neighborhoods include the point itself, a point is core if its neighborhood has at least min_samples points,
+/// clusters are numbered in the order of their first core point and a border point gets the label
+/// of the first cluster reaching it.
+
+// Standard includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Project includes
+#include "shared_memory/SharedMemory.hpp"
+#include "tests/Test.hpp"
+#include "utils/LidarCoordsClusterer.hpp"
+
+using namespace cogip;
+
+namespace {
+
+/// Points of a scene, in the layout of the lidar coords.
+using Points = std::vector<std::array<double, 2>>;
+
+/// Brute-force DBSCAN, as sklearn.cluster.DBSCAN(eps, min_samples).fit(points).labels_.
+std::vector<std::int32_t> reference_dbscan(const Points& points, double eps, std::size_t min_samples)
+{
+    std::size_t count = points.size();
+    std::vector<std::vector<std::size_t>> neighborhoods(count);
+    for (std::size_t i = 0; i < count; i++) {
+        for (std::size_t j = 0; j < count; j++) {
+            double diff_x = points[j][0] - points[i][0];
+            double diff_y = points[j][1] - points[i][1];
+            if (diff_x * diff_x + diff_y * diff_y <= eps * eps) {
+                neighborhoods[i].push_back(j);
+            }
+        }
+    }
+
+    std::vector<bool> core(count);
+    for (std::size_t i = 0; i < count; i++) {
+        core[i] = neighborhoods[i].size() >= min_samples;
+    }
+
+    // sklearn.cluster._dbscan_inner.dbscan_inner
+    std::vector<std::int32_t> labels(count, utils::CLUSTER_NOISE);
+    std::int32_t label = 0;
+    std::vector<std::size_t> stack;
+    for (std::size_t seed = 0; seed < count; seed++) {
+        if (labels[seed] != utils::CLUSTER_NOISE || !core[seed]) {
+            continue;
+        }
+        std::size_t i = seed;
+        while (true) {
+            if (labels[i] == utils::CLUSTER_NOISE) {
+                labels[i] = label;
+                if (core[i]) {
+                    for (std::size_t j : neighborhoods[i]) {
+                        if (labels[j] == utils::CLUSTER_NOISE) {
+                            stack.push_back(j);
+                        }
+                    }
+                }
+            }
+            if (stack.empty()) {
+                break;
+            }
+            i = stack.back();
+            stack.pop_back();
+        }
+        label++;
+    }
+    return labels;
+}
+
+/// Clusters the points and checks the labels against the reference.
+void check_scene(utils::LidarCoordsClusterer& clusterer, const Points& points, double eps, std::size_t min_samples)
+{
+    clusterer.setClusterEps(eps);
+    clusterer.setClusterMinSamples(min_samples);
+    std::size_t cluster_count = clusterer.cluster(reinterpret_cast<const double (*)[2]>(points.data()), points.size());
+
+    std::vector<std::int32_t> expected = reference_dbscan(points, eps, min_samples);
+    std::int32_t expected_count = 0;
+    for (std::int32_t label : expected) {
+        expected_count = std::max(expected_count, label + 1);
+    }
+    COGIP_CHECK(cluster_count == static_cast<std::size_t>(expected_count));
+    COGIP_CHECK(clusterer.pointCount() == points.size());
+    std::size_t mismatches = 0;
+    for (std::size_t index = 0; index < points.size(); index++) {
+        mismatches += clusterer.labels()[index] != expected[index];
+    }
+    COGIP_CHECK(mismatches == 0);
+}
+
+/// A point is a neighbor of itself, and of the points exactly at eps.
+void test_min_samples(utils::LidarCoordsClusterer& clusterer)
+{
+    // Isolated points are clusters of their own with min_samples = 1, noise above.
+    Points isolated = {{0.0, 0.0}, {100.0, 0.0}, {0.0, 100.0}};
+    check_scene(clusterer, isolated, 10.0, 1);
+    COGIP_CHECK(clusterer.labels()[0] == 0 && clusterer.labels()[1] == 1 && clusterer.labels()[2] == 2);
+    check_scene(clusterer, isolated, 10.0, 2);
+    COGIP_CHECK(clusterer.labels()[0] == utils::CLUSTER_NOISE);
+
+    // Two points 5 mm apart, exactly at eps: both have 2 neighbors, themselves included.
+    Points pair = {{-3.0, -4.0}, {0.0, 0.0}, {500.0, 500.0}};
+    check_scene(clusterer, pair, 5.0, 2);
+    COGIP_CHECK(clusterer.labels()[0] == 0 && clusterer.labels()[1] == 0);
+    COGIP_CHECK(clusterer.labels()[2] == utils::CLUSTER_NOISE);
+    check_scene(clusterer, pair, 5.0, 3);
+    COGIP_CHECK(clusterer.labels()[0] == utils::CLUSTER_NOISE && clusterer.labels()[1] == utils::CLUSTER_NOISE);
+    check_scene(clusterer, pair, 4.999, 2);
+    COGIP_CHECK(clusterer.labels()[0] == utils::CLUSTER_NOISE);
+}
+
+/// A border point reached by two clusters belongs to the one whose first core point comes first.
+void test_border_points(utils::LidarCoordsClusterer& clusterer)
+{
+    // With eps = 1 and min_samples = 4, a0 and b0 are core points 2 mm apart, p is a border point between them.
+    const std::array<double, 2> a0 = {0.0, 0.0}, a1 = {0.0, 1.0}, a2 = {0.0, -1.0};
+    const std::array<double, 2> b0 = {2.0, 0.0}, b1 = {2.0, 1.0}, b2 = {2.0, -1.0};
+    const std::array<double, 2> p = {1.0, 0.0};
+
+    Points a_first = {p, a1, a0, a2, b2, b0, b1};
+    check_scene(clusterer, a_first, 1.0, 4);
+    COGIP_CHECK(clusterer.labels()[0] == 0);
+    COGIP_CHECK(clusterer.labels()[5] == 1);
+
+    Points b_first = {p, b1, b0, b2, a2, a0, a1};
+    check_scene(clusterer, b_first, 1.0, 4);
+    COGIP_CHECK(clusterer.labels()[0] == 0);
+    COGIP_CHECK(clusterer.labels()[2] == 0 && clusterer.labels()[5] == 1);
+
+    // A border point coming before all core points is labeled but does not start a cluster.
+    Points border_last_core = {a1, p, b0, b1, b2, a0, a2};
+    check_scene(clusterer, border_last_core, 1.0, 4);
+    COGIP_CHECK(clusterer.labels()[0] == 1 && clusterer.labels()[1] == 0);
+}
+
+/// Random scenes of obstacles and noise, spread over several grid cells and around the origin.
+void test_random_scenes(utils::LidarCoordsClusterer& clusterer)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> table(-1500.0, 1500.0);
+    std::normal_distribution<double> spread(0.0, 30.0);
+    std::uniform_int_distribution<int> obstacle_count(0, 8);
+    const double eps_values[] = {5.0, 20.0, 50.0, 120.0};
+    const std::size_t min_samples_values[] = {1, 2, 3, 5, 10};
+
+    for (int scene = 0; scene < 200; scene++) {
+        Points points;
+        int obstacles = obstacle_count(generator);
+        for (int obstacle = 0; obstacle < obstacles; obstacle++) {
+            double x = table(generator), y = table(generator);
+            for (int n = 0; n < 60; n++) {
+                points.push_back({x + spread(generator), y + spread(generator)});
+            }
+        }
+        while (points.size() < 600) {
+            points.push_back({table(generator), table(generator)});
+        }
+        // Integer coordinates give points exactly at eps from each other.
+        if (scene % 4 == 0) {
+            for (auto& point : points) {
+                point = {std::round(point[0] / 10.0), std::round(point[1] / 10.0)};
+            }
+        }
+        std::shuffle(points.begin(), points.end(), generator);
+        for (double eps : eps_values) {
+            for (std::size_t min_samples : min_samples_values) {
+                check_scene(clusterer, points, scene % 4 == 0 ? eps / 10.0 : eps, min_samples);
+            }
+        }
+    }
+
+    // Full scan of points on a line, all in one cluster.
+    Points line;
+    for (std::size_t n = 0; n < shared_memory::MAX_LIDAR_DATA_COUNT; n++) {
+        line.push_back({-1000.0 + 2.0 * n, 3.0});
+    }
+    check_scene(clusterer, line, 2.0, 3);
+    COGIP_CHECK(clusterer.labels()[0] == 0 && clusterer.labels()[line.size() - 1] == 0);
+}
+
+} // namespace
+
+int main()
+{
+    shared_memory::SharedMemory shared_memory("test_lidar_coords_clusterer", shared_memory::in_process);
+    utils::LidarCoordsClusterer clusterer(shared_memory);
+
+    test_min_samples(clusterer);
+    test_border_points(clusterer);
+    test_random_scenes(clusterer);
+    return tests::report("lidar_coords_clusterer");
+}
@@ -0,0 +1,213 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @file
+/// @brief       Tests of the lock-free reads of PoseBuffer.
+///
+/// Pose number k is pushed as (k, -k, k % 360) with timestamp k + 1, so a reader can check that
+/// each pose it copied is consistent and that a copy of several poses is a contiguous sequence.
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Project includes
+#include "models/PoseBuffer.hpp"
+#include "shared_memory/SharedMemory.hpp"
+#include "tests/Test.hpp"
+
+using namespace cogip;
+
+namespace {
+
+constexpr std::uint64_t size_max = models::POSE_BUFFER_SIZE_MAX;
+
+/// Pushes pose number k.
+void push_pose(models::PoseBuffer& buffer, std::uint64_t k)
+{
+    buffer.push(static_cast<float>(k), -static_cast<float>(k), static_cast<float>(k % 360), k + 1);
+}
+
+/// Checks that a pose and its timestamp are the ones of pose number k.
+bool is_pose(const models::pose_t& pose, std::uint64_t timestamp, std::uint64_t k)
+{
+    return pose.x == static_cast<float>(k) && pose.y == -static_cast<float>(k)
+        && pose.angle == static_cast<float>(k % 360) && timestamp == k + 1;
+}
+
+/// Copies the last `count` readable poses, pushing `pushes` poses while the first copy is in progress,
+/// as a producer running concurrently would.
+/// @return Number of times the read function ran.
+std::size_t read_while_pushing(models::PoseBuffer& buffer, std::size_t count, std::size_t pushes, bool& consistent)
+{
+    std::size_t runs = 0;
+    consistent = false;
+    buffer.read([&](std::uint64_t write_index) {
+        runs++;
+        std::size_t readable = std::min(count, models::PoseBuffer::readableCount(write_index));
+        std::uint64_t oldest = write_index - readable;
+        consistent = true;
+        for (std::uint64_t k = oldest; k < write_index; k++) {
+            consistent &= is_pose(buffer.data()->poses[k % size_max], buffer.data()->timestamps[k % size_max], k);
+        }
+        if (runs == 1) {
+            std::uint64_t next = buffer.writeIndex();
+            for (std::size_t n = 0; n < pushes; n++) {
+                push_pose(buffer, next + n);
+            }
+        }
+        return oldest;
+    });
+    return runs;
+}
+
+/// The read runs again exactly when the producer may have started overwriting the oldest copied pose.
+void test_wrap_around()
+{
+    models::PoseBuffer buffer(nullptr);
+    COGIP_CHECK(buffer.size() == 0);
+    COGIP_CHECK(buffer.read_pose(0).x == 0 && buffer.timestamp(0) == 0);
+
+    std::uint64_t k = 0;
+    for (; k < 3 * size_max + 17; k++) {
+        push_pose(buffer, k);
+    }
+    COGIP_CHECK(buffer.size() == size_max - 1);
+    COGIP_CHECK(buffer.full());
+
+    // Pose number write_index is written while the write index is write_index, in the slot of the pose
+    // size_max poses older. A copy of the last `count` poses is intact until the write index reaches
+    // oldest + size_max - 1, the producer then writes the slot of the oldest copied pose.
+    const std::size_t counts[] = {1, 2, 100, size_max - 2, size_max - 1, size_max + 10};
+    for (std::size_t count : counts) {
+        std::size_t readable = std::min<std::size_t>(count, size_max - 1);
+        bool consistent = false;
+        COGIP_CHECK(read_while_pushing(buffer, count, 0, consistent) == 1);
+        COGIP_CHECK(consistent);
+        COGIP_CHECK(read_while_pushing(buffer, count, size_max - readable - 1, consistent) == 1);
+        COGIP_CHECK(consistent);
+        COGIP_CHECK(read_while_pushing(buffer, count, size_max - readable, consistent) == 2);
+        COGIP_CHECK(consistent);
+        COGIP_CHECK(read_while_pushing(buffer, count, 3 * size_max, consistent) == 2);
+        COGIP_CHECK(consistent);
+    }
+
+    // Accessors clamp to the oldest readable pose.
+    std::uint64_t write_index = buffer.writeIndex();
+    models::pose_t latest = buffer.read_pose(0);
+    COGIP_CHECK(is_pose(latest, buffer.timestamp(0), write_index - 1));
+    COGIP_CHECK(is_pose(buffer.read_pose(size_max - 2), buffer.timestamp(size_max - 2), write_index - size_max + 1));
+    COGIP_CHECK(is_pose(buffer.read_pose(10 * size_max), buffer.timestamp(10 * size_max), write_index - size_max + 1));
+}
+
+/// One producer pushing as fast as it can, readers copying single poses and whole windows concurrently.
+void test_concurrent_readers()
+{
+    shared_memory::SharedMemory shared_memory("test_pose_buffer", shared_memory::in_process);
+    models::PoseBuffer& buffer = *shared_memory.getPoseCurrentBuffer();
+    const std::uint64_t start = buffer.writeIndex();
+    // Poses stay exact in float below 2^24.
+    const std::uint64_t pushes = 4000000;
+
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> inconsistent{0};
+    std::atomic<std::uint64_t> reads{0};
+
+    std::thread producer([&]() {
+        for (std::uint64_t k = start; k < start + pushes; k++) {
+            shared_memory.pushPoseCurrent(
+                static_cast<float>(k), -static_cast<float>(k), static_cast<float>(k % 360), k + 1
+            );
+            // Alternate bursts and pauses, so readers also run while the producer is idle.
+            if (k % 100000 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+    });
+
+    // Single poses, the latest never goes back.
+    auto single_reader = [&]() {
+        std::uint64_t previous = 0;
+        std::uint64_t n = 0;
+        while (!done) {
+            std::size_t depth = n++ % size_max;
+            std::uint64_t k = 0;
+            bool consistent = false;
+            buffer.read([&](std::uint64_t write_index) {
+                std::size_t count = models::PoseBuffer::readableCount(write_index);
+                if (count == 0) {
+                    consistent = true;
+                    return write_index;
+                }
+                k = write_index - 1 - std::min<std::uint64_t>(depth, count - 1);
+                consistent = is_pose(buffer.data()->poses[k % size_max], buffer.data()->timestamps[k % size_max], k);
+                return k;
+            });
+            if (!consistent) {
+                inconsistent++;
+            }
+            models::pose_t latest = buffer.read_pose(0);
+            if (latest.y != -latest.x || latest.x < previous) {
+                inconsistent++;
+            }
+            previous = static_cast<std::uint64_t>(latest.x);
+            reads++;
+        }
+    };
+
+    // Whole windows through SharedMemory, contiguous and consistent.
+    auto window_reader = [&]() {
+        std::vector<models::pose_t> poses;
+        std::vector<std::uint64_t> timestamps;
+        poses.reserve(size_max);
+        timestamps.reserve(size_max);
+        std::uint64_t n = 0;
+        while (!done) {
+            // Alternately the whole buffer and the poses after a recent timestamp.
+            std::uint64_t since = (n++ % 2) ? 0 : buffer.timestamp(size_max / 2);
+            shared_memory.readPoseCurrentSince(since, poses, timestamps);
+            if (poses.size() != timestamps.size() || poses.size() > size_max - 1) {
+                inconsistent++;
+                continue;
+            }
+            for (std::size_t i = 0; i < poses.size(); i++) {
+                std::uint64_t k = timestamps[0] - 1 + i;
+                if (!is_pose(poses[i], timestamps[i], k) || timestamps[i] <= since) {
+                    inconsistent++;
+                    break;
+                }
+            }
+            reads++;
+        }
+    };
+
+    std::vector<std::thread> readers;
+    readers.emplace_back(single_reader);
+    readers.emplace_back(single_reader);
+    readers.emplace_back(window_reader);
+    readers.emplace_back(window_reader);
+    producer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    COGIP_CHECK(inconsistent == 0);
+    COGIP_CHECK(reads > 0);
+    COGIP_CHECK(buffer.writeIndex() == start + pushes);
+    COGIP_CHECK(is_pose(buffer.read_pose(0), buffer.timestamp(0), start + pushes - 1));
+}
+
+} // namespace
+
+int main()
+{
+    test_wrap_around();
+    test_concurrent_readers();
+    return tests::report("pose_buffer");
+}
@@ -0,0 +1,209 @@
+// Copyright (C) 2025 COGIP Robotics association <cogip35@gmail.com>
+// This file is subject to the terms and conditions of the GNU Lesser
+// General Public License v2.1. See the file LICENSE in the top level
+// directory for more details.
+
+/// @file
+/// @brief       Tests of the exact geometric predicates.
+///
+/// Orientation signs are compared with determinants computed exactly on 128-bit integers,
+/// coordinates being scaled by a power of two so they are converted without rounding.
+
+// Standard includes
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+// Project includes
+#include "tests/Test.hpp"
+#include "utils/predicates.hpp"
+
+using namespace cogip;
+
+namespace {
+
+using int128_t = __int128;
+
+/// Converts a coordinate to an integer scaled by 2^scale.
+/// Scaled coordinates stay below 2^61, so the reference determinant fits in 128 bits.
+/// @return `false` if the coordinate is not a multiple of 2^-scale or is out of range.
+bool to_reference(double value, int scale, int128_t& scaled)
+{
+    double shifted = std::ldexp(value, scale);
+    if (std::abs(shifted) >= 0x1p61 || std::trunc(shifted) != shifted) {
+        return false;
+    }
+    scaled = static_cast<int128_t>(static_cast<int64_t>(shifted));
+    return true;
+}
+
+/// Exact sign of the orientation determinant.
+/// @return `false` if a coordinate cannot be converted exactly, see to_reference().
+bool reference_sign(double ax, double ay, double bx, double by, double cx, double cy, int scale, int& sign)
+{
+    int128_t a[2], b[2], c[2];
+    if (!to_reference(ax, scale, a[0]) || !to_reference(ay, scale, a[1])
+        || !to_reference(bx, scale, b[0]) || !to_reference(by, scale, b[1])
+        || !to_reference(cx, scale, c[0]) || !to_reference(cy, scale, c[1])) {
+        return false;
+    }
+    int128_t det = (a[0] - c[0]) * (b[1] - c[1]) - (a[1] - c[1]) * (b[0] - c[0]);
+    sign = (det > 0) - (det < 0);
+    return true;
+}
+
+int sign_of(double value)
+{
+    return (value > 0) - (value < 0);
+}
+
+int sign_of(int64_t value)
+{
+    return (value > 0) - (value < 0);
+}
+
+/// Points exactly on a line, with or without exact decimal coordinates.
+void test_collinear()
+{
+    COGIP_CHECK(utils::orient2d(0.0, 0.0, 1.0, 1.0, 2.0, 2.0) == 0);
+    COGIP_CHECK(utils::orient2d(0.1, 0.1, 0.3, 0.3, 0.7, 0.7) == 0);
+    COGIP_CHECK(utils::orient2d(-1000.0, 250.0, 1000.0, 250.0, 12.5, 250.0) == 0);
+    COGIP_CHECK(utils::orient2d(42.0, -1500.0, 42.0, 1500.0, 42.0, 3000.0) == 0);
+
+    // Repeated points are collinear with any point.
+    COGIP_CHECK(utils::orient2d(3.5, 7.25, 3.5, 7.25, -8.0, 1.0) == 0);
+    COGIP_CHECK(utils::orient2d(3.5, 7.25, -8.0, 1.0, 3.5, 7.25) == 0);
+
+    // Left is positive, right is negative.
+    COGIP_CHECK(utils::orient2d(0.0, 0.0, 1.0, 0.0, 0.5, 1.0) > 0);
+    COGIP_CHECK(utils::orient2d(0.0, 0.0, 1.0, 0.0, 0.5, -1.0) < 0);
+}
+
+/// Points near line (AB), classic cases where the fast determinant rounds to the wrong sign.
+void test_near_zero_determinants()
+{
+    // Grid of points one ulp apart around (0.5, 0.5), relative to the diagonal through (12, 12) and (24, 24).
+    const double ulp = 0x1p-53;
+    int zeros = 0;
+    for (int i = 0; i < 64; i++) {
+        for (int j = 0; j < 64; j++) {
+            double cx = 0.5 + i * ulp;
+            double cy = 0.5 + j * ulp;
+            int expected = 0;
+            COGIP_CHECK(reference_sign(12.0, 12.0, 24.0, 24.0, cx, cy, 53, expected));
+            COGIP_CHECK(sign_of(utils::orient2d(12.0, 12.0, 24.0, 24.0, cx, cy)) == expected);
+            COGIP_CHECK(sign_of(utils::orient2d(cx, cy, 12.0, 12.0, 24.0, 24.0)) == expected);
+            COGIP_CHECK(sign_of(utils::orient2d_exact(12.0, 12.0, 24.0, 24.0, cx, cy)) == expected);
+            zeros += (expected == 0);
+        }
+    }
+    COGIP_CHECK(zeros == 64);
+
+    // Points interpolated on random table segments, then moved by a few ulps.
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordinate(-1500.0, 1500.0);
+    std::uniform_real_distribution<double> ratio(-0.5, 1.5);
+    int checked = 0;
+    for (int n = 0; n < 2000; n++) {
+        double ax = coordinate(generator), ay = coordinate(generator);
+        double bx = coordinate(generator), by = coordinate(generator);
+        double t = ratio(generator);
+        double base_x = ax + t * (bx - ax);
+        double base_y = ay + t * (by - ay);
+        for (int dx = -2; dx <= 2; dx++) {
+            for (int dy = -2; dy <= 2; dy++) {
+                double cx = base_x, cy = base_y;
+                for (int k = 0; k < std::abs(dx); k++) {
+                    cx = std::nextafter(cx, dx > 0 ? INFINITY : -INFINITY);
+                }
+                for (int k = 0; k < std::abs(dy); k++) {
+                    cy = std::nextafter(cy, dy > 0 ? INFINITY : -INFINITY);
+                }
+                int expected = 0;
+                if (!reference_sign(ax, ay, bx, by, cx, cy, 50, expected)) {
+                    continue;
+                }
+                COGIP_CHECK(sign_of(utils::orient2d(ax, ay, bx, by, cx, cy)) == expected);
+                checked++;
+            }
+        }
+    }
+    // Most coordinates are above 4 mm, so exact multiples of 2^-50.
+    COGIP_CHECK(checked > 2000 * 25 * 9 / 10);
+}
+
+/// Segments sharing or touching an endpoint, which must neither cross nor contain it.
+void test_touching_endpoints()
+{
+    // Point on segment, endpoints excluded.
+    COGIP_CHECK(utils::is_point_on_segment(0.5, 0.5, 0.0, 0.0, 1.0, 1.0));
+    COGIP_CHECK(utils::is_point_on_segment(0.1, 0.1, 0.3, 0.3, 0.0, 0.0));
+    COGIP_CHECK(!utils::is_point_on_segment(0.0, 0.0, 0.0, 0.0, 1.0, 1.0));
+    COGIP_CHECK(!utils::is_point_on_segment(1.0, 1.0, 0.0, 0.0, 1.0, 1.0));
+    COGIP_CHECK(!utils::is_point_on_segment(2.0, 2.0, 0.0, 0.0, 1.0, 1.0));
+    COGIP_CHECK(!utils::is_point_on_segment(0.5, 0.5 + 0x1p-53, 0.0, 0.0, 1.0, 1.0));
+    COGIP_CHECK(utils::is_point_on_segment(5.0, 2.0, 5.0, 4.0, 5.0, -4.0));
+    COGIP_CHECK(!utils::is_point_on_segment(5.0, 4.0, 5.0, 4.0, 5.0, -4.0));
+    COGIP_CHECK(!utils::is_point_on_segment(1.0, 1.0, 1.0, 1.0, 1.0, 1.0));
+
+    // Proper crossing.
+    COGIP_CHECK(utils::are_segments_crossing(0.0, 0.0, 2.0, 2.0, 0.0, 2.0, 2.0, 0.0));
+    COGIP_CHECK(utils::are_segments_crossing(0.0, 2.0, 2.0, 0.0, 0.0, 0.0, 2.0, 2.0));
+    // Shared endpoint.
+    COGIP_CHECK(!utils::are_segments_crossing(0.0, 0.0, 2.0, 2.0, 2.0, 2.0, 4.0, 0.0));
+    COGIP_CHECK(!utils::are_segments_crossing(0.0, 0.0, 2.0, 2.0, 0.0, 0.0, -2.0, 3.0));
+    // Endpoint touching the interior of the other segment.
+    COGIP_CHECK(!utils::are_segments_crossing(0.0, 0.0, 2.0, 2.0, 1.0, 1.0, 3.0, 0.0));
+    COGIP_CHECK(!utils::are_segments_crossing(1.0, 1.0, 3.0, 0.0, 0.0, 0.0, 2.0, 2.0));
+    COGIP_CHECK(!utils::are_segments_crossing(0.0, 0.0, 0.3, 0.3, 0.1, 0.1, 1.0, -5.0));
+    // Collinear overlap.
+    COGIP_CHECK(!utils::are_segments_crossing(0.0, 0.0, 2.0, 2.0, 1.0, 1.0, 3.0, 3.0));
+    // One ulp past the touching endpoint does cross.
+    COGIP_CHECK(utils::are_segments_crossing(0.0, 0.0, 2.0, 2.0, std::nextafter(1.0, 0.0), 1.0, 3.0, 0.0));
+    COGIP_CHECK(!utils::are_segments_crossing(0.0, 0.0, 2.0, 2.0, std::nextafter(1.0, 2.0), 1.0, 3.0, 0.0));
+}
+
+/// Integer overload, exact up to the documented +/-2^30 range.
+void test_int64_overload()
+{
+    COGIP_CHECK(utils::orient2d(int32_t(0), 0, 10, 0, 5, 0) == 0);
+    COGIP_CHECK(utils::orient2d(int32_t(0), 0, 10, 0, 5, 1) == 10);
+    COGIP_CHECK(utils::orient2d(int32_t(0), 0, 10, 0, 5, -1) == -10);
+
+    const int32_t max = 1 << 30;
+    COGIP_CHECK(utils::orient2d(-max, -max, max, -max, -max, max) == int64_t(1) << 62);
+    COGIP_CHECK(utils::orient2d(-max, -max, max, max, max - 1, max) == int64_t(1) << 31);
+    COGIP_CHECK(utils::orient2d(-max, -max, max, max, max, max - 1) == -(int64_t(1) << 31));
+    COGIP_CHECK(utils::orient2d(-max, -max, max, max, 0, 0) == 0);
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int32_t> coordinate(-max, max);
+    std::uniform_int_distribution<int32_t> offset(-1, 1);
+    for (int n = 0; n < 10000; n++) {
+        int32_t ax = coordinate(generator), ay = coordinate(generator);
+        int32_t bx = coordinate(generator), by = coordinate(generator);
+        int32_t cx = coordinate(generator), cy = coordinate(generator);
+        if (n % 2) {
+            // Near collinear: C next to the midpoint of [AB].
+            cx = static_cast<int32_t>((int64_t(ax) + bx) / 2 + offset(generator));
+            cy = static_cast<int32_t>((int64_t(ay) + by) / 2 + offset(generator));
+        }
+        int128_t expected = (int128_t(ax) - cx) * (int128_t(by) - cy) - (int128_t(ay) - cy) * (int128_t(bx) - cx);
+        int64_t result = utils::orient2d(ax, ay, bx, by, cx, cy);
+        COGIP_CHECK(int128_t(result) == expected);
+        // Integer coordinates are exact doubles, both overloads agree on the sign.
+        COGIP_CHECK(sign_of(utils::orient2d(double(ax), double(ay), double(bx), double(by), double(cx), double(cy)))
+                    == sign_of(result));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    test_collinear();
+    test_near_zero_determinants();
+    test_touching_endpoints();
+    test_int64_overload();
+    return tests::report("predicates");
+}
@@ -4,9 +4,10 @@ from typing import final
 
 import cv2
 import cv2.typing
+import numpy as np
 from linuxpy.video import device
 
-from cogip.cpp.libraries.shared_memory import LockName, SharedMemory, WritePriorityLock
+from cogip.cpp.libraries.shared_memory import SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH, SharedMemory, SimCameraFormat
 from . import logger
 from .arguments import CameraName, VideoCodec
 
@@ -230,6 +231,9 @@ class RPiCamera(Camera):
 
 
 class SimCamera(Camera):
+    # Packed RGB frames take 3/4 of the RGBA bandwidth and are the cheapest to convert to BGR
+    sim_format = SimCameraFormat.RGB
+
     def __init__(
         self,
         robot_id: int,
@@ -242,7 +246,8 @@ class SimCamera(Camera):
     ):
         super().__init__(robot_id, name, codec, width, height, stream_width, stream_height)
         self.shared_memory: SharedMemory | None = None
-        self.shared_sim_camera_data_lock: WritePriorityLock | None = None
+        self.frame_sequence = 0
+        self.frame_timestamp = 0
         params_path = Path(__file__).parent / "cameras" / str(robot_id)
         params_path /= f"{name.name}_{codec.name}_{width}x{height}"
         self.capture_path = params_path / "images"
@@ -252,15 +257,32 @@ class SimCamera(Camera):
     @final
     def open(self):
         self.shared_memory = SharedMemory(f"cogip_{self.robot_id}")
-        self.shared_sim_camera_data = self.shared_memory.get_sim_camera_data()
-        self.shared_sim_camera_data_lock = self.shared_memory.get_lock(LockName.SimCameraData)
+        self.shared_memory.request_sim_camera_format(self.sim_format)
+        self.frame_sequence = 0
+        self.frame_timestamp = 0
 
     @final
     def read(self) -> tuple[cv2.typing.MatLike | None, cv2.typing.MatLike | None]:
-        # Copy and convert RGBA -> BGR for OpenCV
-        self.shared_sim_camera_data_lock.start_reading()
-        frame = cv2.cvtColor(self.shared_sim_camera_data, cv2.COLOR_RGBA2BGR)
-        self.shared_sim_camera_data_lock.finish_reading()
+        # Convert the latest frame in place to BGR for OpenCV, again if the monitor overwrote it meanwhile
+        while True:
+            latest = self.shared_memory.get_sim_camera_frame()
+            if latest is None:
+                # Black image until the monitor publishes its first frame
+                frame = np.zeros((SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH, 3), dtype=np.uint8)
+                return frame, cv2.resize(frame, (self.stream_width, self.stream_height))
+            pixels, header = latest
+            match header.format:
+                case SimCameraFormat.RGB:
+                    frame = cv2.cvtColor(pixels, cv2.COLOR_RGB2BGR)
+                case SimCameraFormat.YUV420:
+                    frame = cv2.cvtColor(pixels, cv2.COLOR_YUV2BGR_I420)
+                case _:
+                    frame = cv2.cvtColor(pixels, cv2.COLOR_RGBA2BGR)
+            if self.shared_memory.is_sim_camera_frame_valid(header):
+                break
+
+        self.frame_sequence = header.sequence
+        self.frame_timestamp = header.timestamp
 
         if self.width != self.stream_width or self.height != self.stream_height:
             stream_frame = cv2.resize(frame, (self.stream_width, self.stream_height))
@@ -271,6 +293,4 @@ class SimCamera(Camera):
 
     @final
     def close(self):
-        self.shared_sim_camera_data_lock = None
-        self.shared_sim_camera_data = None
         self.shared_memory = None
@@ -8,9 +8,8 @@ from pydantic import TypeAdapter
 
 from cogip import models
 from cogip.cpp.libraries.models import MotionDirection
-from cogip.cpp.libraries.models import PoseBuffer as SharedPoseBuffer
 from cogip.cpp.libraries.models import PoseOrderList as SharedPoseOrderList
-from cogip.cpp.libraries.shared_memory import LockName, SharedMemory, WritePriorityLock
+from cogip.cpp.libraries.shared_memory import AvoidancePathVersion, LockName, SharedMemory, WritePriorityLock
 from cogip.models.actuators import ActuatorsKindEnum, ActuatorState
 from cogip.protobuf import (
     PB_ActuatorState,
@@ -24,6 +23,7 @@ from cogip.protobuf import (
     PB_State,
     PB_TelemetryData,
 )
+from cogip.utils.update_waiter import wait_update
 from . import logger
 from .pbcom import PBCom, pb_exception_handler
 from .sio_events import SioEvents
@@ -89,10 +89,9 @@ class Copilot:
         self.retry_connection = True
 
         self.shared_memory: SharedMemory | None = None
-        self.shared_pose_current_buffer: SharedPoseBuffer | None = None
-        self.shared_pose_current_lock: WritePriorityLock | None = None
         self.shared_avoidance_path: SharedPoseOrderList | None = None
         self.shared_avoidance_path_lock: WritePriorityLock | None = None
+        self.shared_avoidance_path_version: AvoidancePathVersion | None = None
         self.new_path_event_task: asyncio.Task | None = None
 
         self.sio = socketio.AsyncClient(logger=False)
@@ -119,11 +118,10 @@ class Copilot:
 
     def create_shared_memory(self):
         self.shared_memory = SharedMemory(f"cogip_{self.id}")
-        self.shared_pose_current_buffer = self.shared_memory.get_pose_current_buffer()
-        self.shared_pose_current_lock = self.shared_memory.get_lock(LockName.PoseCurrent)
         self.shared_avoidance_path = self.shared_memory.get_avoidance_path()
         self.shared_avoidance_path_lock = self.shared_memory.get_lock(LockName.AvoidancePath)
         self.shared_avoidance_path_lock.register_consumer()
+        self.shared_avoidance_path_version = self.shared_memory.get_avoidance_path_version()
         self.new_path_event_task = asyncio.create_task(
             self.new_path_event_loop(),
             name="Robot: Task New Path Event Watcher Loop",
@@ -141,10 +139,9 @@ class Copilot:
                 traceback.print_exc()
         self.new_path_event_task = None
 
+        self.shared_avoidance_path_version = None
         self.shared_avoidance_path_lock = None
         self.shared_avoidance_path = None
-        self.shared_pose_current_buffer = None
-        self.shared_pose_current_lock = None
         self.shared_memory = None
 
     async def run(self):
@@ -200,9 +197,7 @@ class Copilot:
             use_integers_for_enums=True,
         )
         if self.sio_events.connected:
-            self.shared_pose_current_lock.start_writing()
-            self.shared_pose_current_buffer.push(pose["x"], pose["y"], pose["O"])
-            self.shared_pose_current_lock.finish_writing()
+            self.shared_memory.push_pose_current(pose["x"], pose["y"], pose["O"])
 
     @pb_exception_handler
     async def handle_message_state(self, message: bytes | None = None) -> None:
@@ -419,14 +414,26 @@ class Copilot:
         """
         Async worker watching for new path orders in shared memory.
         When a new path is available, its first pose is sent to the firmware.
+        Updates keeping the path id only changed poses after the first one,
+        so they are not sent to avoid resetting the controller.
         """
         logger.info("Copilot: Task New Path Event Watcher Loop started")
+        sent_path_id = None
         try:
             while True:
-                await asyncio.to_thread(self.shared_avoidance_path_lock.wait_update)
-                if len(self.shared_avoidance_path) == 0:
+                await wait_update(self.shared_avoidance_path_lock)
+                self.shared_avoidance_path_lock.start_reading()
+                path_id = self.shared_avoidance_path_version.path_id
+                pose_order = None
+                if len(self.shared_avoidance_path) > 0:
+                    pose_order = models.PathPose.from_shared(self.shared_avoidance_path[0])
+                self.shared_avoidance_path_lock.finish_reading()
+                if pose_order is None:
                     continue
-                pose_order = models.PathPose.from_shared(self.shared_avoidance_path[0])
+                if path_id == sent_path_id:
+                    logger.debug(f"Copilot: Path {path_id} updated after its first pose")
+                    continue
+                sent_path_id = path_id
                 logger.info(f"Copilot: New path available in shared memory: {pose_order}")
                 if self.id > 2:
                     pose_order.motion_direction = MotionDirection.FORWARD_ONLY
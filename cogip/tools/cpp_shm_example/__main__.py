@@ -1,5 +1,5 @@
 #!/usr/bin/env python3
-from cogip.cpp.libraries.obstacles import ObstacleCircle
+from cogip.cpp.libraries.obstacles import CompactObstacleCircle
 from cogip.cpp.libraries.shared_memory import LockName, SharedMemory
 
 
@@ -94,34 +94,41 @@ def main():
     for i, coords in enumerate(reader_detector_obstacles):
         print(f" => reader iterator on detector_obstacles: coords[{i}] = {coords}")
 
-    # Test for circle_obstacles
+    # Test for circle_obstacles and rectangle_obstacles, written in the staging copy then published
     print("\nTest for circle_obstacles")
     reader_circle_obstacles = reader.get_circle_obstacles()
-    writer_circle_obstacles = reader.get_circle_obstacles()
     print(" => reader circle_obstacles size = ", reader_circle_obstacles.size())
+    writer.begin_obstacles_write()
+    writer_circle_obstacles = writer.get_staging_circle_obstacles()
     writer_circle_obstacles.append(10, 20, 90, 200, 0.2, 4)
     writer_circle_obstacles.append(
         x=40, y=50, angle=180, radius=300, bounding_box_margin=0.2, bounding_box_points_number=5
     )
     print(" => writer circle_obstacles size = ", len(writer_circle_obstacles))
-    for i, obstacle in enumerate(reader_circle_obstacles):
-        print(f" => reader iterator on writer_circle_obstacles: obstacle[{i}] = {obstacle}")
 
-    # Test for rectangle_obstacles
     print("\nTest for rectangle_obstacles")
     reader_rectangle_obstacles = reader.get_rectangle_obstacles()
-    writer_rectangle_obstacles = reader.get_rectangle_obstacles()
     print(" => reader rectangle_obstacles size = ", reader_rectangle_obstacles.size())
+    writer_rectangle_obstacles = writer.get_staging_rectangle_obstacles()
     writer_rectangle_obstacles.append(10, 20, 90, 200, 300, 0.2)
     writer_rectangle_obstacles.append(x=40, y=50, angle=180, length_x=250, length_y=350, bounding_box_margin=0.2)
     print(" => writer rectangle_obstacles size = ", len(writer_rectangle_obstacles))
+
+    writer.publish_obstacles()
+    print(" => obstacles generation = ", reader.get_generation(LockName.Obstacles))
+    reader_circle_obstacles = reader.get_circle_obstacles()
+    reader_rectangle_obstacles = reader.get_rectangle_obstacles()
+    for i, obstacle in enumerate(reader_circle_obstacles):
+        print(f" => reader iterator on published circle_obstacles: obstacle[{i}] = {obstacle}")
     for i, obstacle in enumerate(reader_rectangle_obstacles):
-        print(f" => reader iterator on writer_rectangle_obstacles: obstacle[{i}] = {obstacle}")
+        print(f" => reader iterator on published rectangle_obstacles: obstacle[{i}] = {obstacle}")
+    circle_array, rectangle_array = reader.copy_obstacles()
+    print(" => reader copy_obstacles sizes = ", len(circle_array), len(rectangle_array))
 
     # Deep copy test
-    copy_list: list[ObstacleCircle] = []
+    copy_list: list[CompactObstacleCircle] = []
     for obstacle in writer_circle_obstacles:
-        copy_list.append(ObstacleCircle(obstacle, deep_copy=True))
+        copy_list.append(CompactObstacleCircle(obstacle, deep_copy=True))
     copy_list[0].center.x = 11
     copy_list[0].center.y = 22
 
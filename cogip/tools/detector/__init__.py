@@ -1,3 +1,3 @@
 from cogip.utils.logger import Logger
 
-logger = Logger("cogip-detector")
+logger = Logger("cogip-detector", async_cpp=True)
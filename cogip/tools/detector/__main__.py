@@ -46,6 +46,35 @@ def main_opt(
             envvar="DETECTOR_LIDAR_PORT",
         ),
     ] = None,
+    lidar_record: Annotated[
+        Optional[Path],  # noqa
+        typer.Option(
+            help="Record the Lidar scans and current poses in this file.",
+            envvar="DETECTOR_LIDAR_RECORD",
+        ),
+    ] = None,
+    lidar_replay: Annotated[
+        Optional[Path],  # noqa
+        typer.Option(
+            help="Replay the Lidar scans and current poses of this recording instead of using a Lidar.",
+            envvar="DETECTOR_LIDAR_REPLAY",
+        ),
+    ] = None,
+    lidar_sim: Annotated[
+        bool,
+        typer.Option(
+            help="Simulate the Lidar scans from the obstacles of the shared memory instead of using a Lidar.",
+            envvar="DETECTOR_LIDAR_SIM",
+        ),
+    ] = False,
+    replay_speed: Annotated[
+        float,
+        typer.Option(
+            min=0,
+            help="Replay speed of the recording or speed of the simulated Lidar, 1 for real time, 0 for max speed.",
+            envvar="DETECTOR_REPLAY_SPEED",
+        ),
+    ] = 1.0,
     min_distance: Annotated[
         int,
         typer.Option(
@@ -112,6 +141,101 @@ def main_opt(
             envvar="DETECTOR_CLUSTER_EPS",
         ),
     ] = 40.0,
+    prefault_shared_memory: Annotated[
+        bool,
+        typer.Option(
+            help="Prefault the shared memory and lock its hot regions in RAM.",
+            envvar=["COGIP_PREFAULT_SHARED_MEMORY", "DETECTOR_PREFAULT_SHARED_MEMORY"],
+        ),
+    ] = False,
+    deskew: Annotated[
+        bool,
+        typer.Option(
+            help="Convert each Lidar point with the robot pose at its time to compensate the robot motion.",
+            envvar="DETECTOR_DESKEW",
+        ),
+    ] = False,
+    compact_scans: Annotated[
+        bool,
+        typer.Option(
+            help="Convert the scans from the compact scan history (1/64 deg, 0.25 mm, 5 bytes per point) "
+            "instead of the full precision Lidar data.",
+            envvar="DETECTOR_COMPACT_SCANS",
+        ),
+    ] = False,
+    fused_clustering: Annotated[
+        bool,
+        typer.Option(
+            help="Cluster the obstacles in the Lidar data converter thread, right after each scan conversion.",
+            envvar="DETECTOR_FUSED_CLUSTERING",
+        ),
+    ] = False,
+    track_obstacles: Annotated[
+        bool,
+        typer.Option(
+            help="Track the obstacles from scan to scan to give them stable ids and velocities.",
+            envvar="DETECTOR_TRACK_OBSTACLES",
+        ),
+    ] = False,
+    occupancy_grid_resolution: Annotated[
+        int,
+        typer.Option(
+            min=0,
+            max=100,
+            help="Size of the cells of the occupancy grid built from the Lidar points (mm), 0 to disable it.",
+            envvar="DETECTOR_OCCUPANCY_GRID_RESOLUTION",
+        ),
+    ] = 0,
+    occupancy_filter: Annotated[
+        bool,
+        typer.Option(
+            help="Only keep the Lidar points in occupied cells of the occupancy grid, to filter out single-scan noise.",
+            envvar="DETECTOR_OCCUPANCY_FILTER",
+        ),
+    ] = False,
+    decimation_spacing: Annotated[
+        int,
+        typer.Option(
+            min=0,
+            max=200,
+            help="Minimum spacing between the Lidar points kept beyond 500 mm (mm), 0 to keep all points.",
+            envvar="DETECTOR_DECIMATION_SPACING",
+        ),
+    ] = 0,
+    voxel_size: Annotated[
+        int,
+        typer.Option(
+            min=0,
+            max=100,
+            help="Size of the voxel grid replacing the Lidar points of a cell by their centroid (mm), 0 to disable it.",
+            envvar="DETECTOR_VOXEL_SIZE",
+        ),
+    ] = 0,
+    realtime_priority: Annotated[
+        int,
+        typer.Option(
+            min=0,
+            max=99,
+            help="SCHED_FIFO priority of the Lidar and Lidar data converter threads, 0 to keep the default scheduling. "
+            "Needs the CAP_SYS_NICE capability or a high enough RLIMIT_RTPRIO.",
+            envvar="DETECTOR_REALTIME_PRIORITY",
+        ),
+    ] = 0,
+    realtime_cpus: Annotated[
+        list[int] | None,
+        typer.Option(
+            "--realtime-cpu",
+            help="CPU the Lidar and Lidar data converter threads may run on, repeat the option for several CPUs.",
+            envvar="DETECTOR_REALTIME_CPUS",
+        ),
+    ] = None,
+    lock_memory: Annotated[
+        bool,
+        typer.Option(
+            help="Lock the memory of the process in RAM, so the Lidar threads never wait for page faults.",
+            envvar="DETECTOR_LOCK_MEMORY",
+        ),
+    ] = False,
     gui: Annotated[
         bool,
         typer.Option(
@@ -159,6 +283,10 @@ def main_opt(
         robot_id,
         server_url,
         lidar_port,
+        lidar_record,
+        lidar_replay,
+        lidar_sim,
+        replay_speed,
         min_distance,
         max_distance,
         min_intensity,
@@ -166,6 +294,18 @@ def main_opt(
         sensor_delay,
         cluster_min_samples,
         cluster_eps,
+        prefault_shared_memory,
+        deskew,
+        compact_scans,
+        fused_clustering,
+        track_obstacles,
+        occupancy_grid_resolution,
+        occupancy_filter,
+        decimation_spacing,
+        voxel_size,
+        realtime_priority,
+        realtime_cpus or [],
+        lock_memory,
         gui,
         web,
     )
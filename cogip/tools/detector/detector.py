@@ -3,22 +3,23 @@ import threading
 import time
 from pathlib import Path
 
-import numpy as np
 import serial
 import socketio
 import socketio.exceptions
 import systemd.daemon
 from matplotlib import pyplot as plt
 from numpy.typing import NDArray
-from sklearn.cluster import DBSCAN
 
 from cogip.cpp.drivers.lidar_ld19 import LDLidarDriver
+from cogip.cpp.drivers.lidar_replay import LidarRecorder, ReplayLidar
+from cogip.cpp.drivers.lidar_sim import SimLidar
 from cogip.cpp.drivers.ydlidar_g2 import YDLidar
 from cogip.cpp.libraries.models import CircleList as SharedCircleList
 from cogip.cpp.libraries.models import PoseBuffer as SharedPoseBuffer
-from cogip.cpp.libraries.shared_memory import LockName, SharedMemory, WritePriorityLock
-from cogip.cpp.libraries.utils import LidarDataConverter
+from cogip.cpp.libraries.shared_memory import LatencyStage, LockName, SharedMemory, WritePriorityLock
+from cogip.cpp.libraries.utils import LidarCoordsClusterer, LidarDataConverter, ThreadConfig, lock_process_memory
 from cogip.utils import ThreadLoop
+from cogip.utils.trace import start_trace_recording, stop_trace_recording
 from . import logger
 from .gui import DetectorGUI
 from .properties import Properties
@@ -37,6 +38,8 @@ class Detector:
     """
 
     TABLE_LIMITS_MARGIN: int = 50
+    OBSTACLE_MIN_RADIUS: int = 20
+    DECIMATION_MIN_DISTANCE: int = 500
     YDLIDAR_READY_TIMEOUT_MS: int = 10000
 
     def __init__(
@@ -44,6 +47,10 @@ class Detector:
         robot_id: int,
         server_url: str,
         lidar_port: Path | None,
+        lidar_record: Path | None,
+        lidar_replay: Path | None,
+        lidar_sim: bool,
+        replay_speed: float,
         min_distance: int,
         max_distance: int,
         min_intensity: int,
@@ -51,6 +58,18 @@ class Detector:
         sensor_delay: int,
         cluster_min_samples: int,
         cluster_eps: float,
+        prefault_shared_memory: bool,
+        deskew: bool,
+        compact_scans: bool,
+        fused_clustering: bool,
+        track_obstacles: bool,
+        occupancy_grid_resolution: int,
+        occupancy_filter: bool,
+        decimation_spacing: int,
+        voxel_size: int,
+        realtime_priority: int,
+        realtime_cpus: list[int],
+        lock_memory: bool,
         gui: bool,
         web: bool,
     ):
@@ -61,6 +80,10 @@ class Detector:
             robot_id: Robot ID
             server_url: server URL
             lidar_port: Serial port connected to the Lidar
+            lidar_record: File recording the Lidar scans and current poses
+            lidar_replay: Recording replayed instead of using a Lidar
+            lidar_sim: Simulate the Lidar scans from the obstacles of the shared memory instead of using a Lidar
+            replay_speed: Replay speed of the recording or speed of the simulated Lidar, 1 for real time, 0 for max speed
             min_distance: Minimum distance to detect an obstacle
             max_distance: Maximum distance to detect an obstacle
             min_intensity: Minimum intensity to detect an obstacle
@@ -69,6 +92,19 @@ class Detector:
                           unit is the index of pose current to get in the past
             cluster_min_samples: Minimum number of samples to form a cluster
             cluster_eps: Maximum distance between two samples to form a cluster (mm)
+            prefault_shared_memory: Prefault the shared memory and lock its hot regions in RAM
+            deskew: Convert each Lidar point with the robot pose at its time
+            compact_scans: Convert the scans from the compact scan history instead of the full precision Lidar data
+            fused_clustering: Cluster the obstacles in the Lidar data converter thread
+            track_obstacles: Track the obstacles to give them stable ids and velocities
+            occupancy_grid_resolution: Size of the cells of the occupancy grid (mm), 0 to disable it
+            occupancy_filter: Only keep the Lidar points in occupied cells of the occupancy grid
+            decimation_spacing: Minimum spacing between the Lidar points kept beyond DECIMATION_MIN_DISTANCE (mm),
+                                0 to keep all points
+            voxel_size: Size of the voxel grid downsampling the Lidar points (mm), 0 to disable it
+            realtime_priority: SCHED_FIFO priority of the Lidar and Lidar data converter threads, 0 for the default
+            realtime_cpus: CPUs the Lidar and Lidar data converter threads may run on, empty for all
+            lock_memory: Lock the memory of the process in RAM
             gui: Enable GUI
             web: Enable data display on a web server
         """
@@ -88,6 +124,23 @@ class Detector:
         self.robot_id = robot_id
         self.server_url = server_url
         self.lidar_port = lidar_port
+        self.lidar_record = lidar_record
+        self.lidar_replay = lidar_replay
+        self.lidar_sim = lidar_sim
+        self.replay_speed = replay_speed
+        self.prefault_shared_memory = prefault_shared_memory
+        self.trace_path: Path | None = None
+        self.deskew = deskew
+        self.compact_scans = compact_scans
+        self.fused_clustering = fused_clustering
+        self.track_obstacles = track_obstacles
+        self.occupancy_grid_resolution = occupancy_grid_resolution
+        self.occupancy_filter = occupancy_filter
+        self.decimation_spacing = decimation_spacing
+        self.voxel_size = voxel_size
+        self.realtime_priority = realtime_priority
+        self.realtime_cpus = realtime_cpus
+        self.lock_memory = lock_memory
         self.gui = gui
         self.web = web
         self.properties = Properties(
@@ -112,16 +165,16 @@ class Detector:
         self.shared_memory: SharedMemory | None = None
         self.shared_pose_current_lock: WritePriorityLock | None = None
         self.shared_pose_current_buffer: SharedPoseBuffer | None = None
-        self.shared_lidar_data: NDArray | None = None
-        self.shared_lidar_coords: NDArray | None = None
         self.shared_lidar_data_lock: WritePriorityLock | None = None
         self.shared_lidar_coords_lock: WritePriorityLock | None = None
         self.shared_detector_obstacles: SharedCircleList | None = None
         self.shared_detector_obstacles_lock: WritePriorityLock | None = None
 
         self.lidar_data_converter: LidarDataConverter | None = None
+        self.lidar_coords_clusterer: LidarCoordsClusterer | None = None
 
-        self.lidar: LDLidarDriver | YDLidar | None = None
+        self.lidar: LDLidarDriver | YDLidar | ReplayLidar | SimLidar | None = None
+        self.lidar_recorder: LidarRecorder | None = None
         self.clusters: list[NDArray] = []
 
         self.obstacles_updater_loop = ThreadLoop(
@@ -145,11 +198,9 @@ class Detector:
         self.sio.register_namespace(SioEvents(self))
 
     def create_shared_memory(self):
-        self.shared_memory = SharedMemory(f"cogip_{self.robot_id}")
+        self.shared_memory = SharedMemory(f"cogip_{self.robot_id}", prefault=self.prefault_shared_memory)
         self.shared_pose_current_lock = self.shared_memory.get_lock(LockName.PoseCurrent)
         self.shared_pose_current_buffer = self.shared_memory.get_pose_current_buffer()
-        self.shared_lidar_data = self.shared_memory.get_lidar_data()
-        self.shared_lidar_coords = self.shared_memory.get_lidar_coords()
         self.shared_lidar_data_lock = self.shared_memory.get_lock(LockName.LidarData)
         self.shared_lidar_coords_lock = self.shared_memory.get_lock(LockName.LidarCoords)
         self.shared_detector_obstacles = self.shared_memory.get_detector_obstacles()
@@ -159,31 +210,55 @@ class Detector:
         self.shared_lidar_coords_lock.reset()
         # self.shared_lidar_coords_lock.register_consumer()
 
-        # Lidar data is initialized to -1 to indicate that no data is available
-        self.shared_lidar_data[0][0] = -1
-        self.shared_lidar_data[0][1] = -1
-        self.shared_lidar_data[0][2] = -1
-        self.shared_lidar_coords[0][0] = -1
-        self.shared_lidar_coords[0][1] = -1
+        # No lidar data is available until the first scan
+        self.shared_memory.clear_lidar_scans()
 
         self.lidar_data_converter = LidarDataConverter(f"cogip_{self.robot_id}")
         self.lidar_data_converter.set_pose_current_index(self.properties.sensor_delay)
         self.lidar_data_converter.set_lidar_offset_x(self.LIDAR_OFFSET_X)
         self.lidar_data_converter.set_lidar_offset_y(self.LIDAR_OFFSET_Y)
         self.lidar_data_converter.set_table_limits_margin(self.TABLE_LIMITS_MARGIN)
+        self.lidar_data_converter.set_deskew(self.deskew)
+        self.lidar_data_converter.set_compact_input(self.compact_scans)
+        self.lidar_data_converter.set_cluster_obstacles(self.fused_clustering)
+        self.lidar_data_converter.set_cluster_eps(self.properties.cluster_eps)
+        self.lidar_data_converter.set_cluster_min_samples(self.properties.cluster_min_samples)
+        self.lidar_data_converter.set_obstacle_min_radius(self.OBSTACLE_MIN_RADIUS)
+        self.lidar_data_converter.set_track_obstacles(self.track_obstacles)
+        self.lidar_data_converter.set_occupancy_grid(self.occupancy_grid_resolution > 0)
+        if self.occupancy_grid_resolution > 0:
+            self.lidar_data_converter.set_occupancy_grid_resolution(self.occupancy_grid_resolution)
+        self.lidar_data_converter.set_occupancy_filter(self.occupancy_filter)
+        self.lidar_data_converter.set_decimation(self.DECIMATION_MIN_DISTANCE, self.decimation_spacing)
+        self.lidar_data_converter.set_voxel_size(self.voxel_size)
+        self.lidar_data_converter.set_thread_config(self.thread_config("lidar-convert"))
+
+        self.lidar_coords_clusterer = LidarCoordsClusterer(f"cogip_{self.robot_id}")
+        self.lidar_coords_clusterer.set_cluster_eps(self.properties.cluster_eps)
+        self.lidar_coords_clusterer.set_cluster_min_samples(self.properties.cluster_min_samples)
+        self.lidar_coords_clusterer.set_min_radius(self.OBSTACLE_MIN_RADIUS)
+        self.lidar_coords_clusterer.set_track_obstacles(self.track_obstacles)
+
+    def thread_config(self, name: str) -> ThreadConfig:
+        """
+        Scheduling of a Lidar or Lidar data converter thread.
+
+        Arguments:
+            name: Thread name, shown by ps and top
+        """
+        return ThreadConfig(name, self.realtime_priority, self.realtime_cpus)
 
     def delete_shared_memory(self):
         self.shared_detector_obstacles_lock = None
         self.shared_detector_obstacles = None
         self.shared_lidar_data_lock = None
         self.shared_lidar_coords_lock = None
-        self.shared_lidar_coords = None
-        self.shared_lidar_data = None
         self.shared_pose_current_buffer = None
         self.shared_pose_current_lock = None
         self.shared_memory = None
 
         self.lidar_data_converter = None
+        self.lidar_coords_clusterer = None
 
     def connect(self):
         """
@@ -205,10 +280,17 @@ class Detector:
         """
         Start updating obstacles list.
         """
+        if self.lock_memory:
+            try:
+                lock_process_memory()
+            except RuntimeError as exc:
+                logger.error(f"Error: {exc}")
         self.create_shared_memory()
+        self.trace_path = start_trace_recording(f"cogip_{self.robot_id}", "detector")
         self.lidar_data_converter.start()
         self.start_lidar()
-        self.obstacles_updater_loop.start()
+        if not self.fused_clustering:
+            self.obstacles_updater_loop.start()
 
     def stop(self) -> None:
         """
@@ -217,8 +299,44 @@ class Detector:
         self.obstacles_updater_loop.stop()
         self.stop_lidar()
         self.lidar_data_converter.stop()
+        self.log_converter_statistics()
+        self.log_latency_statistics()
+        stop_trace_recording(self.trace_path)
+        self.trace_path = None
         self.delete_shared_memory()
 
+    def log_converter_statistics(self) -> None:
+        """
+        Log the Lidar data conversion statistics, to check the conversion keeps up with the Lidar.
+        """
+        stats = self.lidar_data_converter.get_statistics()
+        if stats.conversions == 0:
+            logger.info(f"Lidar data converter: no scan converted, {stats.timeouts} timeouts")
+            return
+        latency = stats.scan_latency_total / stats.timed_conversions / 1e6 if stats.timed_conversions else 0
+        logger.info(
+            f"Lidar data converter: {stats.conversions} scans ({stats.conversions_per_second:.1f}/s), "
+            f"{stats.dropped_scans} dropped, {stats.timeouts} timeouts, "
+            f"points {stats.points_in} in/{stats.points_out} out "
+            f"({stats.points_filtered} filtered, {stats.points_downsampled} downsampled), "
+            f"conversion avg {stats.conversion_time_total / stats.conversions / 1e3:.0f}us "
+            f"max {stats.conversion_time_max / 1e3:.0f}us, "
+            f"scan latency avg {latency:.1f}ms max {stats.scan_latency_max / 1e6:.1f}ms"
+        )
+
+    def log_latency_statistics(self) -> None:
+        """
+        Log the latency from the Lidar scan capture to the end of each stage, up to the avoidance path.
+        """
+        for stage in LatencyStage:
+            stats = self.shared_memory.get_latency_statistics(stage)
+            if stats.count == 0:
+                continue
+            logger.info(
+                f"Latency to {stage.name}: {stats.count} frames, "
+                f"p50 {stats.p50 / 1e6:.1f}ms p99 {stats.p99 / 1e6:.1f}ms max {stats.max / 1e6:.1f}ms"
+            )
+
     def try_connect(self):
         """
         Poll to wait for the first cogip-server connection.
@@ -236,91 +354,67 @@ class Detector:
                 continue
             break
 
-    def cluster_obstacles(self, lidar_coords: NDArray) -> list[NDArray]:
-        """
-        Groups points into obstacle clusters using DBSCAN
-
-        Returns:
-            List of clusters, each cluster being a set of points belonging to the same obstacle
-        """
-        if len(lidar_coords) == 0:
-            return []
-
-        db = DBSCAN(
-            eps=self.properties.cluster_eps,
-            min_samples=self.properties.cluster_min_samples,
-        ).fit(lidar_coords)
-        labels = db.labels_
-
-        n_clusters = len(set(labels)) - (1 if -1 in labels else 0)
-
-        clusters = []
-        for i in range(n_clusters):
-            cluster_points = lidar_coords[labels == i]
-            clusters.append(cluster_points)
-
-        return clusters
-
-    def estimate_obstacle_properties(self, clusters: list[NDArray]) -> list[tuple[float, float, float]]:
-        """
-        Estimates position and size of obstacles from clusters
-
-        Args:
-            clusters: List of clusters, each cluster being a set of points
-
-        Returns:
-            List of tuples (center_x, center_y, radius) for each obstacle
-        """
-        obstacle_properties = []
-
-        for cluster in clusters:
-            center_x = np.mean(cluster[:, 0])
-            center_y = np.mean(cluster[:, 1])
-
-            # Calculate the maximum distance from center in x and y directions
-            # This will be used as the radius of the circle
-            radius_x = np.max(np.abs(cluster[:, 0] - center_x))
-            radius_y = np.max(np.abs(cluster[:, 1] - center_y))
-            radius = max(radius_x, radius_y, 20)  # Minimum radius of 20
-
-            obstacle_properties.append((center_x, center_y, radius))
-
-        return obstacle_properties
-
     def process_lidar_coords(self):
         """
         Function executed in a thread loop to update and send dynamic obstacles.
         """
-        # self.shared_lidar_coords_lock.wait_update()
-        self.shared_lidar_coords_lock.start_reading()
-        lidar_coords = self.shared_lidar_coords[: np.argmax(self.shared_lidar_coords[:, 0] == -1)].copy()
-        self.shared_lidar_coords_lock.finish_reading()
-
-        self.clusters = self.cluster_obstacles(lidar_coords)
-        obstacles = self.estimate_obstacle_properties(self.clusters)
-        self.shared_detector_obstacles_lock.start_writing()
-        self.shared_detector_obstacles.clear()
-        for x, y, radius in obstacles:
-            self.shared_detector_obstacles.append(x=x, y=y, radius=radius)
-        self.shared_detector_obstacles_lock.finish_writing()
-        self.shared_detector_obstacles_lock.post_update()
-
-        logger.debug(f"Generated obstacles: {obstacles}")
+        # Clusters are written to the shared detector obstacles by the clusterer.
+        count = self.lidar_coords_clusterer.cluster()
+
+        if self.gui:
+            points = self.lidar_coords_clusterer.get_points()
+            labels = self.lidar_coords_clusterer.get_labels()
+            self.clusters = [points[labels == i] for i in range(count)]
+
+        logger.debug(f"Generated obstacles: {count}")
 
     def start_lidar(self):
         """
         Start the Lidar.
         """
-        if self.lidar_port:
+        if self.lidar_record:
+            self.lidar_recorder = LidarRecorder(f"cogip_{self.robot_id}")
+            self.lidar_recorder.start(str(self.lidar_record))
+            logger.info(f"Lidar recording started in {self.lidar_record}.")
+
+        if self.lidar_replay:
+            self.lidar = ReplayLidar()
+            self.lidar.set_shared_memory(self.shared_memory)
+            self.lidar.set_data_write_lock(self.shared_lidar_data_lock)
+            self.lidar.set_speed(self.replay_speed)
+            if not self.lidar.connect(str(self.lidar_replay)):
+                logger.error(f"Error: cannot load Lidar recording {self.lidar_replay}.")
+                os._exit(1)
+            self.lidar.start()
+            logger.info(
+                f"Lidar replay started: {self.lidar.recorded_scan_count()} scans, "
+                f"{self.lidar.recording_duration():.1f}s."
+            )
+        elif self.lidar_sim:
+            self.lidar = SimLidar()
+            self.lidar.set_shared_memory(self.shared_memory)
+            self.lidar.set_data_write_lock(self.shared_lidar_data_lock)
+            self.lidar.set_min_distance(self.properties.min_distance)
+            self.lidar.set_max_distance(self.properties.max_distance)
+            self.lidar.set_mounting(self.LIDAR_OFFSET_X, self.LIDAR_OFFSET_Y)
+            self.lidar.set_speed(self.replay_speed)
+            self.lidar.start()
+            logger.info("Lidar simulation started.")
+        elif self.lidar_port:
             if self.robot_id == 1:
-                self.lidar = YDLidar(self.shared_lidar_data)
+                self.lidar = YDLidar()
                 self.lidar.set_scan_frequency(10)
+                self.lidar.set_rx_thread_config(self.thread_config("ydlidar-rx"))
+                self.lidar.set_scan_thread_config(self.thread_config("ydlidar-scan"))
+                self.lidar.set_publish_thread_config(self.thread_config("ydlidar-publish"))
                 # No excluded angle range
                 self.lidar.set_invalid_angle_range(360, 0)
             else:
-                self.lidar = LDLidarDriver(self.shared_lidar_data)
+                self.lidar = LDLidarDriver()
+                self.lidar.set_rx_thread_config(self.thread_config("ld19-rx"))
                 # Skip rear-facing Lidar data because Lidar is mounted in PAMI
                 self.lidar.set_invalid_angle_range(30, 330)
+            self.lidar.set_shared_memory(self.shared_memory)
             self.lidar.set_data_write_lock(self.shared_lidar_data_lock)
             self.lidar.set_min_distance(self.properties.min_distance)
             self.lidar.set_max_distance(self.properties.max_distance)
@@ -360,3 +454,10 @@ class Detector:
             self.lidar.stop()
             self.lidar.disconnect()
             self.lidar = None
+        if self.lidar_recorder:
+            self.lidar_recorder.stop()
+            logger.info(
+                f"Lidar recording stopped: {self.lidar_recorder.scan_count()} scans, "
+                f"{self.lidar_recorder.pose_count()} poses, {self.lidar_recorder.missed_scan_count()} missed scans."
+            )
+            self.lidar_recorder = None
@@ -127,12 +127,10 @@ class DetectorGUI:
         """Updates the visualization with current data."""
         self.update_robot_pose()
 
-        if self.detector.shared_lidar_coords is None:
+        if self.detector.shared_memory is None:
             return
 
-        lidar_coords = self.detector.shared_lidar_coords[
-            : np.argmax(self.detector.shared_lidar_coords[:, 0] == -1)
-        ].copy()
+        lidar_coords = self.detector.shared_memory.read_lidar_coords()
         self.points_scatter.set_offsets(np.column_stack((lidar_coords[:, 1], lidar_coords[:, 0])))
 
         for scatter in self.cluster_scatters:
@@ -154,10 +152,10 @@ class DetectorGUI:
             )
             self.cluster_scatters.append(scatter)
 
-        for i, obstacle in enumerate(self.detector.shared_detector_obstacles):
-            center_x = obstacle.x
-            center_y = obstacle.y
-            radius = obstacle.radius
+        obstacles = self.detector.shared_detector_obstacles.as_ndarray()
+        for i, (center_x, center_y, radius) in enumerate(
+            zip(obstacles["x"].tolist(), obstacles["y"].tolist(), obstacles["radius"].tolist())
+        ):
             circle = Ellipse(
                 (center_y, center_x),
                 width=radius * 2,
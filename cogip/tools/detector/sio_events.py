@@ -85,3 +85,9 @@ class SioEvents(socketio.ClientNamespace):
                     self.detector.lidar.set_min_intensity(value)
             case "sensor_delay":
                 self.detector.lidar_data_converter.set_pose_current_index(value)
+            case "cluster_eps":
+                self.detector.lidar_coords_clusterer.set_cluster_eps(value)
+                self.detector.lidar_data_converter.set_cluster_eps(value)
+            case "cluster_min_samples":
+                self.detector.lidar_coords_clusterer.set_cluster_min_samples(value)
+                self.detector.lidar_data_converter.set_cluster_min_samples(value)
@@ -1,7 +1,6 @@
 import typing
 from pathlib import Path
 
-import numpy as np
 import uvicorn
 from fastapi import FastAPI, Request
 from fastapi.responses import HTMLResponse, JSONResponse
@@ -26,10 +25,10 @@ def start_web(detector: "Detector", port: int):
 
     @asgi_app.get("/data", response_class=JSONResponse)
     def get_data():
-        if detector.shared_lidar_data is None:
+        if detector.shared_memory is None:
             return JSONResponse(content=[])
 
-        lidar_data = detector.shared_lidar_data[: np.argmax(detector.shared_lidar_data[:, 0] == -1)].copy()
+        lidar_data = detector.shared_memory.read_lidar_data()
 
         return JSONResponse(content=lidar_data.tolist())
 
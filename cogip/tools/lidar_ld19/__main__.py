@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 import threading
 import time
+from collections.abc import Callable
 from pathlib import Path
 from time import sleep
 from typing import Annotated
@@ -26,9 +27,15 @@ MIN_ANGLE: int = 90
 MAX_ANGLE: int = 270
 
 
-def start_console(lidar_data: NDArray, lidar_coords: NDArray):
+def start_console(read_lidar_data: Callable[[], NDArray], read_lidar_coords: Callable[[], NDArray]):
     print("Starting console thread.")
     while not stop_event.is_set():
+        lidar_data = read_lidar_data()
+        lidar_coords = read_lidar_coords()
+        if len(lidar_data) == 0 or len(lidar_coords) == 0:
+            print("No valid lidar data available.")
+            sleep(0.1)
+            continue
         print(
             f"angle: {lidar_data[0, 0]:>5.1f}"
             f" - distance: {int(lidar_data[0, 1]):>4d}mm"
@@ -93,14 +100,11 @@ def main_opt(
     lidar_coords_lock.reset()
     lidar_coords_lock.register_consumer()
 
-    # Lidar data is initialized to -1 to indicate that no data is available
-    lidar_data[0][0] = -1
-    lidar_data[0][1] = -1
-    lidar_data[0][2] = -1
-    lidar_coords[0][0] = -1
-    lidar_coords[0][1] = -1
+    # No lidar data is available until the first scan
+    shared_memory.clear_lidar_scans()
 
-    lidar = LDLidarDriver(lidar_data)
+    lidar = LDLidarDriver()
+    lidar.set_shared_memory(shared_memory)
     lidar.set_data_write_lock(lidar_data_lock)
     lidar.set_min_distance(MIN_DISTANCE)
     lidar.set_max_distance(MAX_DISTANCE)
@@ -132,16 +136,24 @@ def main_opt(
         return
     print("Lidar started.")
 
-    console_thread = threading.Thread(target=start_console, args=(lidar_data, lidar_coords), name="Console thread")
+    console_thread = threading.Thread(
+        target=start_console,
+        args=(shared_memory.read_lidar_data, shared_memory.read_lidar_coords),
+        name="Console thread",
+    )
     console_thread.start()
 
     if web:
-        server_thread = threading.Thread(target=start_web, args=(lidar_data, web_port), name="Server thread")
+        server_thread = threading.Thread(
+            target=start_web,
+            args=(shared_memory.read_lidar_data, web_port),
+            name="Server thread",
+        )
         server_thread.start()
 
     if gui:
         # This function is blocking so set the stop event after exiting the GUI
-        start_gui(lidar_coords, lidar_offset=(LIDAR_OFFSET_X, LIDAR_OFFSET_Y))
+        start_gui(shared_memory.read_lidar_coords, lidar_offset=(LIDAR_OFFSET_X, LIDAR_OFFSET_Y))
         stop_event.set()
     else:
         try:
@@ -1,3 +1,4 @@
+from collections.abc import Callable
 from pathlib import Path
 
 import uvicorn
@@ -11,7 +12,7 @@ asgi_app = FastAPI()
 asgi_server = uvicorn.Server(uvicorn.Config(asgi_app, host="0.0.0.0", access_log=False))
 
 
-def start_web(lidar_points: NDArray, port: int):
+def start_web(read_lidar_points: Callable[[], NDArray], port: int):
     asgi_server.config.port = port
     asgi_app.mount("/static", StaticFiles(directory=Path(__file__).with_name("static")), name="static")
     templates = Jinja2Templates(directory=Path(__file__).with_name("templates"))
@@ -22,13 +23,7 @@ def start_web(lidar_points: NDArray, port: int):
 
     @asgi_app.get("/data", response_class=JSONResponse)
     def get_data():
-        data = lidar_points.tolist()
-        filtered_data = []
-        for point in data:
-            if point[0] == -1:
-                break
-            filtered_data.append(point)
-        return JSONResponse(content=filtered_data)
+        return JSONResponse(content=read_lidar_points().tolist())
 
     try:
         asgi_server.run()
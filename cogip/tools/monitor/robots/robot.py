@@ -1,5 +1,6 @@
 from functools import partial
 
+import numpy as np
 from PySide6.QtCore import QObject, QTimer
 from PySide6.QtCore import SignalInstance as QtSignalInstance
 from PySide6.QtGui import QVector3D
@@ -43,14 +44,14 @@ class Robot:
         if self.virtual_planner:
             self.update_pose_current_timer.start()
 
+        # Virtual lidar scan, one (angle, distance, intensity) row per degree, published with write_lidar_scan()
+        self.lidar_points = np.zeros((360, 3))
         if self.virtual_detector:
-            for i in range(360):
-                self.shm.shared_lidar_data[i][0] = i
-                self.shm.shared_lidar_data[i][2] = 255
+            self.lidar_points[:, 0] = np.arange(360)
+            self.lidar_points[:, 2] = 255
             if self.robot_id > 1:
-                for i in range(90, 270):
-                    self.shm.shared_lidar_data[i][1] = 65535
-            self.shm.shared_lidar_data[360][0] = -1
+                self.lidar_points[90:270, 1] = 65535
+            self.publish_lidar_scan()
 
             # Find Lidar ray nodes
             if self.view is None:
@@ -111,10 +112,10 @@ class Robot:
         if not q_object:
             return
         distance = q_object.property("distance")
-        if abs(distance - self.shm.shared_lidar_data[index][1]) < 1.0:
+        if abs(distance - self.lidar_points[index][1]) < 1.0:
             return
         self.lidar_distances_changed = True
-        self.shm.shared_lidar_data[index][1] = distance
+        self.lidar_points[index][1] = distance
 
     def post_lidar_update(self) -> None:
         """
@@ -122,4 +123,11 @@ class Robot:
         """
         if self.lidar_distances_changed:
             self.lidar_distances_changed = False
-            self.shm.shared_lidar_data_lock.post_update()
+            self.publish_lidar_scan()
+
+    def publish_lidar_scan(self) -> None:
+        """
+        Publish the virtual lidar scan with its point count, then wake up the lidar data consumers.
+        """
+        self.shm.shared_memory.write_lidar_scan(self.lidar_points)
+        self.shm.shared_lidar_data_lock.post_update()
@@ -7,8 +7,6 @@ from shiboken6 import Shiboken
 
 from cogip.cpp.libraries.models import CircleList as SharedCircleList
 from cogip.cpp.libraries.models import PoseBuffer as SharedPoseBuffer
-from cogip.cpp.libraries.obstacles import ObstacleCircleList as SharedObstacleCircleList
-from cogip.cpp.libraries.obstacles import ObstacleRectangleList as SharedObstacleRectangleList
 from cogip.cpp.libraries.shared_memory import LockName, SharedMemory, SharedProperties, WritePriorityLock
 from cogip.utils.singleton import Singleton
 from . import logger
@@ -26,14 +24,10 @@ class SharedMemoryManager(metaclass=Singleton):
         self.robot_id: int | None = None
         self.shared_memory: SharedMemory | None = None
         self.shared_pose_current_buffer: SharedPoseBuffer | None = None
-        self.shared_lidar_data: NDArray | None = None
         self.shared_lidar_data_lock: WritePriorityLock | None = None
-        self.shared_circle_obstacles: SharedObstacleCircleList | None = None
-        self.shared_rectangle_obstacles: SharedObstacleRectangleList | None = None
         self.shared_obstacles_lock: WritePriorityLock | None = None
         self.shared_monitor_obstacles: SharedCircleList | None = None
         self.shared_monitor_obstacles_lock: WritePriorityLock | None = None
-        self.shared_sim_camera_data: NDArray | None = None
         self.shared_sim_camera_data_lock: WritePriorityLock | None = None
         self.shared_properties: SharedProperties | None = None
         self.update_obstacles_timer: QTimer | None = None
@@ -55,11 +49,8 @@ class SharedMemoryManager(metaclass=Singleton):
             self.shared_memory = SharedMemory(f"cogip_{self.robot_id}")
         if virtual_planner:
             self.shared_pose_current_buffer = self.shared_memory.get_pose_current_buffer()
-            self.shared_circle_obstacles = self.shared_memory.get_circle_obstacles()
-            self.shared_rectangle_obstacles = self.shared_memory.get_rectangle_obstacles()
             self.shared_obstacles_lock = self.shared_memory.get_lock(LockName.Obstacles)
             self.shared_obstacles_lock.register_consumer()
-            self.shared_sim_camera_data = self.shared_memory.get_sim_camera_data()
             self.shared_sim_camera_data_lock = self.shared_memory.get_lock(LockName.SimCameraData)
             self.shared_properties = self.shared_memory.get_properties()
             if self.update_obstacles_timer is None:
@@ -77,7 +68,6 @@ class SharedMemoryManager(metaclass=Singleton):
             self.apply_obstacle_data([], [])
 
         if virtual_detector:
-            self.shared_lidar_data = self.shared_memory.get_lidar_data()
             self.shared_lidar_data_lock = self.shared_memory.get_lock(LockName.LidarData)
             self.shared_monitor_obstacles = self.shared_memory.get_monitor_obstacles()
             self.shared_monitor_obstacles_lock = self.shared_memory.get_lock(LockName.MonitorObstacles)
@@ -86,14 +76,10 @@ class SharedMemoryManager(metaclass=Singleton):
         logger.info(f"Disconnecting from shared memory for robot {self.robot_id}")
         self.shared_properties = None
         self.shared_sim_camera_data_lock = None
-        self.shared_sim_camera_data = None
         self.shared_monitor_obstacles_lock = None
         self.shared_monitor_obstacles = None
         self.shared_obstacles_lock = None
-        self.shared_rectangle_obstacles = None
-        self.shared_circle_obstacles = None
         self.shared_lidar_data_lock = None
-        self.shared_lidar_data = None
         self.shared_pose_current_buffer = None
         self.shared_memory = None
         self.robot_id = None
@@ -107,44 +93,56 @@ class SharedMemoryManager(metaclass=Singleton):
         if self.shared_obstacles_lock is None:
             return
 
-        rectangles: list[dict[str, float]] = []
-        circles: list[dict[str, float]] = []
-
-        self.shared_obstacles_lock.start_reading()
-        try:
-            if self.shared_rectangle_obstacles is not None:
-                for rectangle_obstacle in self.shared_rectangle_obstacles:
-                    center = rectangle_obstacle.center
-                    rect_data: dict[str, float] = {
-                        "x": center.x,
-                        "y": center.y,
-                        "angle": center.angle,
-                        "length_x": rectangle_obstacle.length_x,
-                        "length_y": rectangle_obstacle.length_y,
+        # Copy the published lists without waiting for the planner
+        circle_array, rectangle_array = self.shared_memory.copy_obstacles()
+
+        rectangles: list[dict[str, Any]] = []
+        if rectangle_array is not None:
+            for center, length_x, length_y, bounding_box in zip(
+                rectangle_array["center"].tolist(),
+                rectangle_array["length_x"].tolist(),
+                rectangle_array["length_y"].tolist(),
+                self.bounding_boxes(rectangle_array),
+            ):
+                rectangles.append(
+                    {
+                        "x": center[0],
+                        "y": center[1],
+                        "angle": center[2],
+                        "length_x": length_x,
+                        "length_y": length_y,
+                        "bounding_box": bounding_box,
                     }
-                    rect_data["bounding_box"] = [
-                        {"x": vertex.x, "y": vertex.y} for vertex in rectangle_obstacle.bounding_box
-                    ]
-                    rectangles.append(rect_data)
-
-            if self.shared_circle_obstacles is not None:
-                for circle_obstacle in self.shared_circle_obstacles:
-                    center = circle_obstacle.center
-                    circle_data: dict[str, float] = {
-                        "x": center.x,
-                        "y": center.y,
-                        "angle": center.angle,
-                        "radius": circle_obstacle.radius,
+                )
+
+        circles: list[dict[str, Any]] = []
+        if circle_array is not None:
+            for center, radius, bounding_box in zip(
+                circle_array["center"].tolist(),
+                circle_array["radius"].tolist(),
+                self.bounding_boxes(circle_array),
+            ):
+                circles.append(
+                    {
+                        "x": center[0],
+                        "y": center[1],
+                        "angle": center[2],
+                        "radius": radius,
+                        "bounding_box": bounding_box,
                     }
-                    circle_data["bounding_box"] = [
-                        {"x": vertex.x, "y": vertex.y} for vertex in circle_obstacle.bounding_box
-                    ]
-                    circles.append(circle_data)
-        finally:
-            self.shared_obstacles_lock.finish_reading()
+                )
 
         self.apply_obstacle_data(rectangles, circles)
 
+    @staticmethod
+    def bounding_boxes(obstacles: NDArray) -> list[list[dict[str, float]]]:
+        """Return the used bounding box points of each obstacle of a structured obstacle array."""
+        bounding_boxes = obstacles["bounding_box"]
+        return [
+            [{"x": x, "y": y} for x, y in elems[:count]]
+            for count, elems in zip(bounding_boxes["count"].tolist(), bounding_boxes["elems"].tolist())
+        ]
+
     def apply_obstacle_data(self, rectangles: list[dict[str, Any]], circles: list[dict[str, Any]]) -> None:
         targets = [self.view_item, self.scene_root]
         for target in targets:
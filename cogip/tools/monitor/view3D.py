@@ -1,3 +1,4 @@
+import time
 from collections.abc import Sequence
 from typing import Any
 
@@ -8,6 +9,7 @@ from PySide6.QtCore import Slot as QtSlot
 from PySide6.QtQml import QmlElement
 from PySide6.QtQuick import QQuickItemGrabResult
 
+from cogip.cpp.libraries.shared_memory import SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH
 from cogip.models import models
 from cogip.tools.planner.table import TableEnum
 from . import logger
@@ -73,20 +75,19 @@ class View3DBackend(QObject):
         if image.isNull():
             return
 
-        target_height, target_width = self.shm.shared_sim_camera_data.shape[:2]
-        if image.width() != target_width or image.height() != target_height:
+        if image.width() != SIM_CAMERA_WIDTH or image.height() != SIM_CAMERA_HEIGHT:
             image = image.scaled(
-                target_width,
-                target_height,
+                SIM_CAMERA_WIDTH,
+                SIM_CAMERA_HEIGHT,
                 Qt.AspectRatioMode.IgnoreAspectRatio,
                 Qt.TransformationMode.SmoothTransformation,
             )
 
         ptr = image.constBits()
-        arr = np.array(ptr).reshape((target_height, target_width, 4))
-        self.shm.shared_sim_camera_data_lock.start_writing()
-        self.shm.shared_sim_camera_data[:] = arr[:]
-        self.shm.shared_sim_camera_data_lock.finish_writing()
+        arr = np.asarray(ptr).reshape((SIM_CAMERA_HEIGHT, SIM_CAMERA_WIDTH, 4))
+        # Frames are converted to the format requested by the camera tool and published without blocking it
+        self.shm.shared_memory.publish_sim_camera_frame(arr, time.monotonic_ns())
+        self.shm.shared_sim_camera_data_lock.post_update()
 
     def __del__(self):
         try:
@@ -232,10 +233,12 @@ class View3DBackend(QObject):
 
         obstacles = ObstacleStorage.coerce_data(obstacles)
 
+        circles = np.zeros(len(obstacles), dtype=self.shm.shared_monitor_obstacles.dtype)
+        circles["x"] = [obstacle["x"] for obstacle in obstacles]
+        circles["y"] = [obstacle["y"] for obstacle in obstacles]
+
         self.shm.shared_monitor_obstacles_lock.start_writing()
-        self.shm.shared_monitor_obstacles.clear()
-        for obstacle in obstacles:
-            self.shm.shared_monitor_obstacles.append(obstacle["x"], obstacle["y"])
+        self.shm.shared_monitor_obstacles.assign_from_ndarray(circles)
         self.shm.shared_monitor_obstacles_lock.finish_writing()
 
     def update_training_borders_visibility(self):
@@ -255,6 +255,15 @@ def main_opt(
             envvar="PLANNER_GOAP_DEPTH",
         ),
     ] = properties["goap_depth"]["default"],
+    footprint_avoidance: Annotated[
+        bool,
+        typer.Option(
+            "-fa",
+            "--footprint-avoidance",
+            help=properties["footprint_avoidance"]["description"],
+            envvar=["PLANNER_FOOTPRINT_AVOIDANCE"],
+        ),
+    ] = properties["footprint_avoidance"]["default"],
     reload: Annotated[
         bool,
         typer.Option(
@@ -306,6 +315,7 @@ def main_opt(
         start_position,
         avoidance_strategy,
         goap_depth,
+        footprint_avoidance,
         debug,
     )
 
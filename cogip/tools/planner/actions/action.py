@@ -21,6 +21,12 @@ class Action:
 
     logger = logger
 
+    # World bits of the native GOAP search:
+    # bits required to start the action, and bits set and cleared once it is done.
+    goap_required: int = 0
+    goap_sets: int = 0
+    goap_clears: int = 0
+
     def __init__(
         self,
         name: str,
@@ -106,10 +112,11 @@ class Action:
             await pose.act_after_pose()
 
             # Update countdown
-            distance = math.dist(
-                (self.planner.pose_current.x, self.planner.pose_current.y),
-                (pose.x, pose.y),
-            )
+            start = (self.planner.pose_current.x, self.planner.pose_current.y)
+            if self.strategy is not None:
+                distance = self.strategy.path_cost(start, (pose.x, pose.y))
+            else:
+                distance = math.dist(start, (pose.x, pose.y))
             self.planner.game_context.countdown -= asyncio.sleep.total_sleep + distance / average_speed
             asyncio.sleep.reset()
 
@@ -94,7 +94,7 @@ class AlignTopCornerAction(Action):
         )
         if self.planner.shared_properties.table == TableEnum.Training:
             new_pose_current.x -= 1000
-        self.planner.shared_pose_current_buffer.push(new_pose_current.x, new_pose_current.y, new_pose_current.O)
+        self.planner.shared_memory.push_pose_current(new_pose_current.x, new_pose_current.y, new_pose_current.O)
         await self.planner.sio_ns.emit("pose_start", new_pose_current.pose.model_dump())
         await asyncio.sleep(0.5)
 
@@ -146,7 +146,7 @@ class AlignTopCornerAction(Action):
             y=-1500 + self.border_offset,
             O=90,
         )
-        self.planner.shared_pose_current_buffer.push(new_pose_current.x, new_pose_current.y, new_pose_current.O)
+        self.planner.shared_memory.push_pose_current(new_pose_current.x, new_pose_current.y, new_pose_current.O)
         await self.planner.sio_ns.emit("pose_start", new_pose_current.pose.model_dump())
         await asyncio.sleep(0.5)
 
@@ -244,7 +244,7 @@ class AlignTopCornerCameraAction(AlignTopCornerAction):
             init_pose.x -= 1000
 
         self.logger.info(f"{self.name}: Emitting initial pose for camera detection: {init_pose.pose}")
-        self.planner.shared_pose_current_buffer.push(init_pose.x, init_pose.y, init_pose.O)
+        self.planner.shared_memory.push_pose_current(init_pose.x, init_pose.y, init_pose.O)
         await self.planner.sio_ns.emit("pose_start", init_pose.pose.model_dump())
         await asyncio.sleep(0.5)
 
@@ -260,6 +260,6 @@ class AlignTopCornerCameraAction(AlignTopCornerAction):
             )
             if self.planner.shared_properties.table == TableEnum.Training:
                 current_pose.x -= 1000
-        self.planner.shared_pose_current_buffer.push(current_pose.x, current_pose.y, current_pose.O)
+        self.planner.shared_memory.push_pose_current(current_pose.x, current_pose.y, current_pose.O)
         await self.planner.sio_ns.emit("pose_start", current_pose.pose.model_dump())
         await asyncio.sleep(0.5)
@@ -304,7 +304,7 @@ class CaptureCratesCameraAction(CaptureCratesAction):
             )
             if self.planner.shared_properties.table == TableEnum.Training:
                 current_pose.x -= 1000
-        self.planner.shared_pose_current_buffer.push(current_pose.x, current_pose.y, current_pose.O)
+        self.planner.shared_memory.push_pose_current(current_pose.x, current_pose.y, current_pose.O)
         await self.planner.sio_ns.emit("pose_start", current_pose.model_dump(mode="json"))
         await asyncio.sleep(0.5)
 
@@ -377,7 +377,7 @@ class CaptureAndDropCratesCameraAction(CaptureAndDropCratesAction):
             )
             if self.planner.shared_properties.table == TableEnum.Training:
                 current_pose.x -= 1000
-        self.planner.shared_pose_current_buffer.push(current_pose.x, current_pose.y, current_pose.O)
+        self.planner.shared_memory.push_pose_current(current_pose.x, current_pose.y, current_pose.O)
         await self.planner.sio_ns.emit("pose_start", current_pose.model_dump(mode="json"))
         await asyncio.sleep(0.5)
 
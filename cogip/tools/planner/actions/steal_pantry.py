@@ -3,8 +3,10 @@ import functools
 import math
 from typing import TYPE_CHECKING
 
+import numpy as np
+
 from cogip import models
-from cogip.cpp.libraries.obstacles import ObstacleCircle, ObstacleRectangle
+from cogip.cpp.libraries.obstacles import ObstacleRectangle
 from cogip.models.artifacts import Pantry, PantryID
 from cogip.models.models import MotionDirection
 from cogip.tools.planner import actuators
@@ -342,39 +344,41 @@ class StealPantryAction(Action):
             return None
 
         # Check if approach positions is not in an obstacle
-        # and if the path between approach and capture pose is clear
-        self.planner.shared_obstacles_lock.start_reading()
-        for pose in valid_poses.copy():
-            capture_pose = get_relative_pose(
-                pose,
-                front_offset=self.shift_approach - self.shift_capture,
-                angular_offset=0,
-            )
+        # and if the path between approach and capture pose is clear.
+        # The published obstacles are only replaced by the planner itself, in this thread, no lock is needed.
+        shared_memory = self.planner.shared_memory
+
+        # Check dynamic and static obstacles from planner, all poses at once
+        capture_poses = [
+            get_relative_pose(pose, front_offset=self.shift_approach - self.shift_capture, angular_offset=0)
+            for pose in valid_poses
+        ]
+        x = np.array([pose.x for pose in valid_poses], dtype=np.float64)
+        y = np.array([pose.y for pose in valid_poses], dtype=np.float64)
+        capture_x = np.array([pose.x for pose in capture_poses], dtype=np.float64)
+        capture_y = np.array([pose.y for pose in capture_poses], dtype=np.float64)
+        in_obstacle = np.zeros(len(valid_poses), dtype=bool)
+        path_blocked = np.zeros(len(valid_poses), dtype=bool)
+        for obstacle_list in [shared_memory.get_circle_obstacles(), shared_memory.get_rectangle_obstacles()]:
+            in_obstacle |= obstacle_list.points_inside(x, y) >= 0
+            path_blocked |= obstacle_list.segments_crossing(x, y, capture_x, capture_y) >= 0
+
+        for pose, capture_pose, inside, blocked in zip(
+            valid_poses.copy(), capture_poses, in_obstacle, path_blocked, strict=True
+        ):
+            if inside:
+                self.logger.warning(f"{self.name}: Approach position x={pose.x: 5.2f} y={pose.y: 5.2f} in obstacle")
+                valid_poses.remove(pose)
+                continue
+            if blocked:
+                self.logger.warning(
+                    f"{self.name}: Path from approach x={pose.x: 5.2f} y={pose.y: 5.2f}° "
+                    f"to capture x={capture_pose.x: 5.2f} y={capture_pose.y: 5.2f}° intersects obstacle"
+                )
+                valid_poses.remove(pose)
+                continue
 
-            # Check dynamic and static obstacles from planner
             is_valid = True
-            for obstacle_list in [self.planner.shared_circle_obstacles, self.planner.shared_rectangle_obstacles]:
-                obstacle_list: list[ObstacleCircle | ObstacleRectangle]
-                for obstacle in obstacle_list:
-                    if obstacle.is_point_inside(pose.x, pose.y):
-                        self.logger.warning(
-                            f"{self.name}: Approach position x={pose.x: 5.2f} y={pose.y: 5.2f} in obstacle"
-                        )
-                        is_valid = False
-                        break
-                    if obstacle.is_segment_crossing(pose.x, pose.y, capture_pose.x, capture_pose.y):
-                        self.logger.warning(
-                            f"{self.name}: Path from approach x={pose.x: 5.2f} y={pose.y: 5.2f}° "
-                            f"to capture x={capture_pose.x: 5.2f} y={capture_pose.y: 5.2f}° intersects obstacle"
-                        )
-                        is_valid = False
-                        break
-                if not is_valid:
-                    valid_poses.remove(pose)
-                    break
-
-            if not is_valid:
-                continue
 
             # Check against other crates
             for crate_pose in obstacle_crates:
@@ -398,8 +402,6 @@ class StealPantryAction(Action):
             if not is_valid:
                 valid_poses.remove(pose)
 
-        self.planner.shared_obstacles_lock.finish_reading()
-
         if not valid_poses:
             self.logger.warning(f"{self.name}: No valid approach positions available")
             return None
@@ -1,17 +1,24 @@
 import copy
+import math
 from typing import TYPE_CHECKING
 from unittest.mock import patch
 
+import numpy as np
 from devtools import Timer
 
+from cogip.cpp.libraries.avoidance import GOAP_MAX_ACTIONS, GoapPlanner
 from cogip.tools.planner import logger
 from cogip.tools.planner.actions.action import Action
 from cogip.tools.planner.actions.action_wait import WaitAction
+from cogip.tools.planner.avoidance.avoidance import PathCosts
 from cogip.utils import mock
 
 if TYPE_CHECKING:
     from ..planner import Planner
 
+GOAP_BUDGET = 0.1  # Time budget of the native GOAP search (s)
+GOAP_AVERAGE_SPEED = 100  # Average robot speed used by Action.evaluate() (mm/s)
+
 
 class Strategy(list[Action]):
     """
@@ -20,6 +27,8 @@ class Strategy(list[Action]):
     """
 
     evaluated_strategies: list["Strategy"] = []
+    path_costs: PathCosts | None = None  # Path lengths between poses known at the start of the evaluation
+    goap_planner: GoapPlanner | None = None  # Native GOAP search, created on first use
 
     def __init__(self, planner: "Planner"):
         super().__init__()
@@ -27,6 +36,8 @@ class Strategy(list[Action]):
         self.evaluated_actions: list[Action] = []  # Actions done in the evaluation
         self.goap_allowed: bool = False  # Allow GOAP evaluation
         self.can_wait: bool = False  # Use a WaitAction if no other action is possible
+        self.goap_native: bool = True  # Use the native GOAP search instead of the recursive Python evaluation
+        self.goap_world: int = 0  # World bits at the start of the native GOAP search
 
     async def get_next_action(self) -> Action | None:
         """
@@ -34,7 +45,13 @@ class Strategy(list[Action]):
         """
         next_action: Action | None = None
 
-        if self.goap_allowed and self.planner.shared_properties.goap_depth > 0:
+        if self.goap_allowed and self.goap_native and self.planner.shared_properties.goap_depth > 0:
+            logger.info(f"Start native GOAP search with depth {self.planner.shared_properties.goap_depth}")
+            with Timer(verbose=False) as timer:
+                next_action = await self.start_native_evaluation()
+            logger.info(f"  => Evaluation time: {timer.results[-1].elapsed():0.3f}s")
+            logger.info(f"  => Next action: {next_action.name if next_action else 'None'}")
+        elif self.goap_allowed and self.planner.shared_properties.goap_depth > 0:
             logger.info(f"Start GOAP evaluation with depth {self.planner.shared_properties.goap_depth}")
             with Timer(verbose=False) as timer:
                 await self.start_evaluation()
@@ -73,10 +90,20 @@ class Strategy(list[Action]):
 
         return next_action
 
+    def path_cost(self, start: tuple[float, float], goal: tuple[float, float]) -> float:
+        """
+        Length of the path between two points, avoiding obstacles if known from the evaluation start.
+        """
+        if Strategy.path_costs is None:
+            return math.dist(start, goal)
+        return Strategy.path_costs.get(start, goal)
+
     def copy(self) -> "Strategy":
         new_strategy = Strategy(self.planner)
         new_strategy.goap_allowed = self.goap_allowed
         new_strategy.can_wait = False
+        new_strategy.goap_native = self.goap_native
+        new_strategy.goap_world = self.goap_world
         for action in self:
             new_strategy.append(action)
         new_strategy.evaluated_actions = self.evaluated_actions.copy()
@@ -128,7 +155,117 @@ class Strategy(list[Action]):
             patch("asyncio.sleep", mock.MockAsyncioSleep()),
         ):
             Strategy.evaluated_strategies.clear()
+            points = [(self.planner.pose_current.x, self.planner.pose_current.y)]
+            points += [(pose.x, pose.y) for action in self for pose in action.poses]
+            Strategy.path_costs = PathCosts(self.planner.path_cost_avoidance, points)
             await self.evaluate()
+            Strategy.path_costs = None
+
+    async def describe_action(self, action: Action) -> tuple[np.ndarray, float, float] | None:
+        """
+        Evaluate an action once from the current state, on copies of the planner and the action.
+
+        Returns the poses of the action, the time it spends besides travelling between its poses
+        and the score it earns, or None if its weight is null.
+        """
+        mock_planner = mock.MockPlanner(self.planner)
+
+        strategy_copy = self.copy()
+        strategy_copy.planner = mock_planner
+        strategy_copy.remove(action)
+
+        action_planner_backup = action.planner
+        action_strategy_backup = action.strategy
+        action.planner = None
+        action.strategy = None
+        action_copy = copy.deepcopy(action)
+        action.planner = action_planner_backup
+        action.strategy = action_strategy_backup
+        action_copy.planner = mock_planner
+        action_copy.strategy = strategy_copy
+
+        if action_copy.weight() == 0:
+            return None
+
+        poses = np.array([(pose.x, pose.y) for pose in action_copy.poses], dtype=np.float64).reshape(-1, 2)
+        position = (mock_planner.pose_current.x, mock_planner.pose_current.y)
+        travel = 0.0
+        for pose in poses:
+            travel += math.dist(position, pose)
+            position = pose
+
+        countdown = mock_planner.game_context.countdown
+        score = mock_planner.game_context.score
+        await action_copy.evaluate()
+        duration = max(0.0, countdown - mock_planner.game_context.countdown - travel / GOAP_AVERAGE_SPEED)
+
+        return poses, duration, mock_planner.game_context.score - score
+
+    async def start_native_evaluation(self) -> Action | None:
+        """
+        Describe each action once, then search the best sequence of actions with the native GOAP planner.
+
+        Rewards and durations are measured from the current state,
+        dependencies between actions are given by their GOAP world bits.
+        Travel times use the path lengths between all poses, computed with a single avoidance graph build.
+        """
+        if Strategy.goap_planner is None:
+            Strategy.goap_planner = GoapPlanner()
+        goap = Strategy.goap_planner
+        goap.clear_actions()
+        goap.set_average_speed(GOAP_AVERAGE_SPEED)
+        goap.set_start(self.planner.pose_current.x, self.planner.pose_current.y)
+
+        candidates: list[Action] = []
+        with (
+            patch("cogip.tools.planner.actuators.positional_motor_command", mock.async_no_op),
+            patch("cogip.tools.planner.actions.action.Action.logger", mock.MockDummyClass()),
+            patch("asyncio.sleep", mock.MockAsyncioSleep()),
+        ):
+            for action in list(self):
+                if len(candidates) == GOAP_MAX_ACTIONS:
+                    logger.warning(f"  => Only the first {len(candidates)} actions are evaluated")
+                    break
+                description = await self.describe_action(action)
+                if description is None:
+                    continue
+                poses, duration, reward = description
+                goap.add_action(
+                    poses,
+                    duration,
+                    reward,
+                    action.weight(),
+                    required=action.goap_required,
+                    sets=action.goap_sets,
+                    clears=action.goap_clears,
+                    first_allowed=not action.recycled,
+                )
+                candidates.append(action)
+
+        if not candidates:
+            return None
+
+        if self.planner.path_cost_avoidance is not None:
+            self.planner.path_cost_avoidance.load_obstacles_from_shared_memory()
+            goap.compute_costs(self.planner.path_cost_avoidance)
+
+        plan = goap.search(
+            self.goap_world,
+            self.planner.game_context.countdown,
+            self.planner.shared_properties.goap_depth,
+            GOAP_BUDGET,
+        )
+        logger.info(
+            f"  => Expanded nodes: {plan.expanded_nodes}, depth: {plan.depth}"
+            f"{'' if plan.complete else ' (budget spent)'}"
+        )
+        if not plan.actions:
+            return None
+        logger.info(
+            f"  => Best plan: score {plan.reward:g} in {plan.time:0.1f}s: "
+            f"{', '.join(candidates[index].name for index in plan.actions)}"
+        )
+        return candidates[plan.actions[0]]
 
     def print_evaluations(self, max: int = 10):
         sorted_strategies = sorted(
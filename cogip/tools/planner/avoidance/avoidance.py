@@ -1,25 +1,36 @@
+import math
+
+import numpy as np
+
 from cogip import models
 from cogip.cpp.libraries.avoidance import Avoidance as CppAvoidance
+from cogip.cpp.libraries.avoidance import PlanningEngine
 from cogip.cpp.libraries.models import Coords as SharedCoord
 from cogip.cpp.libraries.shared_memory import SharedProperties
 from cogip.utils.argenum import ArgEnum
 from .. import logger
 
 
+# Static roadmaps of fixed obstacles, kept between matches
+ROADMAP_DIRECTORY = "/var/tmp/cogip/roadmaps"
+
+
 class AvoidanceStrategy(ArgEnum):
     Disabled = 0
     StopAndGo = 1
     AvoidanceCpp = 2
+    AvoidanceGrid = 3
 
 
 class Avoidance:
     def __init__(self, shared_properties: SharedProperties):
         self.shared_properties = shared_properties
         self.cpp_avoidance = CppAvoidance(f"cogip_{shared_properties.robot_id}")
+        self.cpp_avoidance.roadmap_directory = ROADMAP_DIRECTORY
 
     def check_recompute(self, pose_current: models.PathPose, goal: models.PathPose) -> bool:
         match self.shared_properties.avoidance_strategy:
-            case AvoidanceStrategy.AvoidanceCpp:
+            case AvoidanceStrategy.AvoidanceCpp | AvoidanceStrategy.AvoidanceGrid:
                 return self.cpp_avoidance.check_recompute(
                     SharedCoord(x=pose_current.x, y=pose_current.y),
                     SharedCoord(x=goal.x, y=goal.y),
@@ -31,35 +42,77 @@ class Avoidance:
         self,
         pose_current: models.PathPose,
         goal: models.PathPose,
+        budget: float | None = None,
+        use_cached_path: bool = False,
     ) -> list[models.PathPose]:
+        """
+        Compute the path from the current pose to the goal.
+
+        With a time budget (in seconds), the best path found within the budget is returned:
+        direct segment, coarse graph or full graph.
+        With `use_cached_path`, the previous path toward the same goal is reused from the current pose
+        if it is still free, without building the graph.
+        """
         match self.shared_properties.avoidance_strategy:
             case AvoidanceStrategy.Disabled:
                 path = [pose_current.model_copy(), goal.model_copy()]
             case _:
-                path = []
-                res = self.cpp_avoidance.avoidance(
-                    SharedCoord(pose_current.x, pose_current.y),
-                    SharedCoord(goal.x, goal.y),
-                )
-                logger.debug(f"Avoidance: build graph success = {res}")
-                if res:
-                    for i in range(self.cpp_avoidance.get_path_size()):
-                        shared_pose = self.cpp_avoidance.get_path_pose(i)
-                        pose = models.PathPose(
-                            x=shared_pose.x,
-                            y=shared_pose.y,
-                            bypass_final_orientation=True,
-                            is_intermediate=True,
-                        )
-                        path.append(pose)
-
-                    # Remove duplicates
-                    path = [p for i, p in enumerate(path) if (p.x, p.y) not in {(p2.x, p2.y) for p2 in path[:i]}]
-
+                if self.shared_properties.avoidance_strategy == AvoidanceStrategy.AvoidanceGrid:
+                    self.cpp_avoidance.planning_engine = PlanningEngine.GRID
+                else:
+                    self.cpp_avoidance.planning_engine = PlanningEngine.VISIBILITY_GRAPH
+                # Start and finish included, duplicates already removed
+                start = SharedCoord(pose_current.x, pose_current.y)
+                finish = SharedCoord(goal.x, goal.y)
+                points = self.cpp_avoidance.validate_cached_path(start) if use_cached_path else []
+                if len(points) > 0:
+                    logger.debug("Avoidance: cached path reused")
+                elif budget is None:
+                    points = self.cpp_avoidance.compute_path(start, finish)
+                else:
+                    points, optimal = self.cpp_avoidance.compute_path_within(start, finish, budget)
+                    if len(points) > 0 and not optimal:
+                        logger.debug("Avoidance: planning budget spent, using the coarse path")
+                logger.debug(f"Avoidance: build graph success = {len(points) > 0}")
+                path = [
+                    models.PathPose(
+                        x=float(x),
+                        y=float(y),
+                        bypass_final_orientation=True,
+                        is_intermediate=True,
+                    )
+                    for x, y in points[:-1]
+                ]
+                if path:
                     # Append final pose order
                     path.append(goal.model_copy())
-                else:
-                    path = []
                 if self.shared_properties.avoidance_strategy == AvoidanceStrategy.StopAndGo and len(path) > 2:
                     path = []
         return path
+
+
+class PathCosts:
+    """
+    Path lengths between points known before a GOAP evaluation.
+
+    The avoidance graph is built once for all points, so each evaluated leaf
+    only pays a lookup. Lengths of unknown point pairs, or of pairs without path,
+    fall back to the straight line distance.
+    """
+
+    def __init__(self, cpp_avoidance: CppAvoidance | None, points: list[tuple[float, float]]):
+        self.indexes = {point: i for i, point in enumerate(dict.fromkeys(points))}
+        self.costs = None
+        if cpp_avoidance is not None and self.indexes:
+            cpp_avoidance.load_obstacles_from_shared_memory()
+            array = np.array(list(self.indexes), dtype=np.float64)
+            self.costs = cpp_avoidance.compute_path_costs(array, array)
+
+    def get(self, start: tuple[float, float], goal: tuple[float, float]) -> float:
+        i = self.indexes.get(start)
+        j = self.indexes.get(goal)
+        if self.costs is not None and i is not None and j is not None:
+            cost = float(self.costs[i, j])
+            if math.isfinite(cost):
+                return cost
+        return math.dist(start, goal)
@@ -4,27 +4,37 @@ import os
 import time
 
 from cogip import models
+from cogip.cpp.libraries.avoidance import AvoidanceService
+from cogip.cpp.libraries.models import Coords as SharedCoord
 from cogip.cpp.libraries.models import MotionDirection
-from cogip.cpp.libraries.obstacles import ObstacleCircle as SharedObstacleCircle
-from cogip.cpp.libraries.obstacles import ObstacleRectangle as SharedObstacleRectangle
-from cogip.cpp.libraries.shared_memory import LockName, SharedMemory
+from cogip.cpp.libraries.shared_memory import LatencyStage, LockName, SharedMemory
 from cogip.utils.logger import Logger
-from .avoidance import Avoidance, AvoidanceStrategy
+from cogip.utils.trace import trace_recording
+from .avoidance import ROADMAP_DIRECTORY, Avoidance, AvoidanceStrategy
+
+# Part of the refresh interval given to path planning, the rest is left to obstacle loading and publishing
+PLANNING_BUDGET_RATIO = 0.8
 
 
 def avoidance_process(robot_id: int):
+    with trace_recording(f"cogip_{robot_id}", "avoidance"):
+        avoidance_loop(robot_id)
+
+
+def avoidance_loop(robot_id: int):
     logger = Logger("cogip-avoidance", enable_cpp=True)
     if os.getenv("AVOIDANCE_DEBUG") not in [None, False, "False", "false", 0, "0", "no", "No"]:
         logger.setLevel(logging.DEBUG)
 
     logger.info("Avoidance: process started")
+
+    if os.getenv("AVOIDANCE_NATIVE") not in [None, False, "False", "false", 0, "0", "no", "No"]:
+        native_avoidance_loop(robot_id, logger.isEnabledFor(logging.DEBUG))
+        logger.info("Avoidance: process exited")
+        return
+
     shared_memory = SharedMemory(f"cogip_{robot_id}")
     shared_properties = shared_memory.get_properties()
-    shared_pose_current_buffer = shared_memory.get_pose_current_buffer()
-    shared_pose_current_lock = shared_memory.get_lock(LockName.PoseCurrent)
-    shared_circle_obstacles = shared_memory.get_circle_obstacles()
-    shared_rectangle_obstacles = shared_memory.get_rectangle_obstacles()
-    shared_obstacles_lock = shared_memory.get_lock(LockName.Obstacles)
     shared_avoidance_pose_order = shared_memory.get_avoidance_pose_order()
     shared_avoidance_blocked_lock = shared_memory.get_lock(LockName.AvoidanceBlocked)
     shared_avoidance_path = shared_memory.get_avoidance_path()
@@ -54,6 +64,7 @@ def avoidance_process(robot_id: int):
             shared_memory.avoidance_has_new_pose_order = False
             last_pose_current = None
             last_emitted_pose_order = None
+            avoidance.cpp_avoidance.clear_cached_path()
 
         # Check if pose order is available
         if not shared_memory.avoidance_has_pose_order or not pose_order:
@@ -63,10 +74,7 @@ def avoidance_process(robot_id: int):
             continue
 
         # Get current pose
-        shared_pose_current_lock.start_reading()
-        shared_pose_current = shared_pose_current_buffer.last
-        pose_current = models.PathPose.from_shared(shared_pose_current)
-        shared_pose_current_lock.finish_reading()
+        pose_current = models.PathPose.from_shared(shared_memory.read_pose_current())
 
         if last_pose_current:
             # Check if pose order is far enough from current pose
@@ -89,23 +97,13 @@ def avoidance_process(robot_id: int):
                 logger.debug(f"Avoidance: Skip path update (current pose too close: {dist:0.2f}mm)")
                 continue
 
-        # Create dynamic obstacles
-        dyn_obstacles: list[SharedObstacleCircle | SharedObstacleRectangle] = []
+        # Snapshot dynamic obstacles to not block the shared memory
         if shared_properties.avoidance_strategy != AvoidanceStrategy.Disabled:
-            # Deep copy of obstacles to not block the shared memory
-            shared_obstacles_lock.start_reading()
-            for obstacle in shared_circle_obstacles:
-                dyn_obstacles.append(SharedObstacleCircle(obstacle, deep_copy=True))
-            for obstacle in shared_rectangle_obstacles:
-                dyn_obstacles.append(SharedObstacleRectangle(obstacle, deep_copy=True))
-            shared_obstacles_lock.finish_reading()
-
-        if shared_properties.avoidance_strategy == AvoidanceStrategy.AvoidanceCpp:
-            # Recreate obstacles list
+            avoidance.cpp_avoidance.load_obstacles_from_shared_memory()
+        else:
             avoidance.cpp_avoidance.clear_dynamic_obstacles()
-            for obstacle in dyn_obstacles:
-                avoidance.cpp_avoidance.add_dynamic_obstacle(obstacle)
 
+        if shared_properties.avoidance_strategy in (AvoidanceStrategy.AvoidanceCpp, AvoidanceStrategy.AvoidanceGrid):
             # Path is recomputed only if the pose order is reachable or an obstacle prevents
             # to reach next path pose.
             if (
@@ -117,12 +115,17 @@ def avoidance_process(robot_id: int):
                 or avoidance.check_recompute(pose_current, last_emitted_pose_order)
             ):
                 logger.info("Avoidance: compute path")
-                path = avoidance.get_path(pose_current, pose_order)
+                path = avoidance.get_path(
+                    pose_current,
+                    pose_order,
+                    path_refresh_interval * PLANNING_BUDGET_RATIO,
+                    use_cached_path=True,
+                )
         else:
-            if any([obstacle.is_point_inside(pose_current.x, pose_current.y) for obstacle in dyn_obstacles]):
+            if avoidance.cpp_avoidance.is_point_in_obstacles(SharedCoord(pose_current.x, pose_current.y)):
                 logger.info("Avoidance: pose current in obstacle")
                 path = []
-            elif any([obstacle.is_point_inside(pose_order.x, pose_order.y) for obstacle in dyn_obstacles]):
+            elif avoidance.cpp_avoidance.is_point_in_obstacles(SharedCoord(pose_order.x, pose_order.y)):
                 logger.info("Avoidance: pose order in obstacle")
                 path = []
             else:
@@ -270,8 +273,11 @@ def avoidance_process(robot_id: int):
             shared_avoidance_path.append()
             shared_pose = shared_avoidance_path[shared_avoidance_path.size() - 1]
             pose.to_shared(shared_pose)
+        shared_memory.commit_avoidance_path(0)
         shared_avoidance_path_lock.finish_writing()
         shared_avoidance_path_lock.post_update()
+        if shared_properties.avoidance_strategy != AvoidanceStrategy.Disabled:
+            shared_memory.stamp_latency(LatencyStage.AvoidancePath, avoidance.cpp_avoidance.obstacles_latency_frame)
         logger.info(f"Avoidance: Path updated with {len(adjusted_path) - 1} poses")
 
     # Remove reference to shared memory data to trigger garbage collection
@@ -279,12 +285,25 @@ def avoidance_process(robot_id: int):
     shared_avoidance_path = None
     shared_avoidance_blocked_lock = None
     shared_avoidance_pose_order = None
-    shared_circle_obstacles = None
-    shared_rectangle_obstacles = None
-    shared_obstacles_lock = None
-    shared_pose_current_lock = None
-    shared_pose_current_buffer = None
     shared_properties = None
     shared_memory = None
 
     logger.info("Avoidance: process exited")
+
+
+def native_avoidance_loop(robot_id: int, debug: bool):
+    """
+    Run the avoidance loop in a native thread, until the planner requests the process to exit.
+    """
+    shared_memory = SharedMemory(f"cogip_{robot_id}")
+    service = AvoidanceService(f"cogip_{robot_id}")
+    service.set_debug(debug)
+    service.avoidance.roadmap_directory = ROADMAP_DIRECTORY
+    service.start()
+
+    while service.is_running() and not shared_memory.avoidance_exiting:
+        time.sleep(0.1)
+
+    service.stop()
+    service = None
+    shared_memory = None
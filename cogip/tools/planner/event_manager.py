@@ -3,6 +3,8 @@ import traceback
 from datetime import UTC, datetime
 from typing import TYPE_CHECKING
 
+from cogip.utils.update_waiter import wait_update
+
 from . import logger
 
 if TYPE_CHECKING:
@@ -62,7 +64,7 @@ class EventManager:
         logger.info("Planner: Task Blocked Event Watcher Loop started")
         try:
             while True:
-                updated = await asyncio.to_thread(self.planner.shared_avoidance_blocked_lock.wait_update, 1.0)
+                updated = await wait_update(self.planner.shared_avoidance_blocked_lock, 1.0)
                 if not updated:
                     continue
                 if self.planner.sio.connected:
@@ -84,7 +86,7 @@ class EventManager:
         logger.info("Planner: Task New Path Event Watcher Loop started")
         try:
             while True:
-                updated = await asyncio.to_thread(self.planner.shared_avoidance_path_lock.wait_update, 1.0)
+                updated = await wait_update(self.planner.shared_avoidance_path_lock, 1.0)
                 if not updated:
                     continue
                 self.planner.blocked_counter = 0
@@ -1,4 +1,5 @@
 import asyncio
+import math
 import platform
 import re
 import sys
@@ -11,6 +12,7 @@ from pathlib import Path
 from typing import Any
 from unittest.mock import Mock
 
+import numpy as np
 import socketio
 from colorzero import Color
 from gpiozero import RGBLED, Button, OutputDevice
@@ -22,19 +24,19 @@ from numpy.typing import NDArray
 from PIL import ImageFont
 
 from cogip import models
+from cogip.cpp.libraries.avoidance import Avoidance as CppAvoidance
 from cogip.cpp.libraries.models import CircleList as SharedCircleList
 from cogip.cpp.libraries.models import PoseBuffer as SharedPoseBuffer
 from cogip.cpp.libraries.models import PoseOrder as SharedPoseOrder
 from cogip.cpp.libraries.models import PoseOrderList as SharedPoseOrderList
-from cogip.cpp.libraries.obstacles import ObstacleCircleList as SharedObstacleCircleList
-from cogip.cpp.libraries.obstacles import ObstacleRectangleList as SharedObstacleRectangleList
+from cogip.cpp.libraries.obstacles import CompactObstacleRectangle as SharedObstacleRectangle
 from cogip.cpp.libraries.shared_memory import LockName, SharedMemory, SharedProperties, WritePriorityLock
 from cogip.models.actuators import ActuatorState
 from cogip.tools.copilot.controller import ControllerEnum
 from cogip.utils.asyncloop import AsyncLoop
 from . import actuators, cameras, logger, pose, sio_events
 from .actions import StrategyEnum, action, strategy, strategy_classes
-from .avoidance.avoidance import AvoidanceStrategy
+from .avoidance.avoidance import ROADMAP_DIRECTORY, AvoidanceStrategy
 from .avoidance.process import avoidance_process
 from .camp import Camp
 from .context import GameContext
@@ -42,7 +44,7 @@ from .event_manager import EventManager
 from .properties import properties_schema
 from .scservos import SCServoEnum, SCServos
 from .start_positions import StartPositionEnum, StartPositions
-from .table import TableEnum, get_table
+from .table import Table, TableEnum, get_table
 from .wizard import GameWizard
 
 
@@ -78,6 +80,7 @@ class Planner:
         start_position: StartPositionEnum,
         avoidance_strategy: AvoidanceStrategy,
         goap_depth: int,
+        footprint_avoidance: bool,
         debug: bool,
     ):
         """
@@ -109,6 +112,7 @@ class Planner:
             start_position: Default start position on startup
             avoidance_strategy: Default avoidance strategy on startup
             goap_depth: Depth of the GOAP search tree
+            footprint_avoidance: Avoid real obstacles with the robot footprint instead of inflated obstacles
             debug: enable debug messages
         """
         self.robot_id = robot_id
@@ -128,13 +132,13 @@ class Planner:
         self.shared_detector_obstacles_lock: WritePriorityLock | None = None
         self.shared_monitor_obstacles: SharedCircleList | None = None
         self.shared_monitor_obstacles_lock: WritePriorityLock | None = None
-        self.shared_circle_obstacles: SharedObstacleCircleList | None = None
-        self.shared_rectangle_obstacles: SharedObstacleRectangleList | None = None
         self.shared_obstacles_lock: WritePriorityLock | None = None
         self.shared_avoidance_pose_order: SharedPoseOrder | None = None
         self.shared_avoidance_blocked_lock: WritePriorityLock | None = None
         self.shared_avoidance_path: SharedPoseOrderList | None = None
         self.shared_avoidance_path_lock: WritePriorityLock | None = None
+        self.path_cost_avoidance: CppAvoidance | None = None
+        self.static_roadmap_key: tuple | None = None
         self.create_shared_memory()
 
         # Fix type checker after shared memory creation
@@ -156,6 +160,7 @@ class Planner:
         self.shared_properties.start_position = start_position.val
         self.shared_properties.avoidance_strategy = avoidance_strategy.val
         self.shared_properties.goap_depth = goap_depth
+        self.shared_properties.footprint_avoidance = footprint_avoidance
 
         self.virtual = platform.machine() != "aarch64"
         self.retry_connection = True
@@ -245,8 +250,6 @@ class Planner:
             self.shared_detector_obstacles_lock = self.shared_memory.get_lock(LockName.DetectorObstacles)
             self.shared_monitor_obstacles = self.shared_memory.get_monitor_obstacles()
             self.shared_monitor_obstacles_lock = self.shared_memory.get_lock(LockName.MonitorObstacles)
-            self.shared_circle_obstacles = self.shared_memory.get_circle_obstacles()
-            self.shared_rectangle_obstacles = self.shared_memory.get_rectangle_obstacles()
             self.shared_obstacles_lock = self.shared_memory.get_lock(LockName.Obstacles)
             self.shared_avoidance_pose_order = self.shared_memory.get_avoidance_pose_order()
             self.shared_avoidance_blocked_lock = self.shared_memory.get_lock(LockName.AvoidanceBlocked)
@@ -255,16 +258,18 @@ class Planner:
             self.shared_avoidance_path = self.shared_memory.get_avoidance_path()
             self.shared_avoidance_path_lock = self.shared_memory.get_lock(LockName.AvoidancePath)
             self.shared_avoidance_path_lock.register_consumer()
+            self.path_cost_avoidance = CppAvoidance(f"cogip_{self.robot_id}")
+            self.path_cost_avoidance.roadmap_directory = ROADMAP_DIRECTORY
+            self.static_roadmap_key = None
 
     def delete_shared_memory(self):
         if self.shared_memory is not None:
+            self.path_cost_avoidance = None
             self.shared_avoidance_path_lock = None
             self.shared_avoidance_path = None
             self.shared_avoidance_blocked_lock = None
             self.shared_avoidance_pose_order = None
             self.shared_obstacles_lock = None
-            self.shared_rectangle_obstacles = None
-            self.shared_circle_obstacles = None
             self.shared_monitor_obstacles_lock = None
             self.shared_monitor_obstacles = None
             self.shared_detector_obstacles_lock = None
@@ -304,7 +309,7 @@ class Planner:
         """
         Get the current pose of the robot.
         """
-        pose = self.shared_pose_current_buffer.last
+        pose = self.shared_memory.read_pose_current()
         return models.Pose(x=pose.x, y=pose.y, O=pose.angle)
 
     async def start(self):
@@ -414,7 +419,7 @@ class Planner:
 
         # When the firmware receives a pose start, it does not send its updated pose current,
         # so do it here.
-        self.shared_pose_current_buffer.push(pose_start.x, pose_start.y, pose_start.O)
+        self.shared_memory.push_pose_current(pose_start.x, pose_start.y, pose_start.O)
         await self.sio_ns.emit("pose_start", pose_start.model_dump())
 
     @property
@@ -519,10 +524,75 @@ class Planner:
             if not self.pose_order:
                 asyncio.create_task(self.set_pose_reached())
 
+    def obstacle_inflation(self, margin: float) -> tuple[float, float, float, float]:
+        """
+        Sizes added to obstacles for the avoidance: rectangle length increase, circle radius increase,
+        circle bounding box margin and rectangle bounding box margin.
+
+        Obstacles are inflated by the robot size, unless the avoidance tests the robot footprint
+        against their real size. In that case, bounding box points are moved away from obstacles
+        by the footprint rotation radius, so the robot can turn there. The rectangle margin is split
+        between both sides, so its corners need a larger one.
+        """
+        if self.shared_properties.footprint_avoidance:
+            rotation_radius = math.hypot(self.shared_properties.robot_width, self.shared_properties.robot_length) / 2
+            return 0, 0, margin + rotation_radius, margin + math.sqrt(2) * rotation_radius
+        return self.shared_properties.robot_width, self.shared_properties.robot_length / 2, margin, margin
+
+    def fixed_obstacles_parameters(self, table: Table, margin: float) -> list[dict[str, Any]]:
+        """
+        Parameters of the enabled fixed obstacles, as appended to the shared rectangle obstacles.
+        """
+        length_increase, _, _, bounding_box_margin = self.obstacle_inflation(margin)
+        return [
+            dict(
+                x=fixed_obstacle.x,
+                y=fixed_obstacle.y,
+                angle=0,
+                length_x=fixed_obstacle.width + length_increase,
+                length_y=fixed_obstacle.length + length_increase,
+                bounding_box_margin=bounding_box_margin,
+                id=fixed_obstacle.id.value,
+            )
+            for fixed_obstacle in self.game_context.fixed_obstacles.values()
+            if fixed_obstacle.enabled and table.contains(fixed_obstacle, margin)
+        ]
+
+    def update_static_roadmap(self, fixed_obstacles: list[dict[str, Any]]):
+        """
+        Give fixed obstacles to the avoidance, which loads their roadmap from the roadmap directory
+        or computes it there, so avoidance processes can load it.
+        Only done when the table, the robot footprint or the fixed obstacles change.
+        """
+        if self.path_cost_avoidance is None:
+            return
+        key = (
+            self.shared_properties.table,
+            self.shared_properties.robot_width,
+            self.shared_properties.robot_length,
+            self.shared_properties.obstacle_bb_margin,
+            self.shared_properties.obstacle_bb_vertices,
+            self.shared_properties.footprint_avoidance,
+            tuple(tuple(parameters.values()) for parameters in fixed_obstacles),
+        )
+        if key == self.static_roadmap_key:
+            return
+        self.static_roadmap_key = key
+        obstacles = [
+            SharedObstacleRectangle(**{name: value for name, value in parameters.items() if name != "id"})
+            for parameters in fixed_obstacles
+        ]
+        loaded = self.path_cost_avoidance.set_static_obstacles(obstacles)
+        logger.info(f"Planner: static roadmap of {len(obstacles)} fixed obstacles {'loaded' if loaded else 'computed'}")
+
     async def update_obstacles(self):
         table = get_table(self.shared_properties.table)
         try:
             margin = self.shared_properties.obstacle_bb_margin * self.shared_properties.robot_length / 2
+            length_increase, radius_increase, circle_margin, rectangle_margin = self.obstacle_inflation(margin)
+            fixed_obstacles = self.fixed_obstacles_parameters(table, margin)
+            if not self.shared_properties.disable_fixed_obstacles:
+                self.update_static_roadmap(fixed_obstacles)
             if self.shared_properties.bypass_detector:
                 shared_obstacles = self.shared_monitor_obstacles
                 shared_lock = self.shared_monitor_obstacles_lock
@@ -530,28 +600,36 @@ class Planner:
                 shared_obstacles = self.shared_detector_obstacles
                 shared_lock = self.shared_detector_obstacles_lock
             shared_lock.start_reading()
-            self.shared_obstacles_lock.start_writing()
-            self.shared_circle_obstacles.clear()
-            self.shared_rectangle_obstacles.clear()
-
-            # Add dynamic obstacles
-            for detector_obstacle in shared_obstacles:
-                if not table.contains(detector_obstacle, margin):
-                    continue
-                if self.robot_id == 1:
-                    radius = self.shared_properties.obstacle_radius
-                else:
-                    radius = detector_obstacle.radius
-                radius += self.shared_properties.robot_length / 2
-                self.shared_circle_obstacles.append(
-                    x=detector_obstacle.x,
-                    y=detector_obstacle.y,
-                    angle=0,
-                    radius=radius,
-                    bounding_box_margin=margin,
-                    bounding_box_points_number=self.shared_properties.obstacle_bb_vertices,
+            # Fill the staging copy without blocking readers, they keep the published copy until the flip
+            self.shared_memory.begin_obstacles_write()
+            shared_circle_obstacles = self.shared_memory.get_staging_circle_obstacles()
+            shared_rectangle_obstacles = self.shared_memory.get_staging_rectangle_obstacles()
+
+            # Add dynamic obstacles, all written by a single call
+            circles = [
+                (
+                    detector_obstacle.x,
+                    detector_obstacle.y,
+                    self.shared_properties.obstacle_radius if self.robot_id == 1 else detector_obstacle.radius,
+                    detector_obstacle.id,
+                    detector_obstacle.vx,
+                    detector_obstacle.vy,
                 )
+                for detector_obstacle in shared_obstacles
+                if table.contains(detector_obstacle, margin)
+            ][: shared_circle_obstacles.max_size()]
             shared_lock.finish_reading()
+            shared_circle_obstacles.assign_circles(
+                x=np.array([circle[0] for circle in circles], dtype=np.float64),
+                y=np.array([circle[1] for circle in circles], dtype=np.float64),
+                radius=np.array([circle[2] for circle in circles], dtype=np.float64) + radius_increase,
+                id=np.array([circle[3] for circle in circles], dtype=np.uint32),
+                angle=0,
+                bounding_box_margin=circle_margin,
+                bounding_box_points_number=self.shared_properties.obstacle_bb_vertices,
+                vx=np.array([circle[4] for circle in circles], dtype=np.float64),
+                vy=np.array([circle[5] for circle in circles], dtype=np.float64),
+            )
 
             if not self.shared_properties.disable_fixed_obstacles:
                 if self.robot_id == 1:
@@ -561,13 +639,13 @@ class Planner:
                             continue
                         if not table.contains(collection_area, margin):
                             continue
-                        self.shared_rectangle_obstacles.append(
+                        shared_rectangle_obstacles.append(
                             x=collection_area.x,
                             y=collection_area.y,
                             angle=collection_area.O,
-                            length_x=collection_area.length + self.shared_properties.robot_width,
-                            length_y=collection_area.width + self.shared_properties.robot_width,
-                            bounding_box_margin=margin,
+                            length_x=collection_area.length + length_increase,
+                            length_y=collection_area.width + length_increase,
+                            bounding_box_margin=rectangle_margin,
                             id=collection_area.id.value,
                         )
                     for pantry in self.game_context.pantries.values():
@@ -575,33 +653,21 @@ class Planner:
                             continue
                         if not table.contains(pantry, margin):
                             continue
-                        self.shared_rectangle_obstacles.append(
+                        shared_rectangle_obstacles.append(
                             x=pantry.x,
                             y=pantry.y,
                             angle=pantry.O,
-                            length_x=pantry.length + self.shared_properties.robot_width,
-                            length_y=pantry.width + self.shared_properties.robot_width,
-                            bounding_box_margin=margin,
+                            length_x=pantry.length + length_increase,
+                            length_y=pantry.width + length_increase,
+                            bounding_box_margin=rectangle_margin,
                             id=pantry.id.value,
                         )
 
                 # Add fixed obstacles
-                for fixed_obstacle in self.game_context.fixed_obstacles.values():
-                    if not fixed_obstacle.enabled:
-                        continue
-                    if not table.contains(fixed_obstacle, margin):
-                        continue
-                    self.shared_rectangle_obstacles.append(
-                        x=fixed_obstacle.x,
-                        y=fixed_obstacle.y,
-                        angle=0,
-                        length_x=fixed_obstacle.width + self.shared_properties.robot_width,
-                        length_y=fixed_obstacle.length + self.shared_properties.robot_width,
-                        bounding_box_margin=margin,
-                        id=fixed_obstacle.id.value,
-                    )
+                for parameters in fixed_obstacles:
+                    shared_rectangle_obstacles.append(**parameters)
 
-            self.shared_obstacles_lock.finish_writing()
+            self.shared_memory.publish_obstacles()
             self.shared_obstacles_lock.post_update()
         except Exception as exc:
             logger.warning(f"Planner: update_obstacles: Unknown exception {exc}")
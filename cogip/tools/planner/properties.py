@@ -82,5 +82,12 @@ properties_schema = {
             "minimum": 0,
             "default": 0,
         },
+        "footprint_avoidance": {
+            "title": "Footprint Avoidance",
+            "description": "Avoid real obstacles with the robot footprint heading along the path, "
+            "instead of obstacles inflated by the robot size",
+            "type": "boolean",
+            "default": False,
+        },
     },
 }
@@ -15,8 +15,7 @@ from fastapi import FastAPI, HTTPException
 from fastapi.responses import StreamingResponse
 from uvicorn.main import Server as UvicornServer
 
-from cogip.cpp.libraries.models import PoseBuffer as SharedPoseBuffer
-from cogip.cpp.libraries.shared_memory import LockName, SharedMemory, WritePriorityLock
+from cogip.cpp.libraries.shared_memory import SharedMemory
 from cogip.models import CameraExtrinsicParameters, Pose, models
 from cogip.tools.camera.arguments import CameraName, VideoCodec
 from cogip.tools.camera.camera import RPiCamera, SimCamera, USBCamera
@@ -65,8 +64,6 @@ class CameraServer:
         self.last_stream_frame: bytes | None = None
 
         self.shared_memory: SharedMemory | None = None
-        self.shared_pose_current_lock: WritePriorityLock | None = None
-        self.shared_pose_current_buffer: SharedPoseBuffer | None = None
 
         self.app = FastAPI(title="COGIP Robot Camera Streamer", lifespan=self.lifespan, debug=False)
         self.register_endpoints()
@@ -163,8 +160,6 @@ class CameraServer:
 
         if self.shared_memory is None:
             self.shared_memory = SharedMemory(f"cogip_{self.settings.id}")
-            self.shared_pose_current_lock = self.shared_memory.get_lock(LockName.PoseCurrent)
-            self.shared_pose_current_buffer = self.shared_memory.get_pose_current_buffer()
 
         try:
             systemd.daemon.notify("READY=1")
@@ -179,8 +174,6 @@ class CameraServer:
         if self.consumer_thread:
             self.consumer_thread.join()
 
-        self.shared_pose_current_buffer = None
-        self.shared_pose_current_lock = None
         self.shared_memory = None
 
     @staticmethod
@@ -384,10 +377,8 @@ class CameraServer:
             if self.last_frame is None:
                 raise HTTPException(status_code=503, detail="Camera not ready")
 
-            self.shared_pose_current_lock.start_reading()
-            pose = self.shared_pose_current_buffer.get(0)
+            pose = self.shared_memory.read_pose_current()
             pose_current = models.Pose(x=pose.x, y=pose.y, O=pose.angle)
-            self.shared_pose_current_lock.finish_reading()
             logger.info(f"Pose current: x={pose_current.x: 5.2f}, y={pose_current.y: 5.2f}, O={pose_current.O: 3.2f}")
 
             jpg_as_np = np.frombuffer(self.last_frame, dtype=np.uint8)
@@ -36,6 +36,13 @@ def main_opt(
             envvar="SERVER_RECORD_DIR",
         ),
     ] = Path("/var/tmp/cogip"),
+    prefault_shared_memory: Annotated[
+        bool,
+        typer.Option(
+            help="Prefault the shared memory and lock its hot regions in RAM",
+            envvar=["COGIP_PREFAULT_SHARED_MEMORY", "SERVER_PREFAULT_SHARED_MEMORY"],
+        ),
+    ] = False,
     reload: Annotated[
         bool,
         typer.Option(
@@ -60,6 +67,7 @@ def main_opt(
 
     os.environ["SERVER_RECORD_DIR"] = str(record_dir)
     os.environ["SERVER_DASHBOARD_UPDATE_INTERVAL"] = str(dashboard_update_interval)
+    os.environ["SERVER_PREFAULT_SHARED_MEMORY"] = str(int(prefault_shared_memory))
 
     uvicorn.run(
         "cogip.tools.server.app:app",
@@ -12,10 +12,9 @@ from uvicorn.main import Server as UvicornServer
 from cogip import models
 from cogip.cpp.libraries.models import PoseBuffer as SharedPoseBuffer
 from cogip.cpp.libraries.models import PoseOrderList as SharedPoseOrderList
-from cogip.cpp.libraries.obstacles import ObstacleCircleList as SharedObstacleCircleList
-from cogip.cpp.libraries.obstacles import ObstacleRectangleList as SharedObstacleRectangleList
 from cogip.cpp.libraries.shared_memory import LockName, SharedMemory, WritePriorityLock
 from cogip.utils.asyncloop import AsyncLoop
+from cogip.utils.update_waiter import wait_update
 from . import context, logger, namespaces
 
 
@@ -31,8 +30,6 @@ class Server:
     _original_uvicorn_exit_handler = UvicornServer.handle_exit  # Backup of original exit handler to overload it
     _shared_memory: SharedMemory | None = None  # Shared memory instance
     _shared_pose_current_buffer: SharedPoseBuffer | None = None
-    _shared_circle_obstacles: SharedObstacleCircleList | None = None
-    _shared_rectangle_obstacles: SharedObstacleRectangleList | None = None
     _shared_avoidance_path: SharedPoseOrderList | None = None
     _shared_avoidance_path_lock: WritePriorityLock | None = None
 
@@ -41,8 +38,6 @@ class Server:
         """Overload function for Uvicorn handle_exit"""
         Server._shared_avoidance_path = None
         Server._shared_avoidance_path_lock = None
-        Server._shared_rectangle_obstacles = None
-        Server._shared_circle_obstacles = None
         Server._shared_pose_current_buffer = None
         Server._shared_memory = None
         Server._original_uvicorn_exit_handler(*args, **kwargs)
@@ -65,10 +60,12 @@ class Server:
         )
 
         if Server._shared_memory is None:
-            Server._shared_memory = SharedMemory(f"cogip_{self.context.robot_id}", owner=True)
+            Server._shared_memory = SharedMemory(
+                f"cogip_{self.context.robot_id}",
+                owner=True,
+                prefault=bool(int(os.getenv("SERVER_PREFAULT_SHARED_MEMORY", 0))),
+            )
             Server._shared_pose_current_buffer = Server._shared_memory.get_pose_current_buffer()
-            Server._shared_circle_obstacles = Server._shared_memory.get_circle_obstacles()
-            Server._shared_rectangle_obstacles = Server._shared_memory.get_rectangle_obstacles()
             Server._shared_avoidance_path = Server._shared_memory.get_avoidance_path()
             Server._shared_avoidance_path_lock = Server._shared_memory.get_lock(LockName.AvoidancePath)
             Server._shared_avoidance_path_lock.register_consumer()
@@ -137,6 +134,15 @@ class Server:
             namespace="/dashboard",
         )
 
+    @staticmethod
+    def bounding_boxes(obstacles) -> list[list[dict[str, float]]]:
+        """Return the used bounding box points of each obstacle of a structured obstacle array."""
+        bounding_boxes = obstacles["bounding_box"]
+        return [
+            [{"x": x, "y": y} for x, y in elems[:count]]
+            for count, elems in zip(bounding_boxes["count"].tolist(), bounding_boxes["elems"].tolist())
+        ]
+
     async def update_dashboard(self):
         shared_pose_current = Server._shared_pose_current_buffer.last
         pose_current = {
@@ -145,29 +151,41 @@ class Server:
             "O": shared_pose_current.angle,
         }
         await self.sio.emit("pose_current", (self.context.robot_id, pose_current), namespace="/dashboard")
+        circles, rectangles = Server._shared_memory.copy_obstacles()
         obstacles = []
         obstacles += [
             {
-                "x": obstacle.center.x,
-                "y": obstacle.center.y,
+                "x": center[0],
+                "y": center[1],
                 "angle": 0,
-                "radius": obstacle.radius,
-                "bounding_box": [{"x": p.x, "y": p.y} for p in obstacle.bounding_box],
-                "id": obstacle.id,
+                "radius": radius,
+                "bounding_box": bounding_box,
+                "id": id,
             }
-            for obstacle in Server._shared_circle_obstacles
+            for center, radius, bounding_box, id in zip(
+                circles["center"].tolist(),
+                circles["radius"].tolist(),
+                self.bounding_boxes(circles),
+                circles["id"].tolist(),
+            )
         ]
         obstacles += [
             {
-                "x": obstacle.center.x,
-                "y": obstacle.center.y,
-                "angle": obstacle.center.angle,
-                "length_x": obstacle.length_x,
-                "length_y": obstacle.length_y,
-                "bounding_box": [{"x": p.x, "y": p.y} for p in obstacle.bounding_box],
-                "id": obstacle.id,
+                "x": center[0],
+                "y": center[1],
+                "angle": center[2],
+                "length_x": length_x,
+                "length_y": length_y,
+                "bounding_box": bounding_box,
+                "id": id,
             }
-            for obstacle in Server._shared_rectangle_obstacles
+            for center, length_x, length_y, bounding_box, id in zip(
+                rectangles["center"].tolist(),
+                rectangles["length_x"].tolist(),
+                rectangles["length_y"].tolist(),
+                self.bounding_boxes(rectangles),
+                rectangles["id"].tolist(),
+            )
         ]
         await self.sio.emit("obstacles", (self.context.robot_id, obstacles), namespace="/dashboard")
 
@@ -175,7 +193,7 @@ class Server:
         logger.info("Server: Task New Path Event Watcher Loop started")
         try:
             while True:
-                await asyncio.to_thread(Server._shared_avoidance_path_lock.wait_update)
+                await wait_update(Server._shared_avoidance_path_lock)
                 shared_pose_current = Server._shared_pose_current_buffer.last
                 path = [{"x": shared_pose_current.x, "y": shared_pose_current.y, "O": shared_pose_current.angle}]
                 for pose in Server._shared_avoidance_path:
@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 import threading
 import time
+from collections.abc import Callable
 from pathlib import Path
 from time import sleep
 from typing import Annotated
@@ -26,13 +27,13 @@ MIN_ANGLE: int = 0
 MAX_ANGLE: int = 0
 
 
-def start_console(lidar_data: NDArray):
+def start_console(read_lidar_data: Callable[[], NDArray]):
     print("Starting console thread.")
     while not stop_event.is_set():
-        # Find index with angle nearest to 0 (ie lidar_data[:, 0]) excluding -1
-        valid_indices: NDArray = lidar_data[:, 0] != -1
-        if valid_indices.any():
-            min_index = lidar_data[valid_indices, 0].argmin()
+        lidar_data = read_lidar_data()
+        # Find index with angle nearest to 0 (ie lidar_data[:, 0])
+        if len(lidar_data) > 0:
+            min_index = lidar_data[:, 0].argmin()
         else:
             print("No valid lidar data available.")
             sleep(0.1)
@@ -97,15 +98,11 @@ def main_opt(
     lidar_coords_lock.reset()
     lidar_coords_lock.register_consumer()
 
-    # Lidar data is initialized to -1 to indicate that no data is available
-    lidar_data[0][0] = -1
-    lidar_data[0][1] = -1
-    lidar_data[0][2] = -1
+    # No lidar data is available until the first scan
+    shared_memory.clear_lidar_scans()
 
-    lidar_coords[0][0] = -1
-    lidar_coords[0][1] = -1
-
-    lidar = YDLidar(lidar_data)
+    lidar = YDLidar()
+    lidar.set_shared_memory(shared_memory)
     lidar.set_data_write_lock(lidar_data_lock)
     lidar.set_min_distance(MIN_DISTANCE)
     lidar.set_max_distance(MAX_DISTANCE)
@@ -132,16 +129,24 @@ def main_opt(
         return
     print("Lidar started.")
 
-    console_thread = threading.Thread(target=start_console, args=(lidar_data,), name="Console thread")
+    console_thread = threading.Thread(
+        target=start_console,
+        args=(shared_memory.read_lidar_data,),
+        name="Console thread",
+    )
     console_thread.start()
 
     if web:
-        server_thread = threading.Thread(target=start_web, args=(lidar_data, web_port), name="Server thread")
+        server_thread = threading.Thread(
+            target=start_web,
+            args=(shared_memory.read_lidar_data, web_port),
+            name="Server thread",
+        )
         server_thread.start()
 
     if gui:
         # This function is blocking so set the stop event after exiting the GUI
-        start_gui(lidar_coords, lidar_offset=(LIDAR_OFFSET_X, LIDAR_OFFSET_Y))
+        start_gui(shared_memory.read_lidar_coords, lidar_offset=(LIDAR_OFFSET_X, LIDAR_OFFSET_Y))
         stop_event.set()
     else:
         try:
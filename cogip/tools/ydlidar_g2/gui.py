@@ -1,3 +1,5 @@
+from collections.abc import Callable
+
 import matplotlib.pyplot as plt
 import numpy as np
 from matplotlib.animation import FuncAnimation
@@ -11,7 +13,7 @@ from sklearn.cluster import DBSCAN
 class LidarObstacleTracker:
     def __init__(
         self,
-        lidar_coords: NDArray,
+        read_lidar_coords: Callable[[], NDArray],
         lidar_offset: tuple[float, float],
         eps: float = 30.0,
         min_samples: int = 6,
@@ -21,14 +23,15 @@ class LidarObstacleTracker:
         Initialize the real-time Lidar obstacle tracker
 
         Args:
-            lidar_coords: 2D NDArray with shape (MAX_LIDAR_DATA_COUNT, 2) containing x and y global coordinates
+            read_lidar_coords: function returning a 2D NDArray with shape (point count, 2)
+                containing the latest x and y global coordinates
             lidar_offset: Lidar offset from robot center
             eps: DBSCAN clustering parameter
             min_samples: Minimum points for cluster formation
             update_interval: Visualization update interval
         """
         # Use default pose if not provided
-        self.lidar_coords = lidar_coords
+        self.read_lidar_coords = read_lidar_coords
         self.lidar_offset = lidar_offset
         self.eps = eps
         self.min_samples = min_samples
@@ -159,7 +162,7 @@ class LidarObstacleTracker:
 
     def update_plot(self, frame):
         """Updates the visualization with current data"""
-        lidar_coords = self.lidar_coords[: np.argmax(self.lidar_coords[:, 0] == -1)].copy()
+        lidar_coords = self.read_lidar_coords()
         self.clusters = self.cluster_obstacles(lidar_coords)
         self.obstacle_properties = self.estimate_obstacle_properties(self.clusters)
 
@@ -256,10 +259,10 @@ class LidarObstacleTracker:
         plt.draw()
 
 
-def start_gui(lidar_coords: NDArray, lidar_offset: tuple[float, float]):
+def start_gui(read_lidar_coords: Callable[[], NDArray], lidar_offset: tuple[float, float]):
     print("Starting plot GUI")
     tracker = LidarObstacleTracker(
-        lidar_coords=lidar_coords,
+        read_lidar_coords=read_lidar_coords,
         lidar_offset=lidar_offset,
     )
 
@@ -7,13 +7,27 @@ from pathlib import Path
 from cogip.cpp.libraries import logger as cpp_logger
 
 
+def cpp_log_level(level: int) -> cpp_logger.LogLevel:
+    """
+    Lowest C++ log level handled by a Python logger of a given level.
+    C++ messages below this level are neither formatted nor sent to Python.
+    """
+    if level <= logging.DEBUG:
+        return cpp_logger.LogLevel.DEBUG
+    if level <= logging.INFO:
+        return cpp_logger.LogLevel.INFO
+    if level <= logging.WARNING:
+        return cpp_logger.LogLevel.WARNING
+    return cpp_logger.LogLevel.ERROR
+
+
 class Logger:
     """
     A Python class that integrates with C++ logging functionality.
     This class manages a Python logger and connects it to C++ logging streams.
     """
 
-    def __init__(self, name: str, *, level: int = logging.INFO, enable_cpp: bool = True):
+    def __init__(self, name: str, *, level: int = logging.INFO, enable_cpp: bool = True, async_cpp: bool = False):
         """
         Initialize the logger with a specific name and level.
 
@@ -21,9 +35,13 @@ class Logger:
             name: Name of the logger (appears in log output)
             level: Minimum logging level
             enable_cpp: If True, enables C++ logging integration
+            async_cpp: If True, C++ threads queue their messages without waiting for Python,
+                a C++ drain thread hands them over in batches
         """
         self.name = name
+        self.async_cpp = async_cpp
         self.is_destroyed = False  # Flag to track destruction
+        self.cpp_enabled = False
 
         # Create the Python logger
         self.logger = logging.getLogger(name)
@@ -75,13 +93,16 @@ class Logger:
     def enable_cpp_logging(self):
         """Enable C++ logging integration."""
         if not self.is_destroyed:
-            cpp_logger.set_logger_callback(self.log_callback)
+            cpp_logger.set_logger_callback(self.log_callback, cpp_log_level(self.logger.level))
+            if self.async_cpp:
+                cpp_logger.enable_async_logging(self.log_batch_callback)
+            self.cpp_enabled = True
 
     def cleanup(self):
         """Cleanup function to unregister the callback."""
         if not self.is_destroyed:
+            cpp_logger.unset_logger_callback()  # Unregister the callback, handing over queued C++ messages
             self.is_destroyed = True
-            cpp_logger.unset_logger_callback()  # Unregister the callback
 
     def log_callback(self, message: str, level: cpp_logger.LogLevel):
         """
@@ -100,6 +121,29 @@ class Logger:
         logger_func = getattr(self.logger, level.name.lower(), self.logger.info)
         logger_func(f"[C++] {message}")
 
+    def log_batch_callback(self, records: list[cpp_logger.LogRecord]):
+        """
+        Callback function for asynchronous C++ logging, called by the C++ drain thread.
+        Records keep the time and the thread of the C++ log call.
+
+        Args:
+            records: Log records queued by C++ threads
+        """
+        if self.is_destroyed:
+            return
+        for record in records:
+            if not record.message:
+                continue
+            level = getattr(logging, record.level.name, logging.INFO)
+            if not self.logger.isEnabledFor(level):
+                continue
+            log_record = self.logger.makeRecord(self.name, level, "(C++)", 0, f"[C++] {record.message}", None, None)
+            log_record.created = record.timestamp
+            log_record.msecs = (record.timestamp - int(record.timestamp)) * 1000
+            log_record.thread = record.thread_id
+            log_record.threadName = f"C++-{record.thread_id}"
+            self.logger.handle(log_record)
+
     def debug(self, message):
         """Log a debug message from Python"""
         self.logger.debug(message)
@@ -126,3 +170,5 @@ class Logger:
         self.logger.setLevel(level)
         for handler in self.logger.handlers:
             handler.setLevel(level)
+        if self.cpp_enabled and not self.is_destroyed:
+            cpp_logger.set_logger_level(cpp_log_level(level))
@@ -0,0 +1,119 @@
+"""
+Tracing of the C++ hot paths, exported as Chrome / Perfetto JSON timelines.
+
+Set the ``COGIP_TRACE_DIR`` environment variable to a directory to record the spans
+of the C++ libraries and drivers. Each recording process writes
+``<directory>/<shared memory name>-<process>-<pid>.json`` when it stops recording.
+
+All processes use the same monotonic clock, so their files can be merged in a single
+timeline, to be opened in https://ui.perfetto.dev or chrome://tracing:
+
+    python -m cogip.utils.trace <directory> <output file>
+"""
+
+import json
+import os
+import sys
+from collections.abc import Iterator
+from contextlib import contextmanager
+from pathlib import Path
+
+from cogip.cpp.libraries import logger as cpp_logger
+
+TRACE_DIR_VARIABLE = "COGIP_TRACE_DIR"
+
+
+def start_trace_recording(shared_memory_name: str, process: str) -> Path | None:
+    """
+    Start recording C++ tracing spans if ``COGIP_TRACE_DIR`` is set.
+
+    Arguments:
+        shared_memory_name: Name of the shared memory of the robot, grouping its processes in the timeline
+        process: Name of the process in the timeline
+
+    Returns:
+        Path of the trace file, None if tracing is disabled
+    """
+    directory = os.getenv(TRACE_DIR_VARIABLE)
+    if not directory:
+        return None
+
+    path = Path(directory) / f"{shared_memory_name}-{process}-{os.getpid()}.json"
+    path.parent.mkdir(parents=True, exist_ok=True)
+    cpp_logger.start_tracing(f"{shared_memory_name}/{process}")
+    return path
+
+
+def stop_trace_recording(path: Path | None) -> None:
+    """
+    Stop recording C++ tracing spans and write them.
+
+    Arguments:
+        path: Path returned by :func:`start_trace_recording`, nothing is done if None
+    """
+    if path is None:
+        return
+
+    cpp_logger.stop_tracing()
+    if not cpp_logger.dump_trace(str(path)):
+        print(f"Failed to write trace file {path}", file=sys.stderr)
+    elif dropped := cpp_logger.dropped_trace_spans():
+        print(f"Trace file {path}: {dropped} spans dropped", file=sys.stderr)
+
+
+@contextmanager
+def trace_recording(shared_memory_name: str, process: str) -> Iterator[Path | None]:
+    """
+    Record C++ tracing spans during the context if ``COGIP_TRACE_DIR`` is set.
+
+    Arguments:
+        shared_memory_name: Name of the shared memory of the robot, grouping its processes in the timeline
+        process: Name of the process in the timeline
+
+    Returns:
+        Path of the trace file, None if tracing is disabled
+    """
+    path = start_trace_recording(shared_memory_name, process)
+    try:
+        yield path
+    finally:
+        stop_trace_recording(path)
+
+
+def merge_traces(directory: Path, output: Path) -> int:
+    """
+    Merge the trace files of a directory in a single trace.
+
+    Arguments:
+        directory: Directory containing the trace files of the processes
+        output: Path of the merged trace, skipped if it is in the directory
+
+    Returns:
+        Number of merged events
+    """
+    events = []
+    dropped = 0
+    for path in sorted(directory.glob("*.json")):
+        if path.resolve() == output.resolve():
+            continue
+        trace = json.loads(path.read_text())
+        events.extend(trace["traceEvents"])
+        dropped += trace.get("otherData", {}).get("dropped_spans", 0)
+
+    output.write_text(
+        json.dumps(
+            {
+                "traceEvents": events,
+                "displayTimeUnit": "ns",
+                "otherData": {"dropped_spans": dropped},
+            }
+        )
+    )
+    return len(events)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit(f"Usage: python -m {__package__}.trace <directory> <output file>")
+    count = merge_traces(Path(sys.argv[1]), Path(sys.argv[2]))
+    print(f"{count} events written to {sys.argv[2]}")
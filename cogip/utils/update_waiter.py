@@ -0,0 +1,40 @@
+import asyncio
+import time
+
+from cogip.cpp.libraries.shared_memory import WritePriorityLock
+
+
+async def wait_update(lock: WritePriorityLock, timeout: float | None = None) -> bool:
+    """
+    Wait for an update posted on a shared memory lock, without blocking a thread.
+
+    The update file descriptor of the lock is watched by the running asyncio loop,
+    so any number of locks can be waited on by the same loop.
+    The lock must be registered as consumer.
+
+    Arguments:
+        lock: lock to wait on
+        timeout: timeout in seconds, wait indefinitely if None
+
+    Returns:
+        True if updates were posted since the last wait, False if timed out.
+    """
+    if lock.poll_update():
+        return True
+
+    loop = asyncio.get_running_loop()
+    deadline = None if timeout is None else time.monotonic() + timeout
+    fd = lock.update_fd()
+    while True:
+        ready = loop.create_future()
+        loop.add_reader(fd, lambda: ready.done() or ready.set_result(None))
+        try:
+            remaining = None if deadline is None else max(deadline - time.monotonic(), 0)
+            await asyncio.wait_for(ready, remaining)
+        except TimeoutError:
+            return False
+        finally:
+            loop.remove_reader(fd)
+        # The descriptor may have been signaled for an update already consumed by poll_update().
+        if lock.poll_update():
+            return True